@@ -12,6 +12,7 @@
 #include <fizz/client/PskCache.h>
 #include <fizz/protocol/Actions.h>
 #include <fizz/protocol/Params.h>
+#include <folly/futures/Future.h>
 
 namespace fizz {
 namespace client {
@@ -85,6 +86,7 @@ using Actions = std::vector<Action>;
 #else
 using Actions = folly::small_vector<Action, 4>;
 #endif
+using AsyncActions = boost::variant<Actions, folly::Future<Actions>>;
 
 namespace detail {
 
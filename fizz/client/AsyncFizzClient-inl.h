@@ -34,6 +34,46 @@ AsyncFizzClientT<SM>::AsyncFizzClientT(
       visitor_(*this),
       fizzClient_(state_, transportReadBuf_, visitor_, this) {}
 
+template <typename SM>
+AsyncFizzClientT<SM>::AsyncFizzClientT(
+    folly::AsyncTransportWrapper::UniquePtr socket,
+    std::shared_ptr<const FizzClientContext> fizzContext,
+    State state,
+    const std::shared_ptr<ClientExtensions>& extensions)
+    : AsyncFizzBase(std::move(socket)),
+      fizzContext_(std::move(fizzContext)),
+      extensions_(extensions),
+      state_(std::move(state)),
+      visitor_(*this),
+      fizzClient_(state_, transportReadBuf_, visitor_, this) {
+  CHECK(state_.state() == StateEnum::Established)
+      << "can only adopt established sessions";
+  state_.executor() = transport_->getEventBase();
+  sni_ = state_.sni();
+  pskIdentity_ = state_.sni();
+  startTransportReads();
+}
+
+template <typename SM>
+State AsyncFizzClientT<SM>::extractSessionState() {
+  CHECK(getState().state() == StateEnum::Established)
+      << "session not established";
+  CHECK(!fizzClient_.actionProcessing());
+  CHECK(transportReadBuf_.empty()) << "partially received records buffered";
+  return std::move(state_);
+}
+
+template <typename SM>
+bool AsyncFizzClientT<SM>::isDetachable() const {
+  return !fizzClient_.actionProcessing() && AsyncFizzBase::isDetachable();
+}
+
+template <typename SM>
+void AsyncFizzClientT<SM>::attachEventBase(folly::EventBase* evb) {
+  state_.executor() = evb;
+  AsyncFizzBase::attachEventBase(evb);
+}
+
 template <typename SM>
 void AsyncFizzClientT<SM>::connect(
     HandshakeCallback* callback,
@@ -83,6 +123,7 @@ void AsyncFizzClientT<SM>::connect(
     cachedPsk = fizzContext_->getPsk(*pskIdentity);
   }
   fizzClient_.connect(
+      transport_->getEventBase(),
       fizzContext_,
       std::move(verifier),
       std::move(sni),
@@ -119,6 +160,11 @@ void AsyncFizzClientT<SM>::connect(
       transport_->getUnderlyingTransport<folly::AsyncSocket>();
   if (underlyingSocket) {
     underlyingSocket->disableTransparentTls();
+    if (tfoEnabled_) {
+      // With TFO the socket invokes connectSuccess() inline, so the
+      // ClientHello is serialized here and queued to ride the SYN.
+      underlyingSocket->enableTFO();
+    }
     underlyingSocket->connect(
         this,
         connectAddr,
@@ -240,6 +286,7 @@ void AsyncFizzClientT<SM>::connectSuccess() noexcept {
     cachedPsk = fizzContext_->getPsk(*pskIdentity_);
   }
   fizzClient_.connect(
+      transport_->getEventBase(),
       fizzContext_,
       std::move(verifier_),
       sni_,
@@ -288,20 +335,53 @@ void AsyncFizzClientT<SM>::writeAppData(
 
       if (earlyDataRejectionPolicy_ ==
           EarlyDataRejectionPolicy::AutomaticResend) {
-        // We need to call unshare() to make a copy of the data here since we
-        // may need to resend it after we've already called writeSuccess().
-        // Particularly when using the write and writev interfaces, the
-        // application is allowed to delete the underlying buffer after getting
-        // the write callback.
+        // We may need to resend this data after we've already called
+        // writeSuccess(). For refcount-managed buffers a clone is enough
+        // to keep the data alive, and the AEAD will not scribble over a
+        // shared chain, so rejection (the rare case) costs nothing extra
+        // here. Buffers wrapping application memory have no refcount --
+        // with the write and writev interfaces the application is allowed
+        // to delete the memory after getting the write callback -- so
+        // those are copied eagerly.
         auto writeCopy = w.data->clone();
-        writeCopy->unshare();
+        auto current = writeCopy.get();
+        do {
+          if (!current->isManagedOne()) {
+            current->unshareOne();
+          }
+          current = current->next();
+        } while (current != writeCopy.get());
         earlyDataState_->resendBuffer.append(std::move(writeCopy));
       }
 
       earlyDataState_->remainingEarlyData -= size;
+      // Stream early data through the record layer inline while the state
+      // machine is idle, rather than queueing the write behind server
+      // flight processing. Falls back to a state machine event if the
+      // server flight is already being handled (early data may be getting
+      // rejected) or if a compat mode CCS still needs to be written.
+      if (!fizzClient_.actionProcessing() && transportReadBuf_.empty() &&
+          getState().earlyDataType() &&
+          (*getState().earlyDataType() == EarlyDataType::Attempted ||
+           *getState().earlyDataType() == EarlyDataType::Accepted) &&
+          (getState().sentCCS() || !fizzContext_->getCompatibilityMode()) &&
+          writeAppDataDirect(
+              getState().earlyWriteRecordLayer(),
+              callback,
+              w.data,
+              flags,
+              EncryptionLevel::EarlyData)) {
+        return;
+      }
       fizzClient_.earlyAppWrite(std::move(w));
     }
   } else {
+    if (getState().state() == StateEnum::Established &&
+        !fizzClient_.actionProcessing() &&
+        writeAppDataDirect(
+            getState().writeRecordLayer(), callback, buf, flags)) {
+      return;
+    }
     AppWrite w;
     w.callback = callback;
     w.data = std::move(buf);
@@ -319,6 +399,79 @@ void AsyncFizzClientT<SM>::transportError(
 
 template <typename SM>
 void AsyncFizzClientT<SM>::transportDataAvailable() {
+  DelayedDestruction::DestructorGuard dg(this);
+  if (appDataFastPathEnabled() &&
+      getState().state() == StateEnum::Established &&
+      !fizzClient_.actionProcessing() && getState().readRecordLayer() &&
+      getState().readRecordLayer()->getEncryptionLevel() ==
+          EncryptionLevel::AppTraffic &&
+      !getState().readRecordLayer()->hasUnparsedHandshakeData()) {
+    auto recordLayer = getState().readRecordLayer();
+    try {
+      if (decryptionPipeline()) {
+        auto encryptedLayer =
+            dynamic_cast<EncryptedReadRecordLayer*>(recordLayer);
+        if (encryptedLayer) {
+          // Fan decryption out to the pipeline's workers; decrypted
+          // messages arrive in record order via the pipeline callbacks.
+          while (true) {
+            auto record =
+                encryptedLayer->readCiphertextRecord(transportReadBuf_);
+            if (record.hasError()) {
+              deliverAllErrors(folly::AsyncSocketException(
+                  folly::AsyncSocketException::SSL_ERROR,
+                  record.error().message.c_str()));
+              return;
+            }
+            if (!record->hasValue()) {
+              return;
+            }
+            decryptionPipeline()->enqueue(std::move(**record));
+          }
+        }
+      }
+      while (true) {
+        auto msg = recordLayer->read(transportReadBuf_);
+        if (msg.hasError()) {
+          deliverAllErrors(folly::AsyncSocketException(
+              folly::AsyncSocketException::SSL_ERROR,
+              msg.error().message.c_str()));
+          return;
+        }
+        if (!msg->hasValue()) {
+          return;
+        }
+        if ((*msg)->type != ContentType::application_data) {
+          // Hand anything else back for full state machine processing.
+          recordLayer->bufferMessage(std::move(**msg));
+          break;
+        }
+        deliverAppData(std::move((*msg)->fragment));
+        if (!good()) {
+          return;
+        }
+      }
+    } catch (const std::exception& ex) {
+      deliverAllErrors(folly::AsyncSocketException(
+          folly::AsyncSocketException::SSL_ERROR, ex.what()));
+      return;
+    }
+  }
+  fizzClient_.newTransportData();
+}
+
+template <typename SM>
+void AsyncFizzClientT<SM>::pipelineControlMessage(TLSMessage msg) {
+  // A post-handshake message decrypted by the pipeline; hand it to the
+  // state machine as if the record layer had just read it.
+  auto recordLayer = getState().readRecordLayer();
+  if (!recordLayer) {
+    deliverAllErrors(folly::AsyncSocketException(
+        folly::AsyncSocketException::SSL_ERROR,
+        "pipelined control message without record layer"));
+    return;
+  }
+  recordLayer->bufferMessage(std::move(msg));
   fizzClient_.newTransportData();
 }
 
@@ -387,7 +540,12 @@ void AsyncFizzClientT<SM>::ActionMoveVisitor::operator()(WriteToSocket& data) {
   for (size_t i = 1; i < data.contents.size(); ++i) {
     allData->prependChain(std::move(data.contents[i].data));
   }
-  client_.transport_->writeChain(data.callback, std::move(allData), data.flags);
+  client_.queueTransportWrite(data.callback, std::move(allData), data.flags);
+}
+
+template <typename SM>
+void AsyncFizzClientT<SM>::ActionMoveVisitor::flushActions() {
+  client_.flushTransportWrites();
 }
 
 template <typename SM>
@@ -441,6 +599,8 @@ template <typename SM>
 void AsyncFizzClientT<SM>::ActionMoveVisitor::operator()(
     ReportHandshakeSuccess& success) {
   client_.cancelHandshakeTimeout();
+  // Established connections are not subject to handshake admission control.
+  client_.fizzClient_.setHandshakeScheduler(nullptr);
   if (client_.earlyDataState_) {
     if (!success.earlyDataAccepted) {
       auto ex = client_.handleEarlyReject();
@@ -518,6 +678,16 @@ void AsyncFizzClientT<SM>::ActionMoveVisitor::operator()(WaitForData&) {
 template <typename SM>
 void AsyncFizzClientT<SM>::ActionMoveVisitor::operator()(MutateState& mutator) {
   mutator(client_.state_);
+  // A mutator may have installed new record layers; keep the connection's
+  // stats block and event callback attached to the current ones.
+  if (client_.state_.readRecordLayer()) {
+    client_.state_.readRecordLayer()->setStats(client_.recordLayerStats());
+    client_.state_.readRecordLayer()->setEventCallback(
+        client_.recordEventCallback());
+  }
+  if (client_.state_.writeRecordLayer()) {
+    client_.state_.writeRecordLayer()->setStats(client_.recordLayerStats());
+  }
 }
 
 template <typename SM>
@@ -572,6 +742,35 @@ Buf AsyncFizzClientT<SM>::getEarlyEkm(
       *fizzContext_->getFactory(), label, context, length);
 }
 
+template <typename SM>
+void AsyncFizzClientT<SM>::updateTrafficKeys(bool requestPeerUpdate) {
+  KeyUpdateInitiation keyUpdateInitiation;
+  keyUpdateInitiation.request_update = requestPeerUpdate
+      ? KeyUpdateRequest::update_requested
+      : KeyUpdateRequest::update_not_requested;
+  fizzClient_.initiateKeyUpdate(std::move(keyUpdateInitiation));
+}
+
+template <typename SM>
+folly::Optional<KtlsState> AsyncFizzClientT<SM>::getKtlsState() const {
+  auto readRl = dynamic_cast<const EncryptedReadRecordLayer*>(
+      getState().readRecordLayer());
+  auto writeRl = dynamic_cast<const EncryptedWriteRecordLayer*>(
+      getState().writeRecordLayer());
+  if (!readRl || !writeRl ||
+      readRl->getEncryptionLevel() != EncryptionLevel::AppTraffic ||
+      writeRl->getEncryptionLevel() != EncryptionLevel::AppTraffic) {
+    return folly::none;
+  }
+  KtlsState ktls;
+  ktls.read = readRl->getRecordLayerState();
+  ktls.write = writeRl->getRecordLayerState();
+  if (!ktls.read.key || !ktls.write.key) {
+    return folly::none;
+  }
+  return std::move(ktls);
+}
+
 template <typename SM>
 bool AsyncFizzClientT<SM>::pskResumed() const {
   return getState().pskMode().has_value();
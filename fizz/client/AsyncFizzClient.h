@@ -56,6 +56,20 @@ class AsyncFizzClientT : public AsyncFizzBase,
       std::shared_ptr<const FizzClientContext> fizzContext,
       const std::shared_ptr<ClientExtensions>& extensions = nullptr);
 
+  /**
+   * Creates an AsyncFizzClient from an established session previously
+   * detached with extractSessionState(), letting a connection migrate to
+   * another thread's EventBase without re-handshaking. The socket must be
+   * the transport extracted from the original client, reattached to the
+   * new EventBase. New session tickets received after migration are
+   * cached under the session's SNI.
+   **/
+  AsyncFizzClientT(
+      folly::AsyncTransportWrapper::UniquePtr socket,
+      std::shared_ptr<const FizzClientContext> fizzContext,
+      State state,
+      const std::shared_ptr<ClientExtensions>& extensions = nullptr);
+
   /**
    * Performs a TLS handshake using the open socket passed into the constructor.
    **/
@@ -118,6 +132,18 @@ class AsyncFizzClientT : public AsyncFizzBase,
     earlyDataRejectionPolicy_ = policy;
   }
 
+  /**
+   * Enable TCP Fast Open on the socket connect() API. With TFO the socket
+   * reports the connection as established immediately and defers the
+   * actual connect, so the ClientHello (and any early data written with a
+   * 0-RTT PSK before the connection completes) is queued on the socket and
+   * sent with the SYN, collapsing connection establishment into a single
+   * round trip. Must be called before connect().
+   */
+  void setTFOEnabled(bool enabled) {
+    tfoEnabled_ = enabled;
+  }
+
   /**
    * Internal state access for logging/testing.
    */
@@ -135,6 +161,52 @@ class AsyncFizzClientT : public AsyncFizzBase,
   Buf getEarlyEkm(folly::StringPiece label, const Buf& context, uint16_t length)
       const;
 
+  void updateTrafficKeys(bool requestPeerUpdate = true) override;
+
+  /**
+   * Sets the scheduler used to admission-control this connection's
+   * handshake processing. The scheduler is detached automatically once the
+   * handshake completes.
+   */
+  void setHandshakeScheduler(
+      HandshakeScheduler* scheduler,
+      HandshakeScheduler::Priority priority =
+          HandshakeScheduler::Priority::Normal) {
+    fizzClient_.setHandshakeScheduler(scheduler, priority);
+  }
+
+  /**
+   * Sets an instrumentation hook notified of each state transition and
+   * crypto phase, giving a per-connection handshake latency breakdown.
+   * Must be called before connect() to observe the full handshake. The
+   * hook is not owned and must outlive the connection.
+   */
+  void setHandshakeInstrumentation(HandshakeInstrumentation* instrumentation) {
+    state_.instrumentation() = instrumentation;
+  }
+
+  /**
+   * Exports the app traffic record layer state (traffic keys, ivs and
+   * sequence numbers) in a form suitable for kernel TLS (setsockopt
+   * TLS_TX/TLS_RX). Returns none until the handshake has completed. Use
+   * extractTransport() afterwards to take over the socket.
+   */
+  folly::Optional<KtlsState> getKtlsState() const;
+
+  /**
+   * Detaches and returns the established connection state (record layers
+   * with traffic keys and sequence numbers, key scheduler and negotiated
+   * parameters) so the session can be re-attached on another thread with
+   * the State constructor. Only valid once the handshake has completed,
+   * no state machine action is processing and no partially received
+   * records are buffered; the client must not be used afterwards except
+   * for extractTransport() and destruction.
+   */
+  State extractSessionState();
+
+  bool isDetachable() const override;
+  void attachEventBase(folly::EventBase* evb) override;
+
   bool pskResumed() const;
 
  protected:
@@ -148,6 +220,8 @@ class AsyncFizzClientT : public AsyncFizzBase,
 
   void transportDataAvailable() override;
 
+  void pipelineControlMessage(TLSMessage msg) override;
+
  private:
   void deliverAllErrors(
       const folly::AsyncSocketException& ex,
@@ -176,6 +250,8 @@ class AsyncFizzClientT : public AsyncFizzBase,
     void operator()(SecretAvailable&);
     void operator()(EndOfData&);
 
+    void flushActions();
+
    private:
     AsyncFizzClientT<SM>& client_;
   };
@@ -217,6 +293,8 @@ class AsyncFizzClientT : public AsyncFizzBase,
   EarlyDataRejectionPolicy earlyDataRejectionPolicy_{
       EarlyDataRejectionPolicy::FatalConnectionError};
 
+  bool tfoEnabled_{false};
+
   folly::AsyncTransport::ReplaySafetyCallback* replaySafetyCallback_{nullptr};
 
   // Set when using socket connect() API to later pass into the state machine
@@ -0,0 +1,84 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/client/BurstPskCache.h>
+
+namespace fizz {
+namespace client {
+
+BurstPskCache::BurstPskCache(std::shared_ptr<PskCache> delegate)
+    : delegate_(std::move(delegate)) {}
+
+void BurstPskCache::prefetch(const std::vector<std::string>& identities) {
+  auto psks = delegate_->getPsks(identities);
+  auto map = pinned_.wlock();
+  for (size_t i = 0; i < identities.size(); i++) {
+    (*map)[identities[i]].shared = std::move(psks[i]);
+  }
+}
+
+void BurstPskCache::release(const std::string& identity) {
+  folly::Optional<CachedPsk> freshest;
+  {
+    auto map = pinned_.wlock();
+    auto it = map->find(identity);
+    if (it == map->end()) {
+      return;
+    }
+    if (!it->second.ticketQueue.empty()) {
+      freshest = std::move(it->second.ticketQueue.back());
+    }
+    map->erase(it);
+  }
+  if (freshest) {
+    delegate_->putPsk(identity, std::move(*freshest));
+  }
+}
+
+folly::Optional<CachedPsk> BurstPskCache::getPsk(const std::string& identity) {
+  {
+    auto map = pinned_.wlock();
+    auto it = map->find(identity);
+    if (it != map->end()) {
+      if (!it->second.ticketQueue.empty()) {
+        auto psk = std::move(it->second.ticketQueue.front());
+        it->second.ticketQueue.pop_front();
+        return std::move(psk);
+      }
+      return it->second.shared;
+    }
+  }
+  return delegate_->getPsk(identity);
+}
+
+void BurstPskCache::putPsk(const std::string& identity, CachedPsk psk) {
+  {
+    auto map = pinned_.wlock();
+    auto it = map->find(identity);
+    if (it != map->end()) {
+      it->second.ticketQueue.push_back(std::move(psk));
+      return;
+    }
+  }
+  delegate_->putPsk(identity, std::move(psk));
+}
+
+void BurstPskCache::removePsk(const std::string& identity) {
+  pinned_.wlock()->erase(identity);
+  delegate_->removePsk(identity);
+}
+
+Buf BurstPskCache::savePsks() {
+  return delegate_->savePsks();
+}
+
+void BurstPskCache::loadPsks(Buf serialized) {
+  delegate_->loadPsks(std::move(serialized));
+}
+} // namespace client
+} // namespace fizz
@@ -0,0 +1,70 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/client/PskCache.h>
+#include <folly/Synchronized.h>
+
+#include <deque>
+
+namespace fizz {
+namespace client {
+
+/**
+ * PskCache decorator for connection pools that open bursts of connections
+ * to the same identities. prefetch() reads the PSKs for a burst's
+ * identities from the underlying cache in one bulk lookup and pins them in
+ * memory, so each connect in the burst reads the pinned entry instead of
+ * paying another cache round trip. Tickets issued while an identity is
+ * pinned are queued and handed out one per lookup, preserving single-use
+ * ticket semantics; the pinned PSK is only shared when the queue is empty.
+ * release() unpins an identity, storing the freshest queued ticket back to
+ * the underlying cache. Identities that were never prefetched pass
+ * straight through to the underlying cache.
+ */
+class BurstPskCache : public PskCache {
+ public:
+  explicit BurstPskCache(std::shared_ptr<PskCache> delegate);
+  ~BurstPskCache() override = default;
+
+  /**
+   * Fetch and pin the PSKs for the given identities ahead of a burst of
+   * connects. Prefetching an already pinned identity refreshes its shared
+   * PSK but keeps any queued tickets.
+   */
+  void prefetch(const std::vector<std::string>& identities);
+
+  /**
+   * Unpin an identity at the end of a burst. The freshest queued ticket,
+   * if any, is written back to the underlying cache.
+   */
+  void release(const std::string& identity);
+
+  folly::Optional<CachedPsk> getPsk(const std::string& identity) override;
+
+  void putPsk(const std::string& identity, CachedPsk psk) override;
+
+  void removePsk(const std::string& identity) override;
+
+  Buf savePsks() override;
+
+  void loadPsks(Buf serialized) override;
+
+ private:
+  struct PinnedEntry {
+    folly::Optional<CachedPsk> shared;
+    std::deque<CachedPsk> ticketQueue;
+  };
+
+  std::shared_ptr<PskCache> delegate_;
+  folly::Synchronized<std::unordered_map<std::string, PinnedEntry>> pinned_;
+};
+
+} // namespace client
+} // namespace fizz
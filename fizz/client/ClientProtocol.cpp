@@ -10,12 +10,18 @@
 
 #include <fizz/client/PskCache.h>
 #include <fizz/client/State.h>
-#include <fizz/crypto/Utils.h>
+#include <fizz/protocol/AsyncCertificateVerifier.h>
+#include <fizz/protocol/AsyncSelfCert.h>
 #include <fizz/protocol/CertificateVerifier.h>
+#include <fizz/protocol/Instrumentation.h>
 #include <fizz/protocol/Protocol.h>
 #include <fizz/protocol/StateMachine.h>
 #include <fizz/record/Extensions.h>
+#include <fizz/util/Workarounds.h>
+#include <folly/Overload.h>
+#include <folly/io/Cursor.h>
 
+using folly::Future;
 using folly::Optional;
 
 using namespace fizz::client;
@@ -139,6 +145,12 @@ FIZZ_DECLARE_EVENT_HANDLER(
     Event::KeyUpdate,
     StateEnum::Error);
 
+FIZZ_DECLARE_EVENT_HANDLER(
+    ClientTypes,
+    StateEnum::Established,
+    Event::KeyUpdateInitiation,
+    StateEnum::Error);
+
 FIZZ_DECLARE_EVENT_HANDLER(
     ClientTypes,
     StateEnum::Established,
@@ -154,14 +166,16 @@ FIZZ_DECLARE_EVENT_HANDLER(
 
 namespace client {
 
-Actions ClientStateMachine::processConnect(
+AsyncActions ClientStateMachine::processConnect(
     const State& state,
+    folly::Executor* executor,
     std::shared_ptr<const FizzClientContext> context,
     std::shared_ptr<const CertificateVerifier> verifier,
     Optional<std::string> sni,
     Optional<CachedPsk> cachedPsk,
     const std::shared_ptr<ClientExtensions>& extensions) {
   Connect connect;
+  connect.executor = executor;
   connect.context = std::move(context);
   connect.sni = std::move(sni);
   connect.verifier = std::move(verifier);
@@ -170,7 +184,7 @@ Actions ClientStateMachine::processConnect(
   return detail::processEvent(state, std::move(connect));
 }
 
-Actions ClientStateMachine::processSocketData(
+AsyncActions ClientStateMachine::processSocketData(
     const State& state,
     folly::IOBufQueue& buf) {
   try {
@@ -181,10 +195,23 @@ Actions ClientStateMachine::processSocketData(
           folly::none);
     }
     auto param = state.readRecordLayer()->readEvent(buf);
-    if (!param.hasValue()) {
+    if (param.hasError()) {
+      const auto& error = param.error();
+      return detail::handleError(
+          state,
+          ReportError(folly::make_exception_wrapper<FizzException>(
+              folly::to<std::string>(
+                  "error decoding record in state ",
+                  toString(state.state()),
+                  ": ",
+                  error.message),
+              error.alert)),
+          error.alert);
+    }
+    if (!param->hasValue()) {
       return actions(WaitForData());
     }
-    return detail::processEvent(state, std::move(*param));
+    return detail::processEvent(state, std::move(**param));
   } catch (const FizzException& e) {
     return detail::handleError(
         state,
@@ -204,24 +231,30 @@ Actions ClientStateMachine::processSocketData(
   }
 }
 
-Actions ClientStateMachine::processWriteNewSessionTicket(
+AsyncActions ClientStateMachine::processWriteNewSessionTicket(
     const State& state,
     WriteNewSessionTicket write) {
   return detail::processEvent(state, std::move(write));
 }
 
-Actions ClientStateMachine::processAppWrite(
+AsyncActions ClientStateMachine::processAppWrite(
     const State& state,
     AppWrite write) {
   return detail::processEvent(state, std::move(write));
 }
 
-Actions ClientStateMachine::processEarlyAppWrite(
+AsyncActions ClientStateMachine::processEarlyAppWrite(
     const State& state,
     EarlyAppWrite write) {
   return detail::processEvent(state, std::move(write));
 }
 
+AsyncActions ClientStateMachine::processKeyUpdateInitiation(
+    const State& state,
+    KeyUpdateInitiation keyUpdateInitiation) {
+  return detail::processEvent(state, std::move(keyUpdateInitiation));
+}
+
 Actions ClientStateMachine::processAppClose(const State& state) {
   return detail::handleAppClose(state);
 }
@@ -232,11 +265,34 @@ Actions ClientStateMachine::processAppCloseImmediate(const State& state) {
 
 namespace detail {
 
-Actions processEvent(const State& state, Param param) {
-  auto event = boost::apply_visitor(EventVisitor(), param);
+AsyncActions processEvent(const State& state, Param param) {
+  auto event = getEvent(param);
+  // We can have an exception directly in the handler or in a future so we need
+  // to handle both types.
   try {
-    return sm::StateMachine<ClientTypes>::getHandler(state.state(), event)(
-        state, std::move(param));
+    auto actions = sm::StateMachine<ClientTypes>::getHandler(
+        state.state(), event)(state, std::move(param));
+
+    return folly::variant_match(
+        actions,
+        ::fizz::detail::result_type<AsyncActions>(),
+        [&state](folly::Future<Actions>& futureActions) -> AsyncActions {
+          return std::move(futureActions)
+              .thenError([&state](folly::exception_wrapper ew) {
+                auto ex = ew.get_exception<FizzException>();
+                if (ex) {
+                  return detail::handleError(
+                      state, ReportError(std::move(ew)), ex->getAlert());
+                }
+                return detail::handleError(
+                    state,
+                    ReportError(std::move(ew)),
+                    AlertDescription::unexpected_message);
+              });
+        },
+        [](Actions& immediateActions) -> AsyncActions {
+          return std::move(immediateActions);
+        });
   } catch (const FizzException& e) {
     return detail::handleError(
         state,
@@ -357,14 +413,22 @@ static folly::Optional<CachedPsk> validatePsk(
     return folly::none;
   }
 
-  auto now = context.getClock()->getCurrentTime();
-  if (now > psk->ticketExpirationTime) {
-    VLOG(1) << "Ignoring expired cached psk";
-    return folly::none;
-  }
-  if (now - psk->ticketHandshakeTime > context.getMaxPskHandshakeLife()) {
-    VLOG(1) << "Ignoring psk with stale handshake";
-    return folly::none;
+  // Static external PSKs have no ticket lifetime; only the ticket-derived
+  // time checks are skipped for them.
+  if (psk->type != PskType::External) {
+    auto now = context.getClock()->getCurrentTime();
+    if (now > psk->ticketExpirationTime) {
+      VLOG(1) << "Ignoring expired cached psk";
+      return folly::none;
+    }
+    if (now - psk->ticketHandshakeTime > context.getMaxPskHandshakeLife()) {
+      VLOG(1) << "Ignoring psk with stale handshake";
+      return folly::none;
+    }
+    if (psk->ticketHandshakeTime > now) {
+      VLOG(1) << "Ignoring psk from future";
+      return folly::none;
+    }
   }
 
   if (std::find(
@@ -383,11 +447,6 @@ static folly::Optional<CachedPsk> validatePsk(
     return folly::none;
   }
 
-  if (psk->ticketHandshakeTime > now) {
-    VLOG(1) << "Ignoring psk from future";
-    return folly::none;
-  }
-
   return psk;
 }
 
@@ -403,18 +462,18 @@ static std::map<NamedGroup, std::unique_ptr<KeyExchange>> getKeyExchangers(
   return keyExchangers;
 }
 
+static Extension cloneExtension(const Extension& extension) {
+  Extension clone;
+  clone.extension_type = extension.extension_type;
+  clone.extension_data = extension.extension_data->clone();
+  return clone;
+}
+
 static ClientHello getClientHello(
-    const Factory& /*factory*/,
+    const FizzClientContext& context,
     const Random& random,
-    const std::vector<CipherSuite>& supportedCiphers,
-    const std::vector<ProtocolVersion>& supportedVersions,
-    const std::vector<NamedGroup>& supportedGroups,
     const std::map<NamedGroup, std::unique_ptr<KeyExchange>>& shares,
-    const std::vector<SignatureScheme>& supportedSigSchemes,
-    const std::vector<PskKeyExchangeMode>& supportedPskModes,
     const folly::Optional<std::string>& hostname,
-    const std::vector<std::string>& supportedAlpns,
-    const std::vector<CertificateCompressionAlgorithm>& compressionAlgos,
     const Optional<EarlyDataParams>& earlyDataParams,
     const Buf& legacySessionId,
     ClientExtensions* extensions,
@@ -423,16 +482,16 @@ static ClientHello getClientHello(
   chlo.legacy_version = ProtocolVersion::tls_1_2;
   chlo.random = random;
   chlo.legacy_session_id = legacySessionId->clone();
-  chlo.cipher_suites = supportedCiphers;
+  chlo.cipher_suites = context.getSupportedCiphers();
   chlo.legacy_compression_methods.push_back(0x00);
 
-  SupportedVersions versions;
-  versions.versions = supportedVersions;
-  chlo.extensions.push_back(encodeExtension(std::move(versions)));
-
-  SupportedGroups groups;
-  groups.named_group_list = supportedGroups;
-  chlo.extensions.push_back(encodeExtension(std::move(groups)));
+  // Extensions that depend only on context configuration are pre-encoded
+  // by the context; only their bytes are cloned here. The key share, SNI,
+  // early data and cookie extensions vary per connection and are encoded
+  // as before.
+  const auto& precomputed = context.getPrecomputedExtensions();
+  chlo.extensions.push_back(cloneExtension(precomputed.supportedVersions));
+  chlo.extensions.push_back(cloneExtension(precomputed.supportedGroups));
 
   ClientKeyShare keyShare;
   for (const auto& share : shares) {
@@ -443,9 +502,7 @@ static ClientHello getClientHello(
   }
   chlo.extensions.push_back(encodeExtension(std::move(keyShare)));
 
-  SignatureAlgorithms sigAlgs;
-  sigAlgs.supported_signature_algorithms = supportedSigSchemes;
-  chlo.extensions.push_back(encodeExtension(std::move(sigAlgs)));
+  chlo.extensions.push_back(cloneExtension(precomputed.sigSchemes));
 
   if (hostname) {
     ServerNameList sni;
@@ -455,20 +512,12 @@ static ClientHello getClientHello(
     chlo.extensions.push_back(encodeExtension(std::move(sni)));
   }
 
-  if (!supportedAlpns.empty()) {
-    ProtocolNameList alpn;
-    for (const auto& protoName : supportedAlpns) {
-      ProtocolName proto;
-      proto.name = folly::IOBuf::copyBuffer(protoName);
-      alpn.protocol_name_list.push_back(std::move(proto));
-    }
-    chlo.extensions.push_back(encodeExtension(std::move(alpn)));
+  if (precomputed.alpns) {
+    chlo.extensions.push_back(cloneExtension(*precomputed.alpns));
   }
 
-  if (!supportedPskModes.empty()) {
-    PskKeyExchangeModes modes;
-    modes.modes = supportedPskModes;
-    chlo.extensions.push_back(encodeExtension(std::move(modes)));
+  if (precomputed.pskModes) {
+    chlo.extensions.push_back(cloneExtension(*precomputed.pskModes));
   }
 
   if (earlyDataParams) {
@@ -481,10 +530,8 @@ static ClientHello getClientHello(
     chlo.extensions.push_back(encodeExtension(std::move(monster)));
   }
 
-  if (!compressionAlgos.empty()) {
-    CertificateCompressionAlgorithms algos;
-    algos.algorithms = compressionAlgos;
-    chlo.extensions.push_back(encodeExtension(std::move(algos)));
+  if (precomputed.certCompression) {
+    chlo.extensions.push_back(cloneExtension(*precomputed.certCompression));
   }
 
   if (extensions) {
@@ -503,11 +550,16 @@ static ClientPresharedKey getPskExtension(
   ClientPresharedKey pskExt;
   PskIdentity ident;
   ident.psk_identity = folly::IOBuf::copyBuffer(psk.psk);
-  ident.obfuscated_ticket_age =
-      std::chrono::duration_cast<std::chrono::milliseconds>(
-          clock.getCurrentTime() - psk.ticketIssueTime)
-          .count();
-  ident.obfuscated_ticket_age += psk.ticketAgeAdd;
+  if (psk.type == PskType::External) {
+    // External PSKs have no ticket age.
+    ident.obfuscated_ticket_age = 0;
+  } else {
+    ident.obfuscated_ticket_age =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            clock.getCurrentTime() - psk.ticketIssueTime)
+            .count();
+    ident.obfuscated_ticket_age += psk.ticketAgeAdd;
+  }
   pskExt.identities.push_back(std::move(ident));
   PskBinder binder;
   size_t binderSize = getHashSize(getHashFunction(psk.cipher));
@@ -530,46 +582,51 @@ static Buf encodeAndAddBinders(
     KeyScheduler& scheduler,
     HandshakeContext& handshakeContext,
     const Clock& clock) {
-  scheduler.deriveEarlySecret(folly::range(psk.secret));
+  if (!psk.cachedEarlySecret.empty()) {
+    scheduler.setEarlySecret(folly::range(psk.cachedEarlySecret));
+  } else {
+    scheduler.deriveEarlySecret(folly::range(psk.secret));
+  }
 
-  auto binderKey = scheduler.getSecret(
-      psk.type == PskType::External ? EarlySecrets::ExternalPskBinder
-                                    : EarlySecrets::ResumptionPskBinder,
-      handshakeContext.getBlankContext());
+  auto binderType = psk.type == PskType::External
+      ? EarlySecrets::ExternalPskBinder
+      : EarlySecrets::ResumptionPskBinder;
+  auto binderKey = psk.cachedBinderKey.empty()
+      ? scheduler.getSecret(binderType, handshakeContext.getBlankContext())
+            .secret
+      : psk.cachedBinderKey;
 
   auto pskExt = getPskExtension(psk, clock);
-  chlo.extensions.push_back(encodeExtension(pskExt));
+  chlo.extensions.push_back(encodeExtension(std::move(pskExt)));
 
   size_t binderLength = getBinderLength(chlo);
 
-  auto preEncoded = encodeHandshake(chlo);
+  // Encode the hello once, with the zero placeholder binder, and patch
+  // the real binder into the encoding in place. The binder is the last
+  // field of the hello and its length is fixed by the hash, so no
+  // lengths change and nothing needs to be re-encoded.
+  auto encoded = encodeHandshake(std::move(chlo));
+  auto encodedLength = encoded->computeChainDataLength();
 
   // Add the ClientHello up to the binder list to the transcript.
-  {
-    folly::IOBufQueue chloQueue(folly::IOBufQueue::cacheChainLength());
-    chloQueue.append(std::move(preEncoded));
-    auto chloPrefix = chloQueue.split(chloQueue.chainLength() - binderLength);
-    handshakeContext.appendToTranscript(chloPrefix);
-  }
-
-  PskBinder binder;
-  binder.binder =
-      handshakeContext.getFinishedData(folly::range(binderKey.secret));
-  pskExt.binders.clear();
-  pskExt.binders.push_back(std::move(binder));
+  folly::IOBufQueue chloQueue(folly::IOBufQueue::cacheChainLength());
+  chloQueue.append(std::move(encoded));
+  auto chloPrefix = chloQueue.split(encodedLength - binderLength);
+  handshakeContext.appendToTranscript(chloPrefix);
 
-  chlo.extensions.pop_back();
-  chlo.extensions.push_back(encodeExtension(std::move(pskExt)));
+  auto binder = handshakeContext.getFinishedData(folly::range(binderKey));
+  auto binderRange = binder->coalesce();
 
-  auto encoded = encodeHandshake(std::move(chlo));
+  auto binderList = chloQueue.move();
+  folly::io::RWPrivateCursor cursor(binderList.get());
+  cursor.skip(binderLength - binderRange.size());
+  cursor.push(binderRange);
 
   // Add the binder list to the transcript.
-  folly::IOBufQueue chloQueue(folly::IOBufQueue::cacheChainLength());
-  chloQueue.append(encoded->clone());
-  chloQueue.split(chloQueue.chainLength() - binderLength);
-  handshakeContext.appendToTranscript(chloQueue.move());
+  handshakeContext.appendToTranscript(binderList);
 
-  return encoded;
+  chloPrefix->prependChain(std::move(binderList));
+  return chloPrefix;
 }
 
 static Optional<EarlyDataParams> getEarlyDataParams(
@@ -600,16 +657,20 @@ static Optional<EarlyDataParams> getEarlyDataParams(
   return params;
 }
 
-Actions
+AsyncActions
 EventHandler<ClientTypes, StateEnum::Uninitialized, Event::Connect>::handle(
-    const State& /*state*/,
+    const State& state,
     Param param) {
   auto& connect = boost::get<Connect>(param);
 
   auto context = std::move(connect.context);
 
+  auto cachedPsk = std::move(connect.cachedPsk);
+  if (!cachedPsk && context->getExternalPsk()) {
+    cachedPsk = *context->getExternalPsk();
+  }
   folly::Optional<CachedPsk> psk =
-      validatePsk(*context, std::move(connect.cachedPsk));
+      validatePsk(*context, std::move(cachedPsk));
 
   auto random = context->getFactory()->makeRandom();
 
@@ -628,6 +689,20 @@ EventHandler<ClientTypes, StateEnum::Uninitialized, Event::Connect>::handle(
     selectedShares = {};
   } else {
     selectedShares = context->getDefaultShares();
+    // Without a PSK, a group memory cache may still remember which group
+    // this destination negotiated, letting us generate just that share. A
+    // stale prediction falls back via HelloRetryRequest.
+    if (context->getGroupMemoryCache() && connect.sni) {
+      auto rememberedGroup =
+          context->getGroupMemoryCache()->getGroup(*connect.sni);
+      if (rememberedGroup &&
+          std::find(
+              context->getSupportedGroups().begin(),
+              context->getSupportedGroups().end(),
+              *rememberedGroup) != context->getSupportedGroups().end()) {
+        selectedShares = {*rememberedGroup};
+      }
+    }
   }
 
   auto earlyDataParams = getEarlyDataParams(*context, psk);
@@ -640,20 +715,18 @@ EventHandler<ClientTypes, StateEnum::Uninitialized, Event::Connect>::handle(
     legacySessionId = folly::IOBuf::create(0);
   }
 
-  auto keyExchangers = getKeyExchangers(*context->getFactory(), selectedShares);
+  std::map<NamedGroup, std::unique_ptr<KeyExchange>> keyExchangers;
+  {
+    CryptoPhaseTimer timer(
+        state.instrumentation(), CryptoPhase::KeyExchange);
+    keyExchangers = getKeyExchangers(*context->getFactory(), selectedShares);
+  }
 
   auto chlo = getClientHello(
-      *context->getFactory(),
+      *context,
       random,
-      context->getSupportedCiphers(),
-      context->getSupportedVersions(),
-      context->getSupportedGroups(),
       keyExchangers,
-      context->getSupportedSigSchemes(),
-      context->getSupportedPskModes(),
       connect.sni,
-      context->getSupportedAlpns(),
-      context->getSupportedCertDecompressionAlgorithms(),
       earlyDataParams,
       legacySessionId,
       connect.extensions.get());
@@ -722,7 +795,8 @@ EventHandler<ClientTypes, StateEnum::Uninitialized, Event::Connect>::handle(
   EarlyDataType earlyDataType =
       earlyDataParams ? EarlyDataType::Attempted : EarlyDataType::NotAttempted;
 
-  auto saveState = [context = std::move(context),
+  auto saveState = [executor = connect.executor,
+                    context = std::move(context),
                     verifier = connect.verifier,
                     encodedClientHello = std::move(encodedClientHello),
                     readRecordLayer = std::move(readRecordLayer),
@@ -735,6 +809,7 @@ EventHandler<ClientTypes, StateEnum::Uninitialized, Event::Connect>::handle(
                     extensions = connect.extensions,
                     requestedExtensions = std::move(requestedExtensions),
                     earlyDataType](State& newState) mutable {
+    newState.executor() = executor;
     newState.context() = std::move(context);
     newState.verifier() = verifier;
     newState.encodedClientHello() = std::move(encodedClientHello);
@@ -930,7 +1005,7 @@ static NegotiatedPsk negotiatePsk(
   }
 }
 
-Actions
+AsyncActions
 EventHandler<ClientTypes, StateEnum::ExpectingServerHello, Event::ServerHello>::
     handle(const State& state, Param param) {
   auto shlo = std::move(boost::get<ServerHello>(param));
@@ -982,7 +1057,12 @@ EventHandler<ClientTypes, StateEnum::ExpectingServerHello, Event::ServerHello>::
   auto scheduler = state.context()->getFactory()->makeKeyScheduler(cipher);
 
   if (negotiatedPsk.mode) {
-    scheduler->deriveEarlySecret(folly::range(state.attemptedPsk()->secret));
+    if (!state.attemptedPsk()->cachedEarlySecret.empty()) {
+      scheduler->setEarlySecret(
+          folly::range(state.attemptedPsk()->cachedEarlySecret));
+    } else {
+      scheduler->deriveEarlySecret(folly::range(state.attemptedPsk()->secret));
+    }
   }
 
   Optional<NamedGroup> group;
@@ -997,6 +1077,7 @@ EventHandler<ClientTypes, StateEnum::ExpectingServerHello, Event::ServerHello>::
     Buf serverShare;
     const KeyExchange* kex;
     std::tie(group, serverShare, kex) = std::move(*exchange);
+    CryptoPhaseTimer timer(state.instrumentation(), CryptoPhase::KeyExchange);
     auto sharedSecret = kex->generateSharedSecret(serverShare->coalesce());
     scheduler->deriveHandshakeSecret(sharedSecret->coalesce());
   } else {
@@ -1146,7 +1227,7 @@ static std::map<NamedGroup, std::unique_ptr<KeyExchange>> getHrrKeyExchangers(
   }
 }
 
-Actions EventHandler<
+AsyncActions EventHandler<
     ClientTypes,
     StateEnum::ExpectingServerHello,
     Event::HelloRetryRequest>::handle(const State& state, Param param) {
@@ -1175,6 +1256,14 @@ Actions EventHandler<
       getHashFunction(attemptedPsk->cipher) != getHashFunction(cipher)) {
     attemptedPsk = folly::none;
   }
+  if (attemptedPsk && attemptedPsk->cachedEarlySecret.empty() &&
+      state.keyScheduler()) {
+    // The first flight already ran the early secret extract for this
+    // PSK, and the PSK is only kept if the HRR did not change the hash.
+    // Seed the second flight's scheduler with the extracted secret
+    // instead of re-deriving it.
+    attemptedPsk->cachedEarlySecret = state.keyScheduler()->getEarlySecret();
+  }
 
   // We move the current key exchangers in so getHrrKeyExchangers can either
   // return the current set with ownership or create a new one.
@@ -1182,17 +1271,10 @@ Actions EventHandler<
       *state.context()->getFactory(), std::move(*state.keyExchangers()), group);
 
   auto chlo = getClientHello(
-      *state.context()->getFactory(),
+      *state.context(),
       state.clientRandom(),
-      state.context()->getSupportedCiphers(),
-      state.context()->getSupportedVersions(),
-      state.context()->getSupportedGroups(),
       keyExchangers,
-      state.context()->getSupportedSigSchemes(),
-      state.context()->getSupportedPskModes(),
       state.sni(),
-      state.context()->getSupportedAlpns(),
-      state.context()->getSupportedCertDecompressionAlgorithms(),
       folly::none,
       state.legacySessionId(),
       state.extensions(),
@@ -1307,7 +1389,7 @@ static void validateAcceptedEarly(
   }
 }
 
-Actions EventHandler<
+AsyncActions EventHandler<
     ClientTypes,
     StateEnum::ExpectingEncryptedExtensions,
     Event::EncryptedExtensions>::handle(const State& state, Param param) {
@@ -1406,7 +1488,7 @@ getClientCert(const State& state, const std::vector<SignatureScheme>& schemes) {
   return std::make_tuple(std::move(selectedScheme), std::move(clientCert));
 }
 
-Actions EventHandler<
+AsyncActions EventHandler<
     ClientTypes,
     StateEnum::ExpectingCertificate,
     Event::CertificateRequest>::handle(const State& state, Param param) {
@@ -1462,6 +1544,11 @@ static MutateState handleCertMsg(
         AlertDescription::illegal_parameter);
   }
 
+  // With no verifier configured the chain is never inspected beyond the
+  // CertificateVerify signature check, so keep the raw DER and defer
+  // parsing each certificate until it is actually used.
+  const bool lazyCerts = !state.verifier();
+
   std::vector<std::shared_ptr<const PeerCert>> serverCerts;
   for (auto& certEntry : certMsg.certificate_list) {
     // We don't request any certificate-related extensions
@@ -1471,8 +1558,13 @@ static MutateState handleCertMsg(
           AlertDescription::illegal_parameter);
     }
 
-    serverCerts.emplace_back(state.context()->getFactory()->makePeerCert(
-        std::move(certEntry.cert_data)));
+    if (lazyCerts) {
+      serverCerts.emplace_back(
+          CertUtils::makeLazyPeerCert(std::move(certEntry.cert_data)));
+    } else {
+      serverCerts.emplace_back(state.context()->getFactory()->makePeerCert(
+          std::move(certEntry.cert_data)));
+    }
   }
 
   if (serverCerts.empty()) {
@@ -1492,11 +1584,12 @@ static MutateState handleCertMsg(
   };
 }
 
-Actions EventHandler<
+AsyncActions EventHandler<
     ClientTypes,
     StateEnum::ExpectingCertificate,
     Event::CompressedCertificate>::handle(const State& state, Param param) {
-  if (state.context()->getSupportedCertDecompressionAlgorithms().empty()) {
+  auto algos = state.context()->getSupportedCertDecompressionAlgorithms();
+  if (algos.empty()) {
     throw FizzException(
         "compressed certificate received unexpectedly",
         AlertDescription::unexpected_message);
@@ -1505,7 +1598,6 @@ Actions EventHandler<
   auto compCert = std::move(boost::get<CompressedCertificate>(param));
   state.handshakeContext()->appendToTranscript(*compCert.originalEncoding);
 
-  auto algos = state.context()->getSupportedCertDecompressionAlgorithms();
   if (std::find(algos.begin(), algos.end(), compCert.algorithm) ==
       algos.end()) {
     throw FizzException(
@@ -1532,7 +1624,7 @@ Actions EventHandler<
       &Transition<StateEnum::ExpectingCertificateVerify>);
 }
 
-Actions
+AsyncActions
 EventHandler<ClientTypes, StateEnum::ExpectingCertificate, Event::Certificate>::
     handle(const State& state, Param param) {
   auto certMsg = std::move(boost::get<CertificateMsg>(param));
@@ -1544,7 +1636,7 @@ EventHandler<ClientTypes, StateEnum::ExpectingCertificate, Event::Certificate>::
       &Transition<StateEnum::ExpectingCertificateVerify>);
 }
 
-Actions EventHandler<
+AsyncActions EventHandler<
     ClientTypes,
     StateEnum::ExpectingCertificateVerify,
     Event::CertificateVerify>::handle(const State& state, Param param) {
@@ -1565,37 +1657,64 @@ Actions EventHandler<
   CHECK(!state.unverifiedCertChain().empty());
   auto leaf = state.unverifiedCertChain().front();
 
-  leaf->verify(
-      certVerify.algorithm,
-      CertificateVerifyContext::Server,
-      state.handshakeContext()->getHandshakeContext()->coalesce(),
-      certVerify.signature->coalesce());
+  {
+    CryptoPhaseTimer timer(state.instrumentation(), CryptoPhase::Verification);
+    leaf->verify(
+        certVerify.algorithm,
+        CertificateVerifyContext::Server,
+        state.handshakeContext()->getHandshakeContext()->coalesce(),
+        certVerify.signature->coalesce());
+  }
 
+  Future<folly::Unit> verified = folly::unit;
   if (state.verifier()) {
-    try {
-      state.verifier()->verify(state.unverifiedCertChain());
-    } catch (const FizzException&) {
-      std::rethrow_exception(std::current_exception());
-    } catch (const std::exception& e) {
-      throw FizzVerificationException(
-          folly::to<std::string>("verifier failure: ", e.what()),
-          AlertDescription::bad_certificate);
+    auto asyncVerifier =
+        dynamic_cast<const AsyncCertificateVerifier*>(state.verifier().get());
+    if (asyncVerifier) {
+      verified = asyncVerifier->verifyFuture(state.unverifiedCertChain());
+    } else {
+      try {
+        CryptoPhaseTimer timer(
+            state.instrumentation(), CryptoPhase::Verification);
+        state.verifier()->verify(state.unverifiedCertChain());
+      } catch (const FizzException&) {
+        std::rethrow_exception(std::current_exception());
+      } catch (const std::exception& e) {
+        throw FizzVerificationException(
+            folly::to<std::string>("verifier failure: ", e.what()),
+            AlertDescription::bad_certificate);
+      }
     }
   }
 
-  state.handshakeContext()->appendToTranscript(*certVerify.originalEncoding);
+  return std::move(verified)
+      .via(state.executor())
+      .thenError([](folly::exception_wrapper ew) -> folly::Unit {
+        if (ew.get_exception<FizzException>()) {
+          ew.throw_exception();
+        }
+        throw FizzVerificationException(
+            folly::to<std::string>("verifier failure: ", ew.what()),
+            AlertDescription::bad_certificate);
+      })
+      .thenValue([&state,
+                  certVerify = std::move(certVerify),
+                  leaf = std::move(leaf)](folly::Unit) mutable {
+        state.handshakeContext()->appendToTranscript(
+            *certVerify.originalEncoding);
 
-  return actions(
-      [sigScheme = certVerify.algorithm,
-       serverCert = std::move(leaf)](State& newState) mutable {
-        newState.sigScheme() = sigScheme;
-        newState.serverCert() = std::move(serverCert);
-        newState.unverifiedCertChain() = folly::none;
-      },
-      &Transition<StateEnum::ExpectingFinished>);
+        return actions(
+            [sigScheme = certVerify.algorithm,
+             serverCert = std::move(leaf)](State& newState) mutable {
+              newState.sigScheme() = sigScheme;
+              newState.serverCert() = std::move(serverCert);
+              newState.unverifiedCertChain() = folly::none;
+            },
+            &Transition<StateEnum::ExpectingFinished>);
+      });
 }
 
-Actions
+AsyncActions
 EventHandler<ClientTypes, StateEnum::ExpectingFinished, Event::Finished>::
     handle(const State& state, Param param) {
   auto finished = std::move(boost::get<Finished>(param));
@@ -1605,10 +1724,9 @@ EventHandler<ClientTypes, StateEnum::ExpectingFinished, Event::Finished>::
         "data after finished", AlertDescription::unexpected_message);
   }
 
-  auto expectedFinished = state.handshakeContext()->getFinishedData(
-      state.serverHandshakeSecret()->coalesce());
-  if (!CryptoUtils::equal(
-          expectedFinished->coalesce(), finished.verify_data->coalesce())) {
+  if (!state.handshakeContext()->verifyFinishedData(
+          state.serverHandshakeSecret()->coalesce(),
+          finished.verify_data->coalesce())) {
     throw FizzException(
         "server finished verify failure", AlertDescription::bad_record_mac);
   }
@@ -1628,9 +1746,10 @@ EventHandler<ClientTypes, StateEnum::ExpectingFinished, Event::Finished>::
   }
 
   folly::Optional<Buf> encodedCertMessage;
-  folly::Optional<Buf> encodedCertVerify;
   auto auth = *state.clientAuthRequested();
   std::shared_ptr<const Cert> clientCert;
+  Future<Optional<Buf>> signature = folly::none;
+  Optional<SignatureScheme> sigScheme;
   switch (auth) {
     case ClientAuthType::Stored:
       clientCert = state.clientCert();
@@ -1641,19 +1760,24 @@ EventHandler<ClientTypes, StateEnum::ExpectingFinished, Event::Finished>::
       break;
     case ClientAuthType::Sent: {
       auto selectedCert = state.selectedClientCert();
-      encodedCertMessage = encodeHandshake(selectedCert->getCertMessage());
+      encodedCertMessage = selectedCert->getEncodedCertMessage();
       state.handshakeContext()->appendToTranscript(*encodedCertMessage);
 
-      auto sigScheme = *state.clientAuthSigScheme();
+      sigScheme = *state.clientAuthSigScheme();
       auto toSign = state.handshakeContext()->getHandshakeContext();
-      auto signature = selectedCert->sign(
-          sigScheme, CertificateVerifyContext::Client, toSign->coalesce());
-
-      CertificateVerify verify;
-      verify.algorithm = sigScheme;
-      verify.signature = std::move(signature);
-      encodedCertVerify = encodeHandshake(std::move(verify));
-      state.handshakeContext()->appendToTranscript(*encodedCertVerify);
+      auto asyncSelfCert =
+          dynamic_cast<const AsyncSelfCert*>(selectedCert.get());
+      {
+        CryptoPhaseTimer timer(
+            state.instrumentation(), CryptoPhase::Signing);
+        if (asyncSelfCert) {
+          signature = asyncSelfCert->signFuture(
+              *sigScheme, CertificateVerifyContext::Client, toSign->coalesce());
+        } else {
+          signature = selectedCert->sign(
+              *sigScheme, CertificateVerifyContext::Client, toSign->coalesce());
+        }
+      }
 
       clientCert = selectedCert;
       break;
@@ -1662,106 +1786,139 @@ EventHandler<ClientTypes, StateEnum::ExpectingFinished, Event::Finished>::
       break;
   }
 
-  auto exporterMasterVector = state.keyScheduler()->getSecret(
-      MasterSecrets::ExporterMaster, clientFinishedContext->coalesce());
-  auto exporterMaster =
-      folly::IOBuf::copyBuffer(folly::range(exporterMasterVector.secret));
-
-  auto encodedFinished = Protocol::getFinished(
-      state.clientHandshakeSecret()->coalesce(), *state.handshakeContext());
-  auto resumptionSecret = folly::IOBuf::copyBuffer(folly::range(
-      state.keyScheduler()
-          ->getSecret(
-              MasterSecrets::ResumptionMaster,
-              state.handshakeContext()->getHandshakeContext()->coalesce())
-          .secret));
-
-  WriteToSocket clientFlight;
-
-  bool sentCCS = state.sentCCS();
-  if (state.context()->getCompatibilityMode() && !sentCCS) {
-    TLSContent writeCCS;
-    writeCCS.encryptionLevel = EncryptionLevel::Plaintext;
-    writeCCS.contentType = ContentType::change_cipher_spec;
-    writeCCS.data = folly::IOBuf::wrapBuffer(FakeChangeCipherSpec);
-    clientFlight.contents.emplace_back(std::move(writeCCS));
-    sentCCS = true;
-  }
-
-  if (eoedWrite) {
-    clientFlight.contents.emplace_back(std::move(*eoedWrite));
-  }
-
-  if (auth == ClientAuthType::RequestedNoMatch) {
-    clientFlight.contents.emplace_back(state.writeRecordLayer()->writeHandshake(
-        std::move(*encodedCertMessage), std::move(encodedFinished)));
-  } else if (auth == ClientAuthType::Sent) {
-    clientFlight.contents.emplace_back(state.writeRecordLayer()->writeHandshake(
-        std::move(*encodedCertMessage),
-        std::move(*encodedCertVerify),
-        std::move(encodedFinished)));
-  } else {
-    clientFlight.contents.emplace_back(
-        state.writeRecordLayer()->writeHandshake(std::move(encodedFinished)));
-  }
-
-  state.keyScheduler()->deriveAppTrafficSecrets(
-      clientFinishedContext->coalesce());
-  state.keyScheduler()->clearMasterSecret();
-
-  auto writeRecordLayer =
-      state.context()->getFactory()->makeEncryptedWriteRecordLayer(
-          EncryptionLevel::AppTraffic);
-  writeRecordLayer->setProtocolVersion(*state.version());
-  auto writeSecret =
-      state.keyScheduler()->getSecret(AppTrafficSecrets::ClientAppTraffic);
-  Protocol::setAead(
-      *writeRecordLayer,
-      *state.cipher(),
-      folly::range(writeSecret.secret),
-      *state.context()->getFactory(),
-      *state.keyScheduler());
-
-  auto readRecordLayer =
-      state.context()->getFactory()->makeEncryptedReadRecordLayer(
-          EncryptionLevel::AppTraffic);
-  readRecordLayer->setProtocolVersion(*state.version());
-  auto readSecret =
-      state.keyScheduler()->getSecret(AppTrafficSecrets::ServerAppTraffic);
-  Protocol::setAead(
-      *readRecordLayer,
-      *state.cipher(),
-      folly::range(readSecret.secret),
-      *state.context()->getFactory(),
-      *state.keyScheduler());
-
-  ReportHandshakeSuccess reportSuccess;
-  reportSuccess.earlyDataAccepted =
-      state.earlyDataType() == EarlyDataType::Accepted;
+  return signature.via(state.executor())
+      .thenValue([&state,
+                  auth,
+                  sigScheme,
+                  encodedCertMessage = std::move(encodedCertMessage),
+                  eoedWrite = std::move(eoedWrite),
+                  clientCert = std::move(clientCert),
+                  clientFinishedContext = std::move(clientFinishedContext)](
+                     Optional<Buf> sig) mutable {
+        folly::Optional<Buf> encodedCertVerify;
+        if (sig) {
+          CertificateVerify verify;
+          verify.algorithm = *sigScheme;
+          verify.signature = std::move(*sig);
+          encodedCertVerify = encodeHandshake(std::move(verify));
+          state.handshakeContext()->appendToTranscript(*encodedCertVerify);
+        }
+
+        auto exporterMasterVector = state.keyScheduler()->getSecret(
+            MasterSecrets::ExporterMaster, clientFinishedContext->coalesce());
+        auto exporterMaster =
+            folly::IOBuf::copyBuffer(folly::range(exporterMasterVector.secret));
+
+        auto encodedFinished = Protocol::getFinished(
+            state.clientHandshakeSecret()->coalesce(),
+            *state.handshakeContext());
+        auto resumptionSecret = folly::IOBuf::copyBuffer(folly::range(
+            state.keyScheduler()
+                ->getSecret(
+                    MasterSecrets::ResumptionMaster,
+                    state.handshakeContext()->getHandshakeContext()->coalesce())
+                .secret));
+
+        WriteToSocket clientFlight;
+
+        bool sentCCS = state.sentCCS();
+        if (state.context()->getCompatibilityMode() && !sentCCS) {
+          TLSContent writeCCS;
+          writeCCS.encryptionLevel = EncryptionLevel::Plaintext;
+          writeCCS.contentType = ContentType::change_cipher_spec;
+          writeCCS.data = folly::IOBuf::wrapBuffer(FakeChangeCipherSpec);
+          clientFlight.contents.emplace_back(std::move(writeCCS));
+          sentCCS = true;
+        }
+
+        if (eoedWrite) {
+          clientFlight.contents.emplace_back(std::move(*eoedWrite));
+        }
+
+        if (auth == ClientAuthType::RequestedNoMatch) {
+          clientFlight.contents.emplace_back(
+              state.writeRecordLayer()->writeHandshake(
+                  std::move(*encodedCertMessage), std::move(encodedFinished)));
+        } else if (auth == ClientAuthType::Sent) {
+          clientFlight.contents.emplace_back(
+              state.writeRecordLayer()->writeHandshake(
+                  std::move(*encodedCertMessage),
+                  std::move(*encodedCertVerify),
+                  std::move(encodedFinished)));
+        } else {
+          clientFlight.contents.emplace_back(
+              state.writeRecordLayer()->writeHandshake(
+                  std::move(encodedFinished)));
+        }
+
+        state.keyScheduler()->deriveAppTrafficSecrets(
+            clientFinishedContext->coalesce());
+        state.keyScheduler()->clearMasterSecret();
+
+        auto writeRecordLayer =
+            state.context()->getFactory()->makeEncryptedWriteRecordLayer(
+                EncryptionLevel::AppTraffic);
+        writeRecordLayer->setProtocolVersion(*state.version());
+        writeRecordLayer->setRekeyThresholds(
+            state.context()->getRekeyAfterBytes(),
+            state.context()->getRekeyAfterRecords(),
+            state.context()->getRekeyJitter());
+        auto writeSecret = state.keyScheduler()->getSecret(
+            AppTrafficSecrets::ClientAppTraffic);
+        Protocol::setAead(
+            *writeRecordLayer,
+            *state.cipher(),
+            folly::range(writeSecret.secret),
+            *state.context()->getFactory(),
+            *state.keyScheduler());
+
+        auto readRecordLayer =
+            state.context()->getFactory()->makeEncryptedReadRecordLayer(
+                EncryptionLevel::AppTraffic);
+        readRecordLayer->setProtocolVersion(*state.version());
+        auto readSecret = state.keyScheduler()->getSecret(
+            AppTrafficSecrets::ServerAppTraffic);
+        Protocol::setAead(
+            *readRecordLayer,
+            *state.cipher(),
+            folly::range(readSecret.secret),
+            *state.context()->getFactory(),
+            *state.keyScheduler());
+
+        ReportHandshakeSuccess reportSuccess;
+        reportSuccess.earlyDataAccepted =
+            state.earlyDataType() == EarlyDataType::Accepted;
+
+        if (state.context()->getGroupMemoryCache() && state.sni() &&
+            state.group()) {
+          state.context()->getGroupMemoryCache()->putGroup(
+              *state.sni(), *state.group());
+        }
 
-  return actions(
-      [readRecordLayer = std::move(readRecordLayer),
-       writeRecordLayer = std::move(writeRecordLayer),
-       resumptionSecret = std::move(resumptionSecret),
-       exporterMaster = std::move(exporterMaster),
-       clientCert = std::move(clientCert),
-       sentCCS](State& newState) mutable {
-        newState.readRecordLayer() = std::move(readRecordLayer);
-        newState.writeRecordLayer() = std::move(writeRecordLayer);
-        newState.earlyWriteRecordLayer() = nullptr;
-        newState.clientHandshakeSecret() = folly::none;
-        newState.serverHandshakeSecret() = folly::none;
-        newState.resumptionSecret() = std::move(resumptionSecret);
-        newState.exporterMasterSecret() = std::move(exporterMaster);
-        newState.selectedClientCert() = nullptr;
-        newState.clientCert() = std::move(clientCert);
-        newState.sentCCS() = sentCCS;
-      },
-      &Transition<StateEnum::Established>,
-      SecretAvailable(std::move(readSecret)),
-      SecretAvailable(std::move(writeSecret)),
-      std::move(clientFlight),
-      std::move(reportSuccess));
+        return actions(
+            [readRecordLayer = std::move(readRecordLayer),
+             writeRecordLayer = std::move(writeRecordLayer),
+             resumptionSecret = std::move(resumptionSecret),
+             exporterMaster = std::move(exporterMaster),
+             clientCert = std::move(clientCert),
+             sentCCS](State& newState) mutable {
+              newState.readRecordLayer() = std::move(readRecordLayer);
+              newState.writeRecordLayer() = std::move(writeRecordLayer);
+              newState.earlyWriteRecordLayer() = nullptr;
+              newState.clientHandshakeSecret() = folly::none;
+              newState.serverHandshakeSecret() = folly::none;
+              newState.resumptionSecret() = std::move(resumptionSecret);
+              newState.exporterMasterSecret() = std::move(exporterMaster);
+              newState.selectedClientCert() = nullptr;
+              newState.clientCert() = std::move(clientCert);
+              newState.sentCCS() = sentCCS;
+            },
+            &Transition<StateEnum::Established>,
+            SecretAvailable(std::move(readSecret)),
+            SecretAvailable(std::move(writeSecret)),
+            std::move(clientFlight),
+            std::move(reportSuccess));
+      });
 }
 
 static uint32_t getMaxEarlyDataSize(const NewSessionTicket& nst) {
@@ -1773,7 +1930,7 @@ static uint32_t getMaxEarlyDataSize(const NewSessionTicket& nst) {
   }
 }
 
-Actions
+AsyncActions
 EventHandler<ClientTypes, StateEnum::Established, Event::NewSessionTicket>::
     handle(const State& state, Param param) {
   auto nst = std::move(boost::get<NewSessionTicket>(param));
@@ -1806,7 +1963,7 @@ EventHandler<ClientTypes, StateEnum::Established, Event::NewSessionTicket>::
   return actions(std::move(newCachedPsk));
 }
 
-Actions
+AsyncActions
 EventHandler<ClientTypes, StateEnum::Established, Event::AppData>::handle(
     const State&,
     Param param) {
@@ -1815,7 +1972,7 @@ EventHandler<ClientTypes, StateEnum::Established, Event::AppData>::handle(
   return actions(DeliverAppData{std::move(appData.data)});
 }
 
-Actions
+AsyncActions
 EventHandler<ClientTypes, StateEnum::Established, Event::AppWrite>::handle(
     const State& state,
     Param param) {
@@ -1827,10 +1984,35 @@ EventHandler<ClientTypes, StateEnum::Established, Event::AppWrite>::handle(
       state.writeRecordLayer()->writeAppData(std::move(appWrite.data)));
   write.flags = appWrite.flags;
 
+  if (state.writeRecordLayer()->rekeyRecommended()) {
+    // The current write key has reached its configured traffic limit. Append
+    // a key_update to this flight and rotate the write key in place.
+    auto encodedKeyUpdated =
+        Protocol::getKeyUpdated(KeyUpdateRequest::update_not_requested);
+    write.contents.emplace_back(
+        state.writeRecordLayer()->writeHandshake(std::move(encodedKeyUpdated)));
+
+    state.keyScheduler()->clientKeyUpdate();
+    auto writeSecret =
+        state.keyScheduler()->getSecret(AppTrafficSecrets::ClientAppTraffic);
+
+    MutateState rekeyWrite([secret = writeSecret.secret](State& newState) {
+      Protocol::rekeyRecordLayer(
+          *newState.writeRecordLayer(),
+          *newState.keyScheduler(),
+          folly::range(secret));
+    });
+
+    return actions(
+        std::move(rekeyWrite),
+        SecretAvailable(std::move(writeSecret)),
+        std::move(write));
+  }
+
   return actions(std::move(write));
 }
 
-Actions
+AsyncActions
 EventHandler<ClientTypes, StateEnum::Established, Event::KeyUpdate>::handle(
     const State& state,
     Param param) {
@@ -1873,6 +2055,10 @@ EventHandler<ClientTypes, StateEnum::Established, Event::KeyUpdate>::handle(
       state.context()->getFactory()->makeEncryptedWriteRecordLayer(
           EncryptionLevel::AppTraffic);
   writeRecordLayer->setProtocolVersion(*state.version());
+  writeRecordLayer->setRekeyThresholds(
+      state.context()->getRekeyAfterBytes(),
+      state.context()->getRekeyAfterRecords(),
+      state.context()->getRekeyJitter());
   auto writeSecret =
       state.keyScheduler()->getSecret(AppTrafficSecrets::ClientAppTraffic);
   Protocol::setAead(
@@ -1893,6 +2079,36 @@ EventHandler<ClientTypes, StateEnum::Established, Event::KeyUpdate>::handle(
       std::move(write));
 }
 
+AsyncActions
+EventHandler<ClientTypes, StateEnum::Established, Event::KeyUpdateInitiation>::
+    handle(const State& state, Param param) {
+  auto& keyUpdateInitiation = boost::get<KeyUpdateInitiation>(param);
+
+  auto encodedKeyUpdated =
+      Protocol::getKeyUpdated(keyUpdateInitiation.request_update);
+  WriteToSocket write;
+  write.contents.emplace_back(
+      state.writeRecordLayer()->writeHandshake(std::move(encodedKeyUpdated)));
+
+  state.keyScheduler()->clientKeyUpdate();
+  auto writeSecret =
+      state.keyScheduler()->getSecret(AppTrafficSecrets::ClientAppTraffic);
+
+  // Rekey the existing write record layer in place rather than building a
+  // new record layer and aead.
+  MutateState rekeyWrite([secret = writeSecret.secret](State& newState) {
+    Protocol::rekeyRecordLayer(
+        *newState.writeRecordLayer(),
+        *newState.keyScheduler(),
+        folly::range(secret));
+  });
+
+  return actions(
+      std::move(rekeyWrite),
+      SecretAvailable(std::move(writeSecret)),
+      std::move(write));
+}
+
 // If we get an early data write after early data has been rejected we won't
 // bother writing the data out but we can't just throw away the data without
 // invoking a method on the write callback. Since the proper write callback
@@ -1946,7 +2162,7 @@ static Actions handleEarlyAppWrite(const State& state, EarlyAppWrite appWrite) {
   LOG(FATAL) << "Bad EarlyDataType";
 }
 
-Actions EventHandler<
+AsyncActions EventHandler<
     ClientTypes,
     StateEnum::ExpectingServerHello,
     Event::EarlyAppWrite>::handle(const State& state, Param param) {
@@ -1954,7 +2170,7 @@ Actions EventHandler<
       state, std::move(boost::get<EarlyAppWrite>(param)));
 }
 
-Actions EventHandler<
+AsyncActions EventHandler<
     ClientTypes,
     StateEnum::ExpectingEncryptedExtensions,
     Event::EarlyAppWrite>::handle(const State& state, Param param) {
@@ -1962,7 +2178,7 @@ Actions EventHandler<
       state, std::move(boost::get<EarlyAppWrite>(param)));
 }
 
-Actions EventHandler<
+AsyncActions EventHandler<
     ClientTypes,
     StateEnum::ExpectingCertificate,
     Event::EarlyAppWrite>::handle(const State& state, Param param) {
@@ -1970,7 +2186,7 @@ Actions EventHandler<
       state, std::move(boost::get<EarlyAppWrite>(param)));
 }
 
-Actions EventHandler<
+AsyncActions EventHandler<
     ClientTypes,
     StateEnum::ExpectingCertificateVerify,
     Event::EarlyAppWrite>::handle(const State& state, Param param) {
@@ -1978,14 +2194,14 @@ Actions EventHandler<
       state, std::move(boost::get<EarlyAppWrite>(param)));
 }
 
-Actions
+AsyncActions
 EventHandler<ClientTypes, StateEnum::ExpectingFinished, Event::EarlyAppWrite>::
     handle(const State& state, Param param) {
   return handleEarlyAppWrite(
       state, std::move(boost::get<EarlyAppWrite>(param)));
 }
 
-Actions
+AsyncActions
 EventHandler<ClientTypes, StateEnum::Established, Event::EarlyAppWrite>::handle(
     const State& state,
     Param param) {
@@ -2006,7 +2222,7 @@ EventHandler<ClientTypes, StateEnum::Established, Event::EarlyAppWrite>::handle(
   }
 }
 
-Actions
+AsyncActions
 EventHandler<ClientTypes, StateEnum::Established, Event::CloseNotify>::handle(
     const State& state,
     Param param) {
@@ -2029,7 +2245,7 @@ EventHandler<ClientTypes, StateEnum::Established, Event::CloseNotify>::handle(
       std::move(eod));
 }
 
-Actions
+AsyncActions
 EventHandler<ClientTypes, StateEnum::ExpectingCloseNotify, Event::CloseNotify>::
     handle(const State& state, Param param) {
   ensureNoUnparsedHandshakeData(state, Event::CloseNotify);
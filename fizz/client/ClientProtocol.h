@@ -20,28 +20,34 @@ namespace client {
 class ClientStateMachine {
  public:
   using StateType = State;
-  using ProcessingActions = Actions;
+  using ProcessingActions = AsyncActions;
   using CompletedActions = Actions;
+  using ReportSuccess = ReportHandshakeSuccess;
 
   virtual ~ClientStateMachine() = default;
 
-  virtual Actions processConnect(
+  virtual AsyncActions processConnect(
       const State&,
+      folly::Executor* executor,
       std::shared_ptr<const FizzClientContext> context,
       std::shared_ptr<const CertificateVerifier> verifier,
       folly::Optional<std::string> sni,
       folly::Optional<CachedPsk> cachedPsk,
       const std::shared_ptr<ClientExtensions>& extensions);
 
-  virtual Actions processSocketData(const State&, folly::IOBufQueue&);
+  virtual AsyncActions processSocketData(const State&, folly::IOBufQueue&);
 
-  virtual Actions processWriteNewSessionTicket(
+  virtual AsyncActions processWriteNewSessionTicket(
       const State&,
       WriteNewSessionTicket);
 
-  virtual Actions processAppWrite(const State&, AppWrite);
+  virtual AsyncActions processAppWrite(const State&, AppWrite);
 
-  virtual Actions processEarlyAppWrite(const State&, EarlyAppWrite);
+  virtual AsyncActions processEarlyAppWrite(const State&, EarlyAppWrite);
+
+  virtual AsyncActions processKeyUpdateInitiation(
+      const State&,
+      KeyUpdateInitiation);
 
   virtual Actions processAppClose(const State&);
 
@@ -50,7 +56,7 @@ class ClientStateMachine {
 
 namespace detail {
 
-Actions processEvent(const State& state, Param param);
+AsyncActions processEvent(const State& state, Param param);
 
 Actions handleError(
     const State& state,
@@ -68,7 +74,7 @@ struct ClientTypes {
   using StateEnum = fizz::client::StateEnum;
   using Event = fizz::Event;
   using Param = fizz::Param;
-  using Actions = fizz::client::Actions;
+  using Actions = fizz::client::AsyncActions;
   static constexpr auto NumStates =
       static_cast<std::size_t>(fizz::client::StateEnum::NUM_STATES);
   static constexpr auto NumEvents = static_cast<std::size_t>(Event::NUM_EVENTS);
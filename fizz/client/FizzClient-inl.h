@@ -11,6 +11,7 @@ namespace client {
 
 template <typename ActionMoveVisitor, typename SM>
 void FizzClient<ActionMoveVisitor, SM>::connect(
+    folly::Executor* executor,
     std::shared_ptr<const FizzClientContext> context,
     std::shared_ptr<const CertificateVerifier> verifier,
     folly::Optional<std::string> sni,
@@ -18,6 +19,7 @@ void FizzClient<ActionMoveVisitor, SM>::connect(
     const std::shared_ptr<ClientExtensions>& extensions) {
   this->addProcessingActions(this->machine_.processConnect(
       this->state_,
+      executor,
       std::move(context),
       std::move(verifier),
       std::move(sni),
@@ -27,10 +29,12 @@ void FizzClient<ActionMoveVisitor, SM>::connect(
 
 template <typename ActionMoveVisitor, typename SM>
 void FizzClient<ActionMoveVisitor, SM>::connect(
+    folly::Executor* executor,
     std::shared_ptr<const FizzClientContext> context,
     folly::Optional<std::string> hostname) {
   const auto pskIdentity = hostname;
   connect(
+      executor,
       std::move(context),
       std::make_shared<DefaultCertificateVerifier>(VerificationContext::Client),
       std::move(hostname),
@@ -56,8 +60,22 @@ Buf FizzClient<ActionMoveVisitor, SM>::getEarlyEkm(
 }
 
 template <typename ActionMoveVisitor, typename SM>
-void FizzClient<ActionMoveVisitor, SM>::startActions(Actions actions) {
-  this->processActions(std::move(actions));
+void FizzClient<ActionMoveVisitor, SM>::startActions(AsyncActions actions) {
+  folly::variant_match(
+      actions,
+      ::fizz::detail::result_type<void>(),
+      [this](folly::Future<Actions>& futureActions) {
+        std::move(futureActions)
+            .then(
+                &FizzClient::processActions,
+                static_cast<FizzBase<
+                    FizzClient<ActionMoveVisitor, SM>,
+                    ActionMoveVisitor,
+                    SM>*>(this));
+      },
+      [this](Actions& immediateActions) {
+        this->processActions(std::move(immediateActions));
+      });
 }
 } // namespace client
 } // namespace fizz
@@ -27,6 +27,7 @@ class FizzClient : public FizzBase<
       FizzBase;
 
   void connect(
+      folly::Executor* executor,
       std::shared_ptr<const FizzClientContext> context,
       std::shared_ptr<const CertificateVerifier> verifier,
       folly::Optional<std::string> sni,
@@ -37,6 +38,7 @@ class FizzClient : public FizzBase<
    * Uses the default verifier to verify certificates
    */
   void connect(
+      folly::Executor* executor,
       std::shared_ptr<const FizzClientContext> context,
       folly::Optional<std::string> hostname);
 
@@ -56,7 +58,7 @@ class FizzClient : public FizzBase<
       ActionMoveVisitor,
       SM>;
 
-  void startActions(Actions actions);
+  void startActions(AsyncActions actions);
 };
 } // namespace client
 } // namespace fizz
@@ -8,12 +8,15 @@
 
 #pragma once
 
+#include <fizz/client/GroupMemoryCache.h>
 #include <fizz/client/PskCache.h>
+#include <fizz/crypto/CpuFeatures.h>
 #include <fizz/protocol/CertDecompressionManager.h>
 #include <fizz/protocol/Certificate.h>
 #include <fizz/protocol/Factory.h>
 #include <fizz/protocol/OpenSSLFactory.h>
 #include <fizz/protocol/clock/SystemClock.h>
+#include <fizz/record/Extensions.h>
 #include <fizz/record/Types.h>
 
 namespace fizz {
@@ -23,9 +26,14 @@ class FizzClientContext {
  public:
   FizzClientContext()
       : factory_(std::make_shared<OpenSSLFactory>()),
-        clock_(std::make_shared<SystemClock>()) {}
+        clock_(std::make_shared<SystemClock>()) {
+    rebuildPrecomputedExtensions();
+  }
   FizzClientContext(std::shared_ptr<Factory> factory)
-      : factory_(std::move(factory)), clock_(std::make_shared<SystemClock>()) {}
+      : factory_(std::move(factory)),
+        clock_(std::make_shared<SystemClock>()) {
+    rebuildPrecomputedExtensions();
+  }
   virtual ~FizzClientContext() = default;
 
   /**
@@ -33,6 +41,7 @@ class FizzClientContext {
    */
   void setSupportedVersions(std::vector<ProtocolVersion> versions) {
     supportedVersions_ = std::move(versions);
+    rebuildPrecomputedExtensions();
   }
 
   const auto& getSupportedVersions() const {
@@ -55,6 +64,7 @@ class FizzClientContext {
    */
   void setSupportedSigSchemes(std::vector<SignatureScheme> schemes) {
     supportedSigSchemes_ = std::move(schemes);
+    rebuildPrecomputedExtensions();
   }
 
   const auto& getSupportedSigSchemes() const {
@@ -66,6 +76,7 @@ class FizzClientContext {
    */
   void setSupportedGroups(std::vector<NamedGroup> groups) {
     supportedGroups_ = std::move(groups);
+    rebuildPrecomputedExtensions();
   }
 
   const auto& getSupportedGroups() const {
@@ -82,11 +93,24 @@ class FizzClientContext {
     return defaultShares_;
   }
 
+  /**
+   * Set a cache recording which group each destination negotiated. When
+   * set, connections without a cached PSK send only the remembered
+   * group's share rather than the full default share list.
+   */
+  void setGroupMemoryCache(std::shared_ptr<GroupMemoryCache> cache) {
+    groupMemoryCache_ = std::move(cache);
+  }
+  const auto& getGroupMemoryCache() const {
+    return groupMemoryCache_;
+  }
+
   /**
    * Set the supported psk modes, in preference order.
    */
   void setSupportedPskModes(std::vector<PskKeyExchangeMode> modes) {
     supportedPskModes_ = std::move(modes);
+    rebuildPrecomputedExtensions();
   }
 
   const auto& getSupportedPskModes() const {
@@ -98,6 +122,7 @@ class FizzClientContext {
    */
   void setSupportedAlpns(std::vector<std::string> protocols) {
     supportedAlpns_ = std::move(protocols);
+    rebuildPrecomputedExtensions();
   }
 
   const auto& getSupportedAlpns() const {
@@ -142,6 +167,41 @@ class FizzClientContext {
     }
   }
 
+  /**
+   * Registers a static external PSK, offered on connects that do not
+   * supply a cached PSK of their own. The early secret and binder key for
+   * the PSK are computed once here and cached, so per-connection
+   * handshakes skip the early key schedule entirely. The PSK is offered
+   * for TLS 1.3 with the given cipher.
+   */
+  void setExternalPsk(
+      std::string identity,
+      std::string secret,
+      CipherSuite cipher) {
+    CachedPsk psk;
+    psk.psk = std::move(identity);
+    psk.secret = std::move(secret);
+    psk.type = PskType::External;
+    psk.version = ProtocolVersion::tls_1_3;
+    psk.cipher = cipher;
+    psk.ticketAgeAdd = 0;
+
+    auto scheduler = factory_->makeKeyScheduler(cipher);
+    scheduler->deriveEarlySecret(folly::range(psk.secret));
+    psk.cachedEarlySecret = scheduler->getEarlySecret();
+    auto handshakeContext = factory_->makeHandshakeContext(cipher);
+    psk.cachedBinderKey = scheduler
+                              ->getSecret(
+                                  EarlySecrets::ExternalPskBinder,
+                                  handshakeContext->getBlankContext())
+                              .secret;
+    externalPsk_ = std::move(psk);
+  }
+
+  const folly::Optional<CachedPsk>& getExternalPsk() const {
+    return externalPsk_;
+  }
+
   /**
    * Sets whether we should attempt to send early data.
    */
@@ -182,6 +242,7 @@ class FizzClientContext {
   void setCertDecompressionManager(
       std::shared_ptr<CertDecompressionManager> mgr) {
     certDecompressionManager_ = mgr;
+    rebuildPrecomputedExtensions();
   }
 
   /**
@@ -210,6 +271,26 @@ class FizzClientContext {
     }
   }
 
+  /**
+   * ClientHello extensions whose encoding depends only on context
+   * configuration, serialized once when the corresponding setting
+   * changes. Connections clone the encoded bytes instead of re-encoding
+   * the extension per ClientHello. The optional members are absent when
+   * the corresponding setting is empty and the extension is not sent.
+   */
+  struct PrecomputedExtensions {
+    Extension supportedVersions;
+    Extension supportedGroups;
+    Extension sigSchemes;
+    folly::Optional<Extension> alpns;
+    folly::Optional<Extension> pskModes;
+    folly::Optional<Extension> certCompression;
+  };
+
+  const PrecomputedExtensions& getPrecomputedExtensions() const {
+    return precomputedExtensions_;
+  }
+
   /**
    * Whether to omit the early record layer when sending early data. This will
    * also omit the EndOfEarlyData message.
@@ -242,23 +323,95 @@ class FizzClientContext {
     return clock_;
   }
 
+  /**
+   * Sets limits on the amount of traffic written under a single traffic key,
+   * as plaintext bytes and records. Once either limit is reached the state
+   * machine automatically sends a KeyUpdate and rotates its write key. A
+   * limit of 0 disables that limit; by default automatic rekeying is off.
+   * jitter (in [0, 1)) randomly lowers each connection's effective limits by
+   * up to that fraction so that connections do not rekey in lockstep.
+   */
+  void setRekeyAfterWriting(
+      uint64_t maxBytes,
+      uint64_t maxRecords,
+      double jitter = 0.0) {
+    rekeyAfterBytes_ = maxBytes;
+    rekeyAfterRecords_ = maxRecords;
+    rekeyJitter_ = jitter;
+  }
+  uint64_t getRekeyAfterBytes() const {
+    return rekeyAfterBytes_;
+  }
+  uint64_t getRekeyAfterRecords() const {
+    return rekeyAfterRecords_;
+  }
+  double getRekeyJitter() const {
+    return rekeyJitter_;
+  }
+
  private:
+  void rebuildPrecomputedExtensions() {
+    SupportedVersions versions;
+    versions.versions = supportedVersions_;
+    precomputedExtensions_.supportedVersions = encodeExtension(versions);
+
+    SupportedGroups groups;
+    groups.named_group_list = supportedGroups_;
+    precomputedExtensions_.supportedGroups = encodeExtension(groups);
+
+    SignatureAlgorithms sigAlgs;
+    sigAlgs.supported_signature_algorithms = supportedSigSchemes_;
+    precomputedExtensions_.sigSchemes = encodeExtension(sigAlgs);
+
+    if (!supportedAlpns_.empty()) {
+      ProtocolNameList alpn;
+      for (const auto& protoName : supportedAlpns_) {
+        ProtocolName proto;
+        proto.name = folly::IOBuf::copyBuffer(protoName);
+        alpn.protocol_name_list.push_back(std::move(proto));
+      }
+      precomputedExtensions_.alpns = encodeExtension(alpn);
+    } else {
+      precomputedExtensions_.alpns = folly::none;
+    }
+
+    if (!supportedPskModes_.empty()) {
+      PskKeyExchangeModes modes;
+      modes.modes = supportedPskModes_;
+      precomputedExtensions_.pskModes = encodeExtension(modes);
+    } else {
+      precomputedExtensions_.pskModes = folly::none;
+    }
+
+    auto compressionAlgos = getSupportedCertDecompressionAlgorithms();
+    if (!compressionAlgos.empty()) {
+      CertificateCompressionAlgorithms algos;
+      algos.algorithms = std::move(compressionAlgos);
+      precomputedExtensions_.certCompression = encodeExtension(algos);
+    } else {
+      precomputedExtensions_.certCompression = folly::none;
+    }
+  }
+
   std::shared_ptr<Factory> factory_;
 
   std::vector<ProtocolVersion> supportedVersions_ = {ProtocolVersion::tls_1_3};
-  std::vector<CipherSuite> supportedCiphers_ = {
+  // The default preference order is adjusted for this CPU: without
+  // hardware AES support ChaCha is moved to the front.
+  std::vector<CipherSuite> supportedCiphers_ = CpuFeatures::orderCiphers({
       CipherSuite::TLS_AES_128_GCM_SHA256,
       CipherSuite::TLS_AES_256_GCM_SHA384,
 #if FOLLY_OPENSSL_HAS_CHACHA
       CipherSuite::TLS_CHACHA20_POLY1305_SHA256,
 #endif // FOLLY_OPENSSL_HAS_CHACHA
-  };
+  });
   std::vector<SignatureScheme> supportedSigSchemes_ = {
       SignatureScheme::ecdsa_secp256r1_sha256,
       SignatureScheme::rsa_pss_sha256};
   std::vector<NamedGroup> supportedGroups_ = {NamedGroup::x25519,
                                               NamedGroup::secp256r1};
   std::vector<NamedGroup> defaultShares_ = {NamedGroup::x25519};
+  std::shared_ptr<GroupMemoryCache> groupMemoryCache_;
   std::vector<PskKeyExchangeMode> supportedPskModes_ = {
       PskKeyExchangeMode::psk_dhe_ke,
       PskKeyExchangeMode::psk_ke};
@@ -270,11 +423,18 @@ class FizzClientContext {
   bool omitEarlyRecordLayer_{false};
 
   std::shared_ptr<PskCache> pskCache_;
+  folly::Optional<CachedPsk> externalPsk_;
   std::shared_ptr<const SelfCert> clientCert_;
   std::shared_ptr<CertDecompressionManager> certDecompressionManager_;
   std::shared_ptr<Clock> clock_;
 
   std::chrono::seconds maxPskHandshakeLife_{std::chrono::hours(168)};
+
+  uint64_t rekeyAfterBytes_{0};
+  uint64_t rekeyAfterRecords_{0};
+  double rekeyJitter_{0.0};
+
+  PrecomputedExtensions precomputedExtensions_;
 };
 } // namespace client
 } // namespace fizz
@@ -0,0 +1,81 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/record/Types.h>
+#include <folly/Synchronized.h>
+#include <unordered_map>
+
+namespace fizz {
+namespace client {
+
+/**
+ * Cache recording which named group each destination negotiated, keyed by
+ * SNI like PskCache. When set on the context it is consulted on Connect so
+ * that only the remembered group's share is generated instead of the full
+ * default share list, avoiding redundant key generation against servers
+ * whose group preference is already known. A wrong prediction costs at most
+ * one HelloRetryRequest, after which the newly negotiated group is
+ * recorded.
+ */
+class GroupMemoryCache {
+ public:
+  virtual ~GroupMemoryCache() = default;
+
+  /**
+   * Retrieve the group last negotiated with the specified destination.
+   */
+  virtual folly::Optional<NamedGroup> getGroup(
+      const std::string& destination) = 0;
+
+  /**
+   * Record the group negotiated with destination.
+   */
+  virtual void putGroup(const std::string& destination, NamedGroup group) = 0;
+
+  /**
+   * Remove any recorded group for destination.
+   */
+  virtual void removeGroup(const std::string& destination) = 0;
+};
+
+/**
+ * Basic group memory cache that stores groups in a synchronized hash map.
+ * There is no bound on the size of this cache.
+ */
+class BasicGroupMemoryCache : public GroupMemoryCache {
+ public:
+  ~BasicGroupMemoryCache() override = default;
+
+  folly::Optional<NamedGroup> getGroup(
+      const std::string& destination) override {
+    auto map = cache_.rlock();
+    auto result = map->find(destination);
+    if (result != map->end()) {
+      return result->second;
+    } else {
+      return folly::none;
+    }
+  }
+
+  void putGroup(const std::string& destination, NamedGroup group) override {
+    auto map = cache_.wlock();
+    (*map)[destination] = group;
+  }
+
+  void removeGroup(const std::string& destination) override {
+    auto map = cache_.wlock();
+    map->erase(destination);
+  }
+
+ private:
+  folly::Synchronized<std::unordered_map<std::string, NamedGroup>> cache_;
+};
+} // namespace client
+} // namespace fizz
@@ -0,0 +1,77 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/client/MultiTicketPskCache.h>
+
+namespace fizz {
+namespace client {
+
+constexpr size_t MultiTicketPskCache::kDefaultTicketsPerIdentity;
+
+MultiTicketPskCache::MultiTicketPskCache(size_t ticketsPerIdentity)
+    : ticketsPerIdentity_(ticketsPerIdentity) {
+  if (ticketsPerIdentity_ == 0) {
+    throw std::runtime_error("at least one ticket per identity required");
+  }
+}
+
+std::shared_ptr<MultiTicketPskCache::TicketQueue>
+MultiTicketPskCache::findQueue(const std::string& identity) const {
+  auto map = queues_.rlock();
+  auto it = map->find(identity);
+  return it == map->end() ? nullptr : it->second;
+}
+
+folly::Optional<CachedPsk> MultiTicketPskCache::getPsk(
+    const std::string& identity) {
+  if (checkNegativeEntry(identity)) {
+    countMiss();
+    return folly::none;
+  }
+  auto queue = findQueue(identity);
+  if (!queue) {
+    countMiss();
+    return folly::none;
+  }
+  CachedPsk psk;
+  while (queue->readIfNotEmpty(psk)) {
+    if (!isExpired(psk)) {
+      countHit();
+      return std::move(psk);
+    }
+    countExpired();
+  }
+  countMiss();
+  return folly::none;
+}
+
+void MultiTicketPskCache::putPsk(const std::string& identity, CachedPsk psk) {
+  clearNegativeEntry(identity);
+  auto queue = findQueue(identity);
+  if (!queue) {
+    auto map = queues_.wlock();
+    auto& slot = (*map)[identity];
+    if (!slot) {
+      slot = std::make_shared<TicketQueue>(ticketsPerIdentity_);
+    }
+    queue = slot;
+  }
+  // On a full ring drop the oldest ticket to make room for the new one.
+  while (!queue->writeIfNotFull(std::move(psk))) {
+    CachedPsk oldest;
+    if (queue->readIfNotEmpty(oldest)) {
+      countEviction();
+    }
+  }
+}
+
+void MultiTicketPskCache::removePsk(const std::string& identity) {
+  queues_.wlock()->erase(identity);
+}
+} // namespace client
+} // namespace fizz
@@ -0,0 +1,54 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/client/PskCache.h>
+#include <folly/MPMCQueue.h>
+
+namespace fizz {
+namespace client {
+
+/**
+ * PSK cache that holds a small ring of tickets per identity, consumed one
+ * per connection. Reusing a single ticket across concurrent connections
+ * links them observably on the wire; here every getPsk() dequeues a
+ * distinct ticket (the dequeue itself is lock free, only the identity
+ * lookup takes a shared lock), so resumption stays safe for high-fanout
+ * clients. The client state machine emits a NewCachedPsk per
+ * NewSessionTicket received, and each putPsk() call appends to the ring,
+ * evicting the oldest ticket once the ring is full. Expired tickets are
+ * discarded on dequeue.
+ */
+class MultiTicketPskCache : public PskCache {
+ public:
+  static constexpr size_t kDefaultTicketsPerIdentity = 8;
+
+  explicit MultiTicketPskCache(
+      size_t ticketsPerIdentity = kDefaultTicketsPerIdentity);
+  ~MultiTicketPskCache() override = default;
+
+  folly::Optional<CachedPsk> getPsk(const std::string& identity) override;
+
+  void putPsk(const std::string& identity, CachedPsk psk) override;
+
+  void removePsk(const std::string& identity) override;
+
+ private:
+  using TicketQueue = folly::MPMCQueue<CachedPsk>;
+
+  std::shared_ptr<TicketQueue> findQueue(const std::string& identity) const;
+
+  size_t ticketsPerIdentity_;
+  folly::Synchronized<
+      std::unordered_map<std::string, std::shared_ptr<TicketQueue>>>
+      queues_;
+};
+
+} // namespace client
+} // namespace fizz
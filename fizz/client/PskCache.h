@@ -8,11 +8,17 @@
 
 #pragma once
 
+#include <fizz/crypto/Secret.h>
 #include <fizz/protocol/Certificate.h>
 #include <fizz/protocol/Types.h>
+#include <fizz/protocol/clock/SystemClock.h>
 #include <fizz/record/Types.h>
+#include <folly/Synchronized.h>
 #include <chrono>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace fizz {
 namespace client {
@@ -35,6 +41,27 @@ struct CachedPsk {
   std::chrono::system_clock::time_point ticketIssueTime;
   std::chrono::system_clock::time_point ticketExpirationTime;
   std::chrono::system_clock::time_point ticketHandshakeTime;
+
+  // Early key schedule state precomputed at configuration time for static
+  // external PSKs; empty for resumption PSKs. When set, handshakes seed
+  // the key scheduler with these instead of rederiving the early secret
+  // and binder key per connection.
+  SecretStorage cachedEarlySecret;
+  SecretStorage cachedBinderKey;
+};
+
+/**
+ * Counter hooks for PSK cache observability. Implementations are invoked
+ * inline from cache operations and must be cheap and thread safe.
+ */
+class PskCacheStats {
+ public:
+  virtual ~PskCacheStats() = default;
+
+  virtual void hit() = 0;
+  virtual void miss() = 0;
+  virtual void eviction() = 0;
+  virtual void expiredEntry() = 0;
 };
 
 class PskCache {
@@ -55,6 +82,121 @@ class PskCache {
    * Remove any PSKs associated with identity from the cache.
    */
   virtual void removePsk(const std::string& identity) = 0;
+
+  /**
+   * Retrieve PSKs for several identities at once, returned in the same
+   * order. The default implementation performs one getPsk() per identity;
+   * caches backed by remote or locked storage can override it to answer
+   * the batch in a single round trip.
+   */
+  virtual std::vector<folly::Optional<CachedPsk>> getPsks(
+      const std::vector<std::string>& identities) {
+    std::vector<folly::Optional<CachedPsk>> psks;
+    psks.reserve(identities.size());
+    for (const auto& identity : identities) {
+      psks.push_back(getPsk(identity));
+    }
+    return psks;
+  }
+
+  /**
+   * Add several PSKs to the cache at once. The default implementation
+   * performs one putPsk() per entry.
+   */
+  virtual void putPsks(std::vector<std::pair<std::string, CachedPsk>> psks) {
+    for (auto& entry : psks) {
+      putPsk(entry.first, std::move(entry.second));
+    }
+  }
+
+  /**
+   * Serialize the cache contents into a compact binary blob that can be
+   * persisted across process restarts and restored with loadPsks(),
+   * keeping 0-RTT/PSK resumption warm across deploys. The default
+   * implementation does not support persistence and returns nullptr;
+   * implementations able to enumerate their entries should override it.
+   */
+  virtual Buf savePsks() {
+    return nullptr;
+  }
+
+  /**
+   * Restore PSKs serialized with savePsks() into this cache via putPsk.
+   * Unreadable entries are skipped.
+   */
+  virtual void loadPsks(Buf serialized);
+
+  /**
+   * Set a stats object counting hits, misses, evictions and expired
+   * entries.
+   */
+  void setStats(std::shared_ptr<PskCacheStats> stats) {
+    stats_ = std::move(stats);
+  }
+
+  /**
+   * Set the clock used to detect expired entries.
+   */
+  void setClock(std::shared_ptr<Clock> clock) {
+    clock_ = std::move(clock);
+  }
+
+  /**
+   * Mark identity as known not to support resumption, for example after a
+   * handshake where the server issued no ticket. getPsk() then reports a
+   * miss without consulting the underlying store until a PSK is stored
+   * for the identity again. The set only grows when the caller opts in by
+   * invoking this.
+   */
+  void putNegativeEntry(const std::string& identity) {
+    negativeEntries_.wlock()->insert(identity);
+  }
+
+ protected:
+  bool checkNegativeEntry(const std::string& identity) const {
+    auto negativeEntries = negativeEntries_.rlock();
+    return !negativeEntries->empty() &&
+        negativeEntries->count(identity) != 0;
+  }
+
+  void clearNegativeEntry(const std::string& identity) {
+    if (!negativeEntries_.rlock()->empty()) {
+      negativeEntries_.wlock()->erase(identity);
+    }
+  }
+
+  bool isExpired(const CachedPsk& psk) const {
+    return clock_->getCurrentTime() >= psk.ticketExpirationTime;
+  }
+
+  void countHit() const {
+    if (stats_) {
+      stats_->hit();
+    }
+  }
+
+  void countMiss() const {
+    if (stats_) {
+      stats_->miss();
+    }
+  }
+
+  void countEviction() const {
+    if (stats_) {
+      stats_->eviction();
+    }
+  }
+
+  void countExpired() const {
+    if (stats_) {
+      stats_->expiredEntry();
+    }
+  }
+
+ private:
+  std::shared_ptr<PskCacheStats> stats_;
+  std::shared_ptr<Clock> clock_ = std::make_shared<SystemClock>();
+  folly::Synchronized<std::unordered_set<std::string>> negativeEntries_;
 };
 
 /**
@@ -66,15 +208,26 @@ class BasicPskCache : public PskCache {
   ~BasicPskCache() override = default;
 
   folly::Optional<CachedPsk> getPsk(const std::string& identity) override {
+    if (checkNegativeEntry(identity)) {
+      countMiss();
+      return folly::none;
+    }
     auto result = cache_.find(identity);
-    if (result != cache_.end()) {
-      return result->second;
-    } else {
+    if (result == cache_.end()) {
+      countMiss();
       return folly::none;
     }
+    if (isExpired(result->second)) {
+      cache_.erase(result);
+      countExpired();
+      return folly::none;
+    }
+    countHit();
+    return result->second;
   }
 
   void putPsk(const std::string& identity, CachedPsk psk) override {
+    clearNegativeEntry(identity);
     cache_[identity] = std::move(psk);
   }
 
@@ -82,6 +235,8 @@ class BasicPskCache : public PskCache {
     cache_.erase(identity);
   }
 
+  Buf savePsks() override;
+
  private:
   std::unordered_map<std::string, CachedPsk> cache_;
 };
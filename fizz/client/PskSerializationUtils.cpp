@@ -0,0 +1,193 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/client/PskSerializationUtils.h>
+
+#include <folly/ssl/OpenSSLCertUtils.h>
+
+namespace fizz {
+namespace client {
+
+namespace {
+enum class PskCertStorage : uint8_t {
+  None = 0,
+  X509 = 1,
+  IdentityOnly = 2,
+};
+
+void writeCert(
+    const std::shared_ptr<const Cert>& cert,
+    folly::io::Appender& appender) {
+  if (!cert) {
+    fizz::detail::write(PskCertStorage::None, appender);
+  } else if (cert->getX509()) {
+    fizz::detail::write(PskCertStorage::X509, appender);
+    auto der = folly::ssl::OpenSSLCertUtils::derEncode(*cert->getX509());
+    fizz::detail::writeBuf<uint16_t>(der, appender);
+  } else {
+    fizz::detail::write(PskCertStorage::IdentityOnly, appender);
+    auto identity = folly::IOBuf::copyBuffer(cert->getIdentity());
+    fizz::detail::writeBuf<uint16_t>(identity, appender);
+  }
+}
+
+std::shared_ptr<const Cert> readCert(folly::io::Cursor& cursor) {
+  PskCertStorage storage;
+  fizz::detail::read(storage, cursor);
+  switch (storage) {
+    case PskCertStorage::None:
+      return nullptr;
+    case PskCertStorage::X509: {
+      Buf der;
+      fizz::detail::readBuf<uint16_t>(der, cursor);
+      return CertUtils::makePeerCert(std::move(der));
+    }
+    case PskCertStorage::IdentityOnly: {
+      Buf identity;
+      fizz::detail::readBuf<uint16_t>(identity, cursor);
+      return std::make_shared<const IdentityCert>(
+          identity->moveToFbString().toStdString());
+    }
+  }
+  throw std::runtime_error("unknown cert storage");
+}
+
+void writeTime(
+    std::chrono::system_clock::time_point time,
+    folly::io::Appender& appender) {
+  uint64_t seconds = std::chrono::duration_cast<std::chrono::seconds>(
+                         time.time_since_epoch())
+                         .count();
+  fizz::detail::write(seconds, appender);
+}
+
+std::chrono::system_clock::time_point readTime(folly::io::Cursor& cursor) {
+  uint64_t seconds;
+  fizz::detail::read(seconds, cursor);
+  return std::chrono::time_point<std::chrono::system_clock>(
+      std::chrono::seconds(seconds));
+}
+} // namespace
+
+Buf serializePsk(const CachedPsk& psk) {
+  auto capacity = psk.psk.size() + psk.secret.size() + 64;
+  auto buf = folly::IOBuf::create(capacity);
+  folly::io::Appender appender(buf.get(), capacity);
+
+  auto pskBuf = folly::IOBuf::wrapBuffer(folly::StringPiece(psk.psk));
+  fizz::detail::writeBuf<uint16_t>(pskBuf, appender);
+  auto secretBuf = folly::IOBuf::wrapBuffer(folly::StringPiece(psk.secret));
+  fizz::detail::writeBuf<uint16_t>(secretBuf, appender);
+  fizz::detail::write(static_cast<uint8_t>(psk.type), appender);
+  fizz::detail::write(psk.version, appender);
+  fizz::detail::write(psk.cipher, appender);
+  if (psk.group) {
+    fizz::detail::write(static_cast<uint8_t>(1), appender);
+    fizz::detail::write(*psk.group, appender);
+  } else {
+    fizz::detail::write(static_cast<uint8_t>(0), appender);
+  }
+  writeCert(psk.serverCert, appender);
+  writeCert(psk.clientCert, appender);
+  fizz::detail::write(psk.maxEarlyDataSize, appender);
+  if (psk.alpn) {
+    auto alpnBuf = folly::IOBuf::copyBuffer(*psk.alpn);
+    fizz::detail::write(static_cast<uint8_t>(1), appender);
+    fizz::detail::writeBuf<uint8_t>(alpnBuf, appender);
+  } else {
+    fizz::detail::write(static_cast<uint8_t>(0), appender);
+  }
+  fizz::detail::write(psk.ticketAgeAdd, appender);
+  writeTime(psk.ticketIssueTime, appender);
+  writeTime(psk.ticketExpirationTime, appender);
+  writeTime(psk.ticketHandshakeTime, appender);
+
+  return buf;
+}
+
+CachedPsk deserializePsk(Buf serialized) {
+  folly::io::Cursor cursor(serialized.get());
+  CachedPsk psk;
+
+  Buf pskBuf;
+  fizz::detail::readBuf<uint16_t>(pskBuf, cursor);
+  psk.psk = pskBuf->moveToFbString().toStdString();
+  Buf secretBuf;
+  fizz::detail::readBuf<uint16_t>(secretBuf, cursor);
+  psk.secret = secretBuf->moveToFbString().toStdString();
+  uint8_t type;
+  fizz::detail::read(type, cursor);
+  psk.type = static_cast<PskType>(type);
+  fizz::detail::read(psk.version, cursor);
+  fizz::detail::read(psk.cipher, cursor);
+  uint8_t hasGroup;
+  fizz::detail::read(hasGroup, cursor);
+  if (hasGroup) {
+    NamedGroup group;
+    fizz::detail::read(group, cursor);
+    psk.group = group;
+  }
+  psk.serverCert = readCert(cursor);
+  psk.clientCert = readCert(cursor);
+  fizz::detail::read(psk.maxEarlyDataSize, cursor);
+  uint8_t hasAlpn;
+  fizz::detail::read(hasAlpn, cursor);
+  if (hasAlpn) {
+    Buf alpnBuf;
+    fizz::detail::readBuf<uint8_t>(alpnBuf, cursor);
+    psk.alpn = alpnBuf->moveToFbString().toStdString();
+  }
+  fizz::detail::read(psk.ticketAgeAdd, cursor);
+  psk.ticketIssueTime = readTime(cursor);
+  psk.ticketExpirationTime = readTime(cursor);
+  psk.ticketHandshakeTime = readTime(cursor);
+
+  return psk;
+}
+
+namespace detail {
+void appendPskEntry(
+    const std::string& identity,
+    const CachedPsk& psk,
+    folly::io::Appender& appender) {
+  auto identityBuf = folly::IOBuf::wrapBuffer(folly::StringPiece(identity));
+  fizz::detail::writeBuf<uint16_t>(identityBuf, appender);
+  fizz::detail::writeBuf<uint32_t>(serializePsk(psk), appender);
+}
+} // namespace detail
+
+void PskCache::loadPsks(Buf serialized) {
+  folly::io::Cursor cursor(serialized.get());
+  uint32_t count;
+  fizz::detail::read(count, cursor);
+  for (uint32_t i = 0; i < count; i++) {
+    Buf identityBuf;
+    fizz::detail::readBuf<uint16_t>(identityBuf, cursor);
+    Buf pskBuf;
+    fizz::detail::readBuf<uint32_t>(pskBuf, cursor);
+    auto identity = identityBuf->moveToFbString().toStdString();
+    try {
+      putPsk(identity, deserializePsk(std::move(pskBuf)));
+    } catch (const std::exception& ex) {
+      VLOG(5) << "Skipping unreadable cached psk for " << identity << ": "
+              << ex.what();
+    }
+  }
+}
+
+Buf BasicPskCache::savePsks() {
+  auto buf = folly::IOBuf::create(sizeof(uint32_t));
+  folly::io::Appender appender(buf.get(), 512);
+  appender.writeBE<uint32_t>(cache_.size());
+  for (const auto& entry : cache_) {
+    detail::appendPskEntry(entry.first, entry.second, appender);
+  }
+  return buf;
+}
+} // namespace client
+} // namespace fizz
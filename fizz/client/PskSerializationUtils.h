@@ -0,0 +1,42 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/client/PskCache.h>
+
+namespace fizz {
+namespace client {
+
+/**
+ * Compact binary serialization for a cached PSK, including the serialized
+ * ticket and resumption secret, used to persist PSK caches across process
+ * restarts. Certificates are stored as DER when an X509 is available,
+ * falling back to the identity string. Timestamps are stored with second
+ * granularity.
+ */
+Buf serializePsk(const CachedPsk& psk);
+
+/**
+ * Deserializes a PSK serialized with serializePsk. Throws std::exception
+ * on malformed input.
+ */
+CachedPsk deserializePsk(Buf serialized);
+
+namespace detail {
+/**
+ * Appends one identity -> PSK cache entry in the framing used by
+ * PskCache::savePsks/loadPsks.
+ */
+void appendPskEntry(
+    const std::string& identity,
+    const CachedPsk& psk,
+    folly::io::Appender& appender);
+} // namespace detail
+} // namespace client
+} // namespace fizz
@@ -0,0 +1,163 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/client/ShardedClockPskCache.h>
+
+#include <fizz/client/PskSerializationUtils.h>
+#include <folly/hash/Hash.h>
+#include <folly/io/IOBufQueue.h>
+
+namespace fizz {
+namespace client {
+
+constexpr size_t ShardedClockPskCache::kDefaultNumShards;
+
+ShardedClockPskCache::ShardedClockPskCache(uint64_t mapMax, size_t numShards) {
+  if (numShards == 0) {
+    throw std::runtime_error("at least one shard required");
+  }
+  shardCapacity_ = std::max<uint64_t>(1, mapMax / numShards);
+  shards_.reserve(numShards);
+  for (size_t i = 0; i < numShards; i++) {
+    shards_.push_back(std::make_unique<Shard>());
+  }
+}
+
+ShardedClockPskCache::Shard& ShardedClockPskCache::getShard(
+    const std::string& identity) {
+  return *shards_[folly::Hash()(identity) % shards_.size()];
+}
+
+folly::Optional<CachedPsk> ShardedClockPskCache::getPsk(
+    const std::string& identity) {
+  if (checkNegativeEntry(identity)) {
+    countMiss();
+    return folly::none;
+  }
+  auto& shard = getShard(identity);
+  {
+    folly::SharedMutex::ReadHolder holder(shard.lock);
+    auto result = shard.map.find(identity);
+    if (result == shard.map.end()) {
+      countMiss();
+      return folly::none;
+    }
+    if (!isExpired(result->second->psk)) {
+      // Marking recency is a relaxed store, so readers never need the
+      // exclusive lock.
+      result->second->referenced.store(true, std::memory_order_relaxed);
+      countHit();
+      return result->second->psk;
+    }
+  }
+  // The entry has expired; upgrade to the exclusive lock to erase it,
+  // rechecking since it may have been replaced in between.
+  {
+    folly::SharedMutex::WriteHolder holder(shard.lock);
+    auto result = shard.map.find(identity);
+    if (result != shard.map.end() && isExpired(result->second->psk)) {
+      removeFromRing(shard, result->second->ringIndex);
+      shard.map.erase(result);
+    }
+  }
+  countExpired();
+  return folly::none;
+}
+
+void ShardedClockPskCache::putPsk(const std::string& identity, CachedPsk psk) {
+  clearNegativeEntry(identity);
+  auto& shard = getShard(identity);
+  folly::SharedMutex::WriteHolder holder(shard.lock);
+  auto result = shard.map.find(identity);
+  if (result != shard.map.end()) {
+    result->second->psk = std::move(psk);
+    result->second->referenced.store(true, std::memory_order_relaxed);
+    return;
+  }
+
+  if (shard.map.size() >= shardCapacity_) {
+    evictOne(shard);
+  }
+
+  auto entry = std::make_unique<Entry>();
+  entry->psk = std::move(psk);
+  entry->ringIndex = shard.ring.size();
+  shard.ring.push_back(identity);
+  shard.map.emplace(identity, std::move(entry));
+}
+
+void ShardedClockPskCache::removePsk(const std::string& identity) {
+  auto& shard = getShard(identity);
+  folly::SharedMutex::WriteHolder holder(shard.lock);
+  auto result = shard.map.find(identity);
+  if (result == shard.map.end()) {
+    return;
+  }
+  removeFromRing(shard, result->second->ringIndex);
+  shard.map.erase(result);
+}
+
+Buf ShardedClockPskCache::savePsks() {
+  uint32_t count = 0;
+  folly::IOBufQueue body{folly::IOBufQueue::cacheChainLength()};
+  for (auto& shard : shards_) {
+    folly::SharedMutex::ReadHolder holder(shard->lock);
+    if (shard->map.empty()) {
+      continue;
+    }
+    auto buf = folly::IOBuf::create(512);
+    folly::io::Appender appender(buf.get(), 512);
+    for (const auto& entry : shard->map) {
+      detail::appendPskEntry(entry.first, entry.second->psk, appender);
+      count++;
+    }
+    body.append(std::move(buf));
+  }
+
+  auto head = folly::IOBuf::create(sizeof(uint32_t));
+  folly::io::Appender appender(head.get(), sizeof(uint32_t));
+  appender.writeBE<uint32_t>(count);
+  if (!body.empty()) {
+    head->prependChain(body.move());
+  }
+  return head;
+}
+
+// Called with the shard's exclusive lock held.
+void ShardedClockPskCache::evictOne(Shard& shard) {
+  while (true) {
+    if (shard.hand >= shard.ring.size()) {
+      shard.hand = 0;
+    }
+    auto& key = shard.ring[shard.hand];
+    auto& entry = shard.map.at(key);
+    if (entry->referenced.exchange(false, std::memory_order_relaxed)) {
+      shard.hand++;
+      continue;
+    }
+    auto victim = shard.map.find(key);
+    removeFromRing(shard, victim->second->ringIndex);
+    shard.map.erase(victim);
+    countEviction();
+    return;
+  }
+}
+
+void ShardedClockPskCache::removeFromRing(Shard& shard, size_t ringIndex) {
+  auto lastIndex = shard.ring.size() - 1;
+  if (ringIndex != lastIndex) {
+    shard.ring[ringIndex] = std::move(shard.ring[lastIndex]);
+    shard.map.at(shard.ring[ringIndex])->ringIndex = ringIndex;
+  }
+  shard.ring.pop_back();
+  if (shard.hand > ringIndex) {
+    shard.hand--;
+  }
+}
+} // namespace client
+} // namespace fizz
@@ -0,0 +1,75 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/client/PskCache.h>
+#include <folly/SharedMutex.h>
+
+#include <atomic>
+#include <unordered_map>
+#include <vector>
+
+namespace fizz {
+namespace client {
+
+/**
+ * Bounded PSK cache sharded by identity hash. Unlike
+ * SynchronizedLruPskCache, lookups take a per-shard shared lock and mark
+ * the entry with a CLOCK reference bit instead of reordering an LRU
+ * list, so concurrent getPsk calls on the hot connection-setup path
+ * neither serialize on a global mutex nor contend for exclusive access.
+ * Eviction approximates LRU: a clock hand sweeps the shard, clearing
+ * reference bits and evicting the first entry found unreferenced.
+ */
+class ShardedClockPskCache : public PskCache {
+ public:
+  static constexpr size_t kDefaultNumShards = 16;
+
+  /**
+   * mapMax is the total capacity across all shards; each shard holds at
+   * least one entry, so the effective capacity is at least numShards.
+   */
+  explicit ShardedClockPskCache(
+      uint64_t mapMax,
+      size_t numShards = kDefaultNumShards);
+  ~ShardedClockPskCache() override = default;
+
+  folly::Optional<CachedPsk> getPsk(const std::string& identity) override;
+
+  void putPsk(const std::string& identity, CachedPsk psk) override;
+
+  void removePsk(const std::string& identity) override;
+
+  Buf savePsks() override;
+
+ private:
+  struct Entry {
+    CachedPsk psk;
+    size_t ringIndex;
+    std::atomic<bool> referenced{true};
+  };
+
+  struct Shard {
+    mutable folly::SharedMutex lock;
+    std::unordered_map<std::string, std::unique_ptr<Entry>> map;
+    // Clock ring of keys; each entry records its slot for O(1) removal.
+    std::vector<std::string> ring;
+    size_t hand{0};
+  };
+
+  Shard& getShard(const std::string& identity);
+  void evictOne(Shard& shard);
+  void removeFromRing(Shard& shard, size_t ringIndex);
+
+  std::vector<std::unique_ptr<Shard>> shards_;
+  size_t shardCapacity_;
+};
+
+} // namespace client
+} // namespace fizz
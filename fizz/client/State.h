@@ -8,9 +8,12 @@
 
 #pragma once
 
+#include <folly/futures/Future.h>
+
 #include <fizz/client/ClientExtensions.h>
 #include <fizz/client/FizzClientContext.h>
 #include <fizz/protocol/Certificate.h>
+#include <fizz/protocol/Instrumentation.h>
 #include <fizz/protocol/KeyScheduler.h>
 #include <fizz/protocol/Types.h>
 #include <fizz/record/RecordLayer.h>
@@ -66,6 +69,21 @@ class State {
     return state_;
   }
 
+  /**
+   * The executor this connection is running on.
+   */
+  folly::Executor* executor() const {
+    return executor_;
+  }
+
+  /**
+   * Instrumentation hook notified of state transitions and crypto phases.
+   * Not owned. May be null.
+   */
+  HandshakeInstrumentation* instrumentation() const {
+    return instrumentation_;
+  }
+
   /**
    * The FizzClientContext used on this connection.
    */
@@ -361,6 +379,13 @@ class State {
     return state_;
   }
 
+  auto& executor() {
+    return executor_;
+  }
+  auto& instrumentation() {
+    return instrumentation_;
+  }
+
   auto& context() {
     return context_;
   }
@@ -514,18 +539,26 @@ class State {
   }
 
  private:
+  // The members touched on the per-record path are grouped at the front
+  // of the object so that the state enum and both record layer pointers
+  // share a cacheline; everything below is only read during the
+  // handshake or on error paths.
   StateEnum state_{StateEnum::Uninitialized};
 
+  std::unique_ptr<ReadRecordLayer> readRecordLayer_;
+  std::unique_ptr<WriteRecordLayer> writeRecordLayer_;
+  std::unique_ptr<EncryptedWriteRecordLayer> earlyWriteRecordLayer_;
+
+  folly::Executor* executor_;
+
+  HandshakeInstrumentation* instrumentation_{nullptr};
+
   std::shared_ptr<const FizzClientContext> context_;
 
   std::shared_ptr<const CertificateVerifier> verifier_;
 
   std::unique_ptr<KeyScheduler> keyScheduler_;
 
-  std::unique_ptr<ReadRecordLayer> readRecordLayer_;
-  std::unique_ptr<WriteRecordLayer> writeRecordLayer_;
-  std::unique_ptr<EncryptedWriteRecordLayer> earlyWriteRecordLayer_;
-
   mutable std::unique_ptr<HandshakeContext> handshakeContext_;
 
   std::shared_ptr<const Cert> serverCert_;
@@ -8,26 +8,42 @@
 
 #include <fizz/client/SynchronizedLruPskCache.h>
 
+#include <fizz/client/PskSerializationUtils.h>
+
 namespace fizz {
 namespace client {
 
 SynchronizedLruPskCache::SynchronizedLruPskCache(uint64_t mapMax)
-    : cache_(EvictingPskMap(mapMax)) {}
+    : cache_(EvictingPskMap(mapMax)) {
+  cache_.wlock()->setPruneHook(
+      [this](std::string, CachedPsk&&) { countEviction(); });
+}
 
 folly::Optional<CachedPsk> SynchronizedLruPskCache::getPsk(
     const std::string& identity) {
+  if (checkNegativeEntry(identity)) {
+    countMiss();
+    return folly::none;
+  }
   auto cacheMap = cache_.wlock();
   auto result = cacheMap->find(identity);
-  if (result != cacheMap->end()) {
-    return result->second;
-  } else {
+  if (result == cacheMap->end()) {
+    countMiss();
     return folly::none;
   }
+  if (isExpired(result->second)) {
+    cacheMap->erase(identity);
+    countExpired();
+    return folly::none;
+  }
+  countHit();
+  return result->second;
 }
 
 void SynchronizedLruPskCache::putPsk(
     const std::string& identity,
     CachedPsk psk) {
+  clearNegativeEntry(identity);
   auto cacheMap = cache_.wlock();
   cacheMap->set(identity, std::move(psk));
 }
@@ -37,5 +53,16 @@ void SynchronizedLruPskCache::removePsk(const std::string& identity) {
   cacheMap->erase(identity);
 }
 
+Buf SynchronizedLruPskCache::savePsks() {
+  auto cacheMap = cache_.rlock();
+  auto buf = folly::IOBuf::create(sizeof(uint32_t));
+  folly::io::Appender appender(buf.get(), 512);
+  appender.writeBE<uint32_t>(cacheMap->size());
+  for (const auto& entry : *cacheMap) {
+    detail::appendPskEntry(entry.first, entry.second, appender);
+  }
+  return buf;
+}
+
 } // namespace client
 } // namespace fizz
@@ -32,6 +32,8 @@ class SynchronizedLruPskCache : public PskCache {
 
   void removePsk(const std::string& identity) override;
 
+  Buf savePsks() override;
+
  private:
   folly::Synchronized<EvictingPskMap> cache_;
 };
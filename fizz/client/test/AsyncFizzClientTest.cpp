@@ -26,6 +26,11 @@ using namespace folly;
 using namespace folly::test;
 using namespace testing;
 
+template <typename... Args>
+AsyncActions actions(Args&&... act) {
+  return fizz::client::detail::actions(std::forward<Args>(act)...);
+}
+
 class MockClientStateMachineInstance : public MockClientStateMachine {
  public:
   MockClientStateMachineInstance() {
@@ -88,8 +93,9 @@ class AsyncFizzClientTest : public Test {
 
   void connect() {
     expectTransportReadCallback();
-    EXPECT_CALL(*machine_, _processConnect(_, _, _, _, _, _))
-        .WillOnce(InvokeWithoutArgs([]() { return Actions(); }));
+    EXPECT_CALL(*socket_, getEventBase()).WillOnce(Return(&evb_));
+    EXPECT_CALL(*machine_, _processConnect(_, &evb_, _, _, _, _, _))
+        .WillOnce(InvokeWithoutArgs([]() { return actions(); }));
     const auto sni = std::string("www.example.com");
     client_->connect(&handshakeCallback_, nullptr, sni, pskIdentity_);
   }
@@ -126,7 +132,7 @@ class AsyncFizzClientTest : public Test {
           };
           ReportHandshakeSuccess reportSuccess;
           reportSuccess.earlyDataAccepted = acceptEarlyData;
-          return detail::actions(
+          return actions(
               std::move(addToState), std::move(reportSuccess), WaitForData());
         }));
     socketReadCallback_->readBufferAvailable(IOBuf::copyBuffer("ServerData"));
@@ -156,7 +162,7 @@ class AsyncFizzClientTest : public Test {
               };
           ReportEarlyHandshakeSuccess reportSuccess;
           reportSuccess.maxEarlyDataSize = 1000;
-          return detail::actions(
+          return actions(
               std::move(addParamsToState),
               std::move(reportSuccess),
               WaitForData());
@@ -193,33 +199,33 @@ TEST_F(AsyncFizzClientTest, TestReadSingle) {
   connect();
   EXPECT_CALL(*machine_, _processSocketData(_, _))
       .WillOnce(
-          InvokeWithoutArgs([]() { return detail::actions(WaitForData()); }));
+          InvokeWithoutArgs([]() { return actions(WaitForData()); }));
   socketReadCallback_->readBufferAvailable(IOBuf::copyBuffer("ClientHello"));
 }
 
 TEST_F(AsyncFizzClientTest, TestReadMulti) {
   connect();
   EXPECT_CALL(*machine_, _processSocketData(_, _))
-      .WillOnce(InvokeWithoutArgs([]() { return detail::actions(); }))
+      .WillOnce(InvokeWithoutArgs([]() { return actions(); }))
       .WillOnce(
-          InvokeWithoutArgs([]() { return detail::actions(WaitForData()); }));
+          InvokeWithoutArgs([]() { return actions(WaitForData()); }));
   socketReadCallback_->readBufferAvailable(IOBuf::copyBuffer("ClientHello"));
 }
 
 TEST_F(AsyncFizzClientTest, TestWrite) {
   connect();
   EXPECT_CALL(*machine_, _processAppWrite(_, _))
-      .WillOnce(InvokeWithoutArgs([]() { return detail::actions(); }));
+      .WillOnce(InvokeWithoutArgs([]() { return actions(); }));
   client_->writeChain(nullptr, IOBuf::copyBuffer("HTTP GET"));
 }
 
 TEST_F(AsyncFizzClientTest, TestWriteMulti) {
   connect();
   EXPECT_CALL(*machine_, _processAppWrite(_, _))
-      .WillOnce(InvokeWithoutArgs([]() { return detail::actions(); }));
+      .WillOnce(InvokeWithoutArgs([]() { return actions(); }));
   client_->writeChain(nullptr, IOBuf::copyBuffer("HTTP GET"));
   EXPECT_CALL(*machine_, _processAppWrite(_, _))
-      .WillOnce(InvokeWithoutArgs([]() { return detail::actions(); }));
+      .WillOnce(InvokeWithoutArgs([]() { return actions(); }));
   client_->writeChain(nullptr, IOBuf::copyBuffer("HTTP POST"));
 }
 
@@ -253,7 +259,7 @@ TEST_F(AsyncFizzClientTest, TestHandshakeError) {
   connect();
   EXPECT_CALL(*machine_, _processSocketData(_, _))
       .WillOnce(InvokeWithoutArgs([]() {
-        return detail::actions(ReportError("unit test"), WaitForData());
+        return actions(ReportError("unit test"), WaitForData());
       }));
   EXPECT_CALL(handshakeCallback_, _fizzHandshakeError(_));
   socketReadCallback_->readBufferAvailable(IOBuf::copyBuffer("ClientHello"));
@@ -263,7 +269,7 @@ TEST_F(AsyncFizzClientTest, TestHandshakeErrorDelete) {
   connect();
   EXPECT_CALL(*machine_, _processSocketData(_, _))
       .WillOnce(InvokeWithoutArgs([]() {
-        return detail::actions(ReportError("unit test"), WaitForData());
+        return actions(ReportError("unit test"), WaitForData());
       }));
   EXPECT_CALL(handshakeCallback_, _fizzHandshakeError(_))
       .WillOnce(InvokeWithoutArgs([this]() { client_.reset(); }));
@@ -275,7 +281,7 @@ TEST_F(AsyncFizzClientTest, TestDeliverAppData) {
   client_->setReadCB(&readCallback_);
   EXPECT_CALL(*machine_, _processSocketData(_, _))
       .WillOnce(InvokeWithoutArgs([]() {
-        return detail::actions(
+        return actions(
             DeliverAppData{IOBuf::copyBuffer("HI")}, WaitForData());
       }));
   EXPECT_CALL(readCallback_, readBufferAvailable_(_));
@@ -293,7 +299,7 @@ TEST_F(AsyncFizzClientTest, TestWriteToSocket) {
         record.encryptionLevel = EncryptionLevel::Handshake;
         WriteToSocket write;
         write.contents.emplace_back(std::move(record));
-        return detail::actions(std::move(write), WaitForData());
+        return actions(std::move(write), WaitForData());
       }));
   EXPECT_CALL(*socket_, writeChain(_, _, _));
   socketReadCallback_->readBufferAvailable(IOBuf::copyBuffer("ClientHello"));
@@ -305,7 +311,7 @@ TEST_F(AsyncFizzClientTest, TestMutateState) {
   uint32_t numTimesRun = 0;
   EXPECT_CALL(*machine_, _processSocketData(_, _))
       .WillOnce(InvokeWithoutArgs([&numTimesRun]() {
-        return detail::actions(
+        return actions(
             [&numTimesRun](State& newState) {
               numTimesRun++;
               newState.state() = StateEnum::Error;
@@ -333,7 +339,7 @@ TEST_F(AsyncFizzClientTest, TestConnecting) {
   EXPECT_TRUE(client_->connecting());
   EXPECT_CALL(*machine_, _processSocketData(_, _))
       .WillOnce(InvokeWithoutArgs([]() {
-        return detail::actions(ReportHandshakeSuccess(), WaitForData());
+        return actions(ReportHandshakeSuccess(), WaitForData());
       }));
   EXPECT_CALL(handshakeCallback_, _fizzHandshakeSuccess());
   socketReadCallback_->readBufferAvailable(IOBuf::copyBuffer("ClientHello"));
@@ -354,7 +360,7 @@ TEST_F(AsyncFizzClientTest, TestGoodState) {
   EXPECT_TRUE(client_->good());
   EXPECT_CALL(*machine_, _processSocketData(_, _))
       .WillOnce(InvokeWithoutArgs([]() {
-        return detail::actions(
+        return actions(
             [](State& newState) { newState.state() = StateEnum::Error; });
       }));
   socketReadCallback_->readBufferAvailable(IOBuf::copyBuffer("Data"));
@@ -370,9 +376,37 @@ TEST_F(AsyncFizzClientTest, TestSocketConnect) {
   machine_ = MockClientStateMachineInstance::instance;
   auto server = std::make_unique<TestServer>();
 
-  EXPECT_CALL(*machine_, _processConnect(_, _, _, _, _, _))
+  EXPECT_CALL(*machine_, _processConnect(_, _, _, _, _, _, _))
+      .WillOnce(InvokeWithoutArgs([]() {
+        return actions(ReportHandshakeSuccess(), WaitForData());
+      }));
+  EXPECT_CALL(cb, _connectSuccess()).WillOnce(Invoke([&evbClient]() {
+    evbClient->closeNow();
+  }));
+
+  evbClient->connect(
+      server->getAddress(),
+      &cb,
+      nullptr,
+      std::string("www.example.com"),
+      pskIdentity_);
+
+  evb.loop();
+}
+
+TEST_F(AsyncFizzClientTest, TestSocketConnectTFO) {
+  MockConnectCallback cb;
+  EventBase evb;
+  auto evbClient = AsyncFizzClientT<MockClientStateMachineInstance>::UniquePtr(
+      new AsyncFizzClientT<MockClientStateMachineInstance>(&evb, context_));
+  evbClient->setTFOEnabled(true);
+
+  machine_ = MockClientStateMachineInstance::instance;
+  auto server = std::make_unique<TestServer>();
+
+  EXPECT_CALL(*machine_, _processConnect(_, _, _, _, _, _, _))
       .WillOnce(InvokeWithoutArgs([]() {
-        return detail::actions(ReportHandshakeSuccess(), WaitForData());
+        return actions(ReportHandshakeSuccess(), WaitForData());
       }));
   EXPECT_CALL(cb, _connectSuccess()).WillOnce(Invoke([&evbClient]() {
     evbClient->closeNow();
@@ -415,7 +449,7 @@ TEST_F(AsyncFizzClientTest, TestHandshakeConnectWithUnopenedSocket) {
             ex.what().toStdString(),
             HasSubstr("handshake connect called but socket isn't open"));
       }));
-  EXPECT_CALL(*machine_, _processConnect(_, _, _, _, _, _)).Times(0);
+  EXPECT_CALL(*machine_, _processConnect(_, _, _, _, _, _, _)).Times(0);
   evbClient->connect(
       &handshakeCallback_,
       nullptr,
@@ -442,7 +476,7 @@ TEST_F(AsyncFizzClientTest, TestSocketConnectWithOpenSocket) {
         cb->connectErr(AsyncSocketException(
             AsyncSocketException::ALREADY_OPEN, "socket already open"));
       }));
-  EXPECT_CALL(*machine_, _processConnect(_, _, _, _, _, _)).Times(0);
+  EXPECT_CALL(*machine_, _processConnect(_, _, _, _, _, _, _)).Times(0);
   client_->connect(
       SocketAddress(),
       &cb,
@@ -523,13 +557,13 @@ TEST_F(AsyncFizzClientTest, TestEarlyHandshakeWrite) {
   completeEarlyHandshake();
 
   EXPECT_CALL(*machine_, _processEarlyAppWrite(_, _))
-      .WillOnce(InvokeWithoutArgs([]() { return detail::actions(); }));
+      .WillOnce(InvokeWithoutArgs([]() { return actions(); }));
   client_->writeChain(nullptr, IOBuf::copyBuffer("HTTP GET"));
 
   fullHandshakeSuccess(true);
 
   EXPECT_CALL(*machine_, _processAppWrite(_, _))
-      .WillOnce(InvokeWithoutArgs([]() { return detail::actions(); }));
+      .WillOnce(InvokeWithoutArgs([]() { return actions(); }));
   client_->writeChain(nullptr, IOBuf::copyBuffer("HTTP POST"));
 }
 
@@ -538,7 +572,7 @@ TEST_F(AsyncFizzClientTest, TestEarlyHandshakeReplaySafeCallback) {
   client_->setReplaySafetyCallback(&mockReplayCallback_);
 
   EXPECT_CALL(*machine_, _processAppWrite(_, _))
-      .WillOnce(InvokeWithoutArgs([]() { return detail::actions(); }));
+      .WillOnce(InvokeWithoutArgs([]() { return actions(); }));
   EXPECT_CALL(mockReplayCallback_, onReplaySafe_()).WillOnce(Invoke([this]() {
     client_->writeChain(nullptr, IOBuf::copyBuffer("HTTP POST"));
   }));
@@ -568,7 +602,7 @@ TEST_F(AsyncFizzClientTest, TestEarlyHandshakeOverLimit) {
   EXPECT_CALL(*machine_, _processEarlyAppWrite(_, _))
       .WillOnce(Invoke([&earlyWrite](const State&, EarlyAppWrite& write) {
         EXPECT_TRUE(IOBufEqualTo()(write.data, earlyWrite));
-        return detail::actions();
+        return actions();
       }));
   client_->writeChain(nullptr, earlyWrite->clone());
   client_->writeChain(nullptr, longWrite->clone());
@@ -579,19 +613,19 @@ TEST_F(AsyncFizzClientTest, TestEarlyHandshakeOverLimit) {
       .InSequence(s)
       .WillOnce(Invoke([&longWrite](const State&, AppWrite& write) {
         EXPECT_TRUE(IOBufEqualTo()(write.data, longWrite));
-        return detail::actions();
+        return actions();
       }));
   EXPECT_CALL(*machine_, _processAppWrite(_, _))
       .InSequence(s)
       .WillOnce(Invoke([&shortWrite](const State&, AppWrite& write) {
         EXPECT_TRUE(IOBufEqualTo()(write.data, shortWrite));
-        return detail::actions();
+        return actions();
       }));
   EXPECT_CALL(*machine_, _processAppWrite(_, _))
       .InSequence(s)
       .WillOnce(Invoke([&replaySafeWrite](const State&, AppWrite& write) {
         EXPECT_TRUE(IOBufEqualTo()(write.data, replaySafeWrite));
-        return detail::actions();
+        return actions();
       }));
 
   EXPECT_CALL(mockReplayCallback_, onReplaySafe_())
@@ -613,7 +647,7 @@ TEST_F(AsyncFizzClientTest, TestEarlyHandshakeAllOverLimit) {
   EXPECT_CALL(*machine_, _processAppWrite(_, _))
       .WillOnce(Invoke([&buf](const State&, AppWrite& write) {
         EXPECT_TRUE(IOBufEqualTo()(write.data, buf));
-        return detail::actions();
+        return actions();
       }));
   EXPECT_CALL(mockReplayCallback_, onReplaySafe_());
   fullHandshakeSuccess(true);
@@ -650,6 +684,45 @@ TEST_F(AsyncFizzClientTest, TestEarlyHandshakeRejectedPendingWriteError) {
   fullHandshakeSuccess(false);
 }
 
+TEST_F(AsyncFizzClientTest, TestEarlyWriteFastPath) {
+  client_->setAppDataFastPath(true);
+  expectTransportReadCallback();
+  EXPECT_CALL(*socket_, getEventBase()).WillOnce(Return(&evb_));
+  auto rl = new MockEncryptedWriteRecordLayer(EncryptionLevel::EarlyData);
+  EXPECT_CALL(*machine_, _processConnect(_, &evb_, _, _, _, _, _))
+      .WillOnce(InvokeWithoutArgs([rl]() {
+        auto addToState = [rl](State& newState) {
+          newState.earlyDataParams() = getEarlyDataParams();
+          newState.earlyDataType() = EarlyDataType::Attempted;
+          newState.earlyWriteRecordLayer().reset(rl);
+        };
+        ReportEarlyHandshakeSuccess reportSuccess;
+        reportSuccess.maxEarlyDataSize = 1000;
+        return actions(
+            std::move(addToState), std::move(reportSuccess), WaitForData());
+      }));
+  EXPECT_CALL(handshakeCallback_, _fizzHandshakeSuccess());
+  client_->connect(
+      &handshakeCallback_,
+      nullptr,
+      std::string("www.example.com"),
+      pskIdentity_);
+
+  // Early writes now stream through the early record layer inline: no
+  // _processEarlyAppWrite calls are expected.
+  EXPECT_CALL(*rl, _write(_)).WillOnce(Invoke([](TLSMessage& msg) {
+    EXPECT_TRUE(IOBufEqualTo()(msg.fragment, IOBuf::copyBuffer("early")));
+    TLSContent content;
+    content.contentType = msg.type;
+    content.encryptionLevel = EncryptionLevel::EarlyData;
+    content.data = IOBuf::copyBuffer("earlyciphertext");
+    return content;
+  }));
+  EXPECT_CALL(*socket_, writeChain(_, _, _));
+  client_->writeChain(nullptr, IOBuf::copyBuffer("early"));
+  EXPECT_FALSE(client_->isReplaySafe());
+}
+
 TEST_F(AsyncFizzClientTest, TestEarlyHandshakeRejectedAutoResendNoData) {
   client_->setEarlyDataRejectionPolicy(
       EarlyDataRejectionPolicy::AutomaticResend);
@@ -667,20 +740,20 @@ TEST_F(AsyncFizzClientTest, TestEarlyHandshakeRejectedAutoResend) {
   EXPECT_CALL(*machine_, _processEarlyAppWrite(_, _))
       .WillOnce(Invoke([](const State&, EarlyAppWrite& write) {
         EXPECT_TRUE(IOBufEqualTo()(write.data, IOBuf::copyBuffer("aaaa")));
-        return detail::actions();
+        return actions();
       }));
   client_->writeChain(nullptr, IOBuf::copyBuffer("aaaa"));
   EXPECT_CALL(*machine_, _processEarlyAppWrite(_, _))
       .WillOnce(Invoke([](const State&, EarlyAppWrite& write) {
         EXPECT_TRUE(IOBufEqualTo()(write.data, IOBuf::copyBuffer("bbbb")));
-        return detail::actions();
+        return actions();
       }));
   client_->writeChain(nullptr, IOBuf::copyBuffer("bbbb"));
 
   EXPECT_CALL(*machine_, _processAppWrite(_, _))
       .WillOnce(Invoke([](const State&, AppWrite& write) {
         EXPECT_TRUE(IOBufEqualTo()(write.data, IOBuf::copyBuffer("aaaabbbb")));
-        return detail::actions();
+        return actions();
       }));
   fullHandshakeSuccess(false);
 }
@@ -694,7 +767,7 @@ TEST_F(AsyncFizzClientTest, TestEarlyHandshakeRejectedAutoResendOrder) {
   EXPECT_CALL(*machine_, _processEarlyAppWrite(_, _))
       .WillOnce(Invoke([](const State&, EarlyAppWrite& write) {
         EXPECT_TRUE(IOBufEqualTo()(write.data, IOBuf::copyBuffer("aaaa")));
-        return detail::actions();
+        return actions();
       }));
   client_->writeChain(nullptr, IOBuf::copyBuffer("aaaa"));
   auto buf = IOBuf::create(2000);
@@ -707,19 +780,19 @@ TEST_F(AsyncFizzClientTest, TestEarlyHandshakeRejectedAutoResendOrder) {
       .InSequence(s)
       .WillOnce(Invoke([](const State&, AppWrite& write) {
         EXPECT_TRUE(IOBufEqualTo()(write.data, IOBuf::copyBuffer("aaaa")));
-        return detail::actions();
+        return actions();
       }));
   EXPECT_CALL(*machine_, _processAppWrite(_, _))
       .InSequence(s)
       .WillOnce(Invoke([&buf](const State&, AppWrite& write) {
         EXPECT_TRUE(IOBufEqualTo()(write.data, buf));
-        return detail::actions();
+        return actions();
       }));
   EXPECT_CALL(*machine_, _processAppWrite(_, _))
       .InSequence(s)
       .WillOnce(Invoke([](const State&, AppWrite& write) {
         EXPECT_TRUE(IOBufEqualTo()(write.data, IOBuf::copyBuffer("cccc")));
-        return detail::actions();
+        return actions();
       }));
 
   EXPECT_CALL(mockReplayCallback_, onReplaySafe_()).WillOnce(Invoke([this]() {
@@ -738,14 +811,39 @@ TEST_F(AsyncFizzClientTest, TestEarlyHandshakeRejectedAutoResendDeletedBuffer) {
       .WillOnce(Invoke([&buf](const State&, EarlyAppWrite& write) {
         EXPECT_TRUE(IOBufEqualTo()(write.data, IOBuf::copyBuffer("aaaa")));
         buf.reset();
-        return detail::actions();
+        return actions();
       }));
   client_->write(nullptr, buf->data(), buf->length());
 
   EXPECT_CALL(*machine_, _processAppWrite(_, _))
       .WillOnce(Invoke([](const State&, AppWrite& write) {
         EXPECT_TRUE(IOBufEqualTo()(write.data, IOBuf::copyBuffer("aaaa")));
-        return detail::actions();
+        return actions();
+      }));
+  fullHandshakeSuccess(false);
+}
+
+TEST_F(AsyncFizzClientTest, TestEarlyHandshakeRejectedAutoResendSharedBuf) {
+  client_->setEarlyDataRejectionPolicy(
+      EarlyDataRejectionPolicy::AutomaticResend);
+  completeEarlyHandshake();
+
+  auto buf = IOBuf::copyBuffer("aaaa");
+  const void* bufData = buf->data();
+  EXPECT_CALL(*machine_, _processEarlyAppWrite(_, _))
+      .WillOnce(Invoke([](const State&, EarlyAppWrite& write) {
+        EXPECT_TRUE(IOBufEqualTo()(write.data, IOBuf::copyBuffer("aaaa")));
+        return actions();
+      }));
+  client_->writeChain(nullptr, std::move(buf));
+
+  EXPECT_CALL(*machine_, _processAppWrite(_, _))
+      .WillOnce(Invoke([bufData](const State&, AppWrite& write) {
+        EXPECT_TRUE(IOBufEqualTo()(write.data, IOBuf::copyBuffer("aaaa")));
+        // The retained copy should share the refcounted buffer rather
+        // than duplicating it.
+        EXPECT_EQ(write.data->data(), bufData);
+        return actions();
       }));
   fullHandshakeSuccess(false);
 }
@@ -932,7 +1030,7 @@ TEST_F(AsyncFizzClientTest, TestEarlyWriteRejected) {
       .WillOnce(Invoke([](const State&, EarlyAppWrite& write) {
         ReportEarlyWriteFailed failed;
         failed.write = std::move(write);
-        return detail::actions(std::move(failed));
+        return actions(std::move(failed));
       }));
   EXPECT_CALL(writeCallback_, writeSuccess_());
   client_->writeChain(&writeCallback_, IOBuf::copyBuffer("HTTP GET"));
@@ -944,7 +1042,7 @@ TEST_F(AsyncFizzClientTest, TestEarlyWriteRejectedNullCallback) {
       .WillOnce(Invoke([](const State&, EarlyAppWrite& write) {
         ReportEarlyWriteFailed failed;
         failed.write = std::move(write);
-        return detail::actions(std::move(failed));
+        return actions(std::move(failed));
       }));
   client_->writeChain(nullptr, IOBuf::copyBuffer("HTTP GET"));
 }
@@ -954,7 +1052,7 @@ TEST_F(AsyncFizzClientTest, TestErrorStopsActions) {
   client_->setReadCB(&readCallback_);
   EXPECT_CALL(*machine_, _processSocketData(_, _))
       .WillOnce(InvokeWithoutArgs([]() {
-        return detail::actions(
+        return actions(
             [](State& newState) { newState.state() = StateEnum::Error; },
             ReportError("unit test"));
       }));
@@ -1001,7 +1099,7 @@ TEST_F(AsyncFizzClientTest, TestNewCachedPskActions) {
   client_->setReadCB(&readCallback_);
   EXPECT_CALL(*machine_, _processSocketData(_, _))
       .WillOnce(InvokeWithoutArgs(
-          []() { return detail::actions(NewCachedPsk(), WaitForData()); }));
+          []() { return actions(NewCachedPsk(), WaitForData()); }));
   EXPECT_CALL(*mockPskCache_, putPsk(*pskIdentity_, _));
   socketReadCallback_->readBufferAvailable(
       IOBuf::copyBuffer("NewSessionTicket"));
@@ -1013,12 +1111,40 @@ TEST_F(AsyncFizzClientTest, TestNewCachedPskActionsWithEmptyPskIdentity) {
   client_->setReadCB(&readCallback_);
   EXPECT_CALL(*machine_, _processSocketData(_, _))
       .WillOnce(InvokeWithoutArgs(
-          []() { return detail::actions(NewCachedPsk(), WaitForData()); }));
+          []() { return actions(NewCachedPsk(), WaitForData()); }));
   EXPECT_CALL(*mockPskCache_, putPsk(_, _)).Times(0);
   socketReadCallback_->readBufferAvailable(
       IOBuf::copyBuffer("NewSessionTicket"));
 }
 
+TEST_F(AsyncFizzClientTest, TestSessionStateMigration) {
+  completeHandshake();
+  client_->setReadCB(&readCallback_);
+  EXPECT_CALL(*machine_, _processSocketData(_, _))
+      .WillOnce(Invoke([](const State&, folly::IOBufQueue& queue) {
+        queue.move();
+        return actions(
+            [](State& newState) { newState.state() = StateEnum::Established; },
+            WaitForData());
+      }));
+  socketReadCallback_->readBufferAvailable(IOBuf::copyBuffer("ServerData"));
+
+  auto transport = client_->extractTransport();
+  auto state = client_->extractSessionState();
+  EXPECT_EQ(state.state(), StateEnum::Established);
+
+  expectTransportReadCallback();
+  EXPECT_CALL(*socket_, getEventBase()).WillOnce(Return(&evb_));
+  client_.reset(new AsyncFizzClientT<MockClientStateMachineInstance>(
+      std::move(transport), context_, std::move(state)));
+  machine_ = MockClientStateMachineInstance::instance;
+  EXPECT_EQ(client_->getApplicationProtocol(), "h2");
+
+  EXPECT_CALL(*machine_, _processAppWrite(_, _))
+      .WillOnce(InvokeWithoutArgs([]() { return actions(); }));
+  client_->writeChain(nullptr, IOBuf::copyBuffer("HTTP GET"));
+}
+
 TEST_F(AsyncFizzClientTest, TestAsyncFizzClientDestructor) {
   socket_ = new MockAsyncTransport();
   auto transport = AsyncTransportWrapper::UniquePtr(socket_);
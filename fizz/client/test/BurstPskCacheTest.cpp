@@ -0,0 +1,111 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GMock.h>
+#include <folly/portability/GTest.h>
+
+#include <fizz/client/BurstPskCache.h>
+#include <fizz/client/test/Mocks.h>
+#include <fizz/client/test/Utilities.h>
+
+using namespace folly;
+using namespace testing;
+
+namespace fizz {
+namespace client {
+namespace test {
+
+class BurstPskCacheTest : public Test {
+ public:
+  void SetUp() override {
+    delegate_ = std::make_shared<MockPskCache>();
+    cache_ = std::make_unique<BurstPskCache>(delegate_);
+    ticketTime_ = std::chrono::system_clock::now();
+  }
+
+ protected:
+  CachedPsk getCachedPsk(std::string pskName = "PSK") {
+    return getTestPsk(pskName, ticketTime_);
+  }
+
+  std::shared_ptr<MockPskCache> delegate_;
+  std::unique_ptr<BurstPskCache> cache_;
+  std::chrono::system_clock::time_point ticketTime_;
+};
+
+TEST_F(BurstPskCacheTest, TestPrefetchShares) {
+  EXPECT_CALL(*delegate_, getPsk("fizz"))
+      .WillOnce(Return(getCachedPsk("psk 1")));
+  cache_->prefetch({"fizz"});
+
+  // The whole burst is served from the pinned entry without further
+  // delegate lookups.
+  for (int i = 0; i < 3; i++) {
+    auto psk = cache_->getPsk("fizz");
+    ASSERT_TRUE(psk.hasValue());
+    pskEq(getCachedPsk("psk 1"), *psk);
+  }
+}
+
+TEST_F(BurstPskCacheTest, TestTicketQueue) {
+  EXPECT_CALL(*delegate_, getPsk("fizz"))
+      .WillOnce(Return(getCachedPsk("psk 1")));
+  cache_->prefetch({"fizz"});
+
+  // Tickets issued during the burst are queued and handed out once each,
+  // in order, before falling back to the shared PSK.
+  cache_->putPsk("fizz", getCachedPsk("psk 2"));
+  cache_->putPsk("fizz", getCachedPsk("psk 3"));
+  pskEq(getCachedPsk("psk 2"), *cache_->getPsk("fizz"));
+  pskEq(getCachedPsk("psk 3"), *cache_->getPsk("fizz"));
+  pskEq(getCachedPsk("psk 1"), *cache_->getPsk("fizz"));
+}
+
+TEST_F(BurstPskCacheTest, TestRelease) {
+  EXPECT_CALL(*delegate_, getPsk("fizz"))
+      .WillOnce(Return(getCachedPsk("psk 1")));
+  cache_->prefetch({"fizz"});
+  cache_->putPsk("fizz", getCachedPsk("psk 2"));
+  cache_->putPsk("fizz", getCachedPsk("psk 3"));
+
+  // The freshest queued ticket is flushed to the delegate on release.
+  EXPECT_CALL(*delegate_, putPsk("fizz", _))
+      .WillOnce(Invoke([this](const std::string&, CachedPsk psk) {
+        pskEq(getCachedPsk("psk 3"), psk);
+      }));
+  cache_->release("fizz");
+
+  // Subsequent lookups go straight to the delegate again.
+  EXPECT_CALL(*delegate_, getPsk("fizz")).WillOnce(Return(folly::none));
+  EXPECT_FALSE(cache_->getPsk("fizz"));
+}
+
+TEST_F(BurstPskCacheTest, TestPrefetchMiss) {
+  EXPECT_CALL(*delegate_, getPsk("fizz")).WillOnce(Return(folly::none));
+  cache_->prefetch({"fizz"});
+
+  // A pinned miss is shared too: the burst does not hammer the delegate.
+  EXPECT_FALSE(cache_->getPsk("fizz"));
+  EXPECT_FALSE(cache_->getPsk("fizz"));
+}
+
+TEST_F(BurstPskCacheTest, TestUnpinnedPassThrough) {
+  EXPECT_CALL(*delegate_, getPsk("buzz"))
+      .WillOnce(Return(getCachedPsk("psk 1")));
+  pskEq(getCachedPsk("psk 1"), *cache_->getPsk("buzz"));
+
+  EXPECT_CALL(*delegate_, putPsk("buzz", _));
+  cache_->putPsk("buzz", getCachedPsk("psk 2"));
+
+  EXPECT_CALL(*delegate_, removePsk("buzz"));
+  cache_->removePsk("buzz");
+}
+
+} // namespace test
+} // namespace client
+} // namespace fizz
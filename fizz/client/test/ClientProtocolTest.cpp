@@ -18,6 +18,8 @@
 #include <fizz/protocol/test/TestMessages.h>
 #include <fizz/record/test/Mocks.h>
 
+#include <folly/executors/ManualExecutor.h>
+
 using namespace fizz::test;
 using namespace folly;
 using namespace testing;
@@ -52,6 +54,21 @@ class ClientProtocolTest : public ProtocolTest<ClientTypes, Actions> {
   }
 
  protected:
+  Actions getActions(AsyncActions asyncActions, bool immediate = true) {
+    while (executor_.run())
+      ;
+    return folly::variant_match(
+        asyncActions,
+        ::fizz::detail::result_type<Actions>(),
+        [immediate](folly::Future<Actions>& futureActions) {
+          if (immediate) {
+            EXPECT_TRUE(futureActions.hasValue());
+          }
+          return std::move(futureActions).get();
+        },
+        [](Actions& immediateActions) { return std::move(immediateActions); });
+  }
+
   void setMockRecord() {
     mockRead_ = new MockPlaintextReadRecordLayer();
     mockWrite_ = new MockPlaintextWriteRecordLayer();
@@ -113,6 +130,7 @@ class ClientProtocolTest : public ProtocolTest<ClientTypes, Actions> {
 
   void setupExpectingServerHello() {
     setMockRecord();
+    state_.executor() = &executor_;
     state_.context() = context_;
     state_.encodedClientHello() = IOBuf::copyBuffer("chlo");
     auto mockKex = std::make_unique<MockKeyExchange>();
@@ -160,6 +178,7 @@ class ClientProtocolTest : public ProtocolTest<ClientTypes, Actions> {
   void setupExpectingEncryptedExtensions() {
     setMockRecord();
     setMockContextAndScheduler();
+    state_.executor() = &executor_;
     state_.context() = context_;
     state_.earlyDataType() = EarlyDataType::NotAttempted;
     state_.version() = TestProtocolVersion;
@@ -192,7 +211,9 @@ class ClientProtocolTest : public ProtocolTest<ClientTypes, Actions> {
   void setupExpectingCertificate() {
     setMockRecord();
     setMockContextAndScheduler();
+    state_.executor() = &executor_;
     state_.context() = context_;
+    state_.verifier() = verifier_;
     state_.state() = StateEnum::ExpectingCertificate;
     state_.handshakeTime() =
         std::chrono::system_clock::time_point(std::chrono::minutes(4));
@@ -201,6 +222,7 @@ class ClientProtocolTest : public ProtocolTest<ClientTypes, Actions> {
   void setupExpectingCertificateRequest() {
     setMockRecord();
     setMockContextAndScheduler();
+    state_.executor() = &executor_;
     context_->setClientCertificate(mockClientCert_);
     state_.context() = context_;
     state_.state() = StateEnum::ExpectingCertificate;
@@ -211,6 +233,7 @@ class ClientProtocolTest : public ProtocolTest<ClientTypes, Actions> {
   void setupExpectingCertificateVerify() {
     setMockRecord();
     setMockContextAndScheduler();
+    state_.executor() = &executor_;
     state_.context() = context_;
     state_.verifier() = verifier_;
     mockIntermediate_ = std::make_shared<MockPeerCert>();
@@ -227,6 +250,7 @@ class ClientProtocolTest : public ProtocolTest<ClientTypes, Actions> {
   void setupExpectingFinished() {
     setMockHandshakeEncryptedRecord();
     setMockContextAndScheduler();
+    state_.executor() = &executor_;
     state_.context() = context_;
     state_.version() = TestProtocolVersion;
     state_.cipher() = CipherSuite::TLS_AES_128_GCM_SHA256;
@@ -243,6 +267,7 @@ class ClientProtocolTest : public ProtocolTest<ClientTypes, Actions> {
   void setupAcceptingData() {
     setMockRecord();
     setMockContextAndScheduler();
+    state_.executor() = &executor_;
     state_.version() = ProtocolVersion::tls_1_3;
     state_.cipher() = CipherSuite::TLS_AES_128_GCM_SHA256;
     state_.group() = NamedGroup::x25519;
@@ -272,30 +297,34 @@ class ClientProtocolTest : public ProtocolTest<ClientTypes, Actions> {
   std::shared_ptr<MockCertificateVerifier> verifier_;
   std::shared_ptr<MockPskCache> pskCache_;
   std::shared_ptr<MockClock> mockClock_;
+  ManualExecutor executor_;
 };
 
 TEST_F(ClientProtocolTest, TestInvalidTransitionNoAlert) {
-  auto actions = ClientStateMachine().processAppWrite(state_, AppWrite());
+  auto actions = getActions(
+      ClientStateMachine().processAppWrite(state_, AppWrite()));
   expectError<FizzException>(actions, none, "invalid event");
 }
 
 TEST_F(ClientProtocolTest, TestInvalidWriteNewSessionTicket) {
-  auto actions = ClientStateMachine().processWriteNewSessionTicket(
-      state_, WriteNewSessionTicket());
+  auto actions = getActions(ClientStateMachine().processWriteNewSessionTicket(
+      state_, WriteNewSessionTicket()));
   expectError<FizzException>(actions, none, "invalid event");
 }
 
 TEST_F(ClientProtocolTest, TestInvalidTransitionAlert) {
   setMockRecord();
   EXPECT_CALL(*mockWrite_, _write(_));
-  auto actions = ClientStateMachine().processAppWrite(state_, AppWrite());
+  auto actions = getActions(
+      ClientStateMachine().processAppWrite(state_, AppWrite()));
   expectError<FizzException>(
       actions, AlertDescription::unexpected_message, "invalid event");
 }
 
 TEST_F(ClientProtocolTest, TestInvalidTransitionError) {
   state_.state() = StateEnum::Error;
-  auto actions = ClientStateMachine().processAppWrite(state_, AppWrite());
+  auto actions = getActions(
+      ClientStateMachine().processAppWrite(state_, AppWrite()));
   expectActions<ReportError>(actions);
 }
 
@@ -303,7 +332,8 @@ TEST_F(ClientProtocolTest, TestAlertEncryptionLevel) {
   setMockRecord();
   EXPECT_CALL(*mockWrite_, _write(_));
   auto encryptionLevel = state_.writeRecordLayer()->getEncryptionLevel();
-  auto actions = ClientStateMachine().processAppWrite(state_, AppWrite());
+  auto actions = getActions(
+      ClientStateMachine().processAppWrite(state_, AppWrite()));
   auto write = expectAction<WriteToSocket>(actions);
   EXPECT_EQ(write.contents.size(), 1);
   EXPECT_EQ(write.contents[0].encryptionLevel, encryptionLevel);
@@ -351,10 +381,11 @@ TEST_F(ClientProtocolTest, TestConnectFlow) {
       }));
 
   Connect connect;
+  connect.executor = &executor_;
   connect.context = context_;
   connect.sni = "www.hostname.com";
   connect.verifier = verifier_;
-  auto actions = detail::processEvent(state_, std::move(connect));
+  auto actions = getActions(detail::processEvent(state_, std::move(connect)));
 
   expectActions<MutateState, WriteToSocket>(actions);
   auto write = expectAction<WriteToSocket>(actions);
@@ -448,11 +479,12 @@ TEST_F(ClientProtocolTest, TestConnectPskFlow) {
       .InSequence(contextSeq);
 
   Connect connect;
+  connect.executor = &executor_;
   connect.context = context_;
   connect.sni = "www.hostname.com";
   connect.cachedPsk = psk;
   connect.verifier = verifier_;
-  auto actions = detail::processEvent(state_, std::move(connect));
+  auto actions = getActions(detail::processEvent(state_, std::move(connect)));
 
   expectActions<MutateState, WriteToSocket>(actions);
   auto write = expectAction<WriteToSocket>(actions);
@@ -576,11 +608,12 @@ TEST_F(ClientProtocolTest, TestConnectPskEarlyFlow) {
       &earlyRecordLayer, &earlyAead, StringPiece("cet"));
 
   Connect connect;
+  connect.executor = &executor_;
   connect.context = context_;
   connect.sni = "www.hostname.com";
   connect.cachedPsk = psk;
   connect.verifier = verifier_;
-  auto actions = detail::processEvent(state_, std::move(connect));
+  auto actions = getActions(detail::processEvent(state_, std::move(connect)));
 
   expectActions<
       MutateState,
@@ -621,8 +654,9 @@ TEST_F(ClientProtocolTest, TestConnectPskEarlyFlow) {
 
 TEST_F(ClientProtocolTest, TestConnectNoHostNoPsk) {
   Connect connect;
+  connect.executor = &executor_;
   connect.context = context_;
-  auto actions = detail::processEvent(state_, std::move(connect));
+  auto actions = getActions(detail::processEvent(state_, std::move(connect)));
   expectActions<MutateState, WriteToSocket>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingServerHello);
@@ -631,12 +665,13 @@ TEST_F(ClientProtocolTest, TestConnectNoHostNoPsk) {
 
 TEST_F(ClientProtocolTest, TestConnectPskStaleHandshake) {
   Connect connect;
+  connect.executor = &executor_;
   connect.context = context_;
   connect.cachedPsk = getCachedPsk();
   std::string sni = "www.hostname.com";
   connect.sni = sni;
   context_->setMaxPskHandshakeLife(std::chrono::seconds(1));
-  auto actions = detail::processEvent(state_, std::move(connect));
+  auto actions = getActions(detail::processEvent(state_, std::move(connect)));
   expectActions<MutateState, WriteToSocket>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingServerHello);
@@ -645,6 +680,7 @@ TEST_F(ClientProtocolTest, TestConnectPskStaleHandshake) {
 
 TEST_F(ClientProtocolTest, TestConnectPskFutureHandshake) {
   Connect connect;
+  connect.executor = &executor_;
   connect.context = context_;
   connect.cachedPsk = getTestPsk(
       "PSK", std::chrono::system_clock::time_point(std::chrono::hours(86400)));
@@ -653,7 +689,7 @@ TEST_F(ClientProtocolTest, TestConnectPskFutureHandshake) {
   std::string sni = "www.hostname.com";
   connect.sni = sni;
   context_->setMaxPskHandshakeLife(std::chrono::seconds(1));
-  auto actions = detail::processEvent(state_, std::move(connect));
+  auto actions = getActions(detail::processEvent(state_, std::move(connect)));
   expectActions<MutateState, WriteToSocket>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingServerHello);
@@ -662,11 +698,12 @@ TEST_F(ClientProtocolTest, TestConnectPskFutureHandshake) {
 
 TEST_F(ClientProtocolTest, TestConnectPskBadVersion) {
   Connect connect;
+  connect.executor = &executor_;
   connect.context = context_;
   auto psk = getCachedPsk();
   psk.version = ProtocolVersion::tls_1_2;
   connect.cachedPsk = psk;
-  auto actions = detail::processEvent(state_, std::move(connect));
+  auto actions = getActions(detail::processEvent(state_, std::move(connect)));
   expectActions<MutateState, WriteToSocket>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingServerHello);
@@ -676,11 +713,12 @@ TEST_F(ClientProtocolTest, TestConnectPskBadVersion) {
 TEST_F(ClientProtocolTest, TestConnectPskBadCipher) {
   context_->setSupportedCiphers({CipherSuite::TLS_AES_128_GCM_SHA256});
   Connect connect;
+  connect.executor = &executor_;
   connect.context = context_;
   auto psk = getCachedPsk();
   psk.cipher = CipherSuite::TLS_AES_256_GCM_SHA384;
   connect.cachedPsk = psk;
-  auto actions = detail::processEvent(state_, std::move(connect));
+  auto actions = getActions(detail::processEvent(state_, std::move(connect)));
   expectActions<MutateState, WriteToSocket>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingServerHello);
@@ -689,11 +727,12 @@ TEST_F(ClientProtocolTest, TestConnectPskBadCipher) {
 
 TEST_F(ClientProtocolTest, TestConnectSeparatePskIdentity) {
   Connect connect;
+  connect.executor = &executor_;
   connect.context = context_;
   connect.sni = "www.hostname.com";
   auto psk = getCachedPsk();
   connect.cachedPsk = psk;
-  auto actions = detail::processEvent(state_, std::move(connect));
+  auto actions = getActions(detail::processEvent(state_, std::move(connect)));
   expectActions<MutateState, WriteToSocket>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingServerHello);
@@ -702,10 +741,11 @@ TEST_F(ClientProtocolTest, TestConnectSeparatePskIdentity) {
 
 TEST_F(ClientProtocolTest, TestConnectPskIdentityWithoutSni) {
   Connect connect;
+  connect.executor = &executor_;
   connect.context = context_;
   auto psk = getCachedPsk();
   connect.cachedPsk = psk;
-  auto actions = detail::processEvent(state_, std::move(connect));
+  auto actions = getActions(detail::processEvent(state_, std::move(connect)));
   expectActions<MutateState, WriteToSocket>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingServerHello);
@@ -715,9 +755,10 @@ TEST_F(ClientProtocolTest, TestConnectPskIdentityWithoutSni) {
 
 TEST_F(ClientProtocolTest, TestConnectNoSni) {
   Connect connect;
+  connect.executor = &executor_;
   connect.context = context_;
   connect.verifier = verifier_;
-  auto actions = detail::processEvent(state_, std::move(connect));
+  auto actions = getActions(detail::processEvent(state_, std::move(connect)));
   expectActions<MutateState, WriteToSocket>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingServerHello);
@@ -732,9 +773,10 @@ TEST_F(ClientProtocolTest, TestConnectNoSni) {
 TEST_F(ClientProtocolTest, TestConnectNoAlpn) {
   context_->setSupportedAlpns({});
   Connect connect;
+  connect.executor = &executor_;
   connect.context = context_;
   connect.sni = "www.hostname.com";
-  auto actions = detail::processEvent(state_, std::move(connect));
+  auto actions = getActions(detail::processEvent(state_, std::move(connect)));
   expectActions<MutateState, WriteToSocket>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingServerHello);
@@ -747,6 +789,7 @@ TEST_F(ClientProtocolTest, TestConnectNoAlpn) {
 
 TEST_F(ClientProtocolTest, TestConnectExtension) {
   Connect connect;
+  connect.executor = &executor_;
   connect.context = context_;
   connect.verifier = verifier_;
   connect.sni = "www.hostname.com";
@@ -761,7 +804,7 @@ TEST_F(ClientProtocolTest, TestConnectExtension) {
         exts.push_back(std::move(ext));
         return exts;
       }));
-  auto actions = detail::processEvent(state_, std::move(connect));
+  auto actions = getActions(detail::processEvent(state_, std::move(connect)));
   expectActions<MutateState, WriteToSocket>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingServerHello);
@@ -800,9 +843,10 @@ TEST_F(ClientProtocolTest, TestConnectMultipleShares) {
 
   context_->setDefaultShares({NamedGroup::x25519, NamedGroup::secp256r1});
   Connect connect;
+  connect.executor = &executor_;
   connect.context = context_;
   connect.sni = "www.hostname.com";
-  auto actions = detail::processEvent(state_, std::move(connect));
+  auto actions = getActions(detail::processEvent(state_, std::move(connect)));
   expectActions<MutateState, WriteToSocket>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingServerHello);
@@ -829,9 +873,10 @@ TEST_F(ClientProtocolTest, TestConnectCachedGroup) {
   psk.group = NamedGroup::secp256r1;
 
   Connect connect;
+  connect.executor = &executor_;
   connect.context = context_;
   connect.cachedPsk = psk;
-  auto actions = detail::processEvent(state_, std::move(connect));
+  auto actions = getActions(detail::processEvent(state_, std::move(connect)));
   expectActions<MutateState, WriteToSocket>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingServerHello);
@@ -839,12 +884,62 @@ TEST_F(ClientProtocolTest, TestConnectCachedGroup) {
   EXPECT_EQ(state_.keyExchangers()->at(NamedGroup::secp256r1).get(), mockKex);
 }
 
+TEST_F(ClientProtocolTest, TestConnectGroupMemory) {
+  context_->setDefaultShares({NamedGroup::x25519, NamedGroup::secp256r1});
+  auto groupMemoryCache = std::make_shared<MockGroupMemoryCache>();
+  context_->setGroupMemoryCache(groupMemoryCache);
+  EXPECT_CALL(*groupMemoryCache, getGroup("www.hostname.com"))
+      .WillOnce(Return(NamedGroup::secp256r1));
+  MockKeyExchange* mockKex;
+  EXPECT_CALL(*factory_, makeKeyExchange(NamedGroup::secp256r1))
+      .WillOnce(InvokeWithoutArgs([&mockKex]() {
+        auto ret = std::make_unique<MockKeyExchange>();
+        EXPECT_CALL(*ret, generateKeyPair());
+        EXPECT_CALL(*ret, getKeyShare()).WillOnce(InvokeWithoutArgs([]() {
+          return IOBuf::copyBuffer("p256share");
+        }));
+        mockKex = ret.get();
+        return ret;
+      }));
+
+  Connect connect;
+  connect.executor = &executor_;
+  connect.context = context_;
+  connect.sni = "www.hostname.com";
+  auto actions = getActions(detail::processEvent(state_, std::move(connect)));
+  expectActions<MutateState, WriteToSocket>(actions);
+  processStateMutations(actions);
+  EXPECT_EQ(state_.state(), StateEnum::ExpectingServerHello);
+  EXPECT_EQ(state_.keyExchangers()->size(), 1);
+  EXPECT_EQ(state_.keyExchangers()->at(NamedGroup::secp256r1).get(), mockKex);
+}
+
+TEST_F(ClientProtocolTest, TestConnectGroupMemoryUnsupported) {
+  context_->setDefaultShares({NamedGroup::x25519});
+  auto groupMemoryCache = std::make_shared<MockGroupMemoryCache>();
+  context_->setGroupMemoryCache(groupMemoryCache);
+  EXPECT_CALL(*groupMemoryCache, getGroup("www.hostname.com"))
+      .WillOnce(Return(static_cast<NamedGroup>(0x8923)));
+
+  Connect connect;
+  connect.executor = &executor_;
+  connect.context = context_;
+  connect.sni = "www.hostname.com";
+  auto actions = getActions(detail::processEvent(state_, std::move(connect)));
+  expectActions<MutateState, WriteToSocket>(actions);
+  processStateMutations(actions);
+  EXPECT_EQ(state_.state(), StateEnum::ExpectingServerHello);
+  EXPECT_EQ(state_.keyExchangers()->size(), 1);
+  EXPECT_EQ(state_.keyExchangers()->count(NamedGroup::x25519), 1);
+}
+
 TEST_F(ClientProtocolTest, TestConnectNoShares) {
   context_->setDefaultShares({});
   Connect connect;
+  connect.executor = &executor_;
   connect.context = context_;
   connect.sni = "www.hostname.com";
-  auto actions = detail::processEvent(state_, std::move(connect));
+  auto actions = getActions(detail::processEvent(state_, std::move(connect)));
   expectActions<MutateState, WriteToSocket>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingServerHello);
@@ -853,11 +948,12 @@ TEST_F(ClientProtocolTest, TestConnectNoShares) {
 
 TEST_F(ClientProtocolTest, TestConnectPskEarly) {
   Connect connect;
+  connect.executor = &executor_;
   connect.context = context_;
   auto psk = getCachedPsk();
   psk.maxEarlyDataSize = 1000;
   connect.cachedPsk = psk;
-  auto actions = detail::processEvent(state_, std::move(connect));
+  auto actions = getActions(detail::processEvent(state_, std::move(connect)));
   expectActions<
       MutateState,
       WriteToSocket,
@@ -871,12 +967,13 @@ TEST_F(ClientProtocolTest, TestConnectPskEarly) {
 
 TEST_F(ClientProtocolTest, TestConnectPskEarlyNoAlpn) {
   Connect connect;
+  connect.executor = &executor_;
   connect.context = context_;
   auto psk = getCachedPsk();
   psk.maxEarlyDataSize = 1000;
   psk.alpn = folly::none;
   connect.cachedPsk = psk;
-  auto actions = detail::processEvent(state_, std::move(connect));
+  auto actions = getActions(detail::processEvent(state_, std::move(connect)));
   expectActions<
       MutateState,
       WriteToSocket,
@@ -892,11 +989,12 @@ TEST_F(ClientProtocolTest, TestConnectPskEarlyNoAlpn) {
 TEST_F(ClientProtocolTest, TestConnectPskEarlyDisabled) {
   context_->setSendEarlyData(false);
   Connect connect;
+  connect.executor = &executor_;
   connect.context = context_;
   auto psk = getCachedPsk();
   psk.maxEarlyDataSize = 1000;
   connect.cachedPsk = psk;
-  auto actions = detail::processEvent(state_, std::move(connect));
+  auto actions = getActions(detail::processEvent(state_, std::move(connect)));
   expectActions<MutateState, WriteToSocket>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingServerHello);
@@ -906,12 +1004,13 @@ TEST_F(ClientProtocolTest, TestConnectPskEarlyDisabled) {
 
 TEST_F(ClientProtocolTest, TestConnectPskEarlyAlpnMismatch) {
   Connect connect;
+  connect.executor = &executor_;
   connect.context = context_;
   auto psk = getCachedPsk();
   psk.maxEarlyDataSize = 1000;
   psk.alpn = "gopher";
   connect.cachedPsk = psk;
-  auto actions = detail::processEvent(state_, std::move(connect));
+  auto actions = getActions(detail::processEvent(state_, std::move(connect)));
   expectActions<MutateState, WriteToSocket>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingServerHello);
@@ -922,11 +1021,12 @@ TEST_F(ClientProtocolTest, TestConnectPskEarlyAlpnMismatch) {
 TEST_F(ClientProtocolTest, TestConnectPskEarlyOmitEarlyRecord) {
   context_->setOmitEarlyRecordLayer(true);
   Connect connect;
+  connect.executor = &executor_;
   connect.context = context_;
   auto psk = getCachedPsk();
   psk.maxEarlyDataSize = 1000;
   connect.cachedPsk = psk;
-  auto actions = detail::processEvent(state_, std::move(connect));
+  auto actions = getActions(detail::processEvent(state_, std::move(connect)));
   expectActions<
       MutateState,
       WriteToSocket,
@@ -942,9 +1042,10 @@ TEST_F(ClientProtocolTest, TestConnectPskEarlyOmitEarlyRecord) {
 TEST_F(ClientProtocolTest, TestConnectCompat) {
   context_->setCompatibilityMode(true);
   Connect connect;
+  connect.executor = &executor_;
   connect.context = context_;
   connect.sni = "www.hostname.com";
-  auto actions = detail::processEvent(state_, std::move(connect));
+  auto actions = getActions(detail::processEvent(state_, std::move(connect)));
   expectActions<MutateState, WriteToSocket>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingServerHello);
@@ -955,11 +1056,12 @@ TEST_F(ClientProtocolTest, TestConnectCompat) {
 TEST_F(ClientProtocolTest, TestConnectCompatEarly) {
   context_->setCompatibilityMode(true);
   Connect connect;
+  connect.executor = &executor_;
   connect.context = context_;
   auto psk = getCachedPsk();
   psk.maxEarlyDataSize = 1000;
   connect.cachedPsk = psk;
-  auto actions = detail::processEvent(state_, std::move(connect));
+  auto actions = getActions(detail::processEvent(state_, std::move(connect)));
   expectActions<
       MutateState,
       WriteToSocket,
@@ -1035,7 +1137,8 @@ TEST_F(ClientProtocolTest, TestServerHelloFlow) {
   expectEncryptedReadRecordLayerCreation(&rrl, &raead, StringPiece("sht"));
   expectEncryptedWriteRecordLayerCreation(&wrl, &waead, StringPiece("cht"));
 
-  auto actions = detail::processEvent(state_, TestMessages::serverHello());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::serverHello()));
   expectActions<MutateState, SecretAvailable>(actions);
 
   expectSecret(
@@ -1123,7 +1226,8 @@ TEST_F(ClientProtocolTest, TestServerHelloAfterHrrFlow) {
   expectEncryptedReadRecordLayerCreation(&rrl, &raead, StringPiece("sht"));
   expectEncryptedWriteRecordLayerCreation(&wrl, &waead, StringPiece("cht"));
 
-  auto actions = detail::processEvent(state_, TestMessages::serverHello());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::serverHello()));
   expectActions<MutateState, SecretAvailable>(actions);
   expectSecret(
       actions, HandshakeSecrets::ServerHandshakeTraffic, StringPiece("sht"));
@@ -1221,7 +1325,8 @@ TEST_F(ClientProtocolTest, TestServerHelloPskFlow) {
   expectEncryptedReadRecordLayerCreation(&rrl, &raead, StringPiece("sht"));
   expectEncryptedWriteRecordLayerCreation(&wrl, &waead, StringPiece("cht"));
 
-  auto actions = detail::processEvent(state_, TestMessages::serverHelloPsk());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::serverHelloPsk()));
   expectActions<MutateState, SecretAvailable>(actions);
   expectSecret(
       actions, HandshakeSecrets::ServerHandshakeTraffic, StringPiece("sht"));
@@ -1319,7 +1424,7 @@ TEST_F(ClientProtocolTest, TestServerHelloPskNoDhFlow) {
 
   auto shlo = TestMessages::serverHelloPsk();
   TestMessages::removeExtension(shlo, ExtensionType::key_share);
-  auto actions = detail::processEvent(state_, std::move(shlo));
+  auto actions = getActions(detail::processEvent(state_, std::move(shlo)));
   expectActions<MutateState, SecretAvailable>(actions);
 
   expectSecret(
@@ -1409,7 +1514,8 @@ TEST_F(ClientProtocolTest, TestServerHelloPskAfterHrrFlow) {
   expectEncryptedReadRecordLayerCreation(&rrl, &raead, StringPiece("sht"));
   expectEncryptedWriteRecordLayerCreation(&wrl, &waead, StringPiece("cht"));
 
-  auto actions = detail::processEvent(state_, TestMessages::serverHelloPsk());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::serverHelloPsk()));
   expectActions<MutateState, SecretAvailable>(actions);
   expectSecret(
       actions, HandshakeSecrets::ServerHandshakeTraffic, StringPiece("sht"));
@@ -1445,7 +1551,8 @@ TEST_F(ClientProtocolTest, TestServerHelloPskAfterHrrFlow) {
 
 TEST_F(ClientProtocolTest, TestServerHello) {
   setupExpectingServerHello();
-  auto actions = detail::processEvent(state_, TestMessages::serverHello());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::serverHello()));
   expectActions<MutateState, SecretAvailable>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingEncryptedExtensions);
@@ -1457,7 +1564,8 @@ TEST_F(ClientProtocolTest, TestServerHello) {
 TEST_F(ClientProtocolTest, TestServerHelloPsk) {
   setupExpectingServerHello();
   state_.attemptedPsk() = getCachedPsk();
-  auto actions = detail::processEvent(state_, TestMessages::serverHelloPsk());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::serverHelloPsk()));
   expectActions<MutateState, SecretAvailable>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingEncryptedExtensions);
@@ -1471,7 +1579,8 @@ TEST_F(ClientProtocolTest, TestServerHelloPsk) {
 TEST_F(ClientProtocolTest, TestServerHelloPskRejected) {
   setupExpectingServerHello();
   state_.attemptedPsk() = getCachedPsk();
-  auto actions = detail::processEvent(state_, TestMessages::serverHello());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::serverHello()));
   expectActions<MutateState, SecretAvailable>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingEncryptedExtensions);
@@ -1485,7 +1594,8 @@ TEST_F(ClientProtocolTest, TestServerHelloExtraData) {
   setupExpectingServerHello();
   EXPECT_CALL(*mockRead_, hasUnparsedHandshakeData())
       .WillRepeatedly(Return(true));
-  auto actions = detail::processEvent(state_, TestMessages::serverHello());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::serverHello()));
   expectError<FizzException>(
       actions, AlertDescription::unexpected_message, "data after server hello");
 }
@@ -1497,7 +1607,7 @@ TEST_F(ClientProtocolTest, TestServerHelloBadVersion) {
   ServerSupportedVersions supportedVersions;
   supportedVersions.selected_version = ProtocolVersion::tls_1_1;
   shlo.extensions.push_back(encodeExtension(std::move(supportedVersions)));
-  auto actions = detail::processEvent(state_, std::move(shlo));
+  auto actions = getActions(detail::processEvent(state_, std::move(shlo)));
   expectError<FizzException>(
       actions,
       AlertDescription::protocol_version,
@@ -1508,7 +1618,7 @@ TEST_F(ClientProtocolTest, TestServerHelloBadCipher) {
   setupExpectingServerHello();
   auto shlo = TestMessages::serverHello();
   shlo.cipher_suite = static_cast<CipherSuite>(0x03ff);
-  auto actions = detail::processEvent(state_, std::move(shlo));
+  auto actions = getActions(detail::processEvent(state_, std::move(shlo)));
   expectError<FizzException>(
       actions, AlertDescription::handshake_failure, "unsupported cipher");
 }
@@ -1523,7 +1633,7 @@ TEST_F(ClientProtocolTest, TestServerHelloBadGroup) {
   serverKeyShare.server_share.key_exchange =
       folly::IOBuf::copyBuffer("servershare");
   shlo.extensions.push_back(encodeExtension(std::move(serverKeyShare)));
-  auto actions = detail::processEvent(state_, std::move(shlo));
+  auto actions = getActions(detail::processEvent(state_, std::move(shlo)));
   expectError<FizzException>(
       actions, AlertDescription::handshake_failure, "unsupported group");
 }
@@ -1532,7 +1642,7 @@ TEST_F(ClientProtocolTest, TestServerHelloNoKeyShare) {
   setupExpectingServerHello();
   auto shlo = TestMessages::serverHello();
   TestMessages::removeExtension(shlo, ExtensionType::key_share);
-  auto actions = detail::processEvent(state_, std::move(shlo));
+  auto actions = getActions(detail::processEvent(state_, std::move(shlo)));
   expectError<FizzException>(
       actions, AlertDescription::handshake_failure, "did not send share");
 }
@@ -1540,7 +1650,8 @@ TEST_F(ClientProtocolTest, TestServerHelloNoKeyShare) {
 TEST_F(ClientProtocolTest, TestServerHelloHrrBadVersion) {
   setupExpectingServerHelloAfterHrr();
   state_.version() = ProtocolVersion::tls_1_2;
-  auto actions = detail::processEvent(state_, TestMessages::serverHello());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::serverHello()));
   expectError<FizzException>(
       actions, AlertDescription::handshake_failure, "version does not match");
 }
@@ -1548,7 +1659,8 @@ TEST_F(ClientProtocolTest, TestServerHelloHrrBadVersion) {
 TEST_F(ClientProtocolTest, TestServerHelloHrrBadCipher) {
   setupExpectingServerHelloAfterHrr();
   state_.cipher() = CipherSuite::TLS_AES_256_GCM_SHA384;
-  auto actions = detail::processEvent(state_, TestMessages::serverHello());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::serverHello()));
   expectError<FizzException>(
       actions, AlertDescription::handshake_failure, "cipher does not match");
 }
@@ -1561,7 +1673,8 @@ TEST_F(ClientProtocolTest, TestServerHelloHrrBadGroup) {
   kexs.emplace(NamedGroup::secp256r1, std::move(mockKex));
   state_.keyExchangers() = std::move(kexs);
 
-  auto actions = detail::processEvent(state_, TestMessages::serverHello());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::serverHello()));
   expectError<FizzException>(
       actions, AlertDescription::handshake_failure, "group");
 }
@@ -1573,7 +1686,8 @@ TEST_F(ClientProtocolTest, TestServerHelloPskAcceptedNotSent) {
        ExtensionType::key_share,
        ExtensionType::server_name,
        ExtensionType::application_layer_protocol_negotiation});
-  auto actions = detail::processEvent(state_, TestMessages::serverHelloPsk());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::serverHelloPsk()));
   expectError<FizzException>(
       actions,
       AlertDescription::illegal_parameter,
@@ -1587,7 +1701,7 @@ TEST_F(ClientProtocolTest, TestServerHelloOtherPskAccepted) {
   ServerPresharedKey pskExt;
   pskExt.selected_identity = 1;
   shlo.extensions.push_back(encodeExtension(std::move(pskExt)));
-  auto actions = detail::processEvent(state_, std::move(shlo));
+  auto actions = getActions(detail::processEvent(state_, std::move(shlo)));
   expectError<FizzException>(
       actions, AlertDescription::illegal_parameter, "non-0 psk");
 }
@@ -1596,7 +1710,8 @@ TEST_F(ClientProtocolTest, TestServerHelloPskDifferentHash) {
   setupExpectingServerHello();
   state_.attemptedPsk() = getCachedPsk();
   state_.attemptedPsk()->cipher = CipherSuite::TLS_AES_256_GCM_SHA384;
-  auto actions = detail::processEvent(state_, TestMessages::serverHelloPsk());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::serverHelloPsk()));
   expectError<FizzException>(
       actions,
       AlertDescription::handshake_failure,
@@ -1607,7 +1722,8 @@ TEST_F(ClientProtocolTest, TestServerHelloPskDifferentCompatibleCipher) {
   setupExpectingServerHello();
   state_.attemptedPsk() = getCachedPsk();
   state_.attemptedPsk()->cipher = CipherSuite::TLS_CHACHA20_POLY1305_SHA256;
-  auto actions = detail::processEvent(state_, TestMessages::serverHelloPsk());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::serverHelloPsk()));
   expectActions<MutateState, SecretAvailable>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingEncryptedExtensions);
@@ -1622,7 +1738,8 @@ TEST_F(ClientProtocolTest, TestServerHelloPskDheNotSupported) {
   context_->setSupportedPskModes({PskKeyExchangeMode::psk_ke});
   setupExpectingServerHello();
   state_.attemptedPsk() = getCachedPsk();
-  auto actions = detail::processEvent(state_, TestMessages::serverHelloPsk());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::serverHelloPsk()));
   expectError<FizzException>(
       actions, AlertDescription::handshake_failure, "unsupported psk mode");
 }
@@ -1632,7 +1749,8 @@ TEST_F(ClientProtocolTest, TestServerHelloExtensions) {
   auto ext = std::make_shared<MockClientExtensions>();
   state_.extensions() = ext;
   EXPECT_CALL(*ext, onEncryptedExtensions(_));
-  auto actions = detail::processEvent(state_, TestMessages::encryptedExt());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::encryptedExt()));
   expectActions<MutateState>(actions);
   processStateMutations(actions);
 }
@@ -1643,7 +1761,7 @@ TEST_F(ClientProtocolTest, TestServerHelloPskKeNotSupported) {
   state_.attemptedPsk() = getCachedPsk();
   auto shlo = TestMessages::serverHelloPsk();
   TestMessages::removeExtension(shlo, ExtensionType::key_share);
-  auto actions = detail::processEvent(state_, std::move(shlo));
+  auto actions = getActions(detail::processEvent(state_, std::move(shlo)));
   expectError<FizzException>(
       actions, AlertDescription::handshake_failure, "unsupported psk mode");
 }
@@ -1652,18 +1770,19 @@ TEST_F(ClientProtocolTest, TestServerHelloBadSessionId) {
   setupExpectingServerHello();
   auto shlo = TestMessages::serverHello();
   shlo.legacy_session_id_echo = IOBuf::copyBuffer("hi!!");
-  auto actions = detail::processEvent(state_, std::move(shlo));
+  auto actions = getActions(detail::processEvent(state_, std::move(shlo)));
   expectError<FizzException>(
       actions, AlertDescription::illegal_parameter, "session id");
 }
 
 TEST_F(ClientProtocolTest, TestConnectPskKeNoShares) {
   Connect connect;
+  connect.executor = &executor_;
   connect.context = context_;
   auto psk = getCachedPsk();
   psk.group = folly::none;
   connect.cachedPsk = psk;
-  auto actions = detail::processEvent(state_, std::move(connect));
+  auto actions = getActions(detail::processEvent(state_, std::move(connect)));
   expectActions<MutateState, WriteToSocket>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingServerHello);
@@ -1741,7 +1860,8 @@ TEST_F(ClientProtocolTest, TestHelloRetryRequestFlow) {
   }));
 
   auto actions =
-      detail::processEvent(state_, TestMessages::helloRetryRequest());
+      getActions(
+          detail::processEvent(state_, TestMessages::helloRetryRequest()));
   expectActions<MutateState, WriteToSocket>(actions);
   auto write = expectAction<WriteToSocket>(actions);
   EXPECT_TRUE(
@@ -1848,7 +1968,8 @@ TEST_F(ClientProtocolTest, TestHelloRetryRequestPskFlow) {
   }));
 
   auto actions =
-      detail::processEvent(state_, TestMessages::helloRetryRequest());
+      getActions(
+          detail::processEvent(state_, TestMessages::helloRetryRequest()));
   expectActions<MutateState, WriteToSocket>(actions);
   auto write = expectAction<WriteToSocket>(actions);
   EXPECT_EQ(write.contents[0].contentType, ContentType::handshake);
@@ -1882,7 +2003,8 @@ TEST_F(ClientProtocolTest, TestHelloRetryRequestPskFlow) {
 TEST_F(ClientProtocolTest, TestHelloRetryRequest) {
   setupExpectingServerHello();
   auto actions =
-      detail::processEvent(state_, TestMessages::helloRetryRequest());
+      getActions(
+          detail::processEvent(state_, TestMessages::helloRetryRequest()));
   expectActions<MutateState, WriteToSocket>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingServerHello);
@@ -1893,7 +2015,8 @@ TEST_F(ClientProtocolTest, TestHelloRetryRequestPskDifferentHash) {
   state_.attemptedPsk() = getCachedPsk();
   state_.attemptedPsk()->cipher = CipherSuite::TLS_AES_256_GCM_SHA384;
   auto actions =
-      detail::processEvent(state_, TestMessages::helloRetryRequest());
+      getActions(
+          detail::processEvent(state_, TestMessages::helloRetryRequest()));
   expectActions<MutateState, WriteToSocket>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingServerHello);
@@ -1904,7 +2027,8 @@ TEST_F(ClientProtocolTest, TestDoubleHelloRetryRequest) {
   setupExpectingServerHello();
   state_.keyExchangeType() = KeyExchangeType::HelloRetryRequest;
   auto actions =
-      detail::processEvent(state_, TestMessages::helloRetryRequest());
+      getActions(
+          detail::processEvent(state_, TestMessages::helloRetryRequest()));
   expectError<FizzException>(
       actions, AlertDescription::unexpected_message, "two HRRs");
 }
@@ -1916,7 +2040,7 @@ TEST_F(ClientProtocolTest, TestHelloRetryRequestBadVersion) {
   ServerSupportedVersions supportedVersions;
   supportedVersions.selected_version = ProtocolVersion::tls_1_1;
   hrr.extensions.push_back(encodeExtension(std::move(supportedVersions)));
-  auto actions = detail::processEvent(state_, std::move(hrr));
+  auto actions = getActions(detail::processEvent(state_, std::move(hrr)));
   expectError<FizzException>(
       actions,
       AlertDescription::protocol_version,
@@ -1927,7 +2051,7 @@ TEST_F(ClientProtocolTest, TestHelloRetryRequestBadCipher) {
   setupExpectingServerHello();
   auto hrr = TestMessages::helloRetryRequest();
   hrr.cipher_suite = static_cast<CipherSuite>(0x03ff);
-  auto actions = detail::processEvent(state_, std::move(hrr));
+  auto actions = getActions(detail::processEvent(state_, std::move(hrr)));
   expectError<FizzException>(
       actions, AlertDescription::handshake_failure, "unsupported cipher");
 }
@@ -1939,7 +2063,7 @@ TEST_F(ClientProtocolTest, TestHelloRetryRequestBadGroup) {
   HelloRetryRequestKeyShare keyShare;
   keyShare.selected_group = static_cast<NamedGroup>(0x8923);
   hrr.extensions.push_back(encodeExtension(std::move(keyShare)));
-  auto actions = detail::processEvent(state_, std::move(hrr));
+  auto actions = getActions(detail::processEvent(state_, std::move(hrr)));
   expectError<FizzException>(
       actions, AlertDescription::handshake_failure, "unsupported group");
 }
@@ -1952,7 +2076,7 @@ TEST_F(ClientProtocolTest, TestHelloRetryRequestGroupAlreadySent) {
   keyShare.selected_group = NamedGroup::x25519;
   hrr.extensions.push_back(encodeExtension(std::move(keyShare)));
 
-  auto actions = detail::processEvent(state_, std::move(hrr));
+  auto actions = getActions(detail::processEvent(state_, std::move(hrr)));
   expectError<FizzException>(
       actions, AlertDescription::illegal_parameter, "already-sent group");
 }
@@ -1965,7 +2089,7 @@ TEST_F(ClientProtocolTest, TestHelloRetryRequestNoKeyShare) {
   state_.keyExchangers()->emplace(NamedGroup::secp256r1, std::move(mockKex));
   auto hrr = TestMessages::helloRetryRequest();
   TestMessages::removeExtension(hrr, ExtensionType::key_share);
-  auto actions = detail::processEvent(state_, std::move(hrr));
+  auto actions = getActions(detail::processEvent(state_, std::move(hrr)));
   expectActions<MutateState, WriteToSocket>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingServerHello);
@@ -1980,7 +2104,7 @@ TEST_F(ClientProtocolTest, TestHelloRetryRequestCookie) {
   Cookie cookie;
   cookie.cookie = folly::IOBuf::copyBuffer("cookie!!");
   hrr.extensions.push_back(encodeExtension(std::move(cookie)));
-  auto actions = detail::processEvent(state_, std::move(hrr));
+  auto actions = getActions(detail::processEvent(state_, std::move(hrr)));
   expectActions<MutateState, WriteToSocket>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingServerHello);
@@ -1992,7 +2116,8 @@ TEST_F(ClientProtocolTest, TestHelloRetryRequestAttemptedEarly) {
   setupExpectingServerHello();
   state_.earlyDataType() = EarlyDataType::Attempted;
   auto actions =
-      detail::processEvent(state_, TestMessages::helloRetryRequest());
+      getActions(
+          detail::processEvent(state_, TestMessages::helloRetryRequest()));
   expectActions<MutateState, WriteToSocket>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingServerHello);
@@ -2004,7 +2129,8 @@ TEST_F(ClientProtocolTest, TestHelloRetryRequestCompat) {
   context_->setCompatibilityMode(true);
   setupExpectingServerHello();
   auto actions =
-      detail::processEvent(state_, TestMessages::helloRetryRequest());
+      getActions(
+          detail::processEvent(state_, TestMessages::helloRetryRequest()));
   expectActions<MutateState, WriteToSocket>(actions);
   processStateMutations(actions);
   auto write = expectAction<WriteToSocket>(actions);
@@ -2023,7 +2149,8 @@ TEST_F(ClientProtocolTest, TestEncryptedExtensionsFlow) {
   EXPECT_CALL(
       *mockHandshakeContext_, appendToTranscript(BufMatches("eeencoding")));
 
-  auto actions = detail::processEvent(state_, TestMessages::encryptedExt());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::encryptedExt()));
   expectActions<MutateState>(actions);
   processStateMutations(actions);
   EXPECT_EQ(*state_.alpn(), "h2");
@@ -2037,7 +2164,8 @@ TEST_F(ClientProtocolTest, TestEncryptedExtensionsPsk) {
   EXPECT_CALL(
       *mockHandshakeContext_, appendToTranscript(BufMatches("eeencoding")));
 
-  auto actions = detail::processEvent(state_, TestMessages::encryptedExt());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::encryptedExt()));
   expectActions<MutateState>(actions);
   processStateMutations(actions);
   EXPECT_EQ(*state_.alpn(), "h2");
@@ -2048,7 +2176,8 @@ TEST_F(ClientProtocolTest, TestEncryptedExtensionsPsk) {
 TEST_F(ClientProtocolTest, TestEncryptedExtensionsAlpn) {
   context_->setSupportedAlpns({"h2"});
   setupExpectingEncryptedExtensions();
-  auto actions = detail::processEvent(state_, TestMessages::encryptedExt());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::encryptedExt()));
   expectActions<MutateState>(actions);
   processStateMutations(actions);
   EXPECT_EQ(*state_.alpn(), "h2");
@@ -2062,7 +2191,7 @@ TEST_F(ClientProtocolTest, TestEncryptedExtensionsEmptyAlpn) {
   TestMessages::removeExtension(
       ee, ExtensionType::application_layer_protocol_negotiation);
   ee.extensions.push_back(encodeExtension(ProtocolNameList()));
-  auto actions = detail::processEvent(state_, std::move(ee));
+  auto actions = getActions(detail::processEvent(state_, std::move(ee)));
   expectError<FizzException>(
       actions, AlertDescription::illegal_parameter, "alpn list");
 }
@@ -2070,7 +2199,8 @@ TEST_F(ClientProtocolTest, TestEncryptedExtensionsEmptyAlpn) {
 TEST_F(ClientProtocolTest, TestEncryptedExtensionsAlpnMismatch) {
   context_->setSupportedAlpns({"h3", "h1"});
   setupExpectingEncryptedExtensions();
-  auto actions = detail::processEvent(state_, TestMessages::encryptedExt());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::encryptedExt()));
   expectError<FizzException>(
       actions, AlertDescription::illegal_parameter, "alpn mismatch");
 }
@@ -2081,7 +2211,7 @@ TEST_F(ClientProtocolTest, TestEncryptedExtensionsNoAlpn) {
   auto ee = TestMessages::encryptedExt();
   TestMessages::removeExtension(
       ee, ExtensionType::application_layer_protocol_negotiation);
-  auto actions = detail::processEvent(state_, std::move(ee));
+  auto actions = getActions(detail::processEvent(state_, std::move(ee)));
   expectActions<MutateState>(actions);
   processStateMutations(actions);
   EXPECT_FALSE(state_.alpn().hasValue());
@@ -2092,7 +2222,7 @@ TEST_F(ClientProtocolTest, TestEncryptedExtensionsDisallowedExtension) {
   setupExpectingEncryptedExtensions();
   auto ee = TestMessages::encryptedExt();
   ee.extensions.push_back(encodeExtension(ClientPresharedKey()));
-  auto actions = detail::processEvent(state_, std::move(ee));
+  auto actions = getActions(detail::processEvent(state_, std::move(ee)));
   expectError<FizzException>(
       actions,
       AlertDescription::illegal_parameter,
@@ -2107,7 +2237,7 @@ TEST_F(ClientProtocolTest, TestEncryptedExtensionsUnrequestedExtension) {
        ExtensionType::pre_shared_key});
   auto ee = TestMessages::encryptedExt();
   ee.extensions.push_back(encodeExtension(ServerNameList()));
-  auto actions = detail::processEvent(state_, std::move(ee));
+  auto actions = getActions(detail::processEvent(state_, std::move(ee)));
   expectError<FizzException>(
       actions,
       AlertDescription::illegal_parameter,
@@ -2118,7 +2248,7 @@ TEST_F(ClientProtocolTest, TestEncryptedExtensionsEarlyAccepted) {
   setupExpectingEncryptedExtensionsEarlySent();
   auto ee = TestMessages::encryptedExt();
   ee.extensions.push_back(encodeExtension(ServerEarlyData()));
-  auto actions = detail::processEvent(state_, std::move(ee));
+  auto actions = getActions(detail::processEvent(state_, std::move(ee)));
   expectActions<MutateState>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingCertificate);
@@ -2128,7 +2258,7 @@ TEST_F(ClientProtocolTest, TestEncryptedExtensionsEarlyAccepted) {
 TEST_F(ClientProtocolTest, TestEncryptedExtensionsEarlyRejected) {
   setupExpectingEncryptedExtensionsEarlySent();
   auto ee = TestMessages::encryptedExt();
-  auto actions = detail::processEvent(state_, std::move(ee));
+  auto actions = getActions(detail::processEvent(state_, std::move(ee)));
   expectActions<MutateState>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingCertificate);
@@ -2139,7 +2269,7 @@ TEST_F(ClientProtocolTest, TestEncryptedExtensionsEarlyAlreadyRejected) {
   setupExpectingEncryptedExtensionsEarlySent();
   state_.earlyDataType() = EarlyDataType::Rejected;
   auto ee = TestMessages::encryptedExt();
-  auto actions = detail::processEvent(state_, std::move(ee));
+  auto actions = getActions(detail::processEvent(state_, std::move(ee)));
   expectActions<MutateState>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingCertificate);
@@ -2151,7 +2281,7 @@ TEST_F(ClientProtocolTest, TestEncryptedExtensionsEarlyAcceptedHrr) {
   state_.earlyDataType() = EarlyDataType::Rejected;
   auto ee = TestMessages::encryptedExt();
   ee.extensions.push_back(encodeExtension(ServerEarlyData()));
-  auto actions = detail::processEvent(state_, std::move(ee));
+  auto actions = getActions(detail::processEvent(state_, std::move(ee)));
   expectError<FizzException>(
       actions,
       AlertDescription::illegal_parameter,
@@ -2163,7 +2293,7 @@ TEST_F(ClientProtocolTest, TestEncryptedExtensionsEarlyCipherMismatch) {
   state_.cipher() = CipherSuite::TLS_CHACHA20_POLY1305_SHA256;
   auto ee = TestMessages::encryptedExt();
   ee.extensions.push_back(encodeExtension(ServerEarlyData()));
-  auto actions = detail::processEvent(state_, std::move(ee));
+  auto actions = getActions(detail::processEvent(state_, std::move(ee)));
   expectError<FizzException>(
       actions, AlertDescription::illegal_parameter, "different cipher");
 }
@@ -2174,7 +2304,7 @@ TEST_F(ClientProtocolTest, TestEncryptedExtensionsEarlyAlpnMismatch) {
   state_.attemptedPsk()->alpn = "h3";
   auto ee = TestMessages::encryptedExt();
   ee.extensions.push_back(encodeExtension(ServerEarlyData()));
-  auto actions = detail::processEvent(state_, std::move(ee));
+  auto actions = getActions(detail::processEvent(state_, std::move(ee)));
   expectError<FizzException>(
       actions, AlertDescription::illegal_parameter, "different alpn");
 }
@@ -2197,7 +2327,8 @@ TEST_F(ClientProtocolTest, TestCertificateFlow) {
   CertificateEntry entry2;
   entry2.cert_data = folly::IOBuf::copyBuffer("cert2");
   certificate.certificate_list.push_back(std::move(entry2));
-  auto actions = detail::processEvent(state_, std::move(certificate));
+  auto actions = getActions(
+      detail::processEvent(state_, std::move(certificate)));
 
   expectActions<MutateState>(actions);
   processStateMutations(actions);
@@ -2213,13 +2344,34 @@ TEST_F(ClientProtocolTest, TestCertificate) {
   CertificateEntry entry;
   entry.cert_data = folly::IOBuf::copyBuffer("cert");
   certificate.certificate_list.push_back(std::move(entry));
-  auto actions = detail::processEvent(state_, std::move(certificate));
+  auto actions = getActions(
+      detail::processEvent(state_, std::move(certificate)));
   expectActions<MutateState>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.unverifiedCertChain()->size(), 1);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingCertificateVerify);
 }
 
+TEST_F(ClientProtocolTest, TestCertificateNoVerifier) {
+  setupExpectingCertificate();
+  state_.verifier() = nullptr;
+  EXPECT_CALL(*factory_, _makePeerCert(_)).Times(0);
+  auto certificate = TestMessages::certificate();
+  CertificateEntry entry;
+  entry.cert_data = folly::IOBuf::copyBuffer("cert");
+  certificate.certificate_list.push_back(std::move(entry));
+  auto actions = getActions(
+      detail::processEvent(state_, std::move(certificate)));
+  expectActions<MutateState>(actions);
+  processStateMutations(actions);
+  EXPECT_EQ(state_.unverifiedCertChain()->size(), 1);
+  // The raw DER is retained unparsed; the junk encoding only fails once
+  // the certificate is actually used.
+  EXPECT_THROW(
+      state_.unverifiedCertChain()->at(0)->getX509(), std::runtime_error);
+  EXPECT_EQ(state_.state(), StateEnum::ExpectingCertificateVerify);
+}
+
 TEST_F(ClientProtocolTest, TestCertificateWithRequestContext) {
   setupExpectingCertificate();
   auto certificate = TestMessages::certificate();
@@ -2227,7 +2379,8 @@ TEST_F(ClientProtocolTest, TestCertificateWithRequestContext) {
   CertificateEntry entry;
   entry.cert_data = folly::IOBuf::copyBuffer("cert");
   certificate.certificate_list.push_back(std::move(entry));
-  auto actions = detail::processEvent(state_, std::move(certificate));
+  auto actions = getActions(
+      detail::processEvent(state_, std::move(certificate)));
   expectError<FizzException>(
       actions, AlertDescription::illegal_parameter, "context must be empty");
 }
@@ -2235,7 +2388,8 @@ TEST_F(ClientProtocolTest, TestCertificateWithRequestContext) {
 TEST_F(ClientProtocolTest, TestCertificateEmpty) {
   setupExpectingCertificate();
   auto certificate = TestMessages::certificate();
-  auto actions = detail::processEvent(state_, std::move(certificate));
+  auto actions = getActions(
+      detail::processEvent(state_, std::move(certificate)));
   expectError<FizzException>(
       actions, AlertDescription::illegal_parameter, "no cert");
 }
@@ -2276,7 +2430,8 @@ TEST_F(ClientProtocolTest, TestCompressedCertificateFlow) {
       }));
 
   auto compressedCert = TestMessages::compressedCertificate();
-  auto actions = detail::processEvent(state_, std::move(compressedCert));
+  auto actions = getActions(
+      detail::processEvent(state_, std::move(compressedCert)));
 
   expectActions<MutateState>(actions);
   processStateMutations(actions);
@@ -2305,7 +2460,8 @@ TEST_F(ClientProtocolTest, TestCompressedCertificate) {
       }));
 
   auto compressedCert = TestMessages::compressedCertificate();
-  auto actions = detail::processEvent(state_, std::move(compressedCert));
+  auto actions = getActions(
+      detail::processEvent(state_, std::move(compressedCert)));
   expectActions<MutateState>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.unverifiedCertChain()->size(), 1);
@@ -2324,7 +2480,8 @@ TEST_F(ClientProtocolTest, TestCompressedCertificateUnknownAlgo) {
 
   auto compressedCert = TestMessages::compressedCertificate();
   compressedCert.algorithm = static_cast<CertificateCompressionAlgorithm>(0xff);
-  auto actions = detail::processEvent(state_, std::move(compressedCert));
+  auto actions = getActions(
+      detail::processEvent(state_, std::move(compressedCert)));
   expectError<FizzException>(
       actions, AlertDescription::bad_certificate, "unsupported algorithm");
 }
@@ -2342,7 +2499,8 @@ TEST_F(ClientProtocolTest, TestCompressedCertificateDecompressionFailed) {
       {std::static_pointer_cast<CertificateDecompressor>(decompressor)});
   context_->setCertDecompressionManager(std::move(decompressionMgr));
   auto compressedCert = TestMessages::compressedCertificate();
-  auto actions = detail::processEvent(state_, std::move(compressedCert));
+  auto actions = getActions(
+      detail::processEvent(state_, std::move(compressedCert)));
   expectError<FizzException>(
       actions, AlertDescription::bad_certificate, "decompression failed: foo");
 }
@@ -2367,7 +2525,8 @@ TEST_F(ClientProtocolTest, TestCompressedCertificateWithRequestContext) {
       }));
 
   auto compressedCert = TestMessages::compressedCertificate();
-  auto actions = detail::processEvent(state_, std::move(compressedCert));
+  auto actions = getActions(
+      detail::processEvent(state_, std::move(compressedCert)));
   expectError<FizzException>(
       actions, AlertDescription::illegal_parameter, "context must be empty");
 }
@@ -2385,7 +2544,8 @@ TEST_F(ClientProtocolTest, TestCompressedCertificateEmpty) {
       {std::static_pointer_cast<CertificateDecompressor>(decompressor)});
   context_->setCertDecompressionManager(std::move(decompressionMgr));
   auto compressedCert = TestMessages::compressedCertificate();
-  auto actions = detail::processEvent(state_, std::move(compressedCert));
+  auto actions = getActions(
+      detail::processEvent(state_, std::move(compressedCert)));
   expectError<FizzException>(
       actions, AlertDescription::illegal_parameter, "no cert");
 }
@@ -2393,7 +2553,8 @@ TEST_F(ClientProtocolTest, TestCompressedCertificateEmpty) {
 TEST_F(ClientProtocolTest, TestUnexpectedCompressedCertificate) {
   setupExpectingCertificate();
   auto compressedCert = TestMessages::compressedCertificate();
-  auto actions = detail::processEvent(state_, std::move(compressedCert));
+  auto actions = getActions(
+      detail::processEvent(state_, std::move(compressedCert)));
   expectError<FizzException>(
       actions, AlertDescription::unexpected_message, "received unexpectedly");
 }
@@ -2425,7 +2586,8 @@ TEST_F(ClientProtocolTest, TestCertificateVerifyFlow) {
           }));
 
   auto actions =
-      detail::processEvent(state_, TestMessages::certificateVerify());
+      getActions(
+          detail::processEvent(state_, TestMessages::certificateVerify()));
   expectActions<MutateState>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.sigScheme(), SignatureScheme::ecdsa_secp256r1_sha256);
@@ -2437,7 +2599,8 @@ TEST_F(ClientProtocolTest, TestCertificateVerifyFlow) {
 TEST_F(ClientProtocolTest, TestCertificateVerify) {
   setupExpectingCertificateVerify();
   auto actions =
-      detail::processEvent(state_, TestMessages::certificateVerify());
+      getActions(
+          detail::processEvent(state_, TestMessages::certificateVerify()));
   expectActions<MutateState>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingFinished);
@@ -2447,7 +2610,8 @@ TEST_F(ClientProtocolTest, TestCertificateVerifyNoVerifier) {
   setupExpectingCertificateVerify();
   state_.verifier() = nullptr;
   auto actions =
-      detail::processEvent(state_, TestMessages::certificateVerify());
+      getActions(
+          detail::processEvent(state_, TestMessages::certificateVerify()));
   expectActions<MutateState>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::ExpectingFinished);
@@ -2457,7 +2621,8 @@ TEST_F(ClientProtocolTest, TestCertificateVerifyUnsupportedAlgorithm) {
   context_->setSupportedSigSchemes({SignatureScheme::rsa_pss_sha256});
   setupExpectingCertificateVerify();
   auto actions =
-      detail::processEvent(state_, TestMessages::certificateVerify());
+      getActions(
+          detail::processEvent(state_, TestMessages::certificateVerify()));
   expectError<FizzException>(
       actions, AlertDescription::illegal_parameter, "unsupported sig scheme");
 }
@@ -2474,7 +2639,8 @@ TEST_F(ClientProtocolTest, TestCertificateVerifyFailure) {
       .WillOnce(Throw(
           FizzException("verify failed", AlertDescription::bad_record_mac)));
   auto actions =
-      detail::processEvent(state_, TestMessages::certificateVerify());
+      getActions(
+          detail::processEvent(state_, TestMessages::certificateVerify()));
   expectError<FizzException>(
       actions, AlertDescription::bad_record_mac, "verify failed");
 }
@@ -2485,7 +2651,8 @@ TEST_F(ClientProtocolTest, TestCertificateVerifyVerifierFailure) {
       .WillOnce(Throw(FizzVerificationException(
           "verify failed", AlertDescription::bad_record_mac)));
   auto actions =
-      detail::processEvent(state_, TestMessages::certificateVerify());
+      getActions(
+          detail::processEvent(state_, TestMessages::certificateVerify()));
   expectError<FizzVerificationException>(
       actions, AlertDescription::bad_record_mac, "verify failed");
 }
@@ -2495,7 +2662,8 @@ TEST_F(ClientProtocolTest, TestCertificateVerifyVerifierFailureOtherException) {
   EXPECT_CALL(*verifier_, verify(_))
       .WillOnce(Throw(std::runtime_error("no good")));
   auto actions =
-      detail::processEvent(state_, TestMessages::certificateVerify());
+      getActions(
+          detail::processEvent(state_, TestMessages::certificateVerify()));
   expectError<FizzException>(
       actions, AlertDescription::bad_certificate, "verifier failure: no good");
 }
@@ -2503,7 +2671,8 @@ TEST_F(ClientProtocolTest, TestCertificateVerifyVerifierFailureOtherException) {
 TEST_F(ClientProtocolTest, TestCertificateRequestNoCert) {
   setupExpectingCertificate();
   auto certificateRequest = TestMessages::certificateRequest();
-  auto actions = detail::processEvent(state_, std::move(certificateRequest));
+  auto actions = getActions(
+      detail::processEvent(state_, std::move(certificateRequest)));
   expectActions<MutateState>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.clientAuthRequested(), ClientAuthType::RequestedNoMatch);
@@ -2514,11 +2683,13 @@ TEST_F(ClientProtocolTest, TestCertificateRequestNoCert) {
 TEST_F(ClientProtocolTest, TestCertificateRequestDuplicated) {
   setupExpectingCertificate();
   auto certificateRequest = TestMessages::certificateRequest();
-  auto actions = detail::processEvent(state_, std::move(certificateRequest));
+  auto actions = getActions(
+      detail::processEvent(state_, std::move(certificateRequest)));
   expectActions<MutateState>(actions);
   processStateMutations(actions);
   certificateRequest = TestMessages::certificateRequest();
-  actions = detail::processEvent(state_, std::move(certificateRequest));
+  actions = getActions(
+      detail::processEvent(state_, std::move(certificateRequest)));
   expectError<FizzException>(
       actions,
       AlertDescription::unexpected_message,
@@ -2540,7 +2711,8 @@ TEST_F(ClientProtocolTest, TestCertificateRequestAlgosMismatch) {
       .WillOnce(Return(
           std::vector<SignatureScheme>(1, SignatureScheme::rsa_pss_sha256)));
 
-  auto actions = detail::processEvent(state_, std::move(certificateRequest));
+  auto actions = getActions(
+      detail::processEvent(state_, std::move(certificateRequest)));
   expectActions<MutateState>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.clientAuthRequested(), ClientAuthType::RequestedNoMatch);
@@ -2564,7 +2736,8 @@ TEST_F(ClientProtocolTest, TestCertificateRequestContextAlgosUnsupported) {
       .WillOnce(Return(
           std::vector<SignatureScheme>(1, SignatureScheme::rsa_pss_sha256)));
 
-  auto actions = detail::processEvent(state_, std::move(certificateRequest));
+  auto actions = getActions(
+      detail::processEvent(state_, std::move(certificateRequest)));
   expectActions<MutateState>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.clientAuthRequested(), ClientAuthType::RequestedNoMatch);
@@ -2593,7 +2766,8 @@ TEST_F(ClientProtocolTest, TestCertificateRequestPrefersContextOrder) {
                                         SignatureScheme::ecdsa_secp521r1_sha512,
                                         SignatureScheme::rsa_pss_sha512})));
 
-  auto actions = detail::processEvent(state_, std::move(certificateRequest));
+  auto actions = getActions(
+      detail::processEvent(state_, std::move(certificateRequest)));
   expectActions<MutateState>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.clientAuthRequested(), ClientAuthType::Sent);
@@ -2609,7 +2783,8 @@ TEST_F(ClientProtocolTest, TestCertificateRequestMatch) {
       .WillOnce(Return(
           std::vector<SignatureScheme>(1, SignatureScheme::rsa_pss_sha256)));
 
-  auto actions = detail::processEvent(state_, std::move(certificateRequest));
+  auto actions = getActions(
+      detail::processEvent(state_, std::move(certificateRequest)));
   expectActions<MutateState>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.clientAuthRequested(), ClientAuthType::Sent);
@@ -2644,10 +2819,11 @@ TEST_F(ClientProtocolTest, TestFinishedEarlyFlow) {
   setMockEarlyRecord();
 
   Sequence contextSeq;
-  EXPECT_CALL(*mockHandshakeContext_, getFinishedData(RangeMatches("sht")))
+  EXPECT_CALL(
+      *mockHandshakeContext_,
+      verifyFinishedData(RangeMatches("sht"), RangeMatches("verifydata")))
       .InSequence(contextSeq)
-      .WillOnce(
-          InvokeWithoutArgs([]() { return IOBuf::copyBuffer("verifydata"); }));
+      .WillOnce(Return(true));
   EXPECT_CALL(
       *mockHandshakeContext_,
       appendToTranscript(BufMatches("finishedencoding")))
@@ -2739,7 +2915,8 @@ TEST_F(ClientProtocolTest, TestFinishedEarlyFlow) {
   expectEncryptedWriteRecordLayerCreation(&wrl, &waead, StringPiece("cat"));
   EXPECT_CALL(*mockKeyScheduler_, clearMasterSecret());
 
-  auto actions = detail::processEvent(state_, TestMessages::finished());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::finished()));
   expectActions<
       MutateState,
       ReportHandshakeSuccess,
@@ -2787,10 +2964,11 @@ TEST_F(ClientProtocolTest, TestFinishedEarlyFlowOmitEarlyRecord) {
   context_->setOmitEarlyRecordLayer(true);
 
   Sequence contextSeq;
-  EXPECT_CALL(*mockHandshakeContext_, getFinishedData(RangeMatches("sht")))
+  EXPECT_CALL(
+      *mockHandshakeContext_,
+      verifyFinishedData(RangeMatches("sht"), RangeMatches("verifydata")))
       .InSequence(contextSeq)
-      .WillOnce(
-          InvokeWithoutArgs([]() { return IOBuf::copyBuffer("verifydata"); }));
+      .WillOnce(Return(true));
   EXPECT_CALL(
       *mockHandshakeContext_,
       appendToTranscript(BufMatches("finishedencoding")))
@@ -2865,7 +3043,8 @@ TEST_F(ClientProtocolTest, TestFinishedEarlyFlowOmitEarlyRecord) {
   expectEncryptedWriteRecordLayerCreation(&wrl, &waead, StringPiece("cat"));
   EXPECT_CALL(*mockKeyScheduler_, clearMasterSecret());
 
-  auto actions = detail::processEvent(state_, TestMessages::finished());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::finished()));
   expectActions<
       MutateState,
       ReportHandshakeSuccess,
@@ -2904,10 +3083,11 @@ TEST_F(ClientProtocolTest, TestFinishedEarlyFlowOmitEarlyRecord) {
 
 void ClientProtocolTest::doFinishedFlow(ClientAuthType authType) {
   Sequence contextSeq;
-  EXPECT_CALL(*mockHandshakeContext_, getFinishedData(RangeMatches("sht")))
+  EXPECT_CALL(
+      *mockHandshakeContext_,
+      verifyFinishedData(RangeMatches("sht"), RangeMatches("verifydata")))
       .InSequence(contextSeq)
-      .WillOnce(
-          InvokeWithoutArgs([]() { return IOBuf::copyBuffer("verifydata"); }));
+      .WillOnce(Return(true));
   EXPECT_CALL(
       *mockHandshakeContext_,
       appendToTranscript(BufMatches("finishedencoding")))
@@ -3045,7 +3225,8 @@ void ClientProtocolTest::doFinishedFlow(ClientAuthType authType) {
   expectEncryptedWriteRecordLayerCreation(&wrl, &waead, StringPiece("cat"));
   EXPECT_CALL(*mockKeyScheduler_, clearMasterSecret());
 
-  auto actions = detail::processEvent(state_, TestMessages::finished());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::finished()));
   expectActions<
       MutateState,
       ReportHandshakeSuccess,
@@ -3082,7 +3263,8 @@ void ClientProtocolTest::doFinishedFlow(ClientAuthType authType) {
 
 TEST_F(ClientProtocolTest, TestFinished) {
   setupExpectingFinished();
-  auto actions = detail::processEvent(state_, TestMessages::finished());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::finished()));
   expectActions<
       MutateState,
       ReportHandshakeSuccess,
@@ -3095,11 +3277,30 @@ TEST_F(ClientProtocolTest, TestFinished) {
       std::chrono::system_clock::time_point(std::chrono::minutes(4)));
 }
 
+TEST_F(ClientProtocolTest, TestFinishedGroupMemory) {
+  setupExpectingFinished();
+  auto groupMemoryCache = std::make_shared<MockGroupMemoryCache>();
+  context_->setGroupMemoryCache(groupMemoryCache);
+  state_.sni() = "www.hostname.com";
+  EXPECT_CALL(
+      *groupMemoryCache, putGroup("www.hostname.com", NamedGroup::x25519));
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::finished()));
+  expectActions<
+      MutateState,
+      ReportHandshakeSuccess,
+      WriteToSocket,
+      SecretAvailable>(actions);
+  processStateMutations(actions);
+  EXPECT_EQ(state_.state(), StateEnum::Established);
+}
+
 TEST_F(ClientProtocolTest, TestFinishedExtraData) {
   setupExpectingFinished();
   EXPECT_CALL(*mockHandshakeRead_, hasUnparsedHandshakeData())
       .WillRepeatedly(Return(true));
-  auto actions = detail::processEvent(state_, TestMessages::finished());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::finished()));
   expectError<FizzException>(
       actions, AlertDescription::unexpected_message, "data after finished");
 }
@@ -3108,7 +3309,7 @@ TEST_F(ClientProtocolTest, TestFinishedMismatch) {
   setupExpectingFinished();
   auto finished = TestMessages::finished();
   finished.verify_data = IOBuf::copyBuffer("ver1fydata");
-  auto actions = detail::processEvent(state_, std::move(finished));
+  auto actions = getActions(detail::processEvent(state_, std::move(finished)));
   expectError<FizzException>(
       actions, AlertDescription::bad_record_mac, "finished verify failure");
 }
@@ -3116,7 +3317,8 @@ TEST_F(ClientProtocolTest, TestFinishedMismatch) {
 TEST_F(ClientProtocolTest, TestFinishedRejectedEarly) {
   setupExpectingFinished();
   state_.earlyDataType() = EarlyDataType::Rejected;
-  auto actions = detail::processEvent(state_, TestMessages::finished());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::finished()));
   expectActions<
       MutateState,
       ReportHandshakeSuccess,
@@ -3134,7 +3336,8 @@ TEST_F(ClientProtocolTest, TestFinishedRejectedEarly) {
 TEST_F(ClientProtocolTest, TestFinishedCompat) {
   context_->setCompatibilityMode(true);
   setupExpectingFinished();
-  auto actions = detail::processEvent(state_, TestMessages::finished());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::finished()));
   expectActions<
       MutateState,
       ReportHandshakeSuccess,
@@ -3164,7 +3367,8 @@ TEST_F(ClientProtocolTest, TestNewSessionTicket) {
           []() { return IOBuf::copyBuffer("derivedsecret"); }));
   state_.clientCert() = mockClientCert_;
 
-  auto actions = detail::processEvent(state_, TestMessages::newSessionTicket());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::newSessionTicket()));
   auto newCachedPsk = expectSingleAction<NewCachedPsk>(std::move(actions));
   auto psk = newCachedPsk.psk;
   EXPECT_EQ(psk.psk, "ticket");
@@ -3197,7 +3401,7 @@ TEST_F(ClientProtocolTest, TestNewSessionTicketNonce) {
 
   auto nst = TestMessages::newSessionTicket();
   nst.ticket_nonce = IOBuf::copyBuffer("nonce");
-  auto actions = detail::processEvent(state_, std::move(nst));
+  auto actions = getActions(detail::processEvent(state_, std::move(nst)));
   expectSingleAction<NewCachedPsk>(std::move(actions));
 }
 
@@ -3214,7 +3418,7 @@ TEST_F(ClientProtocolTest, TestNewSessionTicketEarlyData) {
   TicketEarlyData early;
   early.max_early_data_size = 2000;
   nst.extensions.push_back(encodeExtension(std::move(early)));
-  auto actions = detail::processEvent(state_, std::move(nst));
+  auto actions = getActions(detail::processEvent(state_, std::move(nst)));
   auto newCachedPsk = expectSingleAction<NewCachedPsk>(std::move(actions));
   auto psk = newCachedPsk.psk;
   EXPECT_EQ(psk.psk, "ticket");
@@ -3237,7 +3441,8 @@ TEST_F(ClientProtocolTest, TestNewSessionTicketEarlyData) {
 TEST_F(ClientProtocolTest, TestAppData) {
   setupAcceptingData();
 
-  auto actions = detail::processEvent(state_, TestMessages::appData());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::appData()));
 
   expectSingleAction<DeliverAppData>(std::move(actions));
 }
@@ -3254,7 +3459,8 @@ TEST_F(ClientProtocolTest, TestAppWrite) {
     return content;
   }));
 
-  auto actions = detail::processEvent(state_, TestMessages::appWrite());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::appWrite()));
   auto write = expectSingleAction<WriteToSocket>(std::move(actions));
   EXPECT_TRUE(IOBufEqualTo()(
       write.contents[0].data, IOBuf::copyBuffer("writtenappdata")));
@@ -3264,9 +3470,75 @@ TEST_F(ClientProtocolTest, TestAppWrite) {
   EXPECT_EQ(write.contents[0].contentType, ContentType::application_data);
 }
 
+TEST_F(ClientProtocolTest, TestAppWriteRekey) {
+  setupAcceptingData();
+  auto wrl = std::make_unique<MockEncryptedWriteRecordLayer>(
+      EncryptionLevel::AppTraffic);
+  wrl->setDefaults();
+  auto appWrite = wrl.get();
+  state_.writeRecordLayer() = std::move(wrl);
+
+  EXPECT_CALL(*appWrite, rekeyRecommended()).WillOnce(Return(true));
+  EXPECT_CALL(*appWrite, _write(_))
+      .WillOnce(Invoke([&](TLSMessage& msg) {
+        TLSContent content;
+        content.contentType = msg.type;
+        content.encryptionLevel = appWrite->getEncryptionLevel();
+        EXPECT_EQ(msg.type, ContentType::application_data);
+        EXPECT_TRUE(IOBufEqualTo()(msg.fragment, IOBuf::copyBuffer("appdata")));
+        content.data = IOBuf::copyBuffer("writtenappdata");
+        return content;
+      }))
+      .WillOnce(Invoke([&](TLSMessage& msg) {
+        TLSContent content;
+        content.contentType = msg.type;
+        content.encryptionLevel = appWrite->getEncryptionLevel();
+        EXPECT_EQ(msg.type, ContentType::handshake);
+        EXPECT_TRUE(IOBufEqualTo()(
+            msg.fragment, encodeHandshake(TestMessages::keyUpdate(false))));
+        content.data = IOBuf::copyBuffer("keyupdated");
+        return content;
+      }));
+
+  EXPECT_CALL(*mockKeyScheduler_, clientKeyUpdate());
+  EXPECT_CALL(
+      *mockKeyScheduler_, getSecret(AppTrafficSecrets::ClientAppTraffic))
+      .WillOnce(InvokeWithoutArgs([]() {
+        return DerivedSecret(
+            std::vector<uint8_t>({'c', 'a', 't'}),
+            AppTrafficSecrets::ClientAppTraffic);
+      }));
+  EXPECT_CALL(*mockKeyScheduler_, getTrafficKey(RangeMatches("cat"), _, _))
+      .WillOnce(InvokeWithoutArgs([]() {
+        return TrafficKey{IOBuf::copyBuffer("clientkey"),
+                          IOBuf::copyBuffer("clientiv")};
+      }));
+  EXPECT_CALL(*appWrite, _rekey(_))
+      .WillOnce(Invoke([](TrafficKeyDeriver& deriver) {
+        auto key = deriver(16, 12);
+        EXPECT_TRUE(IOBufEqualTo()(key.key, IOBuf::copyBuffer("clientkey")));
+        EXPECT_TRUE(IOBufEqualTo()(key.iv, IOBuf::copyBuffer("clientiv")));
+      }));
+
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::appWrite()));
+  expectActions<MutateState, WriteToSocket, SecretAvailable>(actions);
+  auto write = expectAction<WriteToSocket>(actions);
+  EXPECT_TRUE(IOBufEqualTo()(
+      write.contents[0].data, IOBuf::copyBuffer("writtenappdata")));
+  EXPECT_TRUE(
+      IOBufEqualTo()(write.contents[1].data, IOBuf::copyBuffer("keyupdated")));
+  expectSecret(
+      actions, AppTrafficSecrets::ClientAppTraffic, StringPiece("cat"));
+  processStateMutations(actions);
+  EXPECT_EQ(state_.writeRecordLayer().get(), appWrite);
+  EXPECT_EQ(state_.state(), StateEnum::Established);
+}
+
 TEST_F(ClientProtocolTest, TestKeyUpdateNotRequested) {
   setupAcceptingData();
-  auto actions = detail::processEvent(state_, TestMessages::keyUpdate(false));
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::keyUpdate(false)));
   expectActions<MutateState>(actions);
   EXPECT_EQ(getNumActions<WriteToSocket>(actions, false), 0);
 }
@@ -3275,11 +3547,68 @@ TEST_F(ClientProtocolTest, TestKeyUpdateExtraData) {
   setupAcceptingData();
   EXPECT_CALL(*mockRead_, hasUnparsedHandshakeData())
       .WillRepeatedly(Return(true));
-  auto actions = detail::processEvent(state_, TestMessages::keyUpdate(false));
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::keyUpdate(false)));
   expectError<FizzException>(
       actions, AlertDescription::unexpected_message, "data after key_update");
 }
 
+TEST_F(ClientProtocolTest, TestKeyUpdateInitiation) {
+  setupAcceptingData();
+  auto wrl = std::make_unique<MockEncryptedWriteRecordLayer>(
+      EncryptionLevel::AppTraffic);
+  wrl->setDefaults();
+  auto appWrite = wrl.get();
+  state_.writeRecordLayer() = std::move(wrl);
+
+  EXPECT_CALL(*appWrite, _write(_)).WillOnce(Invoke([&](TLSMessage& msg) {
+    TLSContent content;
+    content.contentType = msg.type;
+    content.encryptionLevel = appWrite->getEncryptionLevel();
+    EXPECT_EQ(msg.type, ContentType::handshake);
+    EXPECT_TRUE(IOBufEqualTo()(
+        msg.fragment, encodeHandshake(TestMessages::keyUpdate(true))));
+    content.data = folly::IOBuf::copyBuffer("keyupdated");
+    return content;
+  }));
+
+  EXPECT_CALL(*mockKeyScheduler_, clientKeyUpdate());
+  EXPECT_CALL(
+      *mockKeyScheduler_, getSecret(AppTrafficSecrets::ClientAppTraffic))
+      .WillOnce(InvokeWithoutArgs([]() {
+        return DerivedSecret(
+            std::vector<uint8_t>({'c', 'a', 't'}),
+            AppTrafficSecrets::ClientAppTraffic);
+      }));
+  EXPECT_CALL(*mockKeyScheduler_, getTrafficKey(RangeMatches("cat"), _, _))
+      .WillOnce(InvokeWithoutArgs([]() {
+        return TrafficKey{IOBuf::copyBuffer("clientkey"),
+                          IOBuf::copyBuffer("clientiv")};
+      }));
+  // The existing write record layer is rekeyed in place rather than
+  // replaced.
+  EXPECT_CALL(*appWrite, _rekey(_))
+      .WillOnce(Invoke([](TrafficKeyDeriver& deriver) {
+        auto key = deriver(16, 12);
+        EXPECT_TRUE(IOBufEqualTo()(key.key, IOBuf::copyBuffer("clientkey")));
+        EXPECT_TRUE(IOBufEqualTo()(key.iv, IOBuf::copyBuffer("clientiv")));
+      }));
+
+  KeyUpdateInitiation keyUpdateInitiation;
+  keyUpdateInitiation.request_update = KeyUpdateRequest::update_requested;
+  auto actions = getActions(ClientStateMachine().processKeyUpdateInitiation(
+      state_, std::move(keyUpdateInitiation)));
+  expectActions<MutateState, WriteToSocket, SecretAvailable>(actions);
+  auto write = expectAction<WriteToSocket>(actions);
+  EXPECT_TRUE(
+      IOBufEqualTo()(write.contents[0].data, IOBuf::copyBuffer("keyupdated")));
+  expectSecret(
+      actions, AppTrafficSecrets::ClientAppTraffic, StringPiece("cat"));
+  processStateMutations(actions);
+  EXPECT_EQ(state_.writeRecordLayer().get(), appWrite);
+  EXPECT_EQ(state_.state(), StateEnum::Established);
+}
+
 TEST_F(ClientProtocolTest, TestKeyUpdateRequestFlow) {
   setupAcceptingData();
   EXPECT_CALL(*mockKeyScheduler_, serverKeyUpdate());
@@ -3333,7 +3662,8 @@ TEST_F(ClientProtocolTest, TestKeyUpdateRequestFlow) {
   expectEncryptedReadRecordLayerCreation(&rrl, &raead, StringPiece("sat"));
   expectEncryptedWriteRecordLayerCreation(&wrl, &waead, StringPiece("cat"));
 
-  auto actions = detail::processEvent(state_, TestMessages::keyUpdate(true));
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::keyUpdate(true)));
   expectActions<MutateState, WriteToSocket, SecretAvailable>(actions);
   auto write = expectAction<WriteToSocket>(actions);
   EXPECT_TRUE(
@@ -3364,7 +3694,8 @@ TEST_F(ClientProtocolTest, TestKeyUpdateRequestFlow) {
 TEST_F(ClientProtocolTest, TestInvalidEarlyWrite) {
   setupExpectingServerHello();
 
-  auto actions = detail::processEvent(state_, TestMessages::earlyAppWrite());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::earlyAppWrite()));
   expectError<FizzException>(actions, folly::none, "invalid early write");
 }
 
@@ -3373,7 +3704,8 @@ TEST_F(ClientProtocolTest, TestEarlyWriteOmitRecord) {
   state_.earlyDataType() = EarlyDataType::Attempted;
   context_->setOmitEarlyRecordLayer(true);
 
-  auto actions = detail::processEvent(state_, TestMessages::earlyAppWrite());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::earlyAppWrite()));
   expectError<FizzException>(actions, folly::none, "early app writes disabled");
 }
 
@@ -3392,7 +3724,8 @@ TEST_F(ClientProtocolTest, TestExpectingSHEarlyWrite) {
         return content;
       }));
 
-  auto actions = detail::processEvent(state_, TestMessages::earlyAppWrite());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::earlyAppWrite()));
 
   auto write = expectSingleAction<WriteToSocket>(std::move(actions));
   EXPECT_TRUE(IOBufEqualTo()(
@@ -3404,7 +3737,8 @@ TEST_F(ClientProtocolTest, TestEarlyEncryptionLevelRecvSHLO) {
   setMockEarlyRecord();
   state_.earlyDataType() = EarlyDataType::Attempted;
 
-  auto actions = detail::processEvent(state_, TestMessages::serverHello());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::serverHello()));
   processStateMutations(actions);
   EXPECT_EQ(
       state_.writeRecordLayer()->getEncryptionLevel(),
@@ -3419,7 +3753,8 @@ TEST_F(ClientProtocolTest, TestEarlyEncryptionLevelRecvFinished) {
   setMockEarlyRecord();
   state_.earlyDataType() = EarlyDataType::Attempted;
 
-  auto actions = detail::processEvent(state_, TestMessages::serverHello());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::serverHello()));
   processStateMutations(actions);
   EXPECT_EQ(
       state_.writeRecordLayer()->getEncryptionLevel(),
@@ -3435,7 +3770,8 @@ TEST_F(ClientProtocolTest, TestEarlyWriteCompat) {
   state_.earlyDataType() = EarlyDataType::Attempted;
   context_->setCompatibilityMode(true);
 
-  auto actions = detail::processEvent(state_, TestMessages::earlyAppWrite());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::earlyAppWrite()));
   expectActions<MutateState, WriteToSocket>(actions);
   auto write = expectAction<WriteToSocket>(actions);
   EXPECT_EQ(write.contents.size(), 2);
@@ -3454,7 +3790,8 @@ TEST_F(ClientProtocolTest, TestEarlyWriteCompatCCSAlreadySent) {
   state_.sentCCS() = true;
   context_->setCompatibilityMode(true);
 
-  auto actions = detail::processEvent(state_, TestMessages::earlyAppWrite());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::earlyAppWrite()));
 
   expectActions<WriteToSocket>(actions);
   EXPECT_TRUE(state_.sentCCS());
@@ -3466,7 +3803,8 @@ TEST_F(ClientProtocolTest, TestEarlyAcceptedCompatNoEarlyData) {
   state_.earlyDataType() = EarlyDataType::Accepted;
   context_->setCompatibilityMode(true);
 
-  auto actions = detail::processEvent(state_, TestMessages::finished());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::finished()));
 
   expectActions<
       MutateState,
@@ -3492,7 +3830,8 @@ TEST_F(ClientProtocolTest, TestExpectingSHEarlyWriteRejected) {
   setupExpectingServerHello();
   state_.earlyDataType() = EarlyDataType::Rejected;
 
-  auto actions = detail::processEvent(state_, TestMessages::earlyAppWrite());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::earlyAppWrite()));
   auto failedWrite =
       expectSingleAction<ReportEarlyWriteFailed>(std::move(actions));
   EXPECT_TRUE(
@@ -3512,7 +3851,8 @@ TEST_F(ClientProtocolTest, TestExpectingEEEarlyWrite) {
         return content;
       }));
 
-  auto actions = detail::processEvent(state_, TestMessages::earlyAppWrite());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::earlyAppWrite()));
 
   auto write = expectSingleAction<WriteToSocket>(std::move(actions));
   EXPECT_TRUE(IOBufEqualTo()(
@@ -3523,7 +3863,8 @@ TEST_F(ClientProtocolTest, TestExpectingEEEarlyWriteRejected) {
   setupExpectingEncryptedExtensionsEarlySent();
   state_.earlyDataType() = EarlyDataType::Rejected;
 
-  auto actions = detail::processEvent(state_, TestMessages::earlyAppWrite());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::earlyAppWrite()));
   auto failedWrite =
       expectSingleAction<ReportEarlyWriteFailed>(std::move(actions));
   EXPECT_TRUE(
@@ -3534,7 +3875,8 @@ TEST_F(ClientProtocolTest, TestExpectingCertEarlyWriteRejected) {
   setupExpectingEncryptedExtensionsEarlySent();
   state_.earlyDataType() = EarlyDataType::Rejected;
 
-  auto actions = detail::processEvent(state_, TestMessages::earlyAppWrite());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::earlyAppWrite()));
   auto failedWrite =
       expectSingleAction<ReportEarlyWriteFailed>(std::move(actions));
   EXPECT_TRUE(
@@ -3545,7 +3887,8 @@ TEST_F(ClientProtocolTest, TestExpectingCertVerifyEarlyWriteRejected) {
   setupExpectingEncryptedExtensionsEarlySent();
   state_.earlyDataType() = EarlyDataType::Rejected;
 
-  auto actions = detail::processEvent(state_, TestMessages::earlyAppWrite());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::earlyAppWrite()));
   auto failedWrite =
       expectSingleAction<ReportEarlyWriteFailed>(std::move(actions));
   EXPECT_TRUE(
@@ -3567,7 +3910,8 @@ TEST_F(ClientProtocolTest, TestExpectingFinishedEarlyWrite) {
         return content;
       }));
 
-  auto actions = detail::processEvent(state_, TestMessages::earlyAppWrite());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::earlyAppWrite()));
 
   auto write = expectSingleAction<WriteToSocket>(std::move(actions));
   EXPECT_TRUE(IOBufEqualTo()(
@@ -3578,7 +3922,8 @@ TEST_F(ClientProtocolTest, TestExpectingFinishedEarlyWriteRejected) {
   setupExpectingFinished();
   state_.earlyDataType() = EarlyDataType::Rejected;
 
-  auto actions = detail::processEvent(state_, TestMessages::earlyAppWrite());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::earlyAppWrite()));
   auto failedWrite =
       expectSingleAction<ReportEarlyWriteFailed>(std::move(actions));
   EXPECT_TRUE(
@@ -3598,7 +3943,8 @@ TEST_F(ClientProtocolTest, TestEstablishedEarlyWrite) {
     return content;
   }));
 
-  auto actions = detail::processEvent(state_, TestMessages::earlyAppWrite());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::earlyAppWrite()));
 
   auto write = expectSingleAction<WriteToSocket>(std::move(actions));
   EXPECT_TRUE(IOBufEqualTo()(
@@ -3609,7 +3955,8 @@ TEST_F(ClientProtocolTest, TestEstablishedEarlyWriteRejected) {
   setupAcceptingData();
   state_.earlyDataType() = EarlyDataType::Rejected;
 
-  auto actions = detail::processEvent(state_, TestMessages::earlyAppWrite());
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::earlyAppWrite()));
   auto failedWrite =
       expectSingleAction<ReportEarlyWriteFailed>(std::move(actions));
   EXPECT_TRUE(
@@ -3618,7 +3965,7 @@ TEST_F(ClientProtocolTest, TestEstablishedEarlyWriteRejected) {
 
 TEST_F(ClientProtocolTest, TestEstablishedCloseNotifyReceived) {
   setupAcceptingData();
-  auto actions = detail::processEvent(state_, CloseNotify());
+  auto actions = getActions(detail::processEvent(state_, CloseNotify()));
   expectActions<MutateState, WriteToSocket, EndOfData>(actions);
   processStateMutations(actions);
   EXPECT_EQ(state_.state(), StateEnum::Closed);
@@ -3632,7 +3979,7 @@ TEST_F(
   setupAcceptingData();
   EXPECT_CALL(*mockRead_, hasUnparsedHandshakeData())
       .WillRepeatedly(Return(true));
-  auto actions = detail::processEvent(state_, CloseNotify());
+  auto actions = getActions(detail::processEvent(state_, CloseNotify()));
   expectError<FizzException>(actions, AlertDescription::unexpected_message);
 }
 
@@ -3663,7 +4010,7 @@ TEST_F(ClientProtocolTest, TestEstablishedAppClose) {
 
   mockRead_->useMockReadEvent(true);
   folly::IOBufQueue queue;
-  actions = ClientStateMachine().processSocketData(state_, queue);
+  actions = getActions(ClientStateMachine().processSocketData(state_, queue));
   expectActions<MutateState, EndOfData>(actions);
   processStateMutations(actions);
   expectAction<EndOfData>(actions);
@@ -3694,11 +4041,13 @@ TEST_F(ClientProtocolTest, TestEstablishedAppCloseImmediate) {
 TEST_F(ClientProtocolTest, TestDecodeErrorAlert) {
   setupAcceptingData();
   EXPECT_CALL(*mockRead_, read(_))
-      .WillOnce(Invoke([](auto &&) -> folly::Optional<TLSMessage> {
-        throw std::runtime_error("read record layer error");
+      .WillOnce(Invoke([](auto &&) -> ReadResult<TLSMessage> {
+        return folly::makeUnexpected(ReadError{
+            "read record layer error", AlertDescription::decode_error});
       }));
   folly::IOBufQueue buf;
-  auto actions = ClientStateMachine().processSocketData(state_, buf);
+  auto actions = getActions(
+      ClientStateMachine().processSocketData(state_, buf));
   auto exc = expectError<FizzException>(
       actions, AlertDescription::decode_error, "read record layer error");
 
@@ -3709,13 +4058,14 @@ TEST_F(ClientProtocolTest, TestDecodeErrorAlert) {
 TEST_F(ClientProtocolTest, TestSocketDataFizzExceptionAlert) {
   setupAcceptingData();
   EXPECT_CALL(*mockRead_, read(_))
-      .WillOnce(Invoke([](auto &&) -> folly::Optional<TLSMessage> {
+      .WillOnce(Invoke([](auto &&) -> ReadResult<TLSMessage> {
         throw FizzException(
             "arbitrary fizzexception with alert",
             AlertDescription::internal_error);
       }));
   folly::IOBufQueue buf;
-  auto actions = ClientStateMachine().processSocketData(state_, buf);
+  auto actions = getActions(
+      ClientStateMachine().processSocketData(state_, buf));
   auto exc = expectError<FizzException>(
       actions,
       AlertDescription::internal_error,
@@ -3728,12 +4078,13 @@ TEST_F(ClientProtocolTest, TestSocketDataFizzExceptionAlert) {
 TEST_F(ClientProtocolTest, TestSocketDataFizzExceptionNoAlert) {
   setupAcceptingData();
   EXPECT_CALL(*mockRead_, read(_))
-      .WillOnce(Invoke([](auto &&) -> folly::Optional<TLSMessage> {
+      .WillOnce(Invoke([](auto &&) -> ReadResult<TLSMessage> {
         throw FizzException(
             "arbitrary fizzexception without alert", folly::none);
       }));
   folly::IOBufQueue buf;
-  auto actions = ClientStateMachine().processSocketData(state_, buf);
+  auto actions = getActions(
+      ClientStateMachine().processSocketData(state_, buf));
   auto exc = expectError<FizzException>(
       actions, folly::none, "arbitrary fizzexception without alert");
 
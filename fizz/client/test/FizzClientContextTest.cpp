@@ -0,0 +1,70 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GTest.h>
+
+#include <fizz/client/FizzClientContext.h>
+
+using namespace folly;
+
+namespace fizz {
+namespace client {
+namespace test {
+
+static void expectSameExtension(const Extension& actual, Extension expected) {
+  EXPECT_EQ(actual.extension_type, expected.extension_type);
+  EXPECT_TRUE(IOBufEqualTo()(actual.extension_data, expected.extension_data));
+}
+
+TEST(FizzClientContextTest, TestPrecomputedDefaults) {
+  FizzClientContext context;
+  const auto& precomputed = context.getPrecomputedExtensions();
+
+  SupportedVersions versions;
+  versions.versions = context.getSupportedVersions();
+  expectSameExtension(precomputed.supportedVersions, encodeExtension(versions));
+
+  SupportedGroups groups;
+  groups.named_group_list = context.getSupportedGroups();
+  expectSameExtension(precomputed.supportedGroups, encodeExtension(groups));
+
+  SignatureAlgorithms sigAlgs;
+  sigAlgs.supported_signature_algorithms = context.getSupportedSigSchemes();
+  expectSameExtension(precomputed.sigSchemes, encodeExtension(sigAlgs));
+
+  EXPECT_FALSE(precomputed.alpns.hasValue());
+  EXPECT_TRUE(precomputed.pskModes.hasValue());
+  EXPECT_FALSE(precomputed.certCompression.hasValue());
+}
+
+TEST(FizzClientContextTest, TestPrecomputedRebuiltOnSet) {
+  FizzClientContext context;
+  context.setSupportedGroups({NamedGroup::secp256r1});
+  const auto& precomputed = context.getPrecomputedExtensions();
+
+  SupportedGroups groups;
+  groups.named_group_list = {NamedGroup::secp256r1};
+  expectSameExtension(precomputed.supportedGroups, encodeExtension(groups));
+
+  context.setSupportedAlpns({"h2", "http/1.1"});
+  ASSERT_TRUE(precomputed.alpns.hasValue());
+  ProtocolNameList alpn;
+  ProtocolName h2;
+  h2.name = IOBuf::copyBuffer("h2");
+  alpn.protocol_name_list.push_back(std::move(h2));
+  ProtocolName http11;
+  http11.name = IOBuf::copyBuffer("http/1.1");
+  alpn.protocol_name_list.push_back(std::move(http11));
+  expectSameExtension(*precomputed.alpns, encodeExtension(alpn));
+
+  context.setSupportedPskModes({});
+  EXPECT_FALSE(precomputed.pskModes.hasValue());
+}
+} // namespace test
+} // namespace client
+} // namespace fizz
@@ -61,20 +61,21 @@ class FizzClientTest : public Test {
 TEST_F(FizzClientTest, TestConnect) {
   EXPECT_CALL(
       *MockClientStateMachineInstance::instance,
-      _processConnect(_, _, _, _, _, _))
-      .WillOnce(InvokeWithoutArgs([] { return Actions(); }));
+      _processConnect(_, _, _, _, _, _, _))
+      .WillOnce(InvokeWithoutArgs([] { return AsyncActions(Actions()); }));
   const auto sni = std::string("www.example.com");
-  fizzClient_->fizzClient_.connect(context_, nullptr, sni, folly::none);
+  fizzClient_->fizzClient_.connect(&evb_, context_, nullptr, sni, folly::none);
 }
 
 TEST_F(FizzClientTest, TestConnectPskIdentity) {
   std::string psk("psk");
   EXPECT_CALL(
       *MockClientStateMachineInstance::instance,
-      _processConnect(_, _, _, _, _, _))
+      _processConnect(_, _, _, _, _, _, _))
       .WillOnce(
           Invoke([psk](
                      const State&,
+                     folly::Executor*,
                      std::shared_ptr<const FizzClientContext> context,
                      std::shared_ptr<const CertificateVerifier> verifier,
                      folly::Optional<std::string> sni,
@@ -83,13 +84,13 @@ TEST_F(FizzClientTest, TestConnectPskIdentity) {
             EXPECT_TRUE(cachedPsk);
             EXPECT_EQ(cachedPsk->psk, psk);
             EXPECT_EQ(sni, "www.example.com");
-            return Actions();
+            return AsyncActions(Actions());
           }));
   const auto sni = std::string("www.example.com");
   CachedPsk cachedPsk;
   cachedPsk.psk = psk;
   fizzClient_->fizzClient_.connect(
-      context_, nullptr, sni, std::move(cachedPsk));
+      &evb_, context_, nullptr, sni, std::move(cachedPsk));
 }
 
 TEST(FizzClientContextTest, TestCopy) {
@@ -10,6 +10,7 @@
 
 #include <fizz/client/AsyncFizzClient.h>
 #include <fizz/client/ClientExtensions.h>
+#include <fizz/client/GroupMemoryCache.h>
 #include <fizz/client/PskCache.h>
 #include <folly/io/async/test/MockAsyncTransport.h>
 
@@ -19,49 +20,60 @@ namespace test {
 
 class MockClientStateMachine : public ClientStateMachine {
  public:
-  MOCK_METHOD6(
+  MOCK_METHOD7(
       _processConnect,
-      folly::Optional<Actions>(
+      folly::Optional<AsyncActions>(
           const State&,
+          folly::Executor*,
           std::shared_ptr<const FizzClientContext> context,
           std::shared_ptr<const CertificateVerifier>,
           folly::Optional<std::string> host,
           folly::Optional<CachedPsk> cachedPsk,
           const std::shared_ptr<ClientExtensions>& extensions));
-  Actions processConnect(
+  AsyncActions processConnect(
       const State& state,
+      folly::Executor* executor,
       std::shared_ptr<const FizzClientContext> context,
       std::shared_ptr<const CertificateVerifier> verifier,
       folly::Optional<std::string> host,
       folly::Optional<CachedPsk> cachedPsk,
       const std::shared_ptr<ClientExtensions>& extensions) override {
     return *_processConnect(
-        state, context, verifier, host, cachedPsk, extensions);
+        state, executor, context, verifier, host, cachedPsk, extensions);
   }
 
   MOCK_METHOD2(
       _processSocketData,
-      folly::Optional<Actions>(const State&, folly::IOBufQueue&));
-  Actions processSocketData(const State& state, folly::IOBufQueue& queue)
+      folly::Optional<AsyncActions>(const State&, folly::IOBufQueue&));
+  AsyncActions processSocketData(const State& state, folly::IOBufQueue& queue)
       override {
     return *_processSocketData(state, queue);
   }
 
   MOCK_METHOD2(
       _processAppWrite,
-      folly::Optional<Actions>(const State&, AppWrite&));
-  Actions processAppWrite(const State& state, AppWrite appWrite) override {
+      folly::Optional<AsyncActions>(const State&, AppWrite&));
+  AsyncActions processAppWrite(const State& state, AppWrite appWrite) override {
     return *_processAppWrite(state, appWrite);
   }
 
   MOCK_METHOD2(
       _processEarlyAppWrite,
-      folly::Optional<Actions>(const State&, EarlyAppWrite&));
-  Actions processEarlyAppWrite(const State& state, EarlyAppWrite appWrite)
+      folly::Optional<AsyncActions>(const State&, EarlyAppWrite&));
+  AsyncActions processEarlyAppWrite(const State& state, EarlyAppWrite appWrite)
       override {
     return *_processEarlyAppWrite(state, appWrite);
   }
 
+  MOCK_METHOD2(
+      _processKeyUpdateInitiation,
+      folly::Optional<AsyncActions>(const State&, KeyUpdateInitiation&));
+  AsyncActions processKeyUpdateInitiation(
+      const State& state,
+      KeyUpdateInitiation keyUpdateInitiation) override {
+    return *_processKeyUpdateInitiation(state, keyUpdateInitiation);
+  }
+
   MOCK_METHOD1(_processAppClose, folly::Optional<Actions>(const State&));
   Actions processAppClose(const State& state) override {
     return *_processAppClose(state);
@@ -120,6 +132,15 @@ class MockPskCache : public PskCache {
   MOCK_METHOD1(removePsk, void(const std::string& identity));
 };
 
+class MockGroupMemoryCache : public GroupMemoryCache {
+ public:
+  MOCK_METHOD1(
+      getGroup,
+      folly::Optional<NamedGroup>(const std::string& destination));
+  MOCK_METHOD2(putGroup, void(const std::string& destination, NamedGroup));
+  MOCK_METHOD1(removeGroup, void(const std::string& destination));
+};
+
 class MockClientExtensions : public ClientExtensions {
  public:
   MOCK_CONST_METHOD0(getClientHelloExtensions, std::vector<Extension>());
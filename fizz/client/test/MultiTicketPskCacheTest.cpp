@@ -0,0 +1,118 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GMock.h>
+#include <folly/portability/GTest.h>
+
+#include <fizz/client/MultiTicketPskCache.h>
+#include <fizz/client/test/Utilities.h>
+#include <fizz/protocol/clock/test/Mocks.h>
+#include <folly/Format.h>
+
+#include <set>
+#include <thread>
+
+using namespace folly;
+using namespace testing;
+
+namespace fizz {
+namespace client {
+namespace test {
+
+class MultiTicketPskCacheTest : public Test {
+ public:
+  void SetUp() override {
+    cache_ = std::make_unique<MultiTicketPskCache>();
+    ticketTime_ = std::chrono::system_clock::now();
+  }
+
+ protected:
+  CachedPsk getCachedPsk(std::string pskName = "PSK") {
+    return getTestPsk(pskName, ticketTime_);
+  }
+
+  std::unique_ptr<MultiTicketPskCache> cache_;
+  std::chrono::system_clock::time_point ticketTime_;
+};
+
+TEST_F(MultiTicketPskCacheTest, TestSingleUseDequeue) {
+  for (int i : {1, 2, 3}) {
+    cache_->putPsk("fizz", getCachedPsk(folly::sformat("psk {}", i)));
+  }
+
+  // Each ticket is handed out exactly once, in order.
+  for (int i : {1, 2, 3}) {
+    auto psk = cache_->getPsk("fizz");
+    ASSERT_TRUE(psk.hasValue());
+    pskEq(getCachedPsk(folly::sformat("psk {}", i)), *psk);
+  }
+  EXPECT_FALSE(cache_->getPsk("fizz"));
+}
+
+TEST_F(MultiTicketPskCacheTest, TestRingEviction) {
+  cache_ = std::make_unique<MultiTicketPskCache>(2);
+  for (int i : {1, 2, 3}) {
+    cache_->putPsk("fizz", getCachedPsk(folly::sformat("psk {}", i)));
+  }
+
+  // The ring holds two tickets; the oldest was dropped.
+  pskEq(getCachedPsk("psk 2"), *cache_->getPsk("fizz"));
+  pskEq(getCachedPsk("psk 3"), *cache_->getPsk("fizz"));
+  EXPECT_FALSE(cache_->getPsk("fizz"));
+}
+
+TEST_F(MultiTicketPskCacheTest, TestExpiredTicketsDiscarded) {
+  auto clock = std::make_shared<fizz::test::MockClock>();
+  ON_CALL(*clock, getCurrentTime())
+      .WillByDefault(Return(ticketTime_ + std::chrono::hours(1)));
+  cache_->setClock(clock);
+
+  cache_->putPsk("fizz", getCachedPsk());
+  EXPECT_FALSE(cache_->getPsk("fizz"));
+}
+
+TEST_F(MultiTicketPskCacheTest, TestRemove) {
+  cache_->putPsk("fizz", getCachedPsk());
+  cache_->removePsk("fizz");
+  EXPECT_FALSE(cache_->getPsk("fizz"));
+}
+
+TEST_F(MultiTicketPskCacheTest, TestConcurrentDequeue) {
+  constexpr size_t numTickets = 8;
+  constexpr size_t numThreads = 4;
+  for (size_t i = 0; i < numTickets; i++) {
+    cache_->putPsk("fizz", getCachedPsk(folly::sformat("psk {}", i)));
+  }
+
+  std::vector<std::vector<std::string>> dequeued(numThreads);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < numThreads; t++) {
+    threads.emplace_back([this, t, &dequeued]() {
+      while (auto psk = cache_->getPsk("fizz")) {
+        dequeued[t].push_back(psk->psk);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // Every ticket was handed out exactly once across all threads.
+  std::set<std::string> unique;
+  size_t total = 0;
+  for (const auto& names : dequeued) {
+    total += names.size();
+    unique.insert(names.begin(), names.end());
+  }
+  EXPECT_EQ(total, numTickets);
+  EXPECT_EQ(unique.size(), numTickets);
+}
+
+} // namespace test
+} // namespace client
+} // namespace fizz
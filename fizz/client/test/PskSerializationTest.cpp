@@ -0,0 +1,103 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GMock.h>
+#include <folly/portability/GTest.h>
+
+#include <fizz/client/PskSerializationUtils.h>
+#include <fizz/client/SynchronizedLruPskCache.h>
+#include <fizz/client/test/Utilities.h>
+#include <fizz/protocol/clock/test/Mocks.h>
+
+using namespace folly;
+using namespace testing;
+
+namespace fizz {
+namespace client {
+namespace test {
+
+class PskSerializationTest : public Test {
+ public:
+  void SetUp() override {
+    // Serialization is second-granular; use an aligned timestamp so
+    // round trips compare equal.
+    ticketTime_ = std::chrono::time_point<std::chrono::system_clock>(
+        std::chrono::seconds(1000));
+    // Caches drop expired entries on lookup; pin their clock inside the
+    // test tickets' validity window.
+    clock_ = std::make_shared<fizz::test::MockClock>();
+    ON_CALL(*clock_, getCurrentTime()).WillByDefault(Return(ticketTime_));
+  }
+
+ protected:
+  CachedPsk getCachedPsk(std::string pskName = "PSK") {
+    return getTestPsk(pskName, ticketTime_);
+  }
+
+  std::chrono::system_clock::time_point ticketTime_;
+  std::shared_ptr<fizz::test::MockClock> clock_;
+};
+
+TEST_F(PskSerializationTest, TestRoundTrip) {
+  auto psk = getCachedPsk();
+  auto deserialized = deserializePsk(serializePsk(psk));
+  pskEq(psk, deserialized);
+  EXPECT_EQ(deserialized.serverCert, nullptr);
+  EXPECT_EQ(deserialized.clientCert, nullptr);
+}
+
+TEST_F(PskSerializationTest, TestRoundTripIdentityCert) {
+  auto psk = getCachedPsk();
+  psk.serverCert = std::make_shared<IdentityCert>("server");
+  auto deserialized = deserializePsk(serializePsk(psk));
+  pskEq(psk, deserialized);
+  ASSERT_NE(deserialized.serverCert, nullptr);
+  EXPECT_EQ(deserialized.serverCert->getIdentity(), "server");
+  EXPECT_EQ(deserialized.serverCert->getX509(), nullptr);
+}
+
+TEST_F(PskSerializationTest, TestDeserializeJunk) {
+  EXPECT_THROW(
+      deserializePsk(IOBuf::copyBuffer("junk")), std::exception);
+}
+
+TEST_F(PskSerializationTest, TestBasicCacheSaveLoad) {
+  BasicPskCache cache;
+  cache.putPsk("fizz", getCachedPsk("psk 1"));
+  cache.putPsk("buzz", getCachedPsk("psk 2"));
+
+  auto serialized = cache.savePsks();
+  ASSERT_NE(serialized, nullptr);
+
+  BasicPskCache restored;
+  restored.setClock(clock_);
+  restored.loadPsks(std::move(serialized));
+  auto psk = restored.getPsk("fizz");
+  ASSERT_TRUE(psk.hasValue());
+  pskEq(getCachedPsk("psk 1"), *psk);
+  EXPECT_TRUE(restored.getPsk("buzz").hasValue());
+}
+
+TEST_F(PskSerializationTest, TestLruCacheSaveLoad) {
+  SynchronizedLruPskCache cache(4);
+  cache.putPsk("fizz", getCachedPsk("psk 1"));
+  cache.putPsk("buzz", getCachedPsk("psk 2"));
+
+  auto serialized = cache.savePsks();
+  ASSERT_NE(serialized, nullptr);
+
+  SynchronizedLruPskCache restored(4);
+  restored.setClock(clock_);
+  restored.loadPsks(std::move(serialized));
+  EXPECT_TRUE(restored.getPsk("fizz").hasValue());
+  EXPECT_TRUE(restored.getPsk("buzz").hasValue());
+}
+
+} // namespace test
+} // namespace client
+} // namespace fizz
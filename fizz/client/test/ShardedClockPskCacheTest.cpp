@@ -0,0 +1,92 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GMock.h>
+#include <folly/portability/GTest.h>
+
+#include <fizz/client/ShardedClockPskCache.h>
+#include <fizz/client/test/Utilities.h>
+#include <folly/Format.h>
+
+using namespace folly;
+using namespace testing;
+
+namespace fizz {
+namespace client {
+namespace test {
+
+class ShardedClockPskCacheTest : public Test {
+ public:
+  void SetUp() override {
+    // A single shard makes the eviction order deterministic.
+    cache_ = std::make_unique<ShardedClockPskCache>(3, 1);
+    ticketTime_ = std::chrono::system_clock::now();
+  }
+
+ protected:
+  CachedPsk getCachedPsk(std::string pskName = "PSK") {
+    return getTestPsk(pskName, ticketTime_);
+  }
+
+  std::unique_ptr<ShardedClockPskCache> cache_;
+  std::chrono::system_clock::time_point ticketTime_;
+};
+
+TEST_F(ShardedClockPskCacheTest, TestBasic) {
+  auto psk = getCachedPsk();
+  cache_->putPsk("fizz", psk);
+  auto cachedPsk = cache_->getPsk("fizz");
+  EXPECT_TRUE(cachedPsk);
+  pskEq(psk, *cachedPsk);
+
+  cache_->removePsk("fizz");
+  EXPECT_FALSE(cache_->getPsk("fizz"));
+}
+
+TEST_F(ShardedClockPskCacheTest, TestUpdate) {
+  cache_->putPsk("fizz", getCachedPsk("psk 1"));
+  auto updated = getCachedPsk("psk 2");
+  cache_->putPsk("fizz", updated);
+  auto cachedPsk = cache_->getPsk("fizz");
+  EXPECT_TRUE(cachedPsk);
+  pskEq(updated, *cachedPsk);
+}
+
+TEST_F(ShardedClockPskCacheTest, TestEviction) {
+  for (int i : {1, 2, 3}) {
+    auto pskName = folly::sformat("psk {}", i);
+    auto psk = getCachedPsk(pskName);
+    cache_->putPsk(pskName, psk);
+  }
+
+  // The clock sweep clears all reference bits and wraps back to evict
+  // psk 1, the oldest unreferenced entry.
+  auto evictingPsk = getCachedPsk("psk 4");
+  cache_->putPsk("psk 4", evictingPsk);
+
+  EXPECT_FALSE(cache_->getPsk("psk 1"));
+  EXPECT_TRUE(cache_->getPsk("psk 2"));
+  EXPECT_TRUE(cache_->getPsk("psk 3"));
+  EXPECT_TRUE(cache_->getPsk("psk 4"));
+}
+
+TEST_F(ShardedClockPskCacheTest, TestManyShards) {
+  ShardedClockPskCache cache(64, 16);
+  for (int i = 0; i < 32; i++) {
+    auto pskName = folly::sformat("psk {}", i);
+    cache.putPsk(pskName, getCachedPsk(pskName));
+  }
+  for (int i = 0; i < 32; i++) {
+    auto pskName = folly::sformat("psk {}", i);
+    EXPECT_TRUE(cache.getPsk(pskName));
+  }
+}
+
+} // namespace test
+} // namespace client
+} // namespace fizz
@@ -11,6 +11,7 @@
 
 #include <fizz/client/SynchronizedLruPskCache.h>
 #include <fizz/client/test/Utilities.h>
+#include <fizz/protocol/clock/test/Mocks.h>
 #include <folly/Format.h>
 
 using namespace folly;
@@ -20,6 +21,27 @@ namespace fizz {
 namespace client {
 namespace test {
 
+class CountingPskCacheStats : public PskCacheStats {
+ public:
+  void hit() override {
+    hits++;
+  }
+  void miss() override {
+    misses++;
+  }
+  void eviction() override {
+    evictions++;
+  }
+  void expiredEntry() override {
+    expired++;
+  }
+
+  uint32_t hits{0};
+  uint32_t misses{0};
+  uint32_t evictions{0};
+  uint32_t expired{0};
+};
+
 class SynchronizedLruPskCacheTest : public Test {
  public:
   void SetUp() override {
@@ -65,6 +87,55 @@ TEST_F(SynchronizedLruPskCacheTest, TestEviction) {
   EXPECT_FALSE(psk1);
 }
 
+TEST_F(SynchronizedLruPskCacheTest, TestStats) {
+  auto stats = std::make_shared<CountingPskCacheStats>();
+  cache_->setStats(stats);
+
+  cache_->putPsk("fizz", getCachedPsk());
+  cache_->getPsk("fizz");
+  EXPECT_EQ(stats->hits, 1);
+  cache_->getPsk("buzz");
+  EXPECT_EQ(stats->misses, 1);
+
+  for (int i : {1, 2, 3}) {
+    cache_->putPsk(folly::sformat("psk {}", i), getCachedPsk());
+  }
+  EXPECT_EQ(stats->evictions, 1);
+}
+
+TEST_F(SynchronizedLruPskCacheTest, TestExpiredEntry) {
+  auto stats = std::make_shared<CountingPskCacheStats>();
+  auto clock = std::make_shared<fizz::test::MockClock>();
+  ON_CALL(*clock, getCurrentTime())
+      .WillByDefault(Return(ticketTime_ + std::chrono::hours(1)));
+  cache_->setStats(stats);
+  cache_->setClock(clock);
+
+  cache_->putPsk("fizz", getCachedPsk());
+  EXPECT_FALSE(cache_->getPsk("fizz"));
+  EXPECT_EQ(stats->expired, 1);
+
+  // The expired entry is dropped, so another lookup is a plain miss.
+  EXPECT_FALSE(cache_->getPsk("fizz"));
+  EXPECT_EQ(stats->expired, 1);
+  EXPECT_EQ(stats->misses, 1);
+}
+
+TEST_F(SynchronizedLruPskCacheTest, TestNegativeEntry) {
+  auto stats = std::make_shared<CountingPskCacheStats>();
+  cache_->setStats(stats);
+
+  cache_->putPsk("fizz", getCachedPsk());
+  cache_->putNegativeEntry("fizz");
+  EXPECT_FALSE(cache_->getPsk("fizz"));
+  EXPECT_EQ(stats->misses, 1);
+
+  // Storing a PSK again clears the negative entry.
+  cache_->putPsk("fizz", getCachedPsk());
+  EXPECT_TRUE(cache_->getPsk("fizz"));
+  EXPECT_EQ(stats->hits, 1);
+}
+
 } // namespace test
 } // namespace client
 } // namespace fizz
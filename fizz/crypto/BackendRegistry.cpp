@@ -0,0 +1,108 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/crypto/BackendRegistry.h>
+
+#include <algorithm>
+
+namespace fizz {
+
+namespace {
+template <typename BackendT>
+void insertByPriority(std::vector<BackendT>& backends, BackendT backend) {
+  // Highest priority first; ties resolve to earliest registration.
+  auto it = std::upper_bound(
+      backends.begin(),
+      backends.end(),
+      backend.priority,
+      [](int priority, const BackendT& b) { return priority > b.priority; });
+  backends.insert(it, std::move(backend));
+}
+
+template <typename MapT>
+const typename MapT::mapped_type::value_type* findBest(
+    const MapT& map,
+    uint16_t key) {
+  auto it = map.find(key);
+  if (it == map.end() || it->second.empty()) {
+    return nullptr;
+  }
+  return &it->second.front();
+}
+} // namespace
+
+CryptoBackendRegistry& CryptoBackendRegistry::getInstance() {
+  static auto instance = new CryptoBackendRegistry();
+  return *instance;
+}
+
+void CryptoBackendRegistry::registerAead(
+    CipherSuite suite,
+    std::string name,
+    int priority,
+    BackendCapabilities capabilities,
+    AeadMaker maker) {
+  auto aeads = aeads_.wlock();
+  insertByPriority(
+      (*aeads)[static_cast<uint16_t>(suite)],
+      Backend<AeadMaker>{
+          std::move(name), priority, capabilities, std::move(maker)});
+}
+
+void CryptoBackendRegistry::registerKeyExchange(
+    NamedGroup group,
+    std::string name,
+    int priority,
+    BackendCapabilities capabilities,
+    KeyExchangeMaker maker) {
+  auto keyExchanges = keyExchanges_.wlock();
+  insertByPriority(
+      (*keyExchanges)[static_cast<uint16_t>(group)],
+      Backend<KeyExchangeMaker>{
+          std::move(name), priority, capabilities, std::move(maker)});
+}
+
+std::unique_ptr<Aead> CryptoBackendRegistry::makeAead(
+    CipherSuite suite) const {
+  auto aeads = aeads_.rlock();
+  auto backend = findBest(*aeads, static_cast<uint16_t>(suite));
+  return backend ? backend->maker() : nullptr;
+}
+
+std::unique_ptr<KeyExchange> CryptoBackendRegistry::makeKeyExchange(
+    NamedGroup group) const {
+  auto keyExchanges = keyExchanges_.rlock();
+  auto backend = findBest(*keyExchanges, static_cast<uint16_t>(group));
+  return backend ? backend->maker() : nullptr;
+}
+
+folly::Optional<BackendCapabilities>
+CryptoBackendRegistry::getAeadCapabilities(CipherSuite suite) const {
+  auto aeads = aeads_.rlock();
+  auto backend = findBest(*aeads, static_cast<uint16_t>(suite));
+  if (!backend) {
+    return folly::none;
+  }
+  return backend->capabilities;
+}
+
+folly::Optional<BackendCapabilities>
+CryptoBackendRegistry::getKeyExchangeCapabilities(NamedGroup group) const {
+  auto keyExchanges = keyExchanges_.rlock();
+  auto backend = findBest(*keyExchanges, static_cast<uint16_t>(group));
+  if (!backend) {
+    return folly::none;
+  }
+  return backend->capabilities;
+}
+
+void CryptoBackendRegistry::clear() {
+  aeads_.wlock()->clear();
+  keyExchanges_.wlock()->clear();
+}
+} // namespace fizz
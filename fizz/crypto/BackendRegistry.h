@@ -0,0 +1,105 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/crypto/aead/Aead.h>
+#include <fizz/crypto/exchange/KeyExchange.h>
+#include <fizz/record/Types.h>
+#include <folly/Optional.h>
+#include <folly/Synchronized.h>
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace fizz {
+
+/**
+ * Capability flags a backend declares at registration. They do not change
+ * how the registry resolves implementations; they let callers that can
+ * exploit completion-based offload (for example by draining operations
+ * through an executor) discover whether the engine behind an algorithm
+ * supports it. Backends setting batchCapable are expected to override
+ * Aead::encryptBatch with a multi-buffer implementation.
+ */
+struct BackendCapabilities {
+  bool asyncCapable{false};
+  bool batchCapable{false};
+};
+
+/**
+ * Registry of crypto implementations keyed by algorithm. Hardware offload
+ * engines register Aead and KeyExchange constructors per cipher suite or
+ * named group with a priority; BackendFactory resolves the highest
+ * priority implementation at construction time and falls back to the
+ * built-in OpenSSL implementations when nothing is registered. Built-ins
+ * are not registered here, so an empty registry means stock behavior.
+ *
+ * Registration is expected at process startup (engine module init);
+ * lookups are thread safe.
+ */
+class CryptoBackendRegistry {
+ public:
+  using AeadMaker = std::function<std::unique_ptr<Aead>()>;
+  using KeyExchangeMaker = std::function<std::unique_ptr<KeyExchange>()>;
+
+  static CryptoBackendRegistry& getInstance();
+
+  void registerAead(
+      CipherSuite suite,
+      std::string name,
+      int priority,
+      BackendCapabilities capabilities,
+      AeadMaker maker);
+
+  void registerKeyExchange(
+      NamedGroup group,
+      std::string name,
+      int priority,
+      BackendCapabilities capabilities,
+      KeyExchangeMaker maker);
+
+  /**
+   * Constructs the highest priority registered implementation, or nullptr
+   * if no backend is registered for the algorithm.
+   */
+  std::unique_ptr<Aead> makeAead(CipherSuite suite) const;
+  std::unique_ptr<KeyExchange> makeKeyExchange(NamedGroup group) const;
+
+  /**
+   * Capabilities of the implementation makeAead/makeKeyExchange would
+   * return, or none if no backend is registered.
+   */
+  folly::Optional<BackendCapabilities> getAeadCapabilities(
+      CipherSuite suite) const;
+  folly::Optional<BackendCapabilities> getKeyExchangeCapabilities(
+      NamedGroup group) const;
+
+  /**
+   * Removes all registrations. For tests.
+   */
+  void clear();
+
+ private:
+  template <typename MakerT>
+  struct Backend {
+    std::string name;
+    int priority;
+    BackendCapabilities capabilities;
+    MakerT maker;
+  };
+
+  template <typename MakerT>
+  using BackendMap = std::map<uint16_t, std::vector<Backend<MakerT>>>;
+
+  folly::Synchronized<BackendMap<AeadMaker>> aeads_;
+  folly::Synchronized<BackendMap<KeyExchangeMaker>> keyExchanges_;
+};
+} // namespace fizz
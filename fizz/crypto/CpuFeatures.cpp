@@ -0,0 +1,80 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/crypto/CpuFeatures.h>
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <folly/CpuId.h>
+#elif defined(__aarch64__) && defined(__linux__)
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+
+namespace fizz {
+
+namespace {
+bool probeAesAcceleration() {
+#if defined(__x86_64__) || defined(__i386__)
+  return folly::CpuId().aes();
+#elif defined(__aarch64__) && defined(__linux__)
+  return (getauxval(AT_HWCAP) & HWCAP_AES) != 0;
+#else
+  return false;
+#endif
+}
+
+bool isAesSuite(CipherSuite suite) {
+  switch (suite) {
+    case CipherSuite::TLS_AES_128_GCM_SHA256:
+    case CipherSuite::TLS_AES_256_GCM_SHA384:
+    case CipherSuite::TLS_AES_128_OCB_SHA256_EXPERIMENTAL:
+      return true;
+    default:
+      return false;
+  }
+}
+} // namespace
+
+bool CpuFeatures::hasAesAcceleration() {
+  static const bool accelerated = probeAesAcceleration();
+  return accelerated;
+}
+
+std::vector<CipherSuite> CpuFeatures::orderCiphers(
+    std::vector<CipherSuite> ciphers,
+    bool aesAccelerated) {
+  if (!aesAccelerated) {
+    std::stable_partition(
+        ciphers.begin(), ciphers.end(), [](CipherSuite suite) {
+          return !isAesSuite(suite);
+        });
+  }
+  return ciphers;
+}
+
+std::vector<std::vector<CipherSuite>> CpuFeatures::orderCiphers(
+    std::vector<std::vector<CipherSuite>> cipherTiers,
+    bool aesAccelerated) {
+  for (auto& tier : cipherTiers) {
+    tier = orderCiphers(std::move(tier), aesAccelerated);
+  }
+  return cipherTiers;
+}
+
+std::vector<CipherSuite> CpuFeatures::orderCiphers(
+    std::vector<CipherSuite> ciphers) {
+  return orderCiphers(std::move(ciphers), hasAesAcceleration());
+}
+
+std::vector<std::vector<CipherSuite>> CpuFeatures::orderCiphers(
+    std::vector<std::vector<CipherSuite>> cipherTiers) {
+  return orderCiphers(std::move(cipherTiers), hasAesAcceleration());
+}
+} // namespace fizz
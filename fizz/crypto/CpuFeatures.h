@@ -0,0 +1,58 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/record/Types.h>
+
+#include <vector>
+
+namespace fizz {
+
+/**
+ * Process-wide probe of the CPU's crypto capabilities, used to pick
+ * sensible default cipher preferences on heterogeneous fleets. Without
+ * hardware AES support, software AES-GCM is several times slower than
+ * ChaCha20-Poly1305, so hosts lacking it should prefer ChaCha by
+ * default rather than relying on per-platform configuration.
+ *
+ * The probe runs once on first use (cpuid on x86, the hwcap auxiliary
+ * vector on Linux aarch64) and is cached for the life of the process.
+ */
+struct CpuFeatures {
+  /**
+   * Whether this CPU has hardware AES support (AES-NI on x86, the
+   * ARMv8 crypto extensions on aarch64). Returns false on platforms
+   * where the probe is not implemented.
+   */
+  static bool hasAesAcceleration();
+
+  /**
+   * Reorders a cipher preference list for a CPU with or without
+   * hardware AES. Without acceleration, non-AES suites are moved ahead
+   * of AES suites; otherwise the list is returned as given, on the
+   * assumption that the caller already lists AES first. Relative order
+   * within each class is preserved, and no suites are added or removed.
+   */
+  static std::vector<CipherSuite> orderCiphers(
+      std::vector<CipherSuite> ciphers,
+      bool aesAccelerated);
+  static std::vector<std::vector<CipherSuite>> orderCiphers(
+      std::vector<std::vector<CipherSuite>> cipherTiers,
+      bool aesAccelerated);
+
+  /**
+   * As above, using the probed capabilities of this CPU. Used by the
+   * context defaults.
+   */
+  static std::vector<CipherSuite> orderCiphers(
+      std::vector<CipherSuite> ciphers);
+  static std::vector<std::vector<CipherSuite>> orderCiphers(
+      std::vector<std::vector<CipherSuite>> cipherTiers);
+};
+} // namespace fizz
@@ -30,30 +30,31 @@ inline std::unique_ptr<folly::IOBuf> HkdfImpl<Hash>::expand(
   if (UNLIKELY(outputBytes > 255 * Hash::HashLen)) {
     throw std::runtime_error("Output too long");
   }
-  // HDKF expansion step.
+  // HDKF expansion step. The keyed pad states are cached across rounds and
+  // across expand calls made with the same PRK; each round restores the
+  // cheap midstate instead of re-keying the HMAC from scratch.
+  hmacCache_.setKey(extractedKey);
   size_t numRounds = (outputBytes + Hash::HashLen - 1) / Hash::HashLen;
   auto expanded = folly::IOBuf::create(numRounds * Hash::HashLen);
 
-  auto in = folly::IOBuf::create(0);
+  folly::ByteRange previousBlock;
   for (size_t round = 1; round <= numRounds; ++round) {
-    in->prependChain(info.clone());
     // We're guaranteed that the round num will fit in
     // one byte because of the check at the beginning of
     // the method.
-    auto roundNum = folly::IOBuf::create(1);
-    roundNum->append(1);
-    roundNum->writableData()[0] = round;
-    in->prependChain(std::move(roundNum));
+    uint8_t roundNum = round;
+    hmacCache_.hmacInit();
+    hmacCache_.hmacUpdate(previousBlock);
+    for (auto infoRange : info) {
+      hmacCache_.hmacUpdate(infoRange);
+    }
+    hmacCache_.hmacUpdate({&roundNum, 1});
 
     size_t outputStartIdx = (round - 1) * Hash::HashLen;
-    Hash::hmac(
-        folly::range(extractedKey),
-        *in,
+    hmacCache_.hmacFinal(
         {expanded->writableData() + outputStartIdx, Hash::HashLen});
     expanded->append(Hash::HashLen);
-
-    in = expanded->clone();
-    in->trimStart(outputStartIdx);
+    previousBlock = {expanded->data() + outputStartIdx, Hash::HashLen};
   }
   expanded->trimEnd(numRounds * Hash::HashLen - outputBytes);
   return expanded;
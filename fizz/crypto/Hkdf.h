@@ -70,6 +70,11 @@ class HkdfImpl : public Hkdf {
   size_t hashLength() const override {
     return HashLen;
   }
+
+ private:
+  // Caches the keyed HMAC pad states across rounds and across expand calls
+  // made with the same PRK.
+  mutable typename Hash::HmacStateCache hmacCache_;
 };
 } // namespace fizz
 
@@ -20,16 +20,54 @@ Buf KeyDerivationImpl<Hash>::expandLabel(
     uint16_t length) {
   HkdfLabel hkdfLabel = {
       length, std::string(label.begin(), label.end()), std::move(hashValue)};
-  return HkdfImpl<Hash>().expand(
+  return hkdf_.expand(
       secret, *encodeHkdfLabel(std::move(hkdfLabel), labelPrefix_), length);
 }
 
+template <typename Hash>
+void KeyDerivationImpl<Hash>::expandLabelPair(
+    folly::ByteRange secret,
+    folly::StringPiece firstLabel,
+    folly::MutableByteRange firstOut,
+    folly::StringPiece secondLabel,
+    folly::MutableByteRange secondOut) {
+  CHECK_LE(firstOut.size(), Hash::HashLen);
+  CHECK_LE(secondOut.size(), Hash::HashLen);
+  // For outputs no longer than the hash a single HKDF round suffices:
+  // out = HMAC(secret, HkdfLabel || 0x01). Encode each label into a fixed
+  // scratch rather than building the info buffer chain expandLabel uses.
+  std::array<uint8_t, 64> info;
+  std::array<uint8_t, Hash::HashLen> expanded;
+  auto deriveOne = [&](folly::StringPiece label, folly::MutableByteRange out) {
+    size_t labelLen = labelPrefix_.size() + label.size();
+    // length(2) + label length(1) + label + hash length(1) + round(1)
+    CHECK_LE(labelLen + 5, info.size());
+    size_t idx = 0;
+    info[idx++] = out.size() >> 8;
+    info[idx++] = out.size() & 0xff;
+    info[idx++] = labelLen;
+    memcpy(info.data() + idx, labelPrefix_.data(), labelPrefix_.size());
+    idx += labelPrefix_.size();
+    memcpy(info.data() + idx, label.data(), label.size());
+    idx += label.size();
+    info[idx++] = 0; // empty hash value
+    info[idx++] = 1; // round number
+    Hash::hmac(
+        secret,
+        folly::IOBuf::wrapBufferAsValue(info.data(), idx),
+        folly::range(expanded));
+    memcpy(out.data(), expanded.data(), out.size());
+  };
+  deriveOne(firstLabel, firstOut);
+  deriveOne(secondLabel, secondOut);
+}
+
 template <typename Hash>
 Buf KeyDerivationImpl<Hash>::hkdfExpand(
     folly::ByteRange secret,
     Buf info,
     uint16_t length) {
-  return HkdfImpl<Hash>().expand(secret, *info, length);
+  return hkdf_.expand(secret, *info, length);
 }
 
 template <typename Hash>
@@ -37,19 +75,41 @@ std::vector<uint8_t> KeyDerivationImpl<Hash>::deriveSecret(
     folly::ByteRange secret,
     folly::StringPiece label,
     folly::ByteRange messageHash) {
-  CHECK_EQ(secret.size(), Hash::HashLen);
-  CHECK_EQ(messageHash.size(), Hash::HashLen);
-  // Copying the buffer to avoid violating constness of the data.
-  auto hashBuf = folly::IOBuf::copyBuffer(messageHash);
-  auto out = expandLabel(secret, label, std::move(hashBuf), Hash::HashLen);
   std::vector<uint8_t> prk(Hash::HashLen);
-  size_t offset = 0;
-  for (auto buf : *out) {
-    size_t remaining = Hash::HashLen - offset;
-    size_t length = std::min(buf.size(), remaining);
-    memcpy(prk.data() + offset, buf.data(), length);
-    offset += length;
-  }
+  deriveSecret(secret, label, messageHash, folly::range(prk));
   return prk;
 }
+
+template <typename Hash>
+void KeyDerivationImpl<Hash>::deriveSecret(
+    folly::ByteRange secret,
+    folly::StringPiece label,
+    folly::ByteRange messageHash,
+    folly::MutableByteRange out) {
+  CHECK_EQ(secret.size(), Hash::HashLen);
+  CHECK_EQ(messageHash.size(), Hash::HashLen);
+  CHECK_EQ(out.size(), Hash::HashLen);
+  // The output is exactly one hash long, so a single HKDF round suffices:
+  // out = HMAC(secret, HkdfLabel || 0x01). Encode the label and hash value
+  // into a fixed scratch rather than building the info buffer chain
+  // expandLabel uses.
+  std::array<uint8_t, 128> info;
+  size_t labelLen = labelPrefix_.size() + label.size();
+  // length(2) + label length(1) + label + hash length(1) + hash + round(1)
+  CHECK_LE(labelLen + Hash::HashLen + 5, info.size());
+  size_t idx = 0;
+  info[idx++] = Hash::HashLen >> 8;
+  info[idx++] = Hash::HashLen & 0xff;
+  info[idx++] = labelLen;
+  memcpy(info.data() + idx, labelPrefix_.data(), labelPrefix_.size());
+  idx += labelPrefix_.size();
+  memcpy(info.data() + idx, label.data(), label.size());
+  idx += label.size();
+  info[idx++] = Hash::HashLen;
+  memcpy(info.data() + idx, messageHash.data(), messageHash.size());
+  idx += messageHash.size();
+  info[idx++] = 1; // round number
+  Hash::hmac(
+      secret, folly::IOBuf::wrapBufferAsValue(info.data(), idx), out);
+}
 } // namespace fizz
@@ -11,6 +11,8 @@
 #include <fizz/crypto/Hkdf.h>
 #include <fizz/record/Types.h>
 
+#include <array>
+
 namespace fizz {
 
 /**
@@ -33,11 +35,36 @@ class KeyDerivation {
       Buf hashValue,
       uint16_t length) = 0;
 
+  /**
+   * Derives two outputs (typically a key and an iv) from the same secret in
+   * one pass, writing them directly into the provided ranges. Equivalent to
+   * two expandLabel() calls with empty hash values, but encodes both labels
+   * into a single preallocated scratch and skips the intermediate buffer
+   * allocations. Both output lengths must be <= hashLength().
+   */
+  virtual void expandLabelPair(
+      folly::ByteRange secret,
+      folly::StringPiece firstLabel,
+      folly::MutableByteRange firstOut,
+      folly::StringPiece secondLabel,
+      folly::MutableByteRange secondOut) = 0;
+
   virtual std::vector<uint8_t> deriveSecret(
       folly::ByteRange secret,
       folly::StringPiece label,
       folly::ByteRange messageHash) = 0;
 
+  /**
+   * As deriveSecret(), but writes the derived secret into a caller-provided
+   * range of exactly hashLength() bytes, avoiding a heap allocation per
+   * derivation.
+   */
+  virtual void deriveSecret(
+      folly::ByteRange secret,
+      folly::StringPiece label,
+      folly::ByteRange messageHash,
+      folly::MutableByteRange out) = 0;
+
   /**
    * Performs HDKF expansion.
    */
@@ -48,6 +75,15 @@ class KeyDerivation {
       folly::ByteRange salt,
       folly::ByteRange ikm) = 0;
 
+  /**
+   * As hkdfExtract(), but writes the extracted key into a caller-provided
+   * range of exactly hashLength() bytes.
+   */
+  virtual void hkdfExtract(
+      folly::ByteRange salt,
+      folly::ByteRange ikm,
+      folly::MutableByteRange out) = 0;
+
   virtual void hash(const folly::IOBuf& in, folly::MutableByteRange out) = 0;
 
   virtual void hmac(
@@ -88,21 +124,47 @@ class KeyDerivationImpl : public KeyDerivation {
       Buf hashValue,
       uint16_t length) override;
 
+  void expandLabelPair(
+      folly::ByteRange secret,
+      folly::StringPiece firstLabel,
+      folly::MutableByteRange firstOut,
+      folly::StringPiece secondLabel,
+      folly::MutableByteRange secondOut) override;
+
   std::vector<uint8_t> deriveSecret(
       folly::ByteRange secret,
       folly::StringPiece label,
       folly::ByteRange messageHash) override;
 
+  void deriveSecret(
+      folly::ByteRange secret,
+      folly::StringPiece label,
+      folly::ByteRange messageHash,
+      folly::MutableByteRange out) override;
+
   virtual Buf hkdfExpand(folly::ByteRange secret, Buf info, uint16_t length)
       override;
 
   std::vector<uint8_t> hkdfExtract(folly::ByteRange salt, folly::ByteRange ikm)
       override {
-    return HkdfImpl<Hash>().extract(salt, ikm);
+    return hkdf_.extract(salt, ikm);
+  }
+
+  void hkdfExtract(
+      folly::ByteRange salt,
+      folly::ByteRange ikm,
+      folly::MutableByteRange out) override {
+    CHECK_EQ(out.size(), Hash::HashLen);
+    static constexpr std::array<uint8_t, Hash::HashLen> kZeroSalt{};
+    salt = salt.empty() ? folly::range(kZeroSalt) : salt;
+    Hash::hmac(salt, folly::IOBuf::wrapBufferAsValue(ikm), out);
   }
 
  private:
   std::string labelPrefix_;
+  // Persistent so that its keyed HMAC state cache survives across the many
+  // expand calls a handshake makes with the same PRK.
+  HkdfImpl<Hash> hkdf_;
 };
 } // namespace fizz
 
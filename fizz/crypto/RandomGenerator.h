@@ -9,10 +9,76 @@
 #pragma once
 
 #include <sodium/randombytes.h>
+#include <sodium/utils.h>
+
+#include <pthread.h>
+
 #include <array>
+#include <cstring>
 
 namespace fizz {
 
+namespace detail {
+
+/**
+ * Per-thread buffer of random bytes, refilled from libsodium in chunks so
+ * that typical requests (client randoms, session ids, ticket nonces) are a
+ * lock-free copy out of thread-local memory rather than a trip into the
+ * underlying generator per call. Consumed bytes are wiped as they are
+ * handed out.
+ *
+ * A forked child inherits the buffer, so an atfork handler discards it in
+ * the child; otherwise parent and child would both hand out the same
+ * bytes, duplicating randoms, ticket nonces and AEAD token salts across
+ * processes. randombytes_buf itself reseeds after fork.
+ */
+class BufferedRandom {
+ public:
+  static void fill(void* out, size_t size) {
+    if (size > kBufferSize) {
+      randombytes_buf(out, size);
+      return;
+    }
+    auto& state = threadState();
+    if (state.remaining < size) {
+      randombytes_buf(state.buf.data(), state.buf.size());
+      state.remaining = state.buf.size();
+    }
+    auto src = state.buf.data() + (state.buf.size() - state.remaining);
+    memcpy(out, src, size);
+    sodium_memzero(src, size);
+    state.remaining -= size;
+  }
+
+  /**
+   * Discards any bytes buffered on this thread. Needed by tests that swap
+   * the underlying randombytes implementation.
+   */
+  static void clear() {
+    auto& state = threadState();
+    sodium_memzero(state.buf.data(), state.buf.size());
+    state.remaining = 0;
+  }
+
+ private:
+  static constexpr size_t kBufferSize = 1024;
+
+  struct State {
+    std::array<uint8_t, kBufferSize> buf;
+    size_t remaining{0};
+  };
+
+  static State& threadState() {
+    // Registered once per process; the child handler runs on the only
+    // thread that survives the fork, which owns this buffer.
+    static int registered = pthread_atfork(nullptr, nullptr, clear);
+    (void)registered;
+    static thread_local State state;
+    return state;
+  }
+};
+} // namespace detail
+
 template <size_t Size>
 struct RandomGenerator {
   /**
@@ -20,7 +86,7 @@ struct RandomGenerator {
    */
   std::array<uint8_t, Size> generateRandom() {
     std::array<uint8_t, Size> random;
-    randombytes_buf(random.data(), Size);
+    detail::BufferedRandom::fill(random.data(), Size);
     return random;
   }
 };
@@ -32,7 +98,7 @@ struct RandomNumGenerator {
    */
   T generateRandom() {
     T random;
-    randombytes_buf(&random, sizeof(random));
+    detail::BufferedRandom::fill(&random, sizeof(random));
     return random;
   }
 };
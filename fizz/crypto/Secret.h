@@ -0,0 +1,102 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/crypto/Utils.h>
+#include <folly/Range.h>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+namespace fizz {
+
+/**
+ * Fixed-capacity inline buffer for TLS secrets.
+ *
+ * Secrets are at most one hash (48 bytes) long, so holding them inline
+ * avoids a heap allocation per secret and keeps them cache-local. The
+ * storage is wiped on destruction, so secrets do not linger on freed heap
+ * pages after the connection is torn down.
+ */
+class SecretStorage {
+ public:
+  static constexpr size_t kMaxLength = 64;
+
+  using value_type = uint8_t;
+  using const_iterator = const uint8_t*;
+
+  SecretStorage() = default;
+
+  SecretStorage(const uint8_t* begin, const uint8_t* end) {
+    resize(std::distance(begin, end));
+    std::copy(begin, end, storage_.data());
+  }
+
+  /* implicit */ SecretStorage(folly::ByteRange secret)
+      : SecretStorage(secret.begin(), secret.end()) {}
+
+  /* implicit */ SecretStorage(const std::vector<uint8_t>& secret)
+      : SecretStorage(secret.data(), secret.data() + secret.size()) {}
+
+  SecretStorage(const SecretStorage&) = default;
+  SecretStorage& operator=(const SecretStorage&) = default;
+
+  ~SecretStorage() {
+    CryptoUtils::clean({storage_.data(), storage_.size()});
+  }
+
+  /**
+   * Sets the length without initializing the contents; the caller is
+   * expected to derive directly into data().
+   */
+  void resize(size_t size) {
+    CHECK_LE(size, kMaxLength);
+    size_ = size;
+  }
+
+  uint8_t* data() {
+    return storage_.data();
+  }
+
+  const uint8_t* data() const {
+    return storage_.data();
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  const uint8_t* begin() const {
+    return storage_.data();
+  }
+
+  const uint8_t* end() const {
+    return storage_.data() + size_;
+  }
+
+ private:
+  std::array<uint8_t, kMaxLength> storage_{};
+  size_t size_{0};
+};
+
+inline bool operator==(const SecretStorage& a, const SecretStorage& b) {
+  return a.size() == b.size() &&
+      CryptoUtils::equal({a.begin(), a.end()}, {b.begin(), b.end()});
+}
+
+inline bool operator!=(const SecretStorage& a, const SecretStorage& b) {
+  return !(a == b);
+}
+} // namespace fizz
@@ -12,22 +12,31 @@ namespace fizz {
 
 template <typename T>
 void Sha<T>::hash_init() {
-  digest_.hash_init(T::HashEngine());
+  if (T::HashInit(&ctx_) != 1) {
+    throw std::runtime_error("Hash init error");
+  }
 }
 
 template <typename T>
 void Sha<T>::hash_update(folly::ByteRange data) {
-  digest_.hash_update(data);
+  if (T::HashUpdate(&ctx_, data.data(), data.size()) != 1) {
+    throw std::runtime_error("Hash update error");
+  }
 }
 
 template <typename T>
 void Sha<T>::hash_update(const folly::IOBuf& data) {
-  digest_.hash_update(data);
+  for (auto r : data) {
+    hash_update(r);
+  }
 }
 
 template <typename T>
 void Sha<T>::hash_final(folly::MutableByteRange out) {
-  digest_.hash_final(out);
+  CHECK_GE(out.size(), T::HashLen);
+  if (T::HashFinal(out.data(), &ctx_) != 1) {
+    throw std::runtime_error("Hash final error");
+  }
 }
 
 template <typename T>
@@ -42,6 +51,61 @@ void Sha<T>::hmac(
 template <typename T>
 void Sha<T>::hash(const folly::IOBuf& in, folly::MutableByteRange out) {
   CHECK_GE(out.size(), T::HashLen);
-  folly::ssl::OpenSSLHash::hash(out, T::HashEngine(), in);
+  T hasher;
+  hasher.hash_init();
+  hasher.hash_update(in);
+  hasher.hash_final(out);
+}
+
+template <typename T>
+Sha<T>::HmacStateCache::HmacStateCache() : ctx_(HMAC_CTX_new()) {
+  if (!ctx_) {
+    throw std::runtime_error("Unable to allocate an HMAC_CTX object");
+  }
+}
+
+template <typename T>
+Sha<T>::HmacStateCache::~HmacStateCache() {
+  CryptoUtils::clean(folly::range(key_));
+}
+
+template <typename T>
+void Sha<T>::HmacStateCache::setKey(folly::ByteRange key) {
+  if (keySet_ && key.size() == key_.size() &&
+      memcmp(key.data(), key_.data(), key.size()) == 0) {
+    return;
+  }
+  if (HMAC_Init_ex(
+          ctx_.get(), key.data(), key.size(), T::HashEngine(), nullptr) != 1) {
+    throw std::runtime_error("HMAC key init error");
+  }
+  CryptoUtils::clean(folly::range(key_));
+  key_.assign(key.begin(), key.end());
+  keySet_ = true;
+}
+
+template <typename T>
+void Sha<T>::HmacStateCache::hmacInit() {
+  // A null key re-init restores the cached keyed pad states.
+  if (HMAC_Init_ex(ctx_.get(), nullptr, 0, nullptr, nullptr) != 1) {
+    throw std::runtime_error("HMAC init error");
+  }
+}
+
+template <typename T>
+void Sha<T>::HmacStateCache::hmacUpdate(folly::ByteRange data) {
+  if (HMAC_Update(ctx_.get(), data.data(), data.size()) != 1) {
+    throw std::runtime_error("HMAC update error");
+  }
+}
+
+template <typename T>
+void Sha<T>::HmacStateCache::hmacFinal(folly::MutableByteRange out) {
+  CHECK_GE(out.size(), T::HashLen);
+  unsigned int outLen;
+  if (HMAC_Final(ctx_.get(), out.data(), &outLen) != 1) {
+    throw std::runtime_error("HMAC final error");
+  }
+  DCHECK_EQ(outLen, T::HashLen);
 }
 } // namespace fizz
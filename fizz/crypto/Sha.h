@@ -8,9 +8,15 @@
 
 #pragma once
 
+#include <fizz/crypto/Utils.h>
+
 #include <folly/Range.h>
 #include <folly/io/IOBuf.h>
 #include <folly/ssl/OpenSSLHash.h>
+#include <folly/ssl/OpenSSLPtrTypes.h>
+#include <openssl/hmac.h>
+
+#include <vector>
 
 namespace fizz {
 
@@ -20,7 +26,14 @@ namespace fizz {
  * The template struct requires the following parameters:
  *   - HashLen: length of the hash digest
  *   - HashEngine: function returning EVP_MD* to use
+ *   - HashContext: low-level hash context type
+ *   - HashInit/HashUpdate/HashFinal: direct functions over HashContext
  *   - BlankHash: ByteRange containing the digest of a hash of empty input
+ *
+ * Digest state goes through the direct context functions rather than EVP,
+ * avoiding the per-call EVP dispatch and allocation on the transcript hash
+ * path; OpenSSL's block functions still select SHA-NI/ARMv8 Crypto
+ * Extensions assembly at runtime where the CPU supports it.
  */
 template <typename T>
 class Sha {
@@ -46,8 +59,31 @@ class Sha {
    */
   static void hash(const folly::IOBuf& in, folly::MutableByteRange out);
 
+  /**
+   * HMAC context that caches the keyed inner/outer pad block states.
+   * setKey() with the key that is already installed is a no-op, and each
+   * hmacInit() restores the cached midstate rather than re-deriving it from
+   * the key.
+   */
+  class HmacStateCache {
+   public:
+    HmacStateCache();
+    ~HmacStateCache();
+
+    void setKey(folly::ByteRange key);
+    void hmacInit();
+    void hmacUpdate(folly::ByteRange data);
+    void hmacFinal(folly::MutableByteRange out);
+
+   private:
+    folly::ssl::HmacCtxUniquePtr ctx_;
+    // Wiped on destruction and re-key: this holds extracted PRKs.
+    std::vector<uint8_t> key_;
+    bool keySet_{false};
+  };
+
  private:
-  folly::ssl::OpenSSLHash::Digest digest_;
+  typename T::HashContext ctx_;
 };
 } // namespace fizz
 #include <fizz/crypto/Sha-inl.h>
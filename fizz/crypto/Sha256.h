@@ -10,6 +10,7 @@
 
 #include <fizz/crypto/Sha.h>
 #include <openssl/evp.h>
+#include <openssl/sha.h>
 #include <array>
 
 namespace fizz {
@@ -20,6 +21,11 @@ class Sha256 : public Sha<Sha256> {
 
   static constexpr auto HashEngine = EVP_sha256;
 
+  using HashContext = SHA256_CTX;
+  static constexpr auto HashInit = SHA256_Init;
+  static constexpr auto HashUpdate = SHA256_Update;
+  static constexpr auto HashFinal = SHA256_Final;
+
   static constexpr folly::StringPiece BlankHash{
       "\xe3\xb0\xc4\x42\x98\xfc\x1c\x14\x9a\xfb\xf4\xc8\x99\x6f\xb9\x24\x27\xae\x41\xe4\x64\x9b\x93\x4c\xa4\x95\x99\x1b\x78\x52\xb8\x55"};
 };
@@ -10,6 +10,7 @@
 
 #include <fizz/crypto/Sha.h>
 #include <openssl/evp.h>
+#include <openssl/sha.h>
 #include <array>
 
 namespace fizz {
@@ -20,6 +21,11 @@ class Sha384 : public Sha<Sha384> {
 
   static constexpr auto HashEngine = EVP_sha384;
 
+  using HashContext = SHA512_CTX;
+  static constexpr auto HashInit = SHA384_Init;
+  static constexpr auto HashUpdate = SHA384_Update;
+  static constexpr auto HashFinal = SHA384_Final;
+
   static constexpr folly::StringPiece BlankHash{
       "\x38\xb0\x60\xa7\x51\xac\x96\x38\x4c\xd9\x32\x7e\xb1\xb1\xe3\x6a\x21\xfd\xb7\x11\x14\xbe\x07\x43\x4c\x0c\xc7\xbf\x63\xf6\xe1\xda\x27\x4e\xde\xbf\xe7\x6f\x65\xfb\xd5\x1a\xd2\xf1\x48\x98\xb9\x5b"};
 };
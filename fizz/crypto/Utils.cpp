@@ -12,8 +12,53 @@
 
 #include <folly/ssl/Init.h>
 
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 namespace {
 
+// Accumulates the XOR difference over the whole input with no
+// data-dependent branches or early exits; only the final reduction
+// inspects the accumulated value. Lengths are not treated as secret.
+uint64_t accumulateDiff(const uint8_t* a, const uint8_t* b, size_t len) {
+  uint64_t diff = 0;
+#ifdef __SSE2__
+  __m128i vdiff = _mm_setzero_si128();
+  while (len >= 16) {
+    auto va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+    auto vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+    vdiff = _mm_or_si128(vdiff, _mm_xor_si128(va, vb));
+    a += 16;
+    b += 16;
+    len -= 16;
+  }
+  // The mask is 0xffff iff every accumulated byte is zero.
+  diff |= 0xffffu ^
+      static_cast<unsigned>(
+              _mm_movemask_epi8(_mm_cmpeq_epi8(vdiff, _mm_setzero_si128())));
+#endif
+  while (len >= 8) {
+    uint64_t wordA;
+    uint64_t wordB;
+    memcpy(&wordA, a, 8);
+    memcpy(&wordB, b, 8);
+    diff |= wordA ^ wordB;
+    a += 8;
+    b += 8;
+    len -= 8;
+  }
+  while (len > 0) {
+    diff |= static_cast<uint64_t>(*a ^ *b);
+    a++;
+    b++;
+    len--;
+  }
+  return diff;
+}
+
 class InitFizz {
  public:
   InitFizz() {
@@ -32,7 +77,7 @@ bool CryptoUtils::equal(folly::ByteRange a, folly::ByteRange b) {
   if (a.size() != b.size()) {
     return false;
   }
-  return sodium_memcmp(a.data(), b.data(), a.size()) == 0;
+  return accumulateDiff(a.data(), b.data(), a.size()) == 0;
 }
 
 void CryptoUtils::clean(folly::MutableByteRange range) {
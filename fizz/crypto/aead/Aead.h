@@ -11,11 +11,17 @@
 #include <folly/Optional.h>
 #include <folly/io/IOBuf.h>
 
+#include <vector>
+
 namespace fizz {
 
 struct TrafficKey {
   std::unique_ptr<folly::IOBuf> key;
   std::unique_ptr<folly::IOBuf> iv;
+
+  TrafficKey clone() const {
+    return TrafficKey{key->clone(), iv->clone()};
+  }
 };
 
 /**
@@ -41,6 +47,15 @@ class Aead {
    */
   virtual void setKey(TrafficKey key) = 0;
 
+  /**
+   * Returns a copy of the traffic key this aead was last set with, for
+   * example to hand the connection off to kernel TLS. Returns none if no key
+   * has been set or the implementation does not retain it.
+   */
+  virtual folly::Optional<TrafficKey> getKey() const {
+    return folly::none;
+  }
+
   /**
    * Encrypts plaintext. Will throw on error.
    */
@@ -49,6 +64,18 @@ class Aead {
       const folly::IOBuf* associatedData,
       uint64_t seqNum) const = 0;
 
+  /**
+   * Encrypts plaintext in place, overwriting it with the ciphertext. The
+   * plaintext chain must be exclusively owned by the caller (unshared). The
+   * tag is written into the tailroom of the last buffer in the chain if
+   * there is enough, and appended as a new buffer otherwise. Will throw on
+   * error (including shared input).
+   */
+  virtual std::unique_ptr<folly::IOBuf> inplaceEncrypt(
+      std::unique_ptr<folly::IOBuf>&& plaintext,
+      const folly::IOBuf* associatedData,
+      uint64_t seqNum) const = 0;
+
   /**
    * Set a hint to the AEAD about how much space to try to leave as headroom for
    * ciphertexts returned from encrypt.  Implementations may or may not honor
@@ -88,5 +115,38 @@ class Aead {
    * ciphertext - size of plaintext).
    */
   virtual size_t getCipherOverhead() const = 0;
+
+  /**
+   * One encryption job for encryptBatch(). The associated data pointer
+   * must stay valid until the batch call returns.
+   */
+  struct BatchJob {
+    std::unique_ptr<folly::IOBuf> plaintext;
+    const folly::IOBuf* associatedData;
+    uint64_t seqNum;
+  };
+
+  /**
+   * Encrypts a batch of independent jobs, returning ciphertexts in job
+   * order. The default processes jobs one at a time; multi-buffer
+   * engines (for example ipsec-mb, which runs 4-8 AES-GCM lanes at
+   * once) override this to fill their lanes from the batch. Backends
+   * registering with batchCapable set are expected to override it.
+   */
+  virtual std::vector<std::unique_ptr<folly::IOBuf>> encryptBatch(
+      std::vector<BatchJob>&& jobs) const {
+    std::vector<std::unique_ptr<folly::IOBuf>> ciphertexts;
+    ciphertexts.reserve(jobs.size());
+    for (auto& job : jobs) {
+      if (!job.plaintext->isShared()) {
+        ciphertexts.push_back(inplaceEncrypt(
+            std::move(job.plaintext), job.associatedData, job.seqNum));
+      } else {
+        ciphertexts.push_back(encrypt(
+            std::move(job.plaintext), job.associatedData, job.seqNum));
+      }
+    }
+    return ciphertexts;
+  }
 };
 } // namespace fizz
@@ -26,8 +26,35 @@ std::unique_ptr<folly::IOBuf> evpEncrypt(
     EVP_CIPHER_CTX* encryptCtx);
 } // namespace detail
 
+template <typename EVPImpl>
+std::vector<typename OpenSSLEVPCipher<EVPImpl>::CtxPair>&
+OpenSSLEVPCipher<EVPImpl>::ctxPool() {
+  static thread_local std::vector<CtxPair> pool;
+  return pool;
+}
+
+template <typename EVPImpl>
+OpenSSLEVPCipher<EVPImpl>::~OpenSSLEVPCipher() {
+  // Moved-from ciphers have no contexts to return.
+  if (!encryptCtx_ || !decryptCtx_) {
+    return;
+  }
+  auto& pool = ctxPool();
+  if (pool.size() < kCtxPoolCapacity) {
+    pool.push_back(CtxPair{std::move(encryptCtx_), std::move(decryptCtx_)});
+  }
+}
+
 template <typename EVPImpl>
 OpenSSLEVPCipher<EVPImpl>::OpenSSLEVPCipher() {
+  auto& pool = ctxPool();
+  if (!pool.empty()) {
+    encryptCtx_ = std::move(pool.back().enc);
+    decryptCtx_ = std::move(pool.back().dec);
+    pool.pop_back();
+    return;
+  }
+
   encryptCtx_.reset(EVP_CIPHER_CTX_new());
   if (encryptCtx_ == nullptr) {
     throw std::runtime_error("Unable to allocate an EVP_CIPHER_CTX object");
@@ -91,8 +118,13 @@ void OpenSSLEVPCipher<EVPImpl>::setKey(TrafficKey trafficKey) {
     throw std::runtime_error("Invalid IV");
   }
   trafficKey_ = std::move(trafficKey);
-  // Cache the IV key. calling coalesce() is not free.
-  trafficIvKey_ = trafficKey_.iv->coalesce();
+  // Cache the static IV in the nonce scratch. Only the seqNum tail is
+  // rewritten when constructing per-record nonces.
+  memcpy(nonceScratch_.data(), trafficKey_.iv->data(), EVPImpl::kIVLength);
+  memcpy(
+      &ivTailWord_,
+      trafficKey_.iv->data() + EVPImpl::kIVLength - sizeof(uint64_t),
+      sizeof(uint64_t));
   if (EVP_EncryptInit_ex(
           encryptCtx_.get(),
           nullptr,
@@ -127,6 +159,27 @@ std::unique_ptr<folly::IOBuf> OpenSSLEVPCipher<EVPImpl>::encrypt(
       encryptCtx_.get());
 }
 
+template <typename EVPImpl>
+std::unique_ptr<folly::IOBuf> OpenSSLEVPCipher<EVPImpl>::inplaceEncrypt(
+    std::unique_ptr<folly::IOBuf>&& plaintext,
+    const folly::IOBuf* associatedData,
+    uint64_t seqNum) const {
+  if (plaintext->isShared()) {
+    throw std::runtime_error("inplace encrypt called on shared buffer");
+  }
+  auto iv = createIV(seqNum);
+  // evpEncrypt will encrypt an unshared input in place, writing the tag
+  // into tailroom when available.
+  return detail::evpEncrypt(
+      std::move(plaintext),
+      associatedData,
+      iv,
+      EVPImpl::kTagLength,
+      EVPImpl::kOperatesInBlocks,
+      headroom_,
+      encryptCtx_.get());
+}
+
 template <typename EVPImpl>
 folly::Optional<std::unique_ptr<folly::IOBuf>>
 OpenSSLEVPCipher<EVPImpl>::tryDecrypt(
@@ -152,14 +205,10 @@ size_t OpenSSLEVPCipher<EVPImpl>::getCipherOverhead() const {
 }
 
 template <typename EVPImpl>
-std::array<uint8_t, EVPImpl::kIVLength> OpenSSLEVPCipher<EVPImpl>::createIV(
-    uint64_t seqNum) const {
-  std::array<uint8_t, EVPImpl::kIVLength> iv;
-  uint64_t bigEndianSeqNum = folly::Endian::big(seqNum);
+folly::ByteRange OpenSSLEVPCipher<EVPImpl>::createIV(uint64_t seqNum) const {
   const size_t prefixLength = EVPImpl::kIVLength - sizeof(uint64_t);
-  memset(iv.data(), 0, prefixLength);
-  memcpy(iv.data() + prefixLength, &bigEndianSeqNum, 8);
-  XOR(trafficIvKey_, folly::range(iv));
-  return iv;
+  uint64_t tail = ivTailWord_ ^ folly::Endian::big(seqNum);
+  memcpy(nonceScratch_.data() + prefixLength, &tail, sizeof(uint64_t));
+  return folly::ByteRange(nonceScratch_.data(), EVPImpl::kIVLength);
 }
 } // namespace fizz
@@ -11,6 +11,7 @@
 #include <fizz/crypto/aead/AESGCM128.h>
 #include <fizz/crypto/aead/Aead.h>
 #include <fizz/crypto/aead/IOBufUtil.h>
+#include <fizz/util/ObjectRecycler.h>
 #include <folly/Conv.h>
 #include <folly/Memory.h>
 #include <folly/Range.h>
@@ -36,18 +37,27 @@ namespace fizz {
  *         explicitly
  */
 template <typename EVPImpl>
-class OpenSSLEVPCipher : public Aead {
+class OpenSSLEVPCipher
+    : public Aead,
+      public PerThreadRecycled<OpenSSLEVPCipher<EVPImpl>> {
   static_assert(EVPImpl::kIVLength >= sizeof(uint64_t), "iv too small");
 
  public:
   OpenSSLEVPCipher();
-  ~OpenSSLEVPCipher() override = default;
+  ~OpenSSLEVPCipher() override;
 
   OpenSSLEVPCipher(OpenSSLEVPCipher&& other) = default;
   OpenSSLEVPCipher& operator=(OpenSSLEVPCipher&& other) = default;
 
   void setKey(TrafficKey trafficKey) override;
 
+  folly::Optional<TrafficKey> getKey() const override {
+    if (!trafficKey_.key) {
+      return folly::none;
+    }
+    return trafficKey_.clone();
+  }
+
   size_t keyLength() const override {
     return EVPImpl::kKeyLength;
   }
@@ -65,6 +75,13 @@ class OpenSSLEVPCipher : public Aead {
       const folly::IOBuf* associatedData,
       uint64_t seqNum) const override;
 
+  // Encrypt in place, without allocating a separate ciphertext buffer.
+  // Throws if plaintext is shared.
+  std::unique_ptr<folly::IOBuf> inplaceEncrypt(
+      std::unique_ptr<folly::IOBuf>&& plaintext,
+      const folly::IOBuf* associatedData,
+      uint64_t seqNum) const override;
+
   folly::Optional<std::unique_ptr<folly::IOBuf>> tryDecrypt(
       std::unique_ptr<folly::IOBuf>&& ciphertext,
       const folly::IOBuf* associatedData,
@@ -77,10 +94,25 @@ class OpenSSLEVPCipher : public Aead {
   }
 
  private:
-  std::array<uint8_t, EVPImpl::kIVLength> createIV(uint64_t seqNum) const;
+  folly::ByteRange createIV(uint64_t seqNum) const;
+
+  // Initialized cipher contexts are pooled per thread and cipher so that a
+  // new connection only pays for the key schedule, not full ctx
+  // allocation/init. Contexts are drawn in the constructor and returned on
+  // destruction, up to kCtxPoolCapacity per thread.
+  struct CtxPair {
+    folly::ssl::EvpCipherCtxUniquePtr enc;
+    folly::ssl::EvpCipherCtxUniquePtr dec;
+  };
+  static constexpr size_t kCtxPoolCapacity = 32;
+  static std::vector<CtxPair>& ctxPool();
 
   TrafficKey trafficKey_;
-  folly::ByteRange trafficIvKey_;
+  // Scratch space for the per-record nonce. The static IV is copied in at
+  // setKey() time and only the seqNum tail is rewritten per record, so no
+  // buffer allocation or full-length XOR happens on the record path.
+  mutable std::array<uint8_t, EVPImpl::kIVLength> nonceScratch_;
+  uint64_t ivTailWord_{0};
   size_t headroom_{5};
 
   folly::ssl::EvpCipherCtxUniquePtr encryptCtx_;
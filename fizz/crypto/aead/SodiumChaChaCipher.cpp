@@ -0,0 +1,183 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/crypto/aead/SodiumChaChaCipher.h>
+
+#include <fizz/crypto/aead/IOBufUtil.h>
+#include <folly/lang/Bits.h>
+#include <glog/logging.h>
+#include <sodium.h>
+
+using namespace folly;
+
+namespace fizz {
+
+namespace {
+
+// libsodium operates on contiguous memory. The associated data (the record
+// header) is almost always a single buffer; coalesce a copy when it is not.
+ByteRange adRange(const IOBuf* associatedData, std::unique_ptr<IOBuf>& adCopy) {
+  if (!associatedData) {
+    return ByteRange();
+  }
+  if (!associatedData->isChained()) {
+    return ByteRange(associatedData->data(), associatedData->length());
+  }
+  adCopy = associatedData->clone();
+  return adCopy->coalesce();
+}
+} // namespace
+
+void SodiumChaChaCipher::setKey(TrafficKey trafficKey) {
+  trafficKey.key->coalesce();
+  trafficKey.iv->coalesce();
+  if (trafficKey.key->length() != kKeyLength) {
+    throw std::runtime_error("Invalid key");
+  }
+  if (trafficKey.iv->length() != kIVLength) {
+    throw std::runtime_error("Invalid IV");
+  }
+  trafficKey_ = std::move(trafficKey);
+  memcpy(nonceScratch_.data(), trafficKey_.iv->data(), kIVLength);
+  memcpy(
+      &ivTailWord_,
+      trafficKey_.iv->data() + kIVLength - sizeof(uint64_t),
+      sizeof(uint64_t));
+}
+
+folly::Optional<TrafficKey> SodiumChaChaCipher::getKey() const {
+  if (!trafficKey_.key || !trafficKey_.iv) {
+    return folly::none;
+  }
+  return trafficKey_.clone();
+}
+
+std::unique_ptr<IOBuf> SodiumChaChaCipher::encrypt(
+    std::unique_ptr<IOBuf>&& plaintext,
+    const IOBuf* associatedData,
+    uint64_t seqNum) const {
+  auto iv = createIV(seqNum);
+  std::unique_ptr<IOBuf> adCopy;
+  auto ad = adRange(associatedData, adCopy);
+  auto input = plaintext->coalesce();
+
+  auto output = IOBuf::create(headroom_ + input.size() + kTagLength);
+  output->advance(headroom_);
+  output->append(input.size() + kTagLength);
+
+  unsigned long long outputLen;
+  if (crypto_aead_chacha20poly1305_ietf_encrypt(
+          output->writableData(),
+          &outputLen,
+          input.data(),
+          input.size(),
+          ad.data(),
+          ad.size(),
+          nullptr,
+          iv.data(),
+          trafficKey_.key->data()) != 0) {
+    throw std::runtime_error("Encryption error");
+  }
+  DCHECK_EQ(outputLen, output->length());
+  return output;
+}
+
+std::unique_ptr<IOBuf> SodiumChaChaCipher::inplaceEncrypt(
+    std::unique_ptr<IOBuf>&& plaintext,
+    const IOBuf* associatedData,
+    uint64_t seqNum) const {
+  if (plaintext->isShared()) {
+    throw std::runtime_error("inplace encrypt called on shared buffer");
+  }
+  auto iv = createIV(seqNum);
+  std::unique_ptr<IOBuf> adCopy;
+  auto ad = adRange(associatedData, adCopy);
+  // coalesce() mutates the chain itself, so after this the plaintext is a
+  // single buffer we can encrypt in place with a detached tag.
+  auto input = plaintext->coalesce();
+
+  std::array<uint8_t, kTagLength> tag;
+  unsigned long long tagLen;
+  if (crypto_aead_chacha20poly1305_ietf_encrypt_detached(
+          plaintext->writableData(),
+          tag.data(),
+          &tagLen,
+          input.data(),
+          input.size(),
+          ad.data(),
+          ad.size(),
+          nullptr,
+          iv.data(),
+          trafficKey_.key->data()) != 0) {
+    throw std::runtime_error("Encryption error");
+  }
+  DCHECK_EQ(tagLen, kTagLength);
+
+  if (plaintext->prev()->tailroom() >= kTagLength) {
+    auto lastBuf = plaintext->prev();
+    memcpy(lastBuf->writableTail(), tag.data(), kTagLength);
+    lastBuf->append(kTagLength);
+  } else {
+    auto tagBuf = IOBuf::copyBuffer(tag.data(), kTagLength);
+    plaintext->prependChain(std::move(tagBuf));
+  }
+  return std::move(plaintext);
+}
+
+folly::Optional<std::unique_ptr<IOBuf>> SodiumChaChaCipher::tryDecrypt(
+    std::unique_ptr<IOBuf>&& ciphertext,
+    const IOBuf* associatedData,
+    uint64_t seqNum) const {
+  auto inputLength = ciphertext->computeChainDataLength();
+  if (inputLength < kTagLength) {
+    return folly::none;
+  }
+  auto iv = createIV(seqNum);
+  std::unique_ptr<IOBuf> adCopy;
+  auto ad = adRange(associatedData, adCopy);
+  auto input = ciphertext->coalesce();
+
+  std::unique_ptr<IOBuf> output;
+  uint8_t* out;
+  if (ciphertext->isShared()) {
+    output = IOBuf::create(inputLength - kTagLength);
+    output->append(inputLength - kTagLength);
+    out = output->writableData();
+  } else {
+    // Decrypt in place over the ciphertext.
+    out = ciphertext->writableData();
+  }
+
+  unsigned long long outputLen;
+  if (crypto_aead_chacha20poly1305_ietf_decrypt(
+          out,
+          &outputLen,
+          nullptr,
+          input.data(),
+          input.size(),
+          ad.data(),
+          ad.size(),
+          iv.data(),
+          trafficKey_.key->data()) != 0) {
+    return folly::none;
+  }
+  DCHECK_EQ(outputLen, inputLength - kTagLength);
+  if (!output) {
+    ciphertext->trimEnd(kTagLength);
+    output = std::move(ciphertext);
+  }
+  return output;
+}
+
+folly::ByteRange SodiumChaChaCipher::createIV(uint64_t seqNum) const {
+  const size_t prefixLength = kIVLength - sizeof(uint64_t);
+  uint64_t tail = ivTailWord_ ^ folly::Endian::big(seqNum);
+  memcpy(nonceScratch_.data() + prefixLength, &tail, sizeof(uint64_t));
+  return folly::ByteRange(nonceScratch_.data(), kIVLength);
+}
+} // namespace fizz
@@ -0,0 +1,77 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/crypto/aead/Aead.h>
+#include <fizz/util/ObjectRecycler.h>
+#include <folly/Range.h>
+
+#include <array>
+
+namespace fizz {
+
+/**
+ * Aead implementation of ChaCha20-Poly1305 (IETF variant) backed by
+ * libsodium. Produces output byte-compatible with
+ * OpenSSLEVPCipher<ChaCha20Poly1305> and can be selected per connection via
+ * the factory.
+ */
+class SodiumChaChaCipher
+    : public Aead,
+      public PerThreadRecycled<SodiumChaChaCipher> {
+ public:
+  static constexpr size_t kKeyLength{32};
+  static constexpr size_t kIVLength{12};
+  static constexpr size_t kTagLength{16};
+
+  size_t keyLength() const override {
+    return kKeyLength;
+  }
+
+  size_t ivLength() const override {
+    return kIVLength;
+  }
+
+  void setKey(TrafficKey trafficKey) override;
+
+  folly::Optional<TrafficKey> getKey() const override;
+
+  std::unique_ptr<folly::IOBuf> encrypt(
+      std::unique_ptr<folly::IOBuf>&& plaintext,
+      const folly::IOBuf* associatedData,
+      uint64_t seqNum) const override;
+
+  std::unique_ptr<folly::IOBuf> inplaceEncrypt(
+      std::unique_ptr<folly::IOBuf>&& plaintext,
+      const folly::IOBuf* associatedData,
+      uint64_t seqNum) const override;
+
+  // The returned buffer will have head room == headroom_
+  void setEncryptedBufferHeadroom(size_t headroom) override {
+    headroom_ = headroom;
+  }
+
+  folly::Optional<std::unique_ptr<folly::IOBuf>> tryDecrypt(
+      std::unique_ptr<folly::IOBuf>&& ciphertext,
+      const folly::IOBuf* associatedData,
+      uint64_t seqNum) const override;
+
+  size_t getCipherOverhead() const override {
+    return kTagLength;
+  }
+
+ private:
+  folly::ByteRange createIV(uint64_t seqNum) const;
+
+  TrafficKey trafficKey_;
+  mutable std::array<uint8_t, kIVLength> nonceScratch_;
+  uint64_t ivTailWord_{0};
+  size_t headroom_{5};
+};
+} // namespace fizz
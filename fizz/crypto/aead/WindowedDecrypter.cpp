@@ -0,0 +1,87 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/crypto/aead/WindowedDecrypter.h>
+
+#include <glog/logging.h>
+
+namespace fizz {
+
+ReplayWindow::ReplayWindow(size_t windowSize)
+    : bitmap_((windowSize + 63) / 64, 0), windowSize_(bitmap_.size() * 64) {
+  CHECK_GT(windowSize, 0);
+}
+
+bool ReplayWindow::isSet(uint64_t seqNum) const {
+  auto bit = seqNum % windowSize_;
+  return (bitmap_[bit / 64] >> (bit % 64)) & 1;
+}
+
+void ReplayWindow::set(uint64_t seqNum) {
+  auto bit = seqNum % windowSize_;
+  bitmap_[bit / 64] |= (uint64_t(1) << (bit % 64));
+}
+
+void ReplayWindow::clear(uint64_t seqNum) {
+  auto bit = seqNum % windowSize_;
+  bitmap_[bit / 64] &= ~(uint64_t(1) << (bit % 64));
+}
+
+bool ReplayWindow::wouldAccept(uint64_t seqNum) const {
+  if (!anyReceived_ || seqNum > maxSeqNum_) {
+    return true;
+  }
+  if (maxSeqNum_ - seqNum >= windowSize_) {
+    return false;
+  }
+  return !isSet(seqNum);
+}
+
+void ReplayWindow::markReceived(uint64_t seqNum) {
+  if (!anyReceived_) {
+    anyReceived_ = true;
+    maxSeqNum_ = seqNum;
+    set(seqNum);
+    return;
+  }
+  if (seqNum > maxSeqNum_) {
+    // Advance the window, clearing the positions the ring bitmap now
+    // represents as the new numbers.
+    if (seqNum - maxSeqNum_ >= windowSize_) {
+      std::fill(bitmap_.begin(), bitmap_.end(), 0);
+    } else {
+      for (auto n = maxSeqNum_ + 1; n <= seqNum; ++n) {
+        clear(n);
+      }
+    }
+    maxSeqNum_ = seqNum;
+  }
+  set(seqNum);
+}
+
+WindowedDecrypter::WindowedDecrypter(
+    std::unique_ptr<Aead> aead,
+    size_t windowSize)
+    : aead_(std::move(aead)), window_(windowSize) {}
+
+folly::Optional<std::unique_ptr<folly::IOBuf>> WindowedDecrypter::tryDecrypt(
+    uint64_t seqNum,
+    std::unique_ptr<folly::IOBuf>&& ciphertext,
+    const folly::IOBuf* associatedData) {
+  if (!window_.wouldAccept(seqNum)) {
+    return folly::none;
+  }
+  auto plaintext =
+      aead_->tryDecrypt(std::move(ciphertext), associatedData, seqNum);
+  if (!plaintext) {
+    return folly::none;
+  }
+  window_.markReceived(seqNum);
+  return plaintext;
+}
+} // namespace fizz
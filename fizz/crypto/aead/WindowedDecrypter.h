@@ -0,0 +1,82 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/crypto/aead/Aead.h>
+
+#include <vector>
+
+namespace fizz {
+
+/**
+ * Sliding bitmap anti-replay window over record numbers, in the style of
+ * RFC 4303. Tracks the highest number seen and a bitmap of windowSize
+ * numbers below it; numbers that have been seen, or that have fallen
+ * behind the window, are rejected.
+ */
+class ReplayWindow {
+ public:
+  explicit ReplayWindow(size_t windowSize = 256);
+
+  /**
+   * Whether a record with this number should be processed: it is new and
+   * within the window. Does not modify the window.
+   */
+  bool wouldAccept(uint64_t seqNum) const;
+
+  /**
+   * Marks a number as received, advancing the window if it is the new
+   * highest. Call only after the record has authenticated.
+   */
+  void markReceived(uint64_t seqNum);
+
+ private:
+  bool isSet(uint64_t seqNum) const;
+  void set(uint64_t seqNum);
+  void clear(uint64_t seqNum);
+
+  std::vector<uint64_t> bitmap_;
+  size_t windowSize_;
+  uint64_t maxSeqNum_{0};
+  bool anyReceived_{false};
+};
+
+/**
+ * Decrypts records at arbitrary record numbers with replay protection, for
+ * datagram transports where records arrive reordered. The aead's nonce is
+ * computed from the supplied number on each call (that is how the Aead
+ * interface already works), so out-of-order decryption needs no cipher
+ * reinitialization; this class adds the replay window and only marks a
+ * number as seen once its record has authenticated, so forged packets
+ * cannot poison the window.
+ *
+ * Unlike EncryptedReadRecordLayer there is no TLS record framing here; the
+ * caller supplies the record number and ciphertext from its own packet
+ * format, pairing naturally with the transparent record layer driver mode.
+ */
+class WindowedDecrypter {
+ public:
+  explicit WindowedDecrypter(
+      std::unique_ptr<Aead> aead,
+      size_t windowSize = 256);
+
+  /**
+   * Returns the plaintext, or none if the number is a replay, is behind
+   * the window, or the ciphertext fails to authenticate.
+   */
+  folly::Optional<std::unique_ptr<folly::IOBuf>> tryDecrypt(
+      uint64_t seqNum,
+      std::unique_ptr<folly::IOBuf>&& ciphertext,
+      const folly::IOBuf* associatedData);
+
+ private:
+  std::unique_ptr<Aead> aead_;
+  ReplayWindow window_;
+};
+} // namespace fizz
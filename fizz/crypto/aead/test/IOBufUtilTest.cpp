@@ -37,6 +37,39 @@ TEST(IOBufUtilTest, TrimBytes) {
   EXPECT_TRUE(eq(bufExpected, buf));
 }
 
+TEST(IOBufUtilTest, TrimBytesSingleBuffer) {
+  auto buf = IOBuf::copyBuffer("helloworld");
+
+  constexpr size_t trimLen = 4;
+  std::array<uint8_t, trimLen> trimData;
+  folly::MutableByteRange trim(trimData);
+  trimBytes(*buf, trim);
+
+  auto expected = IOBuf::copyBuffer("orld");
+  auto bufExpected = IOBuf::copyBuffer("hellow");
+  IOBufEqualTo eq;
+  EXPECT_EQ(expected->coalesce(), trim.castToConst());
+  EXPECT_TRUE(eq(bufExpected, buf));
+}
+
+TEST(IOBufUtilTest, XorRange) {
+  // Cover lengths around the vector and word strides.
+  for (size_t len = 0; len <= 40; ++len) {
+    std::vector<uint8_t> first(len);
+    std::vector<uint8_t> second(len);
+    std::vector<uint8_t> expected(len);
+    for (size_t i = 0; i < len; ++i) {
+      first[i] = static_cast<uint8_t>(i * 7 + 1);
+      second[i] = static_cast<uint8_t>(0xa5 - i * 3);
+      expected[i] = first[i] ^ second[i];
+    }
+    XOR(
+        folly::range(first),
+        folly::MutableByteRange(second.data(), second.size()));
+    EXPECT_EQ(expected, second) << "length " << len;
+  }
+}
+
 TEST(IOBufUtilTest, TransformBufferInplace) {
   auto buf = IOBuf::copyBuffer("hello");
   buf->prependChain(IOBuf::copyBuffer("world"));
@@ -42,6 +42,19 @@ class MockAead : public Aead {
     return _encrypt(plaintext, associatedData, seqNum);
   }
 
+  MOCK_CONST_METHOD3(
+      _inplaceEncrypt,
+      std::unique_ptr<folly::IOBuf>(
+          std::unique_ptr<folly::IOBuf>& plaintext,
+          const folly::IOBuf* associatedData,
+          uint64_t seqNum));
+  std::unique_ptr<folly::IOBuf> inplaceEncrypt(
+      std::unique_ptr<folly::IOBuf>&& plaintext,
+      const folly::IOBuf* associatedData,
+      uint64_t seqNum) const override {
+    return _inplaceEncrypt(plaintext, associatedData, seqNum);
+  }
+
   MOCK_CONST_METHOD3(
       _decrypt,
       std::unique_ptr<folly::IOBuf>(
@@ -72,6 +85,9 @@ class MockAead : public Aead {
     ON_CALL(*this, _encrypt(_, _, _)).WillByDefault(InvokeWithoutArgs([]() {
       return folly::IOBuf::copyBuffer("ciphertext");
     }));
+    ON_CALL(*this, _inplaceEncrypt(_, _, _))
+        .WillByDefault(InvokeWithoutArgs(
+            []() { return folly::IOBuf::copyBuffer("ciphertext"); }));
     ON_CALL(*this, _decrypt(_, _, _)).WillByDefault(InvokeWithoutArgs([]() {
       return folly::IOBuf::copyBuffer("plaintext");
     }));
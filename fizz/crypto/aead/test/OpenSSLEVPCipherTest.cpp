@@ -139,6 +139,17 @@ TEST_P(OpenSSLEVPCipherTest, TestEncryptWithTagRoom) {
   EXPECT_FALSE(out->isChained());
 }
 
+TEST_P(OpenSSLEVPCipherTest, TestEncryptPooledCtx) {
+  // Destroying a cipher returns its contexts to the thread local pool; a
+  // new cipher picks them up and must behave identically.
+  auto cipher = getCipher(GetParam());
+  callEncrypt(cipher, GetParam());
+  cipher.reset();
+  cipher = getCipher(GetParam());
+  callEncrypt(cipher, GetParam());
+  callDecrypt(cipher, GetParam());
+}
+
 TEST_P(OpenSSLEVPCipherTest, TestEncryptReusedCipher) {
   auto cipher = getCipher(GetParam());
   auto params = GetParam();
@@ -208,6 +219,29 @@ TEST_P(OpenSSLEVPCipherTest, TestEncryptChunkedSharedInput) {
   EXPECT_FALSE(out->isChained());
 }
 
+TEST_P(OpenSSLEVPCipherTest, TestInplaceEncrypt) {
+  auto cipher = getCipher(GetParam());
+  auto input = toIOBuf(GetParam().plaintext, 0, cipher->getCipherOverhead());
+  std::unique_ptr<IOBuf> aad;
+  if (!GetParam().aad.empty()) {
+    aad = toIOBuf(GetParam().aad);
+  }
+  auto out =
+      cipher->inplaceEncrypt(std::move(input), aad.get(), GetParam().seqNum);
+  EXPECT_FALSE(out->isChained());
+  bool valid = IOBufEqualTo()(toIOBuf(GetParam().ciphertext), out);
+  EXPECT_EQ(valid, GetParam().valid);
+}
+
+TEST_P(OpenSSLEVPCipherTest, TestInplaceEncryptSharedThrows) {
+  auto cipher = getCipher(GetParam());
+  auto input = toIOBuf(GetParam().plaintext);
+  auto shared = input->clone();
+  EXPECT_THROW(
+      cipher->inplaceEncrypt(std::move(shared), nullptr, GetParam().seqNum),
+      std::runtime_error);
+}
+
 TEST_P(OpenSSLEVPCipherTest, TestEncryptChunkedAad) {
   auto cipher = getCipher(GetParam());
   auto aad = toIOBuf(GetParam().aad);
@@ -0,0 +1,108 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GTest.h>
+
+#include <fizz/crypto/aead/ChaCha20Poly1305.h>
+#include <fizz/crypto/aead/OpenSSLEVPCipher.h>
+#include <fizz/crypto/aead/SodiumChaChaCipher.h>
+#include <fizz/crypto/aead/test/TestUtil.h>
+#include <folly/String.h>
+
+using namespace folly;
+
+namespace fizz {
+namespace test {
+
+constexpr StringPiece kKey =
+    "808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f";
+constexpr StringPiece kIV = "070000004041424344454647";
+constexpr StringPiece kPlaintext =
+    "4c616469657320616e642047656e746c656d656e206f662074686520636c617373206f6620"
+    "2739393a204966204920636f756c64206f6666657220796f75206f6e6c79206f6e65207469"
+    "7020666f7220746865206675747572652c2073756e73637265656e20776f756c6420626520"
+    "69742e";
+constexpr StringPiece kCiphertext =
+    "d31a8d34648e60db7b86afbc53ef7ec2a4aded51296e08fea9e2b5a736ee62d63dbea45e8c"
+    "a9671282fafb69da92728b1a71de0a9e060b2905d6a5b67ecd3b3692ddbd7f2d778b8c9803"
+    "aee328091b58fab324e4fad675945585808b4831d7bc3ff4def08e4b7a9de576d26586cec6"
+    "4b61166a23a4681fd59456aea1d29f82477216";
+
+std::unique_ptr<Aead> getSodiumCipher() {
+  auto cipher = std::make_unique<SodiumChaChaCipher>();
+  TrafficKey trafficKey;
+  trafficKey.key = toIOBuf(kKey.str());
+  trafficKey.iv = toIOBuf(kIV.str());
+  cipher->setKey(std::move(trafficKey));
+  return cipher;
+}
+
+TEST(SodiumChaChaCipherTest, TestEncrypt) {
+  auto cipher = getSodiumCipher();
+  auto out = cipher->encrypt(toIOBuf(kPlaintext.str()), nullptr, 0);
+  EXPECT_TRUE(IOBufEqualTo()(toIOBuf(kCiphertext.str()), out));
+}
+
+TEST(SodiumChaChaCipherTest, TestDecrypt) {
+  auto cipher = getSodiumCipher();
+  auto out = cipher->decrypt(toIOBuf(kCiphertext.str()), nullptr, 0);
+  EXPECT_TRUE(IOBufEqualTo()(toIOBuf(kPlaintext.str()), out));
+}
+
+TEST(SodiumChaChaCipherTest, TestDecryptFailure) {
+  auto cipher = getSodiumCipher();
+  auto tampered = toIOBuf(kCiphertext.str());
+  tampered->writableData()[0] ^= 0x01;
+  EXPECT_FALSE(cipher->tryDecrypt(std::move(tampered), nullptr, 0).hasValue());
+}
+
+TEST(SodiumChaChaCipherTest, TestInplaceEncrypt) {
+  auto cipher = getSodiumCipher();
+  auto plaintext =
+      toIOBuf(kPlaintext.str(), 0, SodiumChaChaCipher::kTagLength);
+  auto out = cipher->inplaceEncrypt(std::move(plaintext), nullptr, 0);
+  EXPECT_FALSE(out->isChained());
+  EXPECT_TRUE(IOBufEqualTo()(toIOBuf(kCiphertext.str()), out));
+}
+
+TEST(SodiumChaChaCipherTest, TestInplaceEncryptSharedThrows) {
+  auto cipher = getSodiumCipher();
+  auto plaintext = toIOBuf(kPlaintext.str());
+  auto shared = plaintext->clone();
+  EXPECT_THROW(
+      cipher->inplaceEncrypt(std::move(shared), nullptr, 0),
+      std::runtime_error);
+}
+
+#if FOLLY_OPENSSL_HAS_CHACHA
+TEST(SodiumChaChaCipherTest, TestOpenSSLInterop) {
+  auto sodiumCipher = getSodiumCipher();
+  auto opensslCipher = std::make_unique<OpenSSLEVPCipher<ChaCha20Poly1305>>();
+  TrafficKey trafficKey;
+  trafficKey.key = toIOBuf(kKey.str());
+  trafficKey.iv = toIOBuf(kIV.str());
+  opensslCipher->setKey(std::move(trafficKey));
+
+  auto aad = IOBuf::copyBuffer("record header");
+  for (uint64_t seqNum : {uint64_t(0), uint64_t(1), uint64_t(1) << 40}) {
+    auto fromSodium = sodiumCipher->encrypt(
+        IOBuf::copyBuffer("interop test"), aad.get(), seqNum);
+    auto plaintext =
+        opensslCipher->decrypt(std::move(fromSodium), aad.get(), seqNum);
+    EXPECT_TRUE(IOBufEqualTo()(IOBuf::copyBuffer("interop test"), plaintext));
+
+    auto fromOpenSSL = opensslCipher->encrypt(
+        IOBuf::copyBuffer("interop test"), aad.get(), seqNum);
+    plaintext =
+        sodiumCipher->decrypt(std::move(fromOpenSSL), aad.get(), seqNum);
+    EXPECT_TRUE(IOBufEqualTo()(IOBuf::copyBuffer("interop test"), plaintext));
+  }
+}
+#endif
+} // namespace test
+} // namespace fizz
@@ -0,0 +1,98 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GTest.h>
+
+#include <fizz/crypto/Utils.h>
+#include <fizz/crypto/aead/AESGCM128.h>
+#include <fizz/crypto/aead/OpenSSLEVPCipher.h>
+#include <fizz/crypto/aead/WindowedDecrypter.h>
+
+using namespace folly;
+
+namespace fizz {
+namespace test {
+
+class WindowedDecrypterTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    CryptoUtils::init();
+    encryptor_ = makeAead();
+  }
+
+  static std::unique_ptr<Aead> makeAead() {
+    auto aead = std::make_unique<OpenSSLEVPCipher<AESGCM128>>();
+    TrafficKey key;
+    key.key = IOBuf::copyBuffer("0123456789abcdef");
+    key.iv = IOBuf::copyBuffer("0123456789ab");
+    aead->setKey(std::move(key));
+    return aead;
+  }
+
+  Buf encryptAt(uint64_t seqNum) {
+    return encryptor_->encrypt(
+        IOBuf::copyBuffer("plaintext"), nullptr, seqNum);
+  }
+
+  std::unique_ptr<Aead> encryptor_;
+};
+
+TEST_F(WindowedDecrypterTest, TestOutOfOrder) {
+  WindowedDecrypter decrypter{makeAead()};
+  for (auto seqNum : {2, 0, 4, 1, 3}) {
+    auto plaintext =
+        decrypter.tryDecrypt(seqNum, encryptAt(seqNum), nullptr);
+    ASSERT_TRUE(plaintext.hasValue());
+    EXPECT_TRUE(
+        IOBufEqualTo()(*plaintext, IOBuf::copyBuffer("plaintext")));
+  }
+}
+
+TEST_F(WindowedDecrypterTest, TestReplayRejected) {
+  WindowedDecrypter decrypter{makeAead()};
+  EXPECT_TRUE(decrypter.tryDecrypt(1, encryptAt(1), nullptr).hasValue());
+  EXPECT_FALSE(decrypter.tryDecrypt(1, encryptAt(1), nullptr).hasValue());
+}
+
+TEST_F(WindowedDecrypterTest, TestBehindWindowRejected) {
+  WindowedDecrypter decrypter{makeAead(), 64};
+  EXPECT_TRUE(
+      decrypter.tryDecrypt(1000, encryptAt(1000), nullptr).hasValue());
+  EXPECT_FALSE(decrypter.tryDecrypt(0, encryptAt(0), nullptr).hasValue());
+  // Numbers still inside the window are fine.
+  EXPECT_TRUE(
+      decrypter.tryDecrypt(990, encryptAt(990), nullptr).hasValue());
+}
+
+TEST_F(WindowedDecrypterTest, TestForgeryDoesNotPoisonWindow) {
+  WindowedDecrypter decrypter{makeAead()};
+  auto garbage = IOBuf::create(32);
+  garbage->append(32);
+  memset(garbage->writableData(), 7, garbage->length());
+  EXPECT_FALSE(decrypter.tryDecrypt(5, std::move(garbage), nullptr));
+  // The genuine record at the same number still decrypts.
+  EXPECT_TRUE(decrypter.tryDecrypt(5, encryptAt(5), nullptr).hasValue());
+}
+
+TEST(ReplayWindowTest, TestWindowSemantics) {
+  ReplayWindow window{64};
+  EXPECT_TRUE(window.wouldAccept(0));
+  window.markReceived(10);
+  EXPECT_FALSE(window.wouldAccept(10));
+  EXPECT_TRUE(window.wouldAccept(9));
+  EXPECT_TRUE(window.wouldAccept(11));
+  window.markReceived(100);
+  // 100 - 64 = 36 and below have fallen behind the window.
+  EXPECT_FALSE(window.wouldAccept(36));
+  EXPECT_TRUE(window.wouldAccept(37));
+  EXPECT_FALSE(window.wouldAccept(100));
+  EXPECT_TRUE(window.wouldAccept(101));
+}
+
+} // namespace test
+} // namespace fizz
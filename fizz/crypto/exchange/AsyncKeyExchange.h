@@ -0,0 +1,29 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/crypto/exchange/KeyExchange.h>
+#include <folly/futures/Future.h>
+
+namespace fizz {
+
+/**
+ * KeyExchange with an asynchronous shared secret computation. This is useful
+ * for offloading DH math to a CPU thread pool rather than blocking the IO
+ * thread during the handshake.
+ *
+ * The key share is only guaranteed to live until generateSharedSecretFuture
+ * returns; implementations must copy anything they need before deferring.
+ */
+class AsyncKeyExchange : public KeyExchange {
+ public:
+  virtual folly::Future<std::unique_ptr<folly::IOBuf>>
+  generateSharedSecretFuture(folly::ByteRange keyShare) const = 0;
+};
+} // namespace fizz
@@ -0,0 +1,109 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/crypto/exchange/KeyExchangePool.h>
+
+namespace fizz {
+
+namespace {
+
+/**
+ * Protocol code calls generateKeyPair() on every KeyExchange a factory hands
+ * out. Pooled objects already hold a key pair, so the first call is absorbed
+ * here; any later call (re-randomization) regenerates as usual.
+ */
+class PregeneratedKeyExchange : public KeyExchange {
+ public:
+  explicit PregeneratedKeyExchange(std::unique_ptr<KeyExchange> kex)
+      : kex_(std::move(kex)) {}
+
+  void generateKeyPair() override {
+    if (firstGenerate_) {
+      firstGenerate_ = false;
+      return;
+    }
+    kex_->generateKeyPair();
+  }
+
+  std::unique_ptr<folly::IOBuf> getKeyShare() const override {
+    return kex_->getKeyShare();
+  }
+
+  std::unique_ptr<folly::IOBuf> generateSharedSecret(
+      folly::ByteRange keyShare) const override {
+    return kex_->generateSharedSecret(keyShare);
+  }
+
+ private:
+  std::unique_ptr<KeyExchange> kex_;
+  bool firstGenerate_{true};
+};
+} // namespace
+
+constexpr size_t KeyExchangePool::kLocalBatch;
+
+KeyExchangePool::KeyExchangePool(
+    Generator generator,
+    folly::Executor* executor,
+    size_t capacityPerGroup)
+    : generator_(std::move(generator)),
+      executor_(executor),
+      capacity_(capacityPerGroup) {}
+
+void KeyExchangePool::addGroup(NamedGroup group) {
+  auto& pool = pools_[group];
+  if (!pool) {
+    pool = std::make_unique<GroupPool>();
+    std::lock_guard<std::mutex> guard(pool->lock);
+    maybeScheduleRefill(*pool, group);
+  }
+}
+
+std::unique_ptr<KeyExchange> KeyExchangePool::getKeyExchange(NamedGroup group) {
+  auto poolIt = pools_.find(group);
+  if (poolIt == pools_.end()) {
+    return nullptr;
+  }
+  auto& local = (*localCache_)[group];
+  if (local.empty()) {
+    auto& pool = *poolIt->second;
+    std::lock_guard<std::mutex> guard(pool.lock);
+    auto take = std::min(kLocalBatch, pool.ready.size());
+    for (size_t i = 0; i < take; i++) {
+      local.push_back(std::move(pool.ready.back()));
+      pool.ready.pop_back();
+    }
+    maybeScheduleRefill(pool, group);
+  }
+  if (local.empty()) {
+    return nullptr;
+  }
+  auto kex = std::move(local.back());
+  local.pop_back();
+  return std::make_unique<PregeneratedKeyExchange>(std::move(kex));
+}
+
+void KeyExchangePool::maybeScheduleRefill(GroupPool& pool, NamedGroup group) {
+  if (pool.refillScheduled || pool.ready.size() >= capacity_) {
+    return;
+  }
+  pool.refillScheduled = true;
+  executor_->add([self = shared_from_this(), &pool, group]() {
+    while (true) {
+      auto kex = self->generator_(group);
+      kex->generateKeyPair();
+      std::lock_guard<std::mutex> guard(pool.lock);
+      pool.ready.push_back(std::move(kex));
+      if (pool.ready.size() >= self->capacity_) {
+        pool.refillScheduled = false;
+        return;
+      }
+    }
+  });
+}
+} // namespace fizz
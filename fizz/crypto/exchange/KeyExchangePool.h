@@ -0,0 +1,77 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/crypto/exchange/KeyExchange.h>
+#include <fizz/record/Types.h>
+#include <folly/Executor.h>
+#include <folly/Function.h>
+#include <folly/ThreadLocal.h>
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace fizz {
+
+/**
+ * Pool of KeyExchange objects that already have an ephemeral key pair
+ * generated, refilled off the handshake path on a background executor.
+ *
+ * Each thread keeps a small local cache and takes a batch from the shared
+ * per-group pool when it runs dry, so a handshake normally gets a
+ * pregenerated key pair with at most one brief lock acquisition. When the
+ * pool is empty the caller falls back to synchronous generation.
+ *
+ * Groups to pregenerate for must be added before the pool is handed to a
+ * factory; addGroup() is not safe to call concurrently with getKeyExchange().
+ * The pool must be owned by a shared_ptr as refill tasks keep it alive.
+ */
+class KeyExchangePool : public std::enable_shared_from_this<KeyExchangePool> {
+ public:
+  using Generator =
+      folly::Function<std::unique_ptr<KeyExchange>(NamedGroup) const>;
+
+  KeyExchangePool(
+      Generator generator,
+      folly::Executor* executor,
+      size_t capacityPerGroup = 32);
+
+  /**
+   * Starts pregenerating key pairs for group.
+   */
+  void addGroup(NamedGroup group);
+
+  /**
+   * Returns a KeyExchange with generateKeyPair() already called, or nullptr
+   * if group was not added or the pool has been drained.
+   */
+  std::unique_ptr<KeyExchange> getKeyExchange(NamedGroup group);
+
+ private:
+  struct GroupPool {
+    std::mutex lock;
+    std::vector<std::unique_ptr<KeyExchange>> ready;
+    bool refillScheduled{false};
+  };
+
+  // Must be called with pool.lock held.
+  void maybeScheduleRefill(GroupPool& pool, NamedGroup group);
+
+  static constexpr size_t kLocalBatch = 4;
+
+  Generator generator_;
+  folly::Executor* executor_;
+  size_t capacity_;
+  std::map<NamedGroup, std::unique_ptr<GroupPool>> pools_;
+  folly::ThreadLocal<
+      std::map<NamedGroup, std::vector<std::unique_ptr<KeyExchange>>>>
+      localCache_;
+};
+} // namespace fizz
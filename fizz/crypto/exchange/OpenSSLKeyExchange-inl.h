@@ -33,6 +33,14 @@ class OpenSSLECKeyExchange {
     return generateEvpSharedSecret(key_, peerKey);
   }
 
+  std::unique_ptr<folly::IOBuf> generateSharedSecret(
+      folly::ByteRange keyShare) const {
+    if (!key_) {
+      throw std::runtime_error("Key not generated");
+    }
+    return generateECSharedSecret(key_, keyShare, T::curveNid);
+  }
+
  private:
   folly::ssl::EvpPkeyUniquePtr key_;
 };
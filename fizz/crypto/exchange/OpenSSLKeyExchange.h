@@ -40,8 +40,9 @@ class OpenSSLKeyExchange : public KeyExchange {
 
   std::unique_ptr<folly::IOBuf> generateSharedSecret(
       folly::ByteRange keyShare) const override {
-    auto key = detail::OpenSSLECKeyDecoder<T>::decode(keyShare);
-    return keyExchange_.generateSharedSecret(key);
+    // Derive directly from the encoded point, skipping the intermediate
+    // EVP_PKEY round trip for the peer share.
+    return keyExchange_.generateSharedSecret(keyShare);
   }
 
  private:
@@ -130,6 +130,28 @@ TYPED_TEST(Key, ReadFromKey) {
   EXPECT_TRUE(shared);
 }
 
+TYPED_TEST(Key, SharedSecretFromEncodedShare) {
+  typename TestFixture::KeyExch kex;
+  kex.generateKeyPair();
+  auto encodedShare = detail::OpenSSLECKeyEncoder::encode(kex.getKey());
+
+  typename TestFixture::KeyExch kex2;
+  kex2.generateKeyPair();
+
+  // The direct point-based path must derive the same secret as the
+  // EVP_PKEY path.
+  auto direct = kex2.generateSharedSecret(encodedShare->coalesce());
+  auto viaEvp = kex2.generateSharedSecret(kex.getKey());
+  EXPECT_TRUE(folly::IOBufEqualTo()(direct, viaEvp));
+}
+
+TYPED_TEST(Key, SharedSecretFromInvalidShare) {
+  typename TestFixture::KeyExch kex;
+  kex.generateKeyPair();
+  std::string out = unhexlify(this->getKeyParams().invalidEncodedShare);
+  EXPECT_THROW(kex.generateSharedSecret(range(out)), std::runtime_error);
+}
+
 TYPED_TEST(Key, ReadWrongGroup) {
   auto pkey = getPrivateKey(this->getKeyParams().invalidPrivateKey);
   typename TestFixture::KeyExch kex;
@@ -0,0 +1,89 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GMock.h>
+#include <folly/portability/GTest.h>
+
+#include <fizz/crypto/exchange/KeyExchangePool.h>
+#include <fizz/crypto/exchange/test/Mocks.h>
+#include <folly/executors/ManualExecutor.h>
+
+using namespace folly;
+
+namespace fizz {
+namespace test {
+
+class KeyExchangePoolTest : public Test {
+ public:
+  void SetUp() override {
+    pool_ = std::make_shared<KeyExchangePool>(
+        [this](NamedGroup group) { return makeKex(group); },
+        &executor_,
+        kCapacity);
+  }
+
+ protected:
+  static constexpr size_t kCapacity = 8;
+
+  std::unique_ptr<KeyExchange> makeKex(NamedGroup group) {
+    EXPECT_EQ(group, NamedGroup::x25519);
+    generated_++;
+    auto kex = std::make_unique<MockKeyExchange>();
+    kex->setDefaults();
+    EXPECT_CALL(*kex, generateKeyPair());
+    return kex;
+  }
+
+  static std::string contents(std::unique_ptr<IOBuf> buf) {
+    return buf->moveToFbString().toStdString();
+  }
+
+  ManualExecutor executor_;
+  std::shared_ptr<KeyExchangePool> pool_;
+  size_t generated_{0};
+};
+
+TEST_F(KeyExchangePoolTest, TestUnknownGroup) {
+  pool_->addGroup(NamedGroup::x25519);
+  executor_.drain();
+  EXPECT_EQ(pool_->getKeyExchange(NamedGroup::secp256r1), nullptr);
+}
+
+TEST_F(KeyExchangePoolTest, TestEmptyBeforeRefill) {
+  pool_->addGroup(NamedGroup::x25519);
+  EXPECT_EQ(pool_->getKeyExchange(NamedGroup::x25519), nullptr);
+}
+
+TEST_F(KeyExchangePoolTest, TestPregenerated) {
+  pool_->addGroup(NamedGroup::x25519);
+  executor_.drain();
+  EXPECT_EQ(generated_, kCapacity);
+
+  auto kex = pool_->getKeyExchange(NamedGroup::x25519);
+  ASSERT_NE(kex, nullptr);
+  // The first generateKeyPair() must not regenerate the pooled key pair.
+  kex->generateKeyPair();
+  EXPECT_EQ(contents(kex->getKeyShare()), "keyshare");
+  EXPECT_EQ(
+      contents(kex->generateSharedSecret(folly::range(StringPiece("share")))),
+      "sharedsecret");
+}
+
+TEST_F(KeyExchangePoolTest, TestRefillAfterDrain) {
+  pool_->addGroup(NamedGroup::x25519);
+  executor_.drain();
+  for (size_t i = 0; i < kCapacity; i++) {
+    EXPECT_NE(pool_->getKeyExchange(NamedGroup::x25519), nullptr);
+  }
+  EXPECT_EQ(pool_->getKeyExchange(NamedGroup::x25519), nullptr);
+  executor_.drain();
+  EXPECT_EQ(generated_, 2 * kCapacity);
+  EXPECT_NE(pool_->getKeyExchange(NamedGroup::x25519), nullptr);
+}
+} // namespace test
+} // namespace fizz
@@ -8,11 +8,51 @@
 
 #include <fizz/crypto/openssl/OpenSSLKeyUtils.h>
 
+#include <openssl/ecdh.h>
 #include <openssl/err.h>
 
+#include <memory>
+
 namespace fizz {
 namespace detail {
 
+BN_CTX* getPerThreadBnCtx() {
+  static thread_local std::unique_ptr<BN_CTX, decltype(&BN_CTX_free)> bnCtx(
+      BN_CTX_new(), BN_CTX_free);
+  if (!bnCtx) {
+    throw std::runtime_error("Error allocating BN_CTX");
+  }
+  return bnCtx.get();
+}
+
+const EC_GROUP* getPrecomputedECGroup(int curveNid) {
+  auto make = [](int nid) -> const EC_GROUP* {
+    folly::ssl::EcGroupUniquePtr group(EC_GROUP_new_by_curve_name(nid));
+    if (group) {
+      // On failure generator multiplies just take the non-precomputed
+      // path.
+      EC_GROUP_precompute_mult(group.get(), getPerThreadBnCtx());
+    }
+    return group.release();
+  };
+  switch (curveNid) {
+    case NID_X9_62_prime256v1: {
+      static const EC_GROUP* group = make(NID_X9_62_prime256v1);
+      return group;
+    }
+    case NID_secp384r1: {
+      static const EC_GROUP* group = make(NID_secp384r1);
+      return group;
+    }
+    case NID_secp521r1: {
+      static const EC_GROUP* group = make(NID_secp521r1);
+      return group;
+    }
+    default:
+      return nullptr;
+  }
+}
+
 void validateECKey(const folly::ssl::EvpPkeyUniquePtr& key, int curveNid) {
   folly::ssl::EcKeyUniquePtr ecKey(EVP_PKEY_get1_EC_KEY(key.get()));
   if (!ecKey) {
@@ -55,29 +95,65 @@ std::unique_ptr<folly::IOBuf> generateEvpSharedSecret(
   return buf;
 }
 
+std::unique_ptr<folly::IOBuf> generateECSharedSecret(
+    const folly::ssl::EvpPkeyUniquePtr& key,
+    folly::ByteRange peerKeyShare,
+    int curveNid) {
+  auto ecKey = EVP_PKEY_get0_EC_KEY(key.get());
+  if (!ecKey) {
+    throw std::runtime_error("Wrong key type");
+  }
+  auto curve = getPrecomputedECGroup(curveNid);
+  if (!curve) {
+    throw std::runtime_error("Error initializing peer key");
+  }
+  folly::ssl::EcPointUniquePtr point(EC_POINT_new(curve));
+  if (!point) {
+    throw std::runtime_error("Error initializing point");
+  }
+  if (EC_POINT_oct2point(
+          curve,
+          point.get(),
+          peerKeyShare.data(),
+          peerKeyShare.size(),
+          getPerThreadBnCtx()) != 1) {
+    throw std::runtime_error("Error decoding peer key");
+  }
+  if (EC_POINT_is_on_curve(curve, point.get(), getPerThreadBnCtx()) != 1) {
+    throw std::runtime_error("Peer key is not on curve");
+  }
+  size_t secretLen = (EC_GROUP_get_degree(curve) + 7) / 8;
+  auto buf = folly::IOBuf::create(secretLen);
+  if (ECDH_compute_key(
+          buf->writableData(), secretLen, point.get(), ecKey, nullptr) !=
+      static_cast<int>(secretLen)) {
+    throw std::runtime_error("Error deriving key");
+  }
+  buf->append(secretLen);
+  return buf;
+}
+
 folly::ssl::EvpPkeyUniquePtr generateECKeyPair(int curveNid) {
-  folly::ssl::EcKeyUniquePtr ecParamKey(EC_KEY_new_by_curve_name(curveNid));
-  folly::ssl::EvpPkeyUniquePtr params(EVP_PKEY_new());
-  if (!ecParamKey || !params) {
+  folly::ssl::EcKeyUniquePtr ecKey(EC_KEY_new());
+  if (!ecKey) {
     throw std::runtime_error("Error initializing params");
   }
-  if (EVP_PKEY_set1_EC_KEY(params.get(), ecParamKey.get()) != 1) {
+  // Setting the group from the shared precomputed group copies the
+  // generator table reference, so keygen uses the fast fixed-point path.
+  auto group = getPrecomputedECGroup(curveNid);
+  if (!group || EC_KEY_set_group(ecKey.get(), group) != 1) {
     throw std::runtime_error("Error setting ec key for params");
   }
-  folly::ssl::EvpPkeyCtxUniquePtr kctx(EVP_PKEY_CTX_new(params.get(), nullptr));
-  if (!kctx) {
-    throw std::runtime_error("Error creating kctx");
-  }
-  if (EVP_PKEY_keygen_init(kctx.get()) != 1) {
-    throw std::runtime_error("Error initializing ctx");
-  }
-  EVP_PKEY* pkey = nullptr;
-  if (EVP_PKEY_keygen(kctx.get(), &pkey) != 1) {
+  if (EC_KEY_generate_key(ecKey.get()) != 1) {
     throw std::runtime_error("Error generating key");
   }
-  folly::ssl::EvpPkeyUniquePtr evpKey(pkey);
-  folly::ssl::EcKeyUniquePtr ecKey(EVP_PKEY_get1_EC_KEY(evpKey.get()));
-  validateECKey(evpKey, curveNid);
+  folly::ssl::EvpPkeyUniquePtr evpKey(EVP_PKEY_new());
+  if (!evpKey ||
+      EVP_PKEY_assign_EC_KEY(evpKey.get(), ecKey.release()) != 1) {
+    throw std::runtime_error("Error assigning EC key");
+  }
+  // A freshly generated key is valid by construction, so we skip the
+  // expensive EC_KEY_check_key here.
   return evpKey;
 }
 
@@ -85,20 +161,24 @@ folly::ssl::EvpPkeyUniquePtr decodeECPublicKey(
     folly::ByteRange range,
     int curveNid) {
   // Get the peer key.
-  folly::ssl::EcGroupUniquePtr curve(EC_GROUP_new_by_curve_name(curveNid));
+  auto curve = getPrecomputedECGroup(curveNid);
   folly::ssl::EcKeyUniquePtr peerKey(EC_KEY_new_by_curve_name(curveNid));
   if (!curve || !peerKey) {
     throw std::runtime_error("Error initializing peer key");
   }
-  folly::ssl::EcPointUniquePtr point(EC_POINT_new(curve.get()));
+  folly::ssl::EcPointUniquePtr point(EC_POINT_new(curve));
   if (!point) {
     throw std::runtime_error("Error initializing point");
   }
   if (EC_POINT_oct2point(
-          curve.get(), point.get(), range.data(), range.size(), nullptr) != 1) {
+          curve,
+          point.get(),
+          range.data(),
+          range.size(),
+          getPerThreadBnCtx()) != 1) {
     throw std::runtime_error("Error decoding peer key");
   }
-  if (EC_POINT_is_on_curve(curve.get(), point.get(), nullptr) != 1) {
+  if (EC_POINT_is_on_curve(curve, point.get(), getPerThreadBnCtx()) != 1) {
     throw std::runtime_error("Peer key is not on curve");
   }
   if (!EC_KEY_set_public_key(peerKey.get(), point.get())) {
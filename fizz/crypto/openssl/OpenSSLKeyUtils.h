@@ -12,9 +12,24 @@
 #include <folly/io/IOBuf.h>
 #include <folly/ssl/OpenSSLPtrTypes.h>
 
+#include <openssl/ec.h>
+
 namespace fizz {
 namespace detail {
 
+/**
+ * Returns a process-lifetime EC_GROUP for the curve with the generator
+ * multiplication table precomputed, or nullptr for unknown curves. Only
+ * read-only operations may be performed on the returned group.
+ */
+const EC_GROUP* getPrecomputedECGroup(int curveNid);
+
+/**
+ * Returns a reusable per-thread BN_CTX for EC operations, avoiding a
+ * BN_CTX allocation per call.
+ */
+BN_CTX* getPerThreadBnCtx();
+
 /**
  * Validates whether or not the EVP_PKEY belongs to the
  * curve. If not, this throws an exception.
@@ -53,6 +68,16 @@ std::unique_ptr<folly::IOBuf> generateEvpSharedSecret(
     const folly::ssl::EvpPkeyUniquePtr& key,
     const folly::ssl::EvpPkeyUniquePtr& peerKey);
 
+/**
+ * Performs ECDH between key's private key and an encoded peer public
+ * point, going straight from the encoded point to the shared secret
+ * without constructing an intermediate EVP_PKEY for the peer.
+ */
+std::unique_ptr<folly::IOBuf> generateECSharedSecret(
+    const folly::ssl::EvpPkeyUniquePtr& key,
+    folly::ByteRange peerKeyShare,
+    int curveNid);
+
 /**
  * Returns the current error in the thread queue as a string.
  */
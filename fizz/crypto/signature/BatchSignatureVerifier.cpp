@@ -0,0 +1,72 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/crypto/signature/BatchSignatureVerifier.h>
+
+namespace fizz {
+
+BatchSignatureVerifier::BatchSignatureVerifier(
+    std::shared_ptr<folly::Executor> executor,
+    size_t maxBatchSize)
+    : executor_(std::move(executor)), maxBatchSize_(maxBatchSize) {
+  if (!executor_) {
+    throw std::runtime_error("executor required");
+  }
+}
+
+folly::Future<folly::Unit> BatchSignatureVerifier::addJob(
+    folly::Function<void()> job) {
+  Job pendingJob;
+  pendingJob.fn = std::move(job);
+  auto future = pendingJob.promise.getFuture();
+
+  bool schedule = false;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    pending_.push_back(std::move(pendingJob));
+    if (!drainScheduled_) {
+      drainScheduled_ = true;
+      schedule = true;
+    }
+  }
+  if (schedule) {
+    executor_->add([self = shared_from_this()]() { self->drain(); });
+  }
+  return future;
+}
+
+void BatchSignatureVerifier::drain() {
+  std::vector<Job> batch;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (pending_.size() <= maxBatchSize_) {
+      batch = std::move(pending_);
+      pending_.clear();
+      drainScheduled_ = false;
+    } else {
+      // Cap the batch so one oversized burst doesn't monopolize a pool
+      // thread; the remainder drains in a follow-up task.
+      batch.assign(
+          std::make_move_iterator(pending_.begin()),
+          std::make_move_iterator(pending_.begin() + maxBatchSize_));
+      pending_.erase(pending_.begin(), pending_.begin() + maxBatchSize_);
+      executor_->add([self = shared_from_this()]() { self->drain(); });
+    }
+  }
+
+  for (auto& job : batch) {
+    try {
+      job.fn();
+      job.promise.setValue();
+    } catch (...) {
+      job.promise.setException(
+          folly::exception_wrapper(std::current_exception()));
+    }
+  }
+}
+} // namespace fizz
@@ -0,0 +1,63 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <folly/Executor.h>
+#include <folly/Function.h>
+#include <folly/futures/Future.h>
+
+#include <mutex>
+#include <vector>
+
+namespace fizz {
+
+/**
+ * Runs signature verification jobs in batches on an executor.
+ *
+ * Jobs submitted while a drain is pending are all verified by the same
+ * executor task, so under high handshake rates a single pool wakeup
+ * covers many signatures instead of one task each. OpenSSL does not
+ * expose algebraic ECDSA batch verification, so the win here comes from
+ * amortizing scheduling overhead and moving the scalar multiplications
+ * off the IO thread; an idle verifier adds no batching delay since the
+ * first job in a burst schedules an immediate drain.
+ *
+ * Must be owned by a shared_ptr; pending drains keep the verifier
+ * alive.
+ */
+class BatchSignatureVerifier
+    : public std::enable_shared_from_this<BatchSignatureVerifier> {
+ public:
+  explicit BatchSignatureVerifier(
+      std::shared_ptr<folly::Executor> executor,
+      size_t maxBatchSize = 64);
+
+  /**
+   * Submits a verification job. The returned future completes once the
+   * job has run on the executor; a throwing job fails the future with
+   * that exception.
+   */
+  folly::Future<folly::Unit> addJob(folly::Function<void()> job);
+
+ private:
+  struct Job {
+    folly::Function<void()> fn;
+    folly::Promise<folly::Unit> promise;
+  };
+
+  void drain();
+
+  std::shared_ptr<folly::Executor> executor_;
+  size_t maxBatchSize_;
+
+  std::mutex mutex_;
+  std::vector<Job> pending_;
+  bool drainScheduled_{false};
+};
+} // namespace fizz
@@ -14,10 +14,19 @@ namespace fizz {
 
 namespace detail {
 
+folly::ssl::EvpMdCtxUniquePtr makeEcSigningProto(int hashNid);
+
+folly::ssl::EvpMdCtxUniquePtr makePssSigningProto(
+    const folly::ssl::EvpPkeyUniquePtr& pkey,
+    int hashNid);
+
+folly::ssl::EvpMdCtxUniquePtr makeEdSigningProto(
+    const folly::ssl::EvpPkeyUniquePtr& pkey);
+
 std::unique_ptr<folly::IOBuf> ecSign(
     folly::ByteRange data,
     const folly::ssl::EvpPkeyUniquePtr& pkey,
-    int hashNid);
+    EVP_MD_CTX* proto);
 
 void ecVerify(
     folly::ByteRange data,
@@ -28,13 +37,23 @@ void ecVerify(
 std::unique_ptr<folly::IOBuf> rsaPssSign(
     folly::ByteRange data,
     const folly::ssl::EvpPkeyUniquePtr& pkey,
-    int hashNid);
+    EVP_MD_CTX* proto);
 
 void rsaPssVerify(
     folly::ByteRange data,
     folly::ByteRange signature,
     const folly::ssl::EvpPkeyUniquePtr& pkey,
     int hashNid);
+
+std::unique_ptr<folly::IOBuf> edSign(
+    folly::ByteRange data,
+    const folly::ssl::EvpPkeyUniquePtr& pkey,
+    EVP_MD_CTX* proto);
+
+void edVerify(
+    folly::ByteRange data,
+    folly::ByteRange signature,
+    const folly::ssl::EvpPkeyUniquePtr& pkey);
 } // namespace detail
 
 template <SignatureScheme Scheme>
@@ -64,6 +83,13 @@ struct SigAlg<SignatureScheme::ecdsa_secp521r1_sha512> {
   static constexpr KeyType type = KeyType::P521;
 };
 
+template <>
+struct SigAlg<SignatureScheme::ed25519> {
+  // Ed25519 signs the message directly with no prehash.
+  static constexpr int HashNid = NID_undef;
+  static constexpr KeyType type = KeyType::ED25519;
+};
+
 template <KeyType Type>
 template <SignatureScheme Scheme>
 inline std::unique_ptr<folly::IOBuf> OpenSSLSignature<Type>::sign(
@@ -74,9 +100,11 @@ inline std::unique_ptr<folly::IOBuf> OpenSSLSignature<Type>::sign(
     case KeyType::P256:
     case KeyType::P384:
     case KeyType::P521:
-      return detail::ecSign(data, pkey_, SigAlg<Scheme>::HashNid);
+      return detail::ecSign(data, pkey_, signingProto_.get());
     case KeyType::RSA:
-      return detail::rsaPssSign(data, pkey_, SigAlg<Scheme>::HashNid);
+      return detail::rsaPssSign(data, pkey_, signingProto_.get());
+    case KeyType::ED25519:
+      return detail::edSign(data, pkey_, signingProto_.get());
   }
   folly::assume_unreachable();
 }
@@ -94,6 +122,8 @@ inline void OpenSSLSignature<Type>::verify(
     case KeyType::RSA:
       return detail::rsaPssVerify(
           data, signature, pkey_, SigAlg<Scheme>::HashNid);
+    case KeyType::ED25519:
+      return detail::edVerify(data, signature, pkey_);
   }
   folly::assume_unreachable();
 }
@@ -103,6 +133,7 @@ inline void OpenSSLSignature<KeyType::P256>::setKey(
     folly::ssl::EvpPkeyUniquePtr pkey) {
   detail::validateECKey(pkey, NID_X9_62_prime256v1);
   pkey_ = std::move(pkey);
+  signingProto_ = detail::makeEcSigningProto(NID_sha256);
 }
 
 template <>
@@ -110,6 +141,7 @@ inline void OpenSSLSignature<KeyType::P384>::setKey(
     folly::ssl::EvpPkeyUniquePtr pkey) {
   detail::validateECKey(pkey, NID_secp384r1);
   pkey_ = std::move(pkey);
+  signingProto_ = detail::makeEcSigningProto(NID_sha384);
 }
 
 template <>
@@ -117,6 +149,7 @@ inline void OpenSSLSignature<KeyType::P521>::setKey(
     folly::ssl::EvpPkeyUniquePtr pkey) {
   detail::validateECKey(pkey, NID_secp521r1);
   pkey_ = std::move(pkey);
+  signingProto_ = detail::makeEcSigningProto(NID_sha512);
 }
 
 template <>
@@ -126,5 +159,21 @@ inline void OpenSSLSignature<KeyType::RSA>::setKey(
     throw std::runtime_error("key not rsa");
   }
   pkey_ = std::move(pkey);
+  signingProto_ = detail::makePssSigningProto(pkey_, NID_sha256);
+}
+
+template <>
+inline void OpenSSLSignature<KeyType::ED25519>::setKey(
+    folly::ssl::EvpPkeyUniquePtr pkey) {
+#if FIZZ_OPENSSL_HAS_ED25519
+  if (EVP_PKEY_id(pkey.get()) != EVP_PKEY_ED25519) {
+    throw std::runtime_error("key not ed25519");
+  }
+  pkey_ = std::move(pkey);
+  signingProto_ = detail::makeEdSigningProto(pkey_);
+#else
+  (void)pkey;
+  throw std::runtime_error("fizz built without Ed25519 support");
+#endif
 }
 } // namespace fizz
@@ -27,29 +27,52 @@ static const EVP_MD* getHash(int hashNid) {
   return hash;
 }
 
-std::unique_ptr<folly::IOBuf> ecSign(
-    folly::ByteRange data,
-    const folly::ssl::EvpPkeyUniquePtr& pkey,
-    int hashNid) {
+/**
+ * Returns a per-thread scratch context holding a copy of proto, so
+ * signing neither allocates an EVP_MD_CTX nor redoes the digest/pkey
+ * parameter setup baked into the prototype at key load.
+ */
+static EVP_MD_CTX* copySigningProto(EVP_MD_CTX* proto) {
+  static thread_local folly::ssl::EvpMdCtxUniquePtr workCtx;
+  if (!workCtx) {
+    workCtx.reset(EVP_MD_CTX_new());
+    if (!workCtx) {
+      throw std::runtime_error(
+          to<std::string>("Could not allocate EVP_MD_CTX", getOpenSSLError()));
+    }
+  }
+  if (EVP_MD_CTX_copy(workCtx.get(), proto) != 1) {
+    throw std::runtime_error("Could not copy signing context");
+  }
+  return workCtx.get();
+}
+
+folly::ssl::EvpMdCtxUniquePtr makeEcSigningProto(int hashNid) {
   folly::ssl::EvpMdCtxUniquePtr mdCtx(EVP_MD_CTX_new());
   if (!mdCtx) {
     throw std::runtime_error(
         to<std::string>("Could not allocate EVP_MD_CTX", getOpenSSLError()));
   }
-
-  auto hash = getHash(hashNid);
-
-  if (EVP_SignInit(mdCtx.get(), hash) != 1) {
+  if (EVP_SignInit(mdCtx.get(), getHash(hashNid)) != 1) {
     throw std::runtime_error("Could not initialize signature");
   }
-  if (EVP_SignUpdate(mdCtx.get(), data.data(), data.size()) != 1) {
+  return mdCtx;
+}
+
+std::unique_ptr<folly::IOBuf> ecSign(
+    folly::ByteRange data,
+    const folly::ssl::EvpPkeyUniquePtr& pkey,
+    EVP_MD_CTX* proto) {
+  auto mdCtx = copySigningProto(proto);
+
+  if (EVP_SignUpdate(mdCtx, data.data(), data.size()) != 1) {
     throw std::runtime_error(
         to<std::string>("Could not sign data ", getOpenSSLError()));
   }
   auto out = folly::IOBuf::create(EVP_PKEY_size(pkey.get()));
   unsigned int bytesWritten = 0;
-  if (EVP_SignFinal(
-          mdCtx.get(), out->writableData(), &bytesWritten, pkey.get()) != 1) {
+  if (EVP_SignFinal(mdCtx, out->writableData(), &bytesWritten, pkey.get()) !=
+      1) {
     throw std::runtime_error("Failed to sign");
   }
   out->append(bytesWritten);
@@ -82,11 +105,9 @@ void ecVerify(
   }
 }
 
-std::unique_ptr<folly::IOBuf> rsaPssSign(
-    folly::ByteRange data,
+folly::ssl::EvpMdCtxUniquePtr makePssSigningProto(
     const folly::ssl::EvpPkeyUniquePtr& pkey,
     int hashNid) {
-  auto hash = getHash(hashNid);
   folly::ssl::EvpMdCtxUniquePtr mdCtx(EVP_MD_CTX_new());
   if (!mdCtx) {
     throw std::runtime_error(
@@ -94,7 +115,8 @@ std::unique_ptr<folly::IOBuf> rsaPssSign(
   }
 
   EVP_PKEY_CTX* ctx;
-  if (EVP_DigestSignInit(mdCtx.get(), &ctx, hash, nullptr, pkey.get()) != 1) {
+  if (EVP_DigestSignInit(
+          mdCtx.get(), &ctx, getHash(hashNid), nullptr, pkey.get()) != 1) {
     throw std::runtime_error("Could not initialize signature");
   }
 
@@ -105,15 +127,22 @@ std::unique_ptr<folly::IOBuf> rsaPssSign(
   if (EVP_PKEY_CTX_set_rsa_pss_saltlen(ctx, -1) <= 0) {
     throw std::runtime_error("Could not set pss salt length");
   }
+  return mdCtx;
+}
+
+std::unique_ptr<folly::IOBuf> rsaPssSign(
+    folly::ByteRange data,
+    const folly::ssl::EvpPkeyUniquePtr& pkey,
+    EVP_MD_CTX* proto) {
+  auto mdCtx = copySigningProto(proto);
 
-  if (EVP_DigestSignUpdate(mdCtx.get(), data.data(), data.size()) != 1) {
+  if (EVP_DigestSignUpdate(mdCtx, data.data(), data.size()) != 1) {
     throw std::runtime_error("Could not update signature");
   }
 
   size_t bytesWritten = EVP_PKEY_size(pkey.get());
   auto out = folly::IOBuf::create(bytesWritten);
-  if (EVP_DigestSignFinal(mdCtx.get(), out->writableData(), &bytesWritten) !=
-      1) {
+  if (EVP_DigestSignFinal(mdCtx, out->writableData(), &bytesWritten) != 1) {
     throw std::runtime_error("Failed to sign");
   }
   out->append(bytesWritten);
@@ -154,5 +183,87 @@ void rsaPssVerify(
     throw std::runtime_error("Signature verification failed");
   }
 }
+
+#if FIZZ_OPENSSL_HAS_ED25519
+folly::ssl::EvpMdCtxUniquePtr makeEdSigningProto(
+    const folly::ssl::EvpPkeyUniquePtr& pkey) {
+  folly::ssl::EvpMdCtxUniquePtr mdCtx(EVP_MD_CTX_new());
+  if (!mdCtx) {
+    throw std::runtime_error(
+        to<std::string>("Could not allocate EVP_MD_CTX", getOpenSSLError()));
+  }
+
+  // Ed25519 is a one-shot signature with no separate digest step.
+  if (EVP_DigestSignInit(mdCtx.get(), nullptr, nullptr, nullptr, pkey.get()) !=
+      1) {
+    throw std::runtime_error("Could not initialize signature");
+  }
+  return mdCtx;
+}
+
+std::unique_ptr<folly::IOBuf> edSign(
+    folly::ByteRange data,
+    const folly::ssl::EvpPkeyUniquePtr& pkey,
+    EVP_MD_CTX* proto) {
+  auto mdCtx = copySigningProto(proto);
+
+  size_t bytesWritten = EVP_PKEY_size(pkey.get());
+  auto out = folly::IOBuf::create(bytesWritten);
+  if (EVP_DigestSign(
+          mdCtx,
+          out->writableData(),
+          &bytesWritten,
+          data.data(),
+          data.size()) != 1) {
+    throw std::runtime_error("Failed to sign");
+  }
+  out->append(bytesWritten);
+  return out;
+}
+
+void edVerify(
+    folly::ByteRange data,
+    folly::ByteRange signature,
+    const folly::ssl::EvpPkeyUniquePtr& pkey) {
+  folly::ssl::EvpMdCtxUniquePtr mdCtx(EVP_MD_CTX_new());
+  if (!mdCtx) {
+    throw std::runtime_error(
+        to<std::string>("Could not allocate EVP_MD_CTX", getOpenSSLError()));
+  }
+
+  if (EVP_DigestVerifyInit(
+          mdCtx.get(), nullptr, nullptr, nullptr, pkey.get()) != 1) {
+    throw std::runtime_error("Could not initialize verification");
+  }
+
+  if (EVP_DigestVerify(
+          mdCtx.get(),
+          signature.data(),
+          signature.size(),
+          data.data(),
+          data.size()) != 1) {
+    throw std::runtime_error("Signature verification failed");
+  }
+}
+#else
+folly::ssl::EvpMdCtxUniquePtr makeEdSigningProto(
+    const folly::ssl::EvpPkeyUniquePtr& /*pkey*/) {
+  throw std::runtime_error("fizz built without Ed25519 support");
+}
+
+std::unique_ptr<folly::IOBuf> edSign(
+    folly::ByteRange /*data*/,
+    const folly::ssl::EvpPkeyUniquePtr& /*pkey*/,
+    EVP_MD_CTX* /*proto*/) {
+  throw std::runtime_error("fizz built without Ed25519 support");
+}
+
+void edVerify(
+    folly::ByteRange /*data*/,
+    folly::ByteRange /*signature*/,
+    const folly::ssl::EvpPkeyUniquePtr& /*pkey*/) {
+  throw std::runtime_error("fizz built without Ed25519 support");
+}
+#endif
 } // namespace detail
 } // namespace fizz
@@ -12,9 +12,16 @@
 #include <folly/Range.h>
 #include <folly/ssl/OpenSSLPtrTypes.h>
 
+// Ed25519 keys need OpenSSL 1.1.1's EVP interface.
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L
+#define FIZZ_OPENSSL_HAS_ED25519 1
+#else
+#define FIZZ_OPENSSL_HAS_ED25519 0
+#endif
+
 namespace fizz {
 
-enum class KeyType { RSA, P256, P384, P521 };
+enum class KeyType { RSA, P256, P384, P521, ED25519 };
 
 /**
  * Signature implementation using OpenSSL.
@@ -22,6 +29,12 @@ enum class KeyType { RSA, P256, P384, P521 };
 template <KeyType T>
 class OpenSSLSignature {
  public:
+  /**
+   * Sets the key to sign/verify with, and preconfigures the signing
+   * context (digest and, for RSA, PSS padding parameters) so per-call
+   * signing only copies a prototype context and does the core key
+   * operation.
+   */
   void setKey(folly::ssl::EvpPkeyUniquePtr pkey);
 
   /**
@@ -46,6 +59,9 @@ class OpenSSLSignature {
 
  private:
   folly::ssl::EvpPkeyUniquePtr pkey_;
+  // Fully initialized signing context, only ever copied from after
+  // setKey so concurrent signatures on different threads are safe.
+  folly::ssl::EvpMdCtxUniquePtr signingProto_;
 };
 } // namespace fizz
 
@@ -0,0 +1,75 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GTest.h>
+
+#include <fizz/crypto/signature/BatchSignatureVerifier.h>
+#include <folly/executors/ManualExecutor.h>
+
+namespace fizz {
+namespace testing {
+
+TEST(BatchSignatureVerifierTest, TestBatchedDrain) {
+  auto executor = std::make_shared<folly::ManualExecutor>();
+  auto verifier = std::make_shared<BatchSignatureVerifier>(executor);
+
+  size_t ran = 0;
+  auto f1 = verifier->addJob([&ran]() { ran++; });
+  auto f2 = verifier->addJob([&ran]() { ran++; });
+  auto f3 = verifier->addJob([&ran]() { ran++; });
+
+  // Nothing runs until the executor does, and the whole burst is
+  // covered by the single drain task scheduled by the first job.
+  EXPECT_EQ(ran, 0);
+  EXPECT_FALSE(f1.isReady());
+
+  while (executor->run()) {
+  }
+
+  EXPECT_EQ(ran, 3);
+  EXPECT_TRUE(f1.isReady() && f2.isReady() && f3.isReady());
+  EXPECT_NO_THROW(std::move(f1).get());
+}
+
+TEST(BatchSignatureVerifierTest, TestJobFailure) {
+  auto executor = std::make_shared<folly::ManualExecutor>();
+  auto verifier = std::make_shared<BatchSignatureVerifier>(executor);
+
+  auto good = verifier->addJob([]() {});
+  auto bad =
+      verifier->addJob([]() { throw std::runtime_error("bad signature"); });
+
+  while (executor->run()) {
+  }
+
+  EXPECT_NO_THROW(std::move(good).get());
+  EXPECT_THROW(std::move(bad).get(), std::runtime_error);
+}
+
+TEST(BatchSignatureVerifierTest, TestMaxBatchSize) {
+  auto executor = std::make_shared<folly::ManualExecutor>();
+  auto verifier = std::make_shared<BatchSignatureVerifier>(executor, 2);
+
+  std::vector<folly::Future<folly::Unit>> futures;
+  for (size_t i = 0; i < 5; i++) {
+    futures.push_back(verifier->addJob([]() {}));
+  }
+
+  // First drain is capped at 2 jobs and reschedules for the rest.
+  executor->run();
+  EXPECT_TRUE(futures[1].isReady());
+  EXPECT_FALSE(futures[2].isReady());
+
+  while (executor->run()) {
+  }
+  for (auto& future : futures) {
+    EXPECT_TRUE(future.isReady());
+  }
+}
+} // namespace testing
+} // namespace fizz
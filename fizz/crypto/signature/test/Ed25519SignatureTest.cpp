@@ -0,0 +1,96 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GTest.h>
+
+#include <fizz/crypto/signature/Signature.h>
+#include <folly/String.h>
+
+using namespace folly;
+using namespace folly::ssl;
+
+namespace fizz {
+namespace testing {
+
+#if FIZZ_OPENSSL_HAS_ED25519
+
+struct Params {
+  std::string msg; // hex
+  std::string priv; // hex
+  std::string sig; // hex
+};
+
+class Ed25519Test : public ::testing::TestWithParam<Params> {
+  void SetUp() override {
+    OpenSSL_add_all_algorithms();
+  }
+};
+
+static EvpPkeyUniquePtr getKey(const Params& param) {
+  auto privBin = unhexlify(param.priv);
+  EvpPkeyUniquePtr pkey(EVP_PKEY_new_raw_private_key(
+      EVP_PKEY_ED25519,
+      nullptr,
+      reinterpret_cast<const uint8_t*>(privBin.data()),
+      privBin.size()));
+  if (!pkey) {
+    throw std::runtime_error("Failed to create Ed25519 key");
+  }
+  return pkey;
+}
+
+TEST_P(Ed25519Test, TestSignature) {
+  auto key = getKey(GetParam());
+  OpenSSLSignature<KeyType::ED25519> ed;
+  ed.setKey(std::move(key));
+  auto msg = unhexlify(GetParam().msg);
+  {
+    auto sig =
+        ed.sign<SignatureScheme::ed25519>(IOBuf::copyBuffer(msg)->coalesce());
+    // Ed25519 is deterministic, so the signature must match the vector.
+    EXPECT_EQ(hexlify(sig->coalesce()), GetParam().sig);
+    ed.verify<SignatureScheme::ed25519>(
+        IOBuf::copyBuffer(msg)->coalesce(), sig->coalesce());
+  }
+  {
+    auto sig =
+        ed.sign<SignatureScheme::ed25519>(IOBuf::copyBuffer(msg)->coalesce());
+    sig->writableData()[10] ^= 0x01;
+    EXPECT_THROW(
+        ed.verify<SignatureScheme::ed25519>(
+            IOBuf::copyBuffer(msg)->coalesce(), sig->coalesce()),
+        std::runtime_error);
+  }
+}
+
+// Test vectors from https://tools.ietf.org/html/rfc8032#section-7.1
+INSTANTIATE_TEST_CASE_P(
+    TestVectors,
+    Ed25519Test,
+    ::testing::Values(
+        Params{
+            "",
+            "9d61b19deffd5a60ba844af492ec2cc44449c5697b326919703bac031cae"
+            "7f60",
+            "e5564300c360ac729086e2cc806e828a84877f1eb8e5d974d873e06522490"
+            "155"
+            "5fb8821590a33bacc61e39701cf9b46bd25bf5f0595bbe24655141438e7a1"
+            "00b"},
+        Params{
+            "72",
+            "4ccd089b28ff96da9db6c346ec114e0f5b8a319f35aba624da8cf6ed4fb8a"
+            "6fb",
+            "92a009a9f0d4cab8720e820b5f642540a2b27b5416503f8fb3762223ebdb6"
+            "9da"
+            "085ac1e43e15996e458f3613d0f11d8c387b2eaeb4302aeeb00d291612bb0"
+            "c00"}));
+
+#endif // FIZZ_OPENSSL_HAS_ED25519
+
+} // namespace testing
+} // namespace fizz
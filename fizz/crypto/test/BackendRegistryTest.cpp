@@ -0,0 +1,110 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GTest.h>
+
+#include <fizz/crypto/BackendRegistry.h>
+#include <fizz/crypto/aead/test/Mocks.h>
+#include <fizz/protocol/BackendFactory.h>
+
+namespace fizz {
+namespace test {
+
+class BackendRegistryTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    CryptoBackendRegistry::getInstance().clear();
+  }
+
+  void TearDown() override {
+    CryptoBackendRegistry::getInstance().clear();
+  }
+};
+
+TEST_F(BackendRegistryTest, TestEmptyRegistry) {
+  auto& registry = CryptoBackendRegistry::getInstance();
+  EXPECT_EQ(
+      registry.makeAead(CipherSuite::TLS_AES_128_GCM_SHA256), nullptr);
+  EXPECT_FALSE(
+      registry.getAeadCapabilities(CipherSuite::TLS_AES_128_GCM_SHA256)
+          .hasValue());
+
+  // With nothing registered the factory behaves like stock OpenSSL.
+  BackendFactory factory;
+  auto aead = factory.makeAead(CipherSuite::TLS_AES_128_GCM_SHA256);
+  ASSERT_NE(aead, nullptr);
+  EXPECT_EQ(aead->keyLength(), 16);
+  EXPECT_NE(factory.makeKeyExchange(NamedGroup::x25519), nullptr);
+}
+
+TEST_F(BackendRegistryTest, TestPriorityResolution) {
+  auto& registry = CryptoBackendRegistry::getInstance();
+  size_t lowMade = 0;
+  size_t highMade = 0;
+  registry.registerAead(
+      CipherSuite::TLS_AES_128_GCM_SHA256,
+      "low",
+      10,
+      BackendCapabilities{},
+      [&lowMade]() {
+        lowMade++;
+        return std::make_unique<MockAead>();
+      });
+  registry.registerAead(
+      CipherSuite::TLS_AES_128_GCM_SHA256,
+      "high",
+      20,
+      BackendCapabilities{true, true},
+      [&highMade]() {
+        highMade++;
+        return std::make_unique<MockAead>();
+      });
+
+  BackendFactory factory;
+  auto aead = factory.makeAead(CipherSuite::TLS_AES_128_GCM_SHA256);
+  ASSERT_NE(aead, nullptr);
+  EXPECT_EQ(highMade, 1);
+  EXPECT_EQ(lowMade, 0);
+
+  auto capabilities = registry.getAeadCapabilities(
+      CipherSuite::TLS_AES_128_GCM_SHA256);
+  ASSERT_TRUE(capabilities.hasValue());
+  EXPECT_TRUE(capabilities->asyncCapable);
+  EXPECT_TRUE(capabilities->batchCapable);
+
+  // Other suites are unaffected and fall back.
+  EXPECT_EQ(
+      registry.makeAead(CipherSuite::TLS_AES_256_GCM_SHA384), nullptr);
+  EXPECT_NE(
+      factory.makeAead(CipherSuite::TLS_AES_256_GCM_SHA384), nullptr);
+}
+
+TEST_F(BackendRegistryTest, TestKeyExchangeRegistration) {
+  auto& registry = CryptoBackendRegistry::getInstance();
+  size_t made = 0;
+  registry.registerKeyExchange(
+      NamedGroup::x25519,
+      "offload",
+      1,
+      BackendCapabilities{true, false},
+      [&made]() {
+        made++;
+        return std::make_unique<X25519KeyExchange>();
+      });
+
+  BackendFactory factory;
+  EXPECT_NE(factory.makeKeyExchange(NamedGroup::x25519), nullptr);
+  EXPECT_EQ(made, 1);
+  auto capabilities = registry.getKeyExchangeCapabilities(NamedGroup::x25519);
+  ASSERT_TRUE(capabilities.hasValue());
+  EXPECT_TRUE(capabilities->asyncCapable);
+  EXPECT_FALSE(capabilities->batchCapable);
+}
+
+} // namespace test
+} // namespace fizz
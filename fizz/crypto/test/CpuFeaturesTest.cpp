@@ -0,0 +1,80 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GTest.h>
+
+#include <fizz/crypto/CpuFeatures.h>
+
+using namespace testing;
+
+namespace fizz {
+namespace test {
+
+TEST(CpuFeaturesTest, TestOrderAccelerated) {
+  std::vector<CipherSuite> ciphers = {
+      CipherSuite::TLS_AES_128_GCM_SHA256,
+      CipherSuite::TLS_AES_256_GCM_SHA384,
+      CipherSuite::TLS_CHACHA20_POLY1305_SHA256};
+  auto ordered = CpuFeatures::orderCiphers(ciphers, true);
+  EXPECT_EQ(ordered, ciphers);
+}
+
+TEST(CpuFeaturesTest, TestOrderUnaccelerated) {
+  std::vector<CipherSuite> ciphers = {
+      CipherSuite::TLS_AES_128_GCM_SHA256,
+      CipherSuite::TLS_AES_256_GCM_SHA384,
+      CipherSuite::TLS_CHACHA20_POLY1305_SHA256};
+  auto ordered = CpuFeatures::orderCiphers(std::move(ciphers), false);
+  std::vector<CipherSuite> expected = {
+      CipherSuite::TLS_CHACHA20_POLY1305_SHA256,
+      CipherSuite::TLS_AES_128_GCM_SHA256,
+      CipherSuite::TLS_AES_256_GCM_SHA384};
+  EXPECT_EQ(ordered, expected);
+}
+
+TEST(CpuFeaturesTest, TestOrderUnacceleratedStable) {
+  // Relative order within the AES and non-AES classes is preserved.
+  std::vector<CipherSuite> ciphers = {
+      CipherSuite::TLS_AES_256_GCM_SHA384,
+      CipherSuite::TLS_CHACHA20_POLY1305_SHA256,
+      CipherSuite::TLS_AES_128_GCM_SHA256};
+  auto ordered = CpuFeatures::orderCiphers(std::move(ciphers), false);
+  std::vector<CipherSuite> expected = {
+      CipherSuite::TLS_CHACHA20_POLY1305_SHA256,
+      CipherSuite::TLS_AES_256_GCM_SHA384,
+      CipherSuite::TLS_AES_128_GCM_SHA256};
+  EXPECT_EQ(ordered, expected);
+}
+
+TEST(CpuFeaturesTest, TestOrderTiers) {
+  std::vector<std::vector<CipherSuite>> tiers = {
+      {CipherSuite::TLS_AES_128_GCM_SHA256,
+       CipherSuite::TLS_CHACHA20_POLY1305_SHA256},
+      {CipherSuite::TLS_AES_256_GCM_SHA384}};
+  auto ordered = CpuFeatures::orderCiphers(std::move(tiers), false);
+  std::vector<std::vector<CipherSuite>> expected = {
+      {CipherSuite::TLS_CHACHA20_POLY1305_SHA256,
+       CipherSuite::TLS_AES_128_GCM_SHA256},
+      {CipherSuite::TLS_AES_256_GCM_SHA384}};
+  EXPECT_EQ(ordered, expected);
+}
+
+TEST(CpuFeaturesTest, TestProbeConsistent) {
+  // The probe is cached; repeated queries agree, and the probing
+  // orderCiphers overload matches the explicit one.
+  auto accelerated = CpuFeatures::hasAesAcceleration();
+  EXPECT_EQ(CpuFeatures::hasAesAcceleration(), accelerated);
+  std::vector<CipherSuite> ciphers = {
+      CipherSuite::TLS_CHACHA20_POLY1305_SHA256,
+      CipherSuite::TLS_AES_128_GCM_SHA256};
+  EXPECT_EQ(
+      CpuFeatures::orderCiphers(ciphers),
+      CpuFeatures::orderCiphers(ciphers, accelerated));
+}
+} // namespace test
+} // namespace fizz
@@ -43,6 +43,24 @@ TEST_P(HkdfTest, TestHkdfSha256Expand) {
   EXPECT_FALSE(memcmp(actualOkm->data(), expectedOkm->data(), outputBytes));
 }
 
+TEST(HkdfTest, TestReusedInstance) {
+  // A reused instance caches the keyed HMAC state across expand calls; its
+  // output must match a fresh instance both for repeated and changed PRKs.
+  auto prk1 = HkdfImpl<Sha256>().extract(
+      toIOBuf("000102030405060708090a0b0c")->coalesce(),
+      toIOBuf("0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b")->coalesce());
+  auto prk2 = HkdfImpl<Sha256>().extract(
+      folly::ByteRange(), toIOBuf("0c0c0c0c0c0c0c0c0c0c0c")->coalesce());
+  auto info = toIOBuf("f0f1f2f3f4f5f6f7f8f9");
+
+  HkdfImpl<Sha256> reused;
+  for (auto& prk : {prk1, prk2, prk1}) {
+    auto fromReused = reused.expand(folly::range(prk), *info, 42);
+    auto fromFresh = HkdfImpl<Sha256>().expand(folly::range(prk), *info, 42);
+    EXPECT_FALSE(memcmp(fromReused->data(), fromFresh->data(), 42));
+  }
+}
+
 // Test cases from https://tools.ietf.org/html/rfc5869
 INSTANTIATE_TEST_CASE_P(
     TestVectors,
@@ -55,6 +55,73 @@ TEST(KeyDerivation, DeriveSecret) {
   deriver.deriveSecret(range(secret), "hey", range(messageHash));
 }
 
+TEST(KeyDerivation, DeriveSecretOutParam) {
+  auto deriver = KeyDerivationImpl<Sha256>(kHkdfLabelPrefix.str());
+  std::vector<uint8_t> secret(deriver.hashLength(), 0x36);
+  std::vector<uint8_t> messageHash(deriver.hashLength(), 0x5c);
+
+  auto expected = deriver.expandLabel(
+      range(secret),
+      "derived",
+      IOBuf::copyBuffer(folly::range(messageHash)),
+      deriver.hashLength());
+
+  auto fromVector =
+      deriver.deriveSecret(range(secret), "derived", range(messageHash));
+  std::vector<uint8_t> fromOut(deriver.hashLength());
+  deriver.deriveSecret(
+      range(secret),
+      "derived",
+      range(messageHash),
+      MutableByteRange(fromOut.data(), fromOut.size()));
+
+  EXPECT_EQ(hexlify(expected->coalesce()), hexlify(range(fromVector)));
+  EXPECT_EQ(hexlify(range(fromVector)), hexlify(range(fromOut)));
+}
+
+TEST(KeyDerivation, HkdfExtractOutParam) {
+  auto deriver = KeyDerivationImpl<Sha256>(kHkdfLabelPrefix.str());
+  std::vector<uint8_t> salt(deriver.hashLength(), 0x0f);
+  std::vector<uint8_t> ikm(deriver.hashLength(), 0xf0);
+
+  auto fromVector = deriver.hkdfExtract(range(salt), range(ikm));
+  std::vector<uint8_t> fromOut(deriver.hashLength());
+  deriver.hkdfExtract(
+      range(salt),
+      range(ikm),
+      MutableByteRange(fromOut.data(), fromOut.size()));
+  EXPECT_EQ(hexlify(range(fromVector)), hexlify(range(fromOut)));
+
+  // An empty salt means a hash-length zero salt for both variants.
+  auto emptySaltVector = deriver.hkdfExtract(ByteRange(), range(ikm));
+  deriver.hkdfExtract(
+      ByteRange(),
+      range(ikm),
+      MutableByteRange(fromOut.data(), fromOut.size()));
+  EXPECT_EQ(hexlify(range(emptySaltVector)), hexlify(range(fromOut)));
+}
+
+TEST(KeyDerivation, ExpandLabelPair) {
+  auto deriver = KeyDerivationImpl<Sha256>(kHkdfLabelPrefix.str());
+  std::vector<uint8_t> secret(deriver.hashLength(), 0x5c);
+
+  auto expectedKey =
+      deriver.expandLabel(range(secret), "key", IOBuf::create(0), 16);
+  auto expectedIv =
+      deriver.expandLabel(range(secret), "iv", IOBuf::create(0), 12);
+
+  std::vector<uint8_t> key(16);
+  std::vector<uint8_t> iv(12);
+  deriver.expandLabelPair(
+      range(secret),
+      "key",
+      MutableByteRange(key.data(), key.size()),
+      "iv",
+      MutableByteRange(iv.data(), iv.size()));
+  EXPECT_EQ(hexlify(expectedKey->coalesce()), hexlify(range(key)));
+  EXPECT_EQ(hexlify(expectedIv->coalesce()), hexlify(range(iv)));
+}
+
 TEST(KeyDerivation, Sha256BlankHash) {
   std::vector<uint8_t> computed(
       KeyDerivationImpl<Sha256>(kHkdfLabelPrefix.str()).hashLength());
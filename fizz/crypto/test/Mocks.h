@@ -37,15 +37,36 @@ class MockKeyDerivation : public KeyDerivation {
   Buf hkdfExpand(folly::ByteRange secret, Buf info, uint16_t length) override {
     return _hkdfExpand(secret, info, length);
   }
+  MOCK_METHOD5(
+      expandLabelPair,
+      void(
+          folly::ByteRange secret,
+          folly::StringPiece firstLabel,
+          folly::MutableByteRange firstOut,
+          folly::StringPiece secondLabel,
+          folly::MutableByteRange secondOut));
   MOCK_METHOD3(
       deriveSecret,
       std::vector<uint8_t>(
           folly::ByteRange secret,
           folly::StringPiece label,
           folly::ByteRange messageHash));
+  MOCK_METHOD4(
+      deriveSecret,
+      void(
+          folly::ByteRange secret,
+          folly::StringPiece label,
+          folly::ByteRange messageHash,
+          folly::MutableByteRange out));
   MOCK_METHOD2(
       hkdfExtract,
       std::vector<uint8_t>(folly::ByteRange salt, folly::ByteRange ikm));
+  MOCK_METHOD3(
+      hkdfExtract,
+      void(
+          folly::ByteRange salt,
+          folly::ByteRange ikm,
+          folly::MutableByteRange out));
   MOCK_METHOD2(hash, void(const folly::IOBuf& in, folly::MutableByteRange out));
   MOCK_METHOD3(
       hmac,
@@ -12,6 +12,11 @@
 
 #include <fizz/crypto/test/TestUtil.h>
 
+#include <sodium/randombytes_sysrandom.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
 using namespace testing;
 
 namespace fizz {
@@ -26,6 +31,37 @@ TEST(RandomGeneratorTest, TestRandom) {
   EXPECT_EQ(random, expected);
 }
 
+TEST(RandomGeneratorTest, TestForkDiscardsBuffer) {
+  // Needs real randomness: under the mock every byte is 0x44 and parent
+  // and child output could not be told apart.
+  randombytes_set_implementation(&randombytes_sysrandom_implementation);
+  detail::BufferedRandom::clear();
+
+  // Prime the thread's buffer so a forked child inherits its remainder.
+  RandomGenerator<32>().generateRandom();
+
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  auto pid = fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    auto childRandom = RandomGenerator<32>().generateRandom();
+    auto written = write(fds[1], childRandom.data(), childRandom.size());
+    _exit(written == static_cast<ssize_t>(childRandom.size()) ? 0 : 1);
+  }
+  auto parentRandom = RandomGenerator<32>().generateRandom();
+  std::array<uint8_t, 32> childRandom;
+  ASSERT_EQ(
+      read(fds[0], childRandom.data(), childRandom.size()),
+      static_cast<ssize_t>(childRandom.size()));
+  int status = 0;
+  ASSERT_EQ(waitpid(pid, &status, 0), pid);
+  EXPECT_EQ(status, 0);
+  EXPECT_NE(parentRandom, childRandom);
+  close(fds[0]);
+  close(fds[1]);
+}
+
 TEST(RandomGeneratorTest, TestRandomUInt32) {
   useMockRandom();
 
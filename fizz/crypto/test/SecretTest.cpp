@@ -0,0 +1,64 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GTest.h>
+
+#include <fizz/crypto/Secret.h>
+
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+using namespace folly;
+
+namespace fizz {
+namespace test {
+
+TEST(SecretTest, TestConstruction) {
+  std::vector<uint8_t> vec{'s', 'e', 'c', 'r', 'e', 't'};
+  SecretStorage fromVector(vec);
+  SecretStorage fromRange(folly::range(vec));
+  SecretStorage fromPointers(vec.data(), vec.data() + vec.size());
+
+  EXPECT_EQ(fromVector.size(), vec.size());
+  EXPECT_EQ(fromVector, fromRange);
+  EXPECT_EQ(fromRange, fromPointers);
+  EXPECT_EQ(fromVector, vec);
+
+  SecretStorage empty;
+  EXPECT_TRUE(empty.empty());
+  EXPECT_NE(empty, fromVector);
+}
+
+TEST(SecretTest, TestResizeAndWrite) {
+  SecretStorage secret;
+  secret.resize(4);
+  EXPECT_EQ(secret.size(), 4);
+  std::memcpy(secret.data(), "abcd", 4);
+  EXPECT_EQ(secret, SecretStorage(ByteRange(StringPiece("abcd"))));
+}
+
+TEST(SecretTest, TestWipedOnDestruction) {
+  std::aligned_storage<sizeof(SecretStorage), alignof(SecretStorage)>::type
+      storage;
+  auto secret =
+      new (&storage) SecretStorage(ByteRange(StringPiece("topsecret")));
+  EXPECT_EQ(
+      StringPiece(ByteRange(secret->begin(), secret->end())),
+      StringPiece("topsecret"));
+  secret->~SecretStorage();
+
+  // The inline buffer is the first member; all of it must be zero after
+  // destruction.
+  auto raw = reinterpret_cast<const uint8_t*>(&storage);
+  for (size_t i = 0; i < SecretStorage::kMaxLength; i++) {
+    EXPECT_EQ(raw[i], 0);
+  }
+}
+} // namespace test
+} // namespace fizz
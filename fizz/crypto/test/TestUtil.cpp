@@ -8,6 +8,7 @@
 
 #include <fizz/crypto/test/TestUtil.h>
 
+#include <fizz/crypto/RandomGenerator.h>
 #include <folly/String.h>
 #include <folly/ssl/OpenSSLCertUtils.h>
 #include <sodium/randombytes.h>
@@ -68,6 +69,8 @@ static struct randombytes_implementation mockRandom = {
 
 void useMockRandom() {
   randombytes_set_implementation(&mockRandom);
+  // Drop anything buffered from the real implementation.
+  detail::BufferedRandom::clear();
 }
 } // namespace test
 } // namespace fizz
@@ -31,6 +31,26 @@ TEST(UtilsTest, TestEqual) {
   EXPECT_FALSE(CryptoUtils::equal(a, c));
 }
 
+// Exercises every width class of the comparison: the 16 byte blocks, the
+// 8 byte words, and the byte tail, with the difference at each offset.
+TEST(UtilsTest, TestEqualAllWidths) {
+  for (size_t size : {1, 7, 8, 9, 15, 16, 17, 31, 32, 48, 61}) {
+    std::vector<uint8_t> a(size, 0xa5);
+    std::vector<uint8_t> b(size, 0xa5);
+    EXPECT_TRUE(CryptoUtils::equal(range(a), range(b))) << size;
+    for (size_t i = 0; i < size; i++) {
+      b[i] ^= 0x01;
+      EXPECT_FALSE(CryptoUtils::equal(range(a), range(b)))
+          << size << " " << i;
+      b[i] ^= 0x01;
+    }
+  }
+}
+
+TEST(UtilsTest, TestEqualEmpty) {
+  EXPECT_TRUE(CryptoUtils::equal({}, {}));
+}
+
 TEST(UtilsTest, TestClean) {
   std::array<uint8_t, 8> a{'p', 'a', 's', 's', 'w', 'o', 'r', 'd'};
   CryptoUtils::clean(range(a));
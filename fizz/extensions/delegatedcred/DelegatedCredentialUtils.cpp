@@ -0,0 +1,81 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/extensions/delegatedcred/DelegatedCredentialUtils.h>
+
+#include <folly/ssl/OpenSSLPtrTypes.h>
+#include <openssl/x509.h>
+
+namespace fizz {
+namespace extensions {
+
+Buf DelegatedCredentialUtils::prepareDelegationData(
+    const DelegatedCredential& credential,
+    X509* cert) {
+  int len = i2d_X509(cert, nullptr);
+  if (len < 0) {
+    throw std::runtime_error("could not encode certificate");
+  }
+
+  auto data = folly::IOBuf::create(len + 32);
+  folly::io::Appender appender(data.get(), 32);
+  auto dest = data->writableTail();
+  if (i2d_X509(cert, &dest) != len) {
+    throw std::runtime_error("could not encode certificate");
+  }
+  data->append(len);
+
+  detail::write(credential.valid_time, appender);
+  detail::write(credential.expected_verify_scheme, appender);
+  detail::writeBuf<detail::bits24>(credential.public_key, appender);
+  detail::write(credential.credential_scheme, appender);
+  return data;
+}
+
+DelegatedCredential DelegatedCredentialUtils::generateCredential(
+    const SelfCert& cert,
+    const folly::ssl::EvpPkeyUniquePtr& credKey,
+    SignatureScheme expectedVerifyScheme,
+    SignatureScheme credentialScheme,
+    std::chrono::seconds validSeconds) {
+  DelegatedCredential credential;
+  credential.expected_verify_scheme = expectedVerifyScheme;
+  credential.credential_scheme = credentialScheme;
+
+  auto x509 = cert.getX509();
+
+  // valid_time is relative to the delegating cert's notBefore.
+  int days = 0;
+  int secs = 0;
+  if (ASN1_TIME_diff(&days, &secs, X509_get_notBefore(x509.get()), nullptr) !=
+      1) {
+    throw std::runtime_error("could not compute cert notBefore delta");
+  }
+  credential.valid_time = static_cast<uint32_t>(
+      static_cast<int64_t>(days) * 86400 + secs + validSeconds.count());
+
+  int len = i2d_PUBKEY(credKey.get(), nullptr);
+  if (len < 0) {
+    throw std::runtime_error("could not encode credential public key");
+  }
+  credential.public_key = folly::IOBuf::create(len);
+  auto dest = credential.public_key->writableTail();
+  if (i2d_PUBKEY(credKey.get(), &dest) != len) {
+    throw std::runtime_error("could not encode credential public key");
+  }
+  credential.public_key->append(len);
+
+  auto toSign = prepareDelegationData(credential, x509.get());
+  credential.signature = cert.sign(
+      credentialScheme,
+      CertificateVerifyContext::DelegatedCredential,
+      toSign->coalesce());
+  return credential;
+}
+} // namespace extensions
+} // namespace fizz
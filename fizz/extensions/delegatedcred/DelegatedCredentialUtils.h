@@ -0,0 +1,44 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/protocol/Certificate.h>
+#include <fizz/record/Extensions.h>
+
+namespace fizz {
+namespace extensions {
+
+class DelegatedCredentialUtils {
+ public:
+  /**
+   * Returns the buffer the delegation signature covers: the DER encoding
+   * of the delegating certificate followed by the credential fields and
+   * credential_scheme. The signature itself is made over this with the
+   * DelegatedCredential CertificateVerifyContext.
+   */
+  static Buf prepareDelegationData(
+      const DelegatedCredential& credential,
+      X509* cert);
+
+  /**
+   * Issues a credential delegating from cert's key to credKey's public
+   * key. The credential is valid for validSeconds from now,
+   * expectedVerifyScheme is the scheme the credential key will sign
+   * CertificateVerify with, and credentialScheme is the scheme cert signs
+   * the delegation with.
+   */
+  static DelegatedCredential generateCredential(
+      const SelfCert& cert,
+      const folly::ssl::EvpPkeyUniquePtr& credKey,
+      SignatureScheme expectedVerifyScheme,
+      SignatureScheme credentialScheme,
+      std::chrono::seconds validSeconds);
+};
+} // namespace extensions
+} // namespace fizz
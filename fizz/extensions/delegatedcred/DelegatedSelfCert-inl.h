@@ -0,0 +1,122 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+namespace fizz {
+namespace extensions {
+
+template <KeyType T>
+DelegatedSelfCertImpl<T>::DelegatedSelfCertImpl(
+    folly::ssl::EvpPkeyUniquePtr pkey,
+    std::shared_ptr<const SelfCert> parent,
+    DelegatedCredential credential)
+    : parent_(std::move(parent)), credential_(std::move(credential)) {
+  if (!parent_) {
+    throw std::runtime_error("Must supply a delegating cert");
+  }
+  signature_.setKey(std::move(pkey));
+}
+
+template <KeyType T>
+std::string DelegatedSelfCertImpl<T>::getIdentity() const {
+  return parent_->getIdentity();
+}
+
+template <KeyType T>
+std::vector<std::string> DelegatedSelfCertImpl<T>::getAltIdentities() const {
+  return parent_->getAltIdentities();
+}
+
+template <KeyType T>
+std::vector<SignatureScheme> DelegatedSelfCertImpl<T>::getSigSchemes() const {
+  return {credential_.expected_verify_scheme};
+}
+
+template <KeyType T>
+CertificateMsg DelegatedSelfCertImpl<T>::getCertMessage(
+    Buf certificateRequestContext) const {
+  auto msg = parent_->getCertMessage(std::move(certificateRequestContext));
+  if (msg.certificate_list.empty()) {
+    throw std::runtime_error("delegating cert has no certificates");
+  }
+  msg.certificate_list.front().extensions.push_back(
+      encodeExtension(credential_));
+  return msg;
+}
+
+template <KeyType T>
+Buf DelegatedSelfCertImpl<T>::getEncodedCertMessage() const {
+  folly::call_once(encodeOnce_, [this]() {
+    encodedCertMessage_ = encodeHandshake(getCertMessage());
+  });
+  return encodedCertMessage_->clone();
+}
+
+template <KeyType T>
+CompressedCertificate DelegatedSelfCertImpl<T>::getCompressedCert(
+    CertificateCompressionAlgorithm algo) const {
+  return CertUtils::cloneCompressedCert(compressedCerts_.at(algo));
+}
+
+template <KeyType T>
+void DelegatedSelfCertImpl<T>::precompressCert(
+    CertificateCompressor& compressor) {
+  compressedCerts_[compressor.getAlgorithm()] =
+      compressor.compress(getCertMessage());
+}
+
+template <>
+inline Buf DelegatedSelfCertImpl<KeyType::P256>::sign(
+    SignatureScheme scheme,
+    CertificateVerifyContext context,
+    folly::ByteRange toBeSigned) const {
+  auto signData = CertUtils::prepareSignData(context, toBeSigned);
+  switch (scheme) {
+    case SignatureScheme::ecdsa_secp256r1_sha256:
+      return signature_.sign<SignatureScheme::ecdsa_secp256r1_sha256>(
+          signData->coalesce());
+    default:
+      throw std::runtime_error("Unsupported signature scheme");
+  }
+}
+
+template <>
+inline Buf DelegatedSelfCertImpl<KeyType::P384>::sign(
+    SignatureScheme scheme,
+    CertificateVerifyContext context,
+    folly::ByteRange toBeSigned) const {
+  auto signData = CertUtils::prepareSignData(context, toBeSigned);
+  switch (scheme) {
+    case SignatureScheme::ecdsa_secp384r1_sha384:
+      return signature_.sign<SignatureScheme::ecdsa_secp384r1_sha384>(
+          signData->coalesce());
+    default:
+      throw std::runtime_error("Unsupported signature scheme");
+  }
+}
+
+template <>
+inline Buf DelegatedSelfCertImpl<KeyType::P521>::sign(
+    SignatureScheme scheme,
+    CertificateVerifyContext context,
+    folly::ByteRange toBeSigned) const {
+  auto signData = CertUtils::prepareSignData(context, toBeSigned);
+  switch (scheme) {
+    case SignatureScheme::ecdsa_secp521r1_sha512:
+      return signature_.sign<SignatureScheme::ecdsa_secp521r1_sha512>(
+          signData->coalesce());
+    default:
+      throw std::runtime_error("Unsupported signature scheme");
+  }
+}
+
+template <KeyType T>
+folly::ssl::X509UniquePtr DelegatedSelfCertImpl<T>::getX509() const {
+  return parent_->getX509();
+}
+} // namespace extensions
+} // namespace fizz
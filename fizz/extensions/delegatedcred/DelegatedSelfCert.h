@@ -0,0 +1,76 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/extensions/delegatedcred/DelegatedCredentialUtils.h>
+#include <fizz/protocol/Certificate.h>
+#include <folly/synchronization/CallOnce.h>
+
+namespace fizz {
+namespace extensions {
+
+/**
+ * SelfCert serving a delegated credential: the certificate chain is the
+ * delegating cert's, the leaf entry carries the credential in a
+ * delegated_credential extension, and CertificateVerify is signed with
+ * the (cheap, typically EC) credential key rather than the cert's key.
+ *
+ * T is the credential key's type. Only serve this cert to clients that
+ * advertised delegated_credential support with a compatible scheme.
+ */
+template <KeyType T>
+class DelegatedSelfCertImpl : public SelfCert {
+ public:
+  /**
+   * pkey is the credential's private key and must match the credential's
+   * public_key.
+   */
+  DelegatedSelfCertImpl(
+      folly::ssl::EvpPkeyUniquePtr pkey,
+      std::shared_ptr<const SelfCert> parent,
+      DelegatedCredential credential);
+
+  ~DelegatedSelfCertImpl() override = default;
+
+  std::string getIdentity() const override;
+
+  std::vector<std::string> getAltIdentities() const override;
+
+  std::vector<SignatureScheme> getSigSchemes() const override;
+
+  CertificateMsg getCertMessage(
+      Buf certificateRequestContext = nullptr) const override;
+
+  Buf getEncodedCertMessage() const override;
+
+  CompressedCertificate getCompressedCert(
+      CertificateCompressionAlgorithm algo) const override;
+
+  void precompressCert(CertificateCompressor& compressor) override;
+
+  Buf sign(
+      SignatureScheme scheme,
+      CertificateVerifyContext context,
+      folly::ByteRange toBeSigned) const override;
+
+  folly::ssl::X509UniquePtr getX509() const override;
+
+ private:
+  OpenSSLSignature<T> signature_;
+  std::shared_ptr<const SelfCert> parent_;
+  DelegatedCredential credential_;
+  mutable folly::once_flag encodeOnce_;
+  mutable Buf encodedCertMessage_;
+  std::map<CertificateCompressionAlgorithm, CompressedCertificate>
+      compressedCerts_;
+};
+} // namespace extensions
+} // namespace fizz
+
+#include <fizz/extensions/delegatedcred/DelegatedSelfCert-inl.h>
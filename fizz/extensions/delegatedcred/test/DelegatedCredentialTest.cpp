@@ -0,0 +1,117 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GTest.h>
+
+#include <fizz/crypto/test/TestUtil.h>
+#include <fizz/extensions/delegatedcred/DelegatedSelfCert.h>
+
+using namespace folly;
+
+namespace fizz {
+namespace extensions {
+namespace test {
+
+class DelegatedCredentialTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::vector<ssl::X509UniquePtr> certs;
+    certs.push_back(fizz::test::getCert(fizz::test::kRSACertificate));
+    parent_ = std::make_shared<SelfCertImpl<KeyType::RSA>>(
+        fizz::test::getPrivateKey(fizz::test::kRSAKey), std::move(certs));
+  }
+
+  DelegatedCredential generateCredential() {
+    auto credKey = fizz::test::getPrivateKey(fizz::test::kP256Key);
+    return DelegatedCredentialUtils::generateCredential(
+        *parent_,
+        credKey,
+        SignatureScheme::ecdsa_secp256r1_sha256,
+        SignatureScheme::rsa_pss_sha256,
+        std::chrono::seconds(3600));
+  }
+
+  std::shared_ptr<SelfCertImpl<KeyType::RSA>> parent_;
+  IOBufEqualTo eq_;
+};
+
+TEST_F(DelegatedCredentialTest, TestExtensionRoundTrip) {
+  auto credential = generateCredential();
+  auto ext = encodeExtension(credential);
+  EXPECT_EQ(ext.extension_type, ExtensionType::delegated_credential);
+
+  std::vector<Extension> extensions;
+  extensions.push_back(std::move(ext));
+  auto decoded = getExtension<DelegatedCredential>(extensions);
+  ASSERT_TRUE(decoded.hasValue());
+  EXPECT_EQ(decoded->valid_time, credential.valid_time);
+  EXPECT_EQ(
+      decoded->expected_verify_scheme, credential.expected_verify_scheme);
+  EXPECT_EQ(decoded->credential_scheme, credential.credential_scheme);
+  EXPECT_TRUE(eq_(decoded->public_key, credential.public_key));
+  EXPECT_TRUE(eq_(decoded->signature, credential.signature));
+}
+
+TEST_F(DelegatedCredentialTest, TestDelegationSignatureVerifies) {
+  auto credential = generateCredential();
+  auto x509 = parent_->getX509();
+  auto toBeSigned =
+      DelegatedCredentialUtils::prepareDelegationData(credential, x509.get());
+
+  PeerCertImpl<KeyType::RSA> peerCert(parent_->getX509());
+  peerCert.verify(
+      SignatureScheme::rsa_pss_sha256,
+      CertificateVerifyContext::DelegatedCredential,
+      toBeSigned->coalesce(),
+      credential.signature->coalesce());
+}
+
+TEST_F(DelegatedCredentialTest, TestDelegatedSelfCert) {
+  auto credential = generateCredential();
+  auto credentialPublicKey = credential.public_key->clone();
+  DelegatedSelfCertImpl<KeyType::P256> cert(
+      fizz::test::getPrivateKey(fizz::test::kP256Key),
+      parent_,
+      std::move(credential));
+
+  EXPECT_EQ(cert.getIdentity(), parent_->getIdentity());
+  EXPECT_EQ(
+      cert.getSigSchemes(),
+      std::vector<SignatureScheme>(
+          {SignatureScheme::ecdsa_secp256r1_sha256}));
+
+  // The leaf certificate entry carries the credential.
+  auto msg = cert.getCertMessage();
+  ASSERT_FALSE(msg.certificate_list.empty());
+  auto decoded = getExtension<DelegatedCredential>(
+      msg.certificate_list.front().extensions);
+  ASSERT_TRUE(decoded.hasValue());
+  EXPECT_TRUE(eq_(decoded->public_key, credentialPublicKey));
+
+  // CertificateVerify signatures verify against the credential key.
+  StringPiece tbs{"transcript"};
+  auto sig = cert.sign(
+      SignatureScheme::ecdsa_secp256r1_sha256,
+      CertificateVerifyContext::Server,
+      tbs);
+  auto keyRange = credentialPublicKey->coalesce();
+  const unsigned char* keyData = keyRange.data();
+  ssl::EvpPkeyUniquePtr pubKey(
+      d2i_PUBKEY(nullptr, &keyData, keyRange.size()));
+  ASSERT_NE(pubKey, nullptr);
+  OpenSSLSignature<KeyType::P256> verifier;
+  verifier.setKey(std::move(pubKey));
+  auto signData =
+      CertUtils::prepareSignData(CertificateVerifyContext::Server, tbs);
+  verifier.verify<SignatureScheme::ecdsa_secp256r1_sha256>(
+      signData->coalesce(), sig->coalesce());
+}
+
+} // namespace test
+} // namespace extensions
+} // namespace fizz
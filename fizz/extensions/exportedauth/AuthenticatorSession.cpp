@@ -0,0 +1,74 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/extensions/exportedauth/AuthenticatorSession.h>
+#include <fizz/protocol/OpenSSLFactory.h>
+
+namespace fizz {
+
+AuthenticatorSession::AuthenticatorSession(
+    const fizz::AsyncFizzBase& transport,
+    Direction dir)
+    : transport_(transport), dir_(dir) {
+  auto cipher = transport_.getCipher();
+  deriver_ = OpenSSLFactory().makeKeyDeriver(*cipher);
+  supportedSchemes_ = transport_.getSupportedSigSchemes();
+}
+
+void AuthenticatorSession::deriveSecrets(
+    Buf& handshakeContext,
+    Buf& finishedMacKey,
+    bool local) {
+  if (handshakeContext) {
+    return;
+  }
+  auto hashLength = deriver_->hashLength();
+  // Local authenticators use our own direction's labels, validation uses the
+  // peer's.
+  bool client = (dir_ == Direction::UPSTREAM) == local;
+  if (client) {
+    handshakeContext = transport_.getEkm(
+        "EXPORTER-client authenticator handshake context", nullptr, hashLength);
+    finishedMacKey = transport_.getEkm(
+        "EXPORTER-client authenticator finished key", nullptr, hashLength);
+  } else {
+    handshakeContext = transport_.getEkm(
+        "EXPORTER-server authenticator handshake context", nullptr, hashLength);
+    finishedMacKey = transport_.getEkm(
+        "EXPORTER-server authenticator finished key", nullptr, hashLength);
+  }
+}
+
+Buf AuthenticatorSession::getAuthenticator(
+    const SelfCert& cert,
+    Buf authenticatorRequest) {
+  deriveSecrets(localHandshakeContext_, localFinishedMacKey_, true);
+  return ExportedAuthenticator::makeAuthenticator(
+      deriver_,
+      supportedSchemes_,
+      cert,
+      std::move(authenticatorRequest),
+      localHandshakeContext_->clone(),
+      localFinishedMacKey_->clone(),
+      CertificateVerifyContext::Authenticator);
+}
+
+folly::Optional<std::vector<CertificateEntry>> AuthenticatorSession::validate(
+    Buf authenticatorRequest,
+    Buf authenticator) {
+  deriveSecrets(peerHandshakeContext_, peerFinishedMacKey_, false);
+  return ExportedAuthenticator::validate(
+      deriver_,
+      std::move(authenticatorRequest),
+      std::move(authenticator),
+      peerHandshakeContext_->clone(),
+      peerFinishedMacKey_->clone(),
+      CertificateVerifyContext::Authenticator);
+}
+
+} // namespace fizz
@@ -0,0 +1,66 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/extensions/exportedauth/ExportedAuthenticator.h>
+
+namespace fizz {
+
+/**
+ * Caches the per-connection inputs to exported authenticator construction
+ * and validation. ExportedAuthenticator::getAuthenticator and
+ * validateAuthenticator rederive the handshake context and finished MAC key
+ * from the exporter master secret on every call; those values are fixed for
+ * the lifetime of a connection, so applications that authenticate the same
+ * connection repeatedly (for example HTTP/2 secondary certificate
+ * authentication against several realms) can hold one session per connection
+ * and make the marginal cost of each additional authenticator the signature
+ * plus transcript hashing rather than a full set of exporter derivations.
+ *
+ * The transport must remain alive while the session is in use. Secrets for
+ * each direction are derived lazily on first use.
+ */
+class AuthenticatorSession {
+ public:
+  /**
+   * |dir| is the direction authenticators produced by this session travel
+   * in; validate() assumes authenticators arriving from the opposite
+   * direction.
+   */
+  AuthenticatorSession(const fizz::AsyncFizzBase& transport, Direction dir);
+
+  /**
+   * Constructs an authenticator as ExportedAuthenticator::getAuthenticator
+   * would, using the cached secrets.
+   */
+  Buf getAuthenticator(const SelfCert& cert, Buf authenticatorRequest);
+
+  /**
+   * Validates an authenticator received from the peer as
+   * ExportedAuthenticator::validateAuthenticator would, using the cached
+   * secrets.
+   */
+  folly::Optional<std::vector<CertificateEntry>> validate(
+      Buf authenticatorRequest,
+      Buf authenticator);
+
+ private:
+  void deriveSecrets(Buf& handshakeContext, Buf& finishedMacKey, bool local);
+
+  const fizz::AsyncFizzBase& transport_;
+  Direction dir_;
+  std::unique_ptr<KeyDerivation> deriver_;
+  std::vector<SignatureScheme> supportedSchemes_;
+  Buf localHandshakeContext_;
+  Buf localFinishedMacKey_;
+  Buf peerHandshakeContext_;
+  Buf peerFinishedMacKey_;
+};
+
+} // namespace fizz
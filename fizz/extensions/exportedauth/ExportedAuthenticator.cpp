@@ -6,6 +6,7 @@
  *  LICENSE file in the root directory of this source tree.
  */
 
+#include <fizz/crypto/Utils.h>
 #include <fizz/extensions/exportedauth/ExportedAuthenticator.h>
 #include <fizz/extensions/exportedauth/Util.h>
 #include <fizz/protocol/OpenSSLFactory.h>
@@ -65,7 +66,10 @@ Buf ExportedAuthenticator::getAuthenticatorContext(Buf authenticator) {
   folly::IOBufQueue authQueue{folly::IOBufQueue::cacheChainLength()};
   authQueue.append(std::move(authenticator));
   auto param = fizz::ReadRecordLayer::decodeHandshakeMessage(authQueue);
-  auto& certMsg = boost::get<CertificateMsg>(*param);
+  if (param.hasError()) {
+    throw std::runtime_error(param.error().message);
+  }
+  auto& certMsg = boost::get<CertificateMsg>(**param);
   return std::move(certMsg.certificate_request_context);
 }
 
@@ -134,23 +138,68 @@ Buf ExportedAuthenticator::makeAuthenticator(
       handshakeContext, authenticatorRequest, encodedCertMsg);
   auto transcriptHash = detail::computeTranscriptHash(kderiver, transcript);
   auto sig = cert.sign(*scheme, context, transcriptHash->coalesce());
-  CertificateVerify verify;
-  verify.algorithm = *scheme;
-  verify.signature = std::move(sig);
-  auto encodedCertificateVerify = encodeHandshake(std::move(verify));
-  // Compute Finished.
-  auto finishedTranscript =
-      detail::computeFinishedTranscript(transcript, encodedCertificateVerify);
-  auto finishedTranscriptHash =
-      detail::computeTranscriptHash(kderiver, finishedTranscript);
-  auto verifyData =
-      detail::getFinishedData(kderiver, finishedMacKey, finishedTranscriptHash);
-  Finished finished;
-  finished.verify_data = std::move(verifyData);
-  auto encodedFinished = encodeHandshake(std::move(finished));
+  return detail::finishAuthenticator(
+      kderiver,
+      *scheme,
+      std::move(sig),
+      std::move(encodedCertMsg),
+      std::move(transcript),
+      std::move(finishedMacKey));
+}
 
-  return detail::computeTranscript(
-      encodedCertMsg, encodedCertificateVerify, encodedFinished);
+folly::Future<Buf> ExportedAuthenticator::makeAuthenticatorAsync(
+    std::unique_ptr<KeyDerivation> kderiver,
+    std::vector<SignatureScheme> supportedSchemes,
+    std::shared_ptr<const AsyncSelfCert> cert,
+    Buf authenticatorRequest,
+    Buf handshakeContext,
+    Buf finishedMacKey,
+    CertificateVerifyContext context) {
+  Buf certificateRequestContext;
+  std::vector<fizz::Extension> extensions;
+  std::tie(certificateRequestContext, extensions) =
+      detail::decodeAuthRequest(authenticatorRequest);
+  folly::Optional<SignatureScheme> scheme =
+      detail::getSignatureScheme(supportedSchemes, *cert, extensions);
+  // No proper signature scheme could be selected, return an empty
+  // authenticator.
+  if (!scheme) {
+    return folly::makeFuture(detail::getEmptyAuthenticator(
+        kderiver,
+        std::move(authenticatorRequest),
+        std::move(handshakeContext),
+        std::move(finishedMacKey)));
+  }
+  CertificateMsg certificate =
+      cert->getCertMessage(std::move(certificateRequestContext));
+  auto encodedCertMsg = encodeHandshake(std::move(certificate));
+  auto transcript = detail::computeTranscript(
+      handshakeContext, authenticatorRequest, encodedCertMsg);
+  auto transcriptHash = detail::computeTranscriptHash(kderiver, transcript);
+  auto sigFuture =
+      cert->signFuture(*scheme, context, transcriptHash->coalesce());
+  return std::move(sigFuture)
+      .thenValue([kderiver = std::move(kderiver),
+                  cert = std::move(cert),
+                  scheme = *scheme,
+                  encodedCertMsg = std::move(encodedCertMsg),
+                  transcript = std::move(transcript),
+                  transcriptHash = std::move(transcriptHash),
+                  finishedMacKey = std::move(finishedMacKey)](
+                     folly::Optional<Buf> sig) mutable {
+        if (!sig) {
+          throw FizzException(
+              "failed to sign authenticator",
+              AlertDescription::internal_error);
+        }
+        return detail::finishAuthenticator(
+            kderiver,
+            scheme,
+            std::move(*sig),
+            std::move(encodedCertMsg),
+            std::move(transcript),
+            std::move(finishedMacKey));
+      });
 }
 
 folly::Optional<std::vector<CertificateEntry>> ExportedAuthenticator::validate(
@@ -168,11 +217,11 @@ folly::Optional<std::vector<CertificateEntry>> ExportedAuthenticator::validate(
   auto authClone = authenticator->clone();
   authQueue.append(std::move(authenticator));
   auto param = fizz::ReadRecordLayer::decodeHandshakeMessage(authQueue);
-  if (!param) {
+  if (param.hasError() || !param->hasValue()) {
     return folly::none;
   }
   // First check if the authenticator is empty.
-  auto finished = boost::get<Finished>(&(*param));
+  auto finished = boost::get<Finished>(&(**param));
   if (finished) {
     auto emptyAuth = detail::getEmptyAuthenticator(
         kderiver,
@@ -186,16 +235,16 @@ folly::Optional<std::vector<CertificateEntry>> ExportedAuthenticator::validate(
     }
   }
   auto param2 = fizz::ReadRecordLayer::decodeHandshakeMessage(authQueue);
-  if (!param2) {
+  if (param2.hasError() || !param2->hasValue()) {
     return folly::none;
   }
   auto param3 = fizz::ReadRecordLayer::decodeHandshakeMessage(authQueue);
-  if (!param3) {
+  if (param3.hasError() || !param3->hasValue()) {
     return folly::none;
   }
-  auto certMsg = boost::get<CertificateMsg>(&(*param));
-  auto certVerify = boost::get<CertificateVerify>(&(*param2));
-  finished = boost::get<Finished>(&(*param3));
+  auto certMsg = boost::get<CertificateMsg>(&(**param));
+  auto certVerify = boost::get<CertificateVerify>(&(**param2));
+  finished = boost::get<Finished>(&(**param3));
   if (!certMsg || !certVerify || !finished) {
     return folly::none;
   }
@@ -226,7 +275,8 @@ folly::Optional<std::vector<CertificateEntry>> ExportedAuthenticator::validate(
   auto verifyData =
       detail::getFinishedData(kderiver, finishedMacKey, finishedTranscriptHash);
 
-  if (folly::IOBufEqualTo()(finished->verify_data, verifyData)) {
+  if (CryptoUtils::equal(
+          finished->verify_data->coalesce(), verifyData->coalesce())) {
     certs = std::move(certMsg->certificate_list);
     return certs;
   } else {
@@ -359,6 +409,32 @@ folly::Optional<SignatureScheme> getSignatureScheme(
   return selectedScheme;
 }
 
+Buf finishAuthenticator(
+    std::unique_ptr<KeyDerivation>& kderiver,
+    SignatureScheme scheme,
+    Buf signature,
+    Buf encodedCertMsg,
+    Buf transcript,
+    Buf finishedMacKey) {
+  CertificateVerify verify;
+  verify.algorithm = scheme;
+  verify.signature = std::move(signature);
+  auto encodedCertificateVerify = encodeHandshake(std::move(verify));
+  // Compute Finished.
+  auto finishedTranscript =
+      detail::computeFinishedTranscript(transcript, encodedCertificateVerify);
+  auto finishedTranscriptHash =
+      detail::computeTranscriptHash(kderiver, finishedTranscript);
+  auto verifyData =
+      detail::getFinishedData(kderiver, finishedMacKey, finishedTranscriptHash);
+  Finished finished;
+  finished.verify_data = std::move(verifyData);
+  auto encodedFinished = encodeHandshake(std::move(finished));
+
+  return detail::computeTranscript(
+      encodedCertMsg, encodedCertificateVerify, encodedFinished);
+}
+
 Buf getEmptyAuthenticator(
     std::unique_ptr<KeyDerivation>& kderiver,
     Buf authRequest,
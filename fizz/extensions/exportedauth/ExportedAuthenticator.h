@@ -9,6 +9,7 @@
 #pragma once
 
 #include <fizz/protocol/AsyncFizzBase.h>
+#include <fizz/protocol/AsyncSelfCert.h>
 #include <fizz/protocol/Certificate.h>
 #include <fizz/protocol/Exporter.h>
 #include <fizz/protocol/Protocol.h>
@@ -66,6 +67,22 @@ class ExportedAuthenticator {
       Buf finishedMacKey,
       CertificateVerifyContext context);
 
+  /**
+   * As makeAuthenticator, but signs through AsyncSelfCert::signFuture so the
+   * signature can be offloaded to the same signing pool used for handshake
+   * CertificateVerify messages. The key deriver and certificate are kept
+   * alive by the returned future. The future fails with a FizzException if
+   * the certificate declines to sign.
+   */
+  static folly::Future<Buf> makeAuthenticatorAsync(
+      std::unique_ptr<KeyDerivation> kderiver,
+      std::vector<SignatureScheme> supportedSchemes,
+      std::shared_ptr<const AsyncSelfCert> cert,
+      Buf authenticatorRequest,
+      Buf handshakeContext,
+      Buf finishedMacKey,
+      CertificateVerifyContext context);
+
   /**
    * "get context" API
    *
@@ -50,5 +50,13 @@ Buf getEmptyAuthenticator(
     Buf handshakeContext,
     Buf finishedMacKey);
 
+Buf finishAuthenticator(
+    std::unique_ptr<KeyDerivation>& kderiver,
+    SignatureScheme scheme,
+    Buf signature,
+    Buf encodedCertMsg,
+    Buf transcript,
+    Buf finishedMacKey);
+
 } // namespace detail
 } // namespace fizz
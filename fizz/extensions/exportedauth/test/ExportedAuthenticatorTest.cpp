@@ -10,6 +10,7 @@
 #include <folly/portability/GTest.h>
 
 #include <fizz/crypto/test/TestUtil.h>
+#include <fizz/extensions/exportedauth/AuthenticatorSession.h>
 #include <fizz/extensions/exportedauth/ExportedAuthenticator.h>
 #include <fizz/protocol/test/Mocks.h>
 #include <fizz/protocol/test/TestMessages.h>
@@ -116,6 +117,35 @@ TEST_F(AuthenticatorTest, TestValidAuthenticator) {
       (StringPiece(hexlify(reencodedAuthenticator->coalesce()))));
 }
 
+TEST_F(AuthenticatorTest, TestValidAuthenticatorAsync) {
+  auto mockCert = std::make_shared<MockAsyncSelfCert>();
+  EXPECT_CALL(*mockCert, _getCertMessage(_)).WillOnce(InvokeWithoutArgs([]() {
+    return TestMessages::certificate();
+  }));
+  EXPECT_CALL(*mockCert, getSigSchemes())
+      .WillOnce(Return(std::vector<SignatureScheme>(
+          1, SignatureScheme::ecdsa_secp256r1_sha256)));
+  EXPECT_CALL(
+      *mockCert, signFuture(_, CertificateVerifyContext::Authenticator, _))
+      .WillOnce(InvokeWithoutArgs([]() {
+        return folly::makeFuture<folly::Optional<Buf>>(
+            IOBuf::copyBuffer("signature"));
+      }));
+
+  auto authenticatorFuture = ExportedAuthenticator::makeAuthenticatorAsync(
+      std::move(deriver_),
+      schemes_,
+      mockCert,
+      std::move(authrequest_),
+      std::move(handshakeContext_),
+      std::move(finishedKey_),
+      CertificateVerifyContext::Authenticator);
+  auto reencodedAuthenticator = std::move(authenticatorFuture).get();
+  EXPECT_EQ(
+      expected_authenticator,
+      (StringPiece(hexlify(reencodedAuthenticator->coalesce()))));
+}
+
 TEST_F(AuthenticatorTest, TestEmptyAuthenticator) {
   auto mockCert = std::make_shared<MockSelfCert>();
   EXPECT_CALL(*mockCert, getSigSchemes())
@@ -237,5 +267,56 @@ TEST_F(ValidateAuthenticatorTest, TestValidateEmptyAuthenticator) {
   EXPECT_EQ((*decodedCerts).size(), 0);
 }
 
+TEST_F(ValidateAuthenticatorTest, TestAuthenticatorSessionCachesSecrets) {
+  auto cert = fizz::test::getCert(kP256Certificate);
+  auto key = fizz::test::getPrivateKey(kP256Key);
+  std::vector<folly::ssl::X509UniquePtr> certs;
+  certs.push_back(std::move(cert));
+  SelfCertImpl<KeyType::P256> certificate(std::move(key), std::move(certs));
+
+  MockAsyncFizzBase transport;
+  EXPECT_CALL(transport, getCipher())
+      .WillOnce(Return(CipherSuite::TLS_AES_128_GCM_SHA256));
+  EXPECT_CALL(transport, getSupportedSigSchemes()).WillOnce(Return(schemes_));
+  // The exporter derivations must run only once even though two
+  // authenticators are produced.
+  EXPECT_CALL(
+      transport,
+      getEkm(
+          StringPiece("EXPORTER-client authenticator handshake context"),
+          _,
+          _))
+      .WillOnce(InvokeWithoutArgs([this]() {
+        return folly::IOBuf::copyBuffer(unhexlify(handshakeContext_));
+      }));
+  EXPECT_CALL(
+      transport,
+      getEkm(StringPiece("EXPORTER-client authenticator finished key"), _, _))
+      .WillOnce(InvokeWithoutArgs([this]() {
+        return folly::IOBuf::copyBuffer(unhexlify(finishedKey_));
+      }));
+
+  AuthenticatorSession session(transport, Direction::UPSTREAM);
+  auto authenticator = session.getAuthenticator(
+      certificate, folly::IOBuf::copyBuffer(unhexlify(authrequest_)));
+  auto secondAuthenticator = session.getAuthenticator(
+      certificate, folly::IOBuf::copyBuffer(unhexlify(authrequest_)));
+  EXPECT_TRUE(secondAuthenticator);
+
+  auto authenticatorRequest = folly::IOBuf::copyBuffer(unhexlify(authrequest_));
+  auto handshakeContext =
+      folly::IOBuf::copyBuffer(unhexlify(handshakeContext_));
+  auto finishedMacKey = folly::IOBuf::copyBuffer(unhexlify(finishedKey_));
+  auto decodedCerts = ExportedAuthenticator::validate(
+      deriver_,
+      std::move(authenticatorRequest),
+      std::move(authenticator),
+      std::move(handshakeContext),
+      std::move(finishedMacKey),
+      CertificateVerifyContext::Authenticator);
+  EXPECT_TRUE(decodedCerts.hasValue());
+  EXPECT_EQ((*decodedCerts).size(), 1);
+}
+
 } // namespace test
 } // namespace fizz
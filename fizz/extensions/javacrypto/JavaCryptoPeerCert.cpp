@@ -8,6 +8,7 @@
 
 #include <fizz/extensions/javacrypto/JavaCryptoPeerCert.h>
 #include <fizz/extensions/javacrypto/JniUtils.h>
+#include <folly/io/IOBufQueue.h>
 
 namespace fizz {
 
@@ -16,6 +17,18 @@ jclass clazz;
 jmethodID constructor;
 jmethodID getIdentityMethod;
 jmethodID verifyMethod;
+// Optional fast-path methods; nullptr when the Java side predates them.
+jmethodID verifyDirectMethod;
+jmethodID verifyBatchMethod;
+
+std::string schemeToAlgorithm(SignatureScheme scheme) {
+  switch (scheme) {
+    case SignatureScheme::ecdsa_secp256r1_sha256:
+      return "SHA256withECDSA";
+    default:
+      throw std::runtime_error("Unsupported signature scheme");
+  }
+}
 } // namespace
 
 void JavaCryptoPeerCert::onLoad(JNIEnv* env) {
@@ -25,6 +38,16 @@ void JavaCryptoPeerCert::onLoad(JNIEnv* env) {
       jni::getMethodID(env, clazz, "getIdentity", "()Ljava/lang/String;");
   verifyMethod =
       jni::getMethodID(env, clazz, "verify", "(Ljava/lang/String;[B[B)V");
+  verifyDirectMethod = jni::maybeGetMethodID(
+      env,
+      clazz,
+      "verifyDirect",
+      "(Ljava/lang/String;Ljava/nio/ByteBuffer;Ljava/nio/ByteBuffer;)V");
+  verifyBatchMethod = jni::maybeGetMethodID(
+      env,
+      clazz,
+      "verifyBatch",
+      "(Ljava/lang/String;Ljava/nio/ByteBuffer;[I)V");
 }
 
 JavaCryptoPeerCert::JavaCryptoPeerCert(Buf certData) {
@@ -61,24 +84,81 @@ void JavaCryptoPeerCert::verify(
   bool shouldDetach;
   auto env = jni::getEnv(&shouldDetach);
 
-  std::string algorithm;
-  switch (scheme) {
-    case SignatureScheme::ecdsa_secp256r1_sha256:
-      algorithm = "SHA256withECDSA";
-      break;
-    default:
-      throw std::runtime_error("Unsupported signature scheme");
-  }
+  auto algorithm = schemeToAlgorithm(scheme);
   auto jAlgorithm = env->NewStringUTF(algorithm.c_str());
   auto signData = CertUtils::prepareSignData(context, toBeSigned);
-  auto jSignData = jni::createByteArray(env, std::move(signData));
-  auto jSignature = jni::createByteArray(env, signature);
+
+  if (verifyDirectMethod) {
+    // Zero-copy path: wrap the native buffers as direct ByteBuffers. They
+    // stay alive until after the call returns.
+    auto jSignData =
+        jni::createDirectByteBuffer(env, signData->coalesce());
+    auto jSignature = jni::createDirectByteBuffer(env, signature);
+    env->CallObjectMethod(
+        jobject_, verifyDirectMethod, jAlgorithm, jSignData, jSignature);
+    env->DeleteLocalRef(jSignature);
+    env->DeleteLocalRef(jSignData);
+  } else {
+    auto jSignData = jni::createByteArray(env, std::move(signData));
+    auto jSignature = jni::createByteArray(env, signature);
+    env->CallObjectMethod(
+        jobject_, verifyMethod, jAlgorithm, jSignData, jSignature);
+    env->DeleteLocalRef(jSignature);
+    env->DeleteLocalRef(jSignData);
+  }
+  env->DeleteLocalRef(jAlgorithm);
+
+  jni::maybeThrowException(env, shouldDetach);
+  jni::releaseEnv(shouldDetach);
+}
+
+void JavaCryptoPeerCert::verifyBatch(
+    SignatureScheme scheme,
+    CertificateVerifyContext context,
+    const std::vector<std::pair<folly::ByteRange, folly::ByteRange>>& jobs)
+    const {
+  if (jobs.empty()) {
+    return;
+  }
+  if (!verifyBatchMethod) {
+    // Java side predates the batch interface; fall back to one crossing per
+    // signature.
+    for (const auto& job : jobs) {
+      verify(scheme, context, job.first, job.second);
+    }
+    return;
+  }
+
+  bool shouldDetach;
+  auto env = jni::getEnv(&shouldDetach);
+
+  auto algorithm = schemeToAlgorithm(scheme);
+  auto jAlgorithm = env->NewStringUTF(algorithm.c_str());
+
+  // Pack all sign data and signatures into one contiguous buffer passed as
+  // a single direct ByteBuffer, with a length array describing the layout:
+  // lengths[2i] bytes of sign data followed by lengths[2i+1] bytes of
+  // signature for each job.
+  folly::IOBufQueue packed{folly::IOBufQueue::cacheChainLength()};
+  std::vector<jint> lengths;
+  lengths.reserve(jobs.size() * 2);
+  for (const auto& job : jobs) {
+    auto signData = CertUtils::prepareSignData(context, job.first);
+    lengths.push_back(signData->computeChainDataLength());
+    packed.append(std::move(signData));
+    lengths.push_back(job.second.size());
+    packed.append(folly::IOBuf::copyBuffer(job.second));
+  }
+  auto packedBuf = packed.move();
+  auto jPacked = jni::createDirectByteBuffer(env, packedBuf->coalesce());
+  auto jLengths = env->NewIntArray(lengths.size());
+  env->SetIntArrayRegion(jLengths, 0, lengths.size(), lengths.data());
 
   env->CallObjectMethod(
-      jobject_, verifyMethod, jAlgorithm, jSignData, jSignature);
+      jobject_, verifyBatchMethod, jAlgorithm, jPacked, jLengths);
 
-  env->DeleteLocalRef(jSignature);
-  env->DeleteLocalRef(jSignData);
+  env->DeleteLocalRef(jLengths);
+  env->DeleteLocalRef(jPacked);
   env->DeleteLocalRef(jAlgorithm);
 
   jni::maybeThrowException(env, shouldDetach);
@@ -35,6 +35,18 @@ class JavaCryptoPeerCert : public PeerCert {
       folly::ByteRange toBeSigned,
       folly::ByteRange signature) const override;
 
+  /**
+   * Verifies several (toBeSigned, signature) pairs in a single JNI crossing
+   * when the Java side provides verifyBatch, falling back to per-signature
+   * calls otherwise. All pairs use the same scheme and context. Throws if
+   * any signature fails to verify.
+   */
+  void verifyBatch(
+      SignatureScheme scheme,
+      CertificateVerifyContext context,
+      const std::vector<std::pair<folly::ByteRange, folly::ByteRange>>& jobs)
+      const;
+
   folly::ssl::X509UniquePtr getX509() const override;
 
  private:
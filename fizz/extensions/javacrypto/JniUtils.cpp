@@ -83,5 +83,26 @@ jbyteArray createByteArray(JNIEnv* env, Buf buf) {
   return createByteArray(env, buf->coalesce());
 }
 
+jmethodID maybeGetMethodID(
+    JNIEnv* env,
+    jclass clazz,
+    const std::string& name,
+    const std::string& signature) {
+  auto methodId = env->GetMethodID(clazz, name.c_str(), signature.c_str());
+  if (!methodId) {
+    env->ExceptionClear();
+  }
+  return methodId;
+}
+
+jobject createDirectByteBuffer(JNIEnv* env, folly::ByteRange byteRange) {
+  // NewDirectByteBuffer takes a mutable pointer; the Java side must not
+  // write through it.
+  auto buffer = env->NewDirectByteBuffer(
+      const_cast<uint8_t*>(byteRange.data()), byteRange.size());
+  CHECK(buffer);
+  return buffer;
+}
+
 } // namespace jni
 } // namespace fizz
@@ -33,5 +33,23 @@ void maybeThrowException(JNIEnv* env, bool shouldDetach);
 jbyteArray createByteArray(JNIEnv* env, folly::ByteRange byteRange);
 jbyteArray createByteArray(JNIEnv* env, Buf buf);
 
+/**
+ * As getMethodID, but returns nullptr instead of aborting when the method
+ * does not exist, clearing the pending NoSuchMethodError. Used to probe for
+ * optional fast-path methods on the Java side.
+ */
+jmethodID maybeGetMethodID(
+    JNIEnv* env,
+    jclass clazz,
+    const std::string& name,
+    const std::string& signature);
+
+/**
+ * Wraps native memory as a direct ByteBuffer without copying. The memory
+ * must stay alive and unmodified for the duration of the Java call, and the
+ * Java side must treat the buffer as read only.
+ */
+jobject createDirectByteBuffer(JNIEnv* env, folly::ByteRange byteRange);
+
 } // namespace jni
 } // namespace fizz
@@ -0,0 +1,112 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/extensions/tokenbinding/CachingValidator.h>
+
+namespace fizz {
+namespace extensions {
+
+namespace {
+void appendBuf(std::string& out, const Buf& buf) {
+  if (!buf) {
+    return;
+  }
+  auto current = buf.get();
+  size_t chainElements = buf->countChainElements();
+  for (size_t i = 0; i < chainElements; ++i) {
+    out.append(
+        reinterpret_cast<const char*>(current->data()), current->length());
+    current = current->next();
+  }
+}
+} // namespace
+
+CachingValidator::CachingValidator(size_t maxCachedBindings)
+    : cache_(BindingMap(maxCachedBindings)) {}
+
+std::string CachingValidator::cacheKey(const TokenBinding& tokenBinding) {
+  std::string key;
+  key.push_back(static_cast<char>(tokenBinding.tokenbinding_type));
+  key.push_back(
+      static_cast<char>(tokenBinding.tokenbindingid.key_parameters));
+  appendBuf(key, tokenBinding.tokenbindingid.key);
+  appendBuf(key, tokenBinding.signature);
+  return key;
+}
+
+TokenBindingID CachingValidator::cloneId(const TokenBindingID& id) {
+  TokenBindingID clone;
+  clone.key_parameters = id.key_parameters;
+  clone.key = id.key->clone();
+  return clone;
+}
+
+folly::Optional<TokenBindingID> CachingValidator::cachedId(
+    const std::string& key) {
+  auto cacheMap = cache_.wlock();
+  auto result = cacheMap->find(key);
+  if (result == cacheMap->end()) {
+    return folly::none;
+  }
+  return cloneId(result->second);
+}
+
+void CachingValidator::cacheId(
+    const std::string& key,
+    const TokenBindingID& id) {
+  cache_.wlock()->set(key, cloneId(id));
+}
+
+folly::Optional<TokenBindingID> CachingValidator::validateTokenBinding(
+    TokenBinding tokenBinding,
+    const Buf& ekm,
+    const TokenBindingKeyParameters& negotiatedParameters) {
+  auto key = cacheKey(tokenBinding);
+  auto cached = cachedId(key);
+  if (cached) {
+    return cached;
+  }
+  auto id = Validator::validateTokenBinding(
+      std::move(tokenBinding), ekm, negotiatedParameters);
+  if (id) {
+    cacheId(key, *id);
+  }
+  return id;
+}
+
+folly::Future<folly::Optional<TokenBindingID>>
+CachingValidator::validateTokenBindingAsync(
+    TokenBinding tokenBinding,
+    const Buf& ekm,
+    const TokenBindingKeyParameters& negotiatedParameters,
+    std::shared_ptr<BatchSignatureVerifier> verifier) {
+  auto key = cacheKey(tokenBinding);
+  auto cached = cachedId(key);
+  if (cached) {
+    return folly::makeFuture(std::move(cached));
+  }
+  auto binding = std::make_shared<TokenBinding>(std::move(tokenBinding));
+  auto result = std::make_shared<folly::Optional<TokenBindingID>>();
+  auto ekmClone = ekm->clone();
+  return verifier
+      ->addJob([binding,
+                result,
+                ekmClone = std::move(ekmClone),
+                negotiatedParameters]() mutable {
+        *result = Validator::validateTokenBinding(
+            std::move(*binding), ekmClone, negotiatedParameters);
+      })
+      .thenValue([this, key = std::move(key), result](folly::Unit) {
+        if (*result) {
+          cacheId(key, **result);
+        }
+        return std::move(*result);
+      });
+}
+} // namespace extensions
+} // namespace fizz
@@ -0,0 +1,66 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/crypto/signature/BatchSignatureVerifier.h>
+#include <fizz/extensions/tokenbinding/Validator.h>
+#include <folly/Synchronized.h>
+#include <folly/container/EvictingCacheMap.h>
+
+namespace fizz {
+namespace extensions {
+
+/**
+ * Per-connection token binding validator that caches successful
+ * validations. The (EKM, key, signature) triple carried by a TokenBinding
+ * header is fixed for a connection's lifetime, so after the first ECDSA
+ * verification repeat requests on the connection are answered from a
+ * bounded LRU cache keyed by the binding's bytes. Since the EKM is fixed
+ * per connection, it does not participate in the key; do not share one
+ * validator across connections.
+ *
+ * Failed validations are not cached.
+ */
+class CachingValidator {
+ public:
+  explicit CachingValidator(size_t maxCachedBindings = 32);
+
+  /**
+   * As Validator::validateTokenBinding, consulting the cache first.
+   */
+  folly::Optional<TokenBindingID> validateTokenBinding(
+      TokenBinding tokenBinding,
+      const Buf& ekm,
+      const TokenBindingKeyParameters& negotiatedParameters);
+
+  /**
+   * As validateTokenBinding, but cache misses run their signature
+   * verification on the given batch verifier's executor rather than the
+   * calling thread. The future may complete on that executor; callers
+   * on an event base should via() it back.
+   */
+  folly::Future<folly::Optional<TokenBindingID>> validateTokenBindingAsync(
+      TokenBinding tokenBinding,
+      const Buf& ekm,
+      const TokenBindingKeyParameters& negotiatedParameters,
+      std::shared_ptr<BatchSignatureVerifier> verifier);
+
+ private:
+  using BindingMap = folly::EvictingCacheMap<std::string, TokenBindingID>;
+
+  static std::string cacheKey(const TokenBinding& tokenBinding);
+  static TokenBindingID cloneId(const TokenBindingID& id);
+
+  folly::Optional<TokenBindingID> cachedId(const std::string& key);
+  void cacheId(const std::string& key, const TokenBindingID& id);
+
+  folly::Synchronized<BindingMap> cache_;
+};
+} // namespace extensions
+} // namespace fizz
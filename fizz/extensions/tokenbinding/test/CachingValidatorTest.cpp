@@ -0,0 +1,106 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GTest.h>
+
+#include <fizz/extensions/tokenbinding/CachingValidator.h>
+#include <folly/executors/ManualExecutor.h>
+
+using namespace folly;
+
+namespace fizz {
+namespace extensions {
+namespace test {
+
+// Test values from using chrome to hit my sandbox
+StringPiece cached_session_ekm{
+    "9d20b2acf86f893a240642593cfc53102b9fb76b37f059d4bff47a0e6fee25e7"};
+StringPiece cached_session_key{
+    "40dd2fa2430a0f54ca96454bdf23c264353a252812bc5fa7b851a6fa9d620424bf43e20e50a4ca0a1769f4024db346ca5075eecdb7f62d0018cf1642b75f679d98"};
+StringPiece cached_session_signature{
+    "d2c9c04957013f38369a18a5d5b47d6492f0f0f5c8772a27cc3770f23dda94d30fc3a6d0dc110c78e668a44c3b8b61842a6e72795f61f51f398f8dedd2ceb9a3"};
+
+class CachingValidatorTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    OpenSSL_add_all_algorithms();
+    ekm_ = getBuf(cached_session_ekm);
+  }
+
+  TokenBinding makeBinding() {
+    TokenBinding tokenBinding;
+    tokenBinding.tokenbinding_type = TokenBindingType::provided_token_binding;
+    tokenBinding.extensions = folly::IOBuf::create(0);
+    TokenBindingID id;
+    id.key_parameters = TokenBindingKeyParameters::ecdsap256;
+    id.key = getBuf(cached_session_key);
+    tokenBinding.tokenbindingid = std::move(id);
+    tokenBinding.signature = getBuf(cached_session_signature);
+    return tokenBinding;
+  }
+
+  Buf getBuf(StringPiece hex) {
+    auto data = unhexlify(hex);
+    return folly::IOBuf::copyBuffer(data.data(), data.size());
+  }
+
+  Buf ekm_;
+};
+
+TEST_F(CachingValidatorTest, TestCachedValidation) {
+  CachingValidator validator;
+  auto id = validator.validateTokenBinding(
+      makeBinding(), ekm_, TokenBindingKeyParameters::ecdsap256);
+  EXPECT_TRUE(id.hasValue());
+
+  // The EKM is fixed per connection and is not part of the cache key, so a
+  // repeat of the same binding is answered from the cache without touching
+  // the signature again.
+  auto otherEkm = folly::IOBuf::create(32);
+  otherEkm->append(32);
+  memset(otherEkm->writableData(), 0, otherEkm->length());
+  auto cached = validator.validateTokenBinding(
+      makeBinding(), otherEkm, TokenBindingKeyParameters::ecdsap256);
+  EXPECT_TRUE(cached.hasValue());
+  EXPECT_TRUE(folly::IOBufEqualTo()(id->key, cached->key));
+}
+
+TEST_F(CachingValidatorTest, TestFailedValidationNotCached) {
+  CachingValidator validator;
+  auto binding = makeBinding();
+  binding.signature = folly::IOBuf::create(64);
+  binding.signature->append(64);
+  memset(binding.signature->writableData(), 1, binding.signature->length());
+  auto id = validator.validateTokenBinding(
+      std::move(binding), ekm_, TokenBindingKeyParameters::ecdsap256);
+  EXPECT_FALSE(id.hasValue());
+}
+
+TEST_F(CachingValidatorTest, TestBatchValidation) {
+  auto executor = std::make_shared<folly::ManualExecutor>();
+  auto verifier = std::make_shared<BatchSignatureVerifier>(executor);
+  CachingValidator validator;
+
+  auto future = validator.validateTokenBindingAsync(
+      makeBinding(), ekm_, TokenBindingKeyParameters::ecdsap256, verifier);
+  EXPECT_FALSE(future.isReady());
+  while (executor->run()) {
+  }
+  auto id = std::move(future).get();
+  EXPECT_TRUE(id.hasValue());
+
+  // A repeat of the same binding completes without running the executor.
+  auto cachedFuture = validator.validateTokenBindingAsync(
+      makeBinding(), ekm_, TokenBindingKeyParameters::ecdsap256, verifier);
+  EXPECT_TRUE(cachedFuture.isReady());
+  EXPECT_TRUE(std::move(cachedFuture).get().hasValue());
+}
+
+} // namespace test
+} // namespace extensions
+} // namespace fizz
@@ -41,7 +41,11 @@ struct WriteToSocket {
 #if FOLLY_MOBILE
   std::vector<TLSContent> contents;
 #else
-  folly::small_vector<TLSContent, 4> contents;
+  // Two contents inline covers everything but the full server flight with
+  // middlebox compatibility enabled. Keeping this small matters more:
+  // WriteToSocket is the largest Action payload, so its size sets the cost
+  // of every Action moved through the inline Actions storage.
+  folly::small_vector<TLSContent, 2> contents;
 #endif
   folly::WriteFlags flags{folly::WriteFlags::NONE};
 };
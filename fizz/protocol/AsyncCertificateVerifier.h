@@ -0,0 +1,27 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/protocol/CertificateVerifier.h>
+#include <folly/futures/Future.h>
+
+namespace fizz {
+
+/**
+ * CertificateVerifier with an asynchronous verify method. This is useful to
+ * move chain building and signature verification off the IO thread, for
+ * example onto a CPU thread pool. The certs vector is passed by value so
+ * implementations may safely use it after the call returns.
+ */
+class AsyncCertificateVerifier : public CertificateVerifier {
+ public:
+  virtual folly::Future<folly::Unit> verifyFuture(
+      std::vector<std::shared_ptr<const PeerCert>> certs) const = 0;
+};
+} // namespace fizz
@@ -8,6 +8,7 @@
 
 #include <fizz/protocol/AsyncFizzBase.h>
 
+#include <fizz/util/BufferPool.h>
 #include <folly/Conv.h>
 #include <folly/io/Cursor.h>
 
@@ -16,10 +17,12 @@ namespace fizz {
 using folly::AsyncSocketException;
 
 /**
- * Min and max read buffer sizes when using non-mo
+ * Default bounds for the adaptive read buffer used when the transport does
+ * not hand us movable buffers. Allocations start at the min and double each
+ * time the transport fills one completely, up to the max.
  */
 static const uint32_t kMinReadSize = 1460;
-static const uint32_t kMaxReadSize = 4000;
+static const uint32_t kMaxReadSize = 64 * 1024;
 
 /**
  * Buffer size above which we should unset our read callback to apply back
@@ -27,21 +30,205 @@ static const uint32_t kMaxReadSize = 4000;
  */
 static const uint32_t kMaxBufSize = 64 * 1024;
 
+/**
+ * Size of a TLS record header (content type, legacy version and length),
+ * used to size reads to record boundaries.
+ */
+static const uint32_t kRecordHeaderSize = 5;
+
 AsyncFizzBase::AsyncFizzBase(folly::AsyncTransportWrapper::UniquePtr transport)
     : folly::WriteChainAsyncTransportWrapper<folly::AsyncTransportWrapper>(
           std::move(transport)),
-      handshakeTimeout_(*this, transport_->getEventBase()) {}
+      handshakeTimeout_(*this, transport_->getEventBase()),
+      minReadSize_(kMinReadSize),
+      maxReadSize_(kMaxReadSize),
+      readSizeHint_(kMinReadSize) {}
 
 AsyncFizzBase::~AsyncFizzBase() {
+  setAppDataBufLen(0);
   transport_->setReadCB(nullptr);
 }
 
+constexpr size_t AsyncFizzBase::kDefaultAppDataBufLimit;
+
+void AsyncFizzBase::setAppDataBufferMeter(std::shared_ptr<BufferMeter> meter) {
+  if (appDataBufMeter_) {
+    appDataBufMeter_->release(appDataBufLen_);
+  }
+  appDataBufMeter_ = std::move(meter);
+  if (appDataBufMeter_) {
+    appDataBufMeter_->charge(appDataBufLen_);
+  }
+}
+
+void AsyncFizzBase::setAppDataBufLen(size_t len) {
+  if (appDataBufMeter_) {
+    if (len > appDataBufLen_) {
+      appDataBufMeter_->charge(len - appDataBufLen_);
+    } else {
+      appDataBufMeter_->release(appDataBufLen_ - len);
+    }
+  }
+  appDataBufLen_ = len;
+}
+
 void AsyncFizzBase::destroy() {
   transport_->closeNow();
   transport_->setReadCB(nullptr);
   DelayedDestruction::destroy();
 }
 
+folly::AsyncTransportWrapper::UniquePtr AsyncFizzBase::extractTransport() {
+  transport_->setReadCB(nullptr);
+  return std::move(transport_);
+}
+
+bool AsyncFizzBase::writeAppDataDirect(
+    const WriteRecordLayer* recordLayer,
+    folly::AsyncTransportWrapper::WriteCallback* callback,
+    std::unique_ptr<folly::IOBuf>& buf,
+    folly::WriteFlags flags,
+    EncryptionLevel encryptionLevel) {
+  if (!appDataFastPath_ || !recordLayer ||
+      recordLayer->getEncryptionLevel() != encryptionLevel ||
+      recordLayer->rekeyRecommended()) {
+    // Writes that should trigger an automatic rekey take the state machine
+    // path so that the KeyUpdate can be generated.
+    return false;
+  }
+  DelayedDestruction::DestructorGuard dg(this);
+  try {
+    if (encryptBufferWatermark_ != 0 &&
+        buf->computeChainDataLength() > encryptBufferWatermark_) {
+      // Encrypt and write in watermark-sized chunks so each chunk can be
+      // released by the transport before the next one is encrypted.
+      auto stream = recordLayer->createWriteStream(
+          TLSMessage{ContentType::application_data, std::move(buf)});
+      while (auto content = stream.next(encryptBufferWatermark_)) {
+        auto chunkFlags = addZeroCopyFlags(
+            *content->data,
+            stream.done() ? flags : flags | folly::WriteFlags::CORK);
+        chargeWriteBuffer(content->data->computeChainDataLength());
+        sendToTransport(
+            stream.done() ? callback : nullptr,
+            std::move(content->data),
+            chunkFlags);
+      }
+    } else {
+      auto content = recordLayer->writeAppData(std::move(buf));
+      auto writeFlags = addZeroCopyFlags(*content.data, flags);
+      chargeWriteBuffer(content.data->computeChainDataLength());
+      sendToTransport(callback, std::move(content.data), writeFlags);
+    }
+  } catch (const std::exception& ex) {
+    transportError(AsyncSocketException(
+        AsyncSocketException::SSL_ERROR, ex.what()));
+  }
+  return true;
+}
+
+void AsyncFizzBase::queueTransportWrite(
+    folly::AsyncTransportWrapper::WriteCallback* callback,
+    std::unique_ptr<folly::IOBuf> data,
+    folly::WriteFlags flags) {
+  chargeWriteBuffer(data->computeChainDataLength());
+  if (queuedTransportWrite_) {
+    queuedTransportWrite_->prependChain(std::move(data));
+  } else {
+    queuedTransportWrite_ = std::move(data);
+  }
+  queuedTransportWriteFlags_ = queuedTransportWriteFlags_ | flags;
+  if (callback) {
+    auto buf = std::move(queuedTransportWrite_);
+    auto writeFlags =
+        addZeroCopyFlags(*buf, queuedTransportWriteFlags_);
+    queuedTransportWriteFlags_ = folly::WriteFlags::NONE;
+    sendToTransport(callback, std::move(buf), writeFlags);
+  }
+}
+
+void AsyncFizzBase::flushTransportWrites() {
+  if (!queuedTransportWrite_) {
+    return;
+  }
+  if (deferredFlush_) {
+    auto evb = transport_->getEventBase();
+    if (evb) {
+      // Coalesce every flush this connection requests during the loop
+      // iteration into one transport write at the end of it.
+      if (!flushLoopCallback_.isLoopCallbackScheduled()) {
+        evb->runInLoop(&flushLoopCallback_, true /* thisIteration */);
+      }
+      return;
+    }
+  }
+  flushTransportWritesNow();
+}
+
+void AsyncFizzBase::flushTransportWritesNow() {
+  if (!queuedTransportWrite_) {
+    return;
+  }
+  auto buf = std::move(queuedTransportWrite_);
+  auto writeFlags = addZeroCopyFlags(*buf, queuedTransportWriteFlags_);
+  queuedTransportWriteFlags_ = folly::WriteFlags::NONE;
+  sendToTransport(nullptr, std::move(buf), writeFlags);
+}
+
+void AsyncFizzBase::sendToTransport(
+    folly::AsyncTransportWrapper::WriteCallback* callback,
+    std::unique_ptr<folly::IOBuf> data,
+    folly::WriteFlags flags) {
+  if (!trackBufferedWrites_) {
+    transport_->writeChain(callback, std::move(data), flags);
+    return;
+  }
+  // The bytes were charged when queued; issue the write with this as the
+  // callback so the completion discharges them, forwarding to the
+  // caller's callback afterwards.
+  inflightWrites_.emplace_back(data->computeChainDataLength(), callback);
+  transport_->writeChain(this, std::move(data), flags);
+}
+
+void AsyncFizzBase::chargeWriteBuffer(size_t bytes) {
+  if (!trackBufferedWrites_) {
+    return;
+  }
+  bufferedWriteBytes_ += bytes;
+  if (writeBufferCallback_ && writeHighWatermark_ != 0 &&
+      !writeBufferHighSignaled_ &&
+      bufferedWriteBytes_ > writeHighWatermark_) {
+    writeBufferHighSignaled_ = true;
+    writeBufferCallback_->onWriteBufferHigh(bufferedWriteBytes_);
+  }
+}
+
+void AsyncFizzBase::dischargeWriteBuffer(size_t bytes) {
+  // Data queued before accounting was enabled may flush in a tracked
+  // write; never discharge more than was charged.
+  bufferedWriteBytes_ -= std::min(bytes, bufferedWriteBytes_);
+  if (writeBufferCallback_ && writeBufferHighSignaled_ &&
+      bufferedWriteBytes_ <= writeLowWatermark_) {
+    writeBufferHighSignaled_ = false;
+    writeBufferCallback_->onWriteBufferLow(bufferedWriteBytes_);
+  }
+}
+
+folly::WriteFlags AsyncFizzBase::addZeroCopyFlags(
+    const folly::IOBuf& data,
+    folly::WriteFlags flags) const {
+  // The transport holds buffers flagged for zero-copy until the kernel's
+  // completion notification rather than freeing them when the write call
+  // returns, so the record layer's output can be mapped into the NIC
+  // directly. Small writes stay on the copying path as MSG_ZEROCOPY only
+  // pays for itself on large sends.
+  if (zeroCopyThreshold_ != 0 &&
+      data.computeChainDataLength() >= zeroCopyThreshold_) {
+    flags = flags | folly::WriteFlags::WRITE_MSG_ZEROCOPY;
+  }
+  return flags;
+}
+
 AsyncFizzBase::ReadCallback* AsyncFizzBase::getReadCallback() const {
   return readCallback_;
 }
@@ -90,16 +277,23 @@ void AsyncFizzBase::startTransportReads() {
 }
 
 void AsyncFizzBase::startHandshakeTimeout(std::chrono::milliseconds timeout) {
-  handshakeTimeout_.scheduleTimeout(timeout);
+  if (wheelTimer_) {
+    wheelTimer_->scheduleTimeout(&wheelTimerHandshakeTimeout_, timeout);
+  } else {
+    handshakeTimeout_.scheduleTimeout(timeout);
+  }
 }
 
 void AsyncFizzBase::cancelHandshakeTimeout() {
+  wheelTimerHandshakeTimeout_.cancelTimeout();
   handshakeTimeout_.cancelTimeout();
 }
 
 void AsyncFizzBase::deliverAppData(std::unique_ptr<folly::IOBuf> data) {
+  size_t pendingLen = 0;
   if (data) {
-    appBytesReceived_ += data->computeChainDataLength();
+    pendingLen = data->computeChainDataLength();
+    appBytesReceived_ += pendingLen;
   }
 
   if (appDataBuf_) {
@@ -107,7 +301,9 @@ void AsyncFizzBase::deliverAppData(std::unique_ptr<folly::IOBuf> data) {
       appDataBuf_->prependChain(std::move(data));
     }
     data = std::move(appDataBuf_);
+    pendingLen += appDataBufLen_;
   }
+  setAppDataBufLen(0);
 
   if (readCallback_ && data) {
     if (readCallback_->isBufferMovable()) {
@@ -146,20 +342,45 @@ void AsyncFizzBase::deliverAppData(std::unique_ptr<folly::IOBuf> data) {
       }
       if (available != 0) {
         cursor.clone(appDataBuf_, available);
+        setAppDataBufLen(available);
       }
     }
   } else if (data) {
     appDataBuf_ = std::move(data);
+    setAppDataBufLen(pendingLen);
   }
 
   checkBufLen();
 }
 
+void AsyncFizzBase::pipelineMessage(TLSMessage msg) {
+  if (msg.type == ContentType::application_data) {
+    deliverAppData(std::move(msg.fragment));
+    return;
+  }
+  pipelineControlMessage(std::move(msg));
+}
+
+void AsyncFizzBase::pipelineError(ReadError error) {
+  deliverError(AsyncSocketException(
+      AsyncSocketException::SSL_ERROR, error.message.c_str()));
+}
+
+void AsyncFizzBase::pipelineControlMessage(TLSMessage /* msg */) {
+  deliverError(AsyncSocketException(
+      AsyncSocketException::SSL_ERROR,
+      "unexpected control message in pipelined mode"));
+}
+
 void AsyncFizzBase::deliverError(
     const AsyncSocketException& ex,
     bool closeTransport) {
   DelayedDestruction::DestructorGuard dg(this);
 
+  // Anything queued (for example an alert generated alongside this error)
+  // must reach the transport before it is closed, so skip any deferral.
+  flushTransportWritesNow();
+
   if (readCallback_) {
     auto readCallback = readCallback_;
     readCallback_ = nullptr;
@@ -174,9 +395,48 @@ void AsyncFizzBase::deliverError(
   }
 }
 
+void AsyncFizzBase::setReadBufferSizes(
+    uint32_t minReadSize,
+    uint32_t maxReadSize) {
+  DCHECK_LE(minReadSize, maxReadSize);
+  minReadSize_ = minReadSize;
+  maxReadSize_ = maxReadSize;
+  readSizeHint_ = std::min(std::max(readSizeHint_, minReadSize_), maxReadSize_);
+}
+
 void AsyncFizzBase::getReadBuffer(void** bufReturn, size_t* lenReturn) {
+  uint32_t readSize = readSizeHint_;
+  recordSizedRead_ = false;
+
+  // If a partial record is buffered, peek its header and request exactly
+  // the bytes needed to complete it, so the record layer sees a whole
+  // record on the next read instead of reparsing the partial data on
+  // every read event.
+  if (transportReadBuf_.chainLength() >= kRecordHeaderSize) {
+    folly::io::Cursor cursor(transportReadBuf_.front());
+    cursor.skip(kRecordHeaderSize - sizeof(uint16_t));
+    uint32_t recordSize = kRecordHeaderSize + cursor.readBE<uint16_t>();
+    if (transportReadBuf_.chainLength() < recordSize) {
+      readSize = std::min<uint32_t>(
+          recordSize - transportReadBuf_.chainLength(), maxReadSize_);
+      recordSizedRead_ = true;
+    }
+  }
+
+  // When the queue is empty (the steady state once records have been
+  // consumed) seed it with a pooled buffer, so read storage is allocated
+  // and recycled on this event base's thread and stays NUMA-local.
+  // preallocate() then hands out its tailroom without allocating.
+  if (readBufferPooling_ && transportReadBuf_.empty()) {
+    transportReadBuf_.append(buffer_pool::allocate(readSize));
+  }
+
+  // Record-sized reads are capped at the record boundary; normal reads
+  // may use any tailroom up to the configured max.
+  uint32_t maxAlloc =
+      recordSizedRead_ ? readSize : std::max(readSize, maxReadSize_);
   std::pair<void*, uint32_t> readSpace =
-      transportReadBuf_.preallocate(kMinReadSize, kMaxReadSize);
+      transportReadBuf_.preallocate(readSize, readSize, maxAlloc);
   *bufReturn = readSpace.first;
   *lenReturn = readSpace.second;
 }
@@ -185,6 +445,20 @@ void AsyncFizzBase::readDataAvailable(size_t len) noexcept {
   DelayedDestruction::DestructorGuard dg(this);
 
   transportReadBuf_.postallocate(len);
+
+  // Grow the read buffer while the transport keeps filling it and shrink it
+  // back on partial reads so idle connections hold small buffers. Reads
+  // sized to a record boundary say nothing about transport throughput, so
+  // they do not feed the hint.
+  if (!recordSizedRead_) {
+    if (len >= readSizeHint_) {
+      readSizeHint_ = std::min(readSizeHint_ * 2, maxReadSize_);
+    } else if (len < readSizeHint_ / 2) {
+      readSizeHint_ = std::max(readSizeHint_ / 2, minReadSize_);
+    }
+  }
+  recordSizedRead_ = false;
+
   transportDataAvailable();
   checkBufLen();
 }
@@ -211,18 +485,41 @@ void AsyncFizzBase::readErr(const folly::AsyncSocketException& ex) noexcept {
   transportError(ex);
 }
 
-void AsyncFizzBase::writeSuccess() noexcept {}
+void AsyncFizzBase::writeSuccess() noexcept {
+  if (inflightWrites_.empty()) {
+    return;
+  }
+  auto write = inflightWrites_.front();
+  inflightWrites_.pop_front();
+  dischargeWriteBuffer(write.first);
+  if (write.second) {
+    write.second->writeSuccess();
+  }
+}
 
 void AsyncFizzBase::writeErr(
-    size_t /* bytesWritten */,
+    size_t bytesWritten,
     const folly::AsyncSocketException& ex) noexcept {
-  transportError(ex);
+  if (inflightWrites_.empty()) {
+    transportError(ex);
+    return;
+  }
+  auto write = inflightWrites_.front();
+  inflightWrites_.pop_front();
+  dischargeWriteBuffer(write.first);
+  if (write.second) {
+    write.second->writeErr(bytesWritten, ex);
+  } else {
+    transportError(ex);
+  }
 }
 
 void AsyncFizzBase::checkBufLen() {
   if (!readCallback_ &&
       (transportReadBuf_.chainLength() >= kMaxBufSize ||
-       (appDataBuf_ && appDataBuf_->computeChainDataLength() >= kMaxBufSize))) {
+       appDataBufLen_ >= appDataBufLimit_ ||
+       (appDataBufMeter_ && appDataBufLen_ != 0 &&
+        appDataBufMeter_->overLimit()))) {
     transport_->setReadCB(nullptr);
   }
 }
@@ -296,7 +593,10 @@ class SecretVisitor : public boost::static_visitor<> {
 
 void AsyncFizzBase::secretAvailable(const DerivedSecret& secret) noexcept {
   if (secretCallback_) {
-    SecretVisitor visitor(secretCallback_, secret.secret);
+    // The callback interface hands out a vector; only materialize the copy
+    // when a callback is actually installed.
+    std::vector<uint8_t> secretBuf(secret.secret.begin(), secret.secret.end());
+    SecretVisitor visitor(secretCallback_, secretBuf);
     boost::apply_visitor(visitor, secret.type);
   }
 }
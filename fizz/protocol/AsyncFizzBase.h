@@ -8,12 +8,18 @@
 
 #pragma once
 
+#include <fizz/protocol/BufferMeter.h>
+#include <fizz/protocol/DecryptionPipeline.h>
 #include <fizz/protocol/KeyScheduler.h>
+#include <fizz/record/RecordLayer.h>
 #include <fizz/record/Types.h>
 #include <folly/io/IOBufQueue.h>
 #include <folly/io/async/AsyncSocket.h>
+#include <folly/io/async/HHWheelTimer.h>
 #include <folly/io/async/WriteChainAsyncTransportWrapper.h>
 
+#include <deque>
+
 namespace fizz {
 
 using Cert = folly::AsyncTransportCertificate;
@@ -25,8 +31,11 @@ using Cert = folly::AsyncTransportCertificate;
 class AsyncFizzBase : public folly::WriteChainAsyncTransportWrapper<
                           folly::AsyncTransportWrapper>,
                       protected folly::AsyncTransportWrapper::WriteCallback,
-                      protected folly::AsyncTransportWrapper::ReadCallback {
+                      protected folly::AsyncTransportWrapper::ReadCallback,
+                      protected DecryptionPipeline::Callback {
  public:
+  static constexpr size_t kDefaultAppDataBufLimit = 64 * 1024;
+
   using UniquePtr =
       std::unique_ptr<AsyncFizzBase, folly::DelayedDestruction::Destructor>;
   using ReadCallback = folly::AsyncTransportWrapper::ReadCallback;
@@ -46,6 +55,23 @@ class AsyncFizzBase : public folly::WriteChainAsyncTransportWrapper<
     AsyncFizzBase& transport_;
   };
 
+  /**
+   * Handshake timeout scheduled on a shared wheel timer rather than a
+   * standalone AsyncTimeout; see setHandshakeTimer().
+   */
+  class WheelTimerHandshakeTimeout : public folly::HHWheelTimer::Callback {
+   public:
+    explicit WheelTimerHandshakeTimeout(AsyncFizzBase& transport)
+        : transport_(transport) {}
+
+    void timeoutExpired() noexcept override {
+      transport_.handshakeTimeoutExpired();
+    }
+
+   private:
+    AsyncFizzBase& transport_;
+  };
+
   class SecretCallback {
    public:
     virtual ~SecretCallback() = default;
@@ -74,6 +100,28 @@ class AsyncFizzBase : public folly::WriteChainAsyncTransportWrapper<
         const std::vector<uint8_t>&) noexcept {}
   };
 
+  /**
+   * Callback signaling write buffer watermark crossings, so applications
+   * can shed load while a slow-reading peer lets buffered writes grow.
+   */
+  class WriteBufferCallback {
+   public:
+    virtual ~WriteBufferCallback() = default;
+
+    /**
+     * Called once when buffered write bytes rise above the high
+     * watermark. Not called again until the buffer has drained back to
+     * the low watermark.
+     */
+    virtual void onWriteBufferHigh(size_t bufferedBytes) = 0;
+
+    /**
+     * Called when buffered write bytes drain back to at or below the low
+     * watermark after the high watermark was hit.
+     */
+    virtual void onWriteBufferLow(size_t bufferedBytes) = 0;
+  };
+
   explicit AsyncFizzBase(folly::AsyncTransportWrapper::UniquePtr transport);
 
   ~AsyncFizzBase() override;
@@ -133,6 +181,13 @@ class AsyncFizzBase : public folly::WriteChainAsyncTransportWrapper<
       const Buf& context,
       uint16_t length) const = 0;
 
+  /**
+   * Initiates a TLS KeyUpdate, rotating this side's traffic keys in
+   * place. If requestPeerUpdate is set the peer is asked to rotate its
+   * keys as well. Only valid once the handshake has completed.
+   */
+  virtual void updateTrafficKeys(bool requestPeerUpdate = true) = 0;
+
   /**
    * Clean up transport on destruction
    */
@@ -145,6 +200,19 @@ class AsyncFizzBase : public folly::WriteChainAsyncTransportWrapper<
     return "Fizz";
   }
 
+  /**
+   * Schedules the handshake timeout on a shared wheel timer (typically
+   * the EventBase's, or one owned by the acceptor) instead of arming a
+   * standalone timer per connection. The wheel's tick makes the deadline
+   * coarse, which handshake timeouts tolerate, in exchange for O(1)
+   * insertion and cancellation at high accept rates. The timer must
+   * belong to this connection's EventBase and must be set before the
+   * handshake starts.
+   */
+  void setHandshakeTimer(folly::HHWheelTimer* timer) {
+    wheelTimer_ = timer;
+  }
+
   /**
    * EventBase operations.
    */
@@ -165,11 +233,15 @@ class AsyncFizzBase : public folly::WriteChainAsyncTransportWrapper<
   }
   void detachEventBase() override {
     handshakeTimeout_.detachEventBase();
+    // A shared wheel timer belongs to the EventBase being detached from.
+    wheelTimerHandshakeTimeout_.cancelTimeout();
+    wheelTimer_ = nullptr;
     transport_->setReadCB(nullptr);
     transport_->detachEventBase();
   }
   bool isDetachable() const override {
-    if (handshakeTimeout_.isScheduled()) {
+    if (handshakeTimeout_.isScheduled() ||
+        wheelTimerHandshakeTimeout_.isScheduled()) {
       return false;
     }
     // Since we always have a read callback on the underlying transport,
@@ -182,6 +254,14 @@ class AsyncFizzBase : public folly::WriteChainAsyncTransportWrapper<
     return result;
   }
 
+  /**
+   * Detaches and returns the underlying transport. After this the Fizz
+   * record layer no longer touches the socket, for example because the
+   * connection has been handed off to kernel TLS. This transport must not
+   * be used for app data afterwards.
+   */
+  virtual folly::AsyncTransportWrapper::UniquePtr extractTransport();
+
   void setSecretCallback(SecretCallback* cb) {
     secretCallback_ = cb;
   }
@@ -210,7 +290,175 @@ class AsyncFizzBase : public folly::WriteChainAsyncTransportWrapper<
     return closeTransportOnCloseNotify_;
   }
 
+  /**
+   * Enables a fast path that moves application data directly between the
+   * record layers and the transport once the handshake has completed,
+   * bypassing state machine event dispatch in both directions.
+   * Post-handshake handshake messages and alerts still go through the full
+   * state machine.
+   */
+  void setAppDataFastPath(bool enabled) {
+    appDataFastPath_ = enabled;
+  }
+
+  /**
+   * Opts this connection into pipelined record decryption: once the
+   * handshake has completed and the app data fast path is active,
+   * queued records are fanned out to the pipeline's worker pool and
+   * delivered to the application in order, instead of decrypting
+   * serially on the IO thread. The caller keys the pipeline's aeads
+   * with the connection's read traffic key. Pipelined connections must
+   * not use traffic key updates; see DecryptionPipeline.
+   */
+  void setDecryptionPipeline(std::unique_ptr<DecryptionPipeline> pipeline) {
+    decryptionPipeline_ = std::move(pipeline);
+    if (decryptionPipeline_) {
+      decryptionPipeline_->setCallback(this);
+    }
+  }
+
+  DecryptionPipeline* decryptionPipeline() const {
+    return decryptionPipeline_.get();
+  }
+
+  /**
+   * Defers flushing queued TLS records to an event base loop callback
+   * instead of writing at the end of each processActions pass. All the
+   * output a connection produces during one loop iteration then reaches
+   * the transport in a single writeChain call, trading a few
+   * microseconds of latency for fewer syscalls on event bases serving
+   * many connections. Writes carrying a completion callback and error
+   * teardown still flush inline.
+   */
+  void setDeferredFlush(bool enabled) {
+    deferredFlush_ = enabled;
+  }
+
+  /**
+   * Caps how much plaintext the direct write path will encrypt and buffer
+   * at once. Writes larger than the watermark are encrypted and handed to
+   * the transport in watermark-sized chunks so each chunk can be released
+   * before the next one is encrypted, rather than materializing the
+   * ciphertext for the entire write up front. 0 (the default) disables
+   * chunking.
+   */
+  void setEncryptBufferWatermark(size_t watermark) {
+    encryptBufferWatermark_ = watermark;
+  }
+
+  /**
+   * Bytes of encrypted data queued toward or handed to the transport
+   * whose writes have not completed yet. Maintained inline in the write
+   * path, so reading it is a plain member access with no chain walks.
+   * Accounting starts once setWriteBufferWatermarks has been called;
+   * before that this returns 0.
+   */
+  size_t getBufferedWriteBytes() const {
+    return bufferedWriteBytes_;
+  }
+
+  /**
+   * Registers watermarks on buffered write bytes and enables the
+   * accounting. onWriteBufferHigh fires once when the buffer exceeds the
+   * high watermark; onWriteBufferLow fires once it drains back to the low
+   * watermark. A high watermark of 0 disables the callbacks; the callback
+   * may be null to only track bytes.
+   */
+  void setWriteBufferWatermarks(
+      size_t lowWatermark,
+      size_t highWatermark,
+      WriteBufferCallback* callback) {
+    writeLowWatermark_ = lowWatermark;
+    writeHighWatermark_ = highWatermark;
+    writeBufferCallback_ = callback;
+    trackBufferedWrites_ = true;
+  }
+
+  /**
+   * Caps how much application data may buffer on this connection before a
+   * read callback is installed (for example accepted early data waiting
+   * for the application). Once the cap is reached transport reads pause
+   * until the application attaches and drains the buffer. Default is
+   * 64kB.
+   */
+  void setAppDataBufferLimit(size_t limit) {
+    appDataBufLimit_ = limit;
+  }
+
+  /**
+   * Attaches a meter accounting buffered application data shared across
+   * connections (typically all connections of a server context). While
+   * the meter is over its limit, any connection holding buffered data
+   * pauses transport reads, bounding aggregate buffering without
+   * provisioning every connection for its individual worst case.
+   */
+  void setAppDataBufferMeter(std::shared_ptr<BufferMeter> meter);
+
+  /**
+   * Tunes the adaptive transport read buffer. Read allocations start at
+   * minReadSize, double whenever the transport fills one completely and
+   * shrink back on partially filled reads, so busy connections read in
+   * large chunks while idle connections hold small buffers.
+   */
+  void setReadBufferSizes(uint32_t minReadSize, uint32_t maxReadSize);
+
+  /**
+   * Controls whether transport read buffers are drawn from the
+   * per-thread buffer pool (the default) or allocated fresh per read.
+   * The pool's per-thread retention is tuned with
+   * buffer_pool::setPoolCapacity().
+   */
+  void setReadBufferPooling(bool enabled) {
+    readBufferPooling_ = enabled;
+  }
+
+  /**
+   * Flags encrypted writes of at least threshold bytes for zero-copy
+   * (MSG_ZEROCOPY) transmission. The transport then retains the record
+   * buffers until the kernel's completion notification arrives instead of
+   * freeing them when the write call returns. Zero-copy must also be
+   * enabled on the underlying socket for the flag to take effect. 0 (the
+   * default) disables zero-copy writes.
+   */
+  void setZeroCopyThreshold(size_t threshold) {
+    zeroCopyThreshold_ = threshold;
+  }
+
+  /**
+   * Counters describing record-level traffic on this connection: records,
+   * plaintext bytes, padding, decrypt failures and key updates. Updated
+   * inline by the encrypted record layers.
+   */
+  const RecordLayerStats& getRecordLayerStats() const {
+    return recordLayerStats_;
+  }
+
+  /**
+   * Attaches a callback notified of failure-path record events (decrypt
+   * failures, received alerts), rate limited by the record layer. Should
+   * be set before starting the handshake. Not owned; must outlive the
+   * connection.
+   */
+  void setRecordEventCallback(RecordEventCallback* callback) {
+    recordEventCallback_ = callback;
+  }
+
  protected:
+  /**
+   * Stats block for the derived class to attach to its record layers.
+   */
+  RecordLayerStats* recordLayerStats() {
+    return &recordLayerStats_;
+  }
+
+  /**
+   * Event callback for the derived class to attach to its read record
+   * layer. May be null.
+   */
+  RecordEventCallback* recordEventCallback() {
+    return recordEventCallback_;
+  }
+
   /**
    * Start reading raw data from the transport.
    */
@@ -243,6 +491,54 @@ class AsyncFizzBase : public folly::WriteChainAsyncTransportWrapper<
       std::unique_ptr<folly::IOBuf>&& buf,
       folly::WriteFlags flags = folly::WriteFlags::NONE) = 0;
 
+  /**
+   * Fast path counterpart to writeAppData() for use by the derived class.
+   * Encrypts buf with the given write record layer and writes it to the
+   * transport inline, skipping state machine event dispatch. Returns false
+   * without consuming buf if the fast path is not enabled or the record
+   * layer is not writing at the expected encryption level; the caller
+   * should then fall back to a normal appWrite.
+   */
+  bool writeAppDataDirect(
+      const WriteRecordLayer* recordLayer,
+      folly::AsyncTransportWrapper::WriteCallback* callback,
+      std::unique_ptr<folly::IOBuf>& buf,
+      folly::WriteFlags flags,
+      EncryptionLevel encryptionLevel = EncryptionLevel::AppTraffic);
+
+  /**
+   * Queues a write of TLS records to the transport. Consecutive queued
+   * writes are coalesced into a single writeChain call when flushed; a
+   * write carrying a completion callback flushes immediately so that the
+   * callback observes the whole chain written.
+   */
+  void queueTransportWrite(
+      folly::AsyncTransportWrapper::WriteCallback* callback,
+      std::unique_ptr<folly::IOBuf> data,
+      folly::WriteFlags flags);
+
+  /**
+   * Writes anything queued by queueTransportWrite() to the transport.
+   * With deferred flush enabled this instead schedules a single flush at
+   * the end of the current event base loop iteration.
+   */
+  void flushTransportWrites();
+
+  /**
+   * DecryptionPipeline::Callback implementation. Application data is
+   * delivered to the app read callback; anything else goes to
+   * pipelineControlMessage().
+   */
+  void pipelineMessage(TLSMessage msg) override;
+  void pipelineError(ReadError error) override;
+
+  /**
+   * A non-application-data message decrypted by the pipeline, arriving
+   * in record order, to be fed back through the state machine by the
+   * derived class.
+   */
+  virtual void pipelineControlMessage(TLSMessage msg);
+
   /**
    * Alert the derived class that a transport error occured.
    */
@@ -258,6 +554,10 @@ class AsyncFizzBase : public folly::WriteChainAsyncTransportWrapper<
    */
   virtual void secretAvailable(const DerivedSecret& secret) noexcept;
 
+  bool appDataFastPathEnabled() const {
+    return appDataFastPath_;
+  }
+
   folly::IOBufQueue transportReadBuf_{folly::IOBufQueue::cacheChainLength()};
 
  private:
@@ -282,17 +582,101 @@ class AsyncFizzBase : public folly::WriteChainAsyncTransportWrapper<
 
   void checkBufLen();
 
+  /**
+   * Updates the tracked length of appDataBuf_, keeping the attached meter
+   * (if any) in sync.
+   */
+  void setAppDataBufLen(size_t len);
+
+  /**
+   * Write buffer accounting. Bytes are charged when queued toward the
+   * transport and discharged when the transport write completes; every
+   * transport write is issued with this as its callback so completion is
+   * observed, with the application's callback (if any) forwarded to.
+   */
+  void chargeWriteBuffer(size_t bytes);
+  void dischargeWriteBuffer(size_t bytes);
+  void sendToTransport(
+      folly::AsyncTransportWrapper::WriteCallback* callback,
+      std::unique_ptr<folly::IOBuf> data,
+      folly::WriteFlags flags);
+
   void handshakeTimeoutExpired() noexcept;
 
+  folly::WriteFlags addZeroCopyFlags(
+      const folly::IOBuf& data,
+      folly::WriteFlags flags) const;
+
   ReadCallback* readCallback_{nullptr};
   std::unique_ptr<folly::IOBuf> appDataBuf_;
+  size_t appDataBufLen_{0};
+  size_t appDataBufLimit_{kDefaultAppDataBufLimit};
+  std::shared_ptr<BufferMeter> appDataBufMeter_;
+
+  uint32_t minReadSize_;
+  uint32_t maxReadSize_;
+  uint32_t readSizeHint_;
+
+  /**
+   * Whether the last getReadBuffer() was sized to complete a buffered
+   * partial record rather than by the adaptive hint.
+   */
+  bool recordSizedRead_{false};
+
+  bool readBufferPooling_{true};
+
+  /**
+   * Flushes queued transport writes from the end of the loop iteration
+   * when deferred flush is enabled. Cancels itself on destruction.
+   */
+  class FlushLoopCallback : public folly::EventBase::LoopCallback {
+   public:
+    explicit FlushLoopCallback(AsyncFizzBase& transport)
+        : transport_(transport) {}
+
+    void runLoopCallback() noexcept override {
+      transport_.flushTransportWritesNow();
+    }
+
+   private:
+    AsyncFizzBase& transport_;
+  };
+
+  /**
+   * Unconditionally writes anything queued to the transport.
+   */
+  void flushTransportWritesNow();
+
+  std::unique_ptr<folly::IOBuf> queuedTransportWrite_;
+  folly::WriteFlags queuedTransportWriteFlags_{folly::WriteFlags::NONE};
+  std::unique_ptr<DecryptionPipeline> decryptionPipeline_;
+  bool deferredFlush_{false};
+  FlushLoopCallback flushLoopCallback_{*this};
+
+  std::deque<
+      std::pair<size_t, folly::AsyncTransportWrapper::WriteCallback*>>
+      inflightWrites_;
+  size_t bufferedWriteBytes_{0};
+  size_t writeLowWatermark_{0};
+  size_t writeHighWatermark_{0};
+  WriteBufferCallback* writeBufferCallback_{nullptr};
+  bool writeBufferHighSignaled_{false};
+  // Sticky: once enabled it stays on so in-flight writes always discharge.
+  bool trackBufferedWrites_{false};
 
   size_t appBytesWritten_{0};
   size_t appBytesReceived_{0};
 
   HandshakeTimeout handshakeTimeout_;
+  WheelTimerHandshakeTimeout wheelTimerHandshakeTimeout_{*this};
+  folly::HHWheelTimer* wheelTimer_{nullptr};
 
   bool closeTransportOnCloseNotify_{true};
+  bool appDataFastPath_{false};
+  size_t encryptBufferWatermark_{0};
+  size_t zeroCopyThreshold_{0};
+  RecordLayerStats recordLayerStats_;
+  RecordEventCallback* recordEventCallback_{nullptr};
   SecretCallback* secretCallback_{nullptr};
 };
 } // namespace fizz
@@ -0,0 +1,42 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/crypto/BackendRegistry.h>
+#include <fizz/protocol/OpenSSLFactory.h>
+
+namespace fizz {
+
+/**
+ * Factory that resolves Aead and KeyExchange implementations through the
+ * CryptoBackendRegistry, so hardware offload engines registered at startup
+ * are picked up without forking the factory. Algorithms with no registered
+ * backend fall back to the stock OpenSSL implementations.
+ */
+class BackendFactory : public OpenSSLFactory {
+ public:
+  std::unique_ptr<Aead> makeAead(CipherSuite cipher) const override {
+    auto aead = CryptoBackendRegistry::getInstance().makeAead(cipher);
+    if (aead) {
+      return aead;
+    }
+    return OpenSSLFactory::makeAead(cipher);
+  }
+
+  std::unique_ptr<KeyExchange> makeKeyExchange(NamedGroup group) const
+      override {
+    auto keyExchange =
+        CryptoBackendRegistry::getInstance().makeKeyExchange(group);
+    if (keyExchange) {
+      return keyExchange;
+    }
+    return OpenSSLFactory::makeKeyExchange(group);
+  }
+};
+} // namespace fizz
@@ -26,27 +26,20 @@ CertificateMsg BrotliCertificateDecompressor::decompress(
         toString(cc.algorithm));
   }
 
-  if (cc.uncompressed_length > kMaxHandshakeSize) {
-    throw std::runtime_error(
-        "Compressed certificate exceeds maximum certificate message size");
-  }
+  validateDecompressedCertSize(cc);
 
-  auto rawCertMessage = IOBuf::create(cc.uncompressed_length);
+  auto scratch = getCertDecompressionScratch(cc.uncompressed_length);
   size_t size = cc.uncompressed_length;
   auto compRange = cc.compressed_certificate_message->coalesce();
   auto status = BrotliDecompressBuffer(
-      compRange.size(),
-      compRange.data(),
-      &size,
-      rawCertMessage->writableData());
+      compRange.size(), compRange.data(), &size, scratch.data());
   if (status != BrotliResult::BROTLI_RESULT_SUCCESS) {
     throw std::runtime_error("Decompressing certificate failed");
   } else if (size != cc.uncompressed_length) {
     throw std::runtime_error("Uncompressed length incorrect");
   }
 
-  rawCertMessage->append(size);
-  return decode<CertificateMsg>(std::move(rawCertMessage));
+  return decode<CertificateMsg>(IOBuf::copyBuffer(scratch.data(), size));
 }
 
 } // namespace fizz
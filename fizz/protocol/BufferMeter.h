@@ -0,0 +1,48 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+namespace fizz {
+
+/**
+ * Shared accounting of application data buffered on behalf of connections
+ * whose application has not installed a read callback yet (most notably
+ * accepted early data waiting for the application). Connections charge
+ * bytes as they buffer and release them as the application consumes, so a
+ * burst of buffering connections pauses transport reads once the shared
+ * limit is exceeded instead of ballooning memory.
+ */
+class BufferMeter {
+ public:
+  explicit BufferMeter(size_t limit) : limit_(limit) {}
+
+  void charge(size_t bytes) {
+    used_.fetch_add(bytes, std::memory_order_relaxed);
+  }
+
+  void release(size_t bytes) {
+    used_.fetch_sub(bytes, std::memory_order_relaxed);
+  }
+
+  bool overLimit() const {
+    return used_.load(std::memory_order_relaxed) >= limit_;
+  }
+
+  size_t bytesBuffered() const {
+    return used_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  const size_t limit_;
+  std::atomic<size_t> used_{0};
+};
+} // namespace fizz
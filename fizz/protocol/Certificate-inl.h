@@ -33,6 +33,12 @@ inline std::vector<SignatureScheme> CertUtils::getSigSchemes<KeyType::RSA>() {
   return {SignatureScheme::rsa_pss_sha256};
 }
 
+template <>
+inline std::vector<SignatureScheme>
+CertUtils::getSigSchemes<KeyType::ED25519>() {
+  return {SignatureScheme::ed25519};
+}
+
 template <KeyType T>
 SelfCertImpl<T>::SelfCertImpl(
     folly::ssl::EvpPkeyUniquePtr pkey,
@@ -49,8 +55,7 @@ SelfCertImpl<T>::SelfCertImpl(
   signature_.setKey(std::move(pkey));
   certs_ = std::move(certs);
   for (const auto& compressor : compressors) {
-    compressedCerts_[compressor->getAlgorithm()] =
-        compressor->compress(getCertMessage());
+    precompressCert(*compressor);
   }
 }
 
@@ -72,12 +77,28 @@ CertificateMsg SelfCertImpl<T>::getCertMessage(
       certs_, std::move(certificateRequestContext));
 }
 
+template <KeyType T>
+Buf SelfCertImpl<T>::getEncodedCertMessage() const {
+  // Encoded lazily so that certs which never serve a handshake don't
+  // pay for or retain the encoded message.
+  folly::call_once(encodeOnce_, [this]() {
+    encodedCertMessage_ = encodeHandshake(getCertMessage());
+  });
+  return encodedCertMessage_->clone();
+}
+
 template <KeyType T>
 CompressedCertificate SelfCertImpl<T>::getCompressedCert(
     CertificateCompressionAlgorithm algo) const {
   return CertUtils::cloneCompressedCert(compressedCerts_.at(algo));
 }
 
+template <KeyType T>
+void SelfCertImpl<T>::precompressCert(CertificateCompressor& compressor) {
+  compressedCerts_[compressor.getAlgorithm()] =
+      compressor.compress(getCertMessage());
+}
+
 template <KeyType T>
 std::vector<SignatureScheme> SelfCertImpl<T>::getSigSchemes() const {
   return CertUtils::getSigSchemes<T>();
@@ -143,6 +164,20 @@ inline Buf SelfCertImpl<KeyType::RSA>::sign(
   }
 }
 
+template <>
+inline Buf SelfCertImpl<KeyType::ED25519>::sign(
+    SignatureScheme scheme,
+    CertificateVerifyContext context,
+    folly::ByteRange toBeSigned) const {
+  auto signData = CertUtils::prepareSignData(context, toBeSigned);
+  switch (scheme) {
+    case SignatureScheme::ed25519:
+      return signature_.sign<SignatureScheme::ed25519>(signData->coalesce());
+    default:
+      throw std::runtime_error("Unsupported signature scheme");
+  }
+}
+
 template <KeyType T>
 PeerCertImpl<T>::PeerCertImpl(folly::ssl::X509UniquePtr cert) {
   folly::ssl::EvpPkeyUniquePtr key(X509_get_pubkey(cert.get()));
@@ -222,6 +257,22 @@ inline void PeerCertImpl<KeyType::RSA>::verify(
   }
 }
 
+template <>
+inline void PeerCertImpl<KeyType::ED25519>::verify(
+    SignatureScheme scheme,
+    CertificateVerifyContext context,
+    folly::ByteRange toBeSigned,
+    folly::ByteRange signature) const {
+  auto signData = CertUtils::prepareSignData(context, toBeSigned);
+  switch (scheme) {
+    case SignatureScheme::ed25519:
+      return signature_.verify<SignatureScheme::ed25519>(
+          signData->coalesce(), signature);
+    default:
+      throw std::runtime_error("Unsupported signature scheme");
+  }
+}
+
 template <KeyType T>
 folly::ssl::X509UniquePtr PeerCertImpl<T>::getX509() const {
   X509_up_ref(cert_.get());
@@ -7,7 +7,13 @@
  */
 
 #include <fizz/protocol/Certificate.h>
+#include <folly/portability/OpenSSL.h>
 #include <openssl/bio.h>
+#include <openssl/sha.h>
+
+#include <array>
+#include <mutex>
+#include <unordered_map>
 
 namespace {
 int getCurveName(EVP_PKEY* key) {
@@ -17,6 +23,76 @@ int getCurveName(EVP_PKEY* key) {
   }
   return 0;
 }
+
+std::unique_ptr<folly::IOBuf> derEncode(X509* cert) {
+  int len = i2d_X509(cert, nullptr);
+  if (len < 0) {
+    throw std::runtime_error("Error computing length");
+  }
+  auto der = folly::IOBuf::create(len);
+  auto dataPtr = der->writableData();
+  len = i2d_X509(cert, &dataPtr);
+  if (len < 0) {
+    throw std::runtime_error("Error converting cert to DER");
+  }
+  der->append(len);
+  return der;
+}
+
+/**
+ * Process-wide store deduplicating chain certificates by a digest of
+ * their DER encoding. A large SNI cert set shares a few dozen
+ * intermediates, so entries are small in number and retained for the
+ * process lifetime.
+ */
+class ChainCertStore {
+ public:
+  static ChainCertStore& instance() {
+    static ChainCertStore store;
+    return store;
+  }
+
+  folly::ssl::X509UniquePtr intern(folly::ssl::X509UniquePtr cert) {
+    auto der = derEncode(cert.get());
+    std::array<uint8_t, SHA256_DIGEST_LENGTH> digest;
+    SHA256(der->data(), der->length(), digest.data());
+    std::string key(reinterpret_cast<char*>(digest.data()), digest.size());
+
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = certs_.find(key);
+    if (it == certs_.end()) {
+      it = certs_
+               .emplace(std::move(key), Entry{std::move(cert), std::move(der)})
+               .first;
+      encodings_[it->second.cert.get()] = it->second.der.get();
+    }
+    X509_up_ref(it->second.cert.get());
+    return folly::ssl::X509UniquePtr(it->second.cert.get());
+  }
+
+  /**
+   * Returns a clone sharing the stored encoding, or nullptr if the
+   * certificate was not interned.
+   */
+  std::unique_ptr<folly::IOBuf> getEncoding(X509* cert) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = encodings_.find(cert);
+    if (it == encodings_.end()) {
+      return nullptr;
+    }
+    return it->second->clone();
+  }
+
+ private:
+  struct Entry {
+    folly::ssl::X509UniquePtr cert;
+    std::unique_ptr<folly::IOBuf> der;
+  };
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, Entry> certs_;
+  std::unordered_map<X509*, const folly::IOBuf*> encodings_;
+};
 } // namespace
 
 namespace fizz {
@@ -29,6 +105,8 @@ Buf CertUtils::prepareSignData(
   static constexpr folly::StringPiece kClientLabel =
       "TLS 1.3, client CertificateVerify";
   static constexpr folly::StringPiece kAuthLabel = "Exported Authenticator";
+  static constexpr folly::StringPiece kDelegatedCredLabel =
+      "TLS, server delegated credentials";
   static constexpr size_t kSigPrefixLen = 64;
   static constexpr uint8_t kSigPrefix = 32;
 
@@ -37,6 +115,8 @@ Buf CertUtils::prepareSignData(
     label = kServerLabel;
   } else if (context == CertificateVerifyContext::Client) {
     label = kClientLabel;
+  } else if (context == CertificateVerifyContext::DelegatedCredential) {
+    label = kDelegatedCredLabel;
   } else {
     label = kAuthLabel;
   }
@@ -64,17 +144,12 @@ CertificateMsg CertUtils::getCertMessage(
   std::vector<CertificateEntry> entries;
   for (const auto& cert : certs) {
     CertificateEntry entry;
-    int len = i2d_X509(cert.get(), nullptr);
-    if (len < 0) {
-      throw std::runtime_error("Error computing length");
+    // Interned chain certs share one stored encoding across all cert
+    // messages referencing them.
+    entry.cert_data = ChainCertStore::instance().getEncoding(cert.get());
+    if (!entry.cert_data) {
+      entry.cert_data = derEncode(cert.get());
     }
-    entry.cert_data = folly::IOBuf::create(len);
-    auto dataPtr = entry.cert_data->writableData();
-    len = i2d_X509(cert.get(), &dataPtr);
-    if (len < 0) {
-      throw std::runtime_error("Error converting cert to DER");
-    }
-    entry.cert_data->append(len);
     // TODO: add any extensions.
     entries.push_back(std::move(entry));
   }
@@ -106,6 +181,10 @@ std::unique_ptr<PeerCert> CertUtils::makePeerCert(Buf certData) {
   }
   if (EVP_PKEY_id(pubKey.get()) == EVP_PKEY_RSA) {
     return std::make_unique<PeerCertImpl<KeyType::RSA>>(std::move(cert));
+#if FIZZ_OPENSSL_HAS_ED25519
+  } else if (EVP_PKEY_id(pubKey.get()) == EVP_PKEY_ED25519) {
+    return std::make_unique<PeerCertImpl<KeyType::ED25519>>(std::move(cert));
+#endif
   } else if (EVP_PKEY_id(pubKey.get()) == EVP_PKEY_EC) {
     switch (getCurveName(pubKey.get())) {
       case NID_X9_62_prime256v1:
@@ -121,6 +200,41 @@ std::unique_ptr<PeerCert> CertUtils::makePeerCert(Buf certData) {
   throw std::runtime_error("unknown peer cert type");
 }
 
+std::unique_ptr<PeerCert> CertUtils::makeLazyPeerCert(Buf certData) {
+  return std::make_unique<LazyPeerCert>(std::move(certData));
+}
+
+LazyPeerCert::LazyPeerCert(Buf certData) : certData_(std::move(certData)) {
+  if (certData_->empty()) {
+    throw std::runtime_error("empty peer cert");
+  }
+}
+
+const PeerCert& LazyPeerCert::materialize() const {
+  // A throwing parse does not mark the once_flag done, so a later call
+  // retries (and throws again) rather than observing a null cert.
+  folly::call_once(parseOnce_, [this]() {
+    cert_ = CertUtils::makePeerCert(std::move(certData_));
+  });
+  return *cert_;
+}
+
+std::string LazyPeerCert::getIdentity() const {
+  return materialize().getIdentity();
+}
+
+void LazyPeerCert::verify(
+    SignatureScheme scheme,
+    CertificateVerifyContext context,
+    folly::ByteRange toBeSigned,
+    folly::ByteRange signature) const {
+  materialize().verify(scheme, context, toBeSigned, signature);
+}
+
+folly::ssl::X509UniquePtr LazyPeerCert::getX509() const {
+  return materialize().getX509();
+}
+
 namespace {
 
 std::unique_ptr<SelfCert> selfCertFromDataInternal(
@@ -172,10 +286,21 @@ std::unique_ptr<SelfCert> CertUtils::makeSelfCert(
       std::move(certData), std::move(encryptedKeyData), &password[0], compressors);
 }
 
+folly::ssl::X509UniquePtr CertUtils::internChainCert(
+    folly::ssl::X509UniquePtr cert) {
+  return ChainCertStore::instance().intern(std::move(cert));
+}
+
 std::unique_ptr<SelfCert> CertUtils::makeSelfCert(
     std::vector<folly::ssl::X509UniquePtr> certs,
     folly::ssl::EvpPkeyUniquePtr key,
     const std::vector<std::shared_ptr<CertificateCompressor>>& compressors) {
+  // Intermediates are shared by many leaf certs in large SNI sets;
+  // intern them so each distinct chain cert exists once per process.
+  for (size_t i = 1; i < certs.size(); i++) {
+    certs[i] = internChainCert(std::move(certs[i]));
+  }
+
   folly::ssl::EvpPkeyUniquePtr pubKey(X509_get_pubkey(certs.front().get()));
   if (!pubKey) {
     throw std::runtime_error("Failed to read public key");
@@ -184,6 +309,11 @@ std::unique_ptr<SelfCert> CertUtils::makeSelfCert(
   if (EVP_PKEY_id(pubKey.get()) == EVP_PKEY_RSA) {
     return std::make_unique<SelfCertImpl<KeyType::RSA>>(
         std::move(key), std::move(certs), compressors);
+#if FIZZ_OPENSSL_HAS_ED25519
+  } else if (EVP_PKEY_id(pubKey.get()) == EVP_PKEY_ED25519) {
+    return std::make_unique<SelfCertImpl<KeyType::ED25519>>(
+        std::move(key), std::move(certs), compressors);
+#endif
   } else if (EVP_PKEY_id(pubKey.get()) == EVP_PKEY_EC) {
     switch (getCurveName(pubKey.get())) {
       case NID_X9_62_prime256v1:
@@ -12,12 +12,18 @@
 #include <fizz/protocol/CertificateCompressor.h>
 #include <fizz/record/Types.h>
 #include <folly/io/async/AsyncTransportCertificate.h>
+#include <folly/synchronization/CallOnce.h>
 
 #include <map>
 
 namespace fizz {
 
-enum class CertificateVerifyContext { Server, Client, Authenticator };
+enum class CertificateVerifyContext {
+  Server,
+  Client,
+  Authenticator,
+  DelegatedCredential
+};
 
 using Cert = folly::AsyncTransportCertificate;
 
@@ -52,9 +58,29 @@ class SelfCert : public Cert {
   virtual CertificateMsg getCertMessage(
       Buf certificateRequestContext = nullptr) const = 0;
 
+  /**
+   * Returns the handshake encoding of the certificate message with an empty
+   * certificate_request_context. As the encoding does not depend on anything
+   * negotiated per-connection, implementations may return clones of a cached
+   * serialization.
+   */
+  virtual Buf getEncodedCertMessage() const {
+    return encodeHandshake(getCertMessage());
+  }
+
   virtual CompressedCertificate getCompressedCert(
       CertificateCompressionAlgorithm algo) const = 0;
 
+  /**
+   * Eagerly compresses the certificate message and caches the result so
+   * that getCompressedCert() for the compressor's algorithm serves the
+   * cached copy with no compression work on the handshake path. Certs
+   * are static between rotations, so this makes even expensive settings
+   * (e.g. maximum brotli quality) viable. Compressing again for an
+   * algorithm that is already cached replaces the cached copy.
+   */
+  virtual void precompressCert(CertificateCompressor& compressor) = 0;
+
   virtual Buf sign(
       SignatureScheme scheme,
       CertificateVerifyContext context,
@@ -98,6 +124,15 @@ class CertUtils {
    */
   static std::unique_ptr<PeerCert> makePeerCert(Buf certData);
 
+  /**
+   * Create a PeerCert that retains the ASN1 encoded certData and only
+   * parses it on first use. Invalid encodings are not detected until
+   * then. Used when no certificate verifier is configured, so
+   * connections that never inspect the peer certificate do not pay for
+   * parsing it.
+   */
+  static std::unique_ptr<PeerCert> makeLazyPeerCert(Buf certData);
+
   /**
    * Creates a SelfCert using the supplied certificate/key file data and
    * compressors.
@@ -129,6 +164,16 @@ class CertUtils {
    */
   static CompressedCertificate cloneCompressedCert(
       const CompressedCertificate& src);
+
+  /**
+   * Interns a chain (non-leaf) certificate in a process-wide store
+   * keyed by a digest of its DER encoding, returning a handle to the
+   * shared X509. makeSelfCert interns chain certs automatically, so
+   * identical intermediates across a large cert set exist once and
+   * their encodings are shared by cached certificate messages.
+   */
+  static folly::ssl::X509UniquePtr internChainCert(
+      folly::ssl::X509UniquePtr cert);
 };
 
 template <KeyType T>
@@ -155,9 +200,13 @@ class SelfCertImpl : public SelfCert {
   CertificateMsg getCertMessage(
       Buf certificateRequestContext = nullptr) const override;
 
+  Buf getEncodedCertMessage() const override;
+
   CompressedCertificate getCompressedCert(
       CertificateCompressionAlgorithm algo) const override;
 
+  void precompressCert(CertificateCompressor& compressor) override;
+
   Buf sign(
       SignatureScheme scheme,
       CertificateVerifyContext context,
@@ -168,6 +217,8 @@ class SelfCertImpl : public SelfCert {
  private:
   OpenSSLSignature<T> signature_;
   std::vector<folly::ssl::X509UniquePtr> certs_;
+  mutable folly::once_flag encodeOnce_;
+  mutable Buf encodedCertMessage_;
   std::map<CertificateCompressionAlgorithm, CompressedCertificate>
       compressedCerts_;
 };
@@ -194,6 +245,35 @@ class PeerCertImpl : public PeerCert {
   folly::ssl::X509UniquePtr cert_;
 };
 
+/**
+ * PeerCert holding the raw DER encoding, deferring X509 parsing and
+ * identity extraction until a method that needs them is called. Created
+ * via CertUtils::makeLazyPeerCert.
+ */
+class LazyPeerCert : public PeerCert {
+ public:
+  explicit LazyPeerCert(Buf certData);
+
+  ~LazyPeerCert() override = default;
+
+  std::string getIdentity() const override;
+
+  void verify(
+      SignatureScheme scheme,
+      CertificateVerifyContext context,
+      folly::ByteRange toBeSigned,
+      folly::ByteRange signature) const override;
+
+  folly::ssl::X509UniquePtr getX509() const override;
+
+ private:
+  const PeerCert& materialize() const;
+
+  mutable folly::once_flag parseOnce_;
+  mutable Buf certData_;
+  mutable std::unique_ptr<PeerCert> cert_;
+};
+
 } // namespace fizz
 
 #include <fizz/protocol/Certificate-inl.h>
@@ -0,0 +1,37 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/protocol/CertificateCompressor.h>
+
+#include <vector>
+
+namespace fizz {
+
+void validateDecompressedCertSize(const CompressedCertificate& cc) {
+  if (cc.uncompressed_length > kMaxHandshakeSize) {
+    throw std::runtime_error(
+        "Compressed certificate exceeds maximum certificate message size");
+  }
+  auto compressedLength =
+      cc.compressed_certificate_message->computeChainDataLength();
+  if (cc.uncompressed_length >
+      compressedLength * kMaxCertDecompressionRatio) {
+    throw std::runtime_error(
+        "Compressed certificate claims implausible compression ratio");
+  }
+}
+
+folly::MutableByteRange getCertDecompressionScratch(size_t size) {
+  static thread_local std::vector<uint8_t> scratch;
+  if (scratch.size() < size) {
+    scratch.resize(size);
+  }
+  return folly::MutableByteRange(scratch.data(), size);
+}
+
+} // namespace fizz
@@ -10,7 +10,38 @@
 
 #include <fizz/record/Types.h>
 
+#include <folly/Range.h>
+
 namespace fizz {
+
+/**
+ * Maximum plausible expansion of a compressed certificate message.
+ * Legitimate cert chains compress a few times smaller (dictionary-based
+ * compression of tiny chains somewhat more); anything claiming a larger
+ * ratio is a hostile decompression bomb and is rejected before any
+ * decompression work or allocation happens.
+ */
+constexpr size_t kMaxCertDecompressionRatio = 64;
+
+/**
+ * Validates the claimed uncompressed length of a compressed certificate
+ * against both the maximum handshake message size and
+ * kMaxCertDecompressionRatio. Throws std::runtime_error if the claim is
+ * implausible. Decompressors call this before allocating any output
+ * space.
+ */
+void validateDecompressedCertSize(const CompressedCertificate& cc);
+
+/**
+ * Returns a per-thread scratch buffer of at least size bytes for use as
+ * decompression output. The buffer is reused across handshakes on the
+ * same thread (growing to the high-water mark) so decompressing a
+ * client cert does not allocate a worst-case buffer per connection. The
+ * returned range is only valid until the next call on this thread;
+ * callers must copy out the decompressed bytes they need.
+ */
+folly::MutableByteRange getCertDecompressionScratch(size_t size);
+
 class CertificateCompressor {
  public:
   virtual ~CertificateCompressor() = default;
@@ -0,0 +1,96 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/protocol/DecryptionPipeline.h>
+
+namespace fizz {
+
+DecryptionPipeline::DecryptionPipeline(
+    folly::Executor* executor,
+    std::vector<std::unique_ptr<Aead>> aeads,
+    folly::EventBase* evb,
+    bool useAdditionalData)
+    : executor_(executor),
+      evb_(evb),
+      useAdditionalData_(useAdditionalData),
+      liveness_(std::make_shared<LivenessToken>()) {
+  CHECK(!aeads.empty());
+  for (auto& aead : aeads) {
+    workers_.push_back(std::make_shared<Worker>(std::move(aead)));
+  }
+}
+
+DecryptionPipeline::~DecryptionPipeline() {
+  liveness_->alive = false;
+}
+
+void DecryptionPipeline::enqueue(CiphertextRecord record) {
+  if (failed_) {
+    return;
+  }
+  if (!seqInitialized_) {
+    nextDeliverSeq_ = record.seqNum;
+    seqInitialized_ = true;
+  }
+  auto seqNum = record.seqNum;
+  auto worker = workers_[seqNum % workers_.size()];
+  // The event base must outlive in-flight tasks; the pipeline itself
+  // need not, as completions check the liveness token before touching
+  // it.
+  executor_->add([this,
+                  evb = evb_,
+                  liveness = liveness_,
+                  worker,
+                  seqNum,
+                  useAdditionalData = useAdditionalData_,
+                  record = std::move(record)]() mutable {
+    ReadResult<TLSMessage> result = [&]() {
+      std::lock_guard<std::mutex> guard(worker->lock);
+      return EncryptedReadRecordLayer::decryptAndParse(
+          *worker->aead, std::move(record), useAdditionalData);
+    }();
+    evb->runInEventBaseThread([this,
+                                liveness = std::move(liveness),
+                                seqNum,
+                                result = std::move(result)]() mutable {
+      if (!liveness->alive) {
+        return;
+      }
+      onResult(seqNum, std::move(result));
+    });
+  });
+}
+
+void DecryptionPipeline::onResult(
+    uint64_t seqNum,
+    ReadResult<TLSMessage> result) {
+  if (failed_) {
+    return;
+  }
+  if (result.hasError()) {
+    failed_ = true;
+    pending_.clear();
+    callback_->pipelineError(std::move(result.error()));
+    return;
+  }
+  pending_.emplace(seqNum, std::move(**result));
+
+  // Deliver every contiguous completed record; the callback may destroy
+  // the pipeline, so re-check liveness after each delivery.
+  auto liveness = liveness_;
+  while (!pending_.empty() && pending_.begin()->first == nextDeliverSeq_) {
+    auto msg = std::move(pending_.begin()->second);
+    pending_.erase(pending_.begin());
+    nextDeliverSeq_++;
+    callback_->pipelineMessage(std::move(msg));
+    if (!liveness->alive || failed_) {
+      return;
+    }
+  }
+}
+} // namespace fizz
@@ -0,0 +1,113 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/record/EncryptedRecordLayer.h>
+
+#include <folly/Executor.h>
+#include <folly/io/async/EventBase.h>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace fizz {
+
+/**
+ * Fans decryption of encrypted records out to a worker pool with
+ * in-order delivery, for single connections that need more decrypt
+ * throughput than one core provides. TLS 1.3 records decrypt
+ * independently given their sequence numbers, so the IO thread splits
+ * records out with EncryptedReadRecordLayer::readCiphertextRecord() and
+ * enqueues them here; results are reordered on the event base thread
+ * and delivered to the callback strictly in sequence order.
+ *
+ * Each worker slot owns a dedicated aead keyed with the connection's
+ * read traffic key (available post-handshake via
+ * getRecordLayerState()); records are distributed across slots by
+ * sequence number, with a per-slot lock serializing use of each aead.
+ *
+ * In-flight records assume a fixed read key, so pipelined connections
+ * must not use traffic key updates.
+ */
+class DecryptionPipeline {
+ public:
+  class Callback {
+   public:
+    virtual ~Callback() = default;
+
+    /**
+     * A decrypted message, delivered on the event base in sequence
+     * order. The callback may destroy the pipeline.
+     */
+    virtual void pipelineMessage(TLSMessage msg) = 0;
+
+    /**
+     * A record failed to decrypt or parse. Delivered once; any
+     * undelivered messages are dropped.
+     */
+    virtual void pipelineError(ReadError error) = 0;
+  };
+
+  /**
+   * aeads determines the fan-out width; useAdditionalData must match the
+   * read record layer's negotiated draft version behavior.
+   */
+  DecryptionPipeline(
+      folly::Executor* executor,
+      std::vector<std::unique_ptr<Aead>> aeads,
+      folly::EventBase* evb,
+      bool useAdditionalData = true);
+
+  ~DecryptionPipeline();
+
+  void setCallback(Callback* callback) {
+    callback_ = callback;
+  }
+
+  /**
+   * Enqueues one record for decryption. Must be called on the event
+   * base thread, with monotonically increasing sequence numbers.
+   */
+  void enqueue(CiphertextRecord record);
+
+ private:
+  struct Worker {
+    explicit Worker(std::unique_ptr<Aead> workerAead)
+        : aead(std::move(workerAead)) {}
+
+    std::unique_ptr<Aead> aead;
+    std::mutex lock;
+  };
+
+  // Shared with in-flight tasks so completions posted after destruction
+  // are dropped rather than touching a dead pipeline.
+  struct LivenessToken {
+    std::atomic<bool> alive{true};
+  };
+
+  void onResult(uint64_t seqNum, ReadResult<TLSMessage> result);
+
+  folly::Executor* executor_;
+  folly::EventBase* evb_;
+  // Shared so tasks keep their worker slot (and its aead) alive even if
+  // the pipeline is destroyed while they are queued.
+  std::vector<std::shared_ptr<Worker>> workers_;
+  bool useAdditionalData_;
+  Callback* callback_{nullptr};
+
+  std::shared_ptr<LivenessToken> liveness_;
+  std::map<uint64_t, TLSMessage> pending_;
+  uint64_t nextDeliverSeq_{0};
+  bool seqInitialized_{false};
+  bool failed_{false};
+};
+} // namespace fizz
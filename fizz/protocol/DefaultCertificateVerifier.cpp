@@ -6,7 +6,9 @@
  *  LICENSE file in the root directory of this source tree.
  */
 
+#include <fizz/crypto/Sha256.h>
 #include <fizz/protocol/DefaultCertificateVerifier.h>
+#include <folly/ScopeGuard.h>
 #include <folly/ssl/OpenSSLCertUtils.h>
 
 namespace fizz {
@@ -17,6 +19,21 @@ struct STACK_OF_X509_deleter {
   }
 };
 
+namespace {
+/**
+ * Returns a thread local X509_STORE_CTX, allocated on first use. The context
+ * is fully re-initialized by X509_STORE_CTX_init after a cleanup, so reusing
+ * it avoids the malloc-heavy X509_STORE_CTX_new on every handshake.
+ */
+folly::ssl::X509StoreCtxUniquePtr& getThreadLocalStoreCtx() {
+  static thread_local folly::ssl::X509StoreCtxUniquePtr ctx;
+  if (!ctx) {
+    ctx.reset(X509_STORE_CTX_new());
+  }
+  return ctx;
+}
+} // namespace
+
 /* static */ std::unique_ptr<DefaultCertificateVerifier>
 DefaultCertificateVerifier::createFromCAFile(
     VerificationContext context,
@@ -32,6 +49,30 @@ void DefaultCertificateVerifier::verify(
     throw std::runtime_error("no certificates to verify");
   }
 
+  std::string cacheKey;
+  if (cache_) {
+    cacheKey = getCacheKey(certs);
+    bool cached = false;
+    {
+      auto cacheMap = cache_->wlock();
+      auto result = cacheMap->find(cacheKey);
+      if (result != cacheMap->end()) {
+        if (withinValidityWindows(certs)) {
+          cached = true;
+        } else {
+          // The chain verified previously but has since left its validity
+          // window. Drop the entry and re-verify so the failure surfaces.
+          cacheMap->erase(cacheKey);
+        }
+      }
+    }
+    if (cached) {
+      cacheHits_++;
+      return;
+    }
+    cacheMisses_++;
+  }
+
   auto leafCert = certs.front()->getX509();
 
   auto certChainStack = std::unique_ptr<STACK_OF(X509), STACK_OF_X509_deleter>(
@@ -44,10 +85,13 @@ void DefaultCertificateVerifier::verify(
     sk_X509_push(certChainStack.get(), certs[i]->getX509().get());
   }
 
-  auto ctx = folly::ssl::X509StoreCtxUniquePtr(X509_STORE_CTX_new());
+  auto& ctx = getThreadLocalStoreCtx();
   if (!ctx) {
     throw std::bad_alloc();
   }
+  SCOPE_EXIT {
+    X509_STORE_CTX_cleanup(ctx.get());
+  };
 
   if (X509_STORE_CTX_init(
           ctx.get(),
@@ -68,17 +112,8 @@ void DefaultCertificateVerifier::verify(
     X509_STORE_CTX_set_verify_cb(ctx.get(), customVerifyCallback_);
   }
 
-  folly::ssl::X509VerifyParam param(X509_VERIFY_PARAM_new());
-  if (!param) {
-    throw std::bad_alloc();
-  }
-
-  if (X509_VERIFY_PARAM_set_flags(param.get(), X509_V_FLAG_X509_STRICT) != 1) {
-    throw std::runtime_error("failed to set strict certificate checking");
-  }
-
   if (X509_VERIFY_PARAM_set1(
-          X509_STORE_CTX_get0_param(ctx.get()), param.get()) != 1) {
+          X509_STORE_CTX_get0_param(ctx.get()), verifyParam_.get()) != 1) {
     throw std::runtime_error("failed to apply verification parameters");
   }
 
@@ -88,6 +123,44 @@ void DefaultCertificateVerifier::verify(
         std::string(X509_verify_cert_error_string(errorInt));
     throw std::runtime_error("certificate verification failed: " + errorText);
   }
+
+  if (cache_) {
+    cache_->wlock()->set(std::move(cacheKey), folly::unit);
+  }
+}
+
+void DefaultCertificateVerifier::setVerificationCacheSize(size_t maxEntries) {
+  if (maxEntries == 0) {
+    cache_.reset();
+    return;
+  }
+  cache_ = std::make_unique<folly::Synchronized<VerificationCache>>(
+      VerificationCache(maxEntries));
+}
+
+std::string DefaultCertificateVerifier::getCacheKey(
+    const std::vector<std::shared_ptr<const fizz::PeerCert>>& certs) {
+  Sha256 hasher;
+  hasher.hash_init();
+  for (const auto& cert : certs) {
+    auto der = folly::ssl::OpenSSLCertUtils::derEncode(*cert->getX509());
+    hasher.hash_update(*der);
+  }
+  std::array<uint8_t, Sha256::HashLen> digest;
+  hasher.hash_final(folly::MutableByteRange(digest.data(), digest.size()));
+  return std::string(reinterpret_cast<char*>(digest.data()), digest.size());
+}
+
+bool DefaultCertificateVerifier::withinValidityWindows(
+    const std::vector<std::shared_ptr<const fizz::PeerCert>>& certs) {
+  for (const auto& cert : certs) {
+    auto x509 = cert->getX509();
+    if (X509_cmp_time(X509_get_notBefore(x509.get()), nullptr) >= 0 ||
+        X509_cmp_time(X509_get_notAfter(x509.get()), nullptr) <= 0) {
+      return false;
+    }
+  }
+  return true;
 }
 
 void DefaultCertificateVerifier::createAuthorities() {
@@ -116,6 +189,30 @@ void DefaultCertificateVerifier::createAuthorities() {
     }
   }
   authorities_ = std::move(auth);
+
+  // Retrieving an object forces the store's object stack to be sorted now,
+  // so the first verification does not pay for building the lookup index.
+  if (sk_X509_OBJECT_num(entries) > 0) {
+    X509_OBJECT* first = sk_X509_OBJECT_value(entries, 0);
+    if (X509_OBJECT_get_type(first) == X509_LU_X509) {
+      X509_OBJECT_retrieve_by_subject(
+          entries,
+          X509_LU_X509,
+          X509_get_subject_name(X509_OBJECT_get0_X509(first)));
+    }
+  }
+}
+
+void DefaultCertificateVerifier::createVerifyParameters() {
+  verifyParam_.reset(X509_VERIFY_PARAM_new());
+  if (!verifyParam_) {
+    throw std::bad_alloc();
+  }
+
+  if (X509_VERIFY_PARAM_set_flags(
+          verifyParam_.get(), X509_V_FLAG_X509_STRICT) != 1) {
+    throw std::runtime_error("failed to set strict certificate checking");
+  }
 }
 
 X509_STORE* DefaultCertificateVerifier::getDefaultX509Store() {
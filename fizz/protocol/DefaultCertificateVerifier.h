@@ -9,6 +9,10 @@
 #pragma once
 
 #include <fizz/protocol/CertificateVerifier.h>
+#include <folly/Synchronized.h>
+#include <folly/container/EvictingCacheMap.h>
+
+#include <atomic>
 
 namespace fizz {
 
@@ -31,6 +35,7 @@ class DefaultCertificateVerifier : public CertificateVerifier {
   explicit DefaultCertificateVerifier(VerificationContext context)
       : context_(context), x509Store_(nullptr) {
     createAuthorities();
+    createVerifyParameters();
   }
 
   explicit DefaultCertificateVerifier(
@@ -38,6 +43,7 @@ class DefaultCertificateVerifier : public CertificateVerifier {
       folly::ssl::X509StoreUniquePtr&& store)
       : context_(context), x509Store_(std::move(store)) {
     createAuthorities();
+    createVerifyParameters();
   }
 
   void verify(const std::vector<std::shared_ptr<const fizz::PeerCert>>& certs)
@@ -52,6 +58,23 @@ class DefaultCertificateVerifier : public CertificateVerifier {
     createAuthorities();
   }
 
+  /**
+   * Enables memoization of successful verifications, keyed by a hash of the
+   * DER-encoded chain. Repeat chains short-circuit to a cache lookup as long
+   * as every certificate in the chain is still within its validity window.
+   * The least recently used entry is evicted when the limit is reached. A
+   * size of 0 (the default) disables the cache.
+   */
+  void setVerificationCacheSize(size_t maxEntries);
+
+  uint64_t getVerificationCacheHits() const {
+    return cacheHits_.load();
+  }
+
+  uint64_t getVerificationCacheMisses() const {
+    return cacheMisses_.load();
+  }
+
   std::vector<Extension> getCertificateRequestExtensions() const override;
 
   static X509_STORE* getDefaultX509Store();
@@ -61,11 +84,25 @@ class DefaultCertificateVerifier : public CertificateVerifier {
       const std::string& caFile);
 
  private:
+  using VerificationCache = folly::EvictingCacheMap<std::string, folly::Unit>;
+
   void createAuthorities();
 
+  void createVerifyParameters();
+
+  static std::string getCacheKey(
+      const std::vector<std::shared_ptr<const fizz::PeerCert>>& certs);
+
+  static bool withinValidityWindows(
+      const std::vector<std::shared_ptr<const fizz::PeerCert>>& certs);
+
   CertificateAuthorities authorities_;
   VerificationContext context_;
   folly::ssl::X509StoreUniquePtr x509Store_;
+  folly::ssl::X509VerifyParam verifyParam_{nullptr};
   X509VerifyCallback customVerifyCallback_{nullptr};
+  mutable std::unique_ptr<folly::Synchronized<VerificationCache>> cache_;
+  mutable std::atomic<uint64_t> cacheHits_{0};
+  mutable std::atomic<uint64_t> cacheMisses_{0};
 };
 } // namespace fizz
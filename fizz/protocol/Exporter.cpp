@@ -32,4 +32,41 @@ Buf Exporter::getEkm(
       folly::IOBuf::wrapBuffer(hashedContext),
       length);
 }
+
+ExporterContext::ExporterContext(
+    const Factory& factory,
+    CipherSuite cipher,
+    folly::ByteRange exporterMaster)
+    : deriver_(factory.makeKeyDeriver(cipher)),
+      exporterMaster_(exporterMaster.begin(), exporterMaster.end()) {}
+
+Buf ExporterContext::getEkm(
+    folly::StringPiece label,
+    Buf context,
+    uint16_t length) {
+  if (!context) {
+    context = folly::IOBuf::create(0);
+  }
+  if (lastEkm_ && lastEkm_->label == label && lastEkm_->length == length &&
+      folly::IOBufEqualTo()(lastEkm_->context, context)) {
+    return lastEkm_->ekm->clone();
+  }
+  auto it = labelSecrets_.find(label.str());
+  if (it == labelSecrets_.end()) {
+    auto secret = deriver_->deriveSecret(
+        folly::range(exporterMaster_), label, deriver_->blankHash());
+    it = labelSecrets_.emplace(label.str(), std::move(secret)).first;
+  }
+  std::vector<uint8_t> base(deriver_->hashLength());
+  folly::MutableByteRange hashedContext(base.data(), base.size());
+  deriver_->hash(*context, hashedContext);
+  auto ekm = deriver_->expandLabel(
+      folly::range(it->second),
+      "exporter",
+      folly::IOBuf::wrapBuffer(hashedContext),
+      length);
+  lastEkm_ = CachedEkm{
+      label.str(), std::move(context), length, ekm->clone()};
+  return ekm;
+}
 } // namespace fizz
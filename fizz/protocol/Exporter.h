@@ -11,6 +11,8 @@
 #include <fizz/crypto/KeyDerivation.h>
 #include <fizz/protocol/Factory.h>
 
+#include <map>
+
 namespace fizz {
 
 class Exporter {
@@ -23,4 +25,38 @@ class Exporter {
       Buf context,
       uint16_t length);
 };
+
+/**
+ * Caches exporter derivations for a single connection. Exporter::getEkm
+ * rederives from the exporter master secret on every call, including a hash
+ * of the context and two HKDF expands; callers like token binding and
+ * channel binding request the same label repeatedly per connection. This
+ * object caches the label-derived secret, so repeat calls with a new context
+ * cost one hash and one expand, and repeat calls with an identical context
+ * and length return the cached keying material directly.
+ *
+ * Not thread safe; intended to be owned by a connection.
+ */
+class ExporterContext {
+ public:
+  ExporterContext(
+      const Factory& factory,
+      CipherSuite cipher,
+      folly::ByteRange exporterMaster);
+
+  Buf getEkm(folly::StringPiece label, Buf context, uint16_t length);
+
+ private:
+  struct CachedEkm {
+    std::string label;
+    Buf context;
+    uint16_t length;
+    Buf ekm;
+  };
+
+  std::unique_ptr<KeyDerivation> deriver_;
+  std::vector<uint8_t> exporterMaster_;
+  std::map<std::string, std::vector<uint8_t>> labelSecrets_;
+  folly::Optional<CachedEkm> lastEkm_;
+};
 } // namespace fizz
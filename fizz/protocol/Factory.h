@@ -20,6 +20,7 @@
 #include <fizz/protocol/Certificate.h>
 #include <fizz/protocol/HandshakeContext.h>
 #include <fizz/protocol/KeyScheduler.h>
+#include <fizz/protocol/Types.h>
 #include <fizz/record/EncryptedRecordLayer.h>
 #include <fizz/record/PlaintextRecordLayer.h>
 #include <fizz/record/Types.h>
@@ -65,6 +66,24 @@ class Factory {
   virtual std::unique_ptr<HandshakeContext> makeHandshakeContext(
       CipherSuite cipher) const = 0;
 
+  /**
+   * Returns a handshake context whose transcript starts with the static
+   * message_hash header used when a HelloRetryRequest replaces the initial
+   * ClientHello. The caller appends the hash of the initial ClientHello
+   * directly after it.
+   */
+  virtual std::unique_ptr<HandshakeContext> makeHrrHandshakeContext(
+      CipherSuite cipher) const {
+    auto context = makeHandshakeContext(cipher);
+    auto header = folly::IOBuf::create(4);
+    folly::io::Appender appender(header.get(), 0);
+    appender.writeBE<uint8_t>(
+        static_cast<uint8_t>(HandshakeType::message_hash));
+    detail::writeBits24(getHashSize(getHashFunction(cipher)), appender);
+    context->appendToTranscript(header);
+    return context;
+  }
+
   virtual std::unique_ptr<KeyExchange> makeKeyExchange(NamedGroup group) const {
     switch (group) {
       case NamedGroup::secp256r1:
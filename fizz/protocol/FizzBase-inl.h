@@ -10,6 +10,19 @@
 #include <fizz/util/Workarounds.h>
 
 namespace fizz {
+namespace detail {
+
+// Calls visitor.flushActions() if the visitor provides it, letting visitors
+// that batch transport writes flush once per set of actions.
+template <typename T>
+auto flushVisitor(T& visitor, int) -> decltype(visitor.flushActions()) {
+  return visitor.flushActions();
+}
+
+template <typename T>
+void flushVisitor(T&, ...) {}
+} // namespace detail
+
 template <typename Derived, typename ActionMoveVisitor, typename StateMachine>
 void FizzBase<Derived, ActionMoveVisitor, StateMachine>::writeNewSessionTicket(
     WriteNewSessionTicket w) {
@@ -30,6 +43,13 @@ void FizzBase<Derived, ActionMoveVisitor, StateMachine>::earlyAppWrite(
   processPendingEvents();
 }
 
+template <typename Derived, typename ActionMoveVisitor, typename StateMachine>
+void FizzBase<Derived, ActionMoveVisitor, StateMachine>::initiateKeyUpdate(
+    KeyUpdateInitiation keyUpdateInitiation) {
+  pendingEvents_.push_back(std::move(keyUpdateInitiation));
+  processPendingEvents();
+}
+
 template <typename Derived, typename ActionMoveVisitor, typename StateMachine>
 void FizzBase<Derived, ActionMoveVisitor, StateMachine>::appClose() {
   pendingEvents_.push_back(AppClose::WAIT);
@@ -97,6 +117,20 @@ bool FizzBase<Derived, ActionMoveVisitor, StateMachine>::actionProcessing()
   return actionGuard_.hasValue();
 }
 
+template <typename Derived, typename ActionMoveVisitor, typename StateMachine>
+void FizzBase<Derived, ActionMoveVisitor, StateMachine>::setHandshakeScheduler(
+    HandshakeScheduler* scheduler,
+    HandshakeScheduler::Priority priority) {
+  handshakeScheduler_ = scheduler;
+  handshakePriority_ = priority;
+}
+
+template <typename Derived, typename ActionMoveVisitor, typename StateMachine>
+void FizzBase<Derived, ActionMoveVisitor, StateMachine>::
+    setEventFlushCoalescing(bool enabled) {
+  coalesceEventFlushes_ = enabled;
+}
+
 template <typename Derived, typename ActionMoveVisitor, typename StateMachine>
 void FizzBase<Derived, ActionMoveVisitor, StateMachine>::processActions(
     typename StateMachine::CompletedActions actions) {
@@ -107,6 +141,13 @@ void FizzBase<Derived, ActionMoveVisitor, StateMachine>::processActions(
   for (auto& action : actions) {
     boost::apply_visitor(visitor_, action);
   }
+  if (coalesceEventFlushes_ && inProcessPendingEvents_) {
+    // Mid-drain of queued events; defer so the whole batch flushes once
+    // when processPendingEvents() finishes.
+    pendingFlush_ = true;
+  } else {
+    detail::flushVisitor(visitor_, 0);
+  }
 
   actionGuard_.clear();
   processPendingEvents();
@@ -135,12 +176,34 @@ void FizzBase<Derived, ActionMoveVisitor, StateMachine>::
   inProcessPendingEvents_ = true;
   SCOPE_EXIT {
     inProcessPendingEvents_ = false;
+    if (pendingFlush_) {
+      pendingFlush_ = false;
+      detail::flushVisitor(visitor_, 0);
+    }
   };
 
   while (!actionGuard_ && !inTerminalState()) {
+    if (schedulerPaused_) {
+      // Out of handshake budget; the scheduler's resume callback will
+      // re-enter.
+      return;
+    }
     folly::Optional<typename StateMachine::ProcessingActions> actions;
     actionGuard_ = folly::DelayedDestruction::DestructorGuard(owner_);
     if (!waitForData_) {
+      if (handshakeScheduler_ &&
+          !handshakeScheduler_->admit(handshakePriority_)) {
+        schedulerPaused_ = true;
+        handshakeScheduler_->scheduleResume(
+            [this, guard = folly::DelayedDestruction::DestructorGuard(owner_)] {
+              schedulerPaused_ = false;
+              if (!inTerminalState()) {
+                processPendingEvents();
+              }
+            });
+        actionGuard_.clear();
+        return;
+      }
       actions = machine_.processSocketData(state_, transportReadBuf_);
     } else if (!pendingEvents_.empty()) {
       auto event = std::move(pendingEvents_.front());
@@ -158,6 +221,10 @@ void FizzBase<Derived, ActionMoveVisitor, StateMachine>::
           [&actions, this](EarlyAppWrite& write) {
             actions = machine_.processEarlyAppWrite(state_, std::move(write));
           },
+          [&actions, this](KeyUpdateInitiation& keyUpdateInitiation) {
+            actions = machine_.processKeyUpdateInitiation(
+                state_, std::move(keyUpdateInitiation));
+          },
           [&actions, this](AppClose& close) {
             if (close.policy == AppClose::WAIT) {
               actions = machine_.processAppClose(state_);
@@ -9,6 +9,7 @@
 #pragma once
 
 #include <fizz/protocol/Factory.h>
+#include <fizz/protocol/HandshakeScheduler.h>
 #include <fizz/protocol/Params.h>
 #include <folly/Overload.h>
 
@@ -51,6 +52,13 @@ class FizzBase {
    */
   void earlyAppWrite(EarlyAppWrite appWrite);
 
+  /**
+   * Called when the application wants to initiate a KeyUpdate, rotating
+   * its own traffic keys and optionally requesting that the peer rotate
+   * as well.
+   */
+  void initiateKeyUpdate(KeyUpdateInitiation keyUpdateInitiation);
+
   /**
    * Called when the application wants to close the connection, and wait for
    * the corresponding peer's acknowledgement.
@@ -100,6 +108,30 @@ class FizzBase {
    */
   bool actionProcessing() const;
 
+  /**
+   * Sets the scheduler used to admission-control processing of transport
+   * data, along with this connection's priority tier. While a scheduler is
+   * set, each round of socket data processing must be admitted; when denied,
+   * processing pauses until the scheduler resumes it. Pass nullptr to exempt
+   * the connection (typically once its handshake completes). The scheduler
+   * must not be deleted while attached.
+   */
+  void setHandshakeScheduler(
+      HandshakeScheduler* scheduler,
+      HandshakeScheduler::Priority priority =
+          HandshakeScheduler::Priority::Normal);
+
+  /**
+   * Controls whether visitor flushes coalesce across a synchronous drain
+   * of queued events. When enabled (the default), a read that delivers
+   * several handshake messages produces a single flushActions() call
+   * after the last message's actions, merging the flight's transport
+   * writes into one; when disabled, every event's actions flush
+   * individually. The flush always happens before control returns to the
+   * caller.
+   */
+  void setEventFlushCoalescing(bool enabled);
+
   /**
    * Returns an exported key material derived from the 1-RTT secret of the TLS
    * connection.
@@ -125,12 +157,22 @@ class FizzBase {
   ActionMoveVisitor& visitor_;
   folly::DelayedDestructionBase* owner_;
 
-  using PendingEvent =
-      boost::variant<AppWrite, EarlyAppWrite, AppClose, WriteNewSessionTicket>;
+  using PendingEvent = boost::variant<
+      AppWrite,
+      EarlyAppWrite,
+      AppClose,
+      WriteNewSessionTicket,
+      KeyUpdateInitiation>;
   std::deque<PendingEvent> pendingEvents_;
+  HandshakeScheduler* handshakeScheduler_{nullptr};
+  HandshakeScheduler::Priority handshakePriority_{
+      HandshakeScheduler::Priority::Normal};
+  bool schedulerPaused_{false};
   bool waitForData_{true};
   folly::Optional<folly::DelayedDestruction::DestructorGuard> actionGuard_;
   bool inProcessPendingEvents_{false};
+  bool coalesceEventFlushes_{true};
+  bool pendingFlush_{false};
   bool externalError_{false};
 };
 } // namespace fizz
@@ -7,6 +7,7 @@
  */
 
 #include <fizz/crypto/KeyDerivation.h>
+#include <fizz/crypto/Utils.h>
 
 namespace fizz {
 
@@ -32,18 +33,60 @@ Buf HandshakeContextImpl<Hash>::getHandshakeContext() const {
   return out;
 }
 
+template <typename Hash>
+void HandshakeContextImpl<Hash>::getFinishedDataInto(
+    folly::ByteRange baseKey,
+    folly::MutableByteRange out) const {
+  // The finished key is exactly one hash long and derives from an empty
+  // hash value, so a single HKDF round suffices:
+  // key = HMAC(baseKey, HkdfLabel || 0x01). Encode the label into a fixed
+  // scratch rather than the info buffer chain expandLabel builds.
+  constexpr folly::StringPiece label{"finished"};
+  std::array<uint8_t, 64> info;
+  size_t labelLen = hkdfLabelPrefix_.size() + label.size();
+  // length(2) + label length(1) + label + hash length(1) + round(1)
+  CHECK_LE(labelLen + 5, info.size());
+  size_t idx = 0;
+  info[idx++] = Hash::HashLen >> 8;
+  info[idx++] = Hash::HashLen & 0xff;
+  info[idx++] = labelLen;
+  memcpy(info.data() + idx, hkdfLabelPrefix_.data(), hkdfLabelPrefix_.size());
+  idx += hkdfLabelPrefix_.size();
+  memcpy(info.data() + idx, label.data(), label.size());
+  idx += label.size();
+  info[idx++] = 0; // empty hash value
+  info[idx++] = 1; // round number
+  std::array<uint8_t, Hash::HashLen> finishedKey;
+  Hash::hmac(
+      baseKey,
+      folly::IOBuf::wrapBufferAsValue(info.data(), idx),
+      folly::range(finishedKey));
+
+  std::array<uint8_t, Hash::HashLen> context;
+  Hash copied(hashState_);
+  copied.hash_final(folly::range(context));
+  Hash::hmac(
+      folly::range(finishedKey),
+      folly::IOBuf::wrapBufferAsValue(context.data(), context.size()),
+      out);
+}
+
 template <typename Hash>
 Buf HandshakeContextImpl<Hash>::getFinishedData(
     folly::ByteRange baseKey) const {
-  auto context = getHandshakeContext();
-  auto finishedKey =
-      KeyDerivationImpl<Hash>(hkdfLabelPrefix_)
-          .expandLabel(
-              baseKey, "finished", folly::IOBuf::create(0), Hash::HashLen);
   auto data = folly::IOBuf::create(Hash::HashLen);
   data->append(Hash::HashLen);
-  auto outRange = folly::MutableByteRange(data->writableData(), data->length());
-  Hash::hmac(finishedKey->coalesce(), *context, outRange);
+  getFinishedDataInto(
+      baseKey, folly::MutableByteRange(data->writableData(), data->length()));
   return data;
 }
+
+template <typename Hash>
+bool HandshakeContextImpl<Hash>::verifyFinishedData(
+    folly::ByteRange baseKey,
+    folly::ByteRange finishedData) const {
+  std::array<uint8_t, Hash::HashLen> expected;
+  getFinishedDataInto(baseKey, folly::range(expected));
+  return CryptoUtils::equal(folly::range(expected), finishedData);
+}
 } // namespace fizz
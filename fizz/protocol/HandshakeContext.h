@@ -9,6 +9,7 @@
 #pragma once
 
 #include <fizz/record/Types.h>
+#include <fizz/util/ObjectRecycler.h>
 
 namespace fizz {
 
@@ -36,14 +37,32 @@ class HandshakeContext {
    */
   virtual Buf getFinishedData(folly::ByteRange baseKey) const = 0;
 
+  /**
+   * Verifies finished verify_data against the current handshake context and
+   * baseKey. Computes the expected value into stack storage and compares in
+   * constant time, avoiding the allocations getFinishedData() makes.
+   */
+  virtual bool verifyFinishedData(
+      folly::ByteRange baseKey,
+      folly::ByteRange finishedData) const = 0;
+
   /**
    * Returns the handshake context for an empty transcript.
    */
   virtual folly::ByteRange getBlankContext() const = 0;
+
+  /**
+   * Returns an independent copy of this context. The fork continues the
+   * transcript from the current midstate, so neither context needs to rehash
+   * the data appended so far.
+   */
+  virtual std::unique_ptr<HandshakeContext> fork() const = 0;
 };
 
 template <typename Hash>
-class HandshakeContextImpl : public HandshakeContext {
+class HandshakeContextImpl
+    : public HandshakeContext,
+      public PerThreadRecycled<HandshakeContextImpl<Hash>> {
  public:
   HandshakeContextImpl(const std::string& hkdfLabelPrefix);
 
@@ -53,11 +72,23 @@ class HandshakeContextImpl : public HandshakeContext {
 
   Buf getFinishedData(folly::ByteRange baseKey) const override;
 
+  bool verifyFinishedData(
+      folly::ByteRange baseKey,
+      folly::ByteRange finishedData) const override;
+
   folly::ByteRange getBlankContext() const override {
     return Hash::BlankHash;
   }
 
+  std::unique_ptr<HandshakeContext> fork() const override {
+    return std::make_unique<HandshakeContextImpl>(*this);
+  }
+
  private:
+  void getFinishedDataInto(
+      folly::ByteRange baseKey,
+      folly::MutableByteRange out) const;
+
   Hash hashState_;
   std::string hkdfLabelPrefix_;
 };
@@ -0,0 +1,80 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/util/Workarounds.h>
+
+namespace fizz {
+
+template <typename SM>
+folly::Future<folly::Unit> HandshakeDriver<SM>::run(AsyncActions initial) {
+  return handleAsyncActions(std::move(initial));
+}
+
+template <typename SM>
+folly::Future<folly::Unit> HandshakeDriver<SM>::handleAsyncActions(
+    AsyncActions asyncActions) {
+  // A future here is a suspension point: an async certificate, signature or
+  // replay operation is in flight.
+  auto future = boost::get<folly::Future<Actions>>(&asyncActions);
+  if (future) {
+    return std::move(*future).thenValue(
+        [this](Actions actions) { return handleActions(std::move(actions)); });
+  }
+  return handleActions(std::move(boost::get<Actions>(asyncActions)));
+}
+
+template <typename SM>
+folly::Future<folly::Unit> HandshakeDriver<SM>::handleActions(
+    Actions actions) {
+  for (auto& action : actions) {
+    folly::variant_match(
+        action,
+        detail::result_type<void>(),
+        [this](folly::Function<void(State&)>& mutateState) {
+          mutateState(state_);
+        },
+        [this](WriteToSocket& write) { writeFn_(std::move(write)); },
+        [this](typename SM::ReportSuccess&) { done_ = true; },
+        [this](ReportError& report) { error_ = std::move(report.error); },
+        [this](WaitForData&) { waitingForData_ = true; },
+        [this](EndOfData&) {
+          error_ = folly::make_exception_wrapper<std::runtime_error>(
+              "connection closed during handshake");
+        },
+        [](auto&) {
+          // Actions not needed to drive a plain handshake (secrets, early
+          // data reports, cached psks) are ignored.
+        });
+    if (error_) {
+      return folly::makeFuture<folly::Unit>(std::move(error_));
+    }
+  }
+  return advance();
+}
+
+template <typename SM>
+folly::Future<folly::Unit> HandshakeDriver<SM>::advance() {
+  if (done_) {
+    return folly::makeFuture();
+  }
+  if (waitingForData_) {
+    return readFn_().thenValue([this](Buf data) {
+      if (!data || data->computeChainDataLength() == 0) {
+        return folly::makeFuture<folly::Unit>(
+            folly::make_exception_wrapper<std::runtime_error>(
+                "transport closed during handshake"));
+      }
+      transportReadBuf_.append(std::move(data));
+      waitingForData_ = false;
+      return advance();
+    });
+  }
+  return handleAsyncActions(
+      machine_.processSocketData(state_, transportReadBuf_));
+}
+} // namespace fizz
@@ -0,0 +1,93 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/protocol/Actions.h>
+#include <folly/futures/Future.h>
+#include <folly/io/IOBufQueue.h>
+
+namespace fizz {
+
+/**
+ * HandshakeDriver runs a handshake to completion as one sequential chain of
+ * futures over a client or server state machine.
+ *
+ * FizzBase processes events through a pending-event queue and a visitor over
+ * the Action variant, which obscures the linear structure of a handshake and
+ * makes async suspension points (certificate selection, signatures, replay
+ * checks) awkward to follow. Here each flight is one step in a chain: the
+ * driver processes buffered records, applies the resulting actions in order,
+ * and suspends whenever the state machine returns a future or needs more
+ * transport data.
+ *
+ * The driver is intended for linear handshake flows such as tools, tests and
+ * custom transports; AsyncFizzClient/AsyncFizzServer continue to use
+ * FizzBase, which also handles application data and post-handshake events.
+ * Early data is not supported. The driver must outlive the future returned
+ * by run().
+ */
+template <typename SM>
+class HandshakeDriver {
+ public:
+  using State = typename SM::StateType;
+  using Actions = typename SM::CompletedActions;
+  using AsyncActions = typename SM::ProcessingActions;
+
+  /**
+   * Invoked when the handshake needs more transport data; completes with the
+   * next chunk read from the transport. An empty result is treated as the
+   * transport closing.
+   */
+  using ReadFunction = folly::Function<folly::Future<Buf>()>;
+
+  /**
+   * Invoked when records must be written to the transport.
+   */
+  using WriteFunction = folly::Function<void(WriteToSocket)>;
+
+  HandshakeDriver(ReadFunction readFn, WriteFunction writeFn)
+      : readFn_(std::move(readFn)), writeFn_(std::move(writeFn)) {}
+
+  /**
+   * Runs the handshake to completion starting from the given initial
+   * transition, typically processConnect or processAccept invoked on
+   * machine() and state(). The returned future completes once the state
+   * machine reports handshake success, or fails with the reported error.
+   */
+  folly::Future<folly::Unit> run(AsyncActions initial);
+
+  SM& machine() {
+    return machine_;
+  }
+
+  State& state() {
+    return state_;
+  }
+
+  const State& state() const {
+    return state_;
+  }
+
+ private:
+  folly::Future<folly::Unit> handleAsyncActions(AsyncActions asyncActions);
+  folly::Future<folly::Unit> handleActions(Actions actions);
+  folly::Future<folly::Unit> advance();
+
+  SM machine_;
+  State state_;
+  folly::IOBufQueue transportReadBuf_{folly::IOBufQueue::cacheChainLength()};
+  ReadFunction readFn_;
+  WriteFunction writeFn_;
+  folly::exception_wrapper error_;
+  bool waitingForData_{false};
+  bool done_{false};
+};
+} // namespace fizz
+
+#include <fizz/protocol/HandshakeDriver-inl.h>
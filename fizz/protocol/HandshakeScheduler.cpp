@@ -0,0 +1,53 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/protocol/HandshakeScheduler.h>
+
+namespace fizz {
+
+PerLoopHandshakeScheduler::~PerLoopHandshakeScheduler() {
+  cancelLoopCallback();
+  // Wake anything still waiting so paused connections are not stranded.
+  auto callbacks = std::move(resumeCallbacks_);
+  for (auto& callback : callbacks) {
+    callback();
+  }
+}
+
+bool PerLoopHandshakeScheduler::admit(Priority priority) {
+  auto tier = static_cast<size_t>(priority);
+  if (used_[tier] >= budgets_[tier]) {
+    return false;
+  }
+  used_[tier]++;
+  ensureScheduled();
+  return true;
+}
+
+void PerLoopHandshakeScheduler::scheduleResume(
+    folly::Function<void()> callback) {
+  resumeCallbacks_.push_back(std::move(callback));
+  ensureScheduled();
+}
+
+void PerLoopHandshakeScheduler::ensureScheduled() {
+  if (!isLoopCallbackScheduled()) {
+    evb_->runInLoop(this);
+  }
+}
+
+void PerLoopHandshakeScheduler::runLoopCallback() noexcept {
+  used_.fill(0);
+  // A connection denied again during its resume re-registers through
+  // scheduleResume(), which schedules the next iteration's callback.
+  auto callbacks = std::move(resumeCallbacks_);
+  for (auto& callback : callbacks) {
+    callback();
+  }
+}
+} // namespace fizz
@@ -0,0 +1,87 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <folly/Function.h>
+#include <folly/io/async/EventBase.h>
+
+#include <array>
+#include <vector>
+
+namespace fizz {
+
+/**
+ * Admission control for handshake processing.
+ *
+ * Handshake crypto is CPU-heavy relative to established-connection IO.
+ * Without a cap, an accept burst on a shared EventBase runs every pending
+ * handshake to completion and starves the established connections on the
+ * same thread. A scheduler bounds how much handshake work runs at once;
+ * connections that are denied yield and resume once budget is available.
+ *
+ * Schedulers are not thread-safe and must only be used from a single
+ * EventBase thread.
+ */
+class HandshakeScheduler {
+ public:
+  /**
+   * Priority tier for a connection's handshake work. Budget exhaustion
+   * affects lower tiers first.
+   */
+  enum class Priority : uint8_t { High = 0, Normal = 1, Low = 2 };
+
+  static constexpr size_t kNumPriorities = 3;
+
+  virtual ~HandshakeScheduler() = default;
+
+  /**
+   * Returns true if one handshake event at the given priority may be
+   * processed now. A connection that is denied must stop processing and
+   * call scheduleResume() to be woken when budget is available again.
+   */
+  virtual bool admit(Priority priority) = 0;
+
+  /**
+   * Invokes callback once more handshake budget is available. Any pending
+   * callbacks are invoked if the scheduler is destroyed, so that paused
+   * connections are not stranded.
+   */
+  virtual void scheduleResume(folly::Function<void()> callback) = 0;
+};
+
+/**
+ * HandshakeScheduler that admits a fixed number of handshake events per
+ * priority tier in each EventBase loop iteration. Budgets renew in the
+ * loop callback phase, so a denied connection resumes on a later iteration
+ * after established-connection IO has had a chance to run.
+ */
+class PerLoopHandshakeScheduler : public HandshakeScheduler,
+                                  private folly::EventBase::LoopCallback {
+ public:
+  PerLoopHandshakeScheduler(
+      folly::EventBase* evb,
+      std::array<uint32_t, kNumPriorities> budgets)
+      : evb_(evb), budgets_(budgets) {}
+
+  ~PerLoopHandshakeScheduler() override;
+
+  bool admit(Priority priority) override;
+
+  void scheduleResume(folly::Function<void()> callback) override;
+
+ private:
+  void runLoopCallback() noexcept override;
+  void ensureScheduled();
+
+  folly::EventBase* evb_;
+  std::array<uint32_t, kNumPriorities> budgets_;
+  std::array<uint32_t, kNumPriorities> used_{};
+  std::vector<folly::Function<void()>> resumeCallbacks_;
+};
+} // namespace fizz
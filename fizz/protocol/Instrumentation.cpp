@@ -0,0 +1,28 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/protocol/Instrumentation.h>
+
+namespace fizz {
+
+folly::StringPiece toString(CryptoPhase phase) {
+  switch (phase) {
+    case CryptoPhase::KeyExchange:
+      return "KeyExchange";
+    case CryptoPhase::Signing:
+      return "Signing";
+    case CryptoPhase::Verification:
+      return "Verification";
+    case CryptoPhase::TicketSeal:
+      return "TicketSeal";
+    case CryptoPhase::NUM_PHASES:
+      return "Invalid phase NUM_PHASES";
+  }
+  return "Invalid phase";
+}
+} // namespace fizz
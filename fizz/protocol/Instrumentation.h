@@ -0,0 +1,132 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <folly/Range.h>
+
+#include <chrono>
+#include <vector>
+
+namespace fizz {
+
+/**
+ * Crypto phases attributed by the handshake instrumentation hook.
+ */
+enum class CryptoPhase : uint8_t {
+  KeyExchange,
+  Signing,
+  Verification,
+  TicketSeal,
+  NUM_PHASES
+};
+
+folly::StringPiece toString(CryptoPhase phase);
+
+/**
+ * Per-connection hook for breaking handshake latency down into individual
+ * state transitions and crypto phases.
+ *
+ * Callbacks fire inline on the connection's thread and must not block.
+ * When no hook is registered each instrumentation site costs a single null
+ * check. Crypto phases that run asynchronously on another executor (async
+ * key exchanges, signers and ticket ciphers) are attributed only for the
+ * synchronous portion that dispatches them.
+ */
+class HandshakeInstrumentation {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  virtual ~HandshakeInstrumentation() = default;
+
+  /**
+   * The state machine entered a new state. stateName is the static string
+   * returned by toString() of the client or server StateEnum.
+   */
+  virtual void stateEntered(
+      folly::StringPiece stateName,
+      Clock::time_point when) noexcept = 0;
+
+  /**
+   * A crypto phase finished.
+   */
+  virtual void cryptoPhaseCompleted(
+      CryptoPhase phase,
+      Clock::duration elapsed) noexcept = 0;
+};
+
+/**
+ * Scoped timer that reports a crypto phase to an instrumentation hook.
+ * Does not read the clock when the hook is null.
+ */
+class CryptoPhaseTimer {
+ public:
+  CryptoPhaseTimer(HandshakeInstrumentation* instrumentation, CryptoPhase phase)
+      : instrumentation_(instrumentation), phase_(phase) {
+    if (instrumentation_) {
+      start_ = HandshakeInstrumentation::Clock::now();
+    }
+  }
+
+  ~CryptoPhaseTimer() {
+    if (instrumentation_) {
+      instrumentation_->cryptoPhaseCompleted(
+          phase_, HandshakeInstrumentation::Clock::now() - start_);
+    }
+  }
+
+  CryptoPhaseTimer(const CryptoPhaseTimer&) = delete;
+  CryptoPhaseTimer& operator=(const CryptoPhaseTimer&) = delete;
+
+ private:
+  HandshakeInstrumentation* instrumentation_;
+  CryptoPhase phase_;
+  HandshakeInstrumentation::Clock::time_point start_;
+};
+
+/**
+ * Per-connection handshake latency breakdown accumulated by
+ * HandshakeTimingCollector.
+ */
+struct HandshakeTimings {
+  struct Transition {
+    folly::StringPiece state;
+    HandshakeInstrumentation::Clock::time_point when;
+  };
+
+  std::vector<Transition> transitions;
+  std::vector<std::pair<CryptoPhase, HandshakeInstrumentation::Clock::duration>>
+      cryptoPhases;
+};
+
+/**
+ * Ready-made instrumentation hook that records every transition and crypto
+ * phase into a HandshakeTimings breakdown.
+ */
+class HandshakeTimingCollector : public HandshakeInstrumentation {
+ public:
+  void stateEntered(
+      folly::StringPiece stateName,
+      Clock::time_point when) noexcept override {
+    timings_.transitions.push_back({stateName, when});
+  }
+
+  void cryptoPhaseCompleted(
+      CryptoPhase phase,
+      Clock::duration elapsed) noexcept override {
+    timings_.cryptoPhases.emplace_back(phase, elapsed);
+  }
+
+  const HandshakeTimings& timings() const {
+    return timings_;
+  }
+
+ private:
+  HandshakeTimings timings_;
+};
+} // namespace fizz
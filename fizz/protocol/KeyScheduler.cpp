@@ -8,6 +8,10 @@
 
 #include <fizz/protocol/KeyScheduler.h>
 
+#include <folly/tracing/StaticTracepoint.h>
+
+#include <array>
+
 using folly::StringPiece;
 
 static constexpr StringPiece kTrafficKey{"key"};
@@ -29,56 +33,146 @@ static constexpr StringPiece kResumption{"resumption"};
 
 namespace fizz {
 
+// All secrets are exactly one hash long; a shared all-zero block serves as
+// both the zero salt and the zero ikm without allocating per derivation.
+static folly::ByteRange zeros(size_t length) {
+  static constexpr std::array<uint8_t, 64> kZeros{};
+  DCHECK_LE(length, kZeros.size());
+  return {kZeros.data(), length};
+}
+
 void KeyScheduler::deriveEarlySecret(folly::ByteRange psk) {
   if (secret_) {
     throw std::runtime_error("secret already set");
   }
+  FOLLY_SDT(fizz, derive_early_secret);
+
+  auto hashLength = deriver_->hashLength();
+  EarlySecret earlySecret;
+  earlySecret.secret.resize(hashLength);
+  deriver_->hkdfExtract(
+      zeros(hashLength), psk, folly::range(earlySecret.secret));
+  secret_ = std::move(earlySecret);
+}
+
+void KeyScheduler::setEarlySecret(folly::ByteRange earlySecret) {
+  if (secret_) {
+    throw std::runtime_error("secret already set");
+  }
+  if (earlySecret.size() != deriver_->hashLength()) {
+    throw std::runtime_error("early secret wrong length");
+  }
+  EarlySecret secret;
+  secret.secret = earlySecret;
+  secret_ = std::move(secret);
+}
 
-  auto zeros = std::vector<uint8_t>(deriver_->hashLength(), 0);
-  secret_ = EarlySecret{deriver_->hkdfExtract(folly::range(zeros), psk)};
+SecretStorage KeyScheduler::getEarlySecret() const {
+  auto& earlySecret = boost::get<EarlySecret>(*secret_);
+  return earlySecret.secret;
 }
 
 void KeyScheduler::deriveHandshakeSecret() {
+  FOLLY_SDT(fizz, derive_handshake_secret);
   auto& earlySecret = boost::get<EarlySecret>(*secret_);
-  auto zeros = std::vector<uint8_t>(deriver_->hashLength(), 0);
-  auto preSecret = deriver_->deriveSecret(
-      folly::range(earlySecret.secret), kDerivedSecret, deriver_->blankHash());
-  secret_ = HandshakeSecret{
-      deriver_->hkdfExtract(folly::range(preSecret), folly::range(zeros))};
+  auto hashLength = deriver_->hashLength();
+  SecretStorage preSecret;
+  preSecret.resize(hashLength);
+  deriver_->deriveSecret(
+      folly::range(earlySecret.secret),
+      kDerivedSecret,
+      deriver_->blankHash(),
+      folly::range(preSecret));
+  HandshakeSecret handshakeSecret;
+  handshakeSecret.secret.resize(hashLength);
+  deriver_->hkdfExtract(
+      folly::range(preSecret),
+      zeros(hashLength),
+      folly::range(handshakeSecret.secret));
+  secret_ = std::move(handshakeSecret);
 }
 
 void KeyScheduler::deriveHandshakeSecret(folly::ByteRange ecdhe) {
+  FOLLY_SDT(fizz, derive_handshake_secret);
+  auto hashLength = deriver_->hashLength();
   if (!secret_) {
-    auto zeros = std::vector<uint8_t>(deriver_->hashLength(), 0);
-    secret_ = EarlySecret{
-        deriver_->hkdfExtract(folly::range(zeros), folly::range(zeros))};
+    EarlySecret blankEarlySecret;
+    blankEarlySecret.secret.resize(hashLength);
+    deriver_->hkdfExtract(
+        zeros(hashLength),
+        zeros(hashLength),
+        folly::range(blankEarlySecret.secret));
+    secret_ = std::move(blankEarlySecret);
   }
 
   auto& earlySecret = boost::get<EarlySecret>(*secret_);
-  auto preSecret = deriver_->deriveSecret(
-      folly::range(earlySecret.secret), kDerivedSecret, deriver_->blankHash());
-  secret_ =
-      HandshakeSecret{deriver_->hkdfExtract(folly::range(preSecret), ecdhe)};
+  SecretStorage preSecret;
+  preSecret.resize(hashLength);
+  deriver_->deriveSecret(
+      folly::range(earlySecret.secret),
+      kDerivedSecret,
+      deriver_->blankHash(),
+      folly::range(preSecret));
+  HandshakeSecret handshakeSecret;
+  handshakeSecret.secret.resize(hashLength);
+  deriver_->hkdfExtract(
+      folly::range(preSecret), ecdhe, folly::range(handshakeSecret.secret));
+  secret_ = std::move(handshakeSecret);
 }
 
 void KeyScheduler::deriveMasterSecret() {
-  auto zeros = std::vector<uint8_t>(deriver_->hashLength(), 0);
+  FOLLY_SDT(fizz, derive_master_secret);
   auto& handshakeSecret = boost::get<HandshakeSecret>(*secret_);
-  auto preSecret = deriver_->deriveSecret(
+  auto hashLength = deriver_->hashLength();
+  SecretStorage preSecret;
+  preSecret.resize(hashLength);
+  deriver_->deriveSecret(
       folly::range(handshakeSecret.secret),
       kDerivedSecret,
-      deriver_->blankHash());
-  secret_ = MasterSecret{
-      deriver_->hkdfExtract(folly::range(preSecret), folly::range(zeros))};
+      deriver_->blankHash(),
+      folly::range(preSecret));
+  MasterSecret masterSecret;
+  masterSecret.secret.resize(hashLength);
+  deriver_->hkdfExtract(
+      folly::range(preSecret),
+      zeros(hashLength),
+      folly::range(masterSecret.secret));
+  secret_ = std::move(masterSecret);
 }
 
 void KeyScheduler::deriveAppTrafficSecrets(folly::ByteRange transcript) {
+  FOLLY_SDT(fizz, derive_app_traffic_secrets);
   auto& masterSecret = boost::get<MasterSecret>(*secret_);
+  auto hashLength = deriver_->hashLength();
   AppTrafficSecret trafficSecret;
-  trafficSecret.client = deriver_->deriveSecret(
-      folly::range(masterSecret.secret), kClientAppTraffic, transcript);
-  trafficSecret.server = deriver_->deriveSecret(
-      folly::range(masterSecret.secret), kServerAppTraffic, transcript);
+  trafficSecret.client.resize(hashLength);
+  deriver_->deriveSecret(
+      folly::range(masterSecret.secret),
+      kClientAppTraffic,
+      transcript,
+      folly::range(trafficSecret.client));
+  trafficSecret.server.resize(hashLength);
+  deriver_->deriveSecret(
+      folly::range(masterSecret.secret),
+      kServerAppTraffic,
+      transcript,
+      folly::range(trafficSecret.server));
+  appTrafficSecret_ = std::move(trafficSecret);
+}
+
+void KeyScheduler::adoptAppTrafficSecrets(
+    folly::ByteRange clientSecret,
+    folly::ByteRange serverSecret) {
+  if (secret_ || appTrafficSecret_) {
+    throw std::runtime_error("scheduler already initialized");
+  }
+  if (clientSecret.size() != deriver_->hashLength() ||
+      serverSecret.size() != deriver_->hashLength()) {
+    throw std::runtime_error("wrong traffic secret length");
+  }
+  AppTrafficSecret trafficSecret;
+  trafficSecret.client = SecretStorage(clientSecret);
+  trafficSecret.server = SecretStorage(serverSecret);
   appTrafficSecret_ = std::move(trafficSecret);
 }
 
@@ -88,6 +182,7 @@ void KeyScheduler::clearMasterSecret() {
 }
 
 uint32_t KeyScheduler::clientKeyUpdate() {
+  FOLLY_SDT(fizz, client_key_update);
   auto& appTrafficSecret = *appTrafficSecret_;
   auto buf = deriver_->expandLabel(
       folly::range(appTrafficSecret.client),
@@ -95,11 +190,12 @@ uint32_t KeyScheduler::clientKeyUpdate() {
       folly::IOBuf::create(0),
       deriver_->hashLength());
   buf->coalesce();
-  appTrafficSecret.client = std::vector<uint8_t>(buf->data(), buf->tail());
+  appTrafficSecret.client = SecretStorage(buf->data(), buf->tail());
   return ++appTrafficSecret.clientGeneration;
 }
 
 uint32_t KeyScheduler::serverKeyUpdate() {
+  FOLLY_SDT(fizz, server_key_update);
   auto& appTrafficSecret = *appTrafficSecret_;
   auto buf = deriver_->expandLabel(
       folly::range(appTrafficSecret.server),
@@ -107,7 +203,7 @@ uint32_t KeyScheduler::serverKeyUpdate() {
       folly::IOBuf::create(0),
       deriver_->hashLength());
   buf->coalesce();
-  appTrafficSecret.server = std::vector<uint8_t>(buf->data(), buf->tail());
+  appTrafficSecret.server = SecretStorage(buf->data(), buf->tail());
   return ++appTrafficSecret.serverGeneration;
 }
 
@@ -188,11 +284,11 @@ DerivedSecret KeyScheduler::getSecret(AppTrafficSecrets s) const {
   switch (s) {
     case AppTrafficSecrets::ClientAppTraffic:
       return DerivedSecret(
-          appTrafficSecret.client,
+          folly::range(appTrafficSecret.client),
           SecretType(AppTrafficSecrets::ClientAppTraffic));
     case AppTrafficSecrets::ServerAppTraffic:
       return DerivedSecret(
-          appTrafficSecret.server,
+          folly::range(appTrafficSecret.server),
           SecretType(AppTrafficSecrets::ServerAppTraffic));
     default:
       LOG(FATAL) << "unknown secret";
@@ -213,11 +309,23 @@ TrafficKey KeyScheduler::getTrafficKeyWithLabel(
     folly::StringPiece ivLabel,
     size_t keyLength,
     size_t ivLength) const {
+  // Derive both outputs in one pass rather than with two full expandLabel
+  // invocations; this path runs for every key update and handshake. The key
+  // and iv share a single buffer, viewed through two IOBufs.
+  auto buf = folly::IOBuf::create(keyLength + ivLength);
+  buf->append(keyLength + ivLength);
+  deriver_->expandLabelPair(
+      trafficSecret,
+      keyLabel,
+      {buf->writableData(), keyLength},
+      ivLabel,
+      {buf->writableData() + keyLength, ivLength});
+
   TrafficKey trafficKey;
-  trafficKey.key = deriver_->expandLabel(
-      trafficSecret, keyLabel, folly::IOBuf::create(0), keyLength);
-  trafficKey.iv = deriver_->expandLabel(
-      trafficSecret, ivLabel, folly::IOBuf::create(0), ivLength);
+  trafficKey.iv = buf->cloneOne();
+  trafficKey.iv->trimStart(keyLength);
+  trafficKey.key = std::move(buf);
+  trafficKey.key->trimEnd(ivLength);
   return trafficKey;
 }
 
@@ -9,7 +9,9 @@
 #pragma once
 
 #include <fizz/crypto/KeyDerivation.h>
+#include <fizz/crypto/Secret.h>
 #include <fizz/crypto/aead/Aead.h>
+#include <fizz/util/ObjectRecycler.h>
 #include <folly/Optional.h>
 
 namespace fizz {
@@ -31,20 +33,20 @@ using SecretType = boost::
     variant<EarlySecrets, HandshakeSecrets, MasterSecrets, AppTrafficSecrets>;
 
 struct DerivedSecret {
-  std::vector<uint8_t> secret;
+  SecretStorage secret;
   SecretType type;
 
-  DerivedSecret(std::vector<uint8_t> secretIn, SecretType typeIn)
-      : secret(std::move(secretIn)), type(typeIn) {}
+  DerivedSecret(const std::vector<uint8_t>& secretIn, SecretType typeIn)
+      : secret(secretIn), type(typeIn) {}
 
   DerivedSecret(folly::ByteRange secretIn, SecretType typeIn)
-      : secret(secretIn.begin(), secretIn.end()), type(typeIn) {}
+      : secret(secretIn), type(typeIn) {}
 };
 
 /**
  * Keeps track of the TLS 1.3 key derivation schedule.
  */
-class KeyScheduler {
+class KeyScheduler : public PerThreadRecycled<KeyScheduler> {
  public:
   explicit KeyScheduler(std::unique_ptr<KeyDerivation> deriver)
       : deriver_(std::move(deriver)) {}
@@ -55,6 +57,19 @@ class KeyScheduler {
    */
   virtual void deriveEarlySecret(folly::ByteRange psk);
 
+  /**
+   * Seeds the scheduler with a precomputed early secret, as cached at
+   * configuration time for a static external PSK, skipping the
+   * HKDF-Extract deriveEarlySecret() performs. Must be in uninitialized
+   * state.
+   */
+  virtual void setEarlySecret(folly::ByteRange earlySecret);
+
+  /**
+   * Returns the current early secret. Must be in early secret state.
+   */
+  virtual SecretStorage getEarlySecret() const;
+
   /**
    * Derives the master secert. Must be in early secret state.
    */
@@ -77,6 +92,17 @@ class KeyScheduler {
    */
   virtual void deriveAppTrafficSecrets(folly::ByteRange transcript);
 
+  /**
+   * Seeds the scheduler directly with established application traffic
+   * secrets, as carried in a serialized session handoff from another
+   * process. Must be in uninitialized state. The scheduler afterwards
+   * supports key updates and resumption secret derivation, but not
+   * handshake derivations.
+   */
+  virtual void adoptAppTrafficSecrets(
+      folly::ByteRange clientSecret,
+      folly::ByteRange serverSecret);
+
   /**
    * Clears the master secret. Must be in master secret state.
    */
@@ -134,18 +160,18 @@ class KeyScheduler {
 
  private:
   struct EarlySecret {
-    std::vector<uint8_t> secret;
+    SecretStorage secret;
   };
   struct HandshakeSecret {
-    std::vector<uint8_t> secret;
+    SecretStorage secret;
   };
   struct MasterSecret {
-    std::vector<uint8_t> secret;
+    SecretStorage secret;
   };
   struct AppTrafficSecret {
-    std::vector<uint8_t> client;
+    SecretStorage client;
     uint32_t clientGeneration{0};
-    std::vector<uint8_t> server;
+    SecretStorage server;
     uint32_t serverGeneration{0};
   };
 
@@ -0,0 +1,128 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/protocol/LazySelfCert.h>
+
+#include <folly/portability/OpenSSL.h>
+#include <folly/ssl/OpenSSLCertUtils.h>
+
+#include <openssl/bio.h>
+#include <openssl/pem.h>
+
+namespace fizz {
+
+LazySelfCert::LazySelfCert(
+    std::vector<folly::ssl::X509UniquePtr> certs,
+    std::string keyPemData)
+    : certs_(std::move(certs)), keyPemData_(std::move(keyPemData)) {
+  if (certs_.empty()) {
+    throw std::runtime_error("Must supply at least 1 cert");
+  }
+}
+
+std::string LazySelfCert::getIdentity() const {
+  return folly::ssl::OpenSSLCertUtils::getCommonName(*certs_.front())
+      .value_or("");
+}
+
+std::vector<std::string> LazySelfCert::getAltIdentities() const {
+  return folly::ssl::OpenSSLCertUtils::getSubjectAltNames(*certs_.front());
+}
+
+std::vector<SignatureScheme> LazySelfCert::getSigSchemes() const {
+  folly::ssl::EvpPkeyUniquePtr pubKey(X509_get_pubkey(certs_.front().get()));
+  if (!pubKey) {
+    throw std::runtime_error("Failed to read public key");
+  }
+  if (EVP_PKEY_id(pubKey.get()) == EVP_PKEY_RSA) {
+    return CertUtils::getSigSchemes<KeyType::RSA>();
+#if FIZZ_OPENSSL_HAS_ED25519
+  } else if (EVP_PKEY_id(pubKey.get()) == EVP_PKEY_ED25519) {
+    return CertUtils::getSigSchemes<KeyType::ED25519>();
+#endif
+  } else if (EVP_PKEY_id(pubKey.get()) == EVP_PKEY_EC) {
+    auto ecKey = EVP_PKEY_get0_EC_KEY(pubKey.get());
+    switch (EC_GROUP_get_curve_name(EC_KEY_get0_group(ecKey))) {
+      case NID_X9_62_prime256v1:
+        return CertUtils::getSigSchemes<KeyType::P256>();
+      case NID_secp384r1:
+        return CertUtils::getSigSchemes<KeyType::P384>();
+      case NID_secp521r1:
+        return CertUtils::getSigSchemes<KeyType::P521>();
+      default:
+        break;
+    }
+  }
+  throw std::runtime_error("unknown self cert type");
+}
+
+CertificateMsg LazySelfCert::getCertMessage(
+    Buf certificateRequestContext) const {
+  return CertUtils::getCertMessage(
+      certs_, std::move(certificateRequestContext));
+}
+
+Buf LazySelfCert::getEncodedCertMessage() const {
+  // Cached on first use, matching SelfCertImpl: the encoding doesn't
+  // depend on anything per-connection, so handshakes just clone it.
+  folly::call_once(encodeOnce_, [this]() {
+    encodedCertMessage_ = encodeHandshake(getCertMessage());
+  });
+  return encodedCertMessage_->clone();
+}
+
+CompressedCertificate LazySelfCert::getCompressedCert(
+    CertificateCompressionAlgorithm algo) const {
+  return CertUtils::cloneCompressedCert(compressedCerts_.at(algo));
+}
+
+void LazySelfCert::precompressCert(CertificateCompressor& compressor) {
+  compressedCerts_[compressor.getAlgorithm()] =
+      compressor.compress(getCertMessage());
+}
+
+Buf LazySelfCert::sign(
+    SignatureScheme scheme,
+    CertificateVerifyContext context,
+    folly::ByteRange toBeSigned) const {
+  return materialized().sign(scheme, context, toBeSigned);
+}
+
+folly::ssl::X509UniquePtr LazySelfCert::getX509() const {
+  X509_up_ref(certs_.front().get());
+  return folly::ssl::X509UniquePtr(certs_.front().get());
+}
+
+const SelfCert& LazySelfCert::materialized() const {
+  folly::call_once(materializeOnce_, [this]() {
+    folly::ssl::BioUniquePtr b(BIO_new_mem_buf(
+        const_cast<void*>( // needed by openssl 1.0.2d at least
+            reinterpret_cast<const void*>(keyPemData_.data())),
+        keyPemData_.size()));
+    if (!b) {
+      throw std::runtime_error("failed to create BIO");
+    }
+    folly::ssl::EvpPkeyUniquePtr key(
+        PEM_read_bio_PrivateKey(b.get(), nullptr, nullptr, nullptr));
+    if (!key) {
+      throw std::runtime_error("Failed to read key");
+    }
+    // The chain is shared with the materialized cert rather than moved
+    // so the cert message accessors stay valid.
+    std::vector<folly::ssl::X509UniquePtr> certs;
+    for (const auto& cert : certs_) {
+      X509_up_ref(cert.get());
+      certs.emplace_back(cert.get());
+    }
+    impl_ = CertUtils::makeSelfCert(std::move(certs), std::move(key));
+    keyPemData_.clear();
+  });
+  return *impl_;
+}
+
+} // namespace fizz
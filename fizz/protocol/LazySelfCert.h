@@ -0,0 +1,78 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/protocol/Certificate.h>
+#include <folly/synchronization/CallOnce.h>
+
+namespace fizz {
+
+/**
+ * SelfCert split into an eagerly-available identity shell and
+ * lazily-initialized crypto state. Identity, sig schemes and the cert
+ * message only need the parsed chain; the private key stays as raw PEM
+ * bytes until the first sign() call, when it is parsed, checked against
+ * the leaf and turned into a regular SelfCertImpl. Bulk cert loading
+ * (e.g. a large SNI set) then skips the per-key EVP parse and
+ * consistency check for the long tail of certs that never serve a
+ * connection between rotations. The deferred key parse or mismatch
+ * failure surfaces as an exception from the first sign().
+ */
+class LazySelfCert : public SelfCert {
+ public:
+  /**
+   * certs is the chain with the leaf first; keyPemData is the leaf's
+   * unencrypted private key in PEM format, kept unparsed until first
+   * use.
+   */
+  LazySelfCert(
+      std::vector<folly::ssl::X509UniquePtr> certs,
+      std::string keyPemData);
+
+  ~LazySelfCert() override = default;
+
+  std::string getIdentity() const override;
+
+  std::vector<std::string> getAltIdentities() const override;
+
+  std::vector<SignatureScheme> getSigSchemes() const override;
+
+  CertificateMsg getCertMessage(
+      Buf certificateRequestContext = nullptr) const override;
+
+  Buf getEncodedCertMessage() const override;
+
+  CompressedCertificate getCompressedCert(
+      CertificateCompressionAlgorithm algo) const override;
+
+  void precompressCert(CertificateCompressor& compressor) override;
+
+  Buf sign(
+      SignatureScheme scheme,
+      CertificateVerifyContext context,
+      folly::ByteRange toBeSigned) const override;
+
+  folly::ssl::X509UniquePtr getX509() const override;
+
+ private:
+  const SelfCert& materialized() const;
+
+  std::vector<folly::ssl::X509UniquePtr> certs_;
+  std::map<CertificateCompressionAlgorithm, CompressedCertificate>
+      compressedCerts_;
+
+  mutable folly::once_flag materializeOnce_;
+  mutable std::string keyPemData_;
+  mutable std::unique_ptr<SelfCert> impl_;
+
+  mutable folly::once_flag encodeOnce_;
+  mutable Buf encodedCertMessage_;
+};
+
+} // namespace fizz
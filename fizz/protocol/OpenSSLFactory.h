@@ -10,12 +10,67 @@
 
 #include <fizz/crypto/Sha256.h>
 #include <fizz/crypto/Sha384.h>
+#include <fizz/crypto/aead/SodiumChaChaCipher.h>
+#include <fizz/crypto/exchange/KeyExchangePool.h>
 #include <fizz/protocol/Factory.h>
 
+#include <map>
+
 namespace fizz {
 
 class OpenSSLFactory : public Factory {
  public:
+  OpenSSLFactory() {
+    for (auto cipher :
+         {CipherSuite::TLS_AES_128_GCM_SHA256,
+          CipherSuite::TLS_AES_256_GCM_SHA384,
+          CipherSuite::TLS_CHACHA20_POLY1305_SHA256,
+          CipherSuite::TLS_AES_128_OCB_SHA256_EXPERIMENTAL}) {
+      hrrContexts_[cipher] = Factory::makeHrrHandshakeContext(cipher);
+    }
+  }
+
+  enum class AeadBackend { OpenSSL, Sodium };
+
+  /**
+   * Selects the implementation used for a cipher suite. Only
+   * ChaCha20-Poly1305 currently has a non-OpenSSL backend; libsodium's
+   * implementation is faster on hosts without AVX-512 OpenSSL assembly.
+   */
+  void setAeadBackend(CipherSuite cipher, AeadBackend backend) {
+    if (cipher == CipherSuite::TLS_CHACHA20_POLY1305_SHA256) {
+      useSodiumChaCha_ = backend == AeadBackend::Sodium;
+    } else if (backend != AeadBackend::OpenSSL) {
+      throw std::runtime_error("aead backend: not implemented");
+    }
+  }
+
+  std::unique_ptr<Aead> makeAead(CipherSuite cipher) const override {
+    if (cipher == CipherSuite::TLS_CHACHA20_POLY1305_SHA256 &&
+        useSodiumChaCha_) {
+      return std::make_unique<SodiumChaChaCipher>();
+    }
+    return Factory::makeAead(cipher);
+  }
+
+  /**
+   * Installs a pool of pregenerated ephemeral key pairs. makeKeyExchange()
+   * draws from the pool when it covers the requested group and falls back
+   * to synchronous generation when it is drained.
+   */
+  void setKeyExchangePool(std::shared_ptr<KeyExchangePool> pool) {
+    keyExchangePool_ = std::move(pool);
+  }
+
+  std::unique_ptr<KeyExchange> makeKeyExchange(NamedGroup group) const override {
+    if (keyExchangePool_) {
+      if (auto kex = keyExchangePool_->getKeyExchange(group)) {
+        return kex;
+      }
+    }
+    return Factory::makeKeyExchange(group);
+  }
+
   std::unique_ptr<KeyDerivation> makeKeyDeriver(
       CipherSuite cipher) const override {
     switch (cipher) {
@@ -30,6 +85,17 @@ class OpenSSLFactory : public Factory {
     }
   }
 
+  std::unique_ptr<HandshakeContext> makeHrrHandshakeContext(
+      CipherSuite cipher) const override {
+    // Fork the cached midstate rather than re-encoding and rehashing the
+    // static message_hash header on every HelloRetryRequest.
+    auto it = hrrContexts_.find(cipher);
+    if (it != hrrContexts_.end()) {
+      return it->second->fork();
+    }
+    return Factory::makeHrrHandshakeContext(cipher);
+  }
+
   std::unique_ptr<HandshakeContext> makeHandshakeContext(
       CipherSuite cipher) const override {
     switch (cipher) {
@@ -43,5 +109,10 @@ class OpenSSLFactory : public Factory {
         throw std::runtime_error("hs: not implemented");
     }
   }
+
+ private:
+  std::map<CipherSuite, std::unique_ptr<HandshakeContext>> hrrContexts_;
+  std::shared_ptr<KeyExchangePool> keyExchangePool_;
+  bool useSodiumChaCha_{false};
 };
 } // namespace fizz
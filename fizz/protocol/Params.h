@@ -8,6 +8,11 @@
 
 #pragma once
 
+#include <array>
+#include <utility>
+
+#include <boost/mpl/at.hpp>
+#include <boost/mpl/size.hpp>
 #include <boost/variant.hpp>
 #include <fizz/client/ClientExtensions.h>
 #include <fizz/client/PskCache.h>
@@ -36,6 +41,7 @@ struct Accept : EventType<Event::Accept> {
 };
 
 struct Connect : EventType<Event::Connect> {
+  folly::Executor* executor;
   std::shared_ptr<const client::FizzClientContext> context;
   std::shared_ptr<const CertificateVerifier> verifier;
   folly::Optional<std::string> sni;
@@ -65,12 +71,23 @@ struct WriteNewSessionTicket : EventType<Event::WriteNewSessionTicket> {
   Buf appToken;
 };
 
+struct KeyUpdateInitiation : EventType<Event::KeyUpdateInitiation> {
+  KeyUpdateRequest request_update{KeyUpdateRequest::update_requested};
+};
+
 /**
  * Parameters for each event that will be processed by the state machine.
+ *
+ * The variant's size is the size of its largest alternative, and Params are
+ * moved through the pending event queue, so the few large alternatives
+ * (ClientHello, ServerHello and Connect, which drags a cached PSK along) are
+ * boxed with recursive_wrapper to keep the common small events (AppData,
+ * AppWrite, Alert) moving within a cacheline. recursive_wrapper is
+ * transparent to boost::get and visitation so handlers are unaffected.
  */
 using Param = boost::variant<
-    ClientHello,
-    ServerHello,
+    boost::recursive_wrapper<ClientHello>,
+    boost::recursive_wrapper<ServerHello>,
     EndOfEarlyData,
     HelloRetryRequest,
     EncryptedExtensions,
@@ -84,11 +101,12 @@ using Param = boost::variant<
     Alert,
     CloseNotify,
     Accept,
-    Connect,
+    boost::recursive_wrapper<Connect>,
     AppData,
     AppWrite,
     EarlyAppWrite,
-    WriteNewSessionTicket>;
+    WriteNewSessionTicket,
+    KeyUpdateInitiation>;
 
 class EventVisitor : public boost::static_visitor<Event> {
  public:
@@ -98,6 +116,25 @@ class EventVisitor : public boost::static_visitor<Event> {
   }
 };
 
+namespace detail {
+template <std::size_t... Indices>
+constexpr std::array<Event, sizeof...(Indices)> getParamEventTable(
+    std::index_sequence<Indices...>) {
+  return {{boost::mpl::at_c<Param::types, Indices>::type::event...}};
+}
+} // namespace detail
+
+/**
+ * Returns the Event a Param corresponds to with a single table lookup on
+ * the variant's discriminator, avoiding a full variant visitation on the
+ * event dispatch path.
+ */
+inline Event getEvent(const Param& param) {
+  static constexpr auto table = detail::getParamEventTable(
+      std::make_index_sequence<boost::mpl::size<Param::types>::value>());
+  return table[param.which()];
+}
+
 // App closes bypass the state machine so aren't in the Param variant.
 struct AppClose {
   enum ClosePolicy { IMMEDIATE, WAIT };
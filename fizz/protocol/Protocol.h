@@ -27,6 +27,21 @@ class Protocol {
     recordLayer.setAead(secret, std::move(aead));
   }
 
+  /**
+   * Rotates the traffic key of a record layer in place for a KeyUpdate,
+   * reusing the existing aead and its cipher contexts rather than
+   * building a new record layer and aead.
+   */
+  template <typename Type>
+  static void rekeyRecordLayer(
+      Type& recordLayer,
+      const KeyScheduler& scheduler,
+      folly::ByteRange secret) {
+    recordLayer.rekey([&](size_t keyLength, size_t ivLength) {
+      return scheduler.getTrafficKey(secret, keyLength, ivLength);
+    });
+  }
+
   static std::unique_ptr<Aead> deriveRecordAead(
       const Factory& factory,
       const KeyScheduler& scheduler,
@@ -10,6 +10,10 @@
 
 #include <glog/logging.h>
 
+#include <folly/tracing/StaticTracepoint.h>
+
+#include <fizz/protocol/Instrumentation.h>
+
 namespace fizz {
 namespace sm {
 
@@ -39,7 +43,17 @@ class EventHandlerBase {
         Or<StateSame<SM, to, AllowedStates>...>::value, "Transition invalid");
     CHECK_EQ(stateStruct.state(), state);
     VLOG(8) << "Transition from " << toString(state) << " to " << toString(to);
+    // Probe arguments are the StateEnum values.
+    FOLLY_SDT(
+        fizz,
+        state_transition,
+        static_cast<int>(state),
+        static_cast<int>(to));
     stateStruct.state() = to;
+    if (auto* instrumentation = stateStruct.instrumentation()) {
+      instrumentation->stateEntered(
+          toString(to), HandshakeInstrumentation::Clock::now());
+    }
   }
 };
 
@@ -63,16 +77,27 @@ class EventHandler : public EventHandlerBase<SM, state, event> {
         typename sm::Param param);                                       \
   };
 
+template <typename SM>
+constexpr std::array<
+    typename StateMachine<SM>::EventHandlerFun,
+    SM::NumStates * SM::NumEvents>
+    StateMachine<SM>::handlers_;
+
 template <typename SM>
 typename StateMachine<SM>::EventHandlerFun StateMachine<SM>::getHandler(
     typename SM::StateEnum state,
     typename SM::Event event) {
-  static constexpr auto handlers = getEventHandlers(
-      std::make_index_sequence<SM::NumStates * SM::NumEvents>());
   const auto i = static_cast<std::size_t>(state) * SM::NumEvents +
       static_cast<std::size_t>(event);
-  CHECK_LT(i, handlers.size()) << "Out of bounds handler requested";
-  return handlers[i];
+  CHECK_LT(i, handlers_.size()) << "Out of bounds handler requested";
+  // Fires once per event dispatch; arguments are the StateEnum and Event
+  // values.
+  FOLLY_SDT(
+      fizz,
+      event_dispatch,
+      static_cast<int>(state),
+      static_cast<int>(event));
+  return handlers_[i];
 }
 
 template <typename SM>
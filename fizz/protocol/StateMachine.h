@@ -37,6 +37,12 @@ class StateMachine {
   getEventHandlers(std::index_sequence<Indices...>) {
     return {{getEventHandler<Indices>()...}};
   }
+
+  // Full (state x event) dispatch table, built at compile time so that
+  // getHandler() is a single indexed load.
+  static constexpr std::array<EventHandlerFun, SM::NumStates * SM::NumEvents>
+      handlers_ = getEventHandlers(
+          std::make_index_sequence<SM::NumStates * SM::NumEvents>());
 };
 } // namespace sm
 } // namespace fizz
@@ -0,0 +1,49 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/protocol/TlsMetrics.h>
+
+namespace fizz {
+
+TlsMetrics& TlsMetrics::operator+=(const TlsMetrics& other) {
+  fullHandshakes += other.fullHandshakes;
+  pskHandshakes += other.pskHandshakes;
+  earlyDataHandshakes += other.earlyDataHandshakes;
+  helloRetryRequests += other.helloRetryRequests;
+  handshakeErrors += other.handshakeErrors;
+  cipherAesgcm128 += other.cipherAesgcm128;
+  cipherAesgcm256 += other.cipherAesgcm256;
+  cipherChacha += other.cipherChacha;
+  cipherOther += other.cipherOther;
+  groupX25519 += other.groupX25519;
+  groupSecp256r1 += other.groupSecp256r1;
+  groupOther += other.groupOther;
+  recordsRead += other.recordsRead;
+  recordsWritten += other.recordsWritten;
+  decryptFailures += other.decryptFailures;
+  return *this;
+}
+
+TlsMetrics& TlsMetricsRegistry::local() {
+  return *counters();
+}
+
+TlsMetrics TlsMetricsRegistry::aggregate() {
+  TlsMetrics total;
+  for (const auto& threadMetrics : counters().accessAllThreads()) {
+    total += threadMetrics;
+  }
+  return total;
+}
+
+folly::ThreadLocal<TlsMetrics, TlsMetricsRegistry::Tag>&
+TlsMetricsRegistry::counters() {
+  static folly::ThreadLocal<TlsMetrics, Tag> instance;
+  return instance;
+}
+} // namespace fizz
@@ -0,0 +1,69 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <folly/ThreadLocal.h>
+
+#include <cstdint>
+
+namespace fizz {
+
+/**
+ * Process-wide TLS health counters, kept per thread and bumped with plain
+ * stores so the hot paths never contend on a shared cache line. Handshake
+ * counters update once per handshake in the state machines; record
+ * counters update per record in the encrypted record layers, alongside
+ * the per-connection RecordLayerStats.
+ */
+struct alignas(64) TlsMetrics {
+  // Handshakes, by type, counted at completion.
+  uint64_t fullHandshakes{0};
+  uint64_t pskHandshakes{0};
+  uint64_t earlyDataHandshakes{0};
+  uint64_t helloRetryRequests{0};
+  uint64_t handshakeErrors{0};
+
+  // Negotiated parameters, counted at completion.
+  uint64_t cipherAesgcm128{0};
+  uint64_t cipherAesgcm256{0};
+  uint64_t cipherChacha{0};
+  uint64_t cipherOther{0};
+  uint64_t groupX25519{0};
+  uint64_t groupSecp256r1{0};
+  uint64_t groupOther{0};
+
+  // Records, across all connections on the thread.
+  uint64_t recordsRead{0};
+  uint64_t recordsWritten{0};
+  uint64_t decryptFailures{0};
+
+  TlsMetrics& operator+=(const TlsMetrics& other);
+};
+
+/**
+ * Registry of every thread's TlsMetrics. Incrementing this thread's
+ * counters through local() is contention-free; aggregate() sums a
+ * snapshot across threads for periodic export and takes the registry
+ * lock, so it belongs on a stats thread rather than a hot path.
+ *
+ * Counters for a thread are dropped when the thread exits; aggregate
+ * values are meaningful for the long-lived IO and worker pools that
+ * carry TLS traffic.
+ */
+class TlsMetricsRegistry {
+ public:
+  static TlsMetrics& local();
+
+  static TlsMetrics aggregate();
+
+ private:
+  struct Tag;
+  static folly::ThreadLocal<TlsMetrics, Tag>& counters();
+};
+} // namespace fizz
@@ -8,6 +8,8 @@
 
 #include <fizz/protocol/ZlibCertificateCompressor.h>
 
+#include <cstring>
+
 using namespace folly;
 
 namespace fizz {
@@ -28,30 +30,72 @@ CertificateCompressionAlgorithm ZlibCertificateCompressor::getAlgorithm()
   return CertificateCompressionAlgorithm::zlib;
 }
 
+namespace {
+
+// Deflate stream reused across compressions on this thread: resetting an
+// initialized stream is much cheaper than the allocations compress2()
+// performs per call.
+struct ThreadDeflater {
+  z_stream stream;
+  bool initialized{false};
+  int level{Z_DEFAULT_COMPRESSION};
+
+  ~ThreadDeflater() {
+    if (initialized) {
+      deflateEnd(&stream);
+    }
+  }
+};
+} // namespace
+
 CompressedCertificate ZlibCertificateCompressor::compress(
     const CertificateMsg& cert) {
   auto encoded = encode(cert);
   auto certRange = encoded->coalesce();
   auto compressedCert = IOBuf::create(compressBound(certRange.size()));
-  unsigned long size = compressedCert->capacity();
 
-  int status = ::compress2(
-      compressedCert->writableData(),
-      &size,
-      certRange.data(),
-      certRange.size(),
-      level_);
+  static thread_local ThreadDeflater deflater;
+  auto& stream = deflater.stream;
+  int status;
+  if (!deflater.initialized) {
+    memset(&stream, 0, sizeof(stream));
+    status = deflateInit(&stream, level_);
+    if (status != Z_OK) {
+      throw std::runtime_error(
+          "Failed to initialize deflate stream: " + to<std::string>(status));
+    }
+    deflater.initialized = true;
+    deflater.level = level_;
+  } else {
+    status = deflateReset(&stream);
+    if (status != Z_OK) {
+      throw std::runtime_error(
+          "Failed to reset deflate stream: " + to<std::string>(status));
+    }
+    if (deflater.level != level_) {
+      status = deflateParams(&stream, level_, Z_DEFAULT_STRATEGY);
+      if (status != Z_OK) {
+        throw std::runtime_error(
+            "Compression level invalid: " + to<std::string>(level_));
+      }
+      deflater.level = level_;
+    }
+  }
+
+  stream.next_in = const_cast<Bytef*>(certRange.data());
+  stream.avail_in = certRange.size();
+  stream.next_out = compressedCert->writableData();
+  stream.avail_out = compressedCert->capacity();
+  status = deflate(&stream, Z_FINISH);
   switch (status) {
-    case Z_OK:
-      compressedCert->append(size);
+    case Z_STREAM_END:
+      compressedCert->append(stream.total_out);
       break;
     case Z_MEM_ERROR:
       throw std::runtime_error("Insufficient memory to compress cert");
+    case Z_OK:
     case Z_BUF_ERROR:
       throw std::runtime_error("Buffer too small for compressed cert");
-    case Z_STREAM_ERROR:
-      throw std::runtime_error(
-          "Compression level invalid: " + to<std::string>(level_));
     default:
       throw std::runtime_error(
           "Failed to compress: " + to<std::string>(status));
@@ -25,19 +25,13 @@ CertificateMsg ZlibCertificateDecompressor::decompress(
         toString(cc.algorithm));
   }
 
-  if (cc.uncompressed_length > kMaxHandshakeSize) {
-    throw std::runtime_error(
-        "Compressed certificate exceeds maximum certificate message size");
-  }
+  validateDecompressedCertSize(cc);
 
-  auto rawCertMessage = IOBuf::create(cc.uncompressed_length);
+  auto scratch = getCertDecompressionScratch(cc.uncompressed_length);
   unsigned long size = cc.uncompressed_length;
   auto compRange = cc.compressed_certificate_message->coalesce();
   auto status = ::uncompress(
-      rawCertMessage->writableData(),
-      &size,
-      compRange.data(),
-      compRange.size());
+      scratch.data(), &size, compRange.data(), compRange.size());
   switch (status) {
     case Z_OK:
       if (size != cc.uncompressed_length) {
@@ -56,8 +50,7 @@ CertificateMsg ZlibCertificateDecompressor::decompress(
       throw std::runtime_error(
           "Failed to decompress: " + to<std::string>(status));
   }
-  rawCertMessage->append(size);
-  return decode<CertificateMsg>(std::move(rawCertMessage));
+  return decode<CertificateMsg>(IOBuf::copyBuffer(scratch.data(), size));
 }
 
 } // namespace fizz
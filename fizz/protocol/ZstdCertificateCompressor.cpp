@@ -16,23 +16,63 @@ namespace fizz {
 ZstdCertificateCompressor::ZstdCertificateCompressor(int compressLevel)
     : level_(compressLevel) {}
 
+ZstdCertificateCompressor::ZstdCertificateCompressor(
+    int compressLevel,
+    folly::ByteRange dictionary)
+    : level_(compressLevel),
+      cdict_(
+          ZSTD_createCDict(dictionary.data(), dictionary.size(), compressLevel),
+          ZSTD_freeCDict) {
+  if (!cdict_) {
+    throw std::runtime_error("Failed to digest zstd cert dictionary");
+  }
+}
+
 CertificateCompressionAlgorithm ZstdCertificateCompressor::getAlgorithm()
     const {
   return CertificateCompressionAlgorithm::zstd;
 }
 
+namespace {
+
+// Compression context reused across compressions on this thread; both the
+// dictionary and plain paths reset it per call, which is much cheaper than
+// the context ZSTD_compress() otherwise creates internally.
+ZSTD_CCtx* getThreadCCtx() {
+  static thread_local std::unique_ptr<ZSTD_CCtx, size_t (*)(ZSTD_CCtx*)> cctx(
+      ZSTD_createCCtx(), ZSTD_freeCCtx);
+  return cctx.get();
+}
+} // namespace
+
 CompressedCertificate ZstdCertificateCompressor::compress(
     const CertificateMsg& cert) {
   auto encoded = encode(cert);
   auto certRange = encoded->coalesce();
   auto compressedCert = IOBuf::create(ZSTD_compressBound(certRange.size()));
 
-  auto status = ZSTD_compress(
-      compressedCert->writableData(),
-      compressedCert->tailroom(),
-      certRange.data(),
-      certRange.size(),
-      level_);
+  auto* cctx = getThreadCCtx();
+  if (!cctx) {
+    throw std::runtime_error("Failed to create zstd compression context");
+  }
+  size_t status;
+  if (cdict_) {
+    status = ZSTD_compress_usingCDict(
+        cctx,
+        compressedCert->writableData(),
+        compressedCert->tailroom(),
+        certRange.data(),
+        certRange.size(),
+        cdict_.get());
+  } else {
+    status = ZSTD_compressCCtx(
+        cctx,
+        compressedCert->writableData(),
+        compressedCert->tailroom(),
+        certRange.data(),
+        certRange.size(),
+        level_);
+  }
 
   if (ZSTD_isError(status)) {
     std::string errorMsg("Failed to compress cert with zstd: ");
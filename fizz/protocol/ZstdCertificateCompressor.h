@@ -9,11 +9,29 @@
 #pragma once
 
 #include <fizz/protocol/CertificateCompressor.h>
+#include <folly/Range.h>
+
+#include <memory>
+
+struct ZSTD_CDict_s;
 
 namespace fizz {
 class ZstdCertificateCompressor : public CertificateCompressor {
  public:
   explicit ZstdCertificateCompressor(int compressLevel);
+
+  /**
+   * Creates a compressor that compresses against a trained dictionary
+   * (for example from the fizz tool's certdict command). Cert chains
+   * share large amounts of DER boilerplate and common intermediates, so
+   * a dictionary substantially improves the compression ratio. The
+   * dictionary is digested once here so compress() does no
+   * per-dictionary work; peers must decompress with a
+   * ZstdCertificateDecompressor built from the same dictionary. Throws
+   * std::runtime_error if the dictionary cannot be digested.
+   */
+  ZstdCertificateCompressor(int compressLevel, folly::ByteRange dictionary);
+
   ~ZstdCertificateCompressor() override = default;
 
   CertificateCompressionAlgorithm getAlgorithm() const override;
@@ -22,5 +40,6 @@ class ZstdCertificateCompressor : public CertificateCompressor {
 
  private:
   const int level_;
+  std::shared_ptr<ZSTD_CDict_s> cdict_;
 };
 } // namespace fizz
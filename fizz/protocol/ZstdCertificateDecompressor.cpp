@@ -13,6 +13,16 @@ using namespace folly;
 
 namespace fizz {
 
+ZstdCertificateDecompressor::ZstdCertificateDecompressor(
+    folly::ByteRange dictionary)
+    : ddict_(
+          ZSTD_createDDict(dictionary.data(), dictionary.size()),
+          ZSTD_freeDDict) {
+  if (!ddict_) {
+    throw std::runtime_error("Failed to digest zstd cert dictionary");
+  }
+}
+
 CertificateCompressionAlgorithm ZstdCertificateDecompressor::getAlgorithm()
     const {
   return CertificateCompressionAlgorithm::zstd;
@@ -26,18 +36,28 @@ CertificateMsg ZstdCertificateDecompressor::decompress(
         toString(cc.algorithm));
   }
 
-  if (cc.uncompressed_length > kMaxHandshakeSize) {
-    throw std::runtime_error(
-        "Compressed certificate exceeds maximum certificate message size");
-  }
+  validateDecompressedCertSize(cc);
 
-  auto rawCertMessage = IOBuf::create(cc.uncompressed_length);
+  auto scratch = getCertDecompressionScratch(cc.uncompressed_length);
   auto compRange = cc.compressed_certificate_message->coalesce();
-  auto status = ZSTD_decompress(
-      rawCertMessage->writableData(),
-      rawCertMessage->tailroom(),
-      compRange.data(),
-      compRange.size());
+  size_t status;
+  if (ddict_) {
+    std::unique_ptr<ZSTD_DCtx, size_t (*)(ZSTD_DCtx*)> dctx(
+        ZSTD_createDCtx(), ZSTD_freeDCtx);
+    if (!dctx) {
+      throw std::runtime_error("Failed to create zstd decompression context");
+    }
+    status = ZSTD_decompress_usingDDict(
+        dctx.get(),
+        scratch.data(),
+        scratch.size(),
+        compRange.data(),
+        compRange.size(),
+        ddict_.get());
+  } else {
+    status = ZSTD_decompress(
+        scratch.data(), scratch.size(), compRange.data(), compRange.size());
+  }
 
   if (ZSTD_isError(status)) {
     std::string errorMsg("Failed to decompress cert with zstd: ");
@@ -54,8 +74,7 @@ CertificateMsg ZstdCertificateDecompressor::decompress(
   }
 
   // with successful decompression, status holds uncompressed size
-  rawCertMessage->append(status);
-  return decode<CertificateMsg>(std::move(rawCertMessage));
+  return decode<CertificateMsg>(IOBuf::copyBuffer(scratch.data(), status));
 }
 
 } // namespace fizz
@@ -9,14 +9,33 @@
 #pragma once
 
 #include <fizz/protocol/CertificateCompressor.h>
+#include <folly/Range.h>
+
+#include <memory>
+
+struct ZSTD_DDict_s;
 
 namespace fizz {
 class ZstdCertificateDecompressor : public CertificateDecompressor {
  public:
+  ZstdCertificateDecompressor() = default;
+
+  /**
+   * Creates a decompressor using a trained dictionary. This must be the
+   * same dictionary the peer's ZstdCertificateCompressor was built
+   * from; certs compressed without it (or with a different dictionary)
+   * will fail to decompress. Throws std::runtime_error if the
+   * dictionary cannot be digested.
+   */
+  explicit ZstdCertificateDecompressor(folly::ByteRange dictionary);
+
   ~ZstdCertificateDecompressor() override = default;
 
   CertificateCompressionAlgorithm getAlgorithm() const override;
 
   CertificateMsg decompress(const CompressedCertificate&) override;
+
+ private:
+  std::shared_ptr<ZSTD_DDict_s> ddict_;
 };
 } // namespace fizz
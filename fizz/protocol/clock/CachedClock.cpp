@@ -0,0 +1,33 @@
+/*
+ *  Copyright (c) 2019-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/protocol/clock/CachedClock.h>
+
+namespace fizz {
+
+CachedClock::CachedClock(folly::EventBase* evb)
+    : evb_(evb),
+      cachedNow_(
+          std::chrono::system_clock::now().time_since_epoch().count()) {
+  evb_->runBeforeLoop(this);
+}
+
+std::chrono::system_clock::time_point CachedClock::getCurrentTime() const {
+  return std::chrono::system_clock::time_point(
+      std::chrono::system_clock::duration(
+          cachedNow_.load(std::memory_order_relaxed)));
+}
+
+void CachedClock::runLoopCallback() noexcept {
+  cachedNow_.store(
+      std::chrono::system_clock::now().time_since_epoch().count(),
+      std::memory_order_relaxed);
+  evb_->runBeforeLoop(this);
+}
+
+} // namespace fizz
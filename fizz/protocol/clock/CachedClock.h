@@ -0,0 +1,42 @@
+/*
+ *  Copyright (c) 2019-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/protocol/clock/Clock.h>
+#include <folly/io/async/EventBase.h>
+
+#include <atomic>
+
+namespace fizz {
+
+/**
+ * Clock that caches the system time and refreshes it once per event base
+ * loop iteration, so getCurrentTime() is a single atomic load instead of
+ * a clock call per operation. Timestamps can be up to one loop tick
+ * stale, which is fine for ticket validity windows and handshake
+ * timestamps measured in seconds.
+ *
+ * Must be constructed and destroyed on the event base's thread;
+ * getCurrentTime() may be called from any thread.
+ */
+class CachedClock : public Clock, private folly::EventBase::LoopCallback {
+ public:
+  explicit CachedClock(folly::EventBase* evb);
+  ~CachedClock() override = default;
+
+  std::chrono::system_clock::time_point getCurrentTime() const override;
+
+ private:
+  void runLoopCallback() noexcept override;
+
+  folly::EventBase* evb_;
+  std::atomic<std::chrono::system_clock::duration::rep> cachedNow_;
+};
+
+} // namespace fizz
@@ -0,0 +1,39 @@
+/*
+ *  Copyright (c) 2019-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GTest.h>
+
+#include <fizz/protocol/clock/CachedClock.h>
+
+#include <thread>
+
+namespace fizz {
+namespace test {
+
+TEST(CachedClockTest, TestStableWithinTick) {
+  folly::EventBase evb;
+  CachedClock clock(&evb);
+  auto t1 = clock.getCurrentTime();
+  auto t2 = clock.getCurrentTime();
+  EXPECT_EQ(t1, t2);
+}
+
+TEST(CachedClockTest, TestRefreshedPerLoopTick) {
+  folly::EventBase evb;
+  CachedClock clock(&evb);
+  auto before = clock.getCurrentTime();
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  evb.loopOnce();
+  auto after = clock.getCurrentTime();
+  EXPECT_GT(after, before);
+  EXPECT_LE(
+      std::chrono::system_clock::now() - after, std::chrono::seconds(1));
+}
+
+} // namespace test
+} // namespace fizz
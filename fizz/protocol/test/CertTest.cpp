@@ -10,6 +10,7 @@
 
 #include <fizz/crypto/test/TestUtil.h>
 #include <fizz/protocol/Certificate.h>
+#include <fizz/protocol/LazySelfCert.h>
 #include <folly/String.h>
 
 using namespace folly;
@@ -151,6 +152,36 @@ TEST(CertTest, GetCertMessage) {
   EXPECT_EQ(X509_cmp(firstEncodedCert.get(), certCopy.get()), 0);
 }
 
+TEST(CertTest, LazySelfCertIdentity) {
+  std::vector<folly::ssl::X509UniquePtr> certs;
+  certs.push_back(getCert(kP256Certificate));
+  LazySelfCert certificate(std::move(certs), kP256Key.str());
+  EXPECT_EQ(certificate.getIdentity(), "Fizz");
+  EXPECT_EQ(
+      certificate.getSigSchemes(), CertUtils::getSigSchemes<KeyType::P256>());
+
+  auto sig = certificate.sign(
+      SignatureScheme::ecdsa_secp256r1_sha256,
+      CertificateVerifyContext::Server,
+      folly::StringPiece("tosign"));
+  EXPECT_TRUE(sig);
+}
+
+TEST(CertTest, LazySelfCertBadKey) {
+  std::vector<folly::ssl::X509UniquePtr> certs;
+  certs.push_back(getCert(kP256Certificate));
+  LazySelfCert certificate(std::move(certs), "not a pem key");
+  // Identity accessors work without the key; the parse failure only
+  // surfaces when signing.
+  EXPECT_EQ(certificate.getIdentity(), "Fizz");
+  EXPECT_THROW(
+      certificate.sign(
+          SignatureScheme::ecdsa_secp256r1_sha256,
+          CertificateVerifyContext::Server,
+          folly::StringPiece("tosign")),
+      std::runtime_error);
+}
+
 // example taken from https://tlswg.github.io/tls13-spec/#certificate-verify
 TEST(CertTest, PrepareSignData) {
   std::array<uint8_t, 32> toBeSigned;
@@ -178,6 +209,47 @@ TEST(CertTest, MakePeerCertJunk) {
       CertUtils::makePeerCert(IOBuf::copyBuffer("blah")), std::runtime_error);
 }
 
+TEST(CertTest, InternChainCert) {
+  auto cert1 = getCert(kP256Certificate);
+  auto cert2 = getCert(kP256Certificate);
+  EXPECT_NE(cert1.get(), cert2.get());
+
+  // Interning identical DER yields the same underlying X509.
+  auto interned1 = CertUtils::internChainCert(std::move(cert1));
+  auto interned2 = CertUtils::internChainCert(std::move(cert2));
+  EXPECT_EQ(interned1.get(), interned2.get());
+}
+
+TEST(CertTest, InternChainCertSharedEncoding) {
+  std::vector<folly::ssl::X509UniquePtr> certs1;
+  certs1.push_back(CertUtils::internChainCert(getCert(kP256Certificate)));
+  std::vector<folly::ssl::X509UniquePtr> certs2;
+  certs2.push_back(CertUtils::internChainCert(getCert(kP256Certificate)));
+
+  auto msg1 = CertUtils::getCertMessage(certs1, nullptr);
+  auto msg2 = CertUtils::getCertMessage(certs2, nullptr);
+  // Both messages reference the single stored encoding.
+  EXPECT_EQ(
+      msg1.certificate_list.front().cert_data->data(),
+      msg2.certificate_list.front().cert_data->data());
+  EXPECT_TRUE(folly::IOBufEqualTo()(
+      *msg1.certificate_list.front().cert_data,
+      *msg2.certificate_list.front().cert_data));
+}
+
+TEST(CertTest, MakeLazyPeerCertEmpty) {
+  EXPECT_THROW(
+      CertUtils::makeLazyPeerCert(IOBuf::copyBuffer("")), std::runtime_error);
+}
+
+TEST(CertTest, MakeLazyPeerCertJunk) {
+  // Construction retains the raw DER without parsing; the bad encoding
+  // is only detected on first use.
+  auto cert = CertUtils::makeLazyPeerCert(IOBuf::copyBuffer("blah"));
+  EXPECT_THROW(cert->getX509(), std::runtime_error);
+  EXPECT_THROW(cert->getIdentity(), std::runtime_error);
+}
+
 TEST(CertTest, PeerCertGetX509) {
   PeerCertImpl<KeyType::P256> peerCert(getCert(kP256Certificate));
   auto x509 = peerCert.getX509();
@@ -300,5 +372,25 @@ TYPED_TEST(CertTestTyped, TestVerifyDecodedCert) {
       tbs,
       sig->coalesce());
 }
+
+TYPED_TEST(CertTestTyped, TestLazyVerifyDecodedCert) {
+  std::vector<folly::ssl::X509UniquePtr> certs;
+  certs.push_back(getCert<TypeParam>());
+  auto msg = CertUtils::getCertMessage(certs, nullptr);
+  SelfCertImpl<TypeParam::Type> selfCert(getKey<TypeParam>(), std::move(certs));
+
+  auto peerCert = CertUtils::makeLazyPeerCert(
+      std::move(msg.certificate_list.front().cert_data));
+
+  StringPiece tbs{"ToBeSigned"};
+  auto sig =
+      selfCert.sign(TypeParam::Scheme, CertificateVerifyContext::Server, tbs);
+  peerCert->verify(
+      TypeParam::Scheme,
+      CertificateVerifyContext::Server,
+      tbs,
+      sig->coalesce());
+  EXPECT_NE(peerCert->getX509().get(), nullptr);
+}
 } // namespace test
 } // namespace fizz
@@ -0,0 +1,162 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GMock.h>
+#include <folly/portability/GTest.h>
+
+#include <fizz/crypto/aead/test/Mocks.h>
+#include <fizz/protocol/DecryptionPipeline.h>
+
+#include <folly/io/async/EventBase.h>
+
+using namespace folly;
+using namespace testing;
+
+namespace fizz {
+namespace test {
+
+namespace {
+
+// Captures decryption tasks so tests can run them in any completion
+// order.
+class QueueingExecutor : public folly::Executor {
+ public:
+  void add(folly::Func func) override {
+    funcs_.push_back(std::move(func));
+  }
+
+  std::vector<folly::Func> funcs_;
+};
+
+class TestCallback : public DecryptionPipeline::Callback {
+ public:
+  void pipelineMessage(TLSMessage msg) override {
+    messages.push_back(std::move(msg));
+  }
+
+  void pipelineError(ReadError error) override {
+    errors.push_back(std::move(error));
+  }
+
+  std::vector<TLSMessage> messages;
+  std::vector<ReadError> errors;
+};
+
+CiphertextRecord makeRecord(uint64_t seqNum) {
+  CiphertextRecord record;
+  record.ciphertext = IOBuf::copyBuffer("ciphertext");
+  record.header.fill(0);
+  record.seqNum = seqNum;
+  return record;
+}
+} // namespace
+
+class DecryptionPipelineTest : public Test {
+ public:
+  void SetUp() override {
+    std::vector<std::unique_ptr<Aead>> aeads;
+    for (int i = 0; i < 2; i++) {
+      auto aead = std::make_unique<MockAead>();
+      mockAeads_.push_back(aead.get());
+      aeads.push_back(std::move(aead));
+    }
+    pipeline_ = std::make_unique<DecryptionPipeline>(
+        &executor_, std::move(aeads), &evb_);
+    pipeline_->setCallback(&callback_);
+  }
+
+  void expectDecrypt(MockAead* aead) {
+    EXPECT_CALL(*aead, _decrypt(_, _, _))
+        .WillRepeatedly(Invoke([](std::unique_ptr<IOBuf>& /* ciphertext */,
+                                  const IOBuf* /* associatedData */,
+                                  uint64_t seqNum) {
+          // Plaintext payload naming the record, with an inner
+          // application_data content type octet.
+          auto plaintext =
+              folly::to<std::string>("record", seqNum) + '\x17';
+          return IOBuf::copyBuffer(plaintext);
+        }));
+  }
+
+ protected:
+  QueueingExecutor executor_;
+  EventBase evb_;
+  std::vector<MockAead*> mockAeads_;
+  std::unique_ptr<DecryptionPipeline> pipeline_;
+  TestCallback callback_;
+};
+
+TEST_F(DecryptionPipelineTest, TestInOrderDelivery) {
+  expectDecrypt(mockAeads_[0]);
+  expectDecrypt(mockAeads_[1]);
+
+  pipeline_->enqueue(makeRecord(0));
+  pipeline_->enqueue(makeRecord(1));
+  ASSERT_EQ(executor_.funcs_.size(), 2);
+
+  // Complete the second record first; delivery must still be in
+  // sequence order.
+  executor_.funcs_[1]();
+  executor_.funcs_[0]();
+  evb_.loopOnce();
+
+  ASSERT_EQ(callback_.messages.size(), 2);
+  EXPECT_TRUE(callback_.errors.empty());
+  EXPECT_EQ(callback_.messages[0].type, ContentType::application_data);
+  EXPECT_TRUE(IOBufEqualTo()(
+      *callback_.messages[0].fragment, *IOBuf::copyBuffer("record0")));
+  EXPECT_TRUE(IOBufEqualTo()(
+      *callback_.messages[1].fragment, *IOBuf::copyBuffer("record1")));
+}
+
+TEST_F(DecryptionPipelineTest, TestNonAppDataType) {
+  EXPECT_CALL(*mockAeads_[0], _decrypt(_, _, _))
+      .WillOnce(InvokeWithoutArgs(
+          []() { return IOBuf::copyBuffer("keyupdate\x16"); }));
+
+  pipeline_->enqueue(makeRecord(0));
+  executor_.funcs_[0]();
+  evb_.loopOnce();
+
+  ASSERT_EQ(callback_.messages.size(), 1);
+  EXPECT_EQ(callback_.messages[0].type, ContentType::handshake);
+}
+
+TEST_F(DecryptionPipelineTest, TestDecryptFailure) {
+  expectDecrypt(mockAeads_[0]);
+  EXPECT_CALL(*mockAeads_[1], _decrypt(_, _, _))
+      .WillOnce(InvokeWithoutArgs([]() -> std::unique_ptr<IOBuf> {
+        throw std::runtime_error("bad record");
+      }));
+
+  pipeline_->enqueue(makeRecord(0));
+  pipeline_->enqueue(makeRecord(1));
+  executor_.funcs_[0]();
+  executor_.funcs_[1]();
+  evb_.loopOnce();
+
+  // The good record arrives, then the failure; nothing after it.
+  EXPECT_EQ(callback_.messages.size(), 1);
+  ASSERT_EQ(callback_.errors.size(), 1);
+  EXPECT_THAT(callback_.errors[0].message, HasSubstr("decryption failed"));
+}
+
+TEST_F(DecryptionPipelineTest, TestDestroyWithTasksInFlight) {
+  expectDecrypt(mockAeads_[0]);
+
+  pipeline_->enqueue(makeRecord(0));
+  pipeline_.reset();
+
+  // The queued task must still run safely and its completion must be
+  // dropped.
+  executor_.funcs_[0]();
+  evb_.loopOnce();
+  EXPECT_TRUE(callback_.messages.empty());
+}
+} // namespace test
+} // namespace fizz
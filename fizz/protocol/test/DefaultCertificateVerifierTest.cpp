@@ -94,6 +94,37 @@ TEST_F(DefaultCertificateVerifierTest, TestVerifyWithBadIntermediate) {
   EXPECT_THROW(verifier_->verify({getPeerCert(subleaf)}), std::runtime_error);
 }
 
+TEST_F(DefaultCertificateVerifierTest, TestVerificationCacheHit) {
+  verifier_->setVerificationCacheSize(16);
+  verifier_->verify({getPeerCert(leafCertAndKey_)});
+  EXPECT_EQ(verifier_->getVerificationCacheHits(), 0);
+  EXPECT_EQ(verifier_->getVerificationCacheMisses(), 1);
+  verifier_->verify({getPeerCert(leafCertAndKey_)});
+  EXPECT_EQ(verifier_->getVerificationCacheHits(), 1);
+  EXPECT_EQ(verifier_->getVerificationCacheMisses(), 1);
+}
+
+TEST_F(DefaultCertificateVerifierTest, TestVerificationCacheFailureNotCached) {
+  verifier_->setVerificationCacheSize(16);
+  auto selfsigned = createCert("self", false, nullptr);
+  EXPECT_THROW(
+      verifier_->verify({getPeerCert(selfsigned)}), std::runtime_error);
+  EXPECT_THROW(
+      verifier_->verify({getPeerCert(selfsigned)}), std::runtime_error);
+  EXPECT_EQ(verifier_->getVerificationCacheHits(), 0);
+  EXPECT_EQ(verifier_->getVerificationCacheMisses(), 2);
+}
+
+TEST_F(DefaultCertificateVerifierTest, TestVerificationCacheDistinctChains) {
+  verifier_->setVerificationCacheSize(16);
+  auto subauth = createCert("subauth", true, &rootCertAndKey_);
+  auto subleaf = createCert("subleaf", false, &subauth);
+  verifier_->verify({getPeerCert(leafCertAndKey_)});
+  verifier_->verify({getPeerCert(subleaf), getPeerCert(subauth)});
+  EXPECT_EQ(verifier_->getVerificationCacheHits(), 0);
+  EXPECT_EQ(verifier_->getVerificationCacheMisses(), 2);
+}
+
 TEST_F(DefaultCertificateVerifierTest, TestVerifyWithBadRoot) {
   auto newroot = createCert("root2", true, nullptr);
   auto subauth = createCert("subauth2", true, &newroot);
@@ -34,5 +34,34 @@ TEST(ExporterTest, TestExporterBasic) {
 
   EXPECT_EQ(StringPiece(ekm->coalesce()), unhexlify(basic_expected_ekm));
 }
+
+TEST(ExporterTest, TestExporterContextCaching) {
+  OpenSSLFactory factory;
+  ExporterContext exporterContext(
+      factory,
+      CipherSuite::TLS_AES_128_GCM_SHA256,
+      folly::Range<const char*>(exporter_master));
+
+  auto ekm = exporterContext.getEkm(label, nullptr, 32);
+  EXPECT_EQ(StringPiece(ekm->coalesce()), unhexlify(basic_expected_ekm));
+  auto repeat = exporterContext.getEkm(label, nullptr, 32);
+  EXPECT_EQ(StringPiece(repeat->coalesce()), unhexlify(basic_expected_ekm));
+
+  // A different context under the same label must still derive distinct
+  // material, matching the uncached implementation.
+  auto differentContext =
+      exporterContext.getEkm(label, IOBuf::copyBuffer("context"), 32);
+  EXPECT_NE(
+      StringPiece(differentContext->coalesce()),
+      unhexlify(basic_expected_ekm));
+  auto expected = Exporter::getEkm(
+      factory,
+      CipherSuite::TLS_AES_128_GCM_SHA256,
+      folly::Range<const char*>(exporter_master),
+      label,
+      IOBuf::copyBuffer("context"),
+      32);
+  EXPECT_TRUE(IOBufEqualTo()(differentContext, expected));
+}
 } // namespace test
 } // namespace fizz
@@ -110,6 +110,15 @@ class ActionMoveVisitor : public boost::static_visitor<> {
   }
 };
 
+class MockHandshakeScheduler : public HandshakeScheduler {
+ public:
+  MOCK_METHOD1(admit, bool(Priority));
+  MOCK_METHOD1(scheduleResume_, void(folly::Function<void()>&));
+  void scheduleResume(folly::Function<void()> callback) override {
+    scheduleResume_(callback);
+  }
+};
+
 class TestFizzBase
     : public FizzBase<TestFizzBase, ActionMoveVisitor, TestStateMachine>,
       public DelayedDestruction {
@@ -191,6 +200,67 @@ TEST_F(FizzBaseTest, TestReadNoActions) {
   testFizz_->newTransportData();
 }
 
+TEST_F(FizzBaseTest, TestSchedulerAdmits) {
+  MockHandshakeScheduler scheduler;
+  testFizz_->setHandshakeScheduler(&scheduler);
+  EXPECT_CALL(scheduler, admit(HandshakeScheduler::Priority::Normal))
+      .WillOnce(Return(true));
+  EXPECT_CALL(*TestStateMachine::instance, processSocketData(_, _))
+      .WillOnce(InvokeWithoutArgs([]() { return Actions{A1()}; }));
+  EXPECT_CALL(testFizz_->visitor_, a1()).WillOnce(Invoke([this]() {
+    testFizz_->waitForData();
+  }));
+  testFizz_->newTransportData();
+}
+
+TEST_F(FizzBaseTest, TestSchedulerPausesSocketData) {
+  MockHandshakeScheduler scheduler;
+  testFizz_->setHandshakeScheduler(
+      &scheduler, HandshakeScheduler::Priority::Low);
+
+  folly::Function<void()> resume;
+  EXPECT_CALL(scheduler, admit(HandshakeScheduler::Priority::Low))
+      .WillOnce(Return(false));
+  EXPECT_CALL(scheduler, scheduleResume_(_))
+      .WillOnce(Invoke(
+          [&resume](folly::Function<void()>& cb) { resume = std::move(cb); }));
+  EXPECT_CALL(*TestStateMachine::instance, processSocketData(_, _)).Times(0);
+  testFizz_->newTransportData();
+
+  EXPECT_CALL(scheduler, admit(HandshakeScheduler::Priority::Low))
+      .WillOnce(Return(true));
+  EXPECT_CALL(*TestStateMachine::instance, processSocketData(_, _))
+      .WillOnce(InvokeWithoutArgs([]() { return Actions{A1()}; }));
+  EXPECT_CALL(testFizz_->visitor_, a1()).WillOnce(Invoke([this]() {
+    testFizz_->waitForData();
+  }));
+  resume();
+}
+
+TEST_F(FizzBaseTest, TestSchedulerDoesNotThrottleAppEvents) {
+  MockHandshakeScheduler scheduler;
+  testFizz_->setHandshakeScheduler(&scheduler);
+  EXPECT_CALL(scheduler, admit(_)).Times(0);
+  EXPECT_CALL(
+      *TestStateMachine::instance, processAppWrite_(_, WriteMatches("write")))
+      .WillOnce(InvokeWithoutArgs([]() { return Actions{A1()}; }));
+  EXPECT_CALL(testFizz_->visitor_, a1());
+  testFizz_->appWrite(appWrite("write"));
+}
+
+TEST_F(FizzBaseTest, TestSchedulerDetach) {
+  MockHandshakeScheduler scheduler;
+  testFizz_->setHandshakeScheduler(&scheduler);
+  testFizz_->setHandshakeScheduler(nullptr);
+  EXPECT_CALL(scheduler, admit(_)).Times(0);
+  EXPECT_CALL(*TestStateMachine::instance, processSocketData(_, _))
+      .WillOnce(InvokeWithoutArgs([]() { return Actions{A1()}; }));
+  EXPECT_CALL(testFizz_->visitor_, a1()).WillOnce(Invoke([this]() {
+    testFizz_->waitForData();
+  }));
+  testFizz_->newTransportData();
+}
+
 TEST_F(FizzBaseTest, TestWriteNewSessionTicket) {
   EXPECT_CALL(*TestStateMachine::instance, processWriteNewSessionTicket_(_, _))
       .WillOnce(InvokeWithoutArgs([]() { return Actions{A1()}; }));
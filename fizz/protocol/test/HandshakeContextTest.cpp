@@ -10,6 +10,7 @@
 
 #include <fizz/crypto/Sha256.h>
 #include <fizz/protocol/HandshakeContext.h>
+#include <fizz/protocol/OpenSSLFactory.h>
 
 using namespace folly;
 using namespace testing;
@@ -40,6 +41,78 @@ TEST_F(HandshakeContextTest, TestFinished) {
   context.getFinishedData(range(baseKey));
 }
 
+TEST_F(HandshakeContextTest, TestVerifyFinished) {
+  HandshakeContextImpl<Sha256> context(kHkdfLabelPrefix.str());
+  context.appendToTranscript(folly::IOBuf::copyBuffer("ClientHello"));
+  std::vector<uint8_t> baseKey(Sha256::HashLen, 0x5c);
+
+  auto finished = context.getFinishedData(range(baseKey));
+  EXPECT_TRUE(context.verifyFinishedData(range(baseKey), finished->coalesce()));
+
+  // Matches the long-form derivation through expandLabel().
+  auto finishedKey = KeyDerivationImpl<Sha256>(kHkdfLabelPrefix.str())
+                         .expandLabel(
+                             range(baseKey),
+                             "finished",
+                             folly::IOBuf::create(0),
+                             Sha256::HashLen);
+  std::array<uint8_t, Sha256::HashLen> expected;
+  Sha256::hmac(
+      finishedKey->coalesce(),
+      *context.getHandshakeContext(),
+      folly::range(expected));
+  EXPECT_TRUE(folly::IOBufEqualTo()(
+      finished, folly::IOBuf::copyBuffer(folly::range(expected))));
+
+  auto tampered = finished->clone();
+  tampered->writableData()[0] ^= 1;
+  EXPECT_FALSE(
+      context.verifyFinishedData(range(baseKey), tampered->coalesce()));
+  std::vector<uint8_t> otherKey(Sha256::HashLen, 0x36);
+  EXPECT_FALSE(
+      context.verifyFinishedData(range(otherKey), finished->coalesce()));
+}
+
+TEST_F(HandshakeContextTest, TestFork) {
+  HandshakeContextImpl<Sha256> context(kHkdfLabelPrefix.str());
+  context.appendToTranscript(folly::IOBuf::copyBuffer("ClientHello"));
+  auto forked = context.fork();
+
+  // Both contexts continue from the same midstate.
+  context.appendToTranscript(folly::IOBuf::copyBuffer("ServerHello"));
+  forked->appendToTranscript(folly::IOBuf::copyBuffer("ServerHello"));
+  EXPECT_TRUE(folly::IOBufEqualTo()(
+      context.getHandshakeContext(), forked->getHandshakeContext()));
+
+  // Appending to the fork does not affect the original.
+  auto before = context.getHandshakeContext();
+  forked->appendToTranscript(folly::IOBuf::copyBuffer("Finished"));
+  EXPECT_TRUE(folly::IOBufEqualTo()(before, context.getHandshakeContext()));
+  EXPECT_FALSE(folly::IOBufEqualTo()(
+      context.getHandshakeContext(), forked->getHandshakeContext()));
+}
+
+TEST_F(HandshakeContextTest, TestHrrTranscript) {
+  OpenSSLFactory factory;
+  for (auto cipher :
+       {CipherSuite::TLS_AES_128_GCM_SHA256,
+        CipherSuite::TLS_AES_256_GCM_SHA384}) {
+    auto hashSize = getHashSize(getHashFunction(cipher));
+    auto chloHash = folly::IOBuf::copyBuffer(std::string(hashSize, 'h'));
+
+    auto hrrContext = factory.makeHrrHandshakeContext(cipher);
+    hrrContext->appendToTranscript(chloHash);
+
+    message_hash mh;
+    mh.hash = chloHash->clone();
+    auto expected = factory.makeHandshakeContext(cipher);
+    expected->appendToTranscript(encodeHandshake(std::move(mh)));
+
+    EXPECT_TRUE(folly::IOBufEqualTo()(
+        hrrContext->getHandshakeContext(), expected->getHandshakeContext()));
+  }
+}
+
 TEST_F(HandshakeContextTest, TestEmpty) {
   HandshakeContextImpl<Sha256> context(kHkdfLabelPrefix.str());
   context.getHandshakeContext();
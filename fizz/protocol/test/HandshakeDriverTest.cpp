@@ -0,0 +1,164 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GMock.h>
+#include <folly/portability/GTest.h>
+
+#include <fizz/protocol/HandshakeDriver.h>
+
+namespace fizz {
+namespace test {
+
+using namespace folly;
+using namespace testing;
+
+struct State {
+  int mutations{0};
+};
+
+struct Success {};
+struct Unhandled {};
+using MutateState = folly::Function<void(State&)>;
+
+using Action = boost::variant<
+    MutateState,
+    WriteToSocket,
+    Success,
+    ReportError,
+    WaitForData,
+    EndOfData,
+    Unhandled>;
+using Actions = std::vector<Action>;
+using AsyncActions = boost::variant<Actions, Future<Actions>>;
+
+class TestStateMachine {
+ public:
+  using StateType = State;
+  using ProcessingActions = AsyncActions;
+  using CompletedActions = Actions;
+  using ReportSuccess = Success;
+
+  TestStateMachine() {
+    instance = this;
+  }
+
+  MOCK_METHOD2(
+      processSocketData,
+      AsyncActions(const State&, folly::IOBufQueue&));
+
+  static TestStateMachine* instance;
+};
+TestStateMachine* TestStateMachine::instance;
+
+static WriteToSocket writeRecord(const std::string& str) {
+  TLSContent content;
+  content.data = IOBuf::copyBuffer(str);
+  content.contentType = ContentType::handshake;
+  content.encryptionLevel = EncryptionLevel::Plaintext;
+  WriteToSocket write;
+  write.contents.emplace_back(std::move(content));
+  return write;
+}
+
+class HandshakeDriverTest : public Test {
+ public:
+  void SetUp() override {
+    driver_ = std::make_unique<HandshakeDriver<TestStateMachine>>(
+        [this]() { return readFn(); }, [this](WriteToSocket write) {
+          writes_.push_back(std::move(write));
+        });
+  }
+
+ protected:
+  Future<Buf> readFn() {
+    readPromise_.emplace();
+    return readPromise_->getFuture();
+  }
+
+  std::unique_ptr<HandshakeDriver<TestStateMachine>> driver_;
+  folly::Optional<Promise<Buf>> readPromise_;
+  std::vector<WriteToSocket> writes_;
+};
+
+TEST_F(HandshakeDriverTest, TestSequentialFlow) {
+  // First flight: write a record and wait for the peer's reply.
+  Actions initial;
+  initial.emplace_back(writeRecord("flight1"));
+  initial.emplace_back(WaitForData());
+  auto handshake = driver_->run(std::move(initial));
+
+  EXPECT_FALSE(handshake.isReady());
+  ASSERT_EQ(writes_.size(), 1);
+  ASSERT_TRUE(readPromise_.hasValue());
+
+  // The reply advances the state machine to completion.
+  EXPECT_CALL(*TestStateMachine::instance, processSocketData(_, _))
+      .WillOnce(Invoke([](const State&, folly::IOBufQueue& buf) {
+        EXPECT_EQ(buf.chainLength(), 7);
+        buf.move();
+        Actions actions;
+        actions.emplace_back(MutateState([](State& s) { s.mutations++; }));
+        actions.emplace_back(Success());
+        return actions;
+      }));
+  readPromise_->setValue(IOBuf::copyBuffer("flight2"));
+  EXPECT_TRUE(handshake.isReady());
+  EXPECT_NO_THROW(std::move(handshake).get());
+  EXPECT_EQ(driver_->state().mutations, 1);
+}
+
+TEST_F(HandshakeDriverTest, TestAsyncSuspension) {
+  // A future from the state machine suspends the chain until it completes.
+  Promise<Actions> suspended;
+  auto handshake = driver_->run(suspended.getFuture());
+  EXPECT_FALSE(handshake.isReady());
+
+  Actions actions;
+  actions.emplace_back(Success());
+  suspended.setValue(std::move(actions));
+  EXPECT_TRUE(handshake.isReady());
+  EXPECT_NO_THROW(std::move(handshake).get());
+}
+
+TEST_F(HandshakeDriverTest, TestUnhandledActionsIgnored) {
+  Actions initial;
+  initial.emplace_back(Unhandled());
+  initial.emplace_back(Success());
+  auto handshake = driver_->run(std::move(initial));
+  EXPECT_TRUE(handshake.isReady());
+  EXPECT_NO_THROW(std::move(handshake).get());
+}
+
+TEST_F(HandshakeDriverTest, TestError) {
+  Actions initial;
+  initial.emplace_back(ReportError("handshake error"));
+  auto handshake = driver_->run(std::move(initial));
+  EXPECT_TRUE(handshake.isReady());
+  EXPECT_THROW(std::move(handshake).get(), std::runtime_error);
+}
+
+TEST_F(HandshakeDriverTest, TestTransportClose) {
+  Actions initial;
+  initial.emplace_back(WaitForData());
+  auto handshake = driver_->run(std::move(initial));
+  EXPECT_FALSE(handshake.isReady());
+
+  readPromise_->setValue(IOBuf::create(0));
+  EXPECT_TRUE(handshake.isReady());
+  EXPECT_THROW(std::move(handshake).get(), std::runtime_error);
+}
+
+TEST_F(HandshakeDriverTest, TestEndOfData) {
+  Actions initial;
+  initial.emplace_back(EndOfData());
+  auto handshake = driver_->run(std::move(initial));
+  EXPECT_TRUE(handshake.isReady());
+  EXPECT_THROW(std::move(handshake).get(), std::runtime_error);
+}
+} // namespace test
+} // namespace fizz
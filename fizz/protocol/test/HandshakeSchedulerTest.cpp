@@ -0,0 +1,66 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GTest.h>
+
+#include <fizz/protocol/HandshakeScheduler.h>
+#include <folly/io/async/EventBase.h>
+
+namespace fizz {
+namespace test {
+
+using Priority = HandshakeScheduler::Priority;
+
+TEST(HandshakeSchedulerTest, TestPerLoopBudget) {
+  folly::EventBase evb;
+  PerLoopHandshakeScheduler scheduler(&evb, {{2, 1, 0}});
+
+  EXPECT_TRUE(scheduler.admit(Priority::High));
+  EXPECT_TRUE(scheduler.admit(Priority::High));
+  EXPECT_FALSE(scheduler.admit(Priority::High));
+  EXPECT_TRUE(scheduler.admit(Priority::Normal));
+  EXPECT_FALSE(scheduler.admit(Priority::Normal));
+  EXPECT_FALSE(scheduler.admit(Priority::Low));
+
+  // Budgets renew once the loop callback runs.
+  evb.loopOnce();
+  EXPECT_TRUE(scheduler.admit(Priority::High));
+  EXPECT_TRUE(scheduler.admit(Priority::Normal));
+  EXPECT_FALSE(scheduler.admit(Priority::Low));
+}
+
+TEST(HandshakeSchedulerTest, TestResume) {
+  folly::EventBase evb;
+  PerLoopHandshakeScheduler scheduler(&evb, {{1, 1, 1}});
+
+  EXPECT_TRUE(scheduler.admit(Priority::Normal));
+  EXPECT_FALSE(scheduler.admit(Priority::Normal));
+
+  int resumed = 0;
+  scheduler.scheduleResume([&]() {
+    resumed++;
+    // The resumed connection runs against the renewed budget.
+    EXPECT_TRUE(scheduler.admit(Priority::Normal));
+  });
+  EXPECT_EQ(resumed, 0);
+  evb.loopOnce();
+  EXPECT_EQ(resumed, 1);
+}
+
+TEST(HandshakeSchedulerTest, TestDrainOnDestruction) {
+  folly::EventBase evb;
+  int resumed = 0;
+  {
+    PerLoopHandshakeScheduler scheduler(&evb, {{0, 0, 0}});
+    EXPECT_FALSE(scheduler.admit(Priority::High));
+    scheduler.scheduleResume([&]() { resumed++; });
+  }
+  EXPECT_EQ(resumed, 1);
+}
+} // namespace test
+} // namespace fizz
@@ -0,0 +1,56 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GTest.h>
+
+#include <fizz/protocol/Instrumentation.h>
+
+namespace fizz {
+namespace test {
+
+TEST(InstrumentationTest, TestCollector) {
+  HandshakeTimingCollector collector;
+  auto now = HandshakeInstrumentation::Clock::now();
+
+  collector.stateEntered("ExpectingServerHello", now);
+  collector.stateEntered("Established", now + std::chrono::milliseconds(5));
+  collector.cryptoPhaseCompleted(
+      CryptoPhase::KeyExchange, std::chrono::microseconds(100));
+
+  const auto& timings = collector.timings();
+  ASSERT_EQ(timings.transitions.size(), 2);
+  EXPECT_EQ(timings.transitions[0].state, "ExpectingServerHello");
+  EXPECT_EQ(timings.transitions[1].state, "Established");
+  EXPECT_EQ(
+      timings.transitions[1].when - timings.transitions[0].when,
+      std::chrono::milliseconds(5));
+  ASSERT_EQ(timings.cryptoPhases.size(), 1);
+  EXPECT_EQ(timings.cryptoPhases[0].first, CryptoPhase::KeyExchange);
+  EXPECT_EQ(timings.cryptoPhases[0].second, std::chrono::microseconds(100));
+}
+
+TEST(InstrumentationTest, TestPhaseTimer) {
+  HandshakeTimingCollector collector;
+  { CryptoPhaseTimer timer(&collector, CryptoPhase::Signing); }
+  ASSERT_EQ(collector.timings().cryptoPhases.size(), 1);
+  EXPECT_EQ(collector.timings().cryptoPhases[0].first, CryptoPhase::Signing);
+}
+
+TEST(InstrumentationTest, TestPhaseTimerNullHook) {
+  // Must be a no-op without a hook registered.
+  CryptoPhaseTimer timer(nullptr, CryptoPhase::Verification);
+}
+
+TEST(InstrumentationTest, TestToString) {
+  EXPECT_EQ(toString(CryptoPhase::KeyExchange), "KeyExchange");
+  EXPECT_EQ(toString(CryptoPhase::Signing), "Signing");
+  EXPECT_EQ(toString(CryptoPhase::Verification), "Verification");
+  EXPECT_EQ(toString(CryptoPhase::TicketSeal), "TicketSeal");
+}
+} // namespace test
+} // namespace fizz
@@ -0,0 +1,122 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/Benchmark.h>
+#include <folly/init/Init.h>
+
+#include <fizz/crypto/Sha256.h>
+#include <fizz/crypto/Sha384.h>
+#include <fizz/protocol/HandshakeContext.h>
+#include <fizz/protocol/KeyScheduler.h>
+
+using namespace fizz;
+
+/**
+ * Key schedule and transcript hashing microbenchmarks.
+ *
+ * keySchedule_* runs the full derivation sequence a handshake performs,
+ * from deriveEarlySecret through deriveAppTrafficSecrets plus the traffic
+ * secret and key/iv derivations, so it covers the ~20 HKDF expands per
+ * handshake. transcript_* feeds appendToTranscript a realistic sequence
+ * of handshake message sizes and finalizes the context.
+ */
+
+namespace {
+
+std::vector<uint8_t> makeVec(size_t size, uint8_t fill) {
+  return std::vector<uint8_t>(size, fill);
+}
+
+template <typename Hash>
+void keyScheduleBench(uint32_t n) {
+  std::vector<uint8_t> psk;
+  std::vector<uint8_t> ecdhe;
+  std::vector<uint8_t> transcript;
+  BENCHMARK_SUSPEND {
+    psk = makeVec(Hash::HashLen, 0x11);
+    ecdhe = makeVec(32, 0x22);
+    transcript = makeVec(Hash::HashLen, 0x33);
+  }
+  for (uint32_t i = 0; i < n; i++) {
+    KeyScheduler scheduler(
+        std::make_unique<KeyDerivationImpl<Hash>>(kHkdfLabelPrefix.str()));
+    scheduler.deriveEarlySecret(folly::range(psk));
+    scheduler.deriveHandshakeSecret(folly::range(ecdhe));
+    auto clientHs = scheduler.getSecret(
+        HandshakeSecrets::ClientHandshakeTraffic, folly::range(transcript));
+    auto serverHs = scheduler.getSecret(
+        HandshakeSecrets::ServerHandshakeTraffic, folly::range(transcript));
+    scheduler.deriveMasterSecret();
+    scheduler.deriveAppTrafficSecrets(folly::range(transcript));
+    auto clientApp = scheduler.getSecret(AppTrafficSecrets::ClientAppTraffic);
+    auto serverApp = scheduler.getSecret(AppTrafficSecrets::ServerAppTraffic);
+    auto resumption = scheduler.getSecret(
+        MasterSecrets::ResumptionMaster, folly::range(transcript));
+    scheduler.clearMasterSecret();
+
+    // Each of the four traffic secrets gets a key and iv, as in a real
+    // handshake.
+    for (const auto* secret :
+         {&clientHs, &serverHs, &clientApp, &serverApp}) {
+      auto key = scheduler.getTrafficKey(folly::range(secret->secret), 16, 12);
+      folly::doNotOptimizeAway(key);
+    }
+    folly::doNotOptimizeAway(resumption);
+  }
+}
+
+template <typename Hash>
+void transcriptBench(uint32_t n) {
+  // Approximate sizes of the handshake messages a typical full handshake
+  // appends: ClientHello, ServerHello, EncryptedExtensions, Certificate,
+  // CertificateVerify, server Finished, client Finished.
+  static constexpr std::array<size_t, 7> kMessageSizes{
+      {250, 128, 40, 1500, 300, 52, 52}};
+  std::vector<Buf> messages;
+  BENCHMARK_SUSPEND {
+    for (auto size : kMessageSizes) {
+      auto buf = folly::IOBuf::create(size);
+      memset(buf->writableTail(), 0x44, size);
+      buf->append(size);
+      messages.push_back(std::move(buf));
+    }
+  }
+  for (uint32_t i = 0; i < n; i++) {
+    HandshakeContextImpl<Hash> context(kHkdfLabelPrefix.str());
+    for (const auto& message : messages) {
+      context.appendToTranscript(message);
+    }
+    auto handshakeContext = context.getHandshakeContext();
+    folly::doNotOptimizeAway(handshakeContext);
+  }
+}
+} // namespace
+
+BENCHMARK(keySchedule_Sha256, n) {
+  keyScheduleBench<Sha256>(n);
+}
+
+BENCHMARK(keySchedule_Sha384, n) {
+  keyScheduleBench<Sha384>(n);
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(transcript_Sha256, n) {
+  transcriptBench<Sha256>(n);
+}
+
+BENCHMARK(transcript_Sha384, n) {
+  transcriptBench<Sha384>(n);
+}
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  folly::runBenchmarks();
+  return 0;
+}
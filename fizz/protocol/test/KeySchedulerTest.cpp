@@ -37,7 +37,7 @@ class KeySchedulerTest : public testing::Test {
 
 TEST_F(KeySchedulerTest, TestEarly) {
   StringPiece psk{"psk"};
-  EXPECT_CALL(*kd_, hkdfExtract(_, _));
+  EXPECT_CALL(*kd_, hkdfExtract(_, _, _));
   ks_->deriveEarlySecret(psk);
   EXPECT_CALL(*kd_, deriveSecret(_, _, _)).Times(4);
   ks_->getSecret(EarlySecrets::ExternalPskBinder, transcript_);
@@ -45,21 +45,21 @@ TEST_F(KeySchedulerTest, TestEarly) {
   ks_->getSecret(EarlySecrets::ResumptionPskBinder, transcript_);
   ks_->getSecret(EarlySecrets::EarlyExporter, transcript_);
 
-  EXPECT_CALL(*kd_, deriveSecret(_, _, _)).Times(1);
-  EXPECT_CALL(*kd_, hkdfExtract(_, _));
+  EXPECT_CALL(*kd_, deriveSecret(_, _, _, _)).Times(1);
+  EXPECT_CALL(*kd_, hkdfExtract(_, _, _));
   ks_->deriveHandshakeSecret();
   EXPECT_CALL(*kd_, deriveSecret(_, _, _)).Times(2);
   ks_->getSecret(HandshakeSecrets::ClientHandshakeTraffic, transcript_);
   ks_->getSecret(HandshakeSecrets::ServerHandshakeTraffic, transcript_);
 
-  EXPECT_CALL(*kd_, deriveSecret(_, _, _)).Times(1);
-  EXPECT_CALL(*kd_, hkdfExtract(_, _));
+  EXPECT_CALL(*kd_, deriveSecret(_, _, _, _)).Times(1);
+  EXPECT_CALL(*kd_, hkdfExtract(_, _, _));
   ks_->deriveMasterSecret();
   EXPECT_CALL(*kd_, deriveSecret(_, _, _)).Times(2);
   ks_->getSecret(MasterSecrets::ExporterMaster, transcript_);
   ks_->getSecret(MasterSecrets::ResumptionMaster, transcript_);
 
-  EXPECT_CALL(*kd_, deriveSecret(_, _, _)).Times(2);
+  EXPECT_CALL(*kd_, deriveSecret(_, _, _, _)).Times(2);
   ks_->deriveAppTrafficSecrets(transcript_);
   ks_->getSecret(AppTrafficSecrets::ClientAppTraffic);
   ks_->getSecret(AppTrafficSecrets::ServerAppTraffic);
@@ -67,7 +67,7 @@ TEST_F(KeySchedulerTest, TestEarly) {
 
 TEST_F(KeySchedulerTest, TestEarlyEcdhe) {
   StringPiece psk{"psk"};
-  EXPECT_CALL(*kd_, hkdfExtract(_, _));
+  EXPECT_CALL(*kd_, hkdfExtract(_, _, _));
   ks_->deriveEarlySecret(psk);
   EXPECT_CALL(*kd_, deriveSecret(_, _, _)).Times(4);
   ks_->getSecret(EarlySecrets::ExternalPskBinder, transcript_);
@@ -76,21 +76,21 @@ TEST_F(KeySchedulerTest, TestEarlyEcdhe) {
   ks_->getSecret(EarlySecrets::EarlyExporter, transcript_);
 
   StringPiece ecdhe{"ecdhe"};
-  EXPECT_CALL(*kd_, deriveSecret(_, _, _)).Times(1);
-  EXPECT_CALL(*kd_, hkdfExtract(_, _));
+  EXPECT_CALL(*kd_, deriveSecret(_, _, _, _)).Times(1);
+  EXPECT_CALL(*kd_, hkdfExtract(_, _, _));
   ks_->deriveHandshakeSecret(ecdhe);
   EXPECT_CALL(*kd_, deriveSecret(_, _, _)).Times(2);
   ks_->getSecret(HandshakeSecrets::ClientHandshakeTraffic, transcript_);
   ks_->getSecret(HandshakeSecrets::ServerHandshakeTraffic, transcript_);
 
-  EXPECT_CALL(*kd_, deriveSecret(_, _, _)).Times(1);
-  EXPECT_CALL(*kd_, hkdfExtract(_, _));
+  EXPECT_CALL(*kd_, deriveSecret(_, _, _, _)).Times(1);
+  EXPECT_CALL(*kd_, hkdfExtract(_, _, _));
   ks_->deriveMasterSecret();
   EXPECT_CALL(*kd_, deriveSecret(_, _, _)).Times(2);
   ks_->getSecret(MasterSecrets::ExporterMaster, transcript_);
   ks_->getSecret(MasterSecrets::ResumptionMaster, transcript_);
 
-  EXPECT_CALL(*kd_, deriveSecret(_, _, _)).Times(2);
+  EXPECT_CALL(*kd_, deriveSecret(_, _, _, _)).Times(2);
   ks_->deriveAppTrafficSecrets(transcript_);
   ks_->getSecret(AppTrafficSecrets::ClientAppTraffic);
   ks_->getSecret(AppTrafficSecrets::ServerAppTraffic);
@@ -98,26 +98,52 @@ TEST_F(KeySchedulerTest, TestEarlyEcdhe) {
 
 TEST_F(KeySchedulerTest, TestNoEarly) {
   StringPiece ecdhe{"ecdhe"};
-  EXPECT_CALL(*kd_, deriveSecret(_, _, _)).Times(1);
-  EXPECT_CALL(*kd_, hkdfExtract(_, _)).Times(2);
+  EXPECT_CALL(*kd_, deriveSecret(_, _, _, _)).Times(1);
+  EXPECT_CALL(*kd_, hkdfExtract(_, _, _)).Times(2);
   ks_->deriveHandshakeSecret(ecdhe);
   EXPECT_CALL(*kd_, deriveSecret(_, _, _)).Times(2);
   ks_->getSecret(HandshakeSecrets::ClientHandshakeTraffic, transcript_);
   ks_->getSecret(HandshakeSecrets::ServerHandshakeTraffic, transcript_);
 
-  EXPECT_CALL(*kd_, deriveSecret(_, _, _)).Times(1);
-  EXPECT_CALL(*kd_, hkdfExtract(_, _));
+  EXPECT_CALL(*kd_, deriveSecret(_, _, _, _)).Times(1);
+  EXPECT_CALL(*kd_, hkdfExtract(_, _, _));
   ks_->deriveMasterSecret();
   EXPECT_CALL(*kd_, deriveSecret(_, _, _)).Times(2);
   ks_->getSecret(MasterSecrets::ExporterMaster, transcript_);
   ks_->getSecret(MasterSecrets::ResumptionMaster, transcript_);
 
-  EXPECT_CALL(*kd_, deriveSecret(_, _, _)).Times(2);
+  EXPECT_CALL(*kd_, deriveSecret(_, _, _, _)).Times(2);
   ks_->deriveAppTrafficSecrets(transcript_);
   ks_->getSecret(AppTrafficSecrets::ClientAppTraffic);
   ks_->getSecret(AppTrafficSecrets::ServerAppTraffic);
 }
 
+TEST_F(KeySchedulerTest, TestCachedEarlySecret) {
+  StringPiece psk{"psk"};
+  EXPECT_CALL(*kd_, hkdfExtract(_, _, _));
+  ks_->deriveEarlySecret(psk);
+  auto earlySecret = ks_->getEarlySecret();
+  EXPECT_EQ(earlySecret.size(), 4);
+
+  // A scheduler seeded with the cached early secret performs no extract
+  // and lands in the same early secret state.
+  auto kd = std::make_unique<MockKeyDerivation>();
+  auto kd2 = kd.get();
+  ON_CALL(*kd2, hashLength()).WillByDefault(Return(4));
+  KeyScheduler ks2(std::move(kd));
+  EXPECT_CALL(*kd2, hkdfExtract(_, _, _)).Times(0);
+  ks2.setEarlySecret(folly::range(earlySecret));
+  EXPECT_EQ(ks2.getEarlySecret(), earlySecret);
+  EXPECT_CALL(*kd2, deriveSecret(_, _, _));
+  ks2.getSecret(EarlySecrets::ExternalPskBinder, transcript_);
+}
+
+TEST_F(KeySchedulerTest, TestSetEarlySecretWrongLength) {
+  std::vector<uint8_t> shortSecret(2);
+  EXPECT_THROW(
+      ks_->setEarlySecret(folly::range(shortSecret)), std::runtime_error);
+}
+
 TEST_F(KeySchedulerTest, TestKeyUpdate) {
   StringPiece ecdhe{"ecdhe"};
   ks_->deriveHandshakeSecret(ecdhe);
@@ -136,7 +162,7 @@ TEST_F(KeySchedulerTest, TestKeyUpdate) {
 }
 
 TEST_F(KeySchedulerTest, TestTrafficKey) {
-  EXPECT_CALL(*kd_, _expandLabel(_, _, _, _)).Times(2);
+  EXPECT_CALL(*kd_, expandLabelPair(_, _, _, _, _));
   StringPiece trafficSecret{"secret"};
   ks_->getTrafficKey(trafficSecret, 10, 10);
 }
@@ -146,25 +172,18 @@ TEST_F(KeySchedulerTest, TestTrafficKeyWithLabel) {
   StringPiece keyLabel{"fookey"};
   StringPiece ivLabel{"fooiv"};
 
-  InSequence seq;
-  EXPECT_CALL(*kd_, _expandLabel(_, _, _, _))
-      .WillOnce(
-          Invoke([&](auto secret, auto label, const auto&, const auto& len) {
-            EXPECT_EQ(folly::hexlify(trafficSecret), folly::hexlify(secret));
-            EXPECT_EQ(folly::hexlify(label), folly::hexlify(keyLabel));
-            auto res = IOBuf::create(len);
-            res->append(len);
-            return res;
-          }));
-  EXPECT_CALL(*kd_, _expandLabel(_, _, _, _))
-      .WillOnce(
-          Invoke([&](auto secret, auto label, const auto&, const auto& len) {
-            EXPECT_EQ(folly::hexlify(trafficSecret), folly::hexlify(secret));
-            EXPECT_EQ(folly::hexlify(label), folly::hexlify(ivLabel));
-            auto res = IOBuf::create(len);
-            res->append(len);
-            return res;
-          }));
+  EXPECT_CALL(*kd_, expandLabelPair(_, _, _, _, _))
+      .WillOnce(Invoke([&](auto secret,
+                           auto firstLabel,
+                           auto firstOut,
+                           auto secondLabel,
+                           auto secondOut) {
+        EXPECT_EQ(folly::hexlify(trafficSecret), folly::hexlify(secret));
+        EXPECT_EQ(folly::hexlify(firstLabel), folly::hexlify(keyLabel));
+        EXPECT_EQ(folly::hexlify(secondLabel), folly::hexlify(ivLabel));
+        EXPECT_EQ(firstOut.size(), 10);
+        EXPECT_EQ(secondOut.size(), 10);
+      }));
   ks_->getTrafficKeyWithLabel(trafficSecret, keyLabel, ivLabel, 10, 10);
 }
 } // namespace test
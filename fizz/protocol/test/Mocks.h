@@ -12,6 +12,7 @@
 #include <fizz/crypto/exchange/test/Mocks.h>
 #include <fizz/crypto/test/Mocks.h>
 #include <fizz/protocol/AsyncFizzBase.h>
+#include <fizz/protocol/AsyncSelfCert.h>
 #include <fizz/protocol/Certificate.h>
 #include <fizz/protocol/CertificateCompressor.h>
 #include <fizz/protocol/CertificateVerifier.h>
@@ -34,6 +35,8 @@ class MockKeyScheduler : public KeyScheduler {
   MockKeyScheduler() : KeyScheduler(std::make_unique<MockKeyDerivation>()) {}
 
   MOCK_METHOD1(deriveEarlySecret, void(folly::ByteRange psk));
+  MOCK_METHOD1(setEarlySecret, void(folly::ByteRange earlySecret));
+  MOCK_CONST_METHOD0(getEarlySecret, SecretStorage());
   MOCK_METHOD0(deriveHandshakeSecret, void());
   MOCK_METHOD1(deriveHandshakeSecret, void(folly::ByteRange ecdhe));
   MOCK_METHOD0(deriveMasterSecret, void());
@@ -94,7 +97,11 @@ class MockHandshakeContext : public HandshakeContext {
   MOCK_METHOD1(appendToTranscript, void(const Buf& transcript));
   MOCK_CONST_METHOD0(getHandshakeContext, Buf());
   MOCK_CONST_METHOD1(getFinishedData, Buf(folly::ByteRange baseKey));
+  MOCK_CONST_METHOD2(
+      verifyFinishedData,
+      bool(folly::ByteRange baseKey, folly::ByteRange finishedData));
   MOCK_CONST_METHOD0(getBlankContext, folly::ByteRange());
+  MOCK_CONST_METHOD0(fork, std::unique_ptr<HandshakeContext>());
 
   void setDefaults() {
     ON_CALL(*this, getHandshakeContext()).WillByDefault(InvokeWithoutArgs([]() {
@@ -104,6 +111,21 @@ class MockHandshakeContext : public HandshakeContext {
     ON_CALL(*this, getFinishedData(_)).WillByDefault(InvokeWithoutArgs([]() {
       return folly::IOBuf::copyBuffer("verifydata");
     }));
+
+    // Matches the default getFinishedData() value so mismatch tests that
+    // hand in other verify_data still fail verification.
+    ON_CALL(*this, verifyFinishedData(_, _))
+        .WillByDefault(
+            Invoke([](folly::ByteRange, folly::ByteRange finishedData) {
+              return folly::ByteRange(folly::StringPiece("verifydata")) ==
+                  finishedData;
+            }));
+
+    ON_CALL(*this, fork()).WillByDefault(InvokeWithoutArgs([]() {
+      auto ret = std::make_unique<NiceMock<MockHandshakeContext>>();
+      ret->setDefaults();
+      return ret;
+    }));
   }
 };
 
@@ -126,6 +148,7 @@ class MockSelfCert : public SelfCert {
   MOCK_CONST_METHOD1(
       getCompressedCert,
       CompressedCertificate(CertificateCompressionAlgorithm));
+  MOCK_METHOD1(precompressCert, void(CertificateCompressor&));
 
   MOCK_CONST_METHOD3(
       sign,
@@ -135,6 +158,35 @@ class MockSelfCert : public SelfCert {
   MOCK_CONST_METHOD0(getX509, folly::ssl::X509UniquePtr());
 };
 
+class MockAsyncSelfCert : public AsyncSelfCert {
+ public:
+  MOCK_CONST_METHOD0(getIdentity, std::string());
+  MOCK_CONST_METHOD0(getAltIdentities, std::vector<std::string>());
+  MOCK_CONST_METHOD0(getSigSchemes, std::vector<SignatureScheme>());
+
+  MOCK_CONST_METHOD1(_getCertMessage, CertificateMsg(Buf&));
+  CertificateMsg getCertMessage(Buf buf) const override {
+    return _getCertMessage(buf);
+  }
+  MOCK_CONST_METHOD1(
+      getCompressedCert,
+      CompressedCertificate(CertificateCompressionAlgorithm));
+  MOCK_METHOD1(precompressCert, void(CertificateCompressor&));
+
+  MOCK_CONST_METHOD3(
+      sign,
+      Buf(SignatureScheme scheme,
+          CertificateVerifyContext context,
+          folly::ByteRange toBeSigned));
+  MOCK_CONST_METHOD3(
+      signFuture,
+      folly::Future<folly::Optional<Buf>>(
+          SignatureScheme scheme,
+          CertificateVerifyContext context,
+          folly::ByteRange toBeSigned));
+  MOCK_CONST_METHOD0(getX509, folly::ssl::X509UniquePtr());
+};
+
 class MockPeerCert : public PeerCert {
  public:
   MOCK_CONST_METHOD0(getIdentity, std::string());
@@ -179,6 +231,9 @@ class MockFactory : public OpenSSLFactory {
   MOCK_CONST_METHOD1(
       makeHandshakeContext,
       std::unique_ptr<HandshakeContext>(CipherSuite cipher));
+  MOCK_CONST_METHOD1(
+      makeHrrHandshakeContext,
+      std::unique_ptr<HandshakeContext>(CipherSuite cipher));
   MOCK_CONST_METHOD1(
       makeKeyExchange,
       std::unique_ptr<KeyExchange>(NamedGroup group));
@@ -229,6 +284,13 @@ class MockFactory : public OpenSSLFactory {
           ret->setDefaults();
           return ret;
         }));
+    ON_CALL(*this, makeHrrHandshakeContext(_))
+        .WillByDefault(Invoke([this](CipherSuite cipher) {
+          // Bypass OpenSSLFactory's real-context cache: the base fallback
+          // routes through the mocked makeHandshakeContext and appends the
+          // message_hash header, which is what tests expect.
+          return Factory::makeHrrHandshakeContext(cipher);
+        }));
     ON_CALL(*this, makeKeyExchange(_)).WillByDefault(InvokeWithoutArgs([]() {
       auto ret = std::make_unique<NiceMock<MockKeyExchange>>();
       ret->setDefaults();
@@ -301,6 +363,7 @@ class MockAsyncFizzBase : public AsyncFizzBase {
   MOCK_CONST_METHOD0(getCipher, folly::Optional<CipherSuite>());
   MOCK_CONST_METHOD0(getSupportedSigSchemes, std::vector<SignatureScheme>());
   MOCK_CONST_METHOD3(getEkm, Buf(folly::StringPiece, const Buf&, uint16_t));
+  MOCK_METHOD1(updateTrafficKeys, void(bool));
 
   MOCK_METHOD3(
       writeAppDataInternal,
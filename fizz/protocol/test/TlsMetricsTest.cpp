@@ -0,0 +1,58 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GTest.h>
+
+#include <fizz/protocol/TlsMetrics.h>
+
+#include <folly/synchronization/Baton.h>
+
+#include <thread>
+
+namespace fizz {
+namespace test {
+
+// The registry is process-global, so tests measure deltas against a
+// baseline snapshot rather than absolute values.
+TEST(TlsMetricsTest, TestLocalIncrement) {
+  auto before = TlsMetricsRegistry::aggregate();
+  TlsMetricsRegistry::local().fullHandshakes++;
+  TlsMetricsRegistry::local().recordsRead += 2;
+  auto after = TlsMetricsRegistry::aggregate();
+  EXPECT_EQ(after.fullHandshakes - before.fullHandshakes, 1);
+  EXPECT_EQ(after.recordsRead - before.recordsRead, 2);
+}
+
+TEST(TlsMetricsTest, TestCrossThreadAggregation) {
+  auto before = TlsMetricsRegistry::aggregate();
+
+  // Counters drop with their thread, so aggregate while the workers are
+  // still alive.
+  folly::Baton<> counted1, counted2, release1, release2;
+  std::thread worker1([&] {
+    TlsMetricsRegistry::local().pskHandshakes++;
+    counted1.post();
+    release1.wait();
+  });
+  std::thread worker2([&] {
+    TlsMetricsRegistry::local().pskHandshakes++;
+    counted2.post();
+    release2.wait();
+  });
+  counted1.wait();
+  counted2.wait();
+  auto after = TlsMetricsRegistry::aggregate();
+  release1.post();
+  release2.post();
+  worker1.join();
+  worker2.join();
+
+  EXPECT_EQ(after.pskHandshakes - before.pskHandshakes, 2);
+}
+} // namespace test
+} // namespace fizz
@@ -240,6 +240,30 @@ TEST_F(ZlibCertificateCompressorTest, TestCompressDecompress) {
   EXPECT_TRUE(IOBufEqualTo()(encode(certMsg), encode(decompressedCertMsg)));
 }
 
+TEST_F(ZlibCertificateCompressorTest, TestPooledStreamReuse) {
+  auto certAndKey = createCert("fizz-selfsigned", false, nullptr);
+  std::vector<folly::ssl::X509UniquePtr> certs;
+  certs.push_back(std::move(certAndKey.cert));
+  auto cert =
+      CertUtils::makeSelfCert(std::move(certs), std::move(certAndKey.key));
+  auto certMsg = cert->getCertMessage();
+
+  // Repeated compressions on one thread reuse the pooled deflate stream,
+  // including a level change between compressor instances.
+  auto first = compressor_->compress(certMsg);
+  auto second = compressor_->compress(certMsg);
+  ZlibCertificateCompressor fastCompressor(1);
+  auto third = fastCompressor.compress(certMsg);
+
+  EXPECT_TRUE(IOBufEqualTo()(
+      first.compressed_certificate_message,
+      second.compressed_certificate_message));
+  for (auto* cc : {&first, &second, &third}) {
+    auto decompressed = decompressor_->decompress(*cc);
+    EXPECT_TRUE(IOBufEqualTo()(encode(certMsg), encode(decompressed)));
+  }
+}
+
 TEST_F(ZlibCertificateCompressorTest, TestHugeCompressedCert) {
   auto cc = decodeHex<CompressedCertificate>(tooLargeCompressedCertificate);
 
@@ -262,6 +286,21 @@ TEST_F(ZlibCertificateCompressorTest, TestHugeCompressedCert) {
   }
 }
 
+TEST_F(ZlibCertificateCompressorTest, TestImplausibleRatio) {
+  // A tiny compressed blob claiming a huge (but still under the message
+  // size limit) uncompressed length is rejected before decompression.
+  CompressedCertificate cc;
+  cc.algorithm = CertificateCompressionAlgorithm::zlib;
+  cc.compressed_certificate_message = IOBuf::copyBuffer("tiny");
+  cc.uncompressed_length = kMaxHandshakeSize;
+  try {
+    decompressor_->decompress(cc);
+    FAIL() << "Decompressor decompressed cert erroneously";
+  } catch (const std::exception& e) {
+    EXPECT_THAT(e.what(), HasSubstr("implausible compression ratio"));
+  }
+}
+
 TEST_F(ZlibCertificateCompressorTest, TestBadMessages) {
   auto compressedCert =
       decodeHex<CompressedCertificate>(exampleCompressedCertificate);
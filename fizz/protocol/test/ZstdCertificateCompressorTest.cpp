@@ -115,6 +115,50 @@ TEST_F(ZstdCertificateCompressorTest, TestCompressDecompress) {
   EXPECT_TRUE(IOBufEqualTo()(encode(certMsg), encode(decompressedCertMsg)));
 }
 
+TEST_F(ZstdCertificateCompressorTest, TestDictionaryCompressDecompress) {
+  auto certAndKey = createCert("fizz-selfsigned", false, nullptr);
+  std::vector<folly::ssl::X509UniquePtr> certs;
+  certs.push_back(std::move(certAndKey.cert));
+  auto cert =
+      CertUtils::makeSelfCert(std::move(certs), std::move(certAndKey.key));
+  auto certMsg = cert->getCertMessage();
+
+  // Any shared byte content works as a dictionary as long as both sides
+  // load the same one; a trained dictionary just compresses better.
+  auto dictData = encode(cert->getCertMessage());
+  auto dictRange = dictData->coalesce();
+
+  ZstdCertificateCompressor dictCompressor(19, dictRange);
+  ZstdCertificateDecompressor dictDecompressor(dictRange);
+
+  auto compressedCertMsg = dictCompressor.compress(certMsg);
+  EXPECT_EQ(compressedCertMsg.algorithm, CertificateCompressionAlgorithm::zstd);
+
+  auto decompressedCertMsg = dictDecompressor.decompress(compressedCertMsg);
+  EXPECT_TRUE(IOBufEqualTo()(encode(certMsg), encode(decompressedCertMsg)));
+}
+
+TEST_F(ZstdCertificateCompressorTest, TestPooledContextReuse) {
+  auto certAndKey = createCert("fizz-selfsigned", false, nullptr);
+  std::vector<folly::ssl::X509UniquePtr> certs;
+  certs.push_back(std::move(certAndKey.cert));
+  auto cert =
+      CertUtils::makeSelfCert(std::move(certs), std::move(certAndKey.key));
+  auto certMsg = cert->getCertMessage();
+
+  // Repeated compressions on one thread reuse the pooled compression
+  // context.
+  auto first = compressor_->compress(certMsg);
+  auto second = compressor_->compress(certMsg);
+  EXPECT_TRUE(IOBufEqualTo()(
+      first.compressed_certificate_message,
+      second.compressed_certificate_message));
+  for (auto* cc : {&first, &second}) {
+    auto decompressed = decompressor_->decompress(*cc);
+    EXPECT_TRUE(IOBufEqualTo()(encode(certMsg), encode(decompressed)));
+  }
+}
+
 TEST_F(ZstdCertificateCompressorTest, TestCompressedCertEmpty) {
   CompressedCertificate compressedCert;
   compressedCert.uncompressed_length = 0;
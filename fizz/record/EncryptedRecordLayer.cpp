@@ -8,6 +8,12 @@
 
 #include <fizz/record/EncryptedRecordLayer.h>
 #include <fizz/crypto/aead/IOBufUtil.h>
+#include <fizz/protocol/TlsMetrics.h>
+#include <fizz/util/BufferPool.h>
+#include <folly/Random.h>
+#include <folly/tracing/StaticTracepoint.h>
+
+#include <typeinfo>
 
 namespace fizz {
 
@@ -16,14 +22,13 @@ using ProtocolVersionType =
     typename std::underlying_type<ProtocolVersion>::type;
 
 static constexpr uint16_t kMaxEncryptedRecordSize = 0x4000 + 256; // 16k + 256
-static constexpr size_t kEncryptedHeaderSize =
-    sizeof(ContentType) + sizeof(ProtocolVersion) + sizeof(uint16_t);
 
 EncryptedReadRecordLayer::EncryptedReadRecordLayer(
     EncryptionLevel encryptionLevel)
-    : encryptionLevel_(encryptionLevel) {}
+    : adBuf_(folly::IOBuf::wrapBufferAsValue(folly::range(adScratch_))),
+      encryptionLevel_(encryptionLevel) {}
 
-folly::Optional<Buf> EncryptedReadRecordLayer::getDecryptedBuf(
+ReadResult<Buf> EncryptedReadRecordLayer::getDecryptedBuf(
     folly::IOBufQueue& buf) {
   while (true) {
     // Cache the front buffer, calling front may invoke and update
@@ -32,13 +37,11 @@ folly::Optional<Buf> EncryptedReadRecordLayer::getDecryptedBuf(
     folly::io::Cursor cursor(frontBuf);
 
     if (buf.empty() || !cursor.canAdvance(kEncryptedHeaderSize)) {
-      return folly::none;
+      return folly::Optional<Buf>();
     }
 
-    std::array<uint8_t, kEncryptedHeaderSize> ad;
     folly::io::Cursor adCursor(cursor);
-    adCursor.pull(ad.data(), ad.size());
-    folly::IOBuf adBuf{folly::IOBuf::wrapBufferAsValue(folly::range(ad))};
+    adCursor.pull(adScratch_.data(), adScratch_.size());
 
     auto contentType =
         static_cast<ContentType>(cursor.readBE<ContentTypeType>());
@@ -46,21 +49,27 @@ folly::Optional<Buf> EncryptedReadRecordLayer::getDecryptedBuf(
 
     auto length = cursor.readBE<uint16_t>();
     if (length == 0) {
-      throw std::runtime_error("received 0 length encrypted record");
+      return folly::makeUnexpected(ReadError{
+          "received 0 length encrypted record",
+          AlertDescription::decode_error});
     }
     if (length > kMaxEncryptedRecordSize) {
-      throw std::runtime_error("received too long encrypted record");
+      return folly::makeUnexpected(ReadError{
+          "received too long encrypted record",
+          AlertDescription::decode_error});
     }
     auto consumedBytes = cursor - frontBuf;
     if (buf.chainLength() < consumedBytes + length) {
-      return folly::none;
+      return folly::Optional<Buf>();
     }
 
     if (contentType == ContentType::alert && length == 2) {
       auto alert = decode<Alert>(cursor);
-      throw std::runtime_error(folly::to<std::string>(
-          "received plaintext alert in encrypted record: ",
-          toString(alert.description)));
+      return folly::makeUnexpected(ReadError{
+          folly::to<std::string>(
+              "received plaintext alert in encrypted record: ",
+              toString(alert.description)),
+          AlertDescription::decode_error});
     }
 
     // If we already know that the length of the buffer is the
@@ -74,12 +83,14 @@ folly::Optional<Buf> EncryptedReadRecordLayer::getDecryptedBuf(
     trimStart(*encrypted, consumedBytes);
 
     if (contentType == ContentType::change_cipher_spec) {
-      encrypted->coalesce();
-      if (encrypted->length() == 1 && *encrypted->data() == 0x01) {
+      // No need to coalesce the chain for a 1 byte record.
+      folly::io::Cursor ccsCursor(encrypted.get());
+      if (encrypted->computeChainDataLength() == 1 &&
+          ccsCursor.read<uint8_t>() == 0x01) {
         continue;
       } else {
-        throw FizzException(
-            "received ccs", AlertDescription::illegal_parameter);
+        return folly::makeUnexpected(
+            ReadError{"received ccs", AlertDescription::illegal_parameter});
       }
     }
 
@@ -87,37 +98,150 @@ folly::Optional<Buf> EncryptedReadRecordLayer::getDecryptedBuf(
     if (seqNum_ == std::numeric_limits<uint64_t>::max()) {
       throw std::runtime_error("max read seq num");
     }
+    FOLLY_SDT(fizz, record_decrypt_begin, length);
     if (skipFailedDecryption_) {
       auto decryptAttempt = aead_->tryDecrypt(
-          std::move(encrypted), useAdditionalData_ ? &adBuf : nullptr, seqNum_);
+          std::move(encrypted), useAdditionalData_ ? &adBuf_ : nullptr, seqNum_);
       if (decryptAttempt) {
         seqNum_++;
         skipFailedDecryption_ = false;
-        return decryptAttempt;
+        FOLLY_SDT(fizz, record_decrypt_end, length);
+        return folly::Optional<Buf>(std::move(decryptAttempt));
       } else {
+        TlsMetricsRegistry::local().decryptFailures++;
+        if (stats_) {
+          stats_->decryptFailures++;
+        }
+        if (auto* callback = rateLimitedCallback()) {
+          callback->decryptFailure(seqNum_, true);
+        }
         continue;
       }
     } else {
-      return aead_->decrypt(
-          std::move(encrypted),
-          useAdditionalData_ ? &adBuf : nullptr,
-          seqNum_++);
+      try {
+        auto decrypted = aead_->decrypt(
+            std::move(encrypted),
+            useAdditionalData_ ? &adBuf_ : nullptr,
+            seqNum_++);
+        FOLLY_SDT(fizz, record_decrypt_end, length);
+        return folly::Optional<Buf>(std::move(decrypted));
+      } catch (const std::exception& e) {
+        TlsMetricsRegistry::local().decryptFailures++;
+        if (stats_) {
+          stats_->decryptFailures++;
+        }
+        if (auto* callback = rateLimitedCallback()) {
+          callback->decryptFailure(seqNum_ - 1, false);
+        }
+        return folly::makeUnexpected(ReadError{
+            folly::to<std::string>("decryption failed: ", e.what()),
+            AlertDescription::decode_error});
+      }
     }
   }
 }
 
-folly::Optional<TLSMessage> EncryptedReadRecordLayer::read(
+ReadResult<CiphertextRecord> EncryptedReadRecordLayer::readCiphertextRecord(
     folly::IOBufQueue& buf) {
-  auto decryptedBuf = getDecryptedBuf(buf);
-  if (!decryptedBuf) {
-    return folly::none;
+  if (skipFailedDecryption_) {
+    return folly::makeUnexpected(ReadError{
+        "pipelined read while trial decryption armed",
+        AlertDescription::internal_error});
   }
+  while (true) {
+    auto frontBuf = buf.front();
+    folly::io::Cursor cursor(frontBuf);
 
+    if (buf.empty() || !cursor.canAdvance(kEncryptedHeaderSize)) {
+      return folly::Optional<CiphertextRecord>();
+    }
+
+    CiphertextRecord record;
+    folly::io::Cursor adCursor(cursor);
+    adCursor.pull(record.header.data(), record.header.size());
+
+    auto contentType =
+        static_cast<ContentType>(cursor.readBE<ContentTypeType>());
+    cursor.skip(sizeof(ProtocolVersion));
+
+    auto length = cursor.readBE<uint16_t>();
+    if (length == 0) {
+      return folly::makeUnexpected(ReadError{
+          "received 0 length encrypted record",
+          AlertDescription::decode_error});
+    }
+    if (length > kMaxEncryptedRecordSize) {
+      return folly::makeUnexpected(ReadError{
+          "received too long encrypted record",
+          AlertDescription::decode_error});
+    }
+    auto consumedBytes = cursor - frontBuf;
+    if (buf.chainLength() < consumedBytes + length) {
+      return folly::Optional<CiphertextRecord>();
+    }
+
+    if (contentType == ContentType::alert && length == 2) {
+      auto alert = decode<Alert>(cursor);
+      return folly::makeUnexpected(ReadError{
+          folly::to<std::string>(
+              "received plaintext alert in encrypted record: ",
+              toString(alert.description)),
+          AlertDescription::decode_error});
+    }
+
+    std::unique_ptr<folly::IOBuf> encrypted;
+    if (buf.chainLength() == consumedBytes + length) {
+      encrypted = buf.move();
+    } else {
+      encrypted = buf.split(consumedBytes + length);
+    }
+    trimStart(*encrypted, consumedBytes);
+
+    if (contentType == ContentType::change_cipher_spec) {
+      folly::io::Cursor ccsCursor(encrypted.get());
+      if (encrypted->computeChainDataLength() == 1 &&
+          ccsCursor.read<uint8_t>() == 0x01) {
+        continue;
+      } else {
+        return folly::makeUnexpected(
+            ReadError{"received ccs", AlertDescription::illegal_parameter});
+      }
+    }
+
+    if (seqNum_ == std::numeric_limits<uint64_t>::max()) {
+      throw std::runtime_error("max read seq num");
+    }
+    record.ciphertext = std::move(encrypted);
+    record.seqNum = seqNum_++;
+    return folly::Optional<CiphertextRecord>(std::move(record));
+  }
+}
+
+ReadResult<TLSMessage> EncryptedReadRecordLayer::decryptAndParse(
+    const Aead& aead,
+    CiphertextRecord&& record,
+    bool useAdditionalData) {
+  auto adBuf = folly::IOBuf::wrapBufferAsValue(folly::range(record.header));
+  try {
+    auto decrypted = aead.decrypt(
+        std::move(record.ciphertext),
+        useAdditionalData ? &adBuf : nullptr,
+        record.seqNum);
+    return parseMessage(std::move(decrypted));
+  } catch (const std::exception& e) {
+    return folly::makeUnexpected(ReadError{
+        folly::to<std::string>("decryption failed: ", e.what()),
+        AlertDescription::decode_error});
+  }
+}
+
+ReadResult<TLSMessage> EncryptedReadRecordLayer::parseMessage(
+    Buf decryptedBuf) {
   TLSMessage msg;
   // Iterate over the buffers while trying to find
   // the first non-zero octet. This is much faster than
   // first iterating and then trimming.
-  auto currentBuf = decryptedBuf->get();
+  auto currentBuf = decryptedBuf.get();
   bool nonZeroFound = false;
   do {
     currentBuf = currentBuf->prev();
@@ -130,11 +254,12 @@ folly::Optional<TLSMessage> EncryptedReadRecordLayer::read(
       msg.type = static_cast<ContentType>(currentBuf->data()[i]);
     }
     currentBuf->trimEnd(currentBuf->length() - i);
-  } while (!nonZeroFound && currentBuf != decryptedBuf->get());
+  } while (!nonZeroFound && currentBuf != decryptedBuf.get());
   if (!nonZeroFound) {
-    throw std::runtime_error("No content type found");
+    return folly::makeUnexpected(
+        ReadError{"No content type found", AlertDescription::decode_error});
   }
-  msg.fragment = std::move(*decryptedBuf);
+  msg.fragment = std::move(decryptedBuf);
 
   switch (msg.type) {
     case ContentType::handshake:
@@ -142,20 +267,85 @@ folly::Optional<TLSMessage> EncryptedReadRecordLayer::read(
     case ContentType::application_data:
       break;
     default:
-      throw std::runtime_error(folly::to<std::string>(
-          "received encrypted content type ",
-          static_cast<ContentTypeType>(msg.type)));
+      return folly::makeUnexpected(ReadError{
+          folly::to<std::string>(
+              "received encrypted content type ",
+              static_cast<ContentTypeType>(msg.type)),
+          AlertDescription::decode_error});
   }
 
   if (!msg.fragment) {
     if (msg.type == ContentType::application_data) {
       msg.fragment = folly::IOBuf::create(0);
     } else {
-      throw std::runtime_error("received empty fragment");
+      return folly::makeUnexpected(
+          ReadError{"received empty fragment", AlertDescription::decode_error});
+    }
+  }
+
+  return folly::Optional<TLSMessage>(std::move(msg));
+}
+
+ReadResult<TLSMessage> EncryptedReadRecordLayer::read(
+    folly::IOBufQueue& buf) {
+  auto decryptedResult = getDecryptedBuf(buf);
+  if (decryptedResult.hasError()) {
+    return folly::makeUnexpected(std::move(decryptedResult.error()));
+  }
+  auto& decryptedBuf = *decryptedResult;
+  if (!decryptedBuf) {
+    return folly::Optional<TLSMessage>();
+  }
+
+  size_t decryptedLen = 0;
+  if (stats_) {
+    decryptedLen = (*decryptedBuf)->computeChainDataLength();
+  }
+
+  auto parsed = parseMessage(std::move(*decryptedBuf));
+  if (parsed.hasError()) {
+    return parsed;
+  }
+  auto& msg = **parsed;
+
+  TlsMetricsRegistry::local().recordsRead++;
+  if (stats_) {
+    auto fragmentLen = msg.fragment->computeChainDataLength();
+    stats_->recordsRead++;
+    stats_->bytesRead += fragmentLen;
+    // Whatever the decrypted record contained beyond the fragment and the
+    // content type octet was padding.
+    stats_->paddingBytesRead += decryptedLen - fragmentLen - 1;
+  }
+
+  if (msg.type == ContentType::alert) {
+    if (stats_) {
+      stats_->alertsReceived++;
+    }
+    if (auto* callback = rateLimitedCallback()) {
+      // An alert fragment is a level octet followed by the description.
+      folly::io::Cursor alertCursor(msg.fragment.get());
+      if (alertCursor.totalLength() >= 2) {
+        alertCursor.skip(1);
+        callback->alertReceived(
+            static_cast<AlertDescription>(alertCursor.read<uint8_t>()));
+      }
     }
   }
 
-  return msg;
+  return folly::Optional<TLSMessage>(std::move(msg));
+}
+
+ReadResult<Param> EncryptedReadRecordLayer::readEvent(
+    folly::IOBufQueue& socketBuf) {
+  if (typeid(*this) != typeid(EncryptedReadRecordLayer)) {
+    // A subclass (mock, transparent layer) may have overridden read();
+    // take the virtual path so its override is honored.
+    return ReadRecordLayer::readEvent(socketBuf);
+  }
+  return readEventImpl(socketBuf, [this](folly::IOBufQueue& buf) {
+    return EncryptedReadRecordLayer::read(buf);
+  });
 }
 
 EncryptionLevel EncryptedReadRecordLayer::getEncryptionLevel() const {
@@ -164,53 +354,92 @@ EncryptionLevel EncryptedReadRecordLayer::getEncryptionLevel() const {
 
 EncryptedWriteRecordLayer::EncryptedWriteRecordLayer(
     EncryptionLevel encryptionLevel)
-    : encryptionLevel_(encryptionLevel) {}
+    : headerBuf_(folly::IOBuf::wrapBufferAsValue(folly::range(headerScratch_))),
+      encryptionLevel_(encryptionLevel) {}
+
+Buf EncryptedWriteRecordLayer::encryptMessage(
+    Buf dataBuf,
+    ContentType type,
+    folly::IOBuf& header) const {
+  size_t paddingSize = 0;
+  if (paddingPolicy_) {
+    auto innerSize = dataBuf->computeChainDataLength() + sizeof(ContentType);
+    // RFC 8446 caps the inner plaintext at 2^14 + 1 bytes.
+    paddingSize = std::min<size_t>(
+        paddingPolicy_->getPaddingSize(innerSize),
+        kMaxPlaintextRecordSize + 1 - innerSize);
+    if (stats_) {
+      stats_->paddingBytesWritten += paddingSize;
+    }
+  }
+
+  // check if we have enough room to add the encrypted footer.
+  if (!dataBuf->isShared() &&
+      dataBuf->prev()->tailroom() >= sizeof(ContentType) + paddingSize) {
+    // extend it and add it
+    folly::io::Appender appender(dataBuf.get(), 0);
+    appender.writeBE(static_cast<ContentTypeType>(type));
+    if (paddingSize != 0) {
+      memset(appender.writableData(), 0, paddingSize);
+      appender.append(paddingSize);
+    }
+  } else {
+    // not enough or shared - let's add enough for the tag as well
+    auto encryptedFooter = folly::IOBuf::create(
+        sizeof(ContentType) + paddingSize + aead_->getCipherOverhead());
+    folly::io::Appender appender(encryptedFooter.get(), 0);
+    appender.writeBE(static_cast<ContentTypeType>(type));
+    if (paddingSize != 0) {
+      memset(appender.writableData(), 0, paddingSize);
+      appender.append(paddingSize);
+    }
+    dataBuf->prependChain(std::move(encryptedFooter));
+  }
+
+  if (seqNum_ == std::numeric_limits<uint64_t>::max()) {
+    throw std::runtime_error("max write seq num");
+  }
+
+  // we will either be able to memcpy directly into the ciphertext or
+  // need to create a new buf to insert before the ciphertext but we need
+  // it for additional data
+  header.clear();
+  folly::io::Appender appender(&header, 0);
+  appender.writeBE(static_cast<ContentTypeType>(ContentType::application_data));
+  appender.writeBE(static_cast<ProtocolVersionType>(ProtocolVersion::tls_1_2));
+  auto plaintextLength = dataBuf->computeChainDataLength();
+  auto ciphertextLength = plaintextLength + aead_->getCipherOverhead();
+  appender.writeBE<uint16_t>(ciphertextLength);
+  bytesWritten_ += plaintextLength;
+
+  // If we exclusively own the buffer we can encrypt in place and avoid
+  // allocating a ciphertext buffer for every record.
+  FOLLY_SDT(fizz, record_encrypt_begin, plaintextLength);
+  Buf cipherText;
+  if (!dataBuf->isShared()) {
+    cipherText = aead_->inplaceEncrypt(
+        std::move(dataBuf), useAdditionalData_ ? &header : nullptr, seqNum_++);
+  } else {
+    cipherText = aead_->encrypt(
+        std::move(dataBuf), useAdditionalData_ ? &header : nullptr, seqNum_++);
+  }
+  FOLLY_SDT(fizz, record_encrypt_end, plaintextLength);
+  return cipherText;
+}
 
 TLSContent EncryptedWriteRecordLayer::write(TLSMessage&& msg) const {
-  folly::IOBufQueue queue;
+  folly::IOBufQueue queue{folly::IOBufQueue::cacheChainLength()};
   queue.append(std::move(msg.fragment));
   std::unique_ptr<folly::IOBuf> outBuf;
-  std::array<uint8_t, kEncryptedHeaderSize> headerBuf;
-  auto header = folly::IOBuf::wrapBufferAsValue(folly::range(headerBuf));
-  aead_->setEncryptedBufferHeadroom(kEncryptedHeaderSize);
+  auto& header = headerBuf_;
   while (!queue.empty()) {
     auto dataBuf = getBufToEncrypt(queue);
-    // Currently we never send padding.
-
-    // check if we have enough room to add the encrypted footer.
-    if (!dataBuf->isShared() &&
-        dataBuf->prev()->tailroom() >= sizeof(ContentType)) {
-      // extend it and add it
-      folly::io::Appender appender(dataBuf.get(), 0);
-      appender.writeBE(static_cast<ContentTypeType>(msg.type));
-    } else {
-      // not enough or shared - let's add enough for the tag as well
-      auto encryptedFooter = folly::IOBuf::create(
-          sizeof(ContentType) + aead_->getCipherOverhead());
-      folly::io::Appender appender(encryptedFooter.get(), 0);
-      appender.writeBE(static_cast<ContentTypeType>(msg.type));
-      dataBuf->prependChain(std::move(encryptedFooter));
+    TlsMetricsRegistry::local().recordsWritten++;
+    if (stats_) {
+      stats_->recordsWritten++;
+      stats_->bytesWritten += dataBuf->computeChainDataLength();
     }
-
-    if (seqNum_ == std::numeric_limits<uint64_t>::max()) {
-      throw std::runtime_error("max write seq num");
-    }
-
-    // we will either be able to memcpy directly into the ciphertext or
-    // need to create a new buf to insert before the ciphertext but we need
-    // it for additional data
-    header.clear();
-    folly::io::Appender appender(&header, 0);
-    appender.writeBE(
-        static_cast<ContentTypeType>(ContentType::application_data));
-    appender.writeBE(
-        static_cast<ProtocolVersionType>(ProtocolVersion::tls_1_2));
-    auto ciphertextLength =
-        dataBuf->computeChainDataLength() + aead_->getCipherOverhead();
-    appender.writeBE<uint16_t>(ciphertextLength);
-
-    auto cipherText = aead_->encrypt(
-        std::move(dataBuf), useAdditionalData_ ? &header : nullptr, seqNum_++);
+    auto cipherText = encryptMessage(std::move(dataBuf), msg.type, header);
 
     std::unique_ptr<folly::IOBuf> record;
     if (!cipherText->isShared() &&
@@ -242,14 +471,157 @@ TLSContent EncryptedWriteRecordLayer::write(TLSMessage&& msg) const {
   return content;
 }
 
+TLSContent EncryptedWriteRecordLayer::writeBatch(TLSMessage&& msg) const {
+  if (paddingPolicy_) {
+    // The flight buffer is sized without knowing per-record padding; take
+    // the regular path when padding is enabled.
+    return write(std::move(msg));
+  }
+  folly::IOBufQueue queue{folly::IOBufQueue::cacheChainLength()};
+  queue.append(std::move(msg.fragment));
+  auto inputLen = queue.chainLength();
+  auto numRecords = (inputLen + maxRecord_ - 1) / maxRecord_;
+  auto perRecordOverhead =
+      kEncryptedHeaderSize + sizeof(ContentType) + aead_->getCipherOverhead();
+  // One contiguous region for the entire flight of records, pooled
+  // per-thread so steady-state writes stay NUMA-local.
+  auto flight =
+      buffer_pool::allocate(inputLen + numRecords * perRecordOverhead);
+
+  // Frame every record's footer and header up front, building one batch
+  // of independent encrypt jobs. The records of a flight share no state
+  // beyond consecutive sequence numbers, so a multi-buffer backend can
+  // run them through parallel lanes in the single encryptBatch call.
+  std::vector<Aead::BatchJob> jobs;
+  std::vector<std::array<uint8_t, kEncryptedHeaderSize>> headers;
+  std::vector<folly::IOBuf> adBufs;
+  jobs.reserve(numRecords);
+  headers.reserve(numRecords);
+  adBufs.reserve(numRecords);
+  while (!queue.empty()) {
+    auto dataBuf = queue.splitAtMost(maxRecord_);
+    auto dataLen = dataBuf->computeChainDataLength();
+    TlsMetricsRegistry::local().recordsWritten++;
+    if (stats_) {
+      stats_->recordsWritten++;
+      stats_->bytesWritten += dataLen;
+    }
+
+    // No padding on this path, so the footer is just the content type.
+    if (!dataBuf->isShared() &&
+        dataBuf->prev()->tailroom() >= sizeof(ContentType)) {
+      folly::io::Appender appender(dataBuf.get(), 0);
+      appender.writeBE(static_cast<ContentTypeType>(msg.type));
+    } else {
+      auto footer = folly::IOBuf::create(
+          sizeof(ContentType) + aead_->getCipherOverhead());
+      folly::io::Appender appender(footer.get(), 0);
+      appender.writeBE(static_cast<ContentTypeType>(msg.type));
+      dataBuf->prependChain(std::move(footer));
+    }
+
+    if (seqNum_ == std::numeric_limits<uint64_t>::max()) {
+      throw std::runtime_error("max write seq num");
+    }
+    auto plaintextLength = dataLen + sizeof(ContentType);
+    auto ciphertextLength =
+        static_cast<uint16_t>(plaintextLength + aead_->getCipherOverhead());
+    bytesWritten_ += plaintextLength;
+
+    headers.emplace_back();
+    auto& recordHeader = headers.back();
+    recordHeader[0] =
+        static_cast<ContentTypeType>(ContentType::application_data);
+    recordHeader[1] = 0x03;
+    recordHeader[2] = 0x03;
+    recordHeader[3] = static_cast<uint8_t>(ciphertextLength >> 8);
+    recordHeader[4] = static_cast<uint8_t>(ciphertextLength & 0xff);
+    adBufs.push_back(
+        folly::IOBuf::wrapBufferAsValue(folly::range(recordHeader)));
+
+    jobs.push_back(Aead::BatchJob{
+        std::move(dataBuf),
+        useAdditionalData_ ? &adBufs.back() : nullptr,
+        seqNum_++});
+  }
+
+  FOLLY_SDT(fizz, record_encrypt_begin, inputLen);
+  auto cipherTexts = aead_->encryptBatch(std::move(jobs));
+  FOLLY_SDT(fizz, record_encrypt_end, inputLen);
+
+  for (size_t i = 0; i < cipherTexts.size(); i++) {
+    memcpy(flight->writableTail(), headers[i].data(), headers[i].size());
+    flight->append(headers[i].size());
+    for (auto range : *cipherTexts[i]) {
+      memcpy(flight->writableTail(), range.data(), range.size());
+      flight->append(range.size());
+    }
+  }
+
+  TLSContent content;
+  content.data = std::move(flight);
+  content.contentType = msg.type;
+  content.encryptionLevel = encryptionLevel_;
+  return content;
+}
+
 Buf EncryptedWriteRecordLayer::getBufToEncrypt(folly::IOBufQueue& queue) const {
-  if (queue.front()->length() > maxRecord_) {
-    return queue.splitAtMost(maxRecord_);
-  } else if (queue.front()->length() >= desiredMinRecord_) {
-    return queue.pop_front();
-  } else {
-    return queue.splitAtMost(desiredMinRecord_);
+  auto maxRecord = maxRecord_;
+  auto desiredMinRecord = desiredMinRecord_;
+  if (recordSizePolicy_) {
+    maxRecord = recordSizePolicy_->getMaxRecordSize();
+    desiredMinRecord = std::min(desiredMinRecord, maxRecord);
+  }
+
+  // Move whole buffers off the queue wherever possible: pop_front transfers
+  // ownership without touching reference counts. Once the record has at
+  // least desiredMinRecord bytes it ends at a buffer boundary, so fully
+  // owned chains pass through without being cloned; only a buffer that
+  // would straddle the max record boundary is split.
+  Buf buf;
+  size_t length = 0;
+  while (!queue.empty() && length < desiredMinRecord) {
+    auto frontLength = queue.front()->length();
+    if (length + frontLength > maxRecord) {
+      auto tail = queue.splitAtMost(maxRecord - length);
+      length += tail->computeChainDataLength();
+      if (buf) {
+        buf->prependChain(std::move(tail));
+      } else {
+        buf = std::move(tail);
+      }
+      break;
+    }
+    length += frontLength;
+    auto front = queue.pop_front();
+    if (buf) {
+      buf->prependChain(std::move(front));
+    } else {
+      buf = std::move(front);
+    }
+  }
+  if (recordSizePolicy_) {
+    recordSizePolicy_->reportRecordWritten(length);
   }
+  return buf;
+}
+
+void EncryptedWriteRecordLayer::setRekeyThresholds(
+    uint64_t maxBytes,
+    uint64_t maxRecords,
+    double jitter) {
+  DCHECK_GE(jitter, 0.0);
+  DCHECK_LT(jitter, 1.0);
+  // The jitter offset is drawn once so that a connection's effective
+  // thresholds are stable for its lifetime.
+  auto scale = 1.0 - jitter * folly::Random::randDouble01();
+  rekeyAfterBytes_ = static_cast<uint64_t>(maxBytes * scale);
+  rekeyAfterRecords_ = static_cast<uint64_t>(maxRecords * scale);
+}
+
+bool EncryptedWriteRecordLayer::rekeyRecommended() const {
+  return (rekeyAfterBytes_ != 0 && bytesWritten_ >= rekeyAfterBytes_) ||
+      (rekeyAfterRecords_ != 0 && seqNum_ >= rekeyAfterRecords_);
 }
 
 EncryptionLevel EncryptedWriteRecordLayer::getEncryptionLevel() const {
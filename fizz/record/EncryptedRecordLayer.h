@@ -9,21 +9,94 @@
 #pragma once
 
 #include <fizz/record/RecordLayer.h>
+#include <fizz/record/PaddingPolicy.h>
+#include <fizz/record/RecordSizePolicy.h>
 
 #include <fizz/crypto/aead/Aead.h>
+#include <fizz/util/ObjectRecycler.h>
+
+#include <array>
 
 namespace fizz {
 
 constexpr uint16_t kMaxPlaintextRecordSize = 0x4000; // 16k
 constexpr uint16_t kMinSuggestedRecordSize = 1500;
+constexpr size_t kEncryptedHeaderSize =
+    sizeof(ContentType) + sizeof(ProtocolVersion) + sizeof(uint16_t);
+
+/**
+ * Snapshot of one direction of an encrypted record layer, in a form suitable
+ * for handing the connection off to kernel TLS (setsockopt TLS_TX/TLS_RX).
+ */
+struct RecordLayerState {
+  folly::Optional<TrafficKey> key;
+  uint64_t sequence{0};
+};
+
+/**
+ * Record layer state for both directions of a connection.
+ */
+struct KtlsState {
+  RecordLayerState read;
+  RecordLayerState write;
+};
+
+/**
+ * One encrypted record split out of the socket buffer but not yet
+ * decrypted. TLS 1.3 records decrypt independently given their sequence
+ * number, so these can be fanned out to worker threads; the header bytes
+ * are the record's additional data.
+ */
+struct CiphertextRecord {
+  Buf ciphertext;
+  std::array<uint8_t, kEncryptedHeaderSize> header;
+  uint64_t seqNum{0};
+};
 
-class EncryptedReadRecordLayer : public ReadRecordLayer {
+class EncryptedReadRecordLayer
+    : public ReadRecordLayer,
+      public PerThreadRecycled<EncryptedReadRecordLayer> {
  public:
   ~EncryptedReadRecordLayer() override = default;
 
   explicit EncryptedReadRecordLayer(EncryptionLevel encryptionLevel);
 
-  folly::Optional<TLSMessage> read(folly::IOBufQueue& buf) override;
+  ReadResult<TLSMessage> read(folly::IOBufQueue& buf) override;
+
+  /**
+   * Overridden to run the record loop with a direct call to this class's
+   * read() when the object really is an EncryptedReadRecordLayer, letting
+   * the compiler inline decryption into the loop instead of paying a
+   * virtual dispatch per record. Subclasses overriding read() fall back to
+   * the base virtual path.
+   */
+  ReadResult<Param> readEvent(folly::IOBufQueue& socketBuf) override;
+
+  /**
+   * Splits the next complete encrypted record out of buf without
+   * decrypting it, advancing the read sequence number, for pipelined
+   * decryption off the IO thread. Change cipher spec records are skipped
+   * as in read(). Must not be used while skip-failed-decryption is
+   * armed, as trial decryption is inherently serial.
+   */
+  ReadResult<CiphertextRecord> readCiphertextRecord(folly::IOBufQueue& buf);
+
+  /**
+   * Decrypts a record split out by readCiphertextRecord() and parses it
+   * into a TLSMessage. Does not touch this layer's aead or sequence
+   * state, so it is safe to call concurrently from worker threads as
+   * long as each worker uses its own identically keyed aead.
+   */
+  ReadResult<TLSMessage> decryptAndParse(
+      const Aead& aead,
+      CiphertextRecord&& record) const {
+    return decryptAndParse(aead, std::move(record), useAdditionalData_);
+  }
+
+  static ReadResult<TLSMessage> decryptAndParse(
+      const Aead& aead,
+      CiphertextRecord&& record,
+      bool useAdditionalData);
 
   virtual void setAead(
       folly::ByteRange /* baseSecret */,
@@ -34,34 +107,87 @@ class EncryptedReadRecordLayer : public ReadRecordLayer {
     aead_ = std::move(aead);
   }
 
+  void rekey(TrafficKeyDeriver deriver) override {
+    if (!aead_) {
+      throw std::runtime_error("rekey without aead");
+    }
+    aead_->setKey(deriver(aead_->keyLength(), aead_->ivLength()));
+    seqNum_ = 0;
+    if (stats_) {
+      stats_->keyUpdates++;
+    }
+  }
+
+  /**
+   * Restores the read sequence number of a session adopted from a
+   * serialized handoff. Only valid immediately after setAead(), before
+   * any records have been read.
+   */
+  void setSequenceNumber(uint64_t seqNum) {
+    seqNum_ = seqNum;
+  }
+
   virtual void setSkipFailedDecryption(bool enabled) {
     skipFailedDecryption_ = enabled;
   }
 
   void setProtocolVersion(ProtocolVersion version) {
+#ifndef FIZZ_FINAL_TLS13_ONLY
     auto realVersion = getRealDraftVersion(version);
     if (realVersion == ProtocolVersion::tls_1_3_23) {
       useAdditionalData_ = false;
     } else {
       useAdditionalData_ = true;
     }
+#else
+    getRealDraftVersion(version);
+#endif
   }
 
   EncryptionLevel getEncryptionLevel() const override;
 
+  RecordLayerState getRecordLayerState() const {
+    RecordLayerState state;
+    if (aead_) {
+      state.key = aead_->getKey();
+    }
+    state.sequence = seqNum_;
+    return state;
+  }
+
  private:
-  folly::Optional<Buf> getDecryptedBuf(folly::IOBufQueue& buf);
+  ReadResult<Buf> getDecryptedBuf(folly::IOBufQueue& buf);
+
+  /**
+   * Strips padding from a decrypted record, extracts the inner content
+   * type and validates it, producing the plaintext message.
+   */
+  static ReadResult<TLSMessage> parseMessage(Buf decryptedBuf);
+
+  // Fixed scratch for the record header additional data, patched per record
+  // and passed as a non-owning wrap so no buffers are constructed per
+  // record.
+  std::array<uint8_t, kEncryptedHeaderSize> adScratch_;
+  folly::IOBuf adBuf_;
 
   EncryptionLevel encryptionLevel_;
   std::unique_ptr<Aead> aead_;
   bool skipFailedDecryption_{false};
 
+#ifndef FIZZ_FINAL_TLS13_ONLY
   bool useAdditionalData_{true};
+#else
+  // Draft support compiled out: final-RFC records always authenticate
+  // the record header, so the per-record branch folds away.
+  static constexpr bool useAdditionalData_ = true;
+#endif
 
   mutable uint64_t seqNum_{0};
 };
 
-class EncryptedWriteRecordLayer : public WriteRecordLayer {
+class EncryptedWriteRecordLayer
+    : public WriteRecordLayer,
+      public PerThreadRecycled<EncryptedWriteRecordLayer> {
  public:
   ~EncryptedWriteRecordLayer() override = default;
 
@@ -69,6 +195,14 @@ class EncryptedWriteRecordLayer : public WriteRecordLayer {
 
   TLSContent write(TLSMessage&& msg) const override;
 
+  /**
+   * Writes a message as with write(), but splits it into all of its records
+   * up front and frames the entire flight into a single contiguous buffer,
+   * at the cost of one copy of the ciphertext. Useful for large writes where
+   * per-record buffer chains would otherwise balloon the iovec count.
+   */
+  TLSContent writeBatch(TLSMessage&& msg) const;
+
   virtual void setAead(
       folly::ByteRange /* baseSecret */,
       std::unique_ptr<Aead> aead) {
@@ -76,8 +210,44 @@ class EncryptedWriteRecordLayer : public WriteRecordLayer {
       throw std::runtime_error("aead set after write");
     }
     aead_ = std::move(aead);
+    // Ask the aead to reserve room for the record header so that we can
+    // frame header, ciphertext and tag in one contiguous buffer.
+    aead_->setEncryptedBufferHeadroom(kEncryptedHeaderSize);
   }
 
+  void rekey(TrafficKeyDeriver deriver) override {
+    if (!aead_) {
+      throw std::runtime_error("rekey without aead");
+    }
+    aead_->setKey(deriver(aead_->keyLength(), aead_->ivLength()));
+    seqNum_ = 0;
+    bytesWritten_ = 0;
+    if (stats_) {
+      stats_->keyUpdates++;
+    }
+  }
+
+  /**
+   * Restores the write sequence number of a session adopted from a
+   * serialized handoff. Only valid immediately after setAead(), before
+   * any records have been written.
+   */
+  void setSequenceNumber(uint64_t seqNum) {
+    seqNum_ = seqNum;
+  }
+
+  /**
+   * Arms rekeyRecommended() to fire once maxBytes of plaintext or maxRecords
+   * records have been written under the current key. A threshold of 0
+   * disables that limit. jitter (in [0, 1)) randomly lowers the effective
+   * thresholds by up to that fraction, so that a fleet of connections
+   * brought up together does not rekey in lockstep.
+   */
+  void
+  setRekeyThresholds(uint64_t maxBytes, uint64_t maxRecords, double jitter);
+
+  bool rekeyRecommended() const override;
+
   void setMaxRecord(uint16_t size) {
     CHECK_GT(size, 0);
     DCHECK_LE(size, kMaxPlaintextRecordSize);
@@ -90,16 +260,57 @@ class EncryptedWriteRecordLayer : public WriteRecordLayer {
     desiredMinRecord_ = size;
   }
 
+  /**
+   * Sets a policy that dynamically chooses the record size per record,
+   * overriding the static max/min desired record knobs.
+   */
+  void setRecordSizePolicy(std::unique_ptr<RecordSizePolicy> policy) {
+    recordSizePolicy_ = std::move(policy);
+  }
+
+  /**
+   * Sets a policy that appends zero padding to each record. The padding
+   * is written into the same tailroom used for the content type byte and
+   * AEAD tag, so no extra buffers are allocated. No padding is sent by
+   * default.
+   */
+  void setPaddingPolicy(std::unique_ptr<PaddingPolicy> policy) {
+    paddingPolicy_ = std::move(policy);
+  }
+
   EncryptionLevel getEncryptionLevel() const override;
 
+  RecordLayerState getRecordLayerState() const {
+    RecordLayerState state;
+    if (aead_) {
+      state.key = aead_->getKey();
+    }
+    state.sequence = seqNum_;
+    return state;
+  }
+
  private:
   Buf getBufToEncrypt(folly::IOBufQueue& queue) const;
 
+  Buf encryptMessage(Buf dataBuf, ContentType type, folly::IOBuf& header)
+      const;
+
+  // Fixed scratch for the record header, rewritten per record and shared
+  // between records as the additional data.
+  mutable std::array<uint8_t, kEncryptedHeaderSize> headerScratch_;
+  mutable folly::IOBuf headerBuf_;
+
   std::unique_ptr<Aead> aead_;
 
   uint16_t maxRecord_{kMaxPlaintextRecordSize};
   uint16_t desiredMinRecord_{kMinSuggestedRecordSize};
+  std::unique_ptr<RecordSizePolicy> recordSizePolicy_;
+  std::unique_ptr<PaddingPolicy> paddingPolicy_;
+
+  uint64_t rekeyAfterBytes_{0};
+  uint64_t rekeyAfterRecords_{0};
 
+  mutable uint64_t bytesWritten_{0};
   mutable uint64_t seqNum_{0};
   EncryptionLevel encryptionLevel_;
 };
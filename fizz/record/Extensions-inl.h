@@ -6,6 +6,7 @@
  *  LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
 #include <vector>
 
 #include <fizz/record/Types.h>
@@ -161,6 +162,41 @@ inline CertificateCompressionAlgorithms getExtension(folly::io::Cursor& cs) {
   return cca;
 }
 
+template <>
+inline DelegatedCredentialSupport getExtension(folly::io::Cursor& cs) {
+  DelegatedCredentialSupport support;
+  detail::readVector<uint16_t>(support.supported_signature_algorithms, cs);
+  return support;
+}
+
+template <>
+inline DelegatedCredential getExtension(folly::io::Cursor& cs) {
+  DelegatedCredential credential;
+  detail::read(credential.valid_time, cs);
+  detail::read(credential.expected_verify_scheme, cs);
+  detail::readBuf<detail::bits24>(credential.public_key, cs);
+  detail::read(credential.credential_scheme, cs);
+  detail::readBuf<uint16_t>(credential.signature, cs);
+  return credential;
+}
+
+template <>
+inline CertificateStatusRequest getExtension(folly::io::Cursor& cs) {
+  CertificateStatusRequest request;
+  detail::read(request.status_type, cs);
+  detail::readBuf<uint16_t>(request.responder_id_list, cs);
+  detail::readBuf<uint16_t>(request.request_extensions, cs);
+  return request;
+}
+
+template <>
+inline CertificateStatus getExtension(folly::io::Cursor& cs) {
+  CertificateStatus status;
+  detail::read(status.status_type, cs);
+  detail::readBuf<detail::bits24>(status.response, cs);
+  return status;
+}
+
 template <>
 inline Extension encodeExtension(const SignatureAlgorithms& sig) {
   Extension ext;
@@ -338,6 +374,54 @@ inline Extension encodeExtension(const CertificateCompressionAlgorithms& cca) {
   return ext;
 }
 
+template <>
+inline Extension encodeExtension(const DelegatedCredentialSupport& support) {
+  Extension ext;
+  ext.extension_type = ExtensionType::delegated_credential;
+  ext.extension_data = folly::IOBuf::create(0);
+  folly::io::Appender appender(ext.extension_data.get(), 10);
+  detail::writeVector<uint16_t>(
+      support.supported_signature_algorithms, appender);
+  return ext;
+}
+
+template <>
+inline Extension encodeExtension(const DelegatedCredential& credential) {
+  Extension ext;
+  ext.extension_type = ExtensionType::delegated_credential;
+  ext.extension_data = folly::IOBuf::create(0);
+  folly::io::Appender appender(ext.extension_data.get(), 10);
+  detail::write(credential.valid_time, appender);
+  detail::write(credential.expected_verify_scheme, appender);
+  detail::writeBuf<detail::bits24>(credential.public_key, appender);
+  detail::write(credential.credential_scheme, appender);
+  detail::writeBuf<uint16_t>(credential.signature, appender);
+  return ext;
+}
+
+template <>
+inline Extension encodeExtension(const CertificateStatusRequest& request) {
+  Extension ext;
+  ext.extension_type = ExtensionType::status_request;
+  ext.extension_data = folly::IOBuf::create(0);
+  folly::io::Appender appender(ext.extension_data.get(), 10);
+  detail::write(request.status_type, appender);
+  detail::writeBuf<uint16_t>(request.responder_id_list, appender);
+  detail::writeBuf<uint16_t>(request.request_extensions, appender);
+  return ext;
+}
+
+template <>
+inline Extension encodeExtension(const CertificateStatus& status) {
+  Extension ext;
+  ext.extension_type = ExtensionType::status_request;
+  ext.extension_data = folly::IOBuf::create(0);
+  folly::io::Appender appender(ext.extension_data.get(), 10);
+  detail::write(status.status_type, appender);
+  detail::writeBuf<detail::bits24>(status.response, appender);
+  return ext;
+}
+
 inline size_t getBinderLength(const ClientHello& chlo) {
   if (chlo.extensions.empty() ||
       chlo.extensions.back().extension_type != ExtensionType::pre_shared_key) {
@@ -515,4 +599,43 @@ struct Sizer<DistinguishedName> {
   }
 };
 } // namespace detail
+
+inline ExtensionIndex::ExtensionIndex(const std::vector<Extension>& extensions)
+    : extensions_(extensions) {
+  index_.reserve(extensions.size());
+  for (size_t i = 0; i < extensions.size(); i++) {
+    index_.emplace_back(extensions[i].extension_type, i);
+  }
+  // A stable sort keeps duplicates in message order, so lookups return the
+  // first occurrence like findExtension().
+  std::stable_sort(
+      index_.begin(), index_.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+      });
+}
+
+inline const Extension* ExtensionIndex::find(ExtensionType type) const {
+  auto it = std::lower_bound(
+      index_.begin(), index_.end(), type, [](const auto& entry, auto t) {
+        return entry.first < t;
+      });
+  if (it == index_.end() || it->first != type) {
+    return nullptr;
+  }
+  return &extensions_[it->second];
+}
+
+template <class T>
+inline folly::Optional<T> ExtensionIndex::getExtension() const {
+  auto extension = find(T::extension_type);
+  if (!extension) {
+    return folly::none;
+  }
+  folly::io::Cursor cs{extension->extension_data.get()};
+  auto ret = fizz::getExtension<T>(cs);
+  if (!cs.isAtEnd()) {
+    throw std::runtime_error("didn't read entire extension");
+  }
+  return ret;
+}
 } // namespace fizz
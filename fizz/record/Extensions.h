@@ -133,6 +133,56 @@ struct CertificateAuthorities {
       ExtensionType::certificate_authorities;
 };
 
+/**
+ * delegated_credential in a ClientHello: the signature schemes the client
+ * will accept for a delegated credential's CertificateVerify.
+ */
+struct DelegatedCredentialSupport {
+  std::vector<SignatureScheme> supported_signature_algorithms;
+  static constexpr ExtensionType extension_type =
+      ExtensionType::delegated_credential;
+};
+
+/**
+ * delegated_credential in a CertificateEntry. valid_time is seconds from
+ * the delegating certificate's notBefore; public_key is a DER
+ * SubjectPublicKeyInfo; credential_scheme and signature are the scheme
+ * and signature the certificate's key produced over the delegation.
+ */
+struct DelegatedCredential {
+  uint32_t valid_time;
+  SignatureScheme expected_verify_scheme;
+  Buf public_key;
+  SignatureScheme credential_scheme;
+  Buf signature;
+  static constexpr ExtensionType extension_type =
+      ExtensionType::delegated_credential;
+};
+
+enum class CertificateStatusType : uint8_t { ocsp = 1 };
+
+/**
+ * status_request in a ClientHello. The responder id list and request
+ * extensions are carried opaquely; servers only care that ocsp status
+ * was requested.
+ */
+struct CertificateStatusRequest {
+  CertificateStatusType status_type{CertificateStatusType::ocsp};
+  Buf responder_id_list;
+  Buf request_extensions;
+  static constexpr ExtensionType extension_type = ExtensionType::status_request;
+};
+
+/**
+ * status_request in a CertificateEntry, carrying a DER encoded OCSP
+ * response for that certificate.
+ */
+struct CertificateStatus {
+  CertificateStatusType status_type{CertificateStatusType::ocsp};
+  Buf response;
+  static constexpr ExtensionType extension_type = ExtensionType::status_request;
+};
+
 struct CertificateCompressionAlgorithms {
   std::vector<CertificateCompressionAlgorithm> algorithms;
   static constexpr ExtensionType extension_type =
@@ -151,6 +201,32 @@ std::vector<Extension>::const_iterator findExtension(
     const std::vector<Extension>& extensions,
     ExtensionType type);
 
+/**
+ * Index over an extensions list built in a single pass, for call sites that
+ * look up several extension types from the same message. Lookups are a binary
+ * search over a (type, position) table instead of a linear scan per type, and
+ * typed extensions are still only decoded when asked for.
+ *
+ * The index holds a reference to the extensions vector; it must not outlive
+ * it or be used after the vector is modified.
+ */
+class ExtensionIndex {
+ public:
+  explicit ExtensionIndex(const std::vector<Extension>& extensions);
+
+  /**
+   * Returns the first extension of the given type, or nullptr.
+   */
+  const Extension* find(ExtensionType type) const;
+
+  template <class T>
+  folly::Optional<T> getExtension() const;
+
+ private:
+  const std::vector<Extension>& extensions_;
+  std::vector<std::pair<ExtensionType, uint16_t>> index_;
+};
+
 size_t getBinderLength(const ClientHello& chlo);
 } // namespace fizz
 
@@ -0,0 +1,66 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace fizz {
+
+/**
+ * Policy controlling how much zero padding a write record layer appends
+ * to each record, hiding exact plaintext lengths from an observer.
+ * Padding is counted against the RFC 8446 inner plaintext limit, so the
+ * record layer may send less padding than requested for records close to
+ * the maximum size.
+ */
+class PaddingPolicy {
+ public:
+  virtual ~PaddingPolicy() = default;
+
+  /**
+   * Returns the number of zero bytes to append to a record whose inner
+   * plaintext (content plus the content type byte) is innerSize bytes.
+   */
+  virtual size_t getPaddingSize(size_t innerSize) const = 0;
+};
+
+/**
+ * Rounds every record up to a multiple of blockSize, so an observer only
+ * learns lengths at block granularity. Small blocks (64-256 bytes) hide
+ * message sizes within a class of messages at low bandwidth cost.
+ */
+class PadToBlockPolicy : public PaddingPolicy {
+ public:
+  explicit PadToBlockPolicy(size_t blockSize) : blockSize_(blockSize) {}
+
+  size_t getPaddingSize(size_t innerSize) const override {
+    return (blockSize_ - innerSize % blockSize_) % blockSize_;
+  }
+
+ private:
+  size_t blockSize_;
+};
+
+/**
+ * Pads records shorter than a fixed size (typically derived from the path
+ * MTU) up to exactly that size; longer records already fill the wire and
+ * are left unpadded.
+ */
+class PadToFixedSizePolicy : public PaddingPolicy {
+ public:
+  explicit PadToFixedSizePolicy(size_t size) : size_(size) {}
+
+  size_t getPaddingSize(size_t innerSize) const override {
+    return innerSize < size_ ? size_ - innerSize : 0;
+  }
+
+ private:
+  size_t size_;
+};
+} // namespace fizz
@@ -20,13 +20,13 @@ static constexpr uint16_t kMaxPlaintextRecordSize = 0x4000; // 16k
 static constexpr size_t kPlaintextHeaderSize =
     sizeof(ContentType) + sizeof(ProtocolVersion) + sizeof(uint16_t);
 
-folly::Optional<TLSMessage> PlaintextReadRecordLayer::read(
+ReadResult<TLSMessage> PlaintextReadRecordLayer::read(
     folly::IOBufQueue& buf) {
   while (true) {
     folly::io::Cursor cursor(buf.front());
 
     if (buf.empty() || !cursor.canAdvance(kPlaintextHeaderSize)) {
-      return folly::none;
+      return folly::Optional<TLSMessage>();
     }
 
     TLSMessage msg;
@@ -37,7 +37,7 @@ folly::Optional<TLSMessage> PlaintextReadRecordLayer::read(
         cursor.skip(sizeof(ProtocolVersion));
         auto length = cursor.readBE<uint16_t>();
         if (buf.chainLength() < (cursor - buf.front()) + length) {
-          return folly::none;
+          return folly::Optional<TLSMessage>();
         }
         buf.trimStart(static_cast<size_t>(kPlaintextHeaderSize) + length);
         continue;
@@ -53,11 +53,13 @@ folly::Optional<TLSMessage> PlaintextReadRecordLayer::read(
       case ContentType::change_cipher_spec:
         break;
       default:
-        throw std::runtime_error(folly::to<std::string>(
-            "received plaintext content type ",
-            static_cast<ContentTypeType>(msg.type),
-            ", header: ",
-            folly::hexlify(buf.splitAtMost(10)->coalesce())));
+        return folly::makeUnexpected(ReadError{
+            folly::to<std::string>(
+                "received plaintext content type ",
+                static_cast<ContentTypeType>(msg.type),
+                ", header: ",
+                folly::hexlify(buf.splitAtMost(10)->coalesce())),
+            AlertDescription::decode_error});
     }
 
     receivedRecordVersion_ =
@@ -65,13 +67,16 @@ folly::Optional<TLSMessage> PlaintextReadRecordLayer::read(
 
     auto length = cursor.readBE<uint16_t>();
     if (length > kMaxPlaintextRecordSize) {
-      throw std::runtime_error("received too long plaintext record");
+      return folly::makeUnexpected(ReadError{
+          "received too long plaintext record",
+          AlertDescription::decode_error});
     }
     if (length == 0) {
-      throw std::runtime_error("received empty plaintext record");
+      return folly::makeUnexpected(ReadError{
+          "received empty plaintext record", AlertDescription::decode_error});
     }
     if (buf.chainLength() < (cursor - buf.front()) + length) {
-      return folly::none;
+      return folly::Optional<TLSMessage>();
     }
 
     cursor.clone(msg.fragment, length);
@@ -83,12 +88,12 @@ folly::Optional<TLSMessage> PlaintextReadRecordLayer::read(
       if (msg.fragment->length() == 1 && *msg.fragment->data() == 0x01) {
         continue;
       } else {
-        throw FizzException(
-            "received ccs", AlertDescription::illegal_parameter);
+        return folly::makeUnexpected(
+            ReadError{"received ccs", AlertDescription::illegal_parameter});
       }
     }
 
-    return msg;
+    return folly::Optional<TLSMessage>(std::move(msg));
   }
 }
 
@@ -9,10 +9,13 @@
 #pragma once
 
 #include <fizz/record/RecordLayer.h>
+#include <fizz/util/ObjectRecycler.h>
 
 namespace fizz {
 
-class PlaintextReadRecordLayer : public ReadRecordLayer {
+class PlaintextReadRecordLayer
+    : public ReadRecordLayer,
+      public PerThreadRecycled<PlaintextReadRecordLayer> {
  public:
   ~PlaintextReadRecordLayer() override = default;
 
@@ -23,7 +26,7 @@ class PlaintextReadRecordLayer : public ReadRecordLayer {
     skipEncryptedRecords_ = enabled;
   }
 
-  folly::Optional<TLSMessage> read(folly::IOBufQueue& buf) override;
+  ReadResult<TLSMessage> read(folly::IOBufQueue& buf) override;
 
   /**
    * Get the record protocol version of the most recent received record.
@@ -41,7 +44,9 @@ class PlaintextReadRecordLayer : public ReadRecordLayer {
   folly::Optional<ProtocolVersion> receivedRecordVersion_;
 };
 
-class PlaintextWriteRecordLayer : public WriteRecordLayer {
+class PlaintextWriteRecordLayer
+    : public WriteRecordLayer,
+      public PerThreadRecycled<PlaintextWriteRecordLayer> {
  public:
   ~PlaintextWriteRecordLayer() override = default;
 
@@ -0,0 +1,115 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/Conv.h>
+#include <glog/logging.h>
+
+namespace fizz {
+
+template <class ReadFunc>
+ReadResult<Param> ReadRecordLayer::readEventImpl(
+    folly::IOBufQueue& socketBuf,
+    ReadFunc readRecord) {
+  if (!unparsedHandshakeData_.empty()) {
+    auto param = reassembleHandshakeMessage();
+    if (param.hasError()) {
+      return param;
+    }
+    if (param->hasValue()) {
+      VLOG(8) << "Received handshake message " << toString(getEvent(**param));
+      return param;
+    }
+  }
+
+  while (true) {
+    // Read one record. We read one record at a time since records could cause
+    // a change in the record layer.
+    folly::Optional<TLSMessage> message;
+    if (bufferedMessage_) {
+      message = std::move(bufferedMessage_);
+      bufferedMessage_ = folly::none;
+    } else {
+      auto read = readRecord(socketBuf);
+      if (read.hasError()) {
+        return folly::makeUnexpected(std::move(read.error()));
+      }
+      message = std::move(*read);
+    }
+    if (!message) {
+      return folly::Optional<Param>();
+    }
+
+    if ((handshakeBuffer_ || !unparsedHandshakeData_.empty()) &&
+        message->type != ContentType::handshake) {
+      return folly::makeUnexpected(
+          ReadError{"spliced handshake data", AlertDescription::decode_error});
+    }
+
+    switch (message->type) {
+      case ContentType::alert: {
+        Alert alert;
+        try {
+          alert = decode<Alert>(std::move(message->fragment));
+        } catch (const std::exception& e) {
+          return folly::makeUnexpected(ReadError{
+              folly::to<std::string>("alert decode error: ", e.what()),
+              AlertDescription::decode_error});
+        }
+        if (alert.description == AlertDescription::close_notify) {
+          return folly::Optional<Param>(Param(CloseNotify(socketBuf.move())));
+        } else {
+          return folly::Optional<Param>(Param(std::move(alert)));
+        }
+      }
+      case ContentType::handshake: {
+        unparsedHandshakeData_.append(std::move(message->fragment));
+        auto param = reassembleHandshakeMessage();
+        if (param.hasError()) {
+          return param;
+        }
+        if (param->hasValue()) {
+          VLOG(8) << "Received handshake message "
+                  << toString(getEvent(**param));
+          return param;
+        } else {
+          // If we read handshake data but didn't have enough to get a full
+          // message we immediately try to read another record. Buffering is
+          // bounded: the reassembly buffer is allocated once at the size the
+          // message header declared, capped at kMaxHandshakeSize.
+          continue;
+        }
+      }
+      case ContentType::application_data:
+        if (batchAppDataReads_) {
+          // Drain any further complete app data records so that we only pay
+          // the per-event fixed costs once. A non-app data record stops the
+          // drain and is saved for the next readEvent() call.
+          while (true) {
+            auto next = readRecord(socketBuf);
+            if (next.hasError()) {
+              return folly::makeUnexpected(std::move(next.error()));
+            }
+            if (!next->hasValue()) {
+              break;
+            }
+            if ((*next)->type != ContentType::application_data) {
+              bufferedMessage_ = std::move(**next);
+              break;
+            }
+            message->fragment->prependChain(std::move((*next)->fragment));
+          }
+        }
+        return folly::Optional<Param>(
+            Param(AppData(std::move(message->fragment))));
+      default:
+        return folly::makeUnexpected(
+            ReadError{"unknown content type", AlertDescription::decode_error});
+    }
+  }
+}
+} // namespace fizz
@@ -15,59 +15,51 @@ using HandshakeTypeType = typename std::underlying_type<HandshakeType>::type;
 static constexpr size_t kHandshakeHeaderSize =
     sizeof(HandshakeType) + detail::bits24::size;
 
-folly::Optional<Param> ReadRecordLayer::readEvent(
-    folly::IOBufQueue& socketBuf) {
-  if (!unparsedHandshakeData_.empty()) {
-    auto param = decodeHandshakeMessage(unparsedHandshakeData_);
-    if (param) {
-      VLOG(8) << "Received handshake message "
-              << toString(boost::apply_visitor(EventVisitor(), *param));
-      return param;
-    }
-  }
+ReadResult<Param> ReadRecordLayer::readEvent(folly::IOBufQueue& socketBuf) {
+  return readEventImpl(
+      socketBuf, [this](folly::IOBufQueue& buf) { return read(buf); });
+}
 
-  while (true) {
-    // Read one record. We read one record at a time since records could cause
-    // a change in the record layer.
-    auto message = read(socketBuf);
-    if (!message) {
-      return folly::none;
+ReadResult<Param> ReadRecordLayer::reassembleHandshakeMessage() {
+  if (!handshakeBuffer_) {
+    if (unparsedHandshakeData_.chainLength() < kHandshakeHeaderSize) {
+      return folly::Optional<Param>();
     }
-
-    if (!unparsedHandshakeData_.empty() &&
-        message->type != ContentType::handshake) {
-      throw std::runtime_error("spliced handshake data");
+    folly::io::Cursor cursor(unparsedHandshakeData_.front());
+    cursor.skip(sizeof(HandshakeType));
+    auto length = detail::readBits24(cursor);
+    if (length > kMaxHandshakeSize) {
+      return folly::makeUnexpected(ReadError{
+          "handshake record too big", AlertDescription::decode_error});
     }
-
-    switch (message->type) {
-      case ContentType::alert: {
-        auto alert = decode<Alert>(std::move(message->fragment));
-        if (alert.description == AlertDescription::close_notify) {
-          return Param(CloseNotify(socketBuf.move()));
-        } else {
-          return Param(std::move(alert));
-        }
-      }
-      case ContentType::handshake: {
-        unparsedHandshakeData_.append(std::move(message->fragment));
-        auto param = decodeHandshakeMessage(unparsedHandshakeData_);
-        if (param) {
-          VLOG(8) << "Received handshake message "
-                  << toString(boost::apply_visitor(EventVisitor(), *param));
-          return param;
-        } else {
-          // If we read handshake data but didn't have enough to get a full
-          // message we immediately try to read another record.
-          // TODO: add limits on number of records we buffer
-          continue;
-        }
-      }
-      case ContentType::application_data:
-        return Param(AppData(std::move(message->fragment)));
-      default:
-        throw std::runtime_error("unknown content type");
+    auto messageSize = kHandshakeHeaderSize + length;
+    if (unparsedHandshakeData_.chainLength() >= messageSize) {
+      // The complete message is already buffered, decode it in place.
+      return decodeHandshakeMessage(unparsedHandshakeData_);
     }
+    handshakeBuffer_ = folly::IOBuf::create(messageSize);
+    handshakeBufferTarget_ = messageSize;
   }
+
+  auto toCopy = std::min(
+      unparsedHandshakeData_.chainLength(),
+      handshakeBufferTarget_ - handshakeBuffer_->length());
+  if (toCopy > 0) {
+    folly::io::Cursor cursor(unparsedHandshakeData_.front());
+    cursor.pull(handshakeBuffer_->writableTail(), toCopy);
+    handshakeBuffer_->append(toCopy);
+    unparsedHandshakeData_.trimStart(toCopy);
+  }
+  if (handshakeBuffer_->length() < handshakeBufferTarget_) {
+    return folly::Optional<Param>();
+  }
+
+  folly::IOBufQueue message{folly::IOBufQueue::cacheChainLength()};
+  message.append(std::move(handshakeBuffer_));
+  handshakeBufferTarget_ = 0;
+  auto param = decodeHandshakeMessage(message);
+  DCHECK(param.hasError() || param->hasValue());
+  return param;
 }
 
 template <typename T>
@@ -96,12 +88,12 @@ Param parse<ServerHello>(Buf handshakeMsg, Buf original) {
   }
 }
 
-folly::Optional<Param> ReadRecordLayer::decodeHandshakeMessage(
+ReadResult<Param> ReadRecordLayer::decodeHandshakeMessage(
     folly::IOBufQueue& buf) {
   folly::io::Cursor cursor(buf.front());
 
   if (!cursor.canAdvance(kHandshakeHeaderSize)) {
-    return folly::none;
+    return folly::Optional<Param>();
   }
 
   auto handshakeType =
@@ -109,52 +101,83 @@ folly::Optional<Param> ReadRecordLayer::decodeHandshakeMessage(
   auto length = detail::readBits24(cursor);
 
   if (length > kMaxHandshakeSize) {
-    throw std::runtime_error("handshake record too big");
+    return folly::makeUnexpected(
+        ReadError{"handshake record too big", AlertDescription::decode_error});
   }
   if (buf.chainLength() < (cursor - buf.front()) + length) {
-    return folly::none;
+    return folly::Optional<Param>();
   }
 
   Buf handshakeMsg;
   cursor.clone(handshakeMsg, length);
   auto original = buf.split(kHandshakeHeaderSize + length);
 
-  switch (handshakeType) {
-    case HandshakeType::client_hello:
-      return parse<ClientHello>(std::move(handshakeMsg), std::move(original));
-    case HandshakeType::server_hello:
-      return parse<ServerHello>(std::move(handshakeMsg), std::move(original));
-    case HandshakeType::end_of_early_data:
-      return parse<EndOfEarlyData>(
-          std::move(handshakeMsg), std::move(original));
-    case HandshakeType::new_session_ticket:
-      return parse<NewSessionTicket>(
-          std::move(handshakeMsg), std::move(original));
-    case HandshakeType::encrypted_extensions:
-      return parse<EncryptedExtensions>(
-          std::move(handshakeMsg), std::move(original));
-    case HandshakeType::certificate:
-      return parse<CertificateMsg>(
-          std::move(handshakeMsg), std::move(original));
-    case HandshakeType::compressed_certificate:
-      return parse<CompressedCertificate>(
-          std::move(handshakeMsg), std::move(original));
-    case HandshakeType::certificate_request:
-      return parse<CertificateRequest>(
-          std::move(handshakeMsg), std::move(original));
-    case HandshakeType::certificate_verify:
-      return parse<CertificateVerify>(
-          std::move(handshakeMsg), std::move(original));
-    case HandshakeType::finished:
-      return parse<Finished>(std::move(handshakeMsg), std::move(original));
-    case HandshakeType::key_update:
-      return parse<KeyUpdate>(std::move(handshakeMsg), std::move(original));
-    default:
-      throw std::runtime_error("unknown handshake type");
-  };
+  // The decoded message keeps its full original encoding alive, so its
+  // fields can alias the receive buffer rather than copying out of it.
+  detail::AliasingDecodeScope aliasingScope;
+  // The decode helpers still throw internally on malformed message bodies;
+  // that cost is confined to well-framed messages of a known type, while
+  // record framing garbage never reaches an exception.
+  try {
+    folly::Optional<Param> param;
+    switch (handshakeType) {
+      case HandshakeType::client_hello:
+        param =
+            parse<ClientHello>(std::move(handshakeMsg), std::move(original));
+        break;
+      case HandshakeType::server_hello:
+        param =
+            parse<ServerHello>(std::move(handshakeMsg), std::move(original));
+        break;
+      case HandshakeType::end_of_early_data:
+        param = parse<EndOfEarlyData>(
+            std::move(handshakeMsg), std::move(original));
+        break;
+      case HandshakeType::new_session_ticket:
+        param = parse<NewSessionTicket>(
+            std::move(handshakeMsg), std::move(original));
+        break;
+      case HandshakeType::encrypted_extensions:
+        param = parse<EncryptedExtensions>(
+            std::move(handshakeMsg), std::move(original));
+        break;
+      case HandshakeType::certificate:
+        param = parse<CertificateMsg>(
+            std::move(handshakeMsg), std::move(original));
+        break;
+      case HandshakeType::compressed_certificate:
+        param = parse<CompressedCertificate>(
+            std::move(handshakeMsg), std::move(original));
+        break;
+      case HandshakeType::certificate_request:
+        param = parse<CertificateRequest>(
+            std::move(handshakeMsg), std::move(original));
+        break;
+      case HandshakeType::certificate_verify:
+        param = parse<CertificateVerify>(
+            std::move(handshakeMsg), std::move(original));
+        break;
+      case HandshakeType::finished:
+        param = parse<Finished>(std::move(handshakeMsg), std::move(original));
+        break;
+      case HandshakeType::key_update:
+        param = parse<KeyUpdate>(std::move(handshakeMsg), std::move(original));
+        break;
+      default:
+        return folly::makeUnexpected(ReadError{
+            "unknown handshake type", AlertDescription::decode_error});
+    };
+    return param;
+  } catch (const std::exception& e) {
+    return folly::makeUnexpected(ReadError{
+        folly::to<std::string>("handshake decode error: ", e.what()),
+        AlertDescription::decode_error});
+  }
 }
 
 bool ReadRecordLayer::hasUnparsedHandshakeData() const {
-  return !unparsedHandshakeData_.empty();
+  return !unparsedHandshakeData_.empty() || handshakeBuffer_ != nullptr ||
+      (bufferedMessage_.hasValue() &&
+       bufferedMessage_->type == ContentType::handshake);
 }
 } // namespace fizz
@@ -8,11 +8,16 @@
 
 #pragma once
 
+#include <fizz/crypto/aead/Aead.h>
 #include <fizz/protocol/Params.h>
 #include <fizz/record/Types.h>
+#include <folly/Expected.h>
+#include <folly/Function.h>
 #include <folly/Optional.h>
 #include <folly/io/IOBufQueue.h>
 
+#include <chrono>
+
 namespace fizz {
 
 struct TLSContent {
@@ -21,39 +26,206 @@ struct TLSContent {
   EncryptionLevel encryptionLevel;
 };
 
+/**
+ * Callable that derives a new TrafficKey given the aead's key and iv
+ * lengths. Used to rekey a record layer in place on a KeyUpdate.
+ */
+using TrafficKeyDeriver =
+    folly::Function<TrafficKey(size_t keyLength, size_t ivLength)>;
+
+/**
+ * Parse failure on the record layer read path. Malformed input from the
+ * peer is reported as a value rather than thrown, so an attacker spraying
+ * garbage records pays the cost of a failed parse, not of exception
+ * unwinding. Exceptions on the read path are reserved for programming
+ * errors and resource exhaustion.
+ */
+struct ReadError {
+  std::string message;
+  folly::Optional<AlertDescription> alert;
+};
+
+/**
+ * Result of a read path operation: a ReadError for malformed input, an
+ * empty optional when more data is needed, or the parsed value.
+ */
+template <class T>
+using ReadResult = folly::Expected<folly::Optional<T>, ReadError>;
+
+/**
+ * Plain per-connection traffic counters, updated inline by the encrypted
+ * record layers. The block is aligned to its own cacheline so the hot
+ * write path does not false-share with neighboring members of its owner.
+ * All counts are in plaintext bytes; the padding counters cover the zero
+ * bytes appended after the content type in each direction.
+ */
+struct alignas(64) RecordLayerStats {
+  uint64_t recordsRead{0};
+  uint64_t bytesRead{0};
+  uint64_t paddingBytesRead{0};
+  uint64_t decryptFailures{0};
+  uint64_t alertsReceived{0};
+  uint64_t recordsWritten{0};
+  uint64_t bytesWritten{0};
+  uint64_t paddingBytesWritten{0};
+  uint64_t keyUpdates{0};
+};
+
+/**
+ * Callback for failure-path record events. Counters in RecordLayerStats
+ * are always updated; the callback additionally fires for events that
+ * warrant immediate attention (logging, fleet telemetry), rate limited by
+ * the record layer so a flood of bad records cannot turn into a flood of
+ * callbacks. Invoked inline from the read path; implementations should be
+ * cheap and must not reenter the record layer.
+ */
+class RecordEventCallback {
+ public:
+  virtual ~RecordEventCallback() = default;
+
+  /**
+   * A record failed to decrypt. skipped indicates the failure was
+   * swallowed by skipFailedDecryption (an expected early data discard)
+   * rather than surfaced as a connection error.
+   */
+  virtual void decryptFailure(uint64_t seqNum, bool skipped) noexcept = 0;
+
+  /**
+   * An encrypted alert record was received from the peer.
+   */
+  virtual void alertReceived(AlertDescription description) noexcept = 0;
+};
+
 class ReadRecordLayer {
  public:
   virtual ~ReadRecordLayer() = default;
 
   /**
    * Reads a fragment from the record layer. Returns an empty optional if
-   * insuficient data available. Throws if data malformed. On success, advances
-   * buf the amount read.
+   * insuficient data available, a ReadError if the data is malformed. On
+   * success, advances buf the amount read.
    */
-  virtual folly::Optional<TLSMessage> read(folly::IOBufQueue& buf) = 0;
+  virtual ReadResult<TLSMessage> read(folly::IOBufQueue& buf) = 0;
 
   /**
    * Get a message from the record layer. Returns none if insufficient data was
-   * available on the socket. Throws on parse error.
+   * available on the socket, a ReadError on parse error.
    */
-  virtual folly::Optional<Param> readEvent(folly::IOBufQueue& socketBuf);
+  virtual ReadResult<Param> readEvent(folly::IOBufQueue& socketBuf);
 
   /**
    * Check if there is decrypted but unparsed handshake data buffered.
    */
   virtual bool hasUnparsedHandshakeData() const;
 
+  /**
+   * Controls whether readEvent() drains all consecutive application data
+   * records available in the buffer into a single AppData event, rather than
+   * returning one event per record. A non-app data record encountered while
+   * draining is buffered and returned by the next readEvent() call.
+   */
+  void setBatchAppDataReads(bool enabled) {
+    batchAppDataReads_ = enabled;
+  }
+
+  /**
+   * Buffer an already-read message to be returned by the next readEvent()
+   * call. Used by fast path readers that pull app data records directly off
+   * the record layer and need to hand anything else back to the state
+   * machine.
+   */
+  void bufferMessage(TLSMessage msg) {
+    bufferedMessage_ = std::move(msg);
+  }
+
+  /**
+   * Replaces the traffic key on the existing aead and resets the sequence
+   * number, reusing the record layer and its cipher contexts. Only
+   * supported on encrypted record layers.
+   */
+  virtual void rekey(TrafficKeyDeriver /* deriver */) {
+    throw std::runtime_error("rekey unsupported");
+  }
+
   /**
    * Returns the current encryption level of the data that the read record layer
    * can process.
    */
   virtual EncryptionLevel getEncryptionLevel() const = 0;
 
-  static folly::Optional<Param> decodeHandshakeMessage(folly::IOBufQueue& buf);
+  static ReadResult<Param> decodeHandshakeMessage(folly::IOBufQueue& buf);
+
+  /**
+   * Attaches a stats block updated inline as records are read. Not owned;
+   * may be null. Only encrypted record layers update it.
+   */
+  void setStats(RecordLayerStats* stats) {
+    stats_ = stats;
+  }
+
+  /**
+   * Attaches a callback notified of failure-path events, invoked at most
+   * once per minInterval. Not owned; may be null. Only encrypted record
+   * layers fire it.
+   */
+  void setEventCallback(
+      RecordEventCallback* callback,
+      std::chrono::milliseconds minInterval = std::chrono::seconds(1)) {
+    eventCallback_ = callback;
+    eventCallbackInterval_ = minInterval;
+  }
+
+ protected:
+  /**
+   * Body of readEvent(), templated on the callable used to read a record
+   * so that subclasses fixed to a concrete record layer can instantiate
+   * the loop with a direct (non-virtual) read call and have the whole
+   * record loop inlined. The base class instantiates it with a plain
+   * virtual read() call.
+   */
+  template <class ReadFunc>
+  ReadResult<Param> readEventImpl(
+      folly::IOBufQueue& socketBuf,
+      ReadFunc readRecord);
+
+  /**
+   * Returns the event callback if one is attached and the rate limit
+   * allows another notification, otherwise nullptr. Costs a single null
+   * check when no callback is attached.
+   */
+  RecordEventCallback* rateLimitedCallback() {
+    if (!eventCallback_) {
+      return nullptr;
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (now - lastEventCallback_ < eventCallbackInterval_) {
+      return nullptr;
+    }
+    lastEventCallback_ = now;
+    return eventCallback_;
+  }
+
+  RecordLayerStats* stats_{nullptr};
 
  private:
+  ReadResult<Param> reassembleHandshakeMessage();
+
+  RecordEventCallback* eventCallback_{nullptr};
+  std::chrono::milliseconds eventCallbackInterval_{std::chrono::seconds(1)};
+  std::chrono::steady_clock::time_point lastEventCallback_;
+
   folly::IOBufQueue unparsedHandshakeData_{
       folly::IOBufQueue::cacheChainLength()};
+
+  // Incremental reassembly of a fragmented handshake message. Once the
+  // message header has been seen, the length is validated and a single
+  // buffer of exactly that size is allocated up front; fragments are
+  // copied into it as they arrive instead of accumulating an IOBuf chain
+  // that gets rescanned on every record.
+  Buf handshakeBuffer_;
+  size_t handshakeBufferTarget_{0};
+  bool batchAppDataReads_{false};
+  folly::Optional<TLSMessage> bufferedMessage_;
 };
 
 class WriteRecordLayer {
@@ -62,6 +234,44 @@ class WriteRecordLayer {
 
   virtual TLSContent write(TLSMessage&& msg) const = 0;
 
+  /**
+   * Pull-based generator over the encrypted records of a single message.
+   * Each next() call encrypts at most maxBytes of plaintext into records,
+   * so a large write can be encrypted, written to the transport and
+   * released chunk by chunk instead of materializing the entire ciphertext
+   * up front. The record layer must outlive the stream.
+   */
+  class WriteStream {
+   public:
+    folly::Optional<TLSContent> next(size_t maxBytes) {
+      DCHECK_GT(maxBytes, 0);
+      if (queue_.empty()) {
+        return folly::none;
+      }
+      return recordLayer_.write(
+          TLSMessage{contentType_, queue_.splitAtMost(maxBytes)});
+    }
+
+    bool done() const {
+      return queue_.empty();
+    }
+
+   private:
+    friend class WriteRecordLayer;
+    WriteStream(const WriteRecordLayer& recordLayer, TLSMessage msg)
+        : recordLayer_(recordLayer), contentType_(msg.type) {
+      queue_.append(std::move(msg.fragment));
+    }
+
+    const WriteRecordLayer& recordLayer_;
+    ContentType contentType_;
+    folly::IOBufQueue queue_{folly::IOBufQueue::cacheChainLength()};
+  };
+
+  WriteStream createWriteStream(TLSMessage&& msg) const {
+    return WriteStream(*this, std::move(msg));
+  }
+
   TLSContent writeAlert(Alert&& alert) const {
     return write(TLSMessage{ContentType::alert, encode(std::move(alert))});
   }
@@ -78,12 +288,34 @@ class WriteRecordLayer {
   }
 
   void setProtocolVersion(ProtocolVersion version) const {
+#ifndef FIZZ_FINAL_TLS13_ONLY
     auto realVersion = getRealDraftVersion(version);
     if (realVersion == ProtocolVersion::tls_1_3_23) {
       useAdditionalData_ = false;
     } else {
       useAdditionalData_ = true;
     }
+#else
+    getRealDraftVersion(version);
+#endif
+  }
+
+  /**
+   * Replaces the traffic key on the existing aead and resets the sequence
+   * number, reusing the record layer and its cipher contexts. Only
+   * supported on encrypted record layers.
+   */
+  virtual void rekey(TrafficKeyDeriver /* deriver */) {
+    throw std::runtime_error("rekey unsupported");
+  }
+
+  /**
+   * Whether the amount of traffic written under the current key has reached
+   * a configured limit and the key should be rotated. Checked by the state
+   * machines to initiate a KeyUpdate autonomously.
+   */
+  virtual bool rekeyRecommended() const {
+    return false;
   }
 
   /**
@@ -92,8 +324,23 @@ class WriteRecordLayer {
    */
   virtual EncryptionLevel getEncryptionLevel() const = 0;
 
+  /**
+   * Attaches a stats block updated inline as records are written. Not
+   * owned; may be null. Only encrypted record layers update it.
+   */
+  void setStats(RecordLayerStats* stats) {
+    stats_ = stats;
+  }
+
  protected:
+#ifndef FIZZ_FINAL_TLS13_ONLY
   mutable bool useAdditionalData_{true};
+#else
+  // Draft support compiled out: final-RFC records always authenticate
+  // the record header, so the per-record branch folds away.
+  static constexpr bool useAdditionalData_ = true;
+#endif
+  RecordLayerStats* stats_{nullptr};
 
  private:
   template <typename... Args>
@@ -105,3 +352,5 @@ class WriteRecordLayer {
   static void addMessage(Buf& /*buf*/) {}
 };
 } // namespace fizz
+
+#include <fizz/record/RecordLayer-inl.h>
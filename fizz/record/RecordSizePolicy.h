@@ -0,0 +1,91 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+
+namespace fizz {
+
+/**
+ * Policy controlling the plaintext record size used by a write record layer.
+ * Implementations may adapt the size based on how the connection has been
+ * writing.
+ */
+class RecordSizePolicy {
+ public:
+  virtual ~RecordSizePolicy() = default;
+
+  /**
+   * Returns the maximum plaintext record size to use for the next record.
+   */
+  virtual uint16_t getMaxRecordSize() = 0;
+
+  /**
+   * Called after each record is written with its plaintext size.
+   */
+  virtual void reportRecordWritten(size_t size) = 0;
+};
+
+/**
+ * Record sizing scheme that starts with small records (lower latency and
+ * less head of line blocking on loss while a connection ramps up) and
+ * doubles the record size as the connection keeps streaming, up to the
+ * maximum. Resets back to small records after an idle period.
+ */
+class AdaptiveRecordSizePolicy : public RecordSizePolicy {
+ public:
+  using ClockFunc = std::function<std::chrono::steady_clock::time_point()>;
+
+  AdaptiveRecordSizePolicy(
+      uint16_t minSize,
+      uint16_t maxSize,
+      std::chrono::milliseconds idleTimeout = std::chrono::milliseconds(500),
+      ClockFunc clock = std::chrono::steady_clock::now)
+      : minSize_(minSize),
+        maxSize_(maxSize),
+        idleTimeout_(idleTimeout),
+        clock_(std::move(clock)),
+        currentSize_(minSize),
+        lastWriteTime_(clock_()) {}
+
+  uint16_t getMaxRecordSize() override {
+    if (clock_() - lastWriteTime_ > idleTimeout_) {
+      currentSize_ = minSize_;
+      bytesAtCurrentSize_ = 0;
+    }
+    return currentSize_;
+  }
+
+  void reportRecordWritten(size_t size) override {
+    lastWriteTime_ = clock_();
+    bytesAtCurrentSize_ += size;
+    if (currentSize_ < maxSize_ &&
+        bytesAtCurrentSize_ >= kGrowthThreshold * currentSize_) {
+      currentSize_ = std::min<uint32_t>(maxSize_, currentSize_ * 2);
+      bytesAtCurrentSize_ = 0;
+    }
+  }
+
+ private:
+  // Number of records worth of data at the current size we write before
+  // doubling it.
+  static constexpr size_t kGrowthThreshold = 16;
+
+  uint16_t minSize_;
+  uint16_t maxSize_;
+  std::chrono::milliseconds idleTimeout_;
+  ClockFunc clock_;
+
+  uint16_t currentSize_;
+  size_t bytesAtCurrentSize_{0};
+  std::chrono::steady_clock::time_point lastWriteTime_;
+};
+} // namespace fizz
@@ -0,0 +1,66 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/record/TransparentRecordLayer.h>
+
+namespace fizz {
+
+namespace {
+folly::Optional<TLSMessage> readRaw(folly::IOBufQueue& buf) {
+  if (buf.empty()) {
+    return folly::none;
+  }
+  TLSMessage msg;
+  msg.type = ContentType::handshake;
+  msg.fragment = buf.move();
+  return msg;
+}
+
+TLSContent writeRaw(TLSMessage&& msg, EncryptionLevel encryptionLevel) {
+  TLSContent content;
+  content.contentType = msg.type;
+  content.encryptionLevel = encryptionLevel;
+  content.data = std::move(msg.fragment);
+  return content;
+}
+} // namespace
+
+ReadResult<TLSMessage> TransparentPlaintextReadRecordLayer::read(
+    folly::IOBufQueue& buf) {
+  return readRaw(buf);
+}
+
+TLSContent TransparentPlaintextWriteRecordLayer::write(
+    TLSMessage&& msg) const {
+  return writeRaw(std::move(msg), EncryptionLevel::Plaintext);
+}
+
+TLSContent TransparentPlaintextWriteRecordLayer::writeInitialClientHello(
+    Buf encodedClientHello) const {
+  return writeRaw(
+      TLSMessage{ContentType::handshake, std::move(encodedClientHello)},
+      EncryptionLevel::Plaintext);
+}
+
+TransparentEncryptedReadRecordLayer::TransparentEncryptedReadRecordLayer(
+    EncryptionLevel encryptionLevel)
+    : EncryptedReadRecordLayer(encryptionLevel) {}
+
+ReadResult<TLSMessage> TransparentEncryptedReadRecordLayer::read(
+    folly::IOBufQueue& buf) {
+  return readRaw(buf);
+}
+
+TransparentEncryptedWriteRecordLayer::TransparentEncryptedWriteRecordLayer(
+    EncryptionLevel encryptionLevel)
+    : EncryptedWriteRecordLayer(encryptionLevel) {}
+
+TLSContent TransparentEncryptedWriteRecordLayer::write(TLSMessage&& msg) const {
+  return writeRaw(std::move(msg), getEncryptionLevel());
+}
+} // namespace fizz
@@ -0,0 +1,89 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/record/EncryptedRecordLayer.h>
+#include <fizz/record/PlaintextRecordLayer.h>
+
+namespace fizz {
+
+/**
+ * Record layers that pass handshake messages through without TLS record
+ * framing or encryption, for transports that reuse fizz's handshake
+ * machinery but protect packets themselves (for example QUIC-like datagram
+ * protocols). Install TransparentRecordFactory on the client or server
+ * context, feed raw peer flights into the connection's read path, collect
+ * flight buffers from the write path, and take traffic keys from the
+ * epoch-tagged SecretAvailable actions rather than the record layers.
+ *
+ * The read layers treat everything they are fed as handshake data, so this
+ * mode carries handshake traffic only; application data protection and any
+ * demultiplexing by encryption level are the caller's responsibility. The
+ * caller must feed flights at the encryption level the state machine
+ * currently expects.
+ */
+class TransparentPlaintextReadRecordLayer : public PlaintextReadRecordLayer {
+ public:
+  ReadResult<TLSMessage> read(folly::IOBufQueue& buf) override;
+};
+
+class TransparentPlaintextWriteRecordLayer : public PlaintextWriteRecordLayer {
+ public:
+  TLSContent write(TLSMessage&& msg) const override;
+
+  TLSContent writeInitialClientHello(Buf encodedClientHello) const override;
+};
+
+class TransparentEncryptedReadRecordLayer : public EncryptedReadRecordLayer {
+ public:
+  explicit TransparentEncryptedReadRecordLayer(
+      EncryptionLevel encryptionLevel);
+
+  ReadResult<TLSMessage> read(folly::IOBufQueue& buf) override;
+};
+
+class TransparentEncryptedWriteRecordLayer : public EncryptedWriteRecordLayer {
+ public:
+  explicit TransparentEncryptedWriteRecordLayer(
+      EncryptionLevel encryptionLevel);
+
+  TLSContent write(TLSMessage&& msg) const override;
+};
+
+/**
+ * Factory wrapper substituting transparent record layers for the TLS ones.
+ * All other behavior is inherited from the base factory, typically
+ * OpenSSLFactory.
+ */
+template <typename BaseFactory>
+class TransparentRecordFactory : public BaseFactory {
+ public:
+  std::unique_ptr<PlaintextReadRecordLayer> makePlaintextReadRecordLayer()
+      const override {
+    return std::make_unique<TransparentPlaintextReadRecordLayer>();
+  }
+
+  std::unique_ptr<PlaintextWriteRecordLayer> makePlaintextWriteRecordLayer()
+      const override {
+    return std::make_unique<TransparentPlaintextWriteRecordLayer>();
+  }
+
+  std::unique_ptr<EncryptedReadRecordLayer> makeEncryptedReadRecordLayer(
+      EncryptionLevel encryptionLevel) const override {
+    return std::make_unique<TransparentEncryptedReadRecordLayer>(
+        encryptionLevel);
+  }
+
+  std::unique_ptr<EncryptedWriteRecordLayer> makeEncryptedWriteRecordLayer(
+      EncryptionLevel encryptionLevel) const override {
+    return std::make_unique<TransparentEncryptedWriteRecordLayer>(
+        encryptionLevel);
+  }
+};
+} // namespace fizz
@@ -10,6 +10,8 @@
 #include <folly/String.h>
 #include <folly/io/Cursor.h>
 
+#include <array>
+
 namespace fizz {
 namespace detail {
 
@@ -31,12 +33,12 @@ struct Sizer {
 
 template <class N>
 size_t getBufSize(const Buf& buf) {
-  return sizeof(N) + buf->computeChainDataLength();
+  return sizeof(N) + (buf ? buf->computeChainDataLength() : 0);
 }
 
 template <>
 inline size_t getBufSize<bits24>(const Buf& buf) {
-  return bits24::size + buf->computeChainDataLength();
+  return bits24::size + (buf ? buf->computeChainDataLength() : 0);
 }
 
 template <class T>
@@ -44,6 +46,22 @@ size_t getSize(const T& t) {
   return Sizer<T>().template getSize<T>(t);
 }
 
+template <class N>
+struct LengthFieldSize : std::integral_constant<size_t, sizeof(N)> {};
+
+template <>
+struct LengthFieldSize<bits24> : std::integral_constant<size_t, bits24::size> {
+};
+
+template <class N, class T>
+size_t getVectorSize(const std::vector<T>& data) {
+  size_t len = LengthFieldSize<N>::value;
+  for (const auto& t : data) {
+    len += getSize<T>(t);
+  }
+  return len;
+}
+
 template <>
 struct Sizer<Extension> {
   template <class T>
@@ -216,17 +234,60 @@ inline uint32_t readBits24(folly::io::Cursor& cursor) {
   return length;
 }
 
+// Small decode buffers are copied into a single combined allocation rather
+// than cloned: a clone pins the entire record buffer for the lifetime of the
+// decoded message and needs one IOBuf shell per chain element it spans.
+constexpr size_t kCloneThreshold = 256;
+
+/**
+ * While in scope on this thread, decoded buffers alias the input buffer
+ * (sharing the underlying data) instead of copying fields out of it. Only
+ * for decodes where the message retains its full original encoding anyway,
+ * so that aliasing cannot extend the input buffer's lifetime.
+ */
+class AliasingDecodeScope {
+ public:
+  AliasingDecodeScope() {
+    depth()++;
+  }
+  ~AliasingDecodeScope() {
+    depth()--;
+  }
+  AliasingDecodeScope(const AliasingDecodeScope&) = delete;
+  AliasingDecodeScope& operator=(const AliasingDecodeScope&) = delete;
+
+  static bool active() {
+    return depth() > 0;
+  }
+
+ private:
+  static int& depth() {
+    static thread_local int decodeDepth = 0;
+    return decodeDepth;
+  }
+};
+
+inline void readDataInto(Buf& buf, size_t len, folly::io::Cursor& cursor) {
+  if (len <= kCloneThreshold && !AliasingDecodeScope::active()) {
+    buf = folly::IOBuf::create(len);
+    cursor.pull(buf->writableTail(), len);
+    buf->append(len);
+  } else {
+    cursor.clone(buf, len);
+  }
+}
+
 template <class N>
 size_t readBuf(Buf& buf, folly::io::Cursor& cursor) {
   auto len = cursor.readBE<N>();
-  cursor.clone(buf, len);
+  readDataInto(buf, len, cursor);
   return sizeof(N) + len;
 }
 
 template <>
 inline size_t readBuf<bits24>(Buf& buf, folly::io::Cursor& cursor) {
   auto len = readBits24(cursor);
-  cursor.clone(buf, len);
+  readDataInto(buf, len, cursor);
   return bits24::size + len;
 }
 
@@ -259,6 +320,21 @@ size_t read(T& out, folly::io::Cursor& cursor) {
   return Reader<T>().template read<T>(out, cursor);
 }
 
+// Smallest encoding of a vector element, used to size the output vector in
+// one reservation before decoding. A conservative hint is fine; the vector
+// grows normally if elements are larger than the minimum.
+template <class T>
+struct MinimumReadSize : std::integral_constant<size_t, sizeof(T)> {};
+
+template <>
+struct MinimumReadSize<Extension>
+    : std::integral_constant<size_t, sizeof(ExtensionType) + sizeof(uint16_t)> {
+};
+
+template <>
+struct MinimumReadSize<CertificateEntry>
+    : std::integral_constant<size_t, bits24::size + sizeof(uint16_t)> {};
+
 template <class N, class T>
 struct ReadVector {
   size_t readVector(std::vector<T>& out, folly::io::Cursor& cursor) {
@@ -266,6 +342,7 @@ struct ReadVector {
     if (cursor.totalLength() < len) {
       throw std::out_of_range("Not enough data");
     }
+    out.reserve(out.size() + len / MinimumReadSize<T>::value);
 
     size_t consumed = 0;
     while (consumed < len) {
@@ -286,6 +363,7 @@ struct ReadVector<bits24, T> {
     if (cursor.totalLength() < len) {
       throw std::out_of_range("Not enough data");
     }
+    out.reserve(out.size() + len / MinimumReadSize<T>::value);
 
     size_t consumed = 0;
     while (consumed < len) {
@@ -333,12 +411,27 @@ struct Reader<CertificateEntry> {
     return len;
   }
 };
+
+constexpr size_t kHandshakeHeaderSize = sizeof(HandshakeType) + bits24::size;
+
+// Allocates a buffer of the exact encoded size, with headroom for the
+// handshake header so that encodeHandshake() can prepend it in place.
+inline Buf allocateEncodeBuf(size_t len) {
+  auto buf = folly::IOBuf::create(kHandshakeHeaderSize + len);
+  buf->advance(kHandshakeHeaderSize);
+  return buf;
+}
 } // namespace detail
 
 template <>
 inline Buf encode<ServerHello>(ServerHello&& shlo) {
-  auto buf = folly::IOBuf::create(
-      sizeof(ProtocolVersion) + sizeof(Random) + sizeof(CipherSuite) + 20);
+  size_t len = sizeof(ProtocolVersion) + sizeof(Random) + sizeof(CipherSuite) +
+      detail::getVectorSize<uint16_t>(shlo.extensions);
+  if (shlo.legacy_session_id_echo) {
+    len += detail::getBufSize<uint8_t>(shlo.legacy_session_id_echo) +
+        sizeof(uint8_t);
+  }
+  auto buf = detail::allocateEncodeBuf(len);
   folly::io::Appender appender(buf.get(), 20);
   detail::write(shlo.legacy_version, appender);
   detail::write(shlo.random, appender);
@@ -355,8 +448,11 @@ inline Buf encode<ServerHello>(ServerHello&& shlo) {
 
 template <>
 inline Buf encode<HelloRetryRequest>(HelloRetryRequest&& shlo) {
-  auto buf = folly::IOBuf::create(
-      sizeof(ProtocolVersion) + sizeof(Random) + sizeof(CipherSuite) + 20);
+  auto buf = detail::allocateEncodeBuf(
+      sizeof(ProtocolVersion) + sizeof(Random) +
+      detail::getBufSize<uint8_t>(shlo.legacy_session_id_echo) +
+      sizeof(CipherSuite) + sizeof(uint8_t) +
+      detail::getVectorSize<uint16_t>(shlo.extensions));
   folly::io::Appender appender(buf.get(), 20);
   detail::write(shlo.legacy_version, appender);
   detail::write(HelloRetryRequest::HrrRandom, appender);
@@ -374,7 +470,8 @@ inline Buf encode<EndOfEarlyData>(EndOfEarlyData&&) {
 
 template <>
 inline Buf encode<EncryptedExtensions>(EncryptedExtensions&& extensions) {
-  auto buf = folly::IOBuf::create(20);
+  auto buf = detail::allocateEncodeBuf(
+      detail::getVectorSize<uint16_t>(extensions.extensions));
   folly::io::Appender appender(buf.get(), 20);
   detail::writeVector<uint16_t>(extensions.extensions, appender);
   return buf;
@@ -382,7 +479,9 @@ inline Buf encode<EncryptedExtensions>(EncryptedExtensions&& extensions) {
 
 template <>
 inline Buf encode<CertificateRequest>(CertificateRequest&& cr) {
-  auto buf = folly::IOBuf::create(20);
+  auto buf = detail::allocateEncodeBuf(
+      detail::getBufSize<uint8_t>(cr.certificate_request_context) +
+      detail::getVectorSize<uint16_t>(cr.extensions));
   folly::io::Appender appender(buf.get(), 20);
   detail::writeBuf<uint8_t>(cr.certificate_request_context, appender);
   detail::writeVector<uint16_t>(cr.extensions, appender);
@@ -391,7 +490,9 @@ inline Buf encode<CertificateRequest>(CertificateRequest&& cr) {
 
 template <>
 inline Buf encode<const CertificateMsg&>(const CertificateMsg& cert) {
-  auto buf = folly::IOBuf::create(20);
+  auto buf = detail::allocateEncodeBuf(
+      detail::getBufSize<uint8_t>(cert.certificate_request_context) +
+      detail::getVectorSize<detail::bits24>(cert.certificate_list));
   folly::io::Appender appender(buf.get(), 20);
   detail::writeBuf<uint8_t>(cert.certificate_request_context, appender);
   detail::writeVector<detail::bits24>(cert.certificate_list, appender);
@@ -410,7 +511,9 @@ inline Buf encode<CertificateMsg>(CertificateMsg&& cert) {
 
 template <>
 inline Buf encode<CompressedCertificate&>(CompressedCertificate& cc) {
-  auto buf = folly::IOBuf::create(20);
+  auto buf = detail::allocateEncodeBuf(
+      sizeof(CertificateCompressionAlgorithm) + detail::bits24::size +
+      detail::getBufSize<detail::bits24>(cc.compressed_certificate_message));
   folly::io::Appender appender(buf.get(), 20);
   detail::write(cc.algorithm, appender);
   detail::writeBits24(cc.uncompressed_length, appender);
@@ -425,7 +528,9 @@ inline Buf encode<CompressedCertificate>(CompressedCertificate&& cc) {
 
 template <>
 inline Buf encode<CertificateVerify>(CertificateVerify&& certVerify) {
-  auto buf = folly::IOBuf::create(20);
+  auto buf = detail::allocateEncodeBuf(
+      sizeof(SignatureScheme) +
+      detail::getBufSize<uint16_t>(certVerify.signature));
   folly::io::Appender appender(buf.get(), 20);
   detail::write(certVerify.algorithm, appender);
   detail::writeBuf<uint16_t>(certVerify.signature, appender);
@@ -434,6 +539,22 @@ inline Buf encode<CertificateVerify>(CertificateVerify&& certVerify) {
 
 template <>
 inline Buf encode<Alert>(Alert&& alert) {
+  // There are only a handful of distinct 2-byte alert payloads, and alerts
+  // (close_notify in particular) are sent on every connection close. Hand out
+  // views of a static table instead of allocating per alert; the record
+  // layers treat externally owned buffers as shared and never write into
+  // them.
+  static const auto fatalAlerts = []() {
+    std::array<std::array<uint8_t, 2>, 256> table{};
+    for (size_t i = 0; i < table.size(); i++) {
+      table[i] = {{0x02, static_cast<uint8_t>(i)}};
+    }
+    return table;
+  }();
+  if (alert.level == 0x02) {
+    const auto& payload = fatalAlerts[static_cast<uint8_t>(alert.description)];
+    return folly::IOBuf::wrapBuffer(payload.data(), payload.size());
+  }
   auto buf = folly::IOBuf::create(2);
   folly::io::Appender appender(buf.get(), 2);
   detail::write(alert.level, appender);
@@ -443,9 +564,12 @@ inline Buf encode<Alert>(Alert&& alert) {
 
 template <>
 inline Buf encode<const ClientHello&>(const ClientHello& chlo) {
-  auto buf = folly::IOBuf::create(
-      sizeof(ProtocolVersion) + sizeof(Random) + sizeof(uint8_t) +
-      sizeof(CipherSuite) * chlo.cipher_suites.size() + sizeof(uint8_t) + 20);
+  auto buf = detail::allocateEncodeBuf(
+      sizeof(ProtocolVersion) + sizeof(Random) +
+      detail::getBufSize<uint8_t>(chlo.legacy_session_id) +
+      detail::getVectorSize<uint16_t>(chlo.cipher_suites) +
+      detail::getVectorSize<uint8_t>(chlo.legacy_compression_methods) +
+      detail::getVectorSize<uint16_t>(chlo.extensions));
   folly::io::Appender appender(buf.get(), 20);
   detail::write(chlo.legacy_version, appender);
   detail::write(chlo.random, appender);
@@ -473,7 +597,13 @@ inline Buf encode<Finished>(Finished&& fin) {
 
 template <>
 inline Buf encode<NewSessionTicket>(NewSessionTicket&& nst) {
-  auto buf = folly::IOBuf::create(20);
+  size_t len = sizeof(nst.ticket_lifetime) + sizeof(nst.ticket_age_add) +
+      detail::getBufSize<uint16_t>(nst.ticket) +
+      detail::getVectorSize<uint16_t>(nst.extensions);
+  if (nst.ticket_nonce) {
+    len += detail::getBufSize<uint8_t>(nst.ticket_nonce);
+  }
+  auto buf = detail::allocateEncodeBuf(len);
   folly::io::Appender appender(buf.get(), 20);
   detail::write(nst.ticket_lifetime, appender);
   detail::write(nst.ticket_age_add, appender);
@@ -490,7 +620,9 @@ inline Buf encodeHkdfLabel(
     const std::string& hkdfLabelPrefix) {
   auto labelBuf = folly::IOBuf::copyBuffer(
       folly::to<std::string>(hkdfLabelPrefix, label.label));
-  auto buf = folly::IOBuf::create(sizeof(label.length) + label.label.size());
+  auto buf = folly::IOBuf::create(
+      sizeof(label.length) + detail::getBufSize<uint8_t>(labelBuf) +
+      detail::getBufSize<uint8_t>(label.hash_value));
   folly::io::Appender appender(buf.get(), 20);
   detail::write(label.length, appender);
   detail::writeBuf<uint8_t>(labelBuf, appender);
@@ -514,11 +646,25 @@ inline Buf encode<message_hash>(message_hash&& hash) {
 template <class T>
 Buf encodeHandshake(T&& handshakeMsg) {
   auto body = encode(std::forward<T>(handshakeMsg));
-  auto buf = folly::IOBuf::create(sizeof(HandshakeType) + detail::bits24::size);
-  folly::io::Appender appender(buf.get(), 0);
   constexpr auto handshakeType = std::remove_reference<T>::type::handshake_type;
+  size_t length = body->computeChainDataLength();
+  detail::checkWithin24bits<size_t>(length);
+  if (!body->isChained() && !body->isShared() &&
+      body->headroom() >= detail::kHandshakeHeaderSize) {
+    // Message encoders leave header headroom, putting the handshake header
+    // in the same allocation as the body.
+    body->prepend(detail::kHandshakeHeaderSize);
+    uint8_t* header = body->writableData();
+    header[0] = static_cast<uint8_t>(handshakeType);
+    header[1] = static_cast<uint8_t>(length >> 16);
+    header[2] = static_cast<uint8_t>(length >> 8);
+    header[3] = static_cast<uint8_t>(length);
+    return body;
+  }
+  auto buf = folly::IOBuf::create(detail::kHandshakeHeaderSize);
+  folly::io::Appender appender(buf.get(), 0);
   detail::write(handshakeType, appender);
-  detail::writeBits24(body->computeChainDataLength(), appender);
+  detail::writeBits24(length, appender);
   buf->prependChain(std::move(body));
   return buf;
 }
@@ -13,6 +13,7 @@ namespace fizz {
 
 constexpr Random HelloRetryRequest::HrrRandom;
 
+#ifndef FIZZ_FINAL_TLS13_ONLY
 ProtocolVersion getRealDraftVersion(ProtocolVersion version) {
   switch (version) {
     case ProtocolVersion::tls_1_3:
@@ -30,6 +31,7 @@ ProtocolVersion getRealDraftVersion(ProtocolVersion version) {
           "getRealDraftVersion() called with ", toString(version)));
   }
 }
+#endif
 
 std::string toString(ProtocolVersion version) {
   switch (version) {
@@ -59,6 +61,8 @@ std::string toString(ExtensionType extType) {
   switch (extType) {
     case ExtensionType::server_name:
       return "server_name";
+    case ExtensionType::status_request:
+      return "status_request";
     case ExtensionType::supported_groups:
       return "supported_groups";
     case ExtensionType::signature_algorithms:
@@ -89,6 +93,8 @@ std::string toString(ExtensionType extType) {
       return "key_share";
     case ExtensionType::compress_certificate:
       return "compress_certificate";
+    case ExtensionType::delegated_credential:
+      return "delegated_credential";
   }
   return enumToHex(extType);
 }
@@ -33,7 +33,21 @@ enum class ProtocolVersion : uint16_t {
   tls_1_3_28 = 0x7f1c,
 };
 
+#ifndef FIZZ_FINAL_TLS13_ONLY
 ProtocolVersion getRealDraftVersion(ProtocolVersion);
+#else
+/**
+ * Built with FIZZ_FINAL_TLS13_ONLY: draft-version translation is
+ * compiled out and the only recognized TLS 1.3 wire version is the
+ * final RFC one.
+ */
+inline ProtocolVersion getRealDraftVersion(ProtocolVersion version) {
+  if (version != ProtocolVersion::tls_1_3) {
+    throw std::runtime_error("draft TLS 1.3 support compiled out");
+  }
+  return version;
+}
+#endif
 
 std::string toString(ProtocolVersion);
 
@@ -88,11 +102,13 @@ struct HandshakeStruct : EventType<e> {
 
 enum class ExtensionType : uint16_t {
   server_name = 0,
+  status_request = 5,
   supported_groups = 10,
   signature_algorithms = 13,
   application_layer_protocol_negotiation = 16,
   token_binding = 24,
   compress_certificate = 27,
+  delegated_credential = 34,
   pre_shared_key = 41,
   early_data = 42,
   supported_versions = 43,
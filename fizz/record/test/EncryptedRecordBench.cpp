@@ -85,7 +85,7 @@ void decryptGCM(uint32_t n, size_t size) {
 
   folly::Optional<TLSMessage> msg;
   for (auto& buf : contents) {
-    msg = read.read(buf);
+    msg = read.read(buf).value();
   }
   folly::doNotOptimizeAway(msg);
 }
@@ -30,6 +30,7 @@ class EncryptedRecordTest : public testing::Test {
     read_.setAead(folly::ByteRange(), std::move(readAead));
     auto writeAead = std::make_unique<MockAead>();
     writeAead_ = writeAead.get();
+    EXPECT_CALL(*writeAead_, setEncryptedBufferHeadroom(_));
     write_.setAead(folly::ByteRange(), std::move(writeAead));
   }
 
@@ -60,7 +61,7 @@ class EncryptedRecordTest : public testing::Test {
 };
 
 TEST_F(EncryptedRecordTest, TestReadEmpty) {
-  EXPECT_FALSE(read_.read(queue_).hasValue());
+  EXPECT_FALSE(read_.read(queue_)->hasValue());
 }
 
 TEST_F(EncryptedRecordTest, TestReadHandshake) {
@@ -70,12 +71,66 @@ TEST_F(EncryptedRecordTest, TestReadHandshake) {
         expectSame(buf, "0123456789");
         return getBuf("abcdef16");
       }));
-  auto msg = read_.read(queue_);
+  auto msg = read_.read(queue_).value();
   EXPECT_EQ(msg->type, ContentType::handshake);
   expectSame(msg->fragment, "abcdef");
   EXPECT_TRUE(queue_.empty());
 }
 
+TEST_F(EncryptedRecordTest, TestReadCiphertextRecord) {
+  addToQueue("17030100050123456789");
+  auto record = read_.readCiphertextRecord(queue_).value();
+  ASSERT_TRUE(record.hasValue());
+  expectSame(record->ciphertext->clone(), "0123456789");
+  EXPECT_EQ(record->seqNum, 0);
+  EXPECT_EQ(hexlify(std::string(
+                record->header.begin(), record->header.end())),
+            "1703010005");
+  EXPECT_TRUE(queue_.empty());
+
+  // Incomplete next record: no data yet, but the sequence advanced.
+  addToQueue("1703010005");
+  EXPECT_FALSE(read_.readCiphertextRecord(queue_)->hasValue());
+  addToQueue("0123456789");
+  auto next = read_.readCiphertextRecord(queue_).value();
+  ASSERT_TRUE(next.hasValue());
+  EXPECT_EQ(next->seqNum, 1);
+}
+
+TEST_F(EncryptedRecordTest, TestDecryptAndParse) {
+  addToQueue("17030100050123456789");
+  auto record = read_.readCiphertextRecord(queue_).value();
+  ASSERT_TRUE(record.hasValue());
+  EXPECT_CALL(*readAead_, _decrypt(_, _, 0))
+      .WillOnce(Invoke([](std::unique_ptr<IOBuf>& buf, const IOBuf*, uint64_t) {
+        expectSame(buf, "0123456789");
+        return getBuf("abcdef16");
+      }));
+  auto msg = read_.decryptAndParse(*readAead_, std::move(*record)).value();
+  ASSERT_TRUE(msg.hasValue());
+  EXPECT_EQ(msg->type, ContentType::handshake);
+  expectSame(msg->fragment, "abcdef");
+}
+
+TEST_F(EncryptedRecordTest, TestDecryptAndParseFailure) {
+  addToQueue("17030100050123456789");
+  auto record = read_.readCiphertextRecord(queue_).value();
+  ASSERT_TRUE(record.hasValue());
+  EXPECT_CALL(*readAead_, _decrypt(_, _, 0))
+      .WillOnce(InvokeWithoutArgs([]() -> std::unique_ptr<IOBuf> {
+        throw std::runtime_error("bad record mac");
+      }));
+  auto result = read_.decryptAndParse(*readAead_, std::move(*record));
+  ASSERT_TRUE(result.hasError());
+  EXPECT_THAT(result.error().message, HasSubstr("decryption failed"));
+}
+
+TEST_F(EncryptedRecordTest, TestReadCiphertextRecordSkipArmed) {
+  read_.setSkipFailedDecryption(true);
+  addToQueue("17030100050123456789");
+  EXPECT_TRUE(read_.readCiphertextRecord(queue_).hasError());
+}
+
 TEST_F(EncryptedRecordTest, TestReadAlert) {
   addToQueue("17030100050123456789");
   EXPECT_CALL(*readAead_, _decrypt(_, _, 0))
@@ -83,7 +138,7 @@ TEST_F(EncryptedRecordTest, TestReadAlert) {
         expectSame(buf, "0123456789");
         return getBuf("020215");
       }));
-  auto msg = read_.read(queue_);
+  auto msg = read_.read(queue_).value();
   EXPECT_EQ(msg->type, ContentType::alert);
   expectSame(msg->fragment, "0202");
   EXPECT_TRUE(queue_.empty());
@@ -97,7 +152,39 @@ TEST_F(EncryptedRecordTest, TestReadAppData) {
         expectSame(buf, "0123456789");
         return getBuf("1234abcd17");
       }));
-  auto msg = read_.read(queue_);
+  auto msg = read_.read(queue_).value();
+  EXPECT_EQ(msg->type, ContentType::application_data);
+  expectSame(msg->fragment, "1234abcd");
+  EXPECT_TRUE(queue_.empty());
+}
+
+TEST_F(EncryptedRecordTest, TestReadEventAppData) {
+  // readEvent() on the concrete layer takes the devirtualized record loop.
+  addToQueue("17030100050123456789");
+  EXPECT_CALL(*readAead_, _decrypt(_, _, 0))
+      .WillOnce(Invoke([](std::unique_ptr<IOBuf>& buf, const IOBuf*, uint64_t) {
+        expectSame(buf, "0123456789");
+        return getBuf("1234abcd17");
+      }));
+  auto param = read_.readEvent(queue_).value();
+  auto& appData = boost::get<AppData>(*param);
+  expectSame(appData.data, "1234abcd");
+  EXPECT_TRUE(queue_.empty());
+}
+
+TEST_F(EncryptedRecordTest, TestReadFragmentedRecordNoCoalesce) {
+  // Record split across several reads: the chain should be handed to the
+  // aead as-is, without flattening it first.
+  addToQueue("170301");
+  addToQueue("000501");
+  addToQueue("23456789");
+  EXPECT_CALL(*readAead_, _decrypt(_, _, 0))
+      .WillOnce(Invoke([](std::unique_ptr<IOBuf>& buf, const IOBuf*, uint64_t) {
+        EXPECT_TRUE(buf->isChained());
+        expectSame(buf, "0123456789");
+        return getBuf("1234abcd17");
+      }));
+  auto msg = read_.read(queue_).value();
   EXPECT_EQ(msg->type, ContentType::application_data);
   expectSame(msg->fragment, "1234abcd");
   EXPECT_TRUE(queue_.empty());
@@ -110,30 +197,30 @@ TEST_F(EncryptedRecordTest, TestReadUnknown) {
         expectSame(buf, "0123456789");
         return getBuf("1234abcd20");
       }));
-  EXPECT_ANY_THROW(read_.read(queue_));
+  EXPECT_TRUE(read_.read(queue_).hasError());
 }
 
 TEST_F(EncryptedRecordTest, TestWaitForData) {
   addToQueue("1703010010012345");
-  EXPECT_FALSE(read_.read(queue_).hasValue());
+  EXPECT_FALSE(read_.read(queue_)->hasValue());
   EXPECT_EQ(queue_.chainLength(), 8);
 }
 
 TEST_F(EncryptedRecordTest, TestWaitForHeader) {
   addToQueue("16030102");
-  EXPECT_FALSE(read_.read(queue_).hasValue());
+  EXPECT_FALSE(read_.read(queue_)->hasValue());
   EXPECT_EQ(queue_.chainLength(), 4);
 }
 
 TEST_F(EncryptedRecordTest, TestMaxSize) {
   addToQueue("1603014100");
-  EXPECT_FALSE(read_.read(queue_).hasValue());
+  EXPECT_FALSE(read_.read(queue_)->hasValue());
   EXPECT_EQ(queue_.chainLength(), 5);
 }
 
 TEST_F(EncryptedRecordTest, TestOverSize) {
   addToQueue("1603015000");
-  EXPECT_ANY_THROW(read_.read(queue_));
+  EXPECT_TRUE(read_.read(queue_).hasError());
 }
 
 TEST_F(EncryptedRecordTest, TestDataRemaining) {
@@ -154,7 +241,7 @@ TEST_F(EncryptedRecordTest, TestPadding) {
         expectSame(buf, "0123456789");
         return getBuf("1234abcd17000000");
       }));
-  auto msg = read_.read(queue_);
+  auto msg = read_.read(queue_).value();
   EXPECT_EQ(msg->type, ContentType::application_data);
   expectSame(msg->fragment, "1234abcd");
   EXPECT_TRUE(queue_.empty());
@@ -167,7 +254,7 @@ TEST_F(EncryptedRecordTest, TestAllPaddingAppData) {
         expectSame(buf, "0123456789");
         return getBuf("17000000");
       }));
-  auto msg = read_.read(queue_);
+  auto msg = read_.read(queue_).value();
   EXPECT_EQ(msg->type, ContentType::application_data);
   EXPECT_TRUE(msg->fragment->empty());
   EXPECT_TRUE(queue_.empty());
@@ -180,7 +267,7 @@ TEST_F(EncryptedRecordTest, TestAllPaddingHandshake) {
         expectSame(buf, "0123456789");
         return getBuf("16000000");
       }));
-  EXPECT_NO_THROW(read_.read(queue_));
+  EXPECT_FALSE(read_.read(queue_).hasError());
 }
 
 TEST_F(EncryptedRecordTest, TestNoContentType) {
@@ -190,7 +277,7 @@ TEST_F(EncryptedRecordTest, TestNoContentType) {
         expectSame(buf, "0123456789");
         return getBuf("00000000");
       }));
-  EXPECT_ANY_THROW(read_.read(queue_));
+  EXPECT_TRUE(read_.read(queue_).hasError());
 }
 
 TEST_F(EncryptedRecordTest, TestReadSeqNum) {
@@ -214,7 +301,7 @@ TEST_F(EncryptedRecordTest, TestSkipAndWait) {
           Invoke([](std::unique_ptr<IOBuf>& /*buf*/, const IOBuf*, uint64_t) {
             return folly::none;
           }));
-  EXPECT_FALSE(read_.read(queue_).hasValue());
+  EXPECT_FALSE(read_.read(queue_)->hasValue());
   EXPECT_TRUE(queue_.empty());
 }
 
@@ -234,7 +321,7 @@ TEST_F(EncryptedRecordTest, TestSkipAndRead) {
         expectSame(buf, "0123456789");
         return getBuf("1234abcd17");
       }));
-  auto msg = read_.read(queue_);
+  auto msg = read_.read(queue_).value();
   EXPECT_EQ(msg->type, ContentType::application_data);
   expectSame(msg->fragment, "1234abcd");
   EXPECT_EQ(queue_.chainLength(), 10);
@@ -244,7 +331,7 @@ TEST_F(EncryptedRecordTest, TestSkipAndRead) {
         expectSame(buf, "01234567aa");
         return getBuf("1234abaa17");
       }));
-  msg = read_.read(queue_);
+  msg = read_.read(queue_).value();
   EXPECT_EQ(msg->type, ContentType::application_data);
   expectSame(msg->fragment, "1234abaa");
   EXPECT_TRUE(queue_.empty());
@@ -252,7 +339,7 @@ TEST_F(EncryptedRecordTest, TestSkipAndRead) {
 
 TEST_F(EncryptedRecordTest, TestWriteHandshake) {
   TLSMessage msg{ContentType::handshake, getBuf("1234567890")};
-  EXPECT_CALL(*writeAead_, _encrypt(_, _, 0))
+  EXPECT_CALL(*writeAead_, _inplaceEncrypt(_, _, 0))
       .WillOnce(Invoke([](std::unique_ptr<IOBuf>& buf, const IOBuf*, uint64_t) {
         expectSame(buf, "123456789016");
         return getBuf("abcd1234abcd");
@@ -263,7 +350,7 @@ TEST_F(EncryptedRecordTest, TestWriteHandshake) {
 
 TEST_F(EncryptedRecordTest, TestWriteAppData) {
   TLSMessage msg{ContentType::application_data, getBuf("1234567890")};
-  EXPECT_CALL(*writeAead_, _encrypt(_, _, 0))
+  EXPECT_CALL(*writeAead_, _inplaceEncrypt(_, _, 0))
       .WillOnce(Invoke([](std::unique_ptr<IOBuf>& buf, const IOBuf*, uint64_t) {
         expectSame(buf, "123456789017");
         return getBuf("abcd1234abcd");
@@ -274,7 +361,7 @@ TEST_F(EncryptedRecordTest, TestWriteAppData) {
 
 TEST_F(EncryptedRecordTest, TestWriteAppDataInPlace) {
   TLSMessage msg{ContentType::application_data, getBuf("1234567890", 5, 17)};
-  EXPECT_CALL(*writeAead_, _encrypt(_, _, 0))
+  EXPECT_CALL(*writeAead_, _inplaceEncrypt(_, _, 0))
       .WillOnce(Invoke([](std::unique_ptr<IOBuf>& buf, const IOBuf*, uint64_t) {
         // footer should have been written w/o chaining
         EXPECT_FALSE(buf->isChained());
@@ -287,19 +374,78 @@ TEST_F(EncryptedRecordTest, TestWriteAppDataInPlace) {
   expectSame(buf.data, "1703030006abcd1234abcd");
 }
 
+TEST_F(EncryptedRecordTest, TestWritePadded) {
+  write_.setPaddingPolicy(std::make_unique<PadToBlockPolicy>(8));
+  TLSMessage msg{ContentType::application_data, getBuf("1234567890")};
+  EXPECT_CALL(*writeAead_, _inplaceEncrypt(_, _, 0))
+      .WillOnce(Invoke([](std::unique_ptr<IOBuf>& buf, const IOBuf*, uint64_t) {
+        expectSame(buf, "1234567890170000");
+        return getBuf("abcd1234abcdabcd");
+      }));
+  auto buf = write_.write(std::move(msg));
+  expectSame(buf.data, "1703030008abcd1234abcdabcd");
+}
+
+TEST_F(EncryptedRecordTest, TestWritePaddedInPlace) {
+  write_.setPaddingPolicy(std::make_unique<PadToBlockPolicy>(8));
+  TLSMessage msg{ContentType::application_data, getBuf("1234567890", 5, 17)};
+  EXPECT_CALL(*writeAead_, _inplaceEncrypt(_, _, 0))
+      .WillOnce(Invoke([](std::unique_ptr<IOBuf>& buf, const IOBuf*, uint64_t) {
+        // padding should fit in the existing tailroom without chaining
+        EXPECT_FALSE(buf->isChained());
+        expectSame(buf, "1234567890170000");
+        return getBuf("abcd1234abcdabcd", 5, 0);
+      }));
+  auto buf = write_.write(std::move(msg));
+  expectSame(buf.data, "1703030008abcd1234abcdabcd");
+}
+
+TEST_F(EncryptedRecordTest, TestWriteTwoRecordsContiguous) {
+  // Two records worth of data with headroom/tailroom on each encrypt
+  // result: each record should come out as a single contiguous buffer.
+  TLSMessage msg{ContentType::application_data, IOBuf::create(0x4a00)};
+  msg.fragment->append(0x4a00);
+  memset(msg.fragment->writableData(), 0x1, msg.fragment->length());
+
+  EXPECT_CALL(*writeAead_, _inplaceEncrypt(_, _, _))
+      .Times(2)
+      .WillRepeatedly(
+          Invoke([](std::unique_ptr<IOBuf>& /*buf*/, const IOBuf*, uint64_t) {
+            return getBuf("aaaa", 5, 0);
+          }));
+  auto outBuf = write_.write(std::move(msg));
+  for (auto record : *outBuf.data) {
+    EXPECT_EQ(record.size(), 7);
+  }
+  EXPECT_EQ(outBuf.data->countChainElements(), 2);
+}
+
+TEST_F(EncryptedRecordTest, TestWriteSharedBuf) {
+  auto buf = getBuf("1234567890");
+  auto bufClone = buf->clone();
+  TLSMessage msg{ContentType::application_data, std::move(buf)};
+  EXPECT_CALL(*writeAead_, _encrypt(_, _, 0))
+      .WillOnce(Invoke([](std::unique_ptr<IOBuf>& buf, const IOBuf*, uint64_t) {
+        expectSame(buf, "123456789017");
+        return getBuf("abcd1234abcd");
+      }));
+  auto outBuf = write_.write(std::move(msg));
+  expectSame(outBuf.data, "1703030006abcd1234abcd");
+}
+
 TEST_F(EncryptedRecordTest, TestFragmentedWrite) {
   TLSMessage msg{ContentType::application_data, IOBuf::create(0x4a00)};
   msg.fragment->append(0x4a00);
   memset(msg.fragment->writableData(), 0x1, msg.fragment->length());
 
   Sequence s;
-  EXPECT_CALL(*writeAead_, _encrypt(_, _, 0))
+  EXPECT_CALL(*writeAead_, _inplaceEncrypt(_, _, 0))
       .InSequence(s)
       .WillOnce(
           Invoke([](std::unique_ptr<IOBuf>& /*buf*/, const IOBuf*, uint64_t) {
             return getBuf("aaaa");
           }));
-  EXPECT_CALL(*writeAead_, _encrypt(_, _, 1))
+  EXPECT_CALL(*writeAead_, _inplaceEncrypt(_, _, 1))
       .InSequence(s)
       .WillOnce(
           Invoke([](std::unique_ptr<IOBuf>& /*buf*/, const IOBuf*, uint64_t) {
@@ -316,7 +462,7 @@ TEST_F(EncryptedRecordTest, TestWriteSplittingWholeBuf) {
   msg.fragment->prependChain(IOBuf::copyBuffer("moredata"));
 
   Sequence s;
-  EXPECT_CALL(*writeAead_, _encrypt(_, _, _))
+  EXPECT_CALL(*writeAead_, _inplaceEncrypt(_, _, _))
       .Times(2)
       .WillRepeatedly(
           Invoke([](std::unique_ptr<IOBuf>& /*buf*/, const IOBuf*, uint64_t) {
@@ -332,7 +478,7 @@ TEST_F(EncryptedRecordTest, TestWriteSplittingCombineSmall) {
   msg.fragment->prependChain(IOBuf::copyBuffer("moredata"));
 
   Sequence s;
-  EXPECT_CALL(*writeAead_, _encrypt(_, _, _))
+  EXPECT_CALL(*writeAead_, _inplaceEncrypt(_, _, _))
       .Times(1)
       .WillRepeatedly(
           Invoke([](std::unique_ptr<IOBuf>& /*buf*/, const IOBuf*, uint64_t) {
@@ -341,10 +487,218 @@ TEST_F(EncryptedRecordTest, TestWriteSplittingCombineSmall) {
   write_.write(std::move(msg));
 }
 
+TEST_F(EncryptedRecordTest, TestWriteChainBoundaryAligned) {
+  // A chain of whole buffers below the max record size becomes one record
+  // without any of the buffers being split or cloned.
+  auto buf = IOBuf::create(1200);
+  buf->append(1200);
+  memset(buf->writableData(), 0x1, buf->length());
+  auto buf2 = IOBuf::create(1200);
+  buf2->append(1200);
+  memset(buf2->writableData(), 0x2, buf2->length());
+  buf->prependChain(std::move(buf2));
+  TLSMessage msg{ContentType::application_data, std::move(buf)};
+
+  EXPECT_CALL(*writeAead_, _inplaceEncrypt(_, _, 0))
+      .WillOnce(Invoke([](std::unique_ptr<IOBuf>& buf, const IOBuf*, uint64_t) {
+        EXPECT_EQ(buf->computeChainDataLength(), 2401);
+        EXPECT_FALSE(buf->isShared());
+        return getBuf("aaaa");
+      }));
+  write_.write(std::move(msg));
+}
+
+TEST_F(EncryptedRecordTest, TestStatsCounters) {
+  RecordLayerStats stats;
+  read_.setStats(&stats);
+  write_.setStats(&stats);
+
+  // 2 plaintext bytes followed by the content type and 2 bytes of padding.
+  addToQueue("17030100050123456789");
+  EXPECT_CALL(*readAead_, _decrypt(_, _, 0))
+      .WillOnce(Invoke([](std::unique_ptr<IOBuf>&, const IOBuf*, uint64_t) {
+        return getBuf("abcd170000");
+      }));
+  read_.read(queue_);
+  EXPECT_EQ(stats.recordsRead, 1);
+  EXPECT_EQ(stats.bytesRead, 2);
+  EXPECT_EQ(stats.paddingBytesRead, 2);
+
+  EXPECT_CALL(*writeAead_, _inplaceEncrypt(_, _, 0))
+      .WillOnce(Invoke([](std::unique_ptr<IOBuf>&, const IOBuf*, uint64_t) {
+        return getBuf("aaaa");
+      }));
+  write_.write(TLSMessage{ContentType::application_data, getBuf("1234abcd")});
+  EXPECT_EQ(stats.recordsWritten, 1);
+  EXPECT_EQ(stats.bytesWritten, 4);
+}
+
+TEST_F(EncryptedRecordTest, TestEventCallback) {
+  class Callback : public RecordEventCallback {
+   public:
+    void decryptFailure(uint64_t seqNum, bool skipped) noexcept override {
+      decryptFailures++;
+      lastSeqNum = seqNum;
+      lastSkipped = skipped;
+    }
+    void alertReceived(AlertDescription /*description*/) noexcept override {}
+    uint64_t decryptFailures{0};
+    uint64_t lastSeqNum{0};
+    bool lastSkipped{false};
+  };
+  Callback callback;
+  RecordLayerStats stats;
+  read_.setStats(&stats);
+  read_.setEventCallback(&callback);
+
+  read_.setSkipFailedDecryption(true);
+  addToQueue("17030100050123456789");
+  EXPECT_CALL(*readAead_, _tryDecrypt(_, _, 0))
+      .WillOnce(
+          Invoke([](std::unique_ptr<IOBuf>& /*buf*/, const IOBuf*, uint64_t) {
+            return folly::none;
+          }));
+  EXPECT_FALSE(read_.read(queue_)->hasValue());
+  EXPECT_EQ(callback.decryptFailures, 1);
+  EXPECT_EQ(callback.lastSeqNum, 0);
+  EXPECT_TRUE(callback.lastSkipped);
+  EXPECT_EQ(stats.decryptFailures, 1);
+
+  // A second failure within the rate limit interval updates the counter
+  // but does not fire the callback again.
+  addToQueue("17030100050123456789");
+  EXPECT_CALL(*readAead_, _tryDecrypt(_, _, 0))
+      .WillOnce(
+          Invoke([](std::unique_ptr<IOBuf>& /*buf*/, const IOBuf*, uint64_t) {
+            return folly::none;
+          }));
+  EXPECT_FALSE(read_.read(queue_)->hasValue());
+  EXPECT_EQ(callback.decryptFailures, 1);
+  EXPECT_EQ(stats.decryptFailures, 2);
+}
+
+TEST_F(EncryptedRecordTest, TestAlertCallback) {
+  class Callback : public RecordEventCallback {
+   public:
+    void decryptFailure(uint64_t, bool) noexcept override {}
+    void alertReceived(AlertDescription description) noexcept override {
+      alerts++;
+      lastAlert = description;
+    }
+    uint64_t alerts{0};
+    AlertDescription lastAlert;
+  };
+  Callback callback;
+  RecordLayerStats stats;
+  read_.setStats(&stats);
+  read_.setEventCallback(&callback);
+
+  addToQueue("17030100050123456789");
+  EXPECT_CALL(*readAead_, _decrypt(_, _, 0))
+      .WillOnce(Invoke([](std::unique_ptr<IOBuf>&, const IOBuf*, uint64_t) {
+        return getBuf("025015");
+      }));
+  auto msg = read_.read(queue_).value();
+  EXPECT_EQ(msg->type, ContentType::alert);
+  EXPECT_EQ(stats.alertsReceived, 1);
+  EXPECT_EQ(callback.alerts, 1);
+  EXPECT_EQ(callback.lastAlert, AlertDescription::internal_error);
+}
+
+TEST_F(EncryptedRecordTest, TestWriteBatch) {
+  TLSMessage msg{ContentType::application_data, IOBuf::create(0x4a00)};
+  msg.fragment->append(0x4a00);
+  memset(msg.fragment->writableData(), 0x1, msg.fragment->length());
+
+  Sequence s;
+  EXPECT_CALL(*writeAead_, _inplaceEncrypt(_, _, 0))
+      .InSequence(s)
+      .WillOnce(
+          Invoke([](std::unique_ptr<IOBuf>& /*buf*/, const IOBuf*, uint64_t) {
+            return getBuf("aaaa");
+          }));
+  EXPECT_CALL(*writeAead_, _inplaceEncrypt(_, _, 1))
+      .InSequence(s)
+      .WillOnce(
+          Invoke([](std::unique_ptr<IOBuf>& /*buf*/, const IOBuf*, uint64_t) {
+            return getBuf("bbbb");
+          }));
+  auto outBuf = write_.writeBatch(std::move(msg));
+  EXPECT_FALSE(outBuf.data->isChained());
+  expectSame(outBuf.data, "1703034001aaaa1703030a01bbbb");
+}
+
+namespace {
+// Records batch sizes while deferring to the serial default, to verify
+// the flight writer hands a whole flight to one encryptBatch call.
+class BatchCountingAead : public MockAead {
+ public:
+  std::vector<std::unique_ptr<IOBuf>> encryptBatch(
+      std::vector<BatchJob>&& jobs) const override {
+    batchSizes.push_back(jobs.size());
+    return Aead::encryptBatch(std::move(jobs));
+  }
+
+  mutable std::vector<size_t> batchSizes;
+};
+} // namespace
+
+TEST_F(EncryptedRecordTest, TestWriteBatchSingleBatchCall) {
+  EncryptedWriteRecordLayer write{EncryptionLevel::AppTraffic};
+  auto aead = std::make_unique<BatchCountingAead>();
+  auto aeadPtr = aead.get();
+  EXPECT_CALL(*aeadPtr, setEncryptedBufferHeadroom(_));
+  write.setAead(folly::ByteRange(), std::move(aead));
+
+  EXPECT_CALL(*aeadPtr, _inplaceEncrypt(_, _, _))
+      .Times(3)
+      .WillRepeatedly(
+          Invoke([](std::unique_ptr<IOBuf>&, const IOBuf*, uint64_t) {
+            return getBuf("aaaa");
+          }));
+  TLSMessage msg{ContentType::application_data, IOBuf::create(0x9000)};
+  msg.fragment->append(0x9000);
+  write.writeBatch(std::move(msg));
+
+  ASSERT_EQ(aeadPtr->batchSizes.size(), 1);
+  EXPECT_EQ(aeadPtr->batchSizes[0], 3);
+}
+
+TEST_F(EncryptedRecordTest, TestWriteStream) {
+  TLSMessage msg{ContentType::application_data, IOBuf::create(0x8000)};
+  msg.fragment->append(0x8000);
+  memset(msg.fragment->writableData(), 0x1, msg.fragment->length());
+
+  auto stream = write_.createWriteStream(std::move(msg));
+  EXPECT_FALSE(stream.done());
+
+  // Each pull encrypts only one chunk's worth of records.
+  EXPECT_CALL(*writeAead_, _inplaceEncrypt(_, _, 0))
+      .WillOnce(
+          Invoke([](std::unique_ptr<IOBuf>& buf, const IOBuf*, uint64_t) {
+            EXPECT_EQ(buf->computeChainDataLength(), 0x4001);
+            return getBuf("aaaa");
+          }));
+  auto first = stream.next(0x4000);
+  EXPECT_TRUE(first.hasValue());
+  EXPECT_FALSE(stream.done());
+
+  EXPECT_CALL(*writeAead_, _inplaceEncrypt(_, _, 1))
+      .WillOnce(
+          Invoke([](std::unique_ptr<IOBuf>& buf, const IOBuf*, uint64_t) {
+            EXPECT_EQ(buf->computeChainDataLength(), 0x4001);
+            return getBuf("bbbb");
+          }));
+  auto second = stream.next(0x4000);
+  EXPECT_TRUE(second.hasValue());
+  EXPECT_TRUE(stream.done());
+  EXPECT_FALSE(stream.next(0x4000).hasValue());
+}
+
 TEST_F(EncryptedRecordTest, TestWriteSeqNum) {
   for (int i = 0; i < 10; i++) {
     TLSMessage msg{ContentType::application_data, getBuf("1234567890")};
-    EXPECT_CALL(*writeAead_, _encrypt(_, _, i))
+    EXPECT_CALL(*writeAead_, _inplaceEncrypt(_, _, i))
         .WillOnce(
             Invoke([](std::unique_ptr<IOBuf>& buf, const IOBuf*, uint64_t) {
               expectSame(buf, "123456789017");
@@ -354,6 +708,87 @@ TEST_F(EncryptedRecordTest, TestWriteSeqNum) {
   }
 }
 
+TEST_F(EncryptedRecordTest, TestRekeyThresholdRecords) {
+  write_.setRekeyThresholds(0, 2, 0.0);
+  EXPECT_FALSE(write_.rekeyRecommended());
+  for (int i = 0; i < 2; i++) {
+    TLSMessage msg{ContentType::application_data, getBuf("1234567890")};
+    EXPECT_CALL(*writeAead_, _inplaceEncrypt(_, _, i))
+        .WillOnce(
+            Invoke([](std::unique_ptr<IOBuf>& /*buf*/, const IOBuf*, uint64_t) {
+              return getBuf("aaaa");
+            }));
+    write_.write(std::move(msg));
+  }
+  EXPECT_TRUE(write_.rekeyRecommended());
+
+  EXPECT_CALL(*writeAead_, keyLength()).WillOnce(Return(16));
+  EXPECT_CALL(*writeAead_, ivLength()).WillOnce(Return(12));
+  EXPECT_CALL(*writeAead_, _setKey(_));
+  write_.rekey([](size_t keyLength, size_t ivLength) {
+    TrafficKey key;
+    key.key = IOBuf::create(keyLength);
+    key.iv = IOBuf::create(ivLength);
+    return key;
+  });
+  EXPECT_FALSE(write_.rekeyRecommended());
+}
+
+TEST_F(EncryptedRecordTest, TestRekeyThresholdBytes) {
+  write_.setRekeyThresholds(10, 0, 0.0);
+  EXPECT_FALSE(write_.rekeyRecommended());
+  EXPECT_CALL(*writeAead_, _inplaceEncrypt(_, _, _))
+      .Times(2)
+      .WillRepeatedly(
+          Invoke([](std::unique_ptr<IOBuf>& /*buf*/, const IOBuf*, uint64_t) {
+            return getBuf("aaaa");
+          }));
+  // Each record carries 5 bytes of app data plus the content type footer.
+  TLSMessage msg{ContentType::application_data, getBuf("1234567890")};
+  write_.write(std::move(msg));
+  EXPECT_FALSE(write_.rekeyRecommended());
+  TLSMessage msg2{ContentType::application_data, getBuf("1234567890")};
+  write_.write(std::move(msg2));
+  EXPECT_TRUE(write_.rekeyRecommended());
+}
+
+TEST_F(EncryptedRecordTest, TestRekeyThresholdJitter) {
+  // With 50% jitter the effective byte threshold lands in (500, 1000], so
+  // 400 bytes must never recommend a rekey and 1000 bytes always must.
+  write_.setRekeyThresholds(1000, 0, 0.5);
+  EXPECT_CALL(*writeAead_, _inplaceEncrypt(_, _, _))
+      .WillRepeatedly(
+          Invoke([](std::unique_ptr<IOBuf>& /*buf*/, const IOBuf*, uint64_t) {
+            return getBuf("aaaa");
+          }));
+  TLSMessage msg{ContentType::application_data, IOBuf::create(400)};
+  msg.fragment->append(400);
+  memset(msg.fragment->writableData(), 0x1, msg.fragment->length());
+  write_.write(std::move(msg));
+  EXPECT_FALSE(write_.rekeyRecommended());
+
+  TLSMessage msg2{ContentType::application_data, IOBuf::create(600)};
+  msg2.fragment->append(600);
+  memset(msg2.fragment->writableData(), 0x1, msg2.fragment->length());
+  write_.write(std::move(msg2));
+  EXPECT_TRUE(write_.rekeyRecommended());
+}
+
+TEST_F(EncryptedRecordTest, TestRecordLayerState) {
+  EXPECT_EQ(write_.getRecordLayerState().sequence, 0);
+  TLSMessage msg{ContentType::application_data, getBuf("1234567890")};
+  EXPECT_CALL(*writeAead_, _inplaceEncrypt(_, _, 0))
+      .WillOnce(
+          Invoke([](std::unique_ptr<IOBuf>& /*buf*/, const IOBuf*, uint64_t) {
+            return getBuf("aaaa");
+          }));
+  write_.write(std::move(msg));
+  auto state = write_.getRecordLayerState();
+  EXPECT_EQ(state.sequence, 1);
+  // MockAead does not retain its key
+  EXPECT_FALSE(state.key.hasValue());
+}
+
 TEST_F(EncryptedRecordTest, TestWriteEmpty) {
   TLSMessage msg{ContentType::application_data, folly::IOBuf::create(0)};
   auto outBuf = write_.write(std::move(msg));
@@ -368,7 +803,7 @@ TEST_F(EncryptedRecordTest, TestWriteMaxSize) {
   memset(msg.fragment->writableData(), 0x1, msg.fragment->length());
 
   Sequence s;
-  EXPECT_CALL(*writeAead_, _encrypt(_, _, _))
+  EXPECT_CALL(*writeAead_, _inplaceEncrypt(_, _, _))
       .Times(2)
       .WillRepeatedly(
           Invoke([](std::unique_ptr<IOBuf>& /*buf*/, const IOBuf*, uint64_t) {
@@ -388,7 +823,7 @@ TEST_F(EncryptedRecordTest, TestWriteMinSize) {
   msg.fragment->prependChain(std::move(next));
 
   Sequence s;
-  EXPECT_CALL(*writeAead_, _encrypt(_, _, _))
+  EXPECT_CALL(*writeAead_, _inplaceEncrypt(_, _, _))
       .WillOnce(Invoke([](std::unique_ptr<IOBuf>& buf, const IOBuf*, uint64_t) {
         // one byte for footer
         EXPECT_EQ(buf->computeChainDataLength(), 1701);
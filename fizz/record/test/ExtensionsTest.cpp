@@ -136,5 +136,38 @@ TEST_F(ExtensionsTest, TestBadlyFormedExtension) {
   exts.push_back(std::move(ext));
   EXPECT_THROW(getExtension<ServerNameList>(exts), std::runtime_error);
 }
+
+TEST_F(ExtensionsTest, TestExtensionIndex) {
+  auto exts = getExtensions(sni);
+  auto cookieExts = getExtensions(cookie);
+  exts.push_back(std::move(cookieExts.front()));
+
+  ExtensionIndex index(exts);
+  auto sniExt = index.getExtension<ServerNameList>();
+  ASSERT_TRUE(sniExt.hasValue());
+  EXPECT_EQ(
+      StringPiece(sniExt->server_name_list[0].hostname->coalesce()),
+      StringPiece("www.facebook.com"));
+  auto cookieExt = index.getExtension<Cookie>();
+  ASSERT_TRUE(cookieExt.hasValue());
+  EXPECT_FALSE(index.getExtension<ProtocolNameList>().hasValue());
+  EXPECT_EQ(index.find(ExtensionType::protocol_name_list), nullptr);
+}
+
+TEST_F(ExtensionsTest, TestExtensionIndexDuplicates) {
+  auto exts = getExtensions(sni);
+  auto more = getExtensions(sni);
+  exts.push_back(std::move(more.front()));
+
+  // The index must return the first occurrence, like findExtension().
+  ExtensionIndex index(exts);
+  auto found = index.find(ExtensionType::server_name);
+  ASSERT_NE(found, nullptr);
+  EXPECT_EQ(found, &exts[0]);
+  auto sniExt = index.getExtension<ServerNameList>();
+  EXPECT_EQ(
+      StringPiece(sniExt->server_name_list[0].hostname->coalesce()),
+      StringPiece("www.facebook.com"));
+}
 } // namespace test
 } // namespace fizz
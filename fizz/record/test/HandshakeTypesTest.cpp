@@ -136,6 +136,54 @@ TEST_F(HandshakeTypesTest, ChloEncodeDecode) {
   EXPECT_EQ(chlo, reencoded);
 }
 
+TEST_F(HandshakeTypesTest, ChloDecodeChained) {
+  // Decoding from a heavily chained buffer must give the same result as from
+  // a flat one.
+  auto data = unhexlify(chlo);
+  std::unique_ptr<IOBuf> buf;
+  for (size_t offset = 0; offset < data.size(); offset += 16) {
+    auto chunk = IOBuf::copyBuffer(
+        data.data() + offset, std::min<size_t>(16, data.size() - offset));
+    if (buf) {
+      buf->prependChain(std::move(chunk));
+    } else {
+      buf = std::move(chunk);
+    }
+  }
+  auto clientHello = decode<ClientHello>(std::move(buf));
+  EXPECT_EQ(encodeHex(std::move(clientHello)), chlo);
+}
+
+TEST_F(HandshakeTypesTest, ChloAliasingDecode) {
+  auto data = unhexlify(chlo);
+  auto buf = IOBuf::copyBuffer(data.data(), data.size());
+  auto begin = buf->data();
+  auto end = begin + buf->length();
+
+  detail::AliasingDecodeScope scope;
+  auto clientHello = decode<ClientHello>(std::move(buf));
+  ASSERT_FALSE(clientHello.extensions.empty());
+  for (const auto& extension : clientHello.extensions) {
+    // Extension bodies must point into the input buffer, not copies of it.
+    const auto& extData = extension.extension_data;
+    EXPECT_GE(extData->data(), begin);
+    EXPECT_LE(extData->data() + extData->length(), end);
+  }
+  EXPECT_EQ(encodeHex(std::move(clientHello)), chlo);
+}
+
+TEST_F(HandshakeTypesTest, EncodeHandshakeSingleBuffer) {
+  auto clientHello = decodeHex<ClientHello>(chlo);
+  auto encoded = encodeHandshake(std::move(clientHello));
+  // The handshake header must share the body's allocation.
+  EXPECT_FALSE(encoded->isChained());
+  auto str = hexlify(encoded->moveToFbString().toStdString());
+  ASSERT_EQ(str.size(), chlo.size() + 8);
+  EXPECT_EQ(str.substr(0, 2), "01");
+  EXPECT_EQ(std::stoul(str.substr(2, 6), nullptr, 16), chlo.size() / 2);
+  EXPECT_EQ(str.substr(8), chlo.str());
+}
+
 TEST_F(HandshakeTypesTest, SSL3ChloDecode) {
   auto clientHello = decodeHex<ClientHello>(ssl3chlo);
   EXPECT_TRUE(clientHello.extensions.empty());
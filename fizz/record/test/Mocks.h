@@ -44,12 +44,12 @@ void setWriteDefaults(T* obj) {
 
 class MockPlaintextReadRecordLayer : public PlaintextReadRecordLayer {
  public:
-  MOCK_METHOD1(read, folly::Optional<TLSMessage>(folly::IOBufQueue& buf));
+  MOCK_METHOD1(read, ReadResult<TLSMessage>(folly::IOBufQueue& buf));
   MOCK_CONST_METHOD0(hasUnparsedHandshakeData, bool());
   MOCK_METHOD1(setSkipEncryptedRecords, void(bool));
   MOCK_METHOD0(mockReadEvent, folly::Optional<Param>());
 
-  folly::Optional<Param> readEvent(folly::IOBufQueue& buf) override {
+  ReadResult<Param> readEvent(folly::IOBufQueue& buf) override {
     if (useMockReadEvent_) {
       return mockReadEvent();
     } else {
@@ -70,7 +70,7 @@ class MockEncryptedReadRecordLayer : public EncryptedReadRecordLayer {
   explicit MockEncryptedReadRecordLayer(EncryptionLevel encryptionLevel)
       : EncryptedReadRecordLayer(encryptionLevel) {}
 
-  MOCK_METHOD1(read, folly::Optional<TLSMessage>(folly::IOBufQueue& buf));
+  MOCK_METHOD1(read, ReadResult<TLSMessage>(folly::IOBufQueue& buf));
   MOCK_CONST_METHOD0(hasUnparsedHandshakeData, bool());
 
   MOCK_METHOD2(_setAead, void(folly::ByteRange, Aead*));
@@ -79,10 +79,15 @@ class MockEncryptedReadRecordLayer : public EncryptedReadRecordLayer {
     _setAead(baseSecret, aead.get());
   }
 
+  MOCK_METHOD1(_rekey, void(TrafficKeyDeriver&));
+  void rekey(TrafficKeyDeriver deriver) override {
+    _rekey(deriver);
+  }
+
   MOCK_METHOD1(setSkipFailedDecryption, void(bool));
   MOCK_METHOD0(mockReadEvent, folly::Optional<Param>());
 
-  folly::Optional<Param> readEvent(folly::IOBufQueue& buf) override {
+  ReadResult<Param> readEvent(folly::IOBufQueue& buf) override {
     if (useMockReadEvent_) {
       return mockReadEvent();
     } else {
@@ -139,6 +144,13 @@ class MockEncryptedWriteRecordLayer : public EncryptedWriteRecordLayer {
     _setAead(baseSecret, aead.get());
   }
 
+  MOCK_METHOD1(_rekey, void(TrafficKeyDeriver&));
+  void rekey(TrafficKeyDeriver deriver) override {
+    _rekey(deriver);
+  }
+
+  MOCK_CONST_METHOD0(rekeyRecommended, bool());
+
   void setDefaults() {
     setWriteDefaults(this);
   }
@@ -0,0 +1,42 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GTest.h>
+
+#include <fizz/record/PaddingPolicy.h>
+
+namespace fizz {
+namespace test {
+
+TEST(PadToBlockPolicyTest, TestRoundsUpToBlock) {
+  PadToBlockPolicy policy(64);
+  EXPECT_EQ(policy.getPaddingSize(1), 63);
+  EXPECT_EQ(policy.getPaddingSize(63), 1);
+  EXPECT_EQ(policy.getPaddingSize(65), 63);
+  EXPECT_EQ(policy.getPaddingSize(1000), 24);
+}
+
+TEST(PadToBlockPolicyTest, TestAlignedUnpadded) {
+  PadToBlockPolicy policy(64);
+  EXPECT_EQ(policy.getPaddingSize(64), 0);
+  EXPECT_EQ(policy.getPaddingSize(640), 0);
+}
+
+TEST(PadToFixedSizePolicyTest, TestPadsShortRecords) {
+  PadToFixedSizePolicy policy(1400);
+  EXPECT_EQ(policy.getPaddingSize(1), 1399);
+  EXPECT_EQ(policy.getPaddingSize(1399), 1);
+}
+
+TEST(PadToFixedSizePolicyTest, TestLeavesFullRecords) {
+  PadToFixedSizePolicy policy(1400);
+  EXPECT_EQ(policy.getPaddingSize(1400), 0);
+  EXPECT_EQ(policy.getPaddingSize(16000), 0);
+}
+} // namespace test
+} // namespace fizz
@@ -47,12 +47,12 @@ class PlaintextRecordTest : public testing::Test {
 };
 
 TEST_F(PlaintextRecordTest, TestReadEmpty) {
-  EXPECT_FALSE(read_.read(queue_).hasValue());
+  EXPECT_FALSE(read_.read(queue_)->hasValue());
 }
 
 TEST_F(PlaintextRecordTest, TestReadHandshake) {
   addToQueue("16030100050123456789");
-  auto msg = read_.read(queue_);
+  auto msg = read_.read(queue_).value();
   EXPECT_EQ(msg->type, ContentType::handshake);
   expectSame(msg->fragment, "0123456789");
   EXPECT_TRUE(queue_.empty());
@@ -60,7 +60,7 @@ TEST_F(PlaintextRecordTest, TestReadHandshake) {
 
 TEST_F(PlaintextRecordTest, TestReadAlert) {
   addToQueue("15030100050123456789");
-  auto msg = read_.read(queue_);
+  auto msg = read_.read(queue_).value();
   EXPECT_EQ(msg->type, ContentType::alert);
   expectSame(msg->fragment, "0123456789");
   EXPECT_TRUE(queue_.empty());
@@ -68,40 +68,40 @@ TEST_F(PlaintextRecordTest, TestReadAlert) {
 
 TEST_F(PlaintextRecordTest, TestReadAppData) {
   addToQueue("17030100050123456789");
-  EXPECT_ANY_THROW(read_.read(queue_));
+  EXPECT_TRUE(read_.read(queue_).hasError());
 }
 
 TEST_F(PlaintextRecordTest, TestWaitForData) {
   addToQueue("160301000512345678");
-  EXPECT_FALSE(read_.read(queue_).hasValue());
+  EXPECT_FALSE(read_.read(queue_)->hasValue());
   EXPECT_EQ(queue_.chainLength(), 9);
 }
 
 TEST_F(PlaintextRecordTest, TestWaitForHeader) {
   addToQueue("16030102");
-  EXPECT_FALSE(read_.read(queue_).hasValue());
+  EXPECT_FALSE(read_.read(queue_)->hasValue());
   EXPECT_EQ(queue_.chainLength(), 4);
 }
 
 TEST_F(PlaintextRecordTest, TestMaxSize) {
   addToQueue("1603014000");
-  EXPECT_FALSE(read_.read(queue_).hasValue());
+  EXPECT_FALSE(read_.read(queue_)->hasValue());
   EXPECT_EQ(queue_.chainLength(), 5);
 }
 
 TEST_F(PlaintextRecordTest, TestOverSize) {
   addToQueue("1603014001");
-  EXPECT_ANY_THROW(read_.read(queue_));
+  EXPECT_TRUE(read_.read(queue_).hasError());
 }
 
 TEST_F(PlaintextRecordTest, TestEmpty) {
   addToQueue("1603010000aa");
-  EXPECT_ANY_THROW(read_.read(queue_));
+  EXPECT_TRUE(read_.read(queue_).hasError());
 }
 
 TEST_F(PlaintextRecordTest, TestDataRemaining) {
   addToQueue("16030100050123456789160301");
-  auto msg = read_.read(queue_);
+  auto msg = read_.read(queue_).value();
   EXPECT_EQ(msg->type, ContentType::handshake);
   expectSame(msg->fragment, "0123456789");
   EXPECT_EQ(queue_.chainLength(), 3);
@@ -111,7 +111,7 @@ TEST_F(PlaintextRecordTest, TestDataRemaining) {
 TEST_F(PlaintextRecordTest, TestSkipAndWait) {
   read_.setSkipEncryptedRecords(true);
   addToQueue("17030100050123456789");
-  EXPECT_FALSE(read_.read(queue_).hasValue());
+  EXPECT_FALSE(read_.read(queue_)->hasValue());
   EXPECT_TRUE(queue_.empty());
 }
 
@@ -121,21 +121,21 @@ TEST_F(PlaintextRecordTest, TestSkipOversizedRecord) {
   auto longBuf = IOBuf::create(0xfffb);
   longBuf->append(0xfffb);
   queue_.append(std::move(longBuf));
-  EXPECT_FALSE(read_.read(queue_).hasValue());
+  EXPECT_FALSE(read_.read(queue_)->hasValue());
   EXPECT_TRUE(queue_.empty());
 }
 
 TEST_F(PlaintextRecordTest, TestWaitBeforeSkip) {
   read_.setSkipEncryptedRecords(true);
   addToQueue("170301000501234567");
-  EXPECT_FALSE(read_.read(queue_).hasValue());
+  EXPECT_FALSE(read_.read(queue_)->hasValue());
   expectSame(queue_.move(), "170301000501234567");
 }
 
 TEST_F(PlaintextRecordTest, TestSkipAndRead) {
   read_.setSkipEncryptedRecords(true);
   addToQueue("170301000501234567891703010005012345678916030100050123456789");
-  auto msg = read_.read(queue_);
+  auto msg = read_.read(queue_).value();
   EXPECT_EQ(msg->type, ContentType::handshake);
   expectSame(msg->fragment, "0123456789");
   EXPECT_TRUE(queue_.empty());
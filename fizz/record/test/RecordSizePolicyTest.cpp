@@ -0,0 +1,67 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GTest.h>
+
+#include <fizz/record/RecordSizePolicy.h>
+
+namespace fizz {
+namespace test {
+
+class AdaptiveRecordSizePolicyTest : public testing::Test {
+ protected:
+  std::chrono::steady_clock::time_point now_{
+      std::chrono::steady_clock::now()};
+
+  AdaptiveRecordSizePolicy makePolicy(
+      uint16_t minSize = 1500,
+      uint16_t maxSize = 16384) {
+    return AdaptiveRecordSizePolicy(
+        minSize, maxSize, std::chrono::milliseconds(500), [this]() {
+          return now_;
+        });
+  }
+};
+
+TEST_F(AdaptiveRecordSizePolicyTest, TestStartsAtMin) {
+  auto policy = makePolicy();
+  EXPECT_EQ(policy.getMaxRecordSize(), 1500);
+}
+
+TEST_F(AdaptiveRecordSizePolicyTest, TestGrowsWithTraffic) {
+  auto policy = makePolicy();
+  for (int i = 0; i < 16; i++) {
+    policy.reportRecordWritten(1500);
+  }
+  EXPECT_EQ(policy.getMaxRecordSize(), 3000);
+  for (int i = 0; i < 16; i++) {
+    policy.reportRecordWritten(3000);
+  }
+  EXPECT_EQ(policy.getMaxRecordSize(), 6000);
+}
+
+TEST_F(AdaptiveRecordSizePolicyTest, TestCapsAtMax) {
+  auto policy = makePolicy();
+  for (int i = 0; i < 1000; i++) {
+    policy.reportRecordWritten(16384);
+  }
+  EXPECT_EQ(policy.getMaxRecordSize(), 16384);
+}
+
+TEST_F(AdaptiveRecordSizePolicyTest, TestResetsOnIdle) {
+  auto policy = makePolicy();
+  for (int i = 0; i < 16; i++) {
+    policy.reportRecordWritten(1500);
+  }
+  EXPECT_EQ(policy.getMaxRecordSize(), 3000);
+
+  now_ += std::chrono::seconds(1);
+  EXPECT_EQ(policy.getMaxRecordSize(), 1500);
+}
+} // namespace test
+} // namespace fizz
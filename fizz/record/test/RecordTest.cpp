@@ -25,7 +25,7 @@ namespace test {
 
 class ConcreteReadRecordLayer : public PlaintextReadRecordLayer {
  public:
-  MOCK_METHOD1(read, folly::Optional<TLSMessage>(folly::IOBufQueue& buf));
+  MOCK_METHOD1(read, ReadResult<TLSMessage>(folly::IOBufQueue& buf));
 };
 
 class ConcreteWriteRecordLayer : public PlaintextWriteRecordLayer {
@@ -54,37 +54,82 @@ class RecordTest : public testing::Test {
     auto str = buf->moveToFbString().toStdString();
     EXPECT_EQ(hexlify(str), hex);
   }
+
+  static ReadResult<TLSMessage> message(ContentType type, Buf buf) {
+    return folly::Optional<TLSMessage>(TLSMessage{type, std::move(buf)});
+  }
+
+  static ReadResult<TLSMessage> noMessage() {
+    return folly::Optional<TLSMessage>();
+  }
 };
 
 TEST_F(RecordTest, TestNoData) {
   EXPECT_CALL(read_, read(_)).WillOnce(InvokeWithoutArgs([]() {
-    return none;
+    return noMessage();
   }));
-  EXPECT_FALSE(read_.readEvent(queue_).hasValue());
+  EXPECT_FALSE(read_.readEvent(queue_)->hasValue());
 }
 
 TEST_F(RecordTest, TestReadAppData) {
   EXPECT_CALL(read_, read(_)).WillOnce(InvokeWithoutArgs([]() {
-    return TLSMessage{ContentType::application_data, IOBuf::copyBuffer("hi")};
+    return message(ContentType::application_data, IOBuf::copyBuffer("hi"));
   }));
-  auto param = read_.readEvent(queue_);
+  auto param = read_.readEvent(queue_).value();
+  auto& appData = boost::get<AppData>(*param);
+  EXPECT_TRUE(eq_(appData.data, IOBuf::copyBuffer("hi")));
+}
+
+TEST_F(RecordTest, TestReadAppDataBatched) {
+  read_.setBatchAppDataReads(true);
+  EXPECT_CALL(read_, read(_))
+      .WillOnce(InvokeWithoutArgs([]() {
+        return message(ContentType::application_data, IOBuf::copyBuffer("hi"));
+      }))
+      .WillOnce(InvokeWithoutArgs([]() {
+        return message(
+            ContentType::application_data, IOBuf::copyBuffer("there"));
+      }))
+      .WillOnce(InvokeWithoutArgs([]() { return noMessage(); }));
+  auto param = read_.readEvent(queue_).value();
+  auto& appData = boost::get<AppData>(*param);
+  EXPECT_TRUE(eq_(appData.data, IOBuf::copyBuffer("hithere")));
+}
+
+TEST_F(RecordTest, TestReadAppDataBatchedStopsAtHandshake) {
+  read_.setBatchAppDataReads(true);
+  EXPECT_CALL(read_, read(_))
+      .WillOnce(InvokeWithoutArgs([]() {
+        return message(ContentType::application_data, IOBuf::copyBuffer("hi"));
+      }))
+      .WillOnce(InvokeWithoutArgs([]() {
+        return message(ContentType::handshake, getBuf("140000023232"));
+      }));
+  auto param = read_.readEvent(queue_).value();
   auto& appData = boost::get<AppData>(*param);
   EXPECT_TRUE(eq_(appData.data, IOBuf::copyBuffer("hi")));
+  EXPECT_TRUE(read_.hasUnparsedHandshakeData());
+
+  // the buffered handshake record should be returned without another read
+  param = read_.readEvent(queue_).value();
+  auto& finished = boost::get<Finished>(*param);
+  expectSame(finished.verify_data, "3232");
+  EXPECT_FALSE(read_.hasUnparsedHandshakeData());
 }
 
 TEST_F(RecordTest, TestAlert) {
   EXPECT_CALL(read_, read(_)).WillOnce(InvokeWithoutArgs([]() {
-    return TLSMessage{ContentType::alert, getBuf("0202")};
+    return message(ContentType::alert, getBuf("0202"));
   }));
-  auto param = read_.readEvent(queue_);
+  auto param = read_.readEvent(queue_).value();
   boost::get<Alert>(*param);
 }
 
 TEST_F(RecordTest, TestHandshake) {
   EXPECT_CALL(read_, read(_)).WillOnce(InvokeWithoutArgs([]() {
-    return TLSMessage{ContentType::handshake, getBuf("140000023232")};
+    return message(ContentType::handshake, getBuf("140000023232"));
   }));
-  auto param = read_.readEvent(queue_);
+  auto param = read_.readEvent(queue_).value();
   auto& finished = boost::get<Finished>(*param);
   expectSame(finished.verify_data, "3232");
   expectSame(*finished.originalEncoding, "140000023232");
@@ -92,20 +137,20 @@ TEST_F(RecordTest, TestHandshake) {
 
 TEST_F(RecordTest, TestHandshakeTooLong) {
   EXPECT_CALL(read_, read(_)).WillOnce(InvokeWithoutArgs([]() {
-    return TLSMessage{ContentType::handshake, getBuf("14400000")};
+    return message(ContentType::handshake, getBuf("14400000"));
   }));
-  EXPECT_ANY_THROW(read_.readEvent(queue_));
+  EXPECT_TRUE(read_.readEvent(queue_).hasError());
 }
 
 TEST_F(RecordTest, TestHandshakeFragmentedImmediate) {
   EXPECT_CALL(read_, read(_))
       .WillOnce(InvokeWithoutArgs([]() {
-        return TLSMessage{ContentType::handshake, getBuf("14000008aabbccdd")};
+        return message(ContentType::handshake, getBuf("14000008aabbccdd"));
       }))
       .WillOnce(InvokeWithoutArgs([]() {
-        return TLSMessage{ContentType::handshake, getBuf("11223344")};
+        return message(ContentType::handshake, getBuf("11223344"));
       }));
-  auto param = read_.readEvent(queue_);
+  auto param = read_.readEvent(queue_).value();
   EXPECT_FALSE(read_.hasUnparsedHandshakeData());
   auto& finished = boost::get<Finished>(*param);
   expectSame(finished.verify_data, "aabbccdd11223344");
@@ -114,29 +159,75 @@ TEST_F(RecordTest, TestHandshakeFragmentedImmediate) {
 TEST_F(RecordTest, TestHandshakeFragmentedDelayed) {
   EXPECT_CALL(read_, read(_))
       .WillOnce(InvokeWithoutArgs([]() {
-        return TLSMessage{ContentType::handshake, getBuf("14000008aabbccdd")};
+        return message(ContentType::handshake, getBuf("14000008aabbccdd"));
       }))
-      .WillOnce(InvokeWithoutArgs([]() { return folly::none; }));
-  EXPECT_FALSE(read_.readEvent(queue_).hasValue());
+      .WillOnce(InvokeWithoutArgs(
+          []() { return noMessage(); }));
+  EXPECT_FALSE(read_.readEvent(queue_)->hasValue());
   EXPECT_TRUE(read_.hasUnparsedHandshakeData());
   EXPECT_CALL(read_, read(_)).WillOnce(InvokeWithoutArgs([]() {
-    return TLSMessage{ContentType::handshake, getBuf("11223344")};
+    return message(ContentType::handshake, getBuf("11223344"));
   }));
-  auto param = read_.readEvent(queue_);
+  auto param = read_.readEvent(queue_).value();
+  auto& finished = boost::get<Finished>(*param);
+  expectSame(finished.verify_data, "aabbccdd11223344");
+}
+
+TEST_F(RecordTest, TestHandshakeFragmentedDribble) {
+  // One byte per record; the message should reassemble into the
+  // preallocated buffer and decode once complete.
+  auto encoded = unhexlify("14000008aabbccdd11223344");
+  {
+    InSequence s;
+    for (auto byte : encoded) {
+      EXPECT_CALL(read_, read(_)).WillOnce(InvokeWithoutArgs([byte]() {
+        return message(ContentType::handshake, IOBuf::copyBuffer(&byte, 1));
+      }));
+    }
+  }
+  auto param = read_.readEvent(queue_).value();
   auto& finished = boost::get<Finished>(*param);
   expectSame(finished.verify_data, "aabbccdd11223344");
+  EXPECT_FALSE(read_.hasUnparsedHandshakeData());
+}
+
+TEST_F(RecordTest, TestHandshakeFragmentedThenCoalesced) {
+  // The record completing one message also starts the next.
+  EXPECT_CALL(read_, read(_))
+      .WillOnce(InvokeWithoutArgs([]() {
+        return message(ContentType::handshake, getBuf("14000004aabb"));
+      }))
+      .WillOnce(InvokeWithoutArgs([]() {
+        return message(ContentType::handshake, getBuf("ccdd14000002eeff"));
+      }));
+  auto param = read_.readEvent(queue_).value();
+  auto& finished = boost::get<Finished>(*param);
+  expectSame(finished.verify_data, "aabbccdd");
+  EXPECT_TRUE(read_.hasUnparsedHandshakeData());
+  param = read_.readEvent(queue_).value();
+  auto& finished2 = boost::get<Finished>(*param);
+  expectSame(finished2.verify_data, "eeff");
+  EXPECT_FALSE(read_.hasUnparsedHandshakeData());
+}
+
+TEST_F(RecordTest, TestHandshakeTooLongFragmented) {
+  // The length cap is enforced from the header, before any reassembly
+  // buffer is allocated for the oversized message.
+  EXPECT_CALL(read_, read(_)).WillOnce(InvokeWithoutArgs([]() {
+    return message(ContentType::handshake, getBuf("14400000aabb"));
+  }));
+  EXPECT_TRUE(read_.readEvent(queue_).hasError());
 }
 
 TEST_F(RecordTest, TestHandshakeCoalesced) {
   EXPECT_CALL(read_, read(_)).WillOnce(InvokeWithoutArgs([]() {
-    return TLSMessage{ContentType::handshake,
-                      getBuf("14000002aabb14000002ccdd")};
+    return message(ContentType::handshake, getBuf("14000002aabb14000002ccdd"));
   }));
-  auto param = read_.readEvent(queue_);
+  auto param = read_.readEvent(queue_).value();
   auto& finished = boost::get<Finished>(*param);
   expectSame(finished.verify_data, "aabb");
   EXPECT_TRUE(read_.hasUnparsedHandshakeData());
-  param = read_.readEvent(queue_);
+  param = read_.readEvent(queue_).value();
   auto& finished2 = boost::get<Finished>(*param);
   expectSame(finished2.verify_data, "ccdd");
   EXPECT_FALSE(read_.hasUnparsedHandshakeData());
@@ -145,13 +236,12 @@ TEST_F(RecordTest, TestHandshakeCoalesced) {
 TEST_F(RecordTest, TestHandshakeSpliced) {
   EXPECT_CALL(read_, read(_))
       .WillOnce(InvokeWithoutArgs([]() {
-        return TLSMessage{ContentType::handshake, getBuf("01000010abcd")};
+        return message(ContentType::handshake, getBuf("01000010abcd"));
       }))
       .WillOnce(InvokeWithoutArgs([]() {
-        return TLSMessage{ContentType::application_data,
-                          IOBuf::copyBuffer("hi")};
+        return message(ContentType::application_data, IOBuf::copyBuffer("hi"));
       }));
-  EXPECT_ANY_THROW(read_.readEvent(queue_));
+  EXPECT_TRUE(read_.readEvent(queue_).hasError());
 }
 
 TEST_F(RecordTest, TestWriteAppData) {
@@ -0,0 +1,82 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GTest.h>
+
+#include <fizz/protocol/OpenSSLFactory.h>
+#include <fizz/protocol/test/TestMessages.h>
+#include <fizz/record/TransparentRecordLayer.h>
+
+using namespace folly;
+
+namespace fizz {
+namespace test {
+
+TEST(TransparentRecordTest, TestReadEmpty) {
+  TransparentPlaintextReadRecordLayer layer;
+  IOBufQueue queue{IOBufQueue::cacheChainLength()};
+  EXPECT_FALSE(layer.read(queue)->hasValue());
+}
+
+TEST(TransparentRecordTest, TestReadPassthrough) {
+  TransparentEncryptedReadRecordLayer layer{EncryptionLevel::Handshake};
+  IOBufQueue queue{IOBufQueue::cacheChainLength()};
+  queue.append(IOBuf::copyBuffer("rawhandshakebytes"));
+  auto msg = layer.read(queue).value();
+  EXPECT_TRUE(msg.hasValue());
+  EXPECT_EQ(msg->type, ContentType::handshake);
+  EXPECT_TRUE(IOBufEqualTo()(
+      msg->fragment, IOBuf::copyBuffer("rawhandshakebytes")));
+  EXPECT_TRUE(queue.empty());
+  EXPECT_EQ(layer.getEncryptionLevel(), EncryptionLevel::Handshake);
+}
+
+TEST(TransparentRecordTest, TestReadEventDecodes) {
+  // A raw encoded handshake message fed straight in, with no record
+  // header, decodes through the normal readEvent machinery.
+  TransparentPlaintextReadRecordLayer layer;
+  IOBufQueue queue{IOBufQueue::cacheChainLength()};
+  queue.append(encodeHandshake(TestMessages::clientHello()));
+  auto param = layer.readEvent(queue).value();
+  EXPECT_TRUE(param.hasValue());
+  EXPECT_NO_THROW(boost::get<ClientHello>(*param));
+}
+
+TEST(TransparentRecordTest, TestWritePassthrough) {
+  TransparentEncryptedWriteRecordLayer layer{EncryptionLevel::AppTraffic};
+  auto content = layer.write(
+      TLSMessage{ContentType::handshake, IOBuf::copyBuffer("flight")});
+  EXPECT_EQ(content.contentType, ContentType::handshake);
+  EXPECT_EQ(content.encryptionLevel, EncryptionLevel::AppTraffic);
+  EXPECT_TRUE(IOBufEqualTo()(content.data, IOBuf::copyBuffer("flight")));
+}
+
+TEST(TransparentRecordTest, TestWriteInitialClientHello) {
+  TransparentPlaintextWriteRecordLayer layer;
+  auto content = layer.writeInitialClientHello(IOBuf::copyBuffer("chlo"));
+  EXPECT_EQ(content.contentType, ContentType::handshake);
+  EXPECT_EQ(content.encryptionLevel, EncryptionLevel::Plaintext);
+  EXPECT_TRUE(IOBufEqualTo()(content.data, IOBuf::copyBuffer("chlo")));
+}
+
+TEST(TransparentRecordTest, TestFactory) {
+  TransparentRecordFactory<OpenSSLFactory> factory;
+  auto read = factory.makeEncryptedReadRecordLayer(EncryptionLevel::EarlyData);
+  EXPECT_EQ(read->getEncryptionLevel(), EncryptionLevel::EarlyData);
+  IOBufQueue queue{IOBufQueue::cacheChainLength()};
+  queue.append(IOBuf::copyBuffer("raw"));
+  EXPECT_TRUE(read->read(queue)->hasValue());
+
+  auto write = factory.makePlaintextWriteRecordLayer();
+  auto content = write->write(
+      TLSMessage{ContentType::handshake, IOBuf::copyBuffer("raw")});
+  EXPECT_TRUE(IOBufEqualTo()(content.data, IOBuf::copyBuffer("raw")));
+}
+
+} // namespace test
+} // namespace fizz
@@ -38,6 +38,25 @@ TEST(TestTypes, WriteAndRead24BitsNormal) {
   EXPECT_EQ(len, actualLength);
 }
 
+TEST(TestTypes, EncodeAlert) {
+  auto encoded = encode(Alert(AlertDescription::close_notify));
+  std::array<uint8_t, 2> expected = {{0x02, 0x00}};
+  EXPECT_TRUE(IOBufEqualTo()(
+      encoded, IOBuf::wrapBuffer(expected.data(), expected.size())));
+
+  // Cached encodings hand out views of static storage.
+  auto again = encode(Alert(AlertDescription::close_notify));
+  EXPECT_EQ(encoded->data(), again->data());
+
+  Alert warning(AlertDescription::user_canceled);
+  warning.level = 0x01;
+  auto encodedWarning = encode(std::move(warning));
+  std::array<uint8_t, 2> expectedWarning = {{0x01, 0x5a}};
+  EXPECT_TRUE(IOBufEqualTo()(
+      encodedWarning,
+      IOBuf::wrapBuffer(expectedWarning.data(), expectedWarning.size())));
+}
+
 TEST(TestTypes, Write24BitsOverflow) {
   uint32_t len = 0x10203040;
   auto buf = IOBuf::create(3);
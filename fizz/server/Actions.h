@@ -50,7 +50,12 @@ using Action = boost::variant<
     WaitForData,
     AttemptVersionFallback,
     SecretAvailable>;
+
+#if FOLLY_MOBILE
+using Actions = std::vector<Action>;
+#else
 using Actions = folly::small_vector<Action, 4>;
+#endif
 using AsyncActions = boost::variant<Actions, folly::Future<Actions>>;
 
 namespace detail {
@@ -18,8 +18,11 @@ enum CookieHasGroup : uint8_t {
 };
 
 inline Buf encodeCookie(const CookieState& state) {
-  auto buf = folly::IOBuf::create(100);
-  folly::io::Appender appender(buf.get(), 100);
+  // Fixed-size fields and length prefixes go into the head buffer; the
+  // chlo hash and app token are chained in as shared views rather than
+  // copied byte by byte. The wire format is unchanged.
+  auto buf = folly::IOBuf::create(20);
+  folly::io::Appender appender(buf.get(), 20);
 
   fizz::detail::write(state.version, appender);
   fizz::detail::write(state.cipher, appender);
@@ -31,13 +34,29 @@ inline Buf encodeCookie(const CookieState& state) {
     fizz::detail::write(CookieHasGroup::No, appender);
   }
 
-  fizz::detail::writeBuf<uint16_t>(state.chloHash, appender);
-  fizz::detail::writeBuf<uint16_t>(state.appToken, appender);
+  if (state.chloHash) {
+    appender.writeBE<uint16_t>(
+        static_cast<uint16_t>(state.chloHash->computeChainDataLength()));
+    appender.insert(state.chloHash->clone());
+  } else {
+    appender.writeBE<uint16_t>(0);
+  }
+  if (state.appToken) {
+    appender.writeBE<uint16_t>(
+        static_cast<uint16_t>(state.appToken->computeChainDataLength()));
+    appender.insert(state.appToken->clone());
+  } else {
+    appender.writeBE<uint16_t>(0);
+  }
 
   return buf;
 }
 
+// The returned chlo hash and app token are views sharing the decrypted
+// token's buffer; nothing variable-length is copied on decode. The views
+// keep the underlying token data refcounted past this function.
 inline CookieState decodeCookie(Buf cookie) {
+  fizz::detail::AliasingDecodeScope aliasingScope;
   folly::io::Cursor cursor(cookie.get());
 
   CookieState state;
@@ -67,11 +86,14 @@ AeadCookieCipher<AeadType, HkdfType>::getTokenOrRetry(
   folly::IOBufQueue queue{folly::IOBufQueue::cacheChainLength()};
   queue.append(std::move(clientHello));
   auto msg = PlaintextReadRecordLayer().readEvent(queue);
-  if (!msg) {
+  if (msg.hasError()) {
+    throw std::runtime_error(msg.error().message);
+  }
+  if (!msg->hasValue()) {
     throw std::runtime_error("no TLS message in initial");
   }
 
-  auto chlo = std::move(boost::get<ClientHello>(*msg));
+  auto chlo = std::move(boost::get<ClientHello>(**msg));
 
   auto cookie = getExtension<Cookie>(chlo.extensions);
   if (cookie) {
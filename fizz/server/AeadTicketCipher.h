@@ -43,6 +43,27 @@ class AeadTicketCipher : public TicketCipher {
     return tokenCipher_.setSecrets(ticketSecrets);
   }
 
+  /**
+   * Sets whether tickets carry a key identifier header, making decryption
+   * during key rotation a direct key lookup rather than a trial decryption
+   * with every secret. Only enable once all servers sharing these secrets
+   * can decrypt the versioned format.
+   */
+  void setEncodeTicketKeyIdentifier(bool enable) {
+    tokenCipher_.setEncodeKeyIdentifier(enable);
+  }
+
+  /**
+   * Pre-derives a ring of AEAD keys so steady-state ticket encryption and
+   * decryption of locally issued tickets skip the per-ticket HKDF. Each
+   * handshake thread gets its own ring of pre-keyed cipher contexts,
+   * refreshed on ticket secret rotation, so concurrent seal/open never
+   * contend. A size of 0 (the default) derives a fresh key per ticket.
+   */
+  void setTicketKeyRingSize(size_t size) {
+    tokenCipher_.setKeyRingSize(size);
+  }
+
   void setContext(const FizzServerContext* context) {
     context_ = context;
   }
@@ -70,30 +91,25 @@ class AeadTicketCipher : public TicketCipher {
     clock_ = std::move(clock);
   }
 
+  /**
+   * Sets an executor to run ticket encryption on. When set, the resumption
+   * state serialization and AEAD run on the executor rather than inline on
+   * the calling (typically IO) thread. The cipher must remain alive until
+   * any outstanding encrypts complete.
+   */
+  void setExecutor(folly::Executor* executor) {
+    executor_ = executor;
+  }
+
   folly::Future<folly::Optional<std::pair<Buf, std::chrono::seconds>>> encrypt(
       ResumptionState resState) const override {
-    auto encoded = CodecType::encode(std::move(resState));
-    auto ticket = tokenCipher_.encrypt(std::move(encoded));
-    if (!ticket) {
-      return folly::none;
-    }
-    auto now = clock_->getCurrentTime();
-
-    auto remainingValid = std::chrono::duration_cast<std::chrono::seconds>(
-        (resState.handshakeTime + handshakeValidity_) - now);
-
-    // If handshake is in future, remainingValid will be longer than the actual
-    // validity period. Set maximum to err on the safe side.
-    if (remainingValid > handshakeValidity_) {
-      remainingValid = handshakeValidity_;
-    }
-
-    if (remainingValid <= std::chrono::system_clock::duration::zero()) {
-      return folly::none;
-    } else {
-      return std::make_pair(
-          std::move(*ticket), std::min(remainingValid, ticketValidity_));
+    if (executor_) {
+      return folly::via(
+          executor_, [this, resState = std::move(resState)]() mutable {
+            return encryptImpl(std::move(resState));
+          });
     }
+    return encryptImpl(std::move(resState));
   }
 
   folly::Future<std::pair<PskType, folly::Optional<ResumptionState>>> decrypt(
@@ -117,12 +133,40 @@ class AeadTicketCipher : public TicketCipher {
   }
 
  private:
+  folly::Optional<std::pair<Buf, std::chrono::seconds>> encryptImpl(
+      ResumptionState resState) const {
+    auto encoded = CodecType::encode(std::move(resState));
+    auto ticket = tokenCipher_.encrypt(std::move(encoded));
+    if (!ticket) {
+      return folly::none;
+    }
+    auto now = clock_->getCurrentTime();
+
+    auto remainingValid = std::chrono::duration_cast<std::chrono::seconds>(
+        (resState.handshakeTime + handshakeValidity_) - now);
+
+    // If handshake is in future, remainingValid will be longer than the actual
+    // validity period. Set maximum to err on the safe side.
+    if (remainingValid > handshakeValidity_) {
+      remainingValid = handshakeValidity_;
+    }
+
+    if (remainingValid <= std::chrono::system_clock::duration::zero()) {
+      return folly::none;
+    } else {
+      return std::make_pair(
+          std::move(*ticket), std::min(remainingValid, ticketValidity_));
+    }
+  }
+
   AeadTokenCipher<AeadType, HkdfType> tokenCipher_;
 
   std::chrono::seconds ticketValidity_{std::chrono::hours(1)};
   std::chrono::seconds handshakeValidity_{std::chrono::hours(72)};
   std::shared_ptr<Clock> clock_;
 
+  folly::Executor* executor_{nullptr};
+
   const FizzServerContext* context_ = nullptr;
 };
 } // namespace server
@@ -31,6 +31,13 @@ namespace server {
  * that the salts can be generated randomly without worry of collisions. The
  * sequence number is currently always 0 when encrypting tokens, however it
  * could be incremented to avoid an extra HKDF-Expand on every token.
+ *
+ * When key identifier encoding is enabled the token is prefixed with a
+ * 4 byte identifier expanded from the secret, allowing decryption to select
+ * the right secret directly instead of trial-decrypting with every secret
+ * during key rotation. Decryption accepts both formats; a token whose
+ * leading bytes happen to collide with a key identifier falls back to trial
+ * decryption.
  */
 
 template <typename AeadType, typename HkdfType>
@@ -53,11 +60,19 @@ bool AeadTokenCipher<AeadType, HkdfType>::setSecrets(
       extracted = HkdfType().extract(
           folly::range(contextString), folly::range(extracted));
     }
+    keyIds_.push_back(deriveKeyId(extracted));
     secrets_.push_back(std::move(extracted));
   }
+  secretGeneration_.fetch_add(1, std::memory_order_release);
   return true;
 }
 
+template <typename AeadType, typename HkdfType>
+void AeadTokenCipher<AeadType, HkdfType>::setKeyRingSize(size_t size) {
+  keyRingSize_ = size;
+  secretGeneration_.fetch_add(1, std::memory_order_release);
+}
+
 template <typename AeadType, typename HkdfType>
 folly::Optional<Buf> AeadTokenCipher<AeadType, HkdfType>::encrypt(
     Buf plaintext) const {
@@ -65,18 +80,40 @@ folly::Optional<Buf> AeadTokenCipher<AeadType, HkdfType>::encrypt(
     return folly::none;
   }
 
+  auto& ring = getThreadKeyRing();
+  if (!ring.entries.empty()) {
+    auto& entry = ring.entries[ring.index++ % ring.entries.size()];
+    // Never reuse a nonce: in the unlikely event an entry's sequence number
+    // space is exhausted, fall through to a fresh per-token key.
+    if (entry.seqNum != std::numeric_limits<SeqNum>::max()) {
+      return sealToken(
+          entry.aead, entry.salt, entry.seqNum++, std::move(plaintext));
+    }
+  }
+
   auto salt = RandomGenerator<kSaltLength>().generateRandom();
   auto aead = createAead(folly::range(secrets_.front()), folly::range(salt));
 
-  // For now we always use sequence number 0.
-  SeqNum seqNum = 0;
-  auto token = folly::IOBuf::create(kTokenHeaderLength);
-  folly::io::Appender appender(token.get(), kTokenHeaderLength);
+  // Per-token keys always use sequence number 0.
+  return sealToken(aead, salt, 0, std::move(plaintext));
+}
+
+template <typename AeadType, typename HkdfType>
+Buf AeadTokenCipher<AeadType, HkdfType>::sealToken(
+    const AeadType& aead,
+    const Salt& salt,
+    SeqNum seqNum,
+    Buf plaintext) const {
+  auto token = folly::IOBuf::create(kKeyIdLength + kTokenHeaderLength);
+  folly::io::Appender appender(token.get(), kKeyIdLength + kTokenHeaderLength);
+  if (encodeKeyId_) {
+    appender.push(folly::range(keyIds_.front()));
+  }
   appender.push(folly::range(salt));
   appender.writeBE(seqNum);
   token->prependChain(aead.encrypt(std::move(plaintext), nullptr, seqNum));
 
-  return std::move(token);
+  return token;
 }
 
 template <typename AeadType, typename HkdfType>
@@ -87,12 +124,50 @@ folly::Optional<Buf> AeadTokenCipher<AeadType, HkdfType>::decrypt(
     return folly::none;
   }
 
+  // Tokens carrying a key identifier are decrypted with a direct key
+  // lookup. A legacy token's leading bytes could collide with an
+  // identifier, so on failure fall through to trial decryption below.
+  if (cursor.canAdvance(kKeyIdLength + kTokenHeaderLength)) {
+    folly::io::Cursor keyedCursor(token.get());
+    KeyId keyId;
+    keyedCursor.pull(keyId.data(), keyId.size());
+    for (size_t i = 0; i < keyIds_.size(); i++) {
+      if (keyIds_[i] == keyId) {
+        Salt salt;
+        keyedCursor.pull(salt.data(), salt.size());
+        auto seqNum = keyedCursor.readBE<SeqNum>();
+        Buf ciphertext;
+        keyedCursor.clone(ciphertext, keyedCursor.totalLength());
+        folly::Optional<Buf> result;
+        if (auto ringAead = findRingAead(salt)) {
+          result = ringAead->tryDecrypt(std::move(ciphertext), nullptr, seqNum);
+        } else {
+          auto aead =
+              createAead(folly::range(secrets_[i]), folly::range(salt));
+          result = aead.tryDecrypt(std::move(ciphertext), nullptr, seqNum);
+        }
+        if (result) {
+          return result;
+        }
+        break;
+      }
+    }
+  }
+
   Salt salt;
   cursor.pull(salt.data(), salt.size());
   auto seqNum = cursor.readBE<SeqNum>();
   Buf ciphertext;
   cursor.clone(ciphertext, cursor.totalLength());
 
+  // Tokens sealed with a ring key can reuse the pre-derived aead.
+  if (auto ringAead = findRingAead(salt)) {
+    auto result = ringAead->tryDecrypt(ciphertext->clone(), nullptr, seqNum);
+    if (result) {
+      return result;
+    }
+  }
+
   for (const auto& secret : secrets_) {
     auto aead = createAead(folly::range(secret), folly::range(salt));
     auto result = aead.tryDecrypt(ciphertext->clone(), nullptr, seqNum);
@@ -121,12 +196,61 @@ AeadType AeadTokenCipher<AeadType, HkdfType>::createAead(
   return aead;
 }
 
+template <typename AeadType, typename HkdfType>
+typename AeadTokenCipher<AeadType, HkdfType>::KeyId
+AeadTokenCipher<AeadType, HkdfType>::deriveKeyId(const Secret& secret) const {
+  static constexpr folly::StringPiece label{"token key id"};
+  auto info = folly::IOBuf::wrapBuffer(folly::range(label));
+  auto expanded = HkdfType().expand(folly::range(secret), *info, kKeyIdLength);
+  KeyId keyId;
+  folly::io::Cursor cursor(expanded.get());
+  cursor.pull(keyId.data(), keyId.size());
+  return keyId;
+}
+
+template <typename AeadType, typename HkdfType>
+typename AeadTokenCipher<AeadType, HkdfType>::ThreadKeyRing&
+AeadTokenCipher<AeadType, HkdfType>::getThreadKeyRing() const {
+  auto& ring = *threadKeyRing_;
+  auto generation = secretGeneration_.load(std::memory_order_acquire);
+  if (ring.generation != generation) {
+    // Secrets rotated (or the ring was resized) since this thread last
+    // derived its contexts. Rebuild from the current encryption secret.
+    ring.entries.clear();
+    ring.index = 0;
+    ring.generation = generation;
+    if (keyRingSize_ != 0 && !secrets_.empty()) {
+      for (size_t i = 0; i < keyRingSize_; i++) {
+        KeyRingEntry entry;
+        entry.salt = RandomGenerator<kSaltLength>().generateRandom();
+        entry.aead = createAead(
+            folly::range(secrets_.front()), folly::range(entry.salt));
+        ring.entries.push_back(std::move(entry));
+      }
+    }
+  }
+  return ring;
+}
+
+template <typename AeadType, typename HkdfType>
+const AeadType* AeadTokenCipher<AeadType, HkdfType>::findRingAead(
+    const Salt& salt) const {
+  for (const auto& entry : getThreadKeyRing().entries) {
+    if (entry.salt == salt) {
+      return &entry.aead;
+    }
+  }
+  return nullptr;
+}
+
 template <typename AeadType, typename HkdfType>
 void AeadTokenCipher<AeadType, HkdfType>::clearSecrets() {
   for (auto& secret : secrets_) {
     CryptoUtils::clean(folly::range(secret));
   }
   secrets_.clear();
+  keyIds_.clear();
+  secretGeneration_.fetch_add(1, std::memory_order_release);
 }
 } // namespace server
 } // namespace fizz
@@ -10,8 +10,12 @@
 
 #include <fizz/record/Types.h>
 #include <folly/Optional.h>
+#include <folly/ThreadLocal.h>
 #include <folly/io/IOBuf.h>
 
+#include <atomic>
+#include <limits>
+
 namespace fizz {
 namespace server {
 
@@ -36,6 +40,27 @@ class AeadTokenCipher {
     clearSecrets();
   }
 
+  // Per-thread cipher contexts stay with their cipher; moving transfers
+  // only the secrets and settings, and bumps the generation so any rings
+  // already derived for the destination are rebuilt on next use.
+  AeadTokenCipher(AeadTokenCipher&& other) noexcept
+      : secrets_(std::move(other.secrets_)),
+        keyIds_(std::move(other.keyIds_)),
+        keyRingSize_(other.keyRingSize_),
+        encodeKeyId_(other.encodeKeyId_),
+        contextStrings_(std::move(other.contextStrings_)) {}
+
+  AeadTokenCipher& operator=(AeadTokenCipher&& other) noexcept {
+    clearSecrets();
+    secrets_ = std::move(other.secrets_);
+    keyIds_ = std::move(other.keyIds_);
+    keyRingSize_ = other.keyRingSize_;
+    encodeKeyId_ = other.encodeKeyId_;
+    contextStrings_ = std::move(other.contextStrings_);
+    secretGeneration_.fetch_add(1, std::memory_order_release);
+    return *this;
+  }
+
   /**
    * Set secrets to use for token encryption/decryption.
    * The first one will be used for encryption.
@@ -43,6 +68,31 @@ class AeadTokenCipher {
    */
   bool setSecrets(const std::vector<folly::ByteRange>& tokenSecrets);
 
+  /**
+   * Sets whether encrypted tokens carry a key identifier header. With the
+   * header, decryption is a direct key lookup rather than trial decryption
+   * with every secret during key rotation. Decryption accepts tokens both
+   * with and without the header, so this should only be enabled once all
+   * peers sharing these secrets can decrypt the versioned format.
+   */
+  void setEncodeKeyIdentifier(bool enable) {
+    encodeKeyId_ = enable;
+  }
+
+  /**
+   * Pre-derives a ring of AEAD keys from the encryption secret so that
+   * steady-state token encryption, and same-thread decryption of tokens
+   * sealed by this cipher, skip the per-token HKDF. Each thread builds its
+   * own ring (refreshed lazily after secret rotation), so seal and open
+   * never contend on a shared cipher context. Each ring entry uses its own
+   * random salt (carried in the token as usual, keeping the format
+   * unchanged) and its own sequence number counter, so AEAD nonces are
+   * never reused. Tokens sealed elsewhere still take the derive-per-token
+   * path. A size of 0 (the default) disables the ring. Memory cost is
+   * size AEAD contexts per thread using the cipher.
+   */
+  void setKeyRingSize(size_t size);
+
   folly::Optional<Buf> encrypt(Buf plaintext) const;
 
   folly::Optional<Buf> decrypt(Buf) const;
@@ -53,13 +103,50 @@ class AeadTokenCipher {
   using Salt = std::array<uint8_t, kSaltLength>;
   using SeqNum = uint32_t;
   static constexpr size_t kTokenHeaderLength = kSaltLength + sizeof(SeqNum);
+  static constexpr size_t kKeyIdLength = 4;
+  using KeyId = std::array<uint8_t, kKeyIdLength>;
+
+  struct KeyRingEntry {
+    Salt salt;
+    AeadType aead;
+    SeqNum seqNum{0};
+  };
+
+  // Per-thread ring of pre-keyed AEAD contexts. generation tracks the
+  // secret generation the ring was derived from so rotated-out rings are
+  // rebuilt on next use.
+  struct ThreadKeyRing {
+    uint64_t generation{0};
+    std::vector<KeyRingEntry> entries;
+    uint64_t index{0};
+  };
 
   AeadType createAead(folly::ByteRange secret, folly::ByteRange salt) const;
 
+  KeyId deriveKeyId(const Secret& secret) const;
+
+  Buf sealToken(
+      const AeadType& aead,
+      const Salt& salt,
+      SeqNum seqNum,
+      Buf plaintext) const;
+
+  ThreadKeyRing& getThreadKeyRing() const;
+
+  const AeadType* findRingAead(const Salt& salt) const;
+
   void clearSecrets();
 
-  // First secret is the one used to encrypt.
+  // First secret is the one used to encrypt. keyIds_ is kept in the same
+  // order as secrets_.
   std::vector<Secret> secrets_;
+  std::vector<KeyId> keyIds_;
+
+  folly::ThreadLocal<ThreadKeyRing> threadKeyRing_;
+  std::atomic<uint64_t> secretGeneration_{1};
+  size_t keyRingSize_{0};
+
+  bool encodeKeyId_{false};
 
   std::vector<std::string> contextStrings_;
 };
@@ -22,12 +22,67 @@ AsyncFizzServerT<SM>::AsyncFizzServerT(
       visitor_(*this),
       fizzServer_(state_, transportReadBuf_, visitor_, this) {}
 
+template <typename SM>
+AsyncFizzServerT<SM>::AsyncFizzServerT(
+    folly::AsyncTransportWrapper::UniquePtr socket,
+    const std::shared_ptr<const FizzServerContext>& fizzContext,
+    State state,
+    const std::shared_ptr<ServerExtensions>& extensions)
+    : AsyncFizzBase(std::move(socket)),
+      fizzContext_(fizzContext),
+      extensions_(extensions),
+      state_(std::move(state)),
+      visitor_(*this),
+      fizzServer_(state_, transportReadBuf_, visitor_, this) {
+  CHECK(state_.state() == StateEnum::AcceptingData)
+      << "can only adopt established sessions";
+  state_.executor() = transport_->getEventBase();
+  startTransportReads();
+}
+
+template <typename SM>
+State AsyncFizzServerT<SM>::extractSessionState() {
+  CHECK(getState().state() == StateEnum::AcceptingData)
+      << "session not established";
+  CHECK(!fizzServer_.actionProcessing());
+  CHECK(transportReadBuf_.empty()) << "partially received records buffered";
+  return std::move(state_);
+}
+
+template <typename SM>
+bool AsyncFizzServerT<SM>::sessionStateExtractable() const {
+  return getState().state() == StateEnum::AcceptingData &&
+      !fizzServer_.actionProcessing() && transportReadBuf_.empty();
+}
+
 template <typename SM>
 void AsyncFizzServerT<SM>::accept(HandshakeCallback* callback) {
+  accept(callback, nullptr);
+}
+
+template <typename SM>
+void AsyncFizzServerT<SM>::accept(
+    HandshakeCallback* callback,
+    std::unique_ptr<folly::IOBuf> preReadData) {
   handshakeCallback_ = callback;
 
+  // Bound data (typically accepted early data) buffered before the
+  // application installs its read callback.
+  if (fizzContext_->getEarlyDataBufferLimit() != 0) {
+    setAppDataBufferLimit(fizzContext_->getEarlyDataBufferLimit());
+  }
+  if (fizzContext_->getEarlyDataBufferMeter()) {
+    setAppDataBufferMeter(fizzContext_->getEarlyDataBufferMeter());
+  }
+
   fizzServer_.accept(transport_->getEventBase(), fizzContext_, extensions_);
-  startTransportReads();
+  if (preReadData) {
+    this->transportReadBuf_.append(std::move(preReadData));
+    fizzServer_.newTransportData();
+  }
+  if (!fizzServer_.inTerminalState()) {
+    startTransportReads();
+  }
 }
 
 template <typename SM>
@@ -158,6 +213,35 @@ Buf AsyncFizzServerT<SM>::getEarlyEkm(
       *fizzContext_->getFactory(), label, context, length);
 }
 
+template <typename SM>
+void AsyncFizzServerT<SM>::updateTrafficKeys(bool requestPeerUpdate) {
+  KeyUpdateInitiation keyUpdateInitiation;
+  keyUpdateInitiation.request_update = requestPeerUpdate
+      ? KeyUpdateRequest::update_requested
+      : KeyUpdateRequest::update_not_requested;
+  fizzServer_.initiateKeyUpdate(std::move(keyUpdateInitiation));
+}
+
+template <typename SM>
+folly::Optional<KtlsState> AsyncFizzServerT<SM>::getKtlsState() const {
+  auto readRl = dynamic_cast<const EncryptedReadRecordLayer*>(
+      getState().readRecordLayer());
+  auto writeRl = dynamic_cast<const EncryptedWriteRecordLayer*>(
+      getState().writeRecordLayer());
+  if (!readRl || !writeRl ||
+      readRl->getEncryptionLevel() != EncryptionLevel::AppTraffic ||
+      writeRl->getEncryptionLevel() != EncryptionLevel::AppTraffic) {
+    return folly::none;
+  }
+  KtlsState ktls;
+  ktls.read = readRl->getRecordLayerState();
+  ktls.write = writeRl->getRecordLayerState();
+  if (!ktls.read.key || !ktls.write.key) {
+    return folly::none;
+  }
+  return std::move(ktls);
+}
+
 template <typename SM>
 void AsyncFizzServerT<SM>::writeAppData(
     folly::AsyncTransportWrapper::WriteCallback* callback,
@@ -174,6 +258,12 @@ void AsyncFizzServerT<SM>::writeAppData(
     return;
   }
 
+  if (getState().state() == StateEnum::AcceptingData &&
+      !fizzServer_.actionProcessing() &&
+      writeAppDataDirect(getState().writeRecordLayer(), callback, buf, flags)) {
+    return;
+  }
+
   AppWrite write;
   write.callback = callback;
   write.data = std::move(buf);
@@ -190,6 +280,79 @@ void AsyncFizzServerT<SM>::transportError(
 
 template <typename SM>
 void AsyncFizzServerT<SM>::transportDataAvailable() {
+  DelayedDestruction::DestructorGuard dg(this);
+  if (appDataFastPathEnabled() &&
+      getState().state() == StateEnum::AcceptingData &&
+      !fizzServer_.actionProcessing() && getState().readRecordLayer() &&
+      getState().readRecordLayer()->getEncryptionLevel() ==
+          EncryptionLevel::AppTraffic &&
+      !getState().readRecordLayer()->hasUnparsedHandshakeData()) {
+    auto recordLayer = getState().readRecordLayer();
+    try {
+      if (decryptionPipeline()) {
+        auto encryptedLayer =
+            dynamic_cast<EncryptedReadRecordLayer*>(recordLayer);
+        if (encryptedLayer) {
+          // Fan decryption out to the pipeline's workers; decrypted
+          // messages arrive in record order via the pipeline callbacks.
+          while (true) {
+            auto record =
+                encryptedLayer->readCiphertextRecord(transportReadBuf_);
+            if (record.hasError()) {
+              deliverAllErrors(folly::AsyncSocketException(
+                  folly::AsyncSocketException::SSL_ERROR,
+                  record.error().message.c_str()));
+              return;
+            }
+            if (!record->hasValue()) {
+              return;
+            }
+            decryptionPipeline()->enqueue(std::move(**record));
+          }
+        }
+      }
+      while (true) {
+        auto msg = recordLayer->read(transportReadBuf_);
+        if (msg.hasError()) {
+          deliverAllErrors(folly::AsyncSocketException(
+              folly::AsyncSocketException::SSL_ERROR,
+              msg.error().message.c_str()));
+          return;
+        }
+        if (!msg->hasValue()) {
+          return;
+        }
+        if ((*msg)->type != ContentType::application_data) {
+          // Hand anything else back for full state machine processing.
+          recordLayer->bufferMessage(std::move(**msg));
+          break;
+        }
+        deliverAppData(std::move((*msg)->fragment));
+        if (!good()) {
+          return;
+        }
+      }
+    } catch (const std::exception& ex) {
+      deliverAllErrors(folly::AsyncSocketException(
+          folly::AsyncSocketException::SSL_ERROR, ex.what()));
+      return;
+    }
+  }
+  fizzServer_.newTransportData();
+}
+
+template <typename SM>
+void AsyncFizzServerT<SM>::pipelineControlMessage(TLSMessage msg) {
+  // A post-handshake message decrypted by the pipeline; hand it to the
+  // state machine as if the record layer had just read it.
+  auto recordLayer = getState().readRecordLayer();
+  if (!recordLayer) {
+    deliverAllErrors(folly::AsyncSocketException(
+        folly::AsyncSocketException::SSL_ERROR,
+        "pipelined control message without record layer"));
+    return;
+  }
+  recordLayer->bufferMessage(std::move(msg));
   fizzServer_.newTransportData();
 }
 
@@ -223,7 +386,12 @@ void AsyncFizzServerT<SM>::ActionMoveVisitor::operator()(WriteToSocket& data) {
   for (size_t i = 1; i < data.contents.size(); ++i) {
     allData->prependChain(std::move(data.contents[i].data));
   }
-  server_.transport_->writeChain(data.callback, std::move(allData), data.flags);
+  server_.queueTransportWrite(data.callback, std::move(allData), data.flags);
+}
+
+template <typename SM>
+void AsyncFizzServerT<SM>::ActionMoveVisitor::flushActions() {
+  server_.flushTransportWrites();
 }
 
 template <typename SM>
@@ -248,6 +416,8 @@ void AsyncFizzServerT<SM>::ActionMoveVisitor::operator()(
 template <typename SM>
 void AsyncFizzServerT<SM>::ActionMoveVisitor::operator()(
     ReportHandshakeSuccess&) {
+  // Established connections are not subject to handshake admission control.
+  server_.fizzServer_.setHandshakeScheduler(nullptr);
   // Since the server can handle async events, it is possible for the
   // transport to become not good once we return from processing async events.
   // We want to error out the connection in this case.
@@ -285,6 +455,16 @@ void AsyncFizzServerT<SM>::ActionMoveVisitor::operator()(WaitForData&) {
 template <typename SM>
 void AsyncFizzServerT<SM>::ActionMoveVisitor::operator()(MutateState& mutator) {
   mutator(server_.state_);
+  // A mutator may have installed new record layers; keep the connection's
+  // stats block and event callback attached to the current ones.
+  if (server_.state_.readRecordLayer()) {
+    server_.state_.readRecordLayer()->setStats(server_.recordLayerStats());
+    server_.state_.readRecordLayer()->setEventCallback(
+        server_.recordEventCallback());
+  }
+  if (server_.state_.writeRecordLayer()) {
+    server_.state_.writeRecordLayer()->setStats(server_.recordLayerStats());
+  }
 }
 
 template <typename SM>
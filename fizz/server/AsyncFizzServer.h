@@ -42,8 +42,33 @@ class AsyncFizzServerT : public AsyncFizzBase {
       const std::shared_ptr<const FizzServerContext>& fizzContext,
       const std::shared_ptr<ServerExtensions>& extensions = nullptr);
 
+  /**
+   * Creates an AsyncFizzServer from an established session previously
+   * detached with extractSessionState(), letting a connection migrate to
+   * another thread's EventBase without re-handshaking. The socket must be
+   * the transport extracted from the original server, reattached to the
+   * new EventBase. The state may also come from deserializeSessionState()
+   * in SessionHandoff.h, with the socket rebuilt around a file descriptor
+   * received from another process.
+   **/
+  AsyncFizzServerT(
+      folly::AsyncTransportWrapper::UniquePtr socket,
+      const std::shared_ptr<const FizzServerContext>& fizzContext,
+      State state,
+      const std::shared_ptr<ServerExtensions>& extensions = nullptr);
+
   virtual void accept(HandshakeCallback* callback);
 
+  /**
+   * As accept(), but first feeds preReadData - bytes the acceptor already
+   * read from the socket, typically for peek-based routing - into the
+   * record layer's queue. The data is processed as part of this call
+   * rather than waiting for the next read event.
+   */
+  virtual void accept(
+      HandshakeCallback* callback,
+      std::unique_ptr<folly::IOBuf> preReadData);
+
   bool good() const override;
   bool readable() const override;
   bool connecting() const override;
@@ -81,6 +106,56 @@ class AsyncFizzServerT : public AsyncFizzBase {
       const Buf& hashedContext,
       uint16_t length) const;
 
+  void updateTrafficKeys(bool requestPeerUpdate = true) override;
+
+  /**
+   * Sets the scheduler used to admission-control this connection's
+   * handshake processing. The scheduler is detached automatically once the
+   * handshake completes.
+   */
+  void setHandshakeScheduler(
+      HandshakeScheduler* scheduler,
+      HandshakeScheduler::Priority priority =
+          HandshakeScheduler::Priority::Normal) {
+    fizzServer_.setHandshakeScheduler(scheduler, priority);
+  }
+
+  /**
+   * Sets an instrumentation hook notified of each state transition and
+   * crypto phase, giving a per-connection handshake latency breakdown.
+   * Must be called before accept() to observe the full handshake. The
+   * hook is not owned and must outlive the connection.
+   */
+  void setHandshakeInstrumentation(HandshakeInstrumentation* instrumentation) {
+    state_.instrumentation() = instrumentation;
+  }
+
+  /**
+   * Exports the app traffic record layer state (traffic keys, ivs and
+   * sequence numbers) in a form suitable for kernel TLS (setsockopt
+   * TLS_TX/TLS_RX). Returns none until the handshake has completed. Use
+   * extractTransport() afterwards to take over the socket.
+   */
+  folly::Optional<KtlsState> getKtlsState() const;
+
+  /**
+   * Detaches and returns the established connection state (record layers
+   * with traffic keys and sequence numbers, key scheduler and negotiated
+   * parameters) so the session can be re-attached on another thread with
+   * the State constructor. Only valid once the handshake has completed,
+   * no state machine action is processing and no partially received
+   * records are buffered; the server must not be used afterwards except
+   * for extractTransport() and destruction.
+   */
+  State extractSessionState();
+
+  /**
+   * True when the connection is established and quiescent enough for
+   * extractSessionState(): the handshake has completed, no state machine
+   * action is processing and no partially received records are buffered.
+   */
+  bool sessionStateExtractable() const;
+
   const Cert* getPeerCertificate() const override;
   const Cert* getSelfCertificate() const override;
 
@@ -95,6 +170,8 @@ class AsyncFizzServerT : public AsyncFizzBase {
 
   void transportDataAvailable() override;
 
+  void pipelineControlMessage(TLSMessage msg) override;
+
  private:
   void deliverAllErrors(
       const folly::AsyncSocketException& ex,
@@ -117,6 +194,8 @@ class AsyncFizzServerT : public AsyncFizzBase {
     void operator()(SecretAvailable&);
     void operator()(EndOfData&);
 
+    void flushActions();
+
    private:
     AsyncFizzServerT<SM>& server_;
   };
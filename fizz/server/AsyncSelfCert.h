@@ -8,20 +8,6 @@
 
 #pragma once
 
-#include <fizz/protocol/Certificate.h>
-#include <folly/futures/Future.h>
-
-namespace fizz {
-
-/**
- * SelfCert with an asynchronous sign method. This is useful when the private
- * key for a certificate is not locally available.
- */
-class AsyncSelfCert : public SelfCert {
- public:
-  virtual folly::Future<folly::Optional<Buf>> signFuture(
-      SignatureScheme scheme,
-      CertificateVerifyContext context,
-      folly::ByteRange toBeSigned) const = 0;
-};
-} // namespace fizz
+// AsyncSelfCert is used by both the client and server state machines and now
+// lives in fizz/protocol. This header remains for compatibility.
+#include <fizz/protocol/AsyncSelfCert.h>
@@ -0,0 +1,79 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/server/BatchedReplayCache.h>
+
+namespace fizz {
+namespace server {
+
+BatchedReplayCache::BatchedReplayCache(
+    std::shared_ptr<ReplayCache> cache,
+    folly::EventBase* evb,
+    std::chrono::milliseconds batchWindow,
+    size_t maxBatchSize)
+    : folly::AsyncTimeout(evb),
+      cache_(std::move(cache)),
+      evb_(evb),
+      batchWindow_(batchWindow),
+      maxBatchSize_(maxBatchSize) {}
+
+folly::Future<ReplayCacheResult> BatchedReplayCache::check(
+    folly::ByteRange identifier) {
+  PendingCheck pending;
+  pending.identifier = identifier.str();
+  auto future = pending.promise.getFuture();
+  evb_->runInEventBaseThread([this, pending = std::move(pending)]() mutable {
+    enqueue(std::move(pending));
+  });
+  return future;
+}
+
+void BatchedReplayCache::enqueue(PendingCheck pending) {
+  pending_.push_back(std::move(pending));
+  if (maxBatchSize_ != 0 && pending_.size() >= maxBatchSize_) {
+    cancelTimeout();
+    dispatch();
+    return;
+  }
+  if (!isScheduled()) {
+    scheduleTimeout(batchWindow_.count());
+  }
+}
+
+void BatchedReplayCache::dispatch() {
+  auto batch = std::make_unique<std::vector<PendingCheck>>();
+  batch->swap(pending_);
+  std::vector<folly::ByteRange> identifiers;
+  identifiers.reserve(batch->size());
+  for (const auto& pending : *batch) {
+    identifiers.push_back(folly::ByteRange(
+        folly::StringPiece(pending.identifier)));
+  }
+  // The batch owns the identifier memory and is kept alive until the
+  // wrapped cache's future completes.
+  cache_->checkBatch(identifiers)
+      .thenTry([batch = std::move(batch)](
+                   folly::Try<std::vector<ReplayCacheResult>> results) {
+        for (size_t i = 0; i < batch->size(); i++) {
+          auto& promise = (*batch)[i].promise;
+          if (results.hasException()) {
+            promise.setException(results.exception());
+          } else if (i < results->size()) {
+            promise.setValue((*results)[i]);
+          } else {
+            promise.setValue(ReplayCacheResult::NotChecked);
+          }
+        }
+      });
+}
+
+void BatchedReplayCache::timeoutExpired() noexcept {
+  dispatch();
+}
+} // namespace server
+} // namespace fizz
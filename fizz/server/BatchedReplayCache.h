@@ -0,0 +1,66 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <fizz/server/ReplayCache.h>
+
+#include <folly/io/async/AsyncTimeout.h>
+#include <folly/io/async/EventBase.h>
+
+namespace fizz {
+namespace server {
+
+/**
+ * ReplayCache adapter that micro-batches checks. Checks arriving within
+ * batchWindow are collected and dispatched to the wrapped cache with a
+ * single checkBatch() call, amortizing the per-call overhead of remote or
+ * cross-thread backends during early-data bursts. A batch is dispatched
+ * early once it reaches maxBatchSize (0 means no size limit).
+ */
+class BatchedReplayCache : public ReplayCache, private folly::AsyncTimeout {
+ public:
+  BatchedReplayCache(
+      std::shared_ptr<ReplayCache> cache,
+      folly::EventBase* evb,
+      std::chrono::milliseconds batchWindow,
+      size_t maxBatchSize = 0);
+  ~BatchedReplayCache() override = default;
+
+  /**
+   * May be called from any thread; the identifier is copied and the
+   * returned future completes on the EventBase.
+   */
+  folly::Future<ReplayCacheResult> check(folly::ByteRange identifier) override;
+
+ private:
+  struct PendingCheck {
+    std::string identifier;
+    folly::Promise<ReplayCacheResult> promise;
+  };
+
+  void enqueue(PendingCheck pending);
+  void dispatch();
+  void timeoutExpired() noexcept override;
+
+  std::shared_ptr<ReplayCache> cache_;
+  folly::EventBase* evb_;
+  std::chrono::milliseconds batchWindow_;
+  size_t maxBatchSize_;
+
+  // Only accessed on evb_.
+  std::vector<PendingCheck> pending_;
+};
+
+} // namespace server
+} // namespace fizz
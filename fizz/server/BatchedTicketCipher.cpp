@@ -0,0 +1,78 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/server/BatchedTicketCipher.h>
+
+namespace fizz {
+namespace server {
+
+BatchedTicketCipher::BatchedTicketCipher(
+    std::shared_ptr<TicketCipher> cipher,
+    folly::EventBase* evb,
+    folly::Executor* executor,
+    std::chrono::milliseconds batchWindow,
+    size_t maxBatchSize)
+    : folly::AsyncTimeout(evb),
+      cipher_(std::move(cipher)),
+      evb_(evb),
+      executor_(executor),
+      batchWindow_(batchWindow),
+      maxBatchSize_(maxBatchSize) {}
+
+folly::Future<std::pair<PskType, folly::Optional<ResumptionState>>>
+BatchedTicketCipher::decrypt(
+    std::unique_ptr<folly::IOBuf> encryptedTicket) const {
+  PendingDecrypt pending;
+  pending.ticket = std::move(encryptedTicket);
+  auto future = pending.promise.getFuture();
+  // The batch state mutates only on the EventBase; decrypt()'s constness
+  // covers the wrapped cipher, not the queue.
+  auto self = const_cast<BatchedTicketCipher*>(this);
+  evb_->runInEventBaseThread([self, pending = std::move(pending)]() mutable {
+    self->enqueue(std::move(pending));
+  });
+  return future;
+}
+
+void BatchedTicketCipher::enqueue(PendingDecrypt pending) {
+  pending_.push_back(std::move(pending));
+  if (maxBatchSize_ != 0 && pending_.size() >= maxBatchSize_) {
+    cancelTimeout();
+    dispatch();
+    return;
+  }
+  if (!isScheduled()) {
+    scheduleTimeout(batchWindow_.count());
+  }
+}
+
+void BatchedTicketCipher::dispatch() {
+  auto batch = std::make_unique<std::vector<PendingDecrypt>>();
+  batch->swap(pending_);
+  // One executor hop carries the whole batch; each ticket then opens on
+  // the pool thread. Ciphers with an asynchronous decrypt complete their
+  // promises whenever their futures fire.
+  executor_->add([cipher = cipher_, batch = std::move(batch)]() mutable {
+    for (auto& pending : *batch) {
+      cipher->decrypt(std::move(pending.ticket))
+          .thenTry(
+              [promise = std::move(pending.promise)](
+                  folly::Try<std::pair<
+                      PskType,
+                      folly::Optional<ResumptionState>>> result) mutable {
+                promise.setTry(std::move(result));
+              });
+    }
+  });
+}
+
+void BatchedTicketCipher::timeoutExpired() noexcept {
+  dispatch();
+}
+} // namespace server
+} // namespace fizz
@@ -0,0 +1,81 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <fizz/server/TicketCipher.h>
+
+#include <folly/io/async/AsyncTimeout.h>
+#include <folly/io/async/EventBase.h>
+
+namespace fizz {
+namespace server {
+
+/**
+ * TicketCipher adapter that micro-batches decryption onto an executor.
+ * Decrypts arriving within batchWindow are collected on the EventBase and
+ * shipped to the executor in a single hop, where the wrapped cipher opens
+ * each ticket off the IO thread. During reconnect storms this keeps the
+ * per-hello AES-GCM work out of the IO loop, with resumption throughput
+ * scaling with the executor pool instead of competing with reads. A batch
+ * is dispatched early once it reaches maxBatchSize (0 means no size
+ * limit).
+ *
+ * The handshake resumes through the state machine's normal asynchronous
+ * wait on the decrypt future; encrypts pass straight through, as ticket
+ * issuance already happens after the handshake completes.
+ */
+class BatchedTicketCipher : public TicketCipher, private folly::AsyncTimeout {
+ public:
+  BatchedTicketCipher(
+      std::shared_ptr<TicketCipher> cipher,
+      folly::EventBase* evb,
+      folly::Executor* executor,
+      std::chrono::milliseconds batchWindow,
+      size_t maxBatchSize = 0);
+  ~BatchedTicketCipher() override = default;
+
+  folly::Future<folly::Optional<std::pair<Buf, std::chrono::seconds>>> encrypt(
+      ResumptionState resState) const override {
+    return cipher_->encrypt(std::move(resState));
+  }
+
+  /**
+   * May be called from any thread; the returned future completes on an
+   * executor thread.
+   */
+  folly::Future<std::pair<PskType, folly::Optional<ResumptionState>>> decrypt(
+      std::unique_ptr<folly::IOBuf> encryptedTicket) const override;
+
+ private:
+  struct PendingDecrypt {
+    Buf ticket;
+    folly::Promise<std::pair<PskType, folly::Optional<ResumptionState>>>
+        promise;
+  };
+
+  void enqueue(PendingDecrypt pending);
+  void dispatch();
+  void timeoutExpired() noexcept override;
+
+  std::shared_ptr<TicketCipher> cipher_;
+  folly::EventBase* evb_;
+  folly::Executor* executor_;
+  std::chrono::milliseconds batchWindow_;
+  size_t maxBatchSize_;
+
+  // Only accessed on evb_.
+  std::vector<PendingDecrypt> pending_;
+};
+
+} // namespace server
+} // namespace fizz
@@ -8,28 +8,114 @@
 
 #include <fizz/server/CertManager.h>
 
+#include <fizz/protocol/LazySelfCert.h>
 #include <folly/String.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/futures/Future.h>
+#include <folly/ssl/OpenSSLCertUtils.h>
+#include <folly/system/MemoryMapping.h>
+
+#include <thread>
 
 using namespace folly;
 
 namespace fizz {
 namespace server {
 
+namespace {
+
+constexpr folly::StringPiece kPemBegin = "-----BEGIN ";
+constexpr folly::StringPiece kPemKeyMarker = "PRIVATE KEY-----";
+constexpr folly::StringPiece kPemCertMarker = "-----BEGIN CERTIFICATE-----";
+
+std::shared_ptr<SelfCert> parseBundleEntry(folly::StringPiece entry) {
+  auto certStart = entry.find(kPemCertMarker);
+  if (certStart == std::string::npos) {
+    throw std::runtime_error("bundle entry has no certs");
+  }
+  std::string keyData(entry.data(), certStart);
+  auto certs = folly::ssl::OpenSSLCertUtils::readCertsFromBuffer(
+      folly::ByteRange(entry.subpiece(certStart)));
+  if (certs.empty()) {
+    throw std::runtime_error("no certificates read");
+  }
+  return std::make_shared<LazySelfCert>(std::move(certs), std::move(keyData));
+}
+
+/**
+ * Bit position for each signature scheme fizz knows, so scheme-set
+ * membership is a single mask test. Schemes outside the enum get no bit
+ * and take the slow path.
+ */
+folly::Optional<uint64_t> schemeBit(SignatureScheme scheme) {
+  switch (scheme) {
+    case SignatureScheme::ecdsa_secp256r1_sha256:
+      return uint64_t(1) << 0;
+    case SignatureScheme::ecdsa_secp384r1_sha384:
+      return uint64_t(1) << 1;
+    case SignatureScheme::ecdsa_secp521r1_sha512:
+      return uint64_t(1) << 2;
+    case SignatureScheme::rsa_pss_sha256:
+      return uint64_t(1) << 3;
+    case SignatureScheme::rsa_pss_sha384:
+      return uint64_t(1) << 4;
+    case SignatureScheme::rsa_pss_sha512:
+      return uint64_t(1) << 5;
+    case SignatureScheme::ed25519:
+      return uint64_t(1) << 6;
+    case SignatureScheme::ed448:
+      return uint64_t(1) << 7;
+  }
+  return folly::none;
+}
+
+uint64_t schemeMask(const std::vector<SignatureScheme>& schemes) {
+  uint64_t mask = 0;
+  for (auto scheme : schemes) {
+    if (auto bit = schemeBit(scheme)) {
+      mask |= *bit;
+    }
+  }
+  return mask;
+}
+
+} // namespace
+
 // Find a matching cert given a key. If lastResort is none the first cert found
 // (by supportedSigSchemes priority) matching key but not peerSigSchemes will be
 // saved in lastResort.
 CertManager::CertMatch CertManager::findCert(
-    const std::string& key,
+    const CertMap& certs,
+    folly::StringPiece key,
     const std::vector<SignatureScheme>& supportedSigSchemes,
     const std::vector<SignatureScheme>& peerSigSchemes,
+    uint64_t peerSchemeMask,
     CertMatch& lastResort) const {
-  auto it = certs_.find(key);
-  if (it == certs_.end()) {
+  auto it = certs.find(key);
+  if (it == certs.end()) {
     return none;
   }
+  const auto& entry = it->second;
   for (auto scheme : supportedSigSchemes) {
-    auto cert = it->second.find(scheme);
-    if (cert == it->second.end()) {
+    auto bit = schemeBit(scheme);
+    if (bit) {
+      // The precomputed mask covers every scheme the identity has a cert
+      // for, so a clear bit rules the scheme out without touching the map,
+      // and the peer check is a mask test instead of a scan.
+      if (!(entry.schemeMask & *bit)) {
+        continue;
+      }
+      auto cert = entry.schemes.find(scheme);
+      DCHECK(cert != entry.schemes.end());
+      if (peerSchemeMask & *bit) {
+        return std::make_pair(cert->second, scheme);
+      } else if (!lastResort) {
+        lastResort = std::make_pair(cert->second, scheme);
+      }
+      continue;
+    }
+    auto cert = entry.schemes.find(scheme);
+    if (cert == entry.schemes.end()) {
       continue;
     }
     if (std::find(peerSigSchemes.begin(), peerSigSchemes.end(), scheme) !=
@@ -42,26 +128,41 @@ CertManager::CertMatch CertManager::findCert(
   return none;
 }
 
-CertManager::CertMatch CertManager::getCert(
+CertManager::CertMatch CertManager::matchCert(
+    const CertMap& certs,
+    const std::string& defaultKey,
     const Optional<std::string>& sni,
     const std::vector<SignatureScheme>& supportedSigSchemes,
-    const std::vector<SignatureScheme>& peerSigSchemes) const {
-  CertMatch lastResort;
+    const std::vector<SignatureScheme>& peerSigSchemes,
+    CertMatch& lastResort) const {
+  auto peerSchemeMask = schemeMask(peerSigSchemes);
   if (sni) {
-    auto key = *sni;
-    toLowerAscii(key);
+    // The maps hash and compare case-insensitively, so the client's value
+    // can be matched in place without a lowercased copy.
+    folly::StringPiece key(*sni);
 
-    auto ret = findCert(key, supportedSigSchemes, peerSigSchemes, lastResort);
+    auto ret = findCert(
+        certs,
+        key,
+        supportedSigSchemes,
+        peerSigSchemes,
+        peerSchemeMask,
+        lastResort);
     if (ret) {
       VLOG(8) << "Found exact SNI match for: " << key;
       return ret;
     }
 
-    auto dot = key.find_first_of('.');
+    auto dot = key.find('.');
     if (dot != std::string::npos) {
-      std::string wildcardKey(key, dot);
+      auto wildcardKey = key.subpiece(dot);
       ret = findCert(
-          wildcardKey, supportedSigSchemes, peerSigSchemes, lastResort);
+          certs,
+          wildcardKey,
+          supportedSigSchemes,
+          peerSigSchemes,
+          peerSchemeMask,
+          lastResort);
       if (ret) {
         VLOG(8) << "Found wildcard SNI match for: " << key;
         return ret;
@@ -71,8 +172,22 @@ CertManager::CertMatch CertManager::getCert(
     VLOG(8) << "Did not find match for SNI: " << key;
   }
 
-  auto ret =
-      findCert(default_, supportedSigSchemes, peerSigSchemes, lastResort);
+  return findCert(
+      certs,
+      defaultKey,
+      supportedSigSchemes,
+      peerSigSchemes,
+      peerSchemeMask,
+      lastResort);
+}
+
+CertManager::CertMatch CertManager::getCert(
+    const Optional<std::string>& sni,
+    const std::vector<SignatureScheme>& supportedSigSchemes,
+    const std::vector<SignatureScheme>& peerSigSchemes) const {
+  CertMatch lastResort;
+  auto ret = matchCert(
+      certs_, default_, sni, supportedSigSchemes, peerSigSchemes, lastResort);
   if (ret) {
     return ret;
   }
@@ -81,6 +196,22 @@ CertManager::CertMatch CertManager::getCert(
   return lastResort;
 }
 
+CertManager::CertMatch CertManager::getDelegatedCert(
+    const Optional<std::string>& sni,
+    const std::vector<SignatureScheme>& supportedSigSchemes,
+    const std::vector<SignatureScheme>& peerDcSigSchemes) const {
+  // No last-resort here: a credential the client cannot verify is fatal,
+  // so callers fall back to a regular cert instead.
+  CertMatch lastResort;
+  return matchCert(
+      delegatedCerts_,
+      delegatedDefault_,
+      sni,
+      supportedSigSchemes,
+      peerDcSigSchemes,
+      lastResort);
+}
+
 std::shared_ptr<SelfCert> CertManager::getCert(
     const std::string& identity) const {
   auto it = identMap_.find(identity);
@@ -107,6 +238,7 @@ static std::string getKeyFromIdent(const std::string& ident) {
 }
 
 void CertManager::addCertIdentity(
+    CertMap& certs,
     std::shared_ptr<SelfCert> cert,
     const std::string& ident) {
   auto key = getKeyFromIdent(ident);
@@ -116,24 +248,31 @@ void CertManager::addCertIdentity(
   }
 
   auto sigSchemes = cert->getSigSchemes();
-  auto& schemeMap = certs_[key];
+  auto& entry = certs[key];
   for (auto sigScheme : sigSchemes) {
-    if (schemeMap.find(sigScheme) != schemeMap.end()) {
+    if (entry.schemes.find(sigScheme) != entry.schemes.end()) {
       VLOG(8) << "Skipping duplicate certificate for " << key;
     } else {
-      schemeMap[sigScheme] = cert;
+      entry.schemes[sigScheme] = cert;
+      if (auto bit = schemeBit(sigScheme)) {
+        entry.schemeMask |= *bit;
+      }
     }
   }
 }
 
 void CertManager::addCert(std::shared_ptr<SelfCert> cert, bool defaultCert) {
+  for (const auto& compressor : compressors_) {
+    cert->precompressCert(*compressor);
+  }
+
   auto primaryIdent = cert->getIdentity();
-  addCertIdentity(cert, primaryIdent);
+  addCertIdentity(certs_, cert, primaryIdent);
 
   auto altIdents = cert->getAltIdentities();
   for (const auto& ident : altIdents) {
     if (ident != primaryIdent) {
-      addCertIdentity(cert, ident);
+      addCertIdentity(certs_, cert, ident);
     }
   }
 
@@ -144,6 +283,93 @@ void CertManager::addCert(std::shared_ptr<SelfCert> cert, bool defaultCert) {
   if (identMap_.find(primaryIdent) == identMap_.end()) {
     identMap_[primaryIdent] = cert;
   }
+
+  if (stapleManager_) {
+    stapleManager_->addCert(cert);
+  }
+}
+
+void CertManager::addDelegatedCert(
+    std::shared_ptr<SelfCert> cert,
+    bool defaultCert) {
+  for (const auto& compressor : compressors_) {
+    cert->precompressCert(*compressor);
+  }
+
+  auto primaryIdent = cert->getIdentity();
+  addCertIdentity(delegatedCerts_, cert, primaryIdent);
+
+  auto altIdents = cert->getAltIdentities();
+  for (const auto& ident : altIdents) {
+    if (ident != primaryIdent) {
+      addCertIdentity(delegatedCerts_, cert, ident);
+    }
+  }
+
+  if (defaultCert) {
+    delegatedDefault_ = getKeyFromIdent(primaryIdent);
+  }
+}
+
+void CertManager::setStapleManager(
+    std::shared_ptr<OcspStapleManager> stapleManager) {
+  stapleManager_ = std::move(stapleManager);
+  for (const auto& ident : identMap_) {
+    stapleManager_->addCert(ident.second);
+  }
+}
+
+void CertManager::addCertsFromBundle(
+    const std::string& path,
+    size_t numThreads) {
+  folly::MemoryMapping mapping(path.c_str());
+  auto range = folly::StringPiece(mapping.range());
+
+  // Partition on private key blocks; each entry runs from its key to
+  // the start of the next one.
+  std::vector<size_t> entryStarts;
+  size_t pos = 0;
+  while ((pos = range.find(kPemBegin, pos)) != std::string::npos) {
+    auto header = range.subpiece(pos, kPemBegin.size() + 32);
+    if (header.find(kPemKeyMarker) != std::string::npos) {
+      entryStarts.push_back(pos);
+    }
+    pos += kPemBegin.size();
+  }
+  if (entryStarts.empty()) {
+    throw std::runtime_error(
+        folly::to<std::string>("no private keys found in bundle: ", path));
+  }
+
+  if (numThreads == 0) {
+    numThreads = std::thread::hardware_concurrency();
+  }
+  folly::CPUThreadPoolExecutor executor(std::max<size_t>(numThreads, 1));
+  std::vector<folly::Future<std::shared_ptr<SelfCert>>> futures;
+  for (size_t i = 0; i < entryStarts.size(); i++) {
+    auto start = entryStarts[i];
+    auto end = i + 1 < entryStarts.size() ? entryStarts[i + 1] : range.size();
+    auto entry = range.subpiece(start, end - start);
+    futures.push_back(
+        folly::via(&executor, [entry]() { return parseBundleEntry(entry); }));
+  }
+
+  // Indexing is cheap relative to parsing and the maps are not
+  // thread-safe, so it stays on this thread.
+  auto results = folly::collectAll(std::move(futures)).get();
+  for (auto& result : results) {
+    addCert(std::move(result.value()));
+  }
+}
+
+void CertManager::setCertificateCompressors(
+    std::vector<std::shared_ptr<CertificateCompressor>> compressors) {
+  compressors_ = std::move(compressors);
+  for (const auto& ident : identMap_) {
+    for (const auto& compressor : compressors_) {
+      ident.second->precompressCert(*compressor);
+    }
+  }
 }
 } // namespace server
 } // namespace fizz
@@ -12,6 +12,9 @@
 #include <unordered_map>
 
 #include <fizz/protocol/Certificate.h>
+#include <fizz/server/OcspStapleManager.h>
+#include <folly/Range.h>
+#include <folly/experimental/StringKeyedUnorderedMap.h>
 
 namespace fizz {
 namespace server {
@@ -42,21 +45,135 @@ class CertManager {
 
   void addCert(std::shared_ptr<SelfCert> cert, bool defaultCert = false);
 
+  /**
+   * Adds a delegated credential cert (typically a DelegatedSelfCertImpl
+   * wrapping a cheap EC key). Delegated certs are kept separately and
+   * only selected through getDelegatedCert(), as they must not be served
+   * to clients that did not advertise delegated_credential support.
+   */
+  void addDelegatedCert(
+      std::shared_ptr<SelfCert> cert,
+      bool defaultCert = false);
+
+  /**
+   * Select a delegated cert for sni whose CertificateVerify scheme is
+   * acceptable to both the server and the client's delegated_credential
+   * extension. Unlike getCert() there is no last-resort fallback: returns
+   * none unless the client can verify the credential, so callers fall
+   * back to a regular cert.
+   */
+  virtual CertMatch getDelegatedCert(
+      const folly::Optional<std::string>& sni,
+      const std::vector<SignatureScheme>& supportedSigSchemes,
+      const std::vector<SignatureScheme>& peerDcSigSchemes) const;
+
+  /**
+   * Bulk-loads certs from a concatenated PEM bundle. The bundle is a
+   * sequence of entries, each an unencrypted private key PEM block
+   * followed by that key's cert chain (leaf first). The file is
+   * memory-mapped, partitioned on key block boundaries and parsed
+   * across numThreads threads (0 means one per core), and each entry's
+   * private key is not materialized until the cert first signs, so
+   * loading a large SNI set does not serialize on PEM key parsing.
+   * Throws std::runtime_error if the bundle cannot be read or contains
+   * no entries.
+   */
+  void addCertsFromBundle(const std::string& path, size_t numThreads = 0);
+
+  /**
+   * Sets compressors to eagerly run over every cert as it is added, so
+   * that compressed_certificate responses are served from the cert's
+   * precompressed cache with no compression work per connection. Certs
+   * added before this call are compressed immediately. The algorithms
+   * should match those passed to
+   * FizzServerContext::setSupportedCompressionAlgorithms().
+   */
+  void setCertificateCompressors(
+      std::vector<std::shared_ptr<CertificateCompressor>> compressors);
+
+  /**
+   * Attaches an OCSP staple manager and registers every cert with it for
+   * background refresh; certs added later are registered as they arrive.
+   */
+  void setStapleManager(std::shared_ptr<OcspStapleManager> stapleManager);
+
+  OcspStapleManager* getStapleManager() const {
+    return stapleManager_.get();
+  }
+
  private:
+  /**
+   * Case-insensitive hashing and equality over StringPiece so that SNI
+   * lookups need neither a lowercased copy of the client's value nor a
+   * substring allocation for the wildcard transformation.
+   */
+  struct AsciiCaseInsensitiveHash {
+    size_t operator()(folly::StringPiece key) const {
+      // FNV-1a over the lowercased bytes, matching toLowerAscii semantics.
+      uint64_t hash = 14695981039346656037ULL;
+      for (char c : key) {
+        if (c >= 'A' && c <= 'Z') {
+          c += 'a' - 'A';
+        }
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ULL;
+      }
+      return static_cast<size_t>(hash);
+    }
+  };
+
+  struct AsciiCaseInsensitiveEqual {
+    bool operator()(folly::StringPiece a, folly::StringPiece b) const {
+      return a.equals(b, folly::AsciiCaseInsensitive());
+    }
+  };
+
+  using SigSchemeMap = std::map<SignatureScheme, std::shared_ptr<SelfCert>>;
+
+  /**
+   * Per-identity selection table, built at addCert() time. schemes maps
+   * each signature scheme to the best (first-added) cert for it, and
+   * schemeMask caches the scheme set as a bitmask so selection can skip
+   * schemes the identity has no cert for with a single mask test.
+   */
+  struct IdentityEntry {
+    SigSchemeMap schemes;
+    uint64_t schemeMask{0};
+  };
+
+  using CertMap = folly::StringKeyedUnorderedMap<
+      IdentityEntry,
+      AsciiCaseInsensitiveHash,
+      AsciiCaseInsensitiveEqual>;
+
   CertMatch findCert(
-      const std::string& key,
+      const CertMap& certs,
+      folly::StringPiece key,
+      const std::vector<SignatureScheme>& supportedSigSchemes,
+      const std::vector<SignatureScheme>& peerSigSchemes,
+      uint64_t peerSchemeMask,
+      CertMatch& lastResort) const;
+
+  CertMatch matchCert(
+      const CertMap& certs,
+      const std::string& defaultKey,
+      const folly::Optional<std::string>& sni,
       const std::vector<SignatureScheme>& supportedSigSchemes,
       const std::vector<SignatureScheme>& peerSigSchemes,
       CertMatch& lastResort) const;
 
   void addCertIdentity(
+      CertMap& certs,
       std::shared_ptr<SelfCert> cert,
       const std::string& ident);
 
-  using SigSchemeMap = std::map<SignatureScheme, std::shared_ptr<SelfCert>>;
-  std::unordered_map<std::string, SigSchemeMap> certs_;
+  CertMap certs_;
+  CertMap delegatedCerts_;
   std::unordered_map<std::string, std::shared_ptr<SelfCert>> identMap_;
   std::string default_;
+  std::string delegatedDefault_;
+  std::vector<std::shared_ptr<CertificateCompressor>> compressors_;
+  std::shared_ptr<OcspStapleManager> stapleManager_;
 };
 } // namespace server
 } // namespace fizz
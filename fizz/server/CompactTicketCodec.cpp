@@ -0,0 +1,138 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/server/CompactTicketCodec.h>
+
+#include <fizz/crypto/Sha256.h>
+
+#include <cstring>
+
+namespace fizz {
+namespace server {
+
+namespace {
+constexpr size_t kFingerprintLength = 8;
+
+using Fingerprint = std::array<uint8_t, kFingerprintLength>;
+
+Fingerprint profileFingerprint(
+    ProtocolVersion version,
+    CipherSuite cipher,
+    const folly::Optional<std::string>& alpn,
+    const std::string& identity) {
+  auto buf = folly::IOBuf::create(32);
+  folly::io::Appender appender(buf.get(), 32);
+  fizz::detail::write(version, appender);
+  fizz::detail::write(cipher, appender);
+  if (alpn) {
+    auto alpnBuf = folly::IOBuf::copyBuffer(*alpn);
+    fizz::detail::writeBuf<uint8_t>(alpnBuf, appender);
+  } else {
+    fizz::detail::writeBuf<uint8_t>(nullptr, appender);
+  }
+  appender.push(folly::ByteRange(folly::StringPiece(identity)));
+
+  Sha256 hasher;
+  hasher.hash_init();
+  hasher.hash_update(*buf);
+  std::array<uint8_t, Sha256::HashLen> digest;
+  hasher.hash_final(folly::MutableByteRange(digest.data(), digest.size()));
+
+  Fingerprint fingerprint;
+  memcpy(fingerprint.data(), digest.data(), fingerprint.size());
+  return fingerprint;
+}
+} // namespace
+
+constexpr folly::StringPiece CompactTicketCodec::Label;
+
+Buf CompactTicketCodec::encode(ResumptionState resState) {
+  if (resState.clientCert) {
+    throw std::runtime_error("compact ticket cannot store client cert");
+  }
+  if (resState.appToken && !resState.appToken->empty()) {
+    throw std::runtime_error("compact ticket cannot store app token");
+  }
+
+  std::string selfIdentity;
+  if (resState.serverCert) {
+    selfIdentity = resState.serverCert->getIdentity();
+  }
+  auto fingerprint = profileFingerprint(
+      resState.version, resState.cipher, resState.alpn, selfIdentity);
+
+  uint64_t ticketIssueTime = std::chrono::duration_cast<std::chrono::seconds>(
+                                 resState.ticketIssueTime.time_since_epoch())
+                                 .count();
+  uint64_t handshakeTime = std::chrono::duration_cast<std::chrono::seconds>(
+                               resState.handshakeTime.time_since_epoch())
+                               .count();
+
+  auto buf = folly::IOBuf::create(60);
+  folly::io::Appender appender(buf.get(), 60);
+  appender.push(fingerprint.data(), fingerprint.size());
+  fizz::detail::writeBuf<uint16_t>(resState.resumptionSecret, appender);
+  fizz::detail::write(resState.ticketAgeAdd, appender);
+  fizz::detail::write(ticketIssueTime, appender);
+  fizz::detail::write(handshakeTime, appender);
+  return buf;
+}
+
+ResumptionState CompactTicketCodec::decode(
+    Buf encoded,
+    const FizzServerContext* context) {
+  if (!context) {
+    throw std::runtime_error("compact ticket requires context");
+  }
+
+  folly::io::Cursor cursor(encoded.get());
+  Fingerprint fingerprint;
+  cursor.pull(fingerprint.data(), fingerprint.size());
+
+  ResumptionState resState;
+  fizz::detail::readBuf<uint16_t>(resState.resumptionSecret, cursor);
+  fizz::detail::read(resState.ticketAgeAdd, cursor);
+  uint64_t seconds;
+  fizz::detail::read(seconds, cursor);
+  resState.ticketIssueTime = std::chrono::time_point<std::chrono::system_clock>(
+      std::chrono::seconds(seconds));
+  fizz::detail::read(seconds, cursor);
+  resState.handshakeTime = std::chrono::time_point<std::chrono::system_clock>(
+      std::chrono::seconds(seconds));
+
+  // Reconstruct the profile from the context's primary preferences and
+  // check it against the fingerprint the ticket was issued under.
+  if (context->getSupportedVersions().empty() ||
+      context->getSupportedCiphers().empty() ||
+      context->getSupportedCiphers().front().empty()) {
+    throw std::runtime_error("context has no primary profile");
+  }
+  resState.version = context->getSupportedVersions().front();
+  resState.cipher = context->getSupportedCiphers().front().front();
+  if (!context->getSupportedAlpns().empty()) {
+    resState.alpn = context->getSupportedAlpns().front();
+  }
+  auto certMatch = context->getCert(folly::none, {});
+  if (certMatch) {
+    resState.serverCert = certMatch->first;
+  }
+
+  std::string selfIdentity;
+  if (resState.serverCert) {
+    selfIdentity = resState.serverCert->getIdentity();
+  }
+  auto expected = profileFingerprint(
+      resState.version, resState.cipher, resState.alpn, selfIdentity);
+  if (fingerprint != expected) {
+    throw std::runtime_error("compact ticket profile mismatch");
+  }
+
+  return resState;
+}
+} // namespace server
+} // namespace fizz
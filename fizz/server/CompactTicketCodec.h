@@ -0,0 +1,43 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/record/Types.h>
+#include <fizz/server/FizzServerContext.h>
+#include <fizz/server/ResumptionState.h>
+
+namespace fizz {
+namespace server {
+
+/**
+ * Minimal-state ticket codec for deployments where resumed connections
+ * carry no client certificate and no app token. Instead of serializing
+ * the negotiated version, cipher, ALPN and server cert identity, the
+ * ticket stores only the resumption secret, timestamps, ticket age add
+ * and an 8-byte fingerprint of the profile they were negotiated under.
+ * On decode the profile is reconstructed from the context's primary
+ * preferences; a fingerprint mismatch (config changed since issuance)
+ * rejects the ticket and falls back to a full handshake.
+ *
+ * encode() throws if the resumption state carries a client certificate
+ * or app token; use TicketCodec for those deployments.
+ */
+struct CompactTicketCodec {
+  /**
+   * This label can be used to derive the encryption key and should be changed
+   * whenever the encoding changes so previous tickets are invalidated.
+   */
+  static constexpr folly::StringPiece Label{"Fizz Compact Ticket Codec v1"};
+
+  static Buf encode(ResumptionState state);
+
+  static ResumptionState decode(Buf encoded, const FizzServerContext* context);
+};
+} // namespace server
+} // namespace fizz
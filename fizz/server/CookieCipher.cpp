@@ -8,6 +8,9 @@
 
 #include <fizz/server/CookieCipher.h>
 
+#include <limits>
+#include <map>
+
 #include <fizz/protocol/HandshakeContext.h>
 #include <fizz/record/Extensions.h>
 #include <fizz/server/Negotiator.h>
@@ -15,13 +18,11 @@
 namespace fizz {
 namespace server {
 
-Buf getStatelessHelloRetryRequest(
+static Buf encodeStatelessHelloRetryRequest(
     ProtocolVersion version,
     CipherSuite cipher,
     folly::Optional<NamedGroup> group,
     Buf cookie) {
-  Buf encodedHelloRetryRequest;
-
   HelloRetryRequest hrr;
   hrr.legacy_version = ProtocolVersion::tls_1_2;
   hrr.legacy_session_id_echo = folly::IOBuf::create(0);
@@ -44,6 +45,71 @@ Buf getStatelessHelloRetryRequest(
   return encodeHandshake(std::move(hrr));
 }
 
+Buf getStatelessHelloRetryRequest(
+    ProtocolVersion version,
+    CipherSuite cipher,
+    folly::Optional<NamedGroup> group,
+    Buf cookie) {
+  // For a given (version, cipher, group) the encoded message is constant
+  // except for the cookie payload and the length fields that depend on it
+  // (the session id echo is always empty, as the transcript is reconstructed
+  // with an empty echo). Cache the encoding with an empty cookie per thread
+  // and patch in the cookie, so the stateless retry path avoids full message
+  // construction under load.
+  static thread_local std::map<uint64_t, Buf> skeletonCache;
+  uint64_t key = (static_cast<uint64_t>(version) << 40) |
+      (static_cast<uint64_t>(cipher) << 24) |
+      (group ? (0x10000 | static_cast<uint64_t>(*group)) : 0);
+  auto it = skeletonCache.find(key);
+  if (it == skeletonCache.end()) {
+    auto skeleton = encodeStatelessHelloRetryRequest(
+        version, cipher, group, folly::IOBuf::create(0));
+    skeleton->coalesce();
+    it = skeletonCache.emplace(key, std::move(skeleton)).first;
+  }
+  const auto& skeleton = it->second;
+
+  // Offsets into the skeleton. The cookie extension is encoded last, so only
+  // length fields need patching: the handshake header length, the extensions
+  // length (after the version, random, empty session id echo, cipher and
+  // compression method), and the cookie extension and cookie lengths at the
+  // end of the skeleton.
+  static constexpr size_t kHandshakeLengthOffset = 1;
+  static constexpr size_t kExtensionsLengthOffset =
+      detail::kHandshakeHeaderSize + sizeof(ProtocolVersion) + sizeof(Random) +
+      sizeof(uint8_t) + sizeof(CipherSuite) + sizeof(uint8_t);
+  const size_t cookieExtensionLengthOffset = skeleton->length() - 4;
+  const size_t cookieLengthOffset = skeleton->length() - 2;
+
+  size_t cookieLen = cookie->computeChainDataLength();
+  size_t messageLen =
+      skeleton->length() - detail::kHandshakeHeaderSize + cookieLen;
+  detail::checkWithin24bits<size_t>(messageLen);
+
+  auto out = folly::IOBuf::copyBuffer(skeleton->data(), skeleton->length());
+  uint8_t* data = out->writableData();
+  auto patch16 = [data](size_t offset, size_t value) {
+    if (value > std::numeric_limits<uint16_t>::max()) {
+      throw std::runtime_error("Overflow 16 bit type");
+    }
+    data[offset] = static_cast<uint8_t>(value >> 8);
+    data[offset + 1] = static_cast<uint8_t>(value);
+  };
+
+  data[kHandshakeLengthOffset] = static_cast<uint8_t>(messageLen >> 16);
+  data[kHandshakeLengthOffset + 1] = static_cast<uint8_t>(messageLen >> 8);
+  data[kHandshakeLengthOffset + 2] = static_cast<uint8_t>(messageLen);
+  size_t extensionsLen =
+      (static_cast<size_t>(data[kExtensionsLengthOffset]) << 8) |
+      data[kExtensionsLengthOffset + 1];
+  patch16(kExtensionsLengthOffset, extensionsLen + cookieLen);
+  patch16(cookieExtensionLengthOffset, sizeof(uint16_t) + cookieLen);
+  patch16(cookieLengthOffset, cookieLen);
+
+  out->prependChain(std::move(cookie));
+  return out;
+}
+
 static folly::Optional<NamedGroup> getHrrGroup(
     const std::vector<NamedGroup>& supportedGroups,
     const ClientHello& chlo) {
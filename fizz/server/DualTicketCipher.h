@@ -9,6 +9,9 @@
 #pragma once
 
 #include <fizz/server/TicketCipher.h>
+#include <folly/io/Cursor.h>
+
+#include <atomic>
 
 namespace fizz {
 namespace server {
@@ -26,14 +29,92 @@ class DualTicketCipher : public TicketCipher {
       : cipher_(std::move(cipher)),
         fallbackCipher_(std::move(fallbackCipher)) {}
 
+  /**
+   * Sets one-byte format discriminators for the two ciphers. When set,
+   * tickets are prefixed with formatByte on encryption and decryption
+   * peeks at the first byte to route directly to the matching cipher
+   * instead of trial decrypting with both. Tickets without a recognized
+   * discriminator, or whose routed decryption fails (a pre-discriminator
+   * ticket may collide with a format byte), fall back to trying both
+   * ciphers, so tickets issued before the rollout keep resuming.
+   */
+  void setFormatBytes(uint8_t formatByte, uint8_t fallbackFormatByte) {
+    formatBytes_ = std::make_pair(formatByte, fallbackFormatByte);
+  }
+
+  uint64_t getPrimaryFormatHits() const {
+    return primaryFormatHits_.load();
+  }
+
+  uint64_t getFallbackFormatHits() const {
+    return fallbackFormatHits_.load();
+  }
+
+  uint64_t getUnrecognizedFormatHits() const {
+    return unrecognizedFormatHits_.load();
+  }
+
   folly::Future<folly::Optional<
       std::pair<std::unique_ptr<folly::IOBuf>, std::chrono::seconds>>>
   encrypt(ResumptionState resState) const override {
-    return cipher_->encrypt(std::move(resState));
+    if (!formatBytes_) {
+      return cipher_->encrypt(std::move(resState));
+    }
+    return cipher_->encrypt(std::move(resState))
+        .thenValue(
+            [formatByte = formatBytes_->first](
+                folly::Optional<std::pair<Buf, std::chrono::seconds>>
+                    ticket) {
+              if (ticket) {
+                auto header = folly::IOBuf::create(1);
+                header->writableData()[0] = formatByte;
+                header->append(1);
+                header->prependChain(std::move(ticket->first));
+                ticket->first = std::move(header);
+              }
+              return ticket;
+            });
   }
 
   folly::Future<std::pair<PskType, folly::Optional<ResumptionState>>> decrypt(
       std::unique_ptr<folly::IOBuf> encryptedTicket) const override {
+    if (formatBytes_) {
+      folly::io::Cursor cursor(encryptedTicket.get());
+      if (cursor.canAdvance(1)) {
+        auto formatByte = cursor.readBE<uint8_t>();
+        const TicketCipher* target = nullptr;
+        if (formatByte == formatBytes_->first) {
+          primaryFormatHits_++;
+          target = cipher_.get();
+        } else if (formatByte == formatBytes_->second) {
+          fallbackFormatHits_++;
+          target = fallbackCipher_.get();
+        } else {
+          unrecognizedFormatHits_++;
+        }
+        if (target) {
+          Buf inner;
+          cursor.clone(inner, cursor.totalLength());
+          auto ticket = std::move(encryptedTicket);
+          return target->decrypt(std::move(inner))
+              .thenValue(
+                  [this, ticket = std::move(ticket)](
+                      std::pair<PskType, folly::Optional<ResumptionState>>
+                          res) mutable {
+                    if (std::get<0>(res) == PskType::Rejected) {
+                      return tryBoth(std::move(ticket));
+                    }
+                    return folly::makeFuture(std::move(res));
+                  });
+        }
+      }
+    }
+    return tryBoth(std::move(encryptedTicket));
+  }
+
+ private:
+  folly::Future<std::pair<PskType, folly::Optional<ResumptionState>>> tryBoth(
+      std::unique_ptr<folly::IOBuf> encryptedTicket) const {
     auto bufClone = encryptedTicket->clone();
     return cipher_->decrypt(std::move(encryptedTicket))
         .thenValue([this, ticket = std::move(bufClone)](
@@ -46,9 +127,13 @@ class DualTicketCipher : public TicketCipher {
         });
   }
 
- private:
   std::unique_ptr<TicketCipher> cipher_;
   std::unique_ptr<TicketCipher> fallbackCipher_;
+
+  folly::Optional<std::pair<uint8_t, uint8_t>> formatBytes_;
+  mutable std::atomic<uint64_t> primaryFormatHits_{0};
+  mutable std::atomic<uint64_t> fallbackFormatHits_{0};
+  mutable std::atomic<uint64_t> unrecognizedFormatHits_{0};
 };
 } // namespace server
 } // namespace fizz
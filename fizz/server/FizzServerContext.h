@@ -8,6 +8,10 @@
 
 #pragma once
 
+#include <fizz/crypto/CpuFeatures.h>
+#include <fizz/crypto/Secret.h>
+#include <fizz/crypto/signature/BatchSignatureVerifier.h>
+#include <fizz/protocol/BufferMeter.h>
 #include <fizz/protocol/Certificate.h>
 #include <fizz/protocol/OpenSSLFactory.h>
 #include <fizz/protocol/clock/SystemClock.h>
@@ -15,9 +19,14 @@
 #include <fizz/server/CertManager.h>
 #include <fizz/server/CookieCipher.h>
 #include <fizz/server/Negotiator.h>
+#include <fizz/server/PeerCertCache.h>
 #include <fizz/server/ReplayCache.h>
 #include <fizz/server/TicketCipher.h>
 
+#include <folly/String.h>
+
+#include <unordered_map>
+
 namespace fizz {
 namespace server {
 
@@ -63,11 +72,21 @@ class FizzServerContext {
    */
   void setSupportedCiphers(std::vector<std::vector<CipherSuite>> ciphers) {
     supportedCiphers_ = std::move(ciphers);
+    cipherNegotiator_ = PrecomputedNegotiator<CipherSuite>(supportedCiphers_);
   }
   const auto& getSupportedCiphers() const {
     return supportedCiphers_;
   }
 
+  /**
+   * Negotiate a cipher suite given a client's offer, using precomputed
+   * preference ranks.
+   */
+  folly::Optional<CipherSuite> negotiateCipher(
+      const std::vector<CipherSuite>& clientCiphers) const {
+    return cipherNegotiator_(clientCiphers);
+  }
+
   /**
    * Set the supported signature schemes, in preference order.
    */
@@ -83,11 +102,21 @@ class FizzServerContext {
    */
   void setSupportedGroups(std::vector<NamedGroup> groups) {
     supportedGroups_ = std::move(groups);
+    groupNegotiator_ = PrecomputedNegotiator<NamedGroup>(supportedGroups_);
   }
   const auto& getSupportedGroups() const {
     return supportedGroups_;
   }
 
+  /**
+   * Negotiate a named group given a client's offer, using precomputed
+   * preference ranks.
+   */
+  folly::Optional<NamedGroup> negotiateGroup(
+      const std::vector<NamedGroup>& clientGroups) const {
+    return groupNegotiator_(clientGroups);
+  }
+
   /**
    * Set the supported psk modes, in preference order.
    */
@@ -126,6 +155,10 @@ class FizzServerContext {
    */
   void setSupportedAlpns(std::vector<std::string> protocols) {
     supportedAlpns_ = std::move(protocols);
+    alpnNegotiator_ = PrecomputedNegotiator<std::string>(supportedAlpns_);
+  }
+  const auto& getSupportedAlpns() const {
+    return supportedAlpns_;
   }
 
   /**
@@ -142,7 +175,7 @@ class FizzServerContext {
             supportedAlpns_.end()) {
       return zeroRttAlpn;
     }
-    return negotiate(supportedAlpns_, clientProtocols);
+    return alpnNegotiator_(clientProtocols);
   }
 
   /**
@@ -155,6 +188,52 @@ class FizzServerContext {
     return ticketCipher_.get();
   }
 
+  /**
+   * Registers a static external PSK accepted under the given identity,
+   * checked before the ticket cipher when resolving a client's offered
+   * PSK. The early secret for the PSK is computed once here and cached,
+   * so handshakes using it skip the early key schedule. The PSK is
+   * accepted for TLS 1.3 with the given cipher.
+   */
+  void putExternalPsk(
+      std::string identity,
+      std::string secret,
+      CipherSuite cipher) {
+    ExternalPsk psk;
+    psk.secret = std::move(secret);
+    psk.cipher = cipher;
+    auto scheduler = factory_->makeKeyScheduler(cipher);
+    scheduler->deriveEarlySecret(folly::range(psk.secret));
+    psk.earlySecret = scheduler->getEarlySecret();
+    externalPsks_[std::move(identity)] = std::move(psk);
+  }
+
+  /**
+   * Looks up an external PSK by identity, returning a ResumptionState
+   * carrying its cached early secret, or none if no PSK is registered
+   * under that identity.
+   */
+  folly::Optional<ResumptionState> getExternalPsk(
+      const Buf& identity) const {
+    if (externalPsks_.empty()) {
+      return folly::none;
+    }
+    auto it = externalPsks_.find(
+        identity->clone()->moveToFbString().toStdString());
+    if (it == externalPsks_.end()) {
+      return folly::none;
+    }
+    ResumptionState resState;
+    resState.version = ProtocolVersion::tls_1_3;
+    resState.cipher = it->second.cipher;
+    resState.resumptionSecret = folly::IOBuf::copyBuffer(it->second.secret);
+    resState.cachedEarlySecret = it->second.earlySecret;
+    resState.ticketAgeAdd = 0;
+    resState.ticketIssueTime = clock_->getCurrentTime();
+    resState.handshakeTime = clock_->getCurrentTime();
+    return resState;
+  }
+
   /**
    * Sets the cookie cipher to use. Stateless client retries will be rejected
    * if not set.
@@ -186,6 +265,36 @@ class FizzServerContext {
     return clientCertVerifier_;
   }
 
+  /**
+   * Sets an intern cache for client certificates. Repeat presentations
+   * of the same certificate then share one parsed PeerCert instead of
+   * constructing a fresh one per connection. Unset (the default), every
+   * connection builds its own.
+   */
+  void setClientCertCache(std::shared_ptr<PeerCertCache> cache) {
+    clientCertCache_ = std::move(cache);
+  }
+
+  const std::shared_ptr<PeerCertCache>& getClientCertCache() const {
+    return clientCertCache_;
+  }
+
+  /**
+   * Sets a batch verifier for client CertificateVerify signatures. When
+   * set, signatures are verified on the batch verifier's executor
+   * rather than inline on the IO thread, with bursts of handshakes
+   * amortized into shared executor tasks.
+   */
+  void setClientCertBatchVerifier(
+      std::shared_ptr<BatchSignatureVerifier> verifier) {
+    clientCertBatchVerifier_ = std::move(verifier);
+  }
+
+  const std::shared_ptr<BatchSignatureVerifier>& getClientCertBatchVerifier()
+      const {
+    return clientCertBatchVerifier_;
+  }
+
   /**
    * Chooses a certificate based on given sni and peer signature schemes.
    */
@@ -196,6 +305,20 @@ class FizzServerContext {
     return certManager_->getCert(sni, supportedSigSchemes_, peerSigSchemes);
   }
 
+  /**
+   * Chooses a delegated credential cert based on sni and the schemes the
+   * client advertised in its delegated_credential extension. Returns none
+   * if no credential the client can verify is available; callers fall
+   * back to getCert().
+   */
+  folly::Optional<std::pair<std::shared_ptr<SelfCert>, SignatureScheme>>
+  getDelegatedCert(
+      const folly::Optional<std::string>& sni,
+      const std::vector<SignatureScheme>& peerDcSigSchemes) const {
+    return certManager_->getDelegatedCert(
+        sni, supportedSigSchemes_, peerDcSigSchemes);
+  }
+
   /**
    * Return a certificate that matches identity. Will return nullptr if a
    * matching certificate is not found.
@@ -204,6 +327,19 @@ class FizzServerContext {
     return certManager_->getCert(identity);
   }
 
+  /**
+   * Returns the certificate message encoding with an OCSP staple in the
+   * leaf entry, or nullptr if no staple manager is attached to the cert
+   * manager or no unexpired staple is held for cert.
+   */
+  Buf getStapledCertMessage(const SelfCert& cert) const {
+    auto stapleManager = certManager_->getStapleManager();
+    if (!stapleManager) {
+      return nullptr;
+    }
+    return stapleManager->getStapledCertMessage(&cert);
+  }
+
   /**
    * Sets the early data settings.
    */
@@ -247,6 +383,32 @@ class FizzServerContext {
     return maxEarlyDataSize_;
   }
 
+  /**
+   * Bounds application data (in practice accepted early data) buffered on
+   * a connection before the application installs its read callback. Once
+   * exceeded, that connection's transport reads pause until the
+   * application drains the buffer. 0 leaves the transport default.
+   */
+  void setEarlyDataBufferLimit(size_t limit) {
+    earlyDataBufferLimit_ = limit;
+  }
+  size_t getEarlyDataBufferLimit() const {
+    return earlyDataBufferLimit_;
+  }
+
+  /**
+   * Shared meter bounding the aggregate of such buffered data across all
+   * connections using this context. Connections buffering while the meter
+   * is over its limit pause transport reads, so 0-RTT uploads can be
+   * enabled without provisioning for worst-case per-connection buffering.
+   */
+  void setEarlyDataBufferMeter(std::shared_ptr<BufferMeter> meter) {
+    earlyDataBufferMeter_ = std::move(meter);
+  }
+  const std::shared_ptr<BufferMeter>& getEarlyDataBufferMeter() const {
+    return earlyDataBufferMeter_;
+  }
+
   /**
    * Set the factory to use. Should generally only be changed for testing.
    */
@@ -271,6 +433,19 @@ class FizzServerContext {
     return sendNewSessionTicket_;
   }
 
+  /**
+   * Sets the number of NewSessionTickets issued per batch, letting clients
+   * that open parallel connections resume each one with a fresh ticket. The
+   * tickets are sealed together and written to the socket as one batch.
+   * Default is 1.
+   */
+  void setNumNewSessionTickets(uint32_t numTickets) {
+    numNewSessionTickets_ = numTickets;
+  }
+  uint32_t getNumNewSessionTickets() const {
+    return numNewSessionTickets_;
+  }
+
   /**
    * Set supported cert compression algorithms. Note: It is expected that any
    * certificate used has been initialized with compressors corresponding to the
@@ -284,6 +459,45 @@ class FizzServerContext {
     return supportedCompressionAlgos_;
   }
 
+  /**
+   * Sets a byte budget for the server's first flight (ServerHello through
+   * Finished). A flight larger than the initial congestion window costs
+   * the handshake an extra round trip, so when a budget is set the
+   * certificate compression algorithm is chosen to minimize the encoded
+   * certificate (using each cert's cached compression results) rather
+   * than by preference order; compression is skipped entirely if the
+   * plain encoding is smaller. The flight is always packed into maximal
+   * records, so content size is the only remaining lever. 0 (the
+   * default) disables budget-driven selection.
+   */
+  void setFirstFlightBudget(size_t budget) {
+    firstFlightBudget_ = budget;
+  }
+  size_t getFirstFlightBudget() const {
+    return firstFlightBudget_;
+  }
+
+  /**
+   * Reports the estimated first-flight wire size for a cert and
+   * compression algorithm combination using cached certificate
+   * encodings, allowing deployments to check configurations against
+   * their cwnd budget ahead of time. The non-certificate portion of the
+   * flight varies a few dozen bytes with the negotiated parameters and
+   * is deliberately estimated high.
+   */
+  size_t estimateFirstFlightSize(
+      const SelfCert& cert,
+      folly::Optional<CertificateCompressionAlgorithm> algo) const {
+    size_t certSize;
+    if (algo) {
+      certSize = encodeHandshake(cert.getCompressedCert(*algo))
+                     ->computeChainDataLength();
+    } else {
+      certSize = cert.getEncodedCertMessage()->computeChainDataLength();
+    }
+    return kFirstFlightFixedOverhead + certSize;
+  }
+
   /**
    * Whether to omit the early record layer when sending early data. This will
    * also omit the EndOfEarlyData message.
@@ -303,25 +517,113 @@ class FizzServerContext {
     return *clock_;
   }
 
+  /**
+   * Map of SNI to the context a matching connection should use instead
+   * of this one. Keys are lowercase hostnames; a key of the form
+   * "*.domain" matches any single leftmost label, as in CertManager.
+   */
+  using SniContextMap = std::unordered_map<
+      std::string,
+      std::shared_ptr<const FizzServerContext>>;
+
+  /**
+   * Sets per-SNI context overrides for multi-tenant termination. The
+   * ClientHello handler consults the table once, before negotiation,
+   * and runs the rest of the handshake under the matched context. The
+   * map is an immutable snapshot: to change routes, build a new map and
+   * set it again. Readers are wait-free and never block a setter.
+   */
+  void setSniContextOverrides(std::shared_ptr<const SniContextMap> overrides) {
+    std::atomic_store(&sniContextOverrides_, std::move(overrides));
+  }
+
+  bool hasSniContextOverrides() const {
+    return std::atomic_load(&sniContextOverrides_) != nullptr;
+  }
+
+  /**
+   * Returns the context override matching sni, or nullptr if none is
+   * configured. Exact matches are preferred over wildcard matches.
+   */
+  std::shared_ptr<const FizzServerContext> getContextForSni(
+      folly::StringPiece sni) const {
+    auto overrides = std::atomic_load(&sniContextOverrides_);
+    if (!overrides || overrides->empty()) {
+      return nullptr;
+    }
+    std::string key = sni.str();
+    folly::toLowerAscii(key);
+    auto it = overrides->find(key);
+    if (it != overrides->end()) {
+      return it->second;
+    }
+    auto dot = key.find('.');
+    if (dot != std::string::npos) {
+      it = overrides->find("*" + key.substr(dot));
+      if (it != overrides->end()) {
+        return it->second;
+      }
+    }
+    return nullptr;
+  }
+
+  /**
+   * Sets limits on the amount of traffic written under a single traffic key,
+   * as plaintext bytes and records. Once either limit is reached the state
+   * machine automatically sends a KeyUpdate and rotates its write key. A
+   * limit of 0 disables that limit; by default automatic rekeying is off.
+   * jitter (in [0, 1)) randomly lowers each connection's effective limits by
+   * up to that fraction so that connections do not rekey in lockstep.
+   */
+  void setRekeyAfterWriting(
+      uint64_t maxBytes,
+      uint64_t maxRecords,
+      double jitter = 0.0) {
+    rekeyAfterBytes_ = maxBytes;
+    rekeyAfterRecords_ = maxRecords;
+    rekeyJitter_ = jitter;
+  }
+  uint64_t getRekeyAfterBytes() const {
+    return rekeyAfterBytes_;
+  }
+  uint64_t getRekeyAfterRecords() const {
+    return rekeyAfterRecords_;
+  }
+  double getRekeyJitter() const {
+    return rekeyJitter_;
+  }
+
  private:
   std::shared_ptr<Factory> factory_;
 
   std::shared_ptr<TicketCipher> ticketCipher_;
+
+  struct ExternalPsk {
+    std::string secret;
+    CipherSuite cipher;
+    SecretStorage earlySecret;
+  };
+  std::unordered_map<std::string, ExternalPsk> externalPsks_;
   std::shared_ptr<CookieCipher> cookieCipher_;
 
   std::shared_ptr<CertManager> certManager_;
   std::shared_ptr<const CertificateVerifier> clientCertVerifier_;
+  std::shared_ptr<BatchSignatureVerifier> clientCertBatchVerifier_;
+  std::shared_ptr<PeerCertCache> clientCertCache_;
 
   std::vector<ProtocolVersion> supportedVersions_ = {ProtocolVersion::tls_1_3};
-  std::vector<std::vector<CipherSuite>> supportedCiphers_ = {
-      {
-          CipherSuite::TLS_AES_128_GCM_SHA256,
+  // The default preference order is adjusted for this CPU: without
+  // hardware AES support ChaCha is moved to the front of its tier.
+  std::vector<std::vector<CipherSuite>> supportedCiphers_ =
+      CpuFeatures::orderCiphers({
+          {
+              CipherSuite::TLS_AES_128_GCM_SHA256,
 #if FOLLY_OPENSSL_HAS_CHACHA
-          CipherSuite::TLS_CHACHA20_POLY1305_SHA256,
+              CipherSuite::TLS_CHACHA20_POLY1305_SHA256,
 #endif // FOLLY_OPENSSL_HAS_CHACHA
-      },
-      {CipherSuite::TLS_AES_256_GCM_SHA384},
-  };
+          },
+          {CipherSuite::TLS_AES_256_GCM_SHA384},
+      });
   std::vector<SignatureScheme> supportedSigSchemes_ = {
       SignatureScheme::ecdsa_secp256r1_sha256,
       SignatureScheme::rsa_pss_sha256};
@@ -332,22 +634,42 @@ class FizzServerContext {
       PskKeyExchangeMode::psk_ke};
   std::vector<std::string> supportedAlpns_;
 
+  PrecomputedNegotiator<CipherSuite> cipherNegotiator_{supportedCiphers_};
+  PrecomputedNegotiator<NamedGroup> groupNegotiator_{supportedGroups_};
+  PrecomputedNegotiator<std::string> alpnNegotiator_;
+
   bool versionFallbackEnabled_{false};
   ClientAuthMode clientAuthMode_{ClientAuthMode::None};
 
   bool acceptEarlyData_{false};
   uint32_t maxEarlyDataSize_{std::numeric_limits<uint32_t>::max()};
+  size_t earlyDataBufferLimit_{0};
+  std::shared_ptr<BufferMeter> earlyDataBufferMeter_;
   ClockSkewTolerance clockSkewTolerance_;
   std::shared_ptr<ReplayCache> replayCache_;
   std::shared_ptr<Clock> clock_ = std::make_shared<SystemClock>();
 
   std::vector<CertificateCompressionAlgorithm> supportedCompressionAlgos_;
 
+  // Estimated wire bytes for the non-certificate portion of the first
+  // flight: the plaintext ServerHello record plus the encrypted record
+  // overhead for EncryptedExtensions, CertificateVerify and Finished.
+  static constexpr size_t kFirstFlightFixedOverhead = 768;
+
+  size_t firstFlightBudget_{0};
+
   bool earlyDataFbOnly_{false};
 
   bool sendNewSessionTicket_{true};
+  uint32_t numNewSessionTickets_{1};
 
   bool omitEarlyRecordLayer_{false};
+
+  uint64_t rekeyAfterBytes_{0};
+  uint64_t rekeyAfterRecords_{0};
+  double rekeyJitter_{0.0};
+
+  std::shared_ptr<const SniContextMap> sniContextOverrides_;
 };
 } // namespace server
 } // namespace fizz
@@ -0,0 +1,76 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/server/FizzServerContext.h>
+#include <folly/Function.h>
+#include <folly/experimental/ReadMostlySharedPtr.h>
+
+#include <mutex>
+
+namespace fizz {
+namespace server {
+
+/**
+ * Publishes immutable FizzServerContext snapshots to accept threads.
+ *
+ * The context is already treated as immutable once handshakes start (it is
+ * shared as a pointer to const), but rotating certs, ticket ciphers or
+ * negotiation lists requires replacing the pointer everywhere it is held.
+ * This class adds a read-copy-update publication point: updates build a
+ * fresh context and swap it in atomically, and readers take their snapshot
+ * through a distributed reference count so concurrent accepts do not
+ * contend on a single atomic refcount.
+ *
+ * Handshakes keep the snapshot they started with; publishing never affects
+ * connections in flight.
+ */
+class FizzServerContextPublisher {
+ public:
+  explicit FizzServerContextPublisher(
+      std::shared_ptr<FizzServerContext> context)
+      : context_(std::move(context)) {}
+
+  /**
+   * Returns the current snapshot. The snapshot remains valid after a
+   * subsequent publish for as long as the returned pointer is held.
+   */
+  folly::ReadMostlySharedPtr<FizzServerContext> getContext() const {
+    return context_.getShared();
+  }
+
+  /**
+   * Atomically publishes a new context. The context must not be modified
+   * after it is published.
+   */
+  void publishContext(std::shared_ptr<FizzServerContext> context) {
+    std::lock_guard<std::mutex> guard(publishMutex_);
+    context_.reset(std::move(context));
+  }
+
+  /**
+   * Copies the current snapshot, applies modify to the copy, and atomically
+   * publishes the result. This is the convenient way to hot-swap a single
+   * setting (for example a rotated ticket cipher) without draining accept
+   * threads.
+   */
+  void updateContext(folly::Function<void(FizzServerContext&)> modify) {
+    std::lock_guard<std::mutex> guard(publishMutex_);
+    auto newContext =
+        std::make_shared<FizzServerContext>(*context_.getShared());
+    modify(*newContext);
+    context_.reset(std::move(newContext));
+  }
+
+ private:
+  mutable std::mutex publishMutex_;
+  folly::ReadMostlyMainPtr<FizzServerContext> context_;
+};
+} // namespace server
+} // namespace fizz
@@ -0,0 +1,131 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/server/HandshakePoolAcceptor.h>
+
+namespace fizz {
+namespace server {
+
+namespace {
+
+// Drives one handshake on its handshake event base and migrates the
+// established session to the target event base. Owns itself and is
+// deleted once the callback has been scheduled.
+class HandshakeDriver : public AsyncFizzServer::HandshakeCallback {
+ public:
+  HandshakeDriver(
+      folly::EventBase* handshakeEvb,
+      folly::EventBase* targetEvb,
+      HandshakePoolAcceptor::AcceptCallback* callback,
+      std::shared_ptr<const FizzServerContext> context,
+      std::shared_ptr<ServerExtensions> extensions)
+      : handshakeEvb_(handshakeEvb),
+        targetEvb_(targetEvb),
+        callback_(callback),
+        context_(std::move(context)),
+        extensions_(std::move(extensions)) {}
+
+  void start(folly::AsyncTransportWrapper::UniquePtr socket) {
+    socket->attachEventBase(handshakeEvb_);
+    server_.reset(
+        new AsyncFizzServer(std::move(socket), context_, extensions_));
+    server_->accept(this);
+  }
+
+  void fizzHandshakeSuccess(AsyncFizzServer* /*server*/) noexcept override {
+    // The state machine is still flushing the actions that reported
+    // success; migrate once this event has been fully processed.
+    handshakeEvb_->runInLoop([this] { migrate(); }, true /* thisIteration */);
+  }
+
+  void fizzHandshakeError(
+      AsyncFizzServer* /*server*/,
+      folly::exception_wrapper ex) noexcept override {
+    deliverError(std::move(ex));
+  }
+
+  void fizzHandshakeAttemptFallback(
+      std::unique_ptr<folly::IOBuf> /*clientHello*/) override {
+    deliverError(folly::make_exception_wrapper<FizzException>(
+        "fallback not supported on handshake pool", folly::none));
+  }
+
+ private:
+  void migrate() noexcept {
+    if (!server_->good()) {
+      deliverError(folly::make_exception_wrapper<FizzException>(
+          "connection failed before migration", folly::none));
+      return;
+    }
+    if (!server_->sessionStateExtractable() || !server_->isDetachable()) {
+      // A record straddling handshake completion is still in flight; poll
+      // until the transport quiesces rather than spinning the loop.
+      handshakeEvb_->runAfterDelay([this] { migrate(); }, 1);
+      return;
+    }
+
+    auto state = server_->extractSessionState();
+    auto socket = server_->extractTransport();
+    server_.reset();
+    socket->detachEventBase();
+
+    targetEvb_->runInEventBaseThread(
+        [callback = callback_,
+         targetEvb = targetEvb_,
+         context = std::move(context_),
+         extensions = std::move(extensions_),
+         state = std::move(state),
+         socket = std::move(socket)]() mutable {
+          socket->attachEventBase(targetEvb);
+          AsyncFizzServer::UniquePtr server(new AsyncFizzServer(
+              std::move(socket), context, std::move(state), extensions));
+          callback->connectionReady(std::move(server));
+        });
+    delete this;
+  }
+
+  void deliverError(folly::exception_wrapper ex) {
+    server_.reset();
+    targetEvb_->runInEventBaseThread(
+        [callback = callback_, ex = std::move(ex)]() mutable {
+          callback->connectionError(std::move(ex));
+        });
+    delete this;
+  }
+
+  folly::EventBase* handshakeEvb_;
+  folly::EventBase* targetEvb_;
+  HandshakePoolAcceptor::AcceptCallback* callback_;
+  std::shared_ptr<const FizzServerContext> context_;
+  std::shared_ptr<ServerExtensions> extensions_;
+  AsyncFizzServer::UniquePtr server_;
+};
+} // namespace
+
+HandshakePoolAcceptor::HandshakePoolAcceptor(
+    std::vector<folly::EventBase*> handshakeEvbs,
+    std::shared_ptr<const FizzServerContext> context)
+    : handshakeEvbs_(std::move(handshakeEvbs)), context_(std::move(context)) {
+  CHECK(!handshakeEvbs_.empty());
+}
+
+void HandshakePoolAcceptor::accept(
+    folly::AsyncTransportWrapper::UniquePtr socket,
+    folly::EventBase* targetEvb,
+    AcceptCallback* callback,
+    std::shared_ptr<ServerExtensions> extensions) {
+  auto evb = handshakeEvbs_
+      [next_.fetch_add(1, std::memory_order_relaxed) % handshakeEvbs_.size()];
+  auto driver = new HandshakeDriver(
+      evb, targetEvb, callback, context_, std::move(extensions));
+  evb->runInEventBaseThread([driver, socket = std::move(socket)]() mutable {
+    driver->start(std::move(socket));
+  });
+}
+} // namespace server
+} // namespace fizz
@@ -0,0 +1,70 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/server/AsyncFizzServer.h>
+
+#include <atomic>
+#include <vector>
+
+namespace fizz {
+namespace server {
+
+/**
+ * Accepts fizz handshakes on a pool of dedicated handshake event bases
+ * and hands off fully established connections to a caller-chosen worker
+ * event base. Handshake crypto never runs on the worker threads, so a
+ * burst of accepts does not add tail latency to established sessions.
+ *
+ * The handshake event bases and their threads are owned by the caller
+ * and must outlive the acceptor and any in-flight handshakes.
+ */
+class HandshakePoolAcceptor {
+ public:
+  class AcceptCallback {
+   public:
+    virtual ~AcceptCallback() = default;
+
+    /**
+     * Called on the target event base with an established connection
+     * attached to it.
+     */
+    virtual void connectionReady(
+        AsyncFizzServer::UniquePtr transport) noexcept = 0;
+
+    /**
+     * Called on the target event base if the handshake did not complete.
+     */
+    virtual void connectionError(folly::exception_wrapper ex) noexcept = 0;
+  };
+
+  HandshakePoolAcceptor(
+      std::vector<folly::EventBase*> handshakeEvbs,
+      std::shared_ptr<const FizzServerContext> context);
+
+  /**
+   * Starts a handshake on the next handshake event base, round robin.
+   * The socket must not be attached to an event base; it is attached to
+   * a handshake thread for the duration of the handshake and reattached
+   * to targetEvb before the callback fires. May be called from any
+   * thread. The callback must remain valid until it fires.
+   */
+  void accept(
+      folly::AsyncTransportWrapper::UniquePtr socket,
+      folly::EventBase* targetEvb,
+      AcceptCallback* callback,
+      std::shared_ptr<ServerExtensions> extensions = nullptr);
+
+ private:
+  std::vector<folly::EventBase*> handshakeEvbs_;
+  std::shared_ptr<const FizzServerContext> context_;
+  std::atomic<uint64_t> next_{0};
+};
+} // namespace server
+} // namespace fizz
@@ -9,9 +9,12 @@
 #pragma once
 
 #include <algorithm>
+#include <limits>
+#include <unordered_map>
 #include <vector>
 
 #include <folly/Optional.h>
+#include <folly/hash/Hash.h>
 
 namespace fizz {
 namespace server {
@@ -59,5 +62,52 @@ folly::Optional<T> negotiate(
   }
   return folly::none;
 }
+
+/**
+ * Negotiator with the server's preference ranks precomputed. Returns the
+ * same results as negotiate() over the same preferences, but each
+ * negotiation is a single pass over the client's list with O(1) rank
+ * lookups instead of nested scans of the preference tiers. Intended to be
+ * built once at config time and reused for every handshake.
+ */
+template <typename T>
+class PrecomputedNegotiator {
+ public:
+  PrecomputedNegotiator() = default;
+
+  explicit PrecomputedNegotiator(
+      const std::vector<std::vector<T>>& serverPref) {
+    for (size_t tier = 0; tier < serverPref.size(); tier++) {
+      for (const auto& pref : serverPref[tier]) {
+        ranks_.emplace(pref, tier);
+      }
+    }
+  }
+
+  explicit PrecomputedNegotiator(const std::vector<T>& serverPref) {
+    for (size_t rank = 0; rank < serverPref.size(); rank++) {
+      ranks_.emplace(serverPref[rank], rank);
+    }
+  }
+
+  folly::Optional<T> operator()(const std::vector<T>& clientPref) const {
+    folly::Optional<T> best;
+    size_t bestRank = std::numeric_limits<size_t>::max();
+    for (const auto& pref : clientPref) {
+      auto rank = ranks_.find(pref);
+      if (rank != ranks_.end() && rank->second < bestRank) {
+        bestRank = rank->second;
+        best = pref;
+        if (bestRank == 0) {
+          break;
+        }
+      }
+    }
+    return best;
+  }
+
+ private:
+  std::unordered_map<T, size_t, folly::Hash> ranks_;
+};
 } // namespace server
 } // namespace fizz
@@ -0,0 +1,143 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/server/OcspStapleManager.h>
+
+#include <fizz/record/Extensions.h>
+
+namespace fizz {
+namespace server {
+
+// How long to wait before retrying after a failed fetch.
+static constexpr std::chrono::minutes kFetchRetryInterval{5};
+
+// Floor between refreshes, so a responder handing back short-lived or
+// already-stale responses cannot turn the refresh thread into a spin.
+static constexpr std::chrono::seconds kMinRefreshInterval{30};
+
+OcspStapleManager::OcspStapleManager(
+    Fetcher fetcher,
+    std::chrono::seconds refreshMargin)
+    : fetcher_(std::move(fetcher)), refreshMargin_(refreshMargin) {
+  thread_ = std::thread([this]() { refreshThread(); });
+}
+
+OcspStapleManager::~OcspStapleManager() {
+  {
+    std::lock_guard<std::mutex> guard(threadMutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  thread_.join();
+}
+
+void OcspStapleManager::addCert(std::shared_ptr<const SelfCert> cert) {
+  auto key = cert.get();
+  Entry entry;
+  entry.cert = std::move(cert);
+  entry.nextRefresh = std::chrono::system_clock::time_point::min();
+  entries_.wlock()->emplace(key, std::move(entry));
+  {
+    std::lock_guard<std::mutex> guard(threadMutex_);
+    wakeup_ = true;
+  }
+  cv_.notify_all();
+}
+
+Buf OcspStapleManager::getStapledCertMessage(const SelfCert* cert) const {
+  auto entries = entries_.rlock();
+  auto it = entries->find(cert);
+  if (it == entries->end() || !it->second.encodedCertMessage ||
+      std::chrono::system_clock::now() >= it->second.expiry) {
+    return nullptr;
+  }
+  return it->second.encodedCertMessage->clone();
+}
+
+void OcspStapleManager::refreshNow() {
+  auto now = std::chrono::system_clock::now();
+  std::vector<std::shared_ptr<const SelfCert>> due;
+  entries_.withRLock([&](const auto& entries) {
+    for (const auto& entry : entries) {
+      if (entry.second.nextRefresh <= now) {
+        due.push_back(entry.second.cert);
+      }
+    }
+  });
+
+  // Fetching may block on the network, so it runs outside the lock and
+  // the results are folded back in afterwards.
+  for (const auto& cert : due) {
+    auto staple = fetcher_(*cert);
+    Buf encoded;
+    if (staple) {
+      auto msg = cert->getCertMessage();
+      if (msg.certificate_list.empty()) {
+        staple = folly::none;
+      } else {
+        CertificateStatus status;
+        status.response = std::move(staple->response);
+        msg.certificate_list.front().extensions.push_back(
+            encodeExtension(status));
+        encoded = encodeHandshake(std::move(msg));
+      }
+    }
+
+    entries_.withWLock([&](auto& entries) {
+      auto it = entries.find(cert.get());
+      if (it == entries.end()) {
+        return;
+      }
+      if (staple) {
+        it->second.encodedCertMessage = std::move(encoded);
+        it->second.expiry = staple->expiry;
+        it->second.nextRefresh = std::max(
+            staple->expiry - refreshMargin_,
+            std::chrono::system_clock::now() + kMinRefreshInterval);
+      } else {
+        it->second.nextRefresh =
+            std::chrono::system_clock::now() + kFetchRetryInterval;
+      }
+    });
+  }
+}
+
+folly::Optional<std::chrono::system_clock::time_point>
+OcspStapleManager::nextRefreshTime() const {
+  folly::Optional<std::chrono::system_clock::time_point> next;
+  entries_.withRLock([&](const auto& entries) {
+    for (const auto& entry : entries) {
+      if (!next || entry.second.nextRefresh < *next) {
+        next = entry.second.nextRefresh;
+      }
+    }
+  });
+  return next;
+}
+
+void OcspStapleManager::refreshThread() {
+  std::unique_lock<std::mutex> lock(threadMutex_);
+  while (!stop_) {
+    lock.unlock();
+    refreshNow();
+    auto next = nextRefreshTime();
+    lock.lock();
+    if (stop_) {
+      break;
+    }
+    auto woken = [this]() { return stop_ || wakeup_; };
+    if (next) {
+      cv_.wait_until(lock, *next, woken);
+    } else {
+      cv_.wait(lock, woken);
+    }
+    wakeup_ = false;
+  }
+}
+} // namespace server
+} // namespace fizz
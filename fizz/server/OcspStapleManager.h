@@ -0,0 +1,104 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <thread>
+#include <unordered_map>
+
+#include <fizz/protocol/Certificate.h>
+#include <folly/Function.h>
+#include <folly/Synchronized.h>
+
+namespace fizz {
+namespace server {
+
+/**
+ * Holds a DER OCSP response per certificate and refreshes it on a
+ * background thread before it expires. For each cert the manager caches
+ * the full handshake encoding of the certificate message with the staple
+ * in the leaf entry's status_request extension, rebuilt only when the
+ * response changes, so serving a staple costs a lookup and a clone on the
+ * handshake path.
+ *
+ * Responses are obtained through a caller-supplied fetcher (typically an
+ * OCSP HTTP client), which is invoked from the background thread and may
+ * block. A fetch failure keeps any previously held response until its
+ * expiry and retries later.
+ */
+class OcspStapleManager {
+ public:
+  struct Staple {
+    Buf response;
+    std::chrono::system_clock::time_point expiry;
+  };
+
+  /**
+   * Fetches a fresh OCSP response for a cert, returning none on failure.
+   * The expiry should come from the response's nextUpdate field.
+   */
+  using Fetcher =
+      folly::Function<folly::Optional<Staple>(const SelfCert& cert)>;
+
+  /**
+   * refreshMargin is how long before a response's expiry the refresh is
+   * attempted.
+   */
+  explicit OcspStapleManager(
+      Fetcher fetcher,
+      std::chrono::seconds refreshMargin = std::chrono::hours(1));
+
+  ~OcspStapleManager();
+
+  /**
+   * Registers a cert for stapling. The first fetch happens on the
+   * background thread; until it succeeds getStapledCertMessage() returns
+   * nullptr for the cert.
+   */
+  void addCert(std::shared_ptr<const SelfCert> cert);
+
+  /**
+   * Returns the handshake encoding of the cert's certificate message with
+   * the current staple, or nullptr if the cert is unknown or no unexpired
+   * response is held.
+   */
+  Buf getStapledCertMessage(const SelfCert* cert) const;
+
+  /**
+   * Runs one synchronous refresh pass over all certs that are due,
+   * invoking the fetcher inline. The background thread uses this; it is
+   * public so tests and callers that want a staple before serving can
+   * force a fetch.
+   */
+  void refreshNow();
+
+ private:
+  struct Entry {
+    std::shared_ptr<const SelfCert> cert;
+    Buf encodedCertMessage;
+    std::chrono::system_clock::time_point expiry;
+    std::chrono::system_clock::time_point nextRefresh;
+  };
+
+  void refreshThread();
+  folly::Optional<std::chrono::system_clock::time_point> nextRefreshTime()
+      const;
+
+  Fetcher fetcher_;
+  std::chrono::seconds refreshMargin_;
+  folly::Synchronized<std::unordered_map<const SelfCert*, Entry>> entries_;
+
+  std::mutex threadMutex_;
+  std::condition_variable cv_;
+  bool stop_{false};
+  bool wakeup_{false};
+  std::thread thread_;
+};
+} // namespace server
+} // namespace fizz
@@ -0,0 +1,54 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/server/PeerCertCache.h>
+
+#include <fizz/crypto/Sha256.h>
+
+namespace fizz {
+namespace server {
+
+namespace {
+std::string certDigest(const folly::IOBuf& der) {
+  Sha256 hasher;
+  hasher.hash_init();
+  hasher.hash_update(der);
+  std::array<uint8_t, Sha256::HashLen> digest;
+  hasher.hash_final(folly::MutableByteRange(digest.data(), digest.size()));
+  return std::string(
+      reinterpret_cast<const char*>(digest.data()), digest.size());
+}
+} // namespace
+
+PeerCertCache::PeerCertCache(size_t maxEntries, std::chrono::milliseconds ttl)
+    : ttl_(ttl),
+      cache_(folly::EvictingCacheMap<std::string, Entry>(maxEntries)) {}
+
+std::shared_ptr<const PeerCert> PeerCertCache::get(const folly::IOBuf& der) {
+  auto key = certDigest(der);
+  auto cache = cache_.wlock();
+  auto it = cache->find(key);
+  if (it == cache->end()) {
+    return nullptr;
+  }
+  if (std::chrono::steady_clock::now() >= it->second.expiry) {
+    cache->erase(it);
+    return nullptr;
+  }
+  return it->second.cert;
+}
+
+void PeerCertCache::put(
+    const folly::IOBuf& der,
+    std::shared_ptr<const PeerCert> cert) {
+  auto expiry = std::chrono::steady_clock::now() + ttl_;
+  cache_.wlock()->set(certDigest(der), Entry{std::move(cert), expiry});
+}
+
+} // namespace server
+} // namespace fizz
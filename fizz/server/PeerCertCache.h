@@ -0,0 +1,58 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+
+#include <fizz/protocol/Certificate.h>
+
+#include <folly/Synchronized.h>
+#include <folly/container/EvictingCacheMap.h>
+
+namespace fizz {
+namespace server {
+
+/**
+ * Intern table for peer certificates, keyed by a digest of the DER
+ * encoding. A service mesh presents the same few hundred client certs
+ * millions of times, so repeat presentations can share one parsed
+ * PeerCert instead of constructing a fresh one per connection.
+ *
+ * Entries expire after the configured TTL so revoked or rotated
+ * certificates do not pin stale objects, and the least recently used
+ * entry is evicted at capacity. Install via
+ * FizzServerContext::setClientCertCache.
+ */
+class PeerCertCache {
+ public:
+  PeerCertCache(size_t maxEntries, std::chrono::milliseconds ttl);
+
+  /**
+   * Returns the interned cert for this encoding, or nullptr if absent
+   * or expired.
+   */
+  std::shared_ptr<const PeerCert> get(const folly::IOBuf& der);
+
+  /**
+   * Interns a cert under its encoding's digest.
+   */
+  void put(const folly::IOBuf& der, std::shared_ptr<const PeerCert> cert);
+
+ private:
+  struct Entry {
+    std::shared_ptr<const PeerCert> cert;
+    std::chrono::steady_clock::time_point expiry;
+  };
+
+  std::chrono::milliseconds ttl_;
+  folly::Synchronized<folly::EvictingCacheMap<std::string, Entry>> cache_;
+};
+
+} // namespace server
+} // namespace fizz
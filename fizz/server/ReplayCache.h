@@ -11,6 +11,8 @@
 #include <folly/Range.h>
 #include <folly/futures/Future.h>
 
+#include <vector>
+
 namespace fizz {
 namespace server {
 
@@ -36,6 +38,23 @@ class ReplayCache {
 
   virtual folly::Future<ReplayCacheResult> check(
       folly::ByteRange identifier) = 0;
+
+  /**
+   * Checks a batch of identifiers in one call. The default implementation
+   * issues an individual check() per identifier; backends with per-call
+   * overhead (remote or cross-thread) should override this to dispatch the
+   * whole batch at once. The identifier memory must remain valid until the
+   * returned future completes.
+   */
+  virtual folly::Future<std::vector<ReplayCacheResult>> checkBatch(
+      const std::vector<folly::ByteRange>& identifiers) {
+    std::vector<folly::Future<ReplayCacheResult>> results;
+    results.reserve(identifiers.size());
+    for (const auto& identifier : identifiers) {
+      results.push_back(check(identifier));
+    }
+    return folly::collect(std::move(results));
+  }
 };
 
 /**
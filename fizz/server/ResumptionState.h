@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <fizz/crypto/Secret.h>
 #include <fizz/protocol/Certificate.h>
 #include <fizz/protocol/Types.h>
 #include <fizz/record/Types.h>
@@ -28,6 +29,11 @@ struct ResumptionState {
   std::chrono::system_clock::time_point ticketIssueTime;
   Buf appToken;
   std::chrono::system_clock::time_point handshakeTime;
+
+  // Early secret precomputed at configuration time for static external
+  // PSKs; empty for ticket-based resumption. When set, the handshake
+  // seeds the key scheduler with it instead of rederiving it.
+  SecretStorage cachedEarlySecret;
 };
 } // namespace server
 } // namespace fizz
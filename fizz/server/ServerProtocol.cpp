@@ -8,10 +8,13 @@
 
 #include <fizz/server/ServerProtocol.h>
 
-#include <fizz/crypto/Utils.h>
+#include <fizz/crypto/exchange/AsyncKeyExchange.h>
+#include <fizz/protocol/AsyncCertificateVerifier.h>
 #include <fizz/protocol/CertificateVerifier.h>
+#include <fizz/protocol/Instrumentation.h>
 #include <fizz/protocol/Protocol.h>
 #include <fizz/protocol/StateMachine.h>
+#include <fizz/protocol/TlsMetrics.h>
 #include <fizz/record/Extensions.h>
 #include <fizz/record/PlaintextRecordLayer.h>
 #include <fizz/server/AsyncSelfCert.h>
@@ -116,6 +119,12 @@ FIZZ_DECLARE_EVENT_HANDLER(
     Event::KeyUpdate,
     StateEnum::AcceptingData);
 
+FIZZ_DECLARE_EVENT_HANDLER(
+    ServerTypes,
+    StateEnum::AcceptingData,
+    Event::KeyUpdateInitiation,
+    StateEnum::AcceptingData);
+
 FIZZ_DECLARE_EVENT_HANDLER(
     ServerTypes,
     StateEnum::AcceptingData,
@@ -154,10 +163,23 @@ AsyncActions ServerStateMachine::processSocketData(
           folly::none);
     }
     auto param = state.readRecordLayer()->readEvent(buf);
-    if (!param.hasValue()) {
+    if (param.hasError()) {
+      const auto& error = param.error();
+      return detail::handleError(
+          state,
+          ReportError(folly::make_exception_wrapper<FizzException>(
+              folly::to<std::string>(
+                  "error decoding record in state ",
+                  toString(state.state()),
+                  ": ",
+                  error.message),
+              error.alert)),
+          error.alert);
+    }
+    if (!param->hasValue()) {
       return actions(WaitForData());
     }
-    return detail::processEvent(state, std::move(*param));
+    return detail::processEvent(state, std::move(**param));
   } catch (const FizzException& e) {
     return detail::handleError(
         state,
@@ -195,6 +217,12 @@ AsyncActions ServerStateMachine::processEarlyAppWrite(
   return detail::processEvent(state, std::move(write));
 }
 
+AsyncActions ServerStateMachine::processKeyUpdateInitiation(
+    const State& state,
+    KeyUpdateInitiation keyUpdateInitiation) {
+  return detail::processEvent(state, std::move(keyUpdateInitiation));
+}
+
 Actions ServerStateMachine::processAppClose(const State& state) {
   return detail::handleAppClose(state);
 }
@@ -206,7 +234,7 @@ Actions ServerStateMachine::processAppCloseImmediate(const State& state) {
 namespace detail {
 
 AsyncActions processEvent(const State& state, Param param) {
-  auto event = boost::apply_visitor(EventVisitor(), param);
+  auto event = getEvent(param);
   // We can have an exception directly in the handler or in a future so we need
   // to handle both types.
   try {
@@ -253,6 +281,9 @@ Actions handleError(
   if (state.state() == StateEnum::Error) {
     return actions();
   }
+  if (state.state() != StateEnum::AcceptingData) {
+    TlsMetricsRegistry::local().handshakeErrors++;
+  }
   auto transition = [](State& newState) {
     newState.state() = StateEnum::Error;
     newState.writeRecordLayer() = nullptr;
@@ -375,8 +406,9 @@ EventHandler<ServerTypes, StateEnum::Uninitialized, Event::Accept>::handle(
 
 static void addHandshakeLogging(const State& state, const ClientHello& chlo) {
   if (state.handshakeLogging()) {
+    ExtensionIndex extensionIndex(chlo.extensions);
     state.handshakeLogging()->clientLegacyVersion = chlo.legacy_version;
-    auto supportedVersions = getExtension<SupportedVersions>(chlo.extensions);
+    auto supportedVersions = extensionIndex.getExtension<SupportedVersions>();
     if (supportedVersions) {
       state.handshakeLogging()->clientSupportedVersions =
           supportedVersions->versions;
@@ -393,19 +425,19 @@ static void addHandshakeLogging(const State& state, const ClientHello& chlo) {
       state.handshakeLogging()->clientRecordVersion =
           plaintextReadRecord->getReceivedRecordVersion();
     }
-    auto sni = getExtension<ServerNameList>(chlo.extensions);
+    auto sni = extensionIndex.getExtension<ServerNameList>();
     if (sni && !sni->server_name_list.empty()) {
       state.handshakeLogging()->clientSni = sni->server_name_list.front()
                                                 .hostname->moveToFbString()
                                                 .toStdString();
     }
-    auto supportedGroups = getExtension<SupportedGroups>(chlo.extensions);
+    auto supportedGroups = extensionIndex.getExtension<SupportedGroups>();
     if (supportedGroups) {
       state.handshakeLogging()->clientSupportedGroups =
           std::move(supportedGroups->named_group_list);
     }
 
-    auto keyShare = getExtension<ClientKeyShare>(chlo.extensions);
+    auto keyShare = extensionIndex.getExtension<ClientKeyShare>();
     if (keyShare && !state.handshakeLogging()->clientKeyShares) {
       std::vector<NamedGroup> shares;
       for (const auto& entry : keyShare->client_shares) {
@@ -414,13 +446,13 @@ static void addHandshakeLogging(const State& state, const ClientHello& chlo) {
       state.handshakeLogging()->clientKeyShares = std::move(shares);
     }
 
-    auto exchangeModes = getExtension<PskKeyExchangeModes>(chlo.extensions);
+    auto exchangeModes = extensionIndex.getExtension<PskKeyExchangeModes>();
     if (exchangeModes) {
       state.handshakeLogging()->clientKeyExchangeModes =
           std::move(exchangeModes->modes);
     }
 
-    auto clientSigSchemes = getExtension<SignatureAlgorithms>(chlo.extensions);
+    auto clientSigSchemes = extensionIndex.getExtension<SignatureAlgorithms>();
     if (clientSigSchemes) {
       state.handshakeLogging()->clientSignatureAlgorithms =
           std::move(clientSigSchemes->supported_signature_algorithms);
@@ -511,8 +543,7 @@ struct ResumptionStateResult {
 
 static ResumptionStateResult getResumptionState(
     const ClientHello& chlo,
-    const TicketCipher* ticketCipher,
-    const std::vector<PskKeyExchangeMode>& supportedModes) {
+    const FizzServerContext& context) {
   auto psks = getExtension<ClientPresharedKey>(chlo.extensions);
   auto clientModes = getExtension<PskKeyExchangeModes>(chlo.extensions);
   if (psks && !clientModes) {
@@ -521,7 +552,7 @@ static ResumptionStateResult getResumptionState(
 
   Optional<PskKeyExchangeMode> pskMode;
   if (clientModes) {
-    pskMode = negotiate(supportedModes, clientModes->modes);
+    pskMode = negotiate(context.getSupportedPskModes(), clientModes->modes);
   }
   if (!psks && !pskMode) {
     return ResumptionStateResult(
@@ -529,21 +560,33 @@ static ResumptionStateResult getResumptionState(
   } else if (!psks || psks->identities.size() <= kPskIndex) {
     return ResumptionStateResult(
         std::make_pair(PskType::NotAttempted, folly::none));
-  } else if (!ticketCipher) {
-    VLOG(8) << "No ticket cipher, rejecting PSK.";
-    return ResumptionStateResult(
-        std::make_pair(PskType::Rejected, folly::none));
   } else if (!pskMode) {
     VLOG(8) << "No psk mode match, rejecting PSK.";
     return ResumptionStateResult(
         std::make_pair(PskType::Rejected, folly::none));
-  } else {
-    const auto& ident = psks->identities[kPskIndex].psk_identity;
+  }
+
+  const auto& ident = psks->identities[kPskIndex].psk_identity;
+
+  // Registered external PSKs take precedence over the ticket cipher.
+  auto externalPsk = context.getExternalPsk(ident);
+  if (externalPsk) {
     return ResumptionStateResult(
-        ticketCipher->decrypt(ident->clone()),
+        std::make_pair(PskType::External, std::move(externalPsk)),
         pskMode,
         psks->identities[kPskIndex].obfuscated_ticket_age);
   }
+
+  auto ticketCipher = context.getTicketCipher();
+  if (!ticketCipher) {
+    VLOG(8) << "No ticket cipher, rejecting PSK.";
+    return ResumptionStateResult(
+        std::make_pair(PskType::Rejected, folly::none));
+  }
+  return ResumptionStateResult(
+      ticketCipher->decrypt(ident->clone()),
+      pskMode,
+      psks->identities[kPskIndex].obfuscated_ticket_age);
 }
 
 Future<ReplayCacheResult> getReplayCacheResult(
@@ -578,8 +621,8 @@ static bool validateResumptionState(
 
 static CipherSuite negotiateCipher(
     const ClientHello& chlo,
-    const std::vector<std::vector<CipherSuite>>& supportedCiphers) {
-  auto cipher = negotiate(supportedCiphers, chlo.cipher_suites);
+    const FizzServerContext& context) {
+  auto cipher = context.negotiateCipher(chlo.cipher_suites);
   if (!cipher) {
     throw FizzException("no cipher match", AlertDescription::handshake_failure);
   }
@@ -615,11 +658,8 @@ static std::
           "cookie after statefull hrr", AlertDescription::illegal_parameter);
     }
 
-    handshakeContext = factory.makeHandshakeContext(cipher);
-
-    message_hash chloHash;
-    chloHash.hash = cookieState->chloHash->clone();
-    handshakeContext->appendToTranscript(encodeHandshake(std::move(chloHash)));
+    handshakeContext = factory.makeHrrHandshakeContext(cipher);
+    handshakeContext->appendToTranscript(cookieState->chloHash);
 
     auto cookie = getExtension<Cookie>(chlo.extensions);
     handshakeContext->appendToTranscript(getStatelessHelloRetryRequest(
@@ -632,7 +672,11 @@ static std::
   }
 
   if (resState) {
-    scheduler->deriveEarlySecret(resState->resumptionSecret->coalesce());
+    if (!resState->cachedEarlySecret.empty()) {
+      scheduler->setEarlySecret(folly::range(resState->cachedEarlySecret));
+    } else {
+      scheduler->deriveEarlySecret(resState->resumptionSecret->coalesce());
+    }
 
     auto binderKey = scheduler
                          ->getSecret(
@@ -652,10 +696,8 @@ static std::
     if (!psks || psks->binders.size() <= kPskIndex) {
       throw FizzException("no binders", AlertDescription::illegal_parameter);
     }
-    auto expectedBinder =
-        handshakeContext->getFinishedData(folly::range(binderKey));
-    if (!CryptoUtils::equal(
-            expectedBinder->coalesce(),
+    if (!handshakeContext->verifyFinishedData(
+            folly::range(binderKey),
             psks->binders[kPskIndex].binder->coalesce())) {
       throw FizzException(
           "binder does not match", AlertDescription::bad_record_mac);
@@ -685,12 +727,12 @@ static void validateGroups(const std::vector<KeyShareEntry>& client_shares) {
 static std::tuple<NamedGroup, Optional<Buf>> negotiateGroup(
     ProtocolVersion version,
     const ClientHello& chlo,
-    const std::vector<NamedGroup>& supportedGroups) {
+    const FizzServerContext& context) {
   auto groups = getExtension<SupportedGroups>(chlo.extensions);
   if (!groups) {
     throw FizzException("no named groups", AlertDescription::missing_extension);
   }
-  auto group = negotiate(supportedGroups, groups->named_group_list);
+  auto group = context.negotiateGroup(groups->named_group_list);
   if (!group) {
     throw FizzException("no group match", AlertDescription::handshake_failure);
   }
@@ -709,16 +751,28 @@ static std::tuple<NamedGroup, Optional<Buf>> negotiateGroup(
   return std::make_tuple(*group, folly::none);
 }
 
-static Buf doKex(
+static Future<Optional<Buf>> doKex(
     const Factory& factory,
     NamedGroup group,
     const Buf& clientShare,
-    KeyScheduler& scheduler) {
+    KeyScheduler& scheduler,
+    HandshakeInstrumentation* instrumentation) {
+  CryptoPhaseTimer timer(instrumentation, CryptoPhase::KeyExchange);
   auto kex = factory.makeKeyExchange(group);
   kex->generateKeyPair();
-  auto sharedSecret = kex->generateSharedSecret(clientShare->coalesce());
-  scheduler.deriveHandshakeSecret(sharedSecret->coalesce());
-  return kex->getKeyShare();
+  auto asyncKex = dynamic_cast<const AsyncKeyExchange*>(kex.get());
+  if (!asyncKex) {
+    auto sharedSecret = kex->generateSharedSecret(clientShare->coalesce());
+    scheduler.deriveHandshakeSecret(sharedSecret->coalesce());
+    return Optional<Buf>(kex->getKeyShare());
+  }
+  // The scheduler is kept alive by the continuation chained on this future
+  // in the ClientHello handler.
+  return asyncKex->generateSharedSecretFuture(clientShare->coalesce())
+      .thenValue([kex = std::move(kex), &scheduler](Buf sharedSecret) {
+        scheduler.deriveHandshakeSecret(sharedSecret->coalesce());
+        return Optional<Buf>(kex->getKeyShare());
+      });
 }
 
 static Buf getHelloRetryRequest(
@@ -932,6 +986,17 @@ static std::pair<std::shared_ptr<SelfCert>, SignatureScheme> chooseCert(
               .toStdString();
   }
 
+  // Prefer a delegated credential when the client supports one: it moves
+  // CertificateVerify signing onto the credential's cheaper key.
+  auto dcSupport = getExtension<DelegatedCredentialSupport>(chlo.extensions);
+  if (dcSupport) {
+    auto delegated = context.getDelegatedCert(
+        sni, dcSupport->supported_signature_algorithms);
+    if (delegated) {
+      return *delegated;
+    }
+  }
+
   auto certAndScheme =
       context.getCert(sni, clientSigSchemes->supported_signature_algorithms);
   if (!certAndScheme) {
@@ -957,10 +1022,45 @@ getCertificate(
         context.getSupportedCompressionAlgorithms(), compAlgos->algorithms);
   }
 
+  if (algo && context.getFirstFlightBudget() != 0) {
+    // A first-flight byte budget is set: instead of preference order,
+    // pick the mutually supported algorithm whose cached encoding is
+    // smallest, and skip compression entirely if the plain encoding
+    // beats them all. All encodings involved are cached on the cert, so
+    // this is a handful of length reads per handshake.
+    auto bestSize =
+        serverCert->getEncodedCertMessage()->computeChainDataLength();
+    folly::Optional<CertificateCompressionAlgorithm> bestAlgo;
+    for (auto candidate : context.getSupportedCompressionAlgorithms()) {
+      if (std::find(
+              compAlgos->algorithms.begin(),
+              compAlgos->algorithms.end(),
+              candidate) == compAlgos->algorithms.end()) {
+        continue;
+      }
+      auto size = encodeHandshake(serverCert->getCompressedCert(candidate))
+                      ->computeChainDataLength();
+      if (size < bestSize) {
+        bestSize = size;
+        bestAlgo = candidate;
+      }
+    }
+    algo = bestAlgo;
+  }
+
   if (algo) {
     encodedCertificate = encodeHandshake(serverCert->getCompressedCert(*algo));
   } else {
-    encodedCertificate = encodeHandshake(serverCert->getCertMessage());
+    // Serve a pre-encoded OCSP staple if the client asked for one and a
+    // fresh response is held. Precompressed certs are encoded without a
+    // staple, so stapling only applies on the uncompressed path.
+    if (findExtension(chlo.extensions, ExtensionType::status_request) !=
+        chlo.extensions.end()) {
+      encodedCertificate = context.getStapledCertMessage(*serverCert);
+    }
+    if (!encodedCertificate) {
+      encodedCertificate = serverCert->getEncodedCertMessage();
+    }
   }
   handshakeContext.appendToTranscript(encodedCertificate);
   return std::make_tuple(std::move(encodedCertificate), std::move(algo));
@@ -1004,6 +1104,23 @@ EventHandler<ServerTypes, StateEnum::ExpectingClientHello, Event::ClientHello>::
 
   addHandshakeLogging(state, chlo);
 
+  // Multi-tenant termination: swap in any per-SNI context override
+  // before negotiation so the entire handshake, and every later event,
+  // runs under the matched tenant's policy. One table lookup, resolved
+  // once per connection.
+  if (state.context()->hasSniContextOverrides()) {
+    auto serverNameList = getExtension<ServerNameList>(chlo.extensions);
+    if (serverNameList && !serverNameList->server_name_list.empty()) {
+      auto sniOverride = state.context()->getContextForSni(
+          serverNameList->server_name_list.front()
+              .hostname->moveToFbString()
+              .toStdString());
+      if (sniOverride) {
+        state.overrideContext(std::move(sniOverride));
+      }
+    }
+  }
+
   if (state.readRecordLayer()->hasUnparsedHandshakeData()) {
     throw FizzException(
         "data after client hello", AlertDescription::unexpected_message);
@@ -1045,15 +1162,12 @@ EventHandler<ServerTypes, StateEnum::ExpectingClientHello, Event::ClientHello>::
 
   validateClientHello(chlo);
 
-  auto cipher = negotiateCipher(chlo, state.context()->getSupportedCiphers());
+  auto cipher = negotiateCipher(chlo, *state.context());
 
   auto cookieState = getCookieState(
       chlo, *version, cipher, state.context()->getCookieCipher());
 
-  auto resStateResult = getResumptionState(
-      chlo,
-      state.context()->getTicketCipher(),
-      state.context()->getSupportedPskModes());
+  auto resStateResult = getResumptionState(chlo, *state.context());
 
   auto replayCacheResultFuture = getReplayCacheResult(
       chlo,
@@ -1171,12 +1285,12 @@ EventHandler<ServerTypes, StateEnum::ExpectingClientHello, Event::ClientHello>::
         }
 
         Optional<NamedGroup> group;
-        Optional<Buf> serverShare;
+        Future<Optional<Buf>> serverShareFuture = folly::none;
         KeyExchangeType keyExchangeType;
         if (!pskMode || *pskMode != PskKeyExchangeMode::psk_ke) {
           Optional<Buf> clientShare;
-          std::tie(group, clientShare) = negotiateGroup(
-              version, chlo, state.context()->getSupportedGroups());
+          std::tie(group, clientShare) =
+              negotiateGroup(version, chlo, *state.context());
           if (!clientShare) {
             VLOG(8) << "Did not find key share for " << toString(*group);
             if (state.group().hasValue() || cookieState) {
@@ -1193,13 +1307,12 @@ EventHandler<ServerTypes, StateEnum::ExpectingClientHello, Event::ClientHello>::
               earlyDataType = EarlyDataType::Rejected;
             }
 
-            message_hash chloHash;
-            chloHash.hash = handshakeContext->getHandshakeContext();
+            auto chloHash = handshakeContext->getHandshakeContext();
             handshakeContext =
-                state.context()->getFactory()->makeHandshakeContext(cipher);
-            handshakeContext->appendToTranscript(
-                encodeHandshake(std::move(chloHash)));
+                state.context()->getFactory()->makeHrrHandshakeContext(cipher);
+            handshakeContext->appendToTranscript(chloHash);
 
+            TlsMetricsRegistry::local().helloRetryRequests++;
             auto encodedHelloRetryRequest = getHelloRetryRequest(
                 version,
                 cipher,
@@ -1259,378 +1372,416 @@ EventHandler<ServerTypes, StateEnum::ExpectingClientHello, Event::ClientHello>::
             keyExchangeType = KeyExchangeType::OneRtt;
           }
 
-          serverShare = doKex(
-              *state.context()->getFactory(), *group, *clientShare, *scheduler);
+          serverShareFuture = doKex(
+              *state.context()->getFactory(),
+              *group,
+              *clientShare,
+              *scheduler,
+              state.instrumentation());
         } else {
           keyExchangeType = KeyExchangeType::None;
           scheduler->deriveHandshakeSecret();
         }
 
-        std::vector<Extension> additionalExtensions;
-        if (state.extensions()) {
-          additionalExtensions = state.extensions()->getExtensions(chlo);
-        }
-
-        if (state.group().hasValue() && (!group || *group != *state.group())) {
-          throw FizzException(
-              "group mismatch with previous negotiation",
-              AlertDescription::illegal_parameter);
-        }
-
-        // Cookies are not required to have already negotiated the group but if
-        // they did it must match (psk_ke is still allowed as we may not know if
-        // we are accepting the psk when sending the cookie).
-        if (cookieState && cookieState->group && group &&
-            *group != *cookieState->group) {
-          throw FizzException(
-              "group mismatch with cookie",
-              AlertDescription::illegal_parameter);
-        }
-
-        auto encodedServerHello = getServerHello(
-            version,
-            state.context()->getFactory()->makeRandom(),
-            cipher,
-            resState.hasValue(),
-            group,
-            std::move(serverShare),
-            legacySessionId ? legacySessionId->clone() : nullptr,
-            *handshakeContext);
-
-        // Derive handshake keys.
-        auto handshakeWriteRecordLayer =
-            state.context()->getFactory()->makeEncryptedWriteRecordLayer(
-                EncryptionLevel::Handshake);
-        handshakeWriteRecordLayer->setProtocolVersion(version);
-        auto handshakeWriteSecret = scheduler->getSecret(
-            HandshakeSecrets::ServerHandshakeTraffic,
-            handshakeContext->getHandshakeContext()->coalesce());
-        Protocol::setAead(
-            *handshakeWriteRecordLayer,
-            cipher,
-            folly::range(handshakeWriteSecret.secret),
-            *state.context()->getFactory(),
-            *scheduler);
-
-        auto handshakeReadRecordLayer =
-            state.context()->getFactory()->makeEncryptedReadRecordLayer(
-                EncryptionLevel::Handshake);
-        handshakeReadRecordLayer->setProtocolVersion(version);
-        handshakeReadRecordLayer->setSkipFailedDecryption(
-            earlyDataType == EarlyDataType::Rejected);
-        auto handshakeReadSecret = scheduler->getSecret(
-            HandshakeSecrets::ClientHandshakeTraffic,
-            handshakeContext->getHandshakeContext()->coalesce());
-        Protocol::setAead(
-            *handshakeReadRecordLayer,
-            cipher,
-            folly::range(handshakeReadSecret.secret),
-            *state.context()->getFactory(),
-            *scheduler);
-        auto clientHandshakeSecret =
-            folly::IOBuf::copyBuffer(folly::range(handshakeReadSecret.secret));
-
-        auto encodedEncryptedExt = getEncryptedExt(
-            *handshakeContext,
-            alpn,
-            earlyDataType,
-            std::move(additionalExtensions));
-
-        /*
-         * Determine we are requesting client auth.
-         * If yes, add CertificateRequest to handshake write and transcript.
-         */
-        bool requestClientAuth =
-            state.context()->getClientAuthMode() != ClientAuthMode::None &&
-            !resState;
-        Optional<Buf> encodedCertRequest;
-        if (requestClientAuth) {
-          encodedCertRequest = getCertificateRequest(
-              state.context()->getSupportedSigSchemes(),
-              state.context()->getClientCertVerifier().get(),
-              *handshakeContext);
-        }
-
-        /*
-         * Set the cert and signature scheme we are using.
-         * If sending new cert, add Certificate to handshake write and
-         * transcript.
-         */
-        Optional<Buf> encodedCertificate;
-        Future<Optional<Buf>> signature = folly::none;
-        Optional<SignatureScheme> sigScheme;
-        Optional<std::shared_ptr<const Cert>> serverCert;
-        std::shared_ptr<const Cert> clientCert;
-        Optional<CertificateCompressionAlgorithm> certCompressionAlgo;
-        if (!resState) { // TODO or reauth
-          std::shared_ptr<const SelfCert> originalSelfCert;
-          std::tie(originalSelfCert, sigScheme) =
-              chooseCert(*state.context(), chlo);
-
-          std::tie(encodedCertificate, certCompressionAlgo) = getCertificate(
-              originalSelfCert, *state.context(), chlo, *handshakeContext);
-
-          auto toBeSigned = handshakeContext->getHandshakeContext();
-          auto asyncSelfCert =
-              dynamic_cast<const AsyncSelfCert*>(originalSelfCert.get());
-          if (asyncSelfCert) {
-            signature = asyncSelfCert->signFuture(
-                *sigScheme,
-                CertificateVerifyContext::Server,
-                toBeSigned->coalesce());
-          } else {
-            signature = originalSelfCert->sign(
-                *sigScheme,
-                CertificateVerifyContext::Server,
-                toBeSigned->coalesce());
-          }
-          serverCert = std::move(originalSelfCert);
-        } else {
-          serverCert = std::move(resState->serverCert);
-          clientCert = std::move(resState->clientCert);
-        }
-
-        return signature.via(state.executor())
+        return std::move(serverShareFuture)
+            .via(state.executor())
             .thenValue([&state,
+                        chlo = std::move(chlo),
+                        cookieState = std::move(cookieState),
                         scheduler = std::move(scheduler),
                         handshakeContext = std::move(handshakeContext),
                         cipher,
+                        version,
                         group,
-                        encodedServerHello = std::move(encodedServerHello),
-                        handshakeWriteRecordLayer =
-                            std::move(handshakeWriteRecordLayer),
-                        handshakeWriteSecret = std::move(handshakeWriteSecret),
-                        handshakeReadRecordLayer =
-                            std::move(handshakeReadRecordLayer),
-                        handshakeReadSecret = std::move(handshakeReadSecret),
-                        earlyReadRecordLayer = std::move(earlyReadRecordLayer),
-                        earlyReadSecretAvailable =
-                            std::move(earlyReadSecretAvailable),
-                        earlyExporterMaster = std::move(earlyExporterMaster),
-                        clientHandshakeSecret =
-                            std::move(clientHandshakeSecret),
-                        encodedEncryptedExt = std::move(encodedEncryptedExt),
-                        encodedCertificate = std::move(encodedCertificate),
-                        encodedCertRequest = std::move(encodedCertRequest),
-                        requestClientAuth,
+                        keyExchangeType,
                         pskType,
                         pskMode,
-                        sigScheme,
-                        version,
-                        keyExchangeType,
-                        earlyDataType,
-                        replayCacheResult,
-                        serverCert = std::move(serverCert),
-                        clientCert = std::move(clientCert),
+                        resState = std::move(resState),
+                        legacySessionId = std::move(legacySessionId),
                         alpn = std::move(alpn),
                         clockSkew,
-                        legacySessionId = std::move(legacySessionId),
-                        serverCertCompAlgo = certCompressionAlgo,
-                        handshakeTime](Optional<Buf> sig) mutable {
-              Optional<Buf> encodedCertificateVerify;
-              if (sig) {
-                encodedCertificateVerify = getCertificateVerify(
-                    *sigScheme, std::move(*sig), *handshakeContext);
+                        earlyDataType,
+                        replayCacheResult,
+                        earlyReadRecordLayer = std::move(earlyReadRecordLayer),
+                        earlyReadSecretAvailable =
+                            std::move(earlyReadSecretAvailable),
+                        earlyExporterMaster = std::move(earlyExporterMaster),
+                        handshakeTime](Optional<Buf> serverShare) mutable {
+              std::vector<Extension> additionalExtensions;
+              if (state.extensions()) {
+                additionalExtensions = state.extensions()->getExtensions(chlo);
               }
 
-              auto encodedFinished = Protocol::getFinished(
-                  folly::range(handshakeWriteSecret.secret), *handshakeContext);
-
-              folly::IOBufQueue combined;
-              if (encodedCertificate) {
-                if (encodedCertRequest) {
-                  combined.append(std::move(encodedEncryptedExt));
-                  combined.append(std::move(*encodedCertRequest));
-                  combined.append(std::move(*encodedCertificate));
-                  combined.append(std::move(*encodedCertificateVerify));
-                  combined.append(std::move(encodedFinished));
-                } else {
-                  combined.append(std::move(encodedEncryptedExt));
-                  combined.append(std::move(*encodedCertificate));
-                  combined.append(std::move(*encodedCertificateVerify));
-                  combined.append(std::move(encodedFinished));
-                }
-              } else {
-                combined.append(std::move(encodedEncryptedExt));
-                combined.append(std::move(encodedFinished));
+              if (state.group().hasValue() && (!group || *group != *state.group())) {
+                throw FizzException(
+                    "group mismatch with previous negotiation",
+                    AlertDescription::illegal_parameter);
               }
 
-              // Some middleboxes appear to break if the first encrypted record
-              // is larger than ~1300 bytes (likely if it does not fit in the
-              // first packet).
-              auto serverEncrypted = handshakeWriteRecordLayer->writeHandshake(
-                  combined.splitAtMost(1000));
-              if (!combined.empty()) {
-                auto splitRecord =
-                    handshakeWriteRecordLayer->writeHandshake(combined.move());
-                // Split record must have the same encryption level as the main
-                // handshake.
-                DCHECK(
-                    splitRecord.encryptionLevel ==
-                    serverEncrypted.encryptionLevel);
-                serverEncrypted.data->prependChain(std::move(splitRecord.data));
+              // Cookies are not required to have already negotiated the group but if
+              // they did it must match (psk_ke is still allowed as we may not know if
+              // we are accepting the psk when sending the cookie).
+              if (cookieState && cookieState->group && group &&
+                  *group != *cookieState->group) {
+                throw FizzException(
+                    "group mismatch with cookie",
+                    AlertDescription::illegal_parameter);
               }
 
-              WriteToSocket serverFlight;
-              serverFlight.contents.emplace_back(
-                  state.writeRecordLayer()->writeHandshake(
-                      std::move(encodedServerHello)));
-              if (legacySessionId && !legacySessionId->empty()) {
-                TLSContent ccsWrite;
-                ccsWrite.encryptionLevel = EncryptionLevel::Plaintext;
-                ccsWrite.contentType = ContentType::change_cipher_spec;
-                ccsWrite.data = folly::IOBuf::wrapBuffer(FakeChangeCipherSpec);
-                serverFlight.contents.emplace_back(std::move(ccsWrite));
-              }
-              serverFlight.contents.emplace_back(std::move(serverEncrypted));
-
-              scheduler->deriveMasterSecret();
-              auto clientFinishedContext =
-                  handshakeContext->getHandshakeContext();
-              auto exporterMasterVector = scheduler->getSecret(
-                  MasterSecrets::ExporterMaster,
-                  clientFinishedContext->coalesce());
-              auto exporterMaster = folly::IOBuf::copyBuffer(
-                  folly::range(exporterMasterVector.secret));
-
-              scheduler->deriveAppTrafficSecrets(
-                  clientFinishedContext->coalesce());
-              auto appTrafficWriteRecordLayer =
+              auto encodedServerHello = getServerHello(
+                  version,
+                  state.context()->getFactory()->makeRandom(),
+                  cipher,
+                  resState.hasValue(),
+                  group,
+                  std::move(serverShare),
+                  legacySessionId ? legacySessionId->clone() : nullptr,
+                  *handshakeContext);
+
+              // Derive handshake keys.
+              auto handshakeWriteRecordLayer =
                   state.context()->getFactory()->makeEncryptedWriteRecordLayer(
-                      EncryptionLevel::AppTraffic);
-              appTrafficWriteRecordLayer->setProtocolVersion(version);
-              auto writeSecret =
-                  scheduler->getSecret(AppTrafficSecrets::ServerAppTraffic);
+                      EncryptionLevel::Handshake);
+              handshakeWriteRecordLayer->setProtocolVersion(version);
+              auto handshakeWriteSecret = scheduler->getSecret(
+                  HandshakeSecrets::ServerHandshakeTraffic,
+                  handshakeContext->getHandshakeContext()->coalesce());
+              Protocol::setAead(
+                  *handshakeWriteRecordLayer,
+                  cipher,
+                  folly::range(handshakeWriteSecret.secret),
+                  *state.context()->getFactory(),
+                  *scheduler);
+
+              auto handshakeReadRecordLayer =
+                  state.context()->getFactory()->makeEncryptedReadRecordLayer(
+                      EncryptionLevel::Handshake);
+              handshakeReadRecordLayer->setProtocolVersion(version);
+              handshakeReadRecordLayer->setSkipFailedDecryption(
+                  earlyDataType == EarlyDataType::Rejected);
+              auto handshakeReadSecret = scheduler->getSecret(
+                  HandshakeSecrets::ClientHandshakeTraffic,
+                  handshakeContext->getHandshakeContext()->coalesce());
               Protocol::setAead(
-                  *appTrafficWriteRecordLayer,
+                  *handshakeReadRecordLayer,
                   cipher,
-                  folly::range(writeSecret.secret),
+                  folly::range(handshakeReadSecret.secret),
                   *state.context()->getFactory(),
                   *scheduler);
+              auto clientHandshakeSecret =
+                  folly::IOBuf::copyBuffer(folly::range(handshakeReadSecret.secret));
+
+              auto encodedEncryptedExt = getEncryptedExt(
+                  *handshakeContext,
+                  alpn,
+                  earlyDataType,
+                  std::move(additionalExtensions));
+
+              /*
+               * Determine we are requesting client auth.
+               * If yes, add CertificateRequest to handshake write and transcript.
+               */
+              bool requestClientAuth =
+                  state.context()->getClientAuthMode() != ClientAuthMode::None &&
+                  !resState;
+              Optional<Buf> encodedCertRequest;
+              if (requestClientAuth) {
+                encodedCertRequest = getCertificateRequest(
+                    state.context()->getSupportedSigSchemes(),
+                    state.context()->getClientCertVerifier().get(),
+                    *handshakeContext);
+              }
 
-              // If we have previously dealt with early data (before a
-              // HelloRetryRequest), don't overwrite the previous result.
-              auto earlyDataTypeSave = state.earlyDataType()
-                  ? *state.earlyDataType()
-                  : earlyDataType;
-
-              SecretAvailable handshakeReadSecretAvailable(
-                  std::move(handshakeReadSecret));
-              SecretAvailable handshakeWriteSecretAvailable(
-                  std::move(handshakeWriteSecret));
-              SecretAvailable appWriteSecretAvailable(std::move(writeSecret));
-
-              // Save all the necessary state except for the read record layer,
-              // which is done separately as it varies if early data was
-              // accepted.
-              auto saveState = [appTrafficWriteRecordLayer =
-                                    std::move(appTrafficWriteRecordLayer),
-                                handshakeContext = std::move(handshakeContext),
-                                scheduler = std::move(scheduler),
-                                exporterMaster = std::move(exporterMaster),
-                                serverCert = std::move(serverCert),
-                                clientCert = std::move(clientCert),
-                                cipher,
-                                group,
-                                sigScheme,
-                                clientHandshakeSecret =
-                                    std::move(clientHandshakeSecret),
-                                pskType,
-                                pskMode,
-                                version,
-                                keyExchangeType,
-                                alpn = std::move(alpn),
-                                earlyDataTypeSave,
-                                replayCacheResult,
-                                clockSkew,
-                                serverCertCompAlgo,
-                                handshakeTime = std::move(handshakeTime)](
-                                   State& newState) mutable {
-                newState.writeRecordLayer() =
-                    std::move(appTrafficWriteRecordLayer);
-                newState.handshakeContext() = std::move(handshakeContext);
-                newState.keyScheduler() = std::move(scheduler);
-                newState.exporterMasterSecret() = std::move(exporterMaster);
-                newState.serverCert() = std::move(*serverCert);
-                newState.clientCert() = std::move(clientCert);
-                newState.version() = version;
-                newState.cipher() = cipher;
-                newState.group() = group;
-                newState.sigScheme() = sigScheme;
-                newState.clientHandshakeSecret() =
-                    std::move(clientHandshakeSecret);
-                newState.pskType() = pskType;
-                newState.pskMode() = pskMode;
-                newState.keyExchangeType() = keyExchangeType;
-                newState.earlyDataType() = earlyDataTypeSave;
-                newState.replayCacheResult() = replayCacheResult;
-                newState.alpn() = std::move(alpn);
-                newState.clientClockSkew() = clockSkew;
-                newState.serverCertCompAlgo() = serverCertCompAlgo;
-                newState.handshakeTime() = std::move(handshakeTime);
-              };
-
-              if (earlyDataType == EarlyDataType::Accepted) {
-                if (state.context()->getOmitEarlyRecordLayer()) {
-                  return actions(
-                      [handshakeReadRecordLayer =
-                           std::move(handshakeReadRecordLayer),
-                       earlyExporterMaster = std::move(earlyExporterMaster)](
-                          State& newState) mutable {
-                        newState.readRecordLayer() =
-                            std::move(handshakeReadRecordLayer);
-                        newState.earlyExporterMasterSecret() =
-                            std::move(earlyExporterMaster);
-                      },
-                      std::move(saveState),
-                      std::move(*earlyReadSecretAvailable),
-                      std::move(handshakeReadSecretAvailable),
-                      std::move(handshakeWriteSecretAvailable),
-                      std::move(appWriteSecretAvailable),
-                      std::move(serverFlight),
-                      &Transition<StateEnum::ExpectingFinished>,
-                      ReportEarlyHandshakeSuccess());
-
-                } else {
-                  return actions(
-                      [handshakeReadRecordLayer =
-                           std::move(handshakeReadRecordLayer),
-                       earlyReadRecordLayer = std::move(earlyReadRecordLayer),
-                       earlyExporterMaster = std::move(earlyExporterMaster)](
-                          State& newState) mutable {
-                        newState.readRecordLayer() =
-                            std::move(earlyReadRecordLayer);
-                        newState.handshakeReadRecordLayer() =
-                            std::move(handshakeReadRecordLayer);
-                        newState.earlyExporterMasterSecret() =
-                            std::move(earlyExporterMaster);
-                      },
-                      std::move(saveState),
-                      std::move(*earlyReadSecretAvailable),
-                      std::move(handshakeReadSecretAvailable),
-                      std::move(handshakeWriteSecretAvailable),
-                      std::move(appWriteSecretAvailable),
-                      std::move(serverFlight),
-                      &Transition<StateEnum::AcceptingEarlyData>,
-                      ReportEarlyHandshakeSuccess());
+              /*
+               * Set the cert and signature scheme we are using.
+               * If sending new cert, add Certificate to handshake write and
+               * transcript.
+               */
+              Optional<Buf> encodedCertificate;
+              Future<Optional<Buf>> signature = folly::none;
+              Optional<SignatureScheme> sigScheme;
+              Optional<std::shared_ptr<const Cert>> serverCert;
+              std::shared_ptr<const Cert> clientCert;
+              Optional<CertificateCompressionAlgorithm> certCompressionAlgo;
+              if (!resState) { // TODO or reauth
+                std::shared_ptr<const SelfCert> originalSelfCert;
+                std::tie(originalSelfCert, sigScheme) =
+                    chooseCert(*state.context(), chlo);
+
+                std::tie(encodedCertificate, certCompressionAlgo) = getCertificate(
+                    originalSelfCert, *state.context(), chlo, *handshakeContext);
+
+                auto toBeSigned = handshakeContext->getHandshakeContext();
+                auto asyncSelfCert =
+                    dynamic_cast<const AsyncSelfCert*>(originalSelfCert.get());
+                {
+                  CryptoPhaseTimer timer(
+                      state.instrumentation(), CryptoPhase::Signing);
+                  if (asyncSelfCert) {
+                    signature = asyncSelfCert->signFuture(
+                        *sigScheme,
+                        CertificateVerifyContext::Server,
+                        toBeSigned->coalesce());
+                  } else {
+                    signature = originalSelfCert->sign(
+                        *sigScheme,
+                        CertificateVerifyContext::Server,
+                        toBeSigned->coalesce());
+                  }
                 }
+                serverCert = std::move(originalSelfCert);
               } else {
-                auto transition = requestClientAuth
-                    ? Transition<StateEnum::ExpectingCertificate>
-                    : Transition<StateEnum::ExpectingFinished>;
-                return actions(
-                    [handshakeReadRecordLayer = std::move(
-                         handshakeReadRecordLayer)](State& newState) mutable {
-                      newState.readRecordLayer() =
-                          std::move(handshakeReadRecordLayer);
-                    },
-                    std::move(saveState),
-                    std::move(handshakeReadSecretAvailable),
-                    std::move(handshakeWriteSecretAvailable),
-                    std::move(appWriteSecretAvailable),
-                    std::move(serverFlight),
-                    transition);
+                serverCert = std::move(resState->serverCert);
+                clientCert = std::move(resState->clientCert);
               }
+
+              return signature.via(state.executor())
+                  .thenValue([&state,
+                              scheduler = std::move(scheduler),
+                              handshakeContext = std::move(handshakeContext),
+                              cipher,
+                              group,
+                              encodedServerHello = std::move(encodedServerHello),
+                              handshakeWriteRecordLayer =
+                                  std::move(handshakeWriteRecordLayer),
+                              handshakeWriteSecret = std::move(handshakeWriteSecret),
+                              handshakeReadRecordLayer =
+                                  std::move(handshakeReadRecordLayer),
+                              handshakeReadSecret = std::move(handshakeReadSecret),
+                              earlyReadRecordLayer = std::move(earlyReadRecordLayer),
+                              earlyReadSecretAvailable =
+                                  std::move(earlyReadSecretAvailable),
+                              earlyExporterMaster = std::move(earlyExporterMaster),
+                              clientHandshakeSecret =
+                                  std::move(clientHandshakeSecret),
+                              encodedEncryptedExt = std::move(encodedEncryptedExt),
+                              encodedCertificate = std::move(encodedCertificate),
+                              encodedCertRequest = std::move(encodedCertRequest),
+                              requestClientAuth,
+                              pskType,
+                              pskMode,
+                              sigScheme,
+                              version,
+                              keyExchangeType,
+                              earlyDataType,
+                              replayCacheResult,
+                              serverCert = std::move(serverCert),
+                              clientCert = std::move(clientCert),
+                              alpn = std::move(alpn),
+                              clockSkew,
+                              legacySessionId = std::move(legacySessionId),
+                              serverCertCompAlgo = certCompressionAlgo,
+                              handshakeTime](Optional<Buf> sig) mutable {
+                    Optional<Buf> encodedCertificateVerify;
+                    if (sig) {
+                      encodedCertificateVerify = getCertificateVerify(
+                          *sigScheme, std::move(*sig), *handshakeContext);
+                    }
+
+                    auto encodedFinished = Protocol::getFinished(
+                        folly::range(handshakeWriteSecret.secret), *handshakeContext);
+
+                    folly::IOBufQueue combined{
+                        folly::IOBufQueue::cacheChainLength()};
+                    if (encodedCertificate) {
+                      if (encodedCertRequest) {
+                        combined.append(std::move(encodedEncryptedExt));
+                        combined.append(std::move(*encodedCertRequest));
+                        combined.append(std::move(*encodedCertificate));
+                        combined.append(std::move(*encodedCertificateVerify));
+                        combined.append(std::move(encodedFinished));
+                      } else {
+                        combined.append(std::move(encodedEncryptedExt));
+                        combined.append(std::move(*encodedCertificate));
+                        combined.append(std::move(*encodedCertificateVerify));
+                        combined.append(std::move(encodedFinished));
+                      }
+                    } else {
+                      combined.append(std::move(encodedEncryptedExt));
+                      combined.append(std::move(encodedFinished));
+                    }
+
+                    // Some middleboxes appear to break if the first encrypted record
+                    // is larger than ~1300 bytes (likely if it does not fit in the
+                    // first packet).
+                    auto serverEncrypted = handshakeWriteRecordLayer->writeHandshake(
+                        combined.splitAtMost(1000));
+                    if (!combined.empty()) {
+                      auto splitRecord =
+                          handshakeWriteRecordLayer->writeHandshake(combined.move());
+                      // Split record must have the same encryption level as the main
+                      // handshake.
+                      DCHECK(
+                          splitRecord.encryptionLevel ==
+                          serverEncrypted.encryptionLevel);
+                      serverEncrypted.data->prependChain(std::move(splitRecord.data));
+                    }
+
+                    WriteToSocket serverFlight;
+                    serverFlight.contents.emplace_back(
+                        state.writeRecordLayer()->writeHandshake(
+                            std::move(encodedServerHello)));
+                    if (legacySessionId && !legacySessionId->empty()) {
+                      TLSContent ccsWrite;
+                      ccsWrite.encryptionLevel = EncryptionLevel::Plaintext;
+                      ccsWrite.contentType = ContentType::change_cipher_spec;
+                      ccsWrite.data = folly::IOBuf::wrapBuffer(FakeChangeCipherSpec);
+                      serverFlight.contents.emplace_back(std::move(ccsWrite));
+                    }
+                    serverFlight.contents.emplace_back(std::move(serverEncrypted));
+
+                    scheduler->deriveMasterSecret();
+                    auto clientFinishedContext =
+                        handshakeContext->getHandshakeContext();
+                    auto exporterMasterVector = scheduler->getSecret(
+                        MasterSecrets::ExporterMaster,
+                        clientFinishedContext->coalesce());
+                    auto exporterMaster = folly::IOBuf::copyBuffer(
+                        folly::range(exporterMasterVector.secret));
+
+                    scheduler->deriveAppTrafficSecrets(
+                        clientFinishedContext->coalesce());
+                    auto appTrafficWriteRecordLayer =
+                        state.context()->getFactory()->makeEncryptedWriteRecordLayer(
+                            EncryptionLevel::AppTraffic);
+                    appTrafficWriteRecordLayer->setProtocolVersion(version);
+                    appTrafficWriteRecordLayer->setRekeyThresholds(
+                        state.context()->getRekeyAfterBytes(),
+                        state.context()->getRekeyAfterRecords(),
+                        state.context()->getRekeyJitter());
+                    auto writeSecret =
+                        scheduler->getSecret(AppTrafficSecrets::ServerAppTraffic);
+                    Protocol::setAead(
+                        *appTrafficWriteRecordLayer,
+                        cipher,
+                        folly::range(writeSecret.secret),
+                        *state.context()->getFactory(),
+                        *scheduler);
+
+                    // If we have previously dealt with early data (before a
+                    // HelloRetryRequest), don't overwrite the previous result.
+                    auto earlyDataTypeSave = state.earlyDataType()
+                        ? *state.earlyDataType()
+                        : earlyDataType;
+
+                    SecretAvailable handshakeReadSecretAvailable(
+                        std::move(handshakeReadSecret));
+                    SecretAvailable handshakeWriteSecretAvailable(
+                        std::move(handshakeWriteSecret));
+                    SecretAvailable appWriteSecretAvailable(std::move(writeSecret));
+
+                    // Save all the necessary state except for the read record layer,
+                    // which is done separately as it varies if early data was
+                    // accepted.
+                    auto saveState = [appTrafficWriteRecordLayer =
+                                          std::move(appTrafficWriteRecordLayer),
+                                      handshakeContext = std::move(handshakeContext),
+                                      scheduler = std::move(scheduler),
+                                      exporterMaster = std::move(exporterMaster),
+                                      serverCert = std::move(serverCert),
+                                      clientCert = std::move(clientCert),
+                                      cipher,
+                                      group,
+                                      sigScheme,
+                                      clientHandshakeSecret =
+                                          std::move(clientHandshakeSecret),
+                                      pskType,
+                                      pskMode,
+                                      version,
+                                      keyExchangeType,
+                                      alpn = std::move(alpn),
+                                      earlyDataTypeSave,
+                                      replayCacheResult,
+                                      clockSkew,
+                                      serverCertCompAlgo,
+                                      handshakeTime = std::move(handshakeTime)](
+                                         State& newState) mutable {
+                      newState.writeRecordLayer() =
+                          std::move(appTrafficWriteRecordLayer);
+                      newState.handshakeContext() = std::move(handshakeContext);
+                      newState.keyScheduler() = std::move(scheduler);
+                      newState.exporterMasterSecret() = std::move(exporterMaster);
+                      newState.serverCert() = std::move(*serverCert);
+                      newState.clientCert() = std::move(clientCert);
+                      newState.version() = version;
+                      newState.cipher() = cipher;
+                      newState.group() = group;
+                      newState.sigScheme() = sigScheme;
+                      newState.clientHandshakeSecret() =
+                          std::move(clientHandshakeSecret);
+                      newState.pskType() = pskType;
+                      newState.pskMode() = pskMode;
+                      newState.keyExchangeType() = keyExchangeType;
+                      newState.earlyDataType() = earlyDataTypeSave;
+                      newState.replayCacheResult() = replayCacheResult;
+                      newState.alpn() = std::move(alpn);
+                      newState.clientClockSkew() = clockSkew;
+                      newState.serverCertCompAlgo() = serverCertCompAlgo;
+                      newState.handshakeTime() = std::move(handshakeTime);
+                    };
+
+                    if (earlyDataType == EarlyDataType::Accepted) {
+                      if (state.context()->getOmitEarlyRecordLayer()) {
+                        return actions(
+                            [handshakeReadRecordLayer =
+                                 std::move(handshakeReadRecordLayer),
+                             earlyExporterMaster = std::move(earlyExporterMaster)](
+                                State& newState) mutable {
+                              newState.readRecordLayer() =
+                                  std::move(handshakeReadRecordLayer);
+                              newState.earlyExporterMasterSecret() =
+                                  std::move(earlyExporterMaster);
+                            },
+                            std::move(saveState),
+                            std::move(*earlyReadSecretAvailable),
+                            std::move(handshakeReadSecretAvailable),
+                            std::move(handshakeWriteSecretAvailable),
+                            std::move(appWriteSecretAvailable),
+                            std::move(serverFlight),
+                            &Transition<StateEnum::ExpectingFinished>,
+                            ReportEarlyHandshakeSuccess());
+
+                      } else {
+                        return actions(
+                            [handshakeReadRecordLayer =
+                                 std::move(handshakeReadRecordLayer),
+                             earlyReadRecordLayer = std::move(earlyReadRecordLayer),
+                             earlyExporterMaster = std::move(earlyExporterMaster)](
+                                State& newState) mutable {
+                              newState.readRecordLayer() =
+                                  std::move(earlyReadRecordLayer);
+                              newState.handshakeReadRecordLayer() =
+                                  std::move(handshakeReadRecordLayer);
+                              newState.earlyExporterMasterSecret() =
+                                  std::move(earlyExporterMaster);
+                            },
+                            std::move(saveState),
+                            std::move(*earlyReadSecretAvailable),
+                            std::move(handshakeReadSecretAvailable),
+                            std::move(handshakeWriteSecretAvailable),
+                            std::move(appWriteSecretAvailable),
+                            std::move(serverFlight),
+                            &Transition<StateEnum::AcceptingEarlyData>,
+                            ReportEarlyHandshakeSuccess());
+                      }
+                    } else {
+                      auto transition = requestClientAuth
+                          ? Transition<StateEnum::ExpectingCertificate>
+                          : Transition<StateEnum::ExpectingFinished>;
+                      return actions(
+                          [handshakeReadRecordLayer = std::move(
+                               handshakeReadRecordLayer)](State& newState) mutable {
+                            newState.readRecordLayer() =
+                                std::move(handshakeReadRecordLayer);
+                          },
+                          std::move(saveState),
+                          std::move(handshakeReadSecretAvailable),
+                          std::move(handshakeWriteSecretAvailable),
+                          std::move(appWriteSecretAvailable),
+                          std::move(serverFlight),
+                          transition);
+                    }
+                  });
             });
       });
 }
@@ -1720,9 +1871,9 @@ static WriteToSocket writeNewSessionTicket(
   return nstWrite;
 }
 
-static Future<Optional<WriteToSocket>> generateTicket(
+static Future<Optional<WriteToSocket>> generateTickets(
     const State& state,
-    const std::vector<uint8_t>& resumptionMasterSecret,
+    const SecretStorage& resumptionMasterSecret,
     Buf appToken = nullptr) {
   auto ticketCipher = state.context()->getTicketCipher();
 
@@ -1730,42 +1881,83 @@ static Future<Optional<WriteToSocket>> generateTicket(
     return folly::none;
   }
 
-  Buf resumptionSecret;
-  auto ticketNonce = folly::IOBuf::create(0);
-  resumptionSecret = state.keyScheduler()->getResumptionSecret(
-      folly::range(resumptionMasterSecret), ticketNonce->coalesce());
-
-  ResumptionState resState;
-  resState.version = *state.version();
-  resState.cipher = *state.cipher();
-  resState.resumptionSecret = std::move(resumptionSecret);
-  resState.serverCert = state.serverCert();
-  resState.clientCert = state.clientCert();
-  resState.alpn = state.alpn();
-  resState.ticketAgeAdd = state.context()->getFactory()->makeTicketAgeAdd();
-  resState.ticketIssueTime = state.context()->getClock().getCurrentTime();
-  resState.appToken = std::move(appToken);
-  resState.handshakeTime = *state.handshakeTime();
-
-  auto ticketFuture = ticketCipher->encrypt(std::move(resState));
-  return ticketFuture.via(state.executor())
+  auto numTickets = state.context()->getNumNewSessionTickets();
+  if (numTickets == 0) {
+    return folly::none;
+  }
+
+  // All tickets in the batch share the resumption state; each one binds a
+  // distinct nonce-derived resumption secret. The first ticket keeps the
+  // empty nonce so single-ticket behavior is unchanged.
+  std::vector<Buf> ticketNonces;
+  std::vector<uint32_t> ticketAgeAdds;
+  std::vector<Future<Optional<std::pair<Buf, std::chrono::seconds>>>>
+      ticketFutures;
+  CryptoPhaseTimer sealTimer(state.instrumentation(), CryptoPhase::TicketSeal);
+  for (uint32_t i = 0; i < numTickets; i++) {
+    Buf ticketNonce;
+    if (i == 0) {
+      ticketNonce = folly::IOBuf::create(0);
+    } else {
+      ticketNonce = folly::IOBuf::create(sizeof(uint32_t));
+      folly::io::Appender appender(ticketNonce.get(), 0);
+      appender.writeBE<uint32_t>(i);
+    }
+    auto resumptionSecret = state.keyScheduler()->getResumptionSecret(
+        folly::range(resumptionMasterSecret), ticketNonce->coalesce());
+
+    ResumptionState resState;
+    resState.version = *state.version();
+    resState.cipher = *state.cipher();
+    resState.resumptionSecret = std::move(resumptionSecret);
+    resState.serverCert = state.serverCert();
+    resState.clientCert = state.clientCert();
+    resState.alpn = state.alpn();
+    resState.ticketAgeAdd = state.context()->getFactory()->makeTicketAgeAdd();
+    resState.ticketIssueTime = state.context()->getClock().getCurrentTime();
+    resState.appToken = appToken ? appToken->clone() : nullptr;
+    resState.handshakeTime = *state.handshakeTime();
+
+    ticketNonces.push_back(std::move(ticketNonce));
+    ticketAgeAdds.push_back(resState.ticketAgeAdd);
+    ticketFutures.push_back(ticketCipher->encrypt(std::move(resState)));
+  }
+
+  return folly::collectAll(std::move(ticketFutures))
+      .via(state.executor())
       .thenValue(
           [&state,
-           ticketAgeAdd = resState.ticketAgeAdd,
-           ticketNonce = std::move(ticketNonce)](
-              Optional<std::pair<Buf, std::chrono::seconds>> ticket) mutable
-          -> Optional<WriteToSocket> {
-            if (!ticket) {
-              return folly::none;
+           ticketNonces = std::move(ticketNonces),
+           ticketAgeAdds = std::move(ticketAgeAdds)](
+              std::vector<
+                  folly::Try<Optional<std::pair<Buf, std::chrono::seconds>>>>
+                  tickets) mutable -> Optional<WriteToSocket> {
+            // Emit the batch as a single write so all tickets leave in one
+            // coalesced flush after Finished.
+            Optional<WriteToSocket> nstWrite;
+            for (size_t i = 0; i < tickets.size(); i++) {
+              if (!tickets[i].hasValue() || !tickets[i].value()) {
+                continue;
+              }
+              auto& ticket = *tickets[i].value();
+              auto write = writeNewSessionTicket(
+                  *state.context(),
+                  *state.writeRecordLayer(),
+                  ticket.second,
+                  ticketAgeAdds[i],
+                  std::move(ticketNonces[i]),
+                  std::move(ticket.first),
+                  *state.version());
+              if (!nstWrite) {
+                nstWrite = std::move(write);
+              } else {
+                std::move(
+                    write.contents.begin(),
+                    write.contents.end(),
+                    std::back_inserter(nstWrite->contents));
+              }
             }
-            return writeNewSessionTicket(
-                *state.context(),
-                *state.writeRecordLayer(),
-                ticket->second,
-                ticketAgeAdd,
-                std::move(ticketNonce),
-                std::move(ticket->first),
-                *state.version());
+            return nstWrite;
           });
 }
 
@@ -1782,6 +1974,12 @@ EventHandler<ServerTypes, StateEnum::ExpectingCertificate, Event::Certificate>::
         AlertDescription::illegal_parameter);
   }
 
+  // With no client cert verifier configured the chain is never inspected
+  // beyond the CertificateVerify signature check, so keep the raw DER
+  // and defer parsing each certificate until it is actually used.
+  const bool lazyCerts = !state.context()->getClientCertVerifier();
+  const auto& certCache = state.context()->getClientCertCache();
+
   std::vector<std::shared_ptr<const PeerCert>> clientCerts;
   for (auto& certEntry : certMsg.certificate_list) {
     // We don't request any extensions, so this ought to be empty
@@ -1791,8 +1989,24 @@ EventHandler<ServerTypes, StateEnum::ExpectingCertificate, Event::Certificate>::
           AlertDescription::illegal_parameter);
     }
 
-    clientCerts.emplace_back(state.context()->getFactory()->makePeerCert(
-        std::move(certEntry.cert_data)));
+    if (certCache) {
+      // Repeat presentations of the same certificate share one parsed
+      // PeerCert, costing a digest lookup instead of a parse.
+      auto cached = certCache->get(*certEntry.cert_data);
+      if (!cached) {
+        auto made = state.context()->getFactory()->makePeerCert(
+            certEntry.cert_data->clone());
+        certCache->put(*certEntry.cert_data, made);
+        cached = std::move(made);
+      }
+      clientCerts.emplace_back(std::move(cached));
+    } else if (lazyCerts) {
+      clientCerts.emplace_back(
+          CertUtils::makeLazyPeerCert(std::move(certEntry.cert_data)));
+    } else {
+      clientCerts.emplace_back(state.context()->getFactory()->makePeerCert(
+          std::move(certEntry.cert_data)));
+    }
   }
 
   if (clientCerts.empty()) {
@@ -1835,33 +2049,123 @@ AsyncActions EventHandler<
 
   const auto& certs = *state.unverifiedCertChain();
   auto leafCert = certs.front();
-  leafCert->verify(
-      certVerify.algorithm,
-      CertificateVerifyContext::Client,
-      state.handshakeContext()->getHandshakeContext()->coalesce(),
-      certVerify.signature->coalesce());
 
-  try {
-    const auto& verifier = state.context()->getClientCertVerifier();
-    if (verifier) {
-      verifier->verify(certs);
+  Future<folly::Unit> sigVerified = folly::unit;
+  const auto& batchVerifier = state.context()->getClientCertBatchVerifier();
+  if (batchVerifier) {
+    sigVerified = batchVerifier->addJob(
+        [leafCert,
+         scheme = certVerify.algorithm,
+         handshakeContext =
+             state.handshakeContext()->getHandshakeContext(),
+         signature = certVerify.signature->clone()]() {
+          leafCert->verify(
+              scheme,
+              CertificateVerifyContext::Client,
+              handshakeContext->coalesce(),
+              signature->coalesce());
+        });
+  } else {
+    CryptoPhaseTimer timer(state.instrumentation(), CryptoPhase::Verification);
+    leafCert->verify(
+        certVerify.algorithm,
+        CertificateVerifyContext::Client,
+        state.handshakeContext()->getHandshakeContext()->coalesce(),
+        certVerify.signature->coalesce());
+  }
+
+  Future<folly::Unit> verified = folly::unit;
+  const auto& verifier = state.context()->getClientCertVerifier();
+  if (verifier) {
+    auto asyncVerifier =
+        dynamic_cast<const AsyncCertificateVerifier*>(verifier.get());
+    if (asyncVerifier) {
+      verified = asyncVerifier->verifyFuture(certs);
+    } else {
+      try {
+        CryptoPhaseTimer timer(
+            state.instrumentation(), CryptoPhase::Verification);
+        verifier->verify(certs);
+      } catch (const FizzException&) {
+        throw;
+      } catch (const std::exception& e) {
+        throw FizzVerificationException(
+            folly::to<std::string>("client certificate failure: ", e.what()),
+            AlertDescription::bad_certificate);
+      }
     }
-  } catch (const FizzException&) {
-    throw;
-  } catch (const std::exception& e) {
-    throw FizzVerificationException(
-        folly::to<std::string>("client certificate failure: ", e.what()),
-        AlertDescription::bad_certificate);
   }
 
-  state.handshakeContext()->appendToTranscript(*certVerify.originalEncoding);
+  return std::move(sigVerified)
+      .thenValue([verified = std::move(verified)](folly::Unit) mutable {
+        return std::move(verified);
+      })
+      .via(state.executor())
+      .thenError([](folly::exception_wrapper ew) -> folly::Unit {
+        if (ew.get_exception<FizzException>()) {
+          ew.throw_exception();
+        }
+        throw FizzVerificationException(
+            folly::to<std::string>("client certificate failure: ", ew.what()),
+            AlertDescription::bad_certificate);
+      })
+      .thenValue([&state,
+                  certVerify = std::move(certVerify),
+                  leafCert = std::move(leafCert)](folly::Unit) mutable {
+        state.handshakeContext()->appendToTranscript(
+            *certVerify.originalEncoding);
+
+        return actions(
+            [cert = std::move(leafCert)](State& newState) {
+              newState.unverifiedCertChain() = folly::none;
+              newState.clientCert() = std::move(cert);
+            },
+            &Transition<StateEnum::ExpectingFinished>);
+      });
+}
 
-  return actions(
-      [cert = std::move(leafCert)](State& newState) {
-        newState.unverifiedCertChain() = folly::none;
-        newState.clientCert() = std::move(cert);
-      },
-      &Transition<StateEnum::ExpectingFinished>);
+/*
+ * Counts the completed handshake in this thread's TlsMetrics. Called once
+ * per connection, as the client Finished is accepted.
+ */
+static void recordHandshakeMetrics(const State& state) {
+  auto& metrics = TlsMetricsRegistry::local();
+  if (state.pskType() == PskType::Resumption ||
+      state.pskType() == PskType::External) {
+    metrics.pskHandshakes++;
+  } else {
+    metrics.fullHandshakes++;
+  }
+  if (state.earlyDataType() == EarlyDataType::Accepted) {
+    metrics.earlyDataHandshakes++;
+  }
+  switch (*state.cipher()) {
+    case CipherSuite::TLS_AES_128_GCM_SHA256:
+      metrics.cipherAesgcm128++;
+      break;
+    case CipherSuite::TLS_AES_256_GCM_SHA384:
+      metrics.cipherAesgcm256++;
+      break;
+    case CipherSuite::TLS_CHACHA20_POLY1305_SHA256:
+      metrics.cipherChacha++;
+      break;
+    default:
+      metrics.cipherOther++;
+      break;
+  }
+  if (state.group()) {
+    switch (*state.group()) {
+      case NamedGroup::x25519:
+        metrics.groupX25519++;
+        break;
+      case NamedGroup::secp256r1:
+        metrics.groupSecp256r1++;
+        break;
+      default:
+        metrics.groupOther++;
+        break;
+    }
+  }
 }
 
 AsyncActions
@@ -1869,10 +2173,9 @@ EventHandler<ServerTypes, StateEnum::ExpectingFinished, Event::Finished>::
     handle(const State& state, Param param) {
   auto& finished = boost::get<Finished>(param);
 
-  auto expectedFinished = state.handshakeContext()->getFinishedData(
-      state.clientHandshakeSecret()->coalesce());
-  if (!CryptoUtils::equal(
-          expectedFinished->coalesce(), finished.verify_data->coalesce())) {
+  if (!state.handshakeContext()->verifyFinishedData(
+          state.clientHandshakeSecret()->coalesce(),
+          finished.verify_data->coalesce())) {
     throw FizzException("client finished verify failure", folly::none);
   }
 
@@ -1880,6 +2183,8 @@ EventHandler<ServerTypes, StateEnum::ExpectingFinished, Event::Finished>::
     throw FizzException("data after finished", folly::none);
   }
 
+  recordHandshakeMetrics(state);
+
   auto readRecordLayer =
       state.context()->getFactory()->makeEncryptedReadRecordLayer(
           EncryptionLevel::AppTraffic);
@@ -1918,7 +2223,7 @@ EventHandler<ServerTypes, StateEnum::ExpectingFinished, Event::Finished>::
         &Transition<StateEnum::AcceptingData>,
         ReportHandshakeSuccess());
   } else {
-    auto ticketFuture = generateTicket(state, resumptionMasterSecret);
+    auto ticketFuture = generateTickets(state, resumptionMasterSecret);
     return ticketFuture.via(state.executor())
         .thenValue([saveState = std::move(saveState),
                     appReadTrafficSecretAvailable =
@@ -1947,7 +2252,7 @@ AsyncActions EventHandler<
     StateEnum::AcceptingData,
     Event::WriteNewSessionTicket>::handle(const State& state, Param param) {
   auto& writeNewSessionTicket = boost::get<WriteNewSessionTicket>(param);
-  auto ticketFuture = generateTicket(
+  auto ticketFuture = generateTickets(
       state,
       state.resumptionMasterSecret(),
       std::move(writeNewSessionTicket.appToken));
@@ -1981,6 +2286,31 @@ EventHandler<ServerTypes, StateEnum::AcceptingData, Event::AppWrite>::handle(
       state.writeRecordLayer()->writeAppData(std::move(appWrite.data)));
   write.flags = appWrite.flags;
 
+  if (state.writeRecordLayer()->rekeyRecommended()) {
+    // The current write key has reached its configured traffic limit. Append
+    // a key_update to this flight and rotate the write key in place.
+    auto encodedKeyUpdated =
+        Protocol::getKeyUpdated(KeyUpdateRequest::update_not_requested);
+    write.contents.emplace_back(
+        state.writeRecordLayer()->writeHandshake(std::move(encodedKeyUpdated)));
+
+    state.keyScheduler()->serverKeyUpdate();
+    auto writeSecret =
+        state.keyScheduler()->getSecret(AppTrafficSecrets::ServerAppTraffic);
+
+    MutateState rekeyWrite([secret = writeSecret.secret](State& newState) {
+      Protocol::rekeyRecordLayer(
+          *newState.writeRecordLayer(),
+          *newState.keyScheduler(),
+          folly::range(secret));
+    });
+
+    return actions(
+        std::move(rekeyWrite),
+        SecretAvailable(std::move(writeSecret)),
+        std::move(write));
+  }
+
   return actions(std::move(write));
 }
 
@@ -2026,6 +2356,10 @@ EventHandler<ServerTypes, StateEnum::AcceptingData, Event::KeyUpdate>::handle(
       state.context()->getFactory()->makeEncryptedWriteRecordLayer(
           EncryptionLevel::AppTraffic);
   writeRecordLayer->setProtocolVersion(*state.version());
+  writeRecordLayer->setRekeyThresholds(
+      state.context()->getRekeyAfterBytes(),
+      state.context()->getRekeyAfterRecords(),
+      state.context()->getRekeyJitter());
   auto writeSecret =
       state.keyScheduler()->getSecret(AppTrafficSecrets::ServerAppTraffic);
   Protocol::setAead(
@@ -2046,6 +2380,37 @@ EventHandler<ServerTypes, StateEnum::AcceptingData, Event::KeyUpdate>::handle(
       std::move(write));
 }
 
+AsyncActions EventHandler<
+    ServerTypes,
+    StateEnum::AcceptingData,
+    Event::KeyUpdateInitiation>::handle(const State& state, Param param) {
+  auto& keyUpdateInitiation = boost::get<KeyUpdateInitiation>(param);
+
+  auto encodedKeyUpdated =
+      Protocol::getKeyUpdated(keyUpdateInitiation.request_update);
+  WriteToSocket write;
+  write.contents.emplace_back(
+      state.writeRecordLayer()->writeHandshake(std::move(encodedKeyUpdated)));
+
+  state.keyScheduler()->serverKeyUpdate();
+  auto writeSecret =
+      state.keyScheduler()->getSecret(AppTrafficSecrets::ServerAppTraffic);
+
+  // Rekey the existing write record layer in place rather than building a
+  // new record layer and aead.
+  MutateState rekeyWrite([secret = writeSecret.secret](State& newState) {
+    Protocol::rekeyRecordLayer(
+        *newState.writeRecordLayer(),
+        *newState.keyScheduler(),
+        folly::range(secret));
+  });
+
+  return actions(
+      std::move(rekeyWrite),
+      SecretAvailable(std::move(writeSecret)),
+      std::move(write));
+}
+
 AsyncActions
 EventHandler<ServerTypes, StateEnum::AcceptingData, Event::CloseNotify>::handle(
     const State& state,
@@ -27,6 +27,7 @@ class ServerStateMachine {
   using StateType = State;
   using ProcessingActions = AsyncActions;
   using CompletedActions = Actions;
+  using ReportSuccess = ReportHandshakeSuccess;
 
   virtual ~ServerStateMachine() = default;
 
@@ -46,6 +47,10 @@ class ServerStateMachine {
 
   virtual AsyncActions processEarlyAppWrite(const State&, EarlyAppWrite);
 
+  virtual AsyncActions processKeyUpdateInitiation(
+      const State&,
+      KeyUpdateInitiation);
+
   virtual Actions processAppClose(const State&);
   virtual Actions processAppCloseImmediate(const State&);
 };
@@ -0,0 +1,224 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/server/SessionHandoff.h>
+
+#include <fizz/protocol/Protocol.h>
+#include <fizz/record/EncryptedRecordLayer.h>
+#include <folly/ssl/OpenSSLCertUtils.h>
+
+using folly::io::Appender;
+using folly::io::Cursor;
+
+namespace fizz {
+namespace server {
+
+namespace {
+
+constexpr uint16_t kSessionHandoffFormatVersion = 1;
+constexpr size_t kHandoffInitialCapacity = 256;
+
+void writeSecret(folly::ByteRange secret, Appender& out) {
+  out.writeBE<uint8_t>(folly::to<uint8_t>(secret.size()));
+  out.push(secret);
+}
+
+SecretStorage readSecret(Cursor& cursor) {
+  auto len = cursor.readBE<uint8_t>();
+  if (len > SecretStorage::kMaxLength) {
+    throw std::runtime_error("secret too long");
+  }
+  SecretStorage secret;
+  secret.resize(len);
+  cursor.pull(secret.data(), len);
+  return secret;
+}
+
+template <class T>
+void writeOptionalEnum(const folly::Optional<T>& val, Appender& out) {
+  out.writeBE<uint8_t>(val.hasValue() ? 1 : 0);
+  if (val) {
+    detail::write(*val, out);
+  }
+}
+
+template <class T>
+void readOptionalEnum(folly::Optional<T>& val, Cursor& cursor) {
+  if (cursor.readBE<uint8_t>() != 0) {
+    T value;
+    detail::read(value, cursor);
+    val = value;
+  }
+}
+} // namespace
+
+Buf serializeSessionState(const State& state) {
+  if (state.state() != StateEnum::AcceptingData || !state.keyScheduler() ||
+      !state.version() || !state.cipher()) {
+    throw std::runtime_error("session not established");
+  }
+  auto readLayer =
+      dynamic_cast<const EncryptedReadRecordLayer*>(state.readRecordLayer());
+  auto writeLayer =
+      dynamic_cast<const EncryptedWriteRecordLayer*>(state.writeRecordLayer());
+  if (!readLayer || !writeLayer ||
+      readLayer->getEncryptionLevel() != EncryptionLevel::AppTraffic ||
+      writeLayer->getEncryptionLevel() != EncryptionLevel::AppTraffic) {
+    throw std::runtime_error("record layers not transferable");
+  }
+
+  // The traffic keys themselves are not serialized; they rederive from the
+  // current application traffic secrets on the other side, staying correct
+  // across any key updates that have happened since the handshake.
+  auto clientSecret =
+      state.keyScheduler()->getSecret(AppTrafficSecrets::ClientAppTraffic);
+  auto serverSecret =
+      state.keyScheduler()->getSecret(AppTrafficSecrets::ServerAppTraffic);
+
+  auto buf = folly::IOBuf::create(kHandoffInitialCapacity);
+  Appender appender(buf.get(), kHandoffInitialCapacity);
+  appender.writeBE<uint16_t>(kSessionHandoffFormatVersion);
+  detail::write(*state.version(), appender);
+  detail::write(*state.cipher(), appender);
+  writeSecret(folly::range(clientSecret.secret), appender);
+  writeSecret(folly::range(serverSecret.secret), appender);
+  appender.writeBE<uint64_t>(readLayer->getRecordLayerState().sequence);
+  appender.writeBE<uint64_t>(writeLayer->getRecordLayerState().sequence);
+  writeSecret(folly::range(state.resumptionMasterSecret()), appender);
+
+  writeOptionalEnum(state.group(), appender);
+  writeOptionalEnum(state.sigScheme(), appender);
+  writeOptionalEnum(state.pskType(), appender);
+  writeOptionalEnum(state.keyExchangeType(), appender);
+  writeOptionalEnum(state.earlyDataType(), appender);
+
+  appender.writeBE<uint8_t>(state.alpn() ? 1 : 0);
+  if (state.alpn()) {
+    auto alpn = folly::IOBuf::wrapBuffer(
+        state.alpn()->data(), state.alpn()->size());
+    detail::writeBuf<uint8_t>(alpn, appender);
+  }
+
+  appender.writeBE<uint8_t>(state.handshakeTime() ? 1 : 0);
+  if (state.handshakeTime()) {
+    appender.writeBE<uint64_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            state.handshakeTime()->time_since_epoch())
+            .count());
+  }
+
+  appender.writeBE<uint8_t>(state.exporterMasterSecret() ? 1 : 0);
+  if (state.exporterMasterSecret()) {
+    detail::writeBuf<uint16_t>(*state.exporterMasterSecret(), appender);
+  }
+
+  // Client certificates without a backing X509 (such as cached identities
+  // from a resumed session) serialize as absent.
+  Buf certDer;
+  if (state.clientCert()) {
+    auto x509 = state.clientCert()->getX509();
+    if (x509) {
+      certDer = folly::ssl::OpenSSLCertUtils::derEncode(*x509);
+    }
+  }
+  detail::writeBuf<detail::bits24>(certDer, appender);
+
+  return buf;
+}
+
+State deserializeSessionState(
+    const Factory& factory,
+    std::shared_ptr<const FizzServerContext> context,
+    const folly::IOBuf& serialized) {
+  Cursor cursor(&serialized);
+  try {
+    if (cursor.readBE<uint16_t>() != kSessionHandoffFormatVersion) {
+      throw std::runtime_error("unsupported handoff format");
+    }
+    ProtocolVersion version;
+    CipherSuite cipher;
+    detail::read(version, cursor);
+    detail::read(cipher, cursor);
+    auto clientSecret = readSecret(cursor);
+    auto serverSecret = readSecret(cursor);
+    auto readSeq = cursor.readBE<uint64_t>();
+    auto writeSeq = cursor.readBE<uint64_t>();
+    auto resumptionMasterSecret = readSecret(cursor);
+
+    State state;
+    state.state() = StateEnum::AcceptingData;
+    state.context() = std::move(context);
+    state.version() = version;
+    state.cipher() = cipher;
+    state.resumptionMasterSecret() = resumptionMasterSecret;
+
+    readOptionalEnum(state.group(), cursor);
+    readOptionalEnum(state.sigScheme(), cursor);
+    readOptionalEnum(state.pskType(), cursor);
+    readOptionalEnum(state.keyExchangeType(), cursor);
+    readOptionalEnum(state.earlyDataType(), cursor);
+
+    if (cursor.readBE<uint8_t>() != 0) {
+      Buf alpn;
+      detail::readBuf<uint8_t>(alpn, cursor);
+      state.alpn() = alpn->moveToFbString().toStdString();
+    }
+
+    if (cursor.readBE<uint8_t>() != 0) {
+      state.handshakeTime() = std::chrono::system_clock::time_point(
+          std::chrono::milliseconds(cursor.readBE<uint64_t>()));
+    }
+
+    if (cursor.readBE<uint8_t>() != 0) {
+      Buf exporterMaster;
+      detail::readBuf<uint16_t>(exporterMaster, cursor);
+      state.exporterMasterSecret() = std::move(exporterMaster);
+    }
+
+    Buf certDer;
+    detail::readBuf<detail::bits24>(certDer, cursor);
+    if (!certDer->empty()) {
+      state.clientCert() = factory.makePeerCert(std::move(certDer));
+    }
+
+    auto scheduler = factory.makeKeyScheduler(cipher);
+    scheduler->adoptAppTrafficSecrets(
+        folly::range(clientSecret), folly::range(serverSecret));
+
+    auto readRecordLayer =
+        factory.makeEncryptedReadRecordLayer(EncryptionLevel::AppTraffic);
+    readRecordLayer->setProtocolVersion(version);
+    Protocol::setAead(
+        *readRecordLayer,
+        cipher,
+        folly::range(clientSecret),
+        factory,
+        *scheduler);
+    readRecordLayer->setSequenceNumber(readSeq);
+
+    auto writeRecordLayer =
+        factory.makeEncryptedWriteRecordLayer(EncryptionLevel::AppTraffic);
+    writeRecordLayer->setProtocolVersion(version);
+    Protocol::setAead(
+        *writeRecordLayer,
+        cipher,
+        folly::range(serverSecret),
+        factory,
+        *scheduler);
+    writeRecordLayer->setSequenceNumber(writeSeq);
+
+    state.keyScheduler() = std::move(scheduler);
+    state.readRecordLayer() = std::move(readRecordLayer);
+    state.writeRecordLayer() = std::move(writeRecordLayer);
+    return state;
+  } catch (const std::out_of_range&) {
+    throw std::runtime_error("truncated session handoff");
+  }
+}
+} // namespace server
+} // namespace fizz
@@ -0,0 +1,45 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/protocol/Factory.h>
+#include <fizz/server/State.h>
+
+namespace fizz {
+namespace server {
+
+/**
+ * Serializes an established session's state - negotiated parameters,
+ * application traffic secrets, record sequence numbers and resumption
+ * state - so the connection can be handed to another process alongside
+ * its file descriptor (passed separately, e.g. over SCM_RIGHTS) and
+ * resumed there without a re-handshake. The state should first be
+ * detached from its transport with AsyncFizzServer::extractSessionState().
+ *
+ * The session must be fully established (accepting application data)
+ * with both record layers at the application traffic level; throws
+ * otherwise. The serialized buffer contains the connection's traffic
+ * secrets, so it must only be sent over a channel as trusted as the
+ * process boundary itself.
+ */
+Buf serializeSessionState(const State& state);
+
+/**
+ * Reconstructs session state previously serialized with
+ * serializeSessionState(), rebuilding the record layers and key
+ * scheduler with the given factory. The returned State can be attached
+ * to the transferred socket with the session-adopting AsyncFizzServer
+ * constructor. Throws on malformed or incompatible input.
+ */
+State deserializeSessionState(
+    const Factory& factory,
+    std::shared_ptr<const FizzServerContext> context,
+    const folly::IOBuf& serialized);
+} // namespace server
+} // namespace fizz
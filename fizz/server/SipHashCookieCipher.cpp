@@ -0,0 +1,130 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/server/SipHashCookieCipher.h>
+
+#include <cstring>
+
+namespace fizz {
+namespace server {
+
+constexpr size_t SipHashCookieCipher::kMinCookieSecretLength;
+
+static constexpr size_t kTagLength = crypto_shorthash_siphashx24_BYTES;
+
+bool SipHashCookieCipher::setCookieSecrets(
+    const std::vector<folly::ByteRange>& cookieSecrets) {
+  std::vector<Key> keys;
+  for (const auto& secret : cookieSecrets) {
+    if (secret.size() < kMinCookieSecretLength) {
+      return false;
+    }
+    Key key;
+    memcpy(key.data(), secret.data(), key.size());
+    keys.push_back(key);
+  }
+  keys_ = std::move(keys);
+  return true;
+}
+
+boost::variant<AppToken, StatelessHelloRetryRequest>
+SipHashCookieCipher::getTokenOrRetry(Buf clientHello, Buf appToken) const {
+  folly::IOBufQueue queue{folly::IOBufQueue::cacheChainLength()};
+  queue.append(std::move(clientHello));
+  auto msg = PlaintextReadRecordLayer().readEvent(queue);
+  if (msg.hasError()) {
+    throw std::runtime_error(msg.error().message);
+  }
+  if (!msg->hasValue()) {
+    throw std::runtime_error("no TLS message in initial");
+  }
+
+  auto chlo = std::move(boost::get<ClientHello>(**msg));
+
+  auto cookie = getExtension<Cookie>(chlo.extensions);
+  if (cookie) {
+    auto state = decrypt(std::move(cookie->cookie));
+    if (!state) {
+      throw std::runtime_error("cookie could not be verified");
+    }
+    AppToken token;
+    token.token = std::move(state->appToken);
+    return std::move(token);
+  } else {
+    StatelessHelloRetryRequest hrr;
+    hrr.data = getStatelessResponse(chlo, std::move(appToken));
+    return std::move(hrr);
+  }
+}
+
+folly::Optional<CookieState> SipHashCookieCipher::decrypt(Buf cookie) const {
+  auto payload = verify(std::move(cookie));
+  if (payload) {
+    return detail::decodeCookie(std::move(*payload));
+  } else {
+    return folly::none;
+  }
+}
+
+Buf SipHashCookieCipher::getStatelessResponse(
+    const ClientHello& chlo,
+    Buf appToken) const {
+  auto state = getCookieState(
+      *context_->getFactory(),
+      context_->getSupportedVersions(),
+      context_->getSupportedCiphers(),
+      context_->getSupportedGroups(),
+      chlo,
+      std::move(appToken));
+
+  auto cookie = seal(detail::encodeCookie(state));
+
+  auto statelessMessage = getStatelessHelloRetryRequest(
+      state.version, state.cipher, state.group, std::move(cookie));
+
+  return PlaintextWriteRecordLayer()
+      .writeHandshake(std::move(statelessMessage))
+      .data;
+}
+
+Buf SipHashCookieCipher::seal(Buf payload) const {
+  if (keys_.empty()) {
+    throw std::runtime_error("no cookie secrets set");
+  }
+  payload->coalesce();
+  auto tag = folly::IOBuf::create(kTagLength);
+  crypto_shorthash_siphashx24(
+      tag->writableData(),
+      payload->data(),
+      payload->length(),
+      keys_.front().data());
+  tag->append(kTagLength);
+  payload->prependChain(std::move(tag));
+  return payload;
+}
+
+folly::Optional<Buf> SipHashCookieCipher::verify(Buf cookie) const {
+  cookie->coalesce();
+  if (cookie->length() < kTagLength) {
+    return folly::none;
+  }
+  size_t payloadLength = cookie->length() - kTagLength;
+  std::array<uint8_t, kTagLength> tag;
+  for (const auto& key : keys_) {
+    crypto_shorthash_siphashx24(
+        tag.data(), cookie->data(), payloadLength, key.data());
+    if (sodium_memcmp(
+            tag.data(), cookie->data() + payloadLength, kTagLength) == 0) {
+      cookie->trimEnd(kTagLength);
+      return std::move(cookie);
+    }
+  }
+  return folly::none;
+}
+} // namespace server
+} // namespace fizz
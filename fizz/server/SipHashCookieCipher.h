@@ -0,0 +1,77 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/server/AeadCookieCipher.h>
+
+#include <sodium.h>
+
+#include <array>
+#include <vector>
+
+namespace fizz {
+namespace server {
+
+/**
+ * CookieCipher implementation that authenticates the cookie state with a
+ * keyed SipHash MAC instead of sealing it with an AEAD. Validating a
+ * cookie costs one short hash rather than an AEAD decryption, which
+ * matters when cookies are enabled as a DoS defense and every spoofed
+ * ClientHello forces a validation.
+ *
+ * Unlike AeadCookieCipher the cookie state (including the app token) is
+ * sent in the clear; only its integrity is protected. Use the AEAD
+ * cipher if the app token is confidential.
+ */
+class SipHashCookieCipher : public CookieCipher {
+ public:
+  SipHashCookieCipher() = default;
+
+  /**
+   * Set cookie secrets to use for cookie MACs. The first one will be used
+   * for new cookies; all are tried on validation. Secrets must be at
+   * least kMinCookieSecretLength long.
+   */
+  bool setCookieSecrets(const std::vector<folly::ByteRange>& cookieSecrets);
+
+  /**
+   * Set the Fizz context to use when negotiating the parameters for a
+   * stateless hello retry request.
+   */
+  void setContext(const FizzServerContext* context) {
+    context_ = context;
+  }
+
+  /**
+   * Returns either a stateless hello retry request, or a verified token
+   * contained in the client hello.
+   */
+  boost::variant<AppToken, StatelessHelloRetryRequest> getTokenOrRetry(
+      Buf clientHello,
+      Buf appToken) const;
+
+  folly::Optional<CookieState> decrypt(Buf cookie) const override;
+
+  static constexpr size_t kMinCookieSecretLength =
+      crypto_shorthash_siphashx24_KEYBYTES;
+
+ private:
+  using Key = std::array<uint8_t, crypto_shorthash_siphashx24_KEYBYTES>;
+
+  Buf getStatelessResponse(const ClientHello& chlo, Buf appToken) const;
+
+  Buf seal(Buf payload) const;
+  folly::Optional<Buf> verify(Buf cookie) const;
+
+  std::vector<Key> keys_;
+
+  const FizzServerContext* context_ = nullptr;
+};
+} // namespace server
+} // namespace fizz
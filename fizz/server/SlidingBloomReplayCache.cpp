@@ -28,7 +28,8 @@ namespace fizz {
 namespace server {
 const static int kBitsPerByte = 0x8;
 const static unsigned int kBucketCount = 12;
-const static unsigned int kHashCount = 4;
+
+constexpr size_t SlidingBloomReplayCache::kHashCount;
 
 // You can only have as many buckets as you have bits in your cell
 static_assert(
@@ -78,19 +79,14 @@ SlidingBloomReplayCache::SlidingBloomReplayCache(
       std::chrono::milliseconds(((ttlInSecs * 1000) / kBucketCount) + 1);
 
   // Reset bit buffer
-  bitBuf_.reset(new CellType[bitSize_]());
+  bitBuf_.reset(new std::atomic<CellType>[bitSize_]());
 
   // Initialize current bucket
   currentBucket_ = 0;
 
-  // Set up hashers
-  for (unsigned int i = 0; i < kHashCount; i++) {
-    hashers_.push_back(
-        [seed = RandomNumGenerator<uint64_t>().generateRandom()](
-            const unsigned char* buf, size_t len) -> uint64_t {
-          return SpookyHashV2::Hash64((const void*)buf, len, seed);
-        });
-  }
+  // Seed the single hash pass all probe indices are derived from.
+  hashSeeds_[0] = RandomNumGenerator<uint64_t>().generateRandom();
+  hashSeeds_[1] = RandomNumGenerator<uint64_t>().generateRandom();
 
   // Schedule reaping function (if evb given)
   if (evb) {
@@ -100,23 +96,39 @@ SlidingBloomReplayCache::SlidingBloomReplayCache(
   }
 }
 
-void SlidingBloomReplayCache::set(folly::ByteRange query) {
-  CellType mask = (static_cast<CellType>(1)) << currentBucket_;
+void SlidingBloomReplayCache::hashIndices(
+    folly::ByteRange query,
+    size_t (&indices)[kHashCount]) const {
+  // Double hashing: one 128-bit hash pass yields two 64-bit halves, and
+  // index i is h1 + i * h2. Prefetching each probed cell lets the k
+  // loads overlap instead of serializing on memory latency.
+  uint64_t h1 = hashSeeds_[0];
+  uint64_t h2 = hashSeeds_[1];
+  SpookyHashV2::Hash128((const void*)query.data(), query.size(), &h1, &h2);
+  for (size_t i = 0; i < kHashCount; ++i) {
+    indices[i] = (h1 + i * h2) % bitSize_;
+    __builtin_prefetch(&bitBuf_[indices[i]]);
+  }
+}
 
-  for (auto& hasher : hashers_) {
-    size_t idx = hasher(query.data(), query.size()) % bitSize_;
+void SlidingBloomReplayCache::set(folly::ByteRange query) {
+  CellType mask = (static_cast<CellType>(1))
+      << currentBucket_.load(std::memory_order_relaxed);
 
-    bitBuf_[idx] |= mask;
+  size_t indices[kHashCount];
+  hashIndices(query, indices);
+  for (size_t idx : indices) {
+    bitBuf_[idx].fetch_or(mask, std::memory_order_relaxed);
   }
 }
 
 bool SlidingBloomReplayCache::test(folly::ByteRange query) const {
   CellType ret(std::numeric_limits<CellType>::max());
 
-  for (auto& hasher : hashers_) {
-    size_t idx = hasher(query.data(), query.size()) % bitSize_;
-
-    ret &= bitBuf_[idx];
+  size_t indices[kHashCount];
+  hashIndices(query, indices);
+  for (size_t idx : indices) {
+    ret &= bitBuf_[idx].load(std::memory_order_relaxed);
   }
 
   return (ret != 0);
@@ -124,13 +136,15 @@ bool SlidingBloomReplayCache::test(folly::ByteRange query) const {
 
 bool SlidingBloomReplayCache::testAndSet(folly::ByteRange query) {
   CellType ret(std::numeric_limits<CellType>::max());
-  CellType mask = (static_cast<CellType>(1)) << currentBucket_;
-
-  for (auto& hasher : hashers_) {
-    size_t idx = hasher(query.data(), query.size()) % bitSize_;
-
-    ret &= bitBuf_[idx];
-    bitBuf_[idx] |= mask;
+  CellType mask = (static_cast<CellType>(1))
+      << currentBucket_.load(std::memory_order_relaxed);
+
+  size_t indices[kHashCount];
+  hashIndices(query, indices);
+  for (size_t idx : indices) {
+    // fetch_or returns the previous value, giving an atomic test-and-set
+    // per cell without any cross-thread hop.
+    ret &= bitBuf_[idx].fetch_or(mask, std::memory_order_relaxed);
   }
 
   return (ret != 0);
@@ -144,20 +158,22 @@ folly::Future<ReplayCacheResult> SlidingBloomReplayCache::check(
 
 void SlidingBloomReplayCache::clearBucket(size_t bucket) {
   VLOG(8) << "Clearing bit " << bucket << ", current bucket is "
-          << currentBucket_;
+          << currentBucket_.load(std::memory_order_relaxed);
 
   CellType mask = ~((static_cast<CellType>(1)) << bucket);
   for (size_t i = 0; i < bitSize_; ++i) {
-    bitBuf_[i] &= mask;
+    bitBuf_[i].fetch_and(mask, std::memory_order_relaxed);
   }
 }
 
 void SlidingBloomReplayCache::clear() {
+  size_t current = currentBucket_.load(std::memory_order_relaxed);
+
   // Clear the soon to be occupied bucket
-  clearBucket((currentBucket_ + 1) % kBucketCount);
+  clearBucket((current + 1) % kBucketCount);
 
   // Increment current bucket
-  currentBucket_ = (currentBucket_ + 1) % kBucketCount;
+  currentBucket_.store((current + 1) % kBucketCount, std::memory_order_relaxed);
 }
 
 void SlidingBloomReplayCache::timeoutExpired() noexcept {
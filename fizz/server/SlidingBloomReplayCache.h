@@ -8,9 +8,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <memory>
-#include <vector>
 
 #include <fizz/server/ReplayCache.h>
 
@@ -27,7 +27,10 @@ class SlidingBloomReplayCache : public ReplayCache,
   // maximumum number of buckets corresponds to the bit size of the cell.
   // You can use one of uint8_t, uint16_t, uint32_t, or uint64_t.
   using CellType = uint64_t;
-  using HashFunction = std::function<CellType(const unsigned char*, size_t)>;
+  // Number of bit probes per entry. All probes are derived from a single
+  // 128-bit hash pass with double hashing, so raising this does not add
+  // hash computations, only probes.
+  static constexpr size_t kHashCount = 4;
   /*
    * Create a time bucketed bloom filter with following parameters:
    * - ttlInSeconds: TTL for each checked attempt in seconds.
@@ -43,6 +46,11 @@ class SlidingBloomReplayCache : public ReplayCache,
       folly::EventBase* evb);
   ~SlidingBloomReplayCache() override = default;
 
+  /**
+   * set/test/testAndSet may be called concurrently from any thread; the
+   * cells are updated with atomic fetch_or so handshake threads do not
+   * need to hop onto the reaping EventBase.
+   */
   void set(folly::ByteRange query);
 
   bool test(folly::ByteRange query) const;
@@ -56,15 +64,22 @@ class SlidingBloomReplayCache : public ReplayCache,
   void clear();
   void timeoutExpired() noexcept override;
 
+  /**
+   * Computes all probe indices from one 128-bit hash pass and prefetches
+   * the probed cells, so a check costs one hash plus k overlapping loads.
+   */
+  void hashIndices(folly::ByteRange query, size_t (&indices)[kHashCount])
+      const;
+
   std::chrono::milliseconds bucketWidthInMs_;
   size_t bitSize_;
 
-  size_t currentBucket_;
+  std::atomic<size_t> currentBucket_;
 
   // bit array as a buffer
-  std::unique_ptr<CellType[]> bitBuf_;
+  std::unique_ptr<std::atomic<CellType>[]> bitBuf_;
 
-  std::vector<HashFunction> hashers_;
+  uint64_t hashSeeds_[2];
 };
 
 } // namespace server
@@ -10,7 +10,9 @@
 
 #include <folly/futures/Future.h>
 
+#include <fizz/crypto/Secret.h>
 #include <fizz/protocol/Certificate.h>
+#include <fizz/protocol/Instrumentation.h>
 #include <fizz/protocol/KeyScheduler.h>
 #include <fizz/protocol/Types.h>
 #include <fizz/record/Extensions.h>
@@ -78,6 +80,14 @@ class State {
     return executor_;
   }
 
+  /**
+   * Instrumentation hook notified of state transitions and crypto phases.
+   * Not owned. May be null.
+   */
+  HandshakeInstrumentation* instrumentation() const {
+    return instrumentation_;
+  }
+
   /**
    * The FizzServerContext used on this connection.
    */
@@ -85,6 +95,15 @@ class State {
     return context_.get();
   }
 
+  /**
+   * Replaces the context for this connection. Called by the ClientHello
+   * handler when a per-SNI context override matches, before any
+   * negotiation has consulted the original context's policy.
+   */
+  void overrideContext(std::shared_ptr<const FizzServerContext> ctx) const {
+    context_ = std::move(ctx);
+  }
+
   /**
    * The certificate used to authenticate the server. May be null.
    */
@@ -246,7 +265,7 @@ class State {
   /**
    * Resumption master secret.
    */
-  const std::vector<uint8_t>& resumptionMasterSecret() const {
+  const SecretStorage& resumptionMasterSecret() const {
     return resumptionMasterSecret_;
   }
 
@@ -301,6 +320,9 @@ class State {
   auto& executor() {
     return executor_;
   }
+  auto& instrumentation() {
+    return instrumentation_;
+  }
   auto& context() {
     return context_;
   }
@@ -390,16 +412,24 @@ class State {
   }
 
  private:
+  // The members touched on the per-record path are grouped at the front
+  // of the object so that the state enum and both record layer pointers
+  // share a cacheline; everything below is only read during the
+  // handshake or on error paths.
   StateEnum state_{StateEnum::Uninitialized};
 
+  std::unique_ptr<ReadRecordLayer> readRecordLayer_;
+  std::unique_ptr<WriteRecordLayer> writeRecordLayer_;
+
   folly::Executor* executor_;
 
-  std::shared_ptr<const FizzServerContext> context_;
+  HandshakeInstrumentation* instrumentation_{nullptr};
 
-  std::unique_ptr<KeyScheduler> keyScheduler_;
+  // Mutable so the ClientHello handler can swap in a per-SNI
+  // override context mid-event; see overrideContext().
+  mutable std::shared_ptr<const FizzServerContext> context_;
 
-  std::unique_ptr<ReadRecordLayer> readRecordLayer_;
-  std::unique_ptr<WriteRecordLayer> writeRecordLayer_;
+  std::unique_ptr<KeyScheduler> keyScheduler_;
 
   // The handshake read record layer, stored here while accepting early data.
   mutable std::unique_ptr<EncryptedReadRecordLayer> handshakeReadRecordLayer_;
@@ -426,7 +456,7 @@ class State {
   folly::Optional<std::chrono::milliseconds> clientClockSkew_;
   std::unique_ptr<AppTokenValidator> appTokenValidator_;
   std::shared_ptr<ServerExtensions> extensions_;
-  std::vector<uint8_t> resumptionMasterSecret_;
+  SecretStorage resumptionMasterSecret_;
   folly::Optional<std::chrono::system_clock::time_point> handshakeTime_;
 
   std::unique_ptr<HandshakeLogging> handshakeLogging_;
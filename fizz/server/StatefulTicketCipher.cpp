@@ -0,0 +1,88 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/server/StatefulTicketCipher.h>
+
+#include <fizz/crypto/RandomGenerator.h>
+
+namespace fizz {
+namespace server {
+
+namespace {
+
+// Stored state is handed out by copy so a ticket stays redeemable for
+// retries until it expires or is evicted.
+ResumptionState cloneState(const ResumptionState& in) {
+  ResumptionState out;
+  out.version = in.version;
+  out.cipher = in.cipher;
+  out.resumptionSecret =
+      in.resumptionSecret ? in.resumptionSecret->clone() : nullptr;
+  out.serverCert = in.serverCert;
+  out.clientCert = in.clientCert;
+  out.alpn = in.alpn;
+  out.ticketAgeAdd = in.ticketAgeAdd;
+  out.ticketIssueTime = in.ticketIssueTime;
+  out.appToken = in.appToken ? in.appToken->clone() : nullptr;
+  out.handshakeTime = in.handshakeTime;
+  out.cachedEarlySecret = in.cachedEarlySecret;
+  return out;
+}
+} // namespace
+
+StatefulTicketCipher::StatefulTicketCipher(
+    size_t maxEntries,
+    std::chrono::seconds validity)
+    : validity_(validity), clock_(std::make_shared<SystemClock>()) {
+  auto perShard = std::max<size_t>(maxEntries / kNumShards, 1);
+  for (size_t i = 0; i < kNumShards; i++) {
+    shards_.push_back(std::make_unique<Shard>(
+        folly::EvictingCacheMap<std::string, Entry>(perShard)));
+  }
+}
+
+StatefulTicketCipher::Shard& StatefulTicketCipher::getShard(
+    const std::string& id) const {
+  // Ids are uniformly random, so the first byte shards evenly.
+  return *shards_[static_cast<uint8_t>(id[0]) % kNumShards];
+}
+
+folly::Future<folly::Optional<std::pair<Buf, std::chrono::seconds>>>
+StatefulTicketCipher::encrypt(ResumptionState resState) const {
+  auto idBytes = RandomGenerator<kTicketLength>().generateRandom();
+  std::string id(
+      reinterpret_cast<const char*>(idBytes.data()), idBytes.size());
+  auto expiry = clock_->getCurrentTime() + validity_;
+  getShard(id).wlock()->set(id, Entry{std::move(resState), expiry});
+  folly::Optional<std::pair<Buf, std::chrono::seconds>> ticket =
+      std::make_pair(folly::IOBuf::copyBuffer(id), validity_);
+  return ticket;
+}
+
+folly::Future<std::pair<PskType, folly::Optional<ResumptionState>>>
+StatefulTicketCipher::decrypt(
+    std::unique_ptr<folly::IOBuf> encryptedTicket) const {
+  if (encryptedTicket->computeChainDataLength() != kTicketLength) {
+    return std::make_pair(PskType::Rejected, folly::none);
+  }
+  auto idRange = encryptedTicket->coalesce();
+  std::string id(
+      reinterpret_cast<const char*>(idRange.data()), idRange.size());
+  auto shard = getShard(id).wlock();
+  auto it = shard->find(id);
+  if (it == shard->end()) {
+    return std::make_pair(PskType::Rejected, folly::none);
+  }
+  if (clock_->getCurrentTime() >= it->second.expiry) {
+    shard->erase(it);
+    return std::make_pair(PskType::Rejected, folly::none);
+  }
+  return std::make_pair(PskType::Resumption, cloneState(it->second.state));
+}
+} // namespace server
+} // namespace fizz
@@ -0,0 +1,73 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/protocol/clock/SystemClock.h>
+#include <fizz/server/TicketCipher.h>
+
+#include <folly/Synchronized.h>
+#include <folly/container/EvictingCacheMap.h>
+
+#include <memory>
+#include <vector>
+
+namespace fizz {
+namespace server {
+
+/**
+ * TicketCipher that keeps ResumptionState in a sharded in-memory table
+ * instead of sealing it into the ticket. The ticket handed to the
+ * client is a 16 byte random id, so redeeming one costs a hash probe
+ * rather than HKDF plus two AEAD passes. Intended for internal traffic
+ * where both ends are trusted and memory is plentiful.
+ *
+ * Tickets are only redeemable by the process that issued them, since
+ * the stored state owns heap buffers and certs. Deployments that
+ * resume across processes or hosts should keep a sealing cipher,
+ * either alone or alongside this one via DualTicketCipher.
+ *
+ * The table is bounded: each shard evicts its least recently used
+ * ticket at capacity, and entries expire after the configured
+ * validity. A ticket stays redeemable until then, so client retries
+ * with the same ticket still resume.
+ */
+class StatefulTicketCipher : public TicketCipher {
+ public:
+  StatefulTicketCipher(size_t maxEntries, std::chrono::seconds validity);
+
+  void setClock(std::shared_ptr<Clock> clock) {
+    clock_ = std::move(clock);
+  }
+
+  folly::Future<folly::Optional<std::pair<Buf, std::chrono::seconds>>> encrypt(
+      ResumptionState resState) const override;
+
+  folly::Future<std::pair<PskType, folly::Optional<ResumptionState>>> decrypt(
+      std::unique_ptr<folly::IOBuf> encryptedTicket) const override;
+
+ private:
+  struct Entry {
+    ResumptionState state;
+    std::chrono::system_clock::time_point expiry;
+  };
+
+  using Shard =
+      folly::Synchronized<folly::EvictingCacheMap<std::string, Entry>>;
+
+  Shard& getShard(const std::string& id) const;
+
+  static constexpr size_t kTicketLength = 16;
+  static constexpr size_t kNumShards = 16;
+
+  std::chrono::seconds validity_;
+  std::shared_ptr<Clock> clock_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+} // namespace server
+} // namespace fizz
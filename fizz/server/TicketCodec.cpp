@@ -6,7 +6,10 @@
  *  LICENSE file in the root directory of this source tree.
  */
 
+#include <fizz/crypto/Sha256.h>
 #include <fizz/server/TicketCodec.h>
+#include <folly/Synchronized.h>
+#include <folly/container/EvictingCacheMap.h>
 
 namespace fizz {
 std::string toString(fizz::server::CertificateStorage storage) {
@@ -18,11 +21,42 @@ std::string toString(fizz::server::CertificateStorage storage) {
       return "X509";
     case CertificateStorage::IdentityOnly:
       return "IdentityOnly";
+    case CertificateStorage::Fingerprint:
+      return "Fingerprint";
     default:
       return "Unknown storage";
   }
 }
 namespace server {
+
+namespace {
+constexpr size_t kDefaultClientCertCacheSize = 10000;
+
+using ClientCertCache =
+    folly::EvictingCacheMap<std::string, std::shared_ptr<const Cert>>;
+
+folly::Synchronized<ClientCertCache>& getClientCertCache() {
+  // Intentionally leaked so cached certs are not destroyed during static
+  // teardown.
+  static auto cache = new folly::Synchronized<ClientCertCache>(
+      ClientCertCache(kDefaultClientCertCacheSize));
+  return *cache;
+}
+
+std::string certFingerprint(const folly::IOBuf& der) {
+  Sha256 hasher;
+  hasher.hash_init();
+  hasher.hash_update(der);
+  std::array<uint8_t, Sha256::HashLen> digest;
+  hasher.hash_final(folly::MutableByteRange(digest.data(), digest.size()));
+  return std::string(
+      reinterpret_cast<const char*>(digest.data()), digest.size());
+}
+} // namespace
+
+void setClientCertCacheSize(size_t maxEntries) {
+  getClientCertCache().wlock()->setMaxSize(maxEntries);
+}
 void appendClientCertificate(
     CertificateStorage storage,
     const std::shared_ptr<const Cert>& cert,
@@ -34,12 +68,22 @@ void appendClientCertificate(
   } else if (storage == CertificateStorage::X509 && cert->getX509()) {
     selectedStorage = CertificateStorage::X509;
     clientCertBuf = folly::ssl::OpenSSLCertUtils::derEncode(*cert->getX509());
+  } else if (storage == CertificateStorage::Fingerprint && cert->getX509()) {
+    selectedStorage = CertificateStorage::Fingerprint;
+    auto der = folly::ssl::OpenSSLCertUtils::derEncode(*cert->getX509());
+    auto fingerprint = certFingerprint(*der);
+    getClientCertCache().wlock()->set(fingerprint, cert);
+    clientCertBuf = folly::IOBuf::copyBuffer(fingerprint);
   } else {
     selectedStorage = CertificateStorage::IdentityOnly;
     clientCertBuf = folly::IOBuf::copyBuffer(cert->getIdentity());
   }
   fizz::detail::write(selectedStorage, appender);
-  if (selectedStorage != CertificateStorage::None) {
+  if (selectedStorage == CertificateStorage::Fingerprint) {
+    fizz::detail::writeBuf<uint8_t>(clientCertBuf, appender);
+    auto identityBuf = folly::IOBuf::copyBuffer(cert->getIdentity());
+    fizz::detail::writeBuf<uint16_t>(identityBuf, appender);
+  } else if (selectedStorage != CertificateStorage::None) {
     fizz::detail::writeBuf<uint16_t>(clientCertBuf, appender);
   }
 }
@@ -61,6 +105,24 @@ std::shared_ptr<const Cert> readClientCertificate(folly::io::Cursor& cursor) {
       return std::make_shared<const IdentityCert>(
           ident->moveToFbString().toStdString());
     }
+    case CertificateStorage::Fingerprint: {
+      Buf fingerprintBuf;
+      fizz::detail::readBuf<uint8_t>(fingerprintBuf, cursor);
+      Buf ident;
+      fizz::detail::readBuf<uint16_t>(ident, cursor);
+      auto fingerprint = fingerprintBuf->moveToFbString().toStdString();
+      {
+        auto cache = getClientCertCache().wlock();
+        auto it = cache->find(fingerprint);
+        if (it != cache->end()) {
+          return it->second;
+        }
+      }
+      // Evicted or issued by another process; keep the identity so the
+      // connection still knows who the client was.
+      return std::make_shared<const IdentityCert>(
+          ident->moveToFbString().toStdString());
+    }
   }
 
   return nullptr;
@@ -17,7 +17,11 @@ namespace server {
 enum class CertificateStorage : uint8_t {
   None = 0,
   X509 = 1,
-  IdentityOnly = 2
+  IdentityOnly = 2,
+  // Stores a fingerprint referencing a process-wide certificate cache
+  // along with the identity, keeping tickets close to IdentityOnly size
+  // while allowing the full certificate to be recovered on a cache hit.
+  Fingerprint = 3
 };
 }
 
@@ -25,6 +29,14 @@ std::string toString(server::CertificateStorage storage);
 
 namespace server {
 
+/**
+ * Sets the capacity of the process-wide certificate cache used by
+ * CertificateStorage::Fingerprint. Tickets whose fingerprint is not in the
+ * cache (evicted, or issued by another process) fall back to an identity
+ * only certificate on decode.
+ */
+void setClientCertCacheSize(size_t maxEntries);
+
 void appendClientCertificate(
     CertificateStorage storage,
     const std::shared_ptr<const Cert>& cert,
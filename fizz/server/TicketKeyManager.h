@@ -0,0 +1,250 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/crypto/Utils.h>
+#include <fizz/server/AeadTicketCipher.h>
+#include <folly/Synchronized.h>
+
+#include <mutex>
+
+namespace fizz {
+namespace server {
+
+/**
+ * Ticket cipher that derives versioned ticket secrets from a single master
+ * secret and rotates them on a fixed epoch schedule. The current epoch's
+ * secret encrypts new tickets; secrets for a configurable number of previous
+ * epochs (and the next epoch, to tolerate clock skew between servers sharing
+ * the master secret) remain valid for decryption.
+ *
+ * Each epoch's cipher state is built once, complete with its pre-derived key
+ * ring, and published as an immutable snapshot; rotation is a pointer swap
+ * observed at the next epoch boundary, so in-flight handshakes keep using
+ * the snapshot they started with and never race a secret update.
+ */
+template <typename AeadType, typename CodecType, typename HkdfType>
+class TicketKeyManager : public TicketCipher {
+ public:
+  /**
+   * Set the PSK context used for these tickets, forwarded to the underlying
+   * ticket cipher's key derivation.
+   */
+  explicit TicketKeyManager(std::string pskContext)
+      : pskContext_(std::move(pskContext)) {}
+
+  TicketKeyManager() = default;
+
+  ~TicketKeyManager() override {
+    CryptoUtils::clean(folly::range(masterSecret_));
+  }
+
+  /**
+   * Set the master secret that epoch secrets are derived from. Must be at
+   * least kMinMasterSecretLength long. Servers sharing a master secret and
+   * epoch duration derive identical per-epoch secrets, so rotation needs no
+   * coordinated secret push.
+   */
+  bool setMasterSecret(folly::ByteRange masterSecret) {
+    if (masterSecret.size() < kMinMasterSecretLength) {
+      LOG(ERROR) << "Ticket master secret too small - not updating.";
+      return false;
+    }
+    std::lock_guard<std::mutex> guard(rotationMutex_);
+    CryptoUtils::clean(folly::range(masterSecret_));
+    masterSecret_.assign(masterSecret.begin(), masterSecret.end());
+    *cipher_.wlock() = nullptr;
+    return true;
+  }
+
+  /**
+   * How long each epoch's secret encrypts new tickets. Should be no shorter
+   * than the ticket validity period times the previous epoch count, or
+   * outstanding tickets will stop decrypting before they expire.
+   */
+  void setEpochDuration(std::chrono::seconds epochDuration) {
+    epochDuration_ = epochDuration;
+  }
+
+  /**
+   * How many previous epochs' secrets remain valid for decryption (the
+   * rotation overlap window).
+   */
+  void setPreviousEpochCount(size_t count) {
+    previousEpochCount_ = count;
+  }
+
+  /**
+   * Settings forwarded to each epoch's underlying ticket cipher; see
+   * AeadTicketCipher. They apply from the next rotation onwards.
+   */
+  void setEncodeTicketKeyIdentifier(bool enable) {
+    encodeKeyId_ = enable;
+  }
+
+  void setTicketKeyRingSize(size_t size) {
+    keyRingSize_ = size;
+  }
+
+  void setContext(const FizzServerContext* context) {
+    context_ = context;
+  }
+
+  void setHandshakeValidity(std::chrono::seconds validity) {
+    handshakeValidity_ = validity;
+  }
+
+  void setTicketValidity(std::chrono::seconds validity) {
+    ticketValidity_ = validity;
+  }
+
+  void setExecutor(folly::Executor* executor) {
+    executor_ = executor;
+  }
+
+  void setClock(std::shared_ptr<Clock> clock) {
+    clock_ = std::move(clock);
+  }
+
+  /**
+   * The epoch number the manager is currently encrypting with, for
+   * monitoring.
+   */
+  uint64_t getCurrentEpoch() const {
+    return epochAt(clock_->getCurrentTime());
+  }
+
+  folly::Future<folly::Optional<std::pair<Buf, std::chrono::seconds>>> encrypt(
+      ResumptionState resState) const override {
+    auto cipher = getCipher();
+    if (!cipher) {
+      return folly::Optional<std::pair<Buf, std::chrono::seconds>>(
+          folly::none);
+    }
+    // Hold the snapshot until the encrypt completes so rotation (or an
+    // executor hop) can't destroy it out from under us.
+    return cipher->encrypt(std::move(resState)).ensure([cipher] {});
+  }
+
+  folly::Future<std::pair<PskType, folly::Optional<ResumptionState>>> decrypt(
+      std::unique_ptr<folly::IOBuf> encryptedTicket) const override {
+    auto cipher = getCipher();
+    if (!cipher) {
+      return std::make_pair(PskType::Rejected, folly::none);
+    }
+    return cipher->decrypt(std::move(encryptedTicket)).ensure([cipher] {});
+  }
+
+ private:
+  using EpochCipher = AeadTicketCipher<AeadType, CodecType, HkdfType>;
+
+  static constexpr size_t kMinMasterSecretLength = 32;
+  static constexpr size_t kEpochSecretLength = 32;
+
+  uint64_t epochAt(std::chrono::system_clock::time_point time) const {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+               time.time_since_epoch())
+               .count() /
+        epochDuration_.count();
+  }
+
+  std::vector<uint8_t> deriveEpochSecret(uint64_t epoch) const {
+    static constexpr folly::StringPiece kEpochLabel{"ticket key epoch"};
+    auto extracted = HkdfType().extract(
+        folly::range(kEpochLabel), folly::range(masterSecret_));
+    auto epochBe = folly::Endian::big(epoch);
+    auto info = folly::IOBuf::wrapBuffer(&epochBe, sizeof(epochBe));
+    auto expanded =
+        HkdfType().expand(folly::range(extracted), *info, kEpochSecretLength);
+    auto range = expanded->coalesce();
+    std::vector<uint8_t> secret(range.begin(), range.end());
+    CryptoUtils::clean(folly::range(extracted));
+    return secret;
+  }
+
+  std::shared_ptr<const EpochCipher> buildCipher(uint64_t epoch) const {
+    auto cipher = pskContext_ ? std::make_shared<EpochCipher>(*pskContext_)
+                              : std::make_shared<EpochCipher>();
+
+    // First secret encrypts; the previous epochs and (for clock skew
+    // between servers) the next epoch are decrypt-only.
+    std::vector<std::vector<uint8_t>> secrets;
+    secrets.push_back(deriveEpochSecret(epoch));
+    for (size_t i = 1; i <= previousEpochCount_ && i <= epoch; i++) {
+      secrets.push_back(deriveEpochSecret(epoch - i));
+    }
+    secrets.push_back(deriveEpochSecret(epoch + 1));
+    std::vector<folly::ByteRange> secretRanges;
+    for (const auto& secret : secrets) {
+      secretRanges.push_back(folly::range(secret));
+    }
+
+    cipher->setEncodeTicketKeyIdentifier(encodeKeyId_);
+    cipher->setTicketKeyRingSize(keyRingSize_);
+    cipher->setContext(context_);
+    cipher->setHandshakeValidity(handshakeValidity_);
+    cipher->setTicketValidity(ticketValidity_);
+    cipher->setClock(clock_);
+    cipher->setExecutor(executor_);
+    cipher->setTicketSecrets(secretRanges);
+
+    for (auto& secret : secrets) {
+      CryptoUtils::clean(folly::range(secret));
+    }
+    return cipher;
+  }
+
+  std::shared_ptr<const EpochCipher> getCipher() const {
+    auto epoch = getCurrentEpoch();
+    {
+      auto rlock = cipher_.rlock();
+      if (*rlock && epoch == cipherEpoch_) {
+        return *rlock;
+      }
+    }
+
+    std::lock_guard<std::mutex> guard(rotationMutex_);
+    {
+      // Another thread may have rotated while we waited for the lock.
+      auto rlock = cipher_.rlock();
+      if (*rlock && epoch == cipherEpoch_) {
+        return *rlock;
+      }
+    }
+    if (masterSecret_.empty()) {
+      return nullptr;
+    }
+    auto built = buildCipher(epoch);
+    auto wlock = cipher_.wlock();
+    cipherEpoch_ = epoch;
+    *wlock = built;
+    return built;
+  }
+
+  folly::Optional<std::string> pskContext_;
+  std::vector<uint8_t> masterSecret_;
+
+  std::chrono::seconds epochDuration_{std::chrono::hours(24)};
+  size_t previousEpochCount_{1};
+
+  bool encodeKeyId_{false};
+  size_t keyRingSize_{0};
+  std::chrono::seconds ticketValidity_{std::chrono::hours(1)};
+  std::chrono::seconds handshakeValidity_{std::chrono::hours(72)};
+  const FizzServerContext* context_{nullptr};
+  folly::Executor* executor_{nullptr};
+  std::shared_ptr<Clock> clock_{std::make_shared<SystemClock>()};
+
+  mutable folly::Synchronized<std::shared_ptr<const EpochCipher>> cipher_;
+  // Guarded by cipher_'s lock (read under rlock, written under wlock).
+  mutable uint64_t cipherEpoch_{0};
+  mutable std::mutex rotationMutex_;
+};
+} // namespace server
+} // namespace fizz
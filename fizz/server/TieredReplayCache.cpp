@@ -0,0 +1,56 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/server/TieredReplayCache.h>
+
+namespace fizz {
+namespace server {
+
+TieredReplayCache::TieredReplayCache(
+    std::unique_ptr<SlidingBloomReplayCache> localCache,
+    std::shared_ptr<ReplayCache> remoteCache,
+    PendingPolicy policy)
+    : localCache_(std::move(localCache)),
+      remoteCache_(std::move(remoteCache)),
+      policy_(policy) {}
+
+folly::Future<ReplayCacheResult> TieredReplayCache::check(
+    folly::ByteRange identifier) {
+  if (localCache_->testAndSet(identifier)) {
+    VLOG(8) << "Replay rejected by local filter";
+    return ReplayCacheResult::MaybeReplay;
+  }
+
+  // Copy the identifier so the remote check can outlive the caller's
+  // buffer.
+  auto id = std::make_unique<std::string>(identifier.str());
+  auto range = folly::ByteRange(folly::StringPiece(*id));
+  auto remoteFuture = remoteCache_->check(range).thenTry(
+      [id = std::move(id)](folly::Try<ReplayCacheResult> result) {
+        if (result.hasException()) {
+          VLOG(5) << "Remote replay check failed: "
+                  << result.exception().what();
+          return ReplayCacheResult::MaybeReplay;
+        }
+        return *result;
+      });
+
+  if (policy_ == PendingPolicy::Pessimistic) {
+    return remoteFuture;
+  }
+
+  std::move(remoteFuture).thenValue([this](ReplayCacheResult result) {
+    if (result != ReplayCacheResult::NotReplay) {
+      lateRemoteHits_++;
+      VLOG(5) << "Remote replay hit after optimistic local accept";
+    }
+  });
+  return ReplayCacheResult::NotReplay;
+}
+} // namespace server
+} // namespace fizz
@@ -0,0 +1,70 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include <fizz/server/ReplayCache.h>
+#include <fizz/server/SlidingBloomReplayCache.h>
+
+namespace fizz {
+namespace server {
+
+/**
+ * Two-tier replay cache for multi-host 0-RTT. A local
+ * SlidingBloomReplayCache acts as a front filter: identifiers it has
+ * already seen are rejected without touching the remote backend. On a
+ * local miss the identifier is recorded locally and checked against the
+ * remote cache, whose result is handled per the configured policy.
+ */
+class TieredReplayCache : public ReplayCache {
+ public:
+  enum class PendingPolicy {
+    /**
+     * Resolve to NotReplay as soon as the local filter misses, letting
+     * early data proceed while the remote check completes in the
+     * background. Late remote hits are counted but cannot reject the
+     * handshake any more.
+     */
+    Optimistic,
+    /**
+     * Wait for the remote result before resolving. Remote failures fail
+     * closed as MaybeReplay, rejecting early data but not the handshake.
+     */
+    Pessimistic,
+  };
+
+  TieredReplayCache(
+      std::unique_ptr<SlidingBloomReplayCache> localCache,
+      std::shared_ptr<ReplayCache> remoteCache,
+      PendingPolicy policy = PendingPolicy::Optimistic);
+  ~TieredReplayCache() override = default;
+
+  folly::Future<ReplayCacheResult> check(folly::ByteRange identifier) override;
+
+  /**
+   * Number of identifiers the remote cache reported as replays after the
+   * optimistic policy had already accepted them locally.
+   */
+  uint64_t getLateRemoteHits() const {
+    return lateRemoteHits_.load();
+  }
+
+ private:
+  std::unique_ptr<SlidingBloomReplayCache> localCache_;
+  std::shared_ptr<ReplayCache> remoteCache_;
+  PendingPolicy policy_;
+
+  std::atomic<uint64_t> lateRemoteHits_{0};
+};
+
+} // namespace server
+} // namespace fizz
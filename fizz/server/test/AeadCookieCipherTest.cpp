@@ -136,6 +136,29 @@ TEST_F(AeadCookieCipherTest, TestDecryptMultipleSecrets) {
   EXPECT_FALSE(state->group.hasValue());
 }
 
+TEST_F(AeadCookieCipherTest, TestCookieCodecZeroCopy) {
+  CookieState state;
+  state.version = ProtocolVersion::tls_1_3;
+  state.cipher = CipherSuite::TLS_AES_128_GCM_SHA256;
+  state.chloHash = IOBuf::copyBuffer("chlohashchlohashchlohashchlohash");
+  state.appToken = IOBuf::copyBuffer("token");
+
+  auto encoded = detail::encodeCookie(state);
+  bool sharesHash = false;
+  for (auto range : *encoded) {
+    if (range.data() == state.chloHash->data()) {
+      sharesHash = true;
+    }
+  }
+  EXPECT_TRUE(sharesHash);
+
+  auto decoded = detail::decodeCookie(encoded->clone());
+  EXPECT_TRUE(IOBufEqualTo()(decoded.chloHash, state.chloHash));
+  EXPECT_TRUE(IOBufEqualTo()(decoded.appToken, state.appToken));
+  // Decoded fields alias the token buffer instead of copying out of it.
+  EXPECT_EQ(decoded.chloHash->data(), state.chloHash->data());
+}
+
 TEST_F(AeadCookieCipherTest, TestDecryptFailed) {
   auto s1 = RandomGenerator<32>().generateRandom();
   auto s2 = RandomGenerator<32>().generateRandom();
@@ -16,6 +16,7 @@
 #include <fizz/crypto/test/TestUtil.h>
 #include <fizz/protocol/clock/test/Mocks.h>
 #include <folly/String.h>
+#include <folly/executors/ManualExecutor.h>
 
 using namespace fizz::test;
 using namespace folly;
@@ -138,6 +139,112 @@ TEST_F(AeadTicketCipherTest, TestEncrypt) {
   EXPECT_EQ(result->second, std::chrono::seconds(5));
 }
 
+TEST_F(AeadTicketCipherTest, TestKeyIdentifierRoundTrip) {
+  setTicketSecrets();
+  cipher_.setEncodeTicketKeyIdentifier(true);
+  EXPECT_CALL(codec_, _encode(_)).WillOnce(InvokeWithoutArgs([]() {
+    return IOBuf::copyBuffer("encodedticket");
+  }));
+  expectDecode();
+  auto result = cipher_.encrypt(ResumptionState()).get();
+  EXPECT_TRUE(result.hasValue());
+  auto decResult = cipher_.decrypt(result->first->clone()).get();
+  EXPECT_EQ(decResult.first, PskType::Resumption);
+  EXPECT_TRUE(decResult.second.hasValue());
+}
+
+TEST_F(AeadTicketCipherTest, TestKeyRingRoundTrip) {
+  setTicketSecrets();
+  cipher_.setTicketKeyRingSize(4);
+  EXPECT_CALL(codec_, _encode(_))
+      .Times(2)
+      .WillRepeatedly(InvokeWithoutArgs(
+          []() { return IOBuf::copyBuffer("encodedticket"); }));
+  EXPECT_CALL(codec_, _decode(_, _))
+      .Times(2)
+      .WillRepeatedly(InvokeWithoutArgs([]() { return ResumptionState(); }));
+  auto first = cipher_.encrypt(ResumptionState()).get();
+  auto second = cipher_.encrypt(ResumptionState()).get();
+  EXPECT_TRUE(first.hasValue());
+  EXPECT_TRUE(second.hasValue());
+  EXPECT_FALSE(IOBufEqualTo()(first->first, second->first));
+  EXPECT_EQ(
+      cipher_.decrypt(first->first->clone()).get().first,
+      PskType::Resumption);
+  EXPECT_EQ(
+      cipher_.decrypt(second->first->clone()).get().first,
+      PskType::Resumption);
+}
+
+TEST_F(AeadTicketCipherTest, TestKeyRingSecretRotation) {
+  setTicketSecrets();
+  cipher_.setTicketKeyRingSize(4);
+  EXPECT_CALL(codec_, _encode(_))
+      .Times(2)
+      .WillRepeatedly(InvokeWithoutArgs(
+          []() { return IOBuf::copyBuffer("encodedticket"); }));
+  EXPECT_CALL(codec_, _decode(_, _))
+      .Times(2)
+      .WillRepeatedly(InvokeWithoutArgs([]() { return ResumptionState(); }));
+  auto first = cipher_.encrypt(ResumptionState()).get();
+  EXPECT_TRUE(first.hasValue());
+
+  // Rotate: secret 2 becomes the encryption secret while secret 1 is
+  // retained for decryption. The per-thread ring is rebuilt from the new
+  // secret; tickets sealed with the old ring keys must still decrypt.
+  auto s1 = toIOBuf(ticketSecret1);
+  auto s2 = toIOBuf(ticketSecret2);
+  std::vector<ByteRange> rotated{{s2->coalesce(), s1->coalesce()}};
+  EXPECT_TRUE(cipher_.setTicketSecrets(std::move(rotated)));
+
+  auto second = cipher_.encrypt(ResumptionState()).get();
+  EXPECT_TRUE(second.hasValue());
+  EXPECT_EQ(
+      cipher_.decrypt(first->first->clone()).get().first,
+      PskType::Resumption);
+  EXPECT_EQ(
+      cipher_.decrypt(second->first->clone()).get().first,
+      PskType::Resumption);
+}
+
+TEST_F(AeadTicketCipherTest, TestKeyRingLegacyDecrypt) {
+  setTicketSecrets();
+  cipher_.setTicketKeyRingSize(4);
+  expectDecode();
+  auto result = cipher_.decrypt(toIOBuf(ticket1)).get();
+  EXPECT_EQ(result.first, PskType::Resumption);
+  EXPECT_TRUE(result.second.hasValue());
+}
+
+TEST_F(AeadTicketCipherTest, TestKeyIdentifierLegacyDecrypt) {
+  setTicketSecrets();
+  cipher_.setEncodeTicketKeyIdentifier(true);
+  expectDecode();
+  auto result = cipher_.decrypt(toIOBuf(ticket1)).get();
+  EXPECT_EQ(result.first, PskType::Resumption);
+  EXPECT_TRUE(result.second.hasValue());
+}
+
+TEST_F(AeadTicketCipherTest, TestEncryptOnExecutor) {
+  folly::ManualExecutor executor;
+  setTicketSecrets();
+  useMockRandom();
+  cipher_.setExecutor(&executor);
+  cipher_.setTicketValidity(std::chrono::seconds(5));
+  EXPECT_CALL(codec_, _encode(_)).WillOnce(InvokeWithoutArgs([]() {
+    return IOBuf::copyBuffer("encodedticket");
+  }));
+  ResumptionState state;
+  auto future = cipher_.encrypt(std::move(state));
+  EXPECT_FALSE(future.isReady());
+  while (executor.run()) {
+  }
+  auto result = std::move(future).get();
+  EXPECT_TRUE(result.hasValue());
+  EXPECT_TRUE(IOBufEqualTo()(result->first, toIOBuf(ticket1)));
+  EXPECT_EQ(result->second, std::chrono::seconds(5));
+}
+
 TEST_F(AeadTicketCipherTest, TestHandshakeExpiration) {
   setTicketSecrets();
   useMockRandom();
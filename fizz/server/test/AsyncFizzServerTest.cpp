@@ -150,6 +150,21 @@ TEST_F(AsyncFizzServerTest, TestAccept) {
   accept();
 }
 
+TEST_F(AsyncFizzServerTest, TestAcceptPreReadData) {
+  expectTransportReadCallback();
+  EXPECT_CALL(*socket_, getEventBase()).WillOnce(Return(&evb_));
+  EXPECT_CALL(*machine_, _processAccept(_, &evb_, _, _))
+      .WillOnce(InvokeWithoutArgs([]() { return actions(); }));
+  // The routed bytes are processed during accept(), without waiting for a
+  // read event.
+  EXPECT_CALL(*machine_, _processSocketData(_, _))
+      .WillOnce(Invoke([](const State&, IOBufQueue& queue) {
+        EXPECT_EQ(queue.move()->moveToFbString().toStdString(), "ClientHello");
+        return actions(WaitForData());
+      }));
+  server_->accept(&handshakeCallback_, IOBuf::copyBuffer("ClientHello"));
+}
+
 TEST_F(AsyncFizzServerTest, TestReadSingle) {
   accept();
   EXPECT_CALL(*machine_, _processSocketData(_, _))
@@ -231,6 +246,67 @@ TEST_F(AsyncFizzServerTest, TestDeliverAppData) {
   socketReadCallback_->readBufferAvailable(IOBuf::copyBuffer("ClientHello"));
 }
 
+TEST_F(AsyncFizzServerTest, TestAppDataFastPath) {
+  completeHandshake();
+  server_->setReadCB(&readCallback_);
+  server_->setAppDataFastPath(true);
+
+  auto rl = new MockEncryptedReadRecordLayer(EncryptionLevel::AppTraffic);
+  EXPECT_CALL(*machine_, _processSocketData(_, _))
+      .WillOnce(InvokeWithoutArgs([rl]() {
+        return actions(
+            [rl](State& newState) {
+              newState.readRecordLayer().reset(rl);
+              newState.state() = StateEnum::AcceptingData;
+            },
+            WaitForData());
+      }));
+  socketReadCallback_->readBufferAvailable(IOBuf::copyBuffer("Finished"));
+
+  // App data records now bypass the state machine: no further
+  // _processSocketData calls are expected.
+  EXPECT_CALL(*rl, hasUnparsedHandshakeData()).WillRepeatedly(Return(false));
+  EXPECT_CALL(*rl, read(_))
+      .WillOnce(InvokeWithoutArgs([]() {
+        return folly::Optional<TLSMessage>(TLSMessage{
+            ContentType::application_data, IOBuf::copyBuffer("fastpath")});
+      }))
+      .WillOnce(
+          InvokeWithoutArgs([]() { return folly::Optional<TLSMessage>(); }));
+  auto expected = IOBuf::copyBuffer("fastpath");
+  EXPECT_CALL(readCallback_, readBufferAvailable_(BufMatches(expected.get())));
+  socketReadCallback_->readBufferAvailable(IOBuf::copyBuffer("appdata"));
+}
+
+TEST_F(AsyncFizzServerTest, TestAppDataWriteFastPath) {
+  completeHandshake();
+  server_->setAppDataFastPath(true);
+
+  auto rl = new MockEncryptedWriteRecordLayer(EncryptionLevel::AppTraffic);
+  EXPECT_CALL(*machine_, _processSocketData(_, _))
+      .WillOnce(InvokeWithoutArgs([rl]() {
+        return actions(
+            [rl](State& newState) {
+              newState.writeRecordLayer().reset(rl);
+              newState.state() = StateEnum::AcceptingData;
+            },
+            WaitForData());
+      }));
+  socketReadCallback_->readBufferAvailable(IOBuf::copyBuffer("Finished"));
+
+  // Writes now bypass the state machine: no _processAppWrite calls are
+  // expected.
+  EXPECT_CALL(*rl, _write(_)).WillOnce(Invoke([](TLSMessage& msg) {
+    TLSContent content;
+    content.contentType = msg.type;
+    content.encryptionLevel = EncryptionLevel::AppTraffic;
+    content.data = IOBuf::copyBuffer("ciphertext");
+    return content;
+  }));
+  EXPECT_CALL(*socket_, writeChain(_, _, _));
+  server_->writeChain(nullptr, IOBuf::copyBuffer("appdata"));
+}
+
 TEST_F(AsyncFizzServerTest, TestWriteToSocket) {
   completeHandshake();
   server_->setReadCB(&readCallback_);
@@ -248,6 +324,29 @@ TEST_F(AsyncFizzServerTest, TestWriteToSocket) {
   socketReadCallback_->readBufferAvailable(IOBuf::copyBuffer("ClientHello"));
 }
 
+TEST_F(AsyncFizzServerTest, TestWriteToSocketCoalesced) {
+  completeHandshake();
+  server_->setReadCB(&readCallback_);
+  EXPECT_CALL(*machine_, _processSocketData(_, _))
+      .WillOnce(InvokeWithoutArgs([]() {
+        auto makeWrite = [](const char* data) {
+          WriteToSocket write;
+          TLSContent record;
+          record.contentType = ContentType::application_data;
+          record.encryptionLevel = EncryptionLevel::AppTraffic;
+          record.data = IOBuf::copyBuffer(data);
+          write.contents.emplace_back(std::move(record));
+          return write;
+        };
+        return actions(makeWrite("XYZ"), makeWrite("ABC"), WaitForData());
+      }));
+  // Both writes from one set of actions must coalesce into a single
+  // writeChain call.
+  auto expected = IOBuf::copyBuffer("XYZABC");
+  EXPECT_CALL(*socket_, writeChain(_, BufMatches(expected.get()), _));
+  socketReadCallback_->readBufferAvailable(IOBuf::copyBuffer("ClientHello"));
+}
+
 TEST_F(AsyncFizzServerTest, TestMutateState) {
   completeHandshake();
   server_->setReadCB(&readCallback_);
@@ -361,6 +460,54 @@ TEST_F(AsyncFizzServerTest, TestIsDetachable) {
   EXPECT_TRUE(server_->isDetachable());
 }
 
+TEST_F(AsyncFizzServerTest, TestSessionStateExtractable) {
+  accept();
+  EXPECT_FALSE(server_->sessionStateExtractable());
+  EXPECT_CALL(*machine_, _processSocketData(_, _))
+      .WillOnce(Invoke([](const State&, folly::IOBufQueue& queue) {
+        queue.move();
+        return actions(
+            [](State& newState) {
+              newState.state() = StateEnum::AcceptingData;
+            },
+            ReportHandshakeSuccess(),
+            WaitForData());
+      }));
+  EXPECT_CALL(handshakeCallback_, _fizzHandshakeSuccess());
+  socketReadCallback_->readBufferAvailable(IOBuf::copyBuffer("ClientHello"));
+  EXPECT_TRUE(server_->sessionStateExtractable());
+}
+
+TEST_F(AsyncFizzServerTest, TestSessionStateMigration) {
+  completeHandshake();
+  server_->setReadCB(&readCallback_);
+  EXPECT_CALL(*machine_, _processSocketData(_, _))
+      .WillOnce(Invoke([](const State&, folly::IOBufQueue& queue) {
+        queue.move();
+        return actions(
+            [](State& newState) {
+              newState.state() = StateEnum::AcceptingData;
+            },
+            WaitForData());
+      }));
+  socketReadCallback_->readBufferAvailable(IOBuf::copyBuffer("AppData"));
+
+  auto transport = server_->extractTransport();
+  auto state = server_->extractSessionState();
+  EXPECT_EQ(state.state(), StateEnum::AcceptingData);
+
+  expectTransportReadCallback();
+  EXPECT_CALL(*socket_, getEventBase()).WillOnce(Return(&evb_));
+  server_.reset(new AsyncFizzServerT<MockServerStateMachineInstance>(
+      std::move(transport), context_, std::move(state)));
+  machine_ = MockServerStateMachineInstance::instance;
+  EXPECT_EQ(server_->getCipher(), CipherSuite::TLS_AES_128_GCM_SHA256);
+
+  EXPECT_CALL(*machine_, _processAppWrite(_, _))
+      .WillOnce(InvokeWithoutArgs([]() { return actions(); }));
+  server_->writeChain(nullptr, IOBuf::copyBuffer("echo"));
+}
+
 TEST_F(AsyncFizzServerTest, TestConnecting) {
   ON_CALL(*socket_, connecting()).WillByDefault(Return(true));
   EXPECT_TRUE(server_->connecting());
@@ -0,0 +1,106 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GMock.h>
+#include <folly/portability/GTest.h>
+
+#include <fizz/server/BatchedReplayCache.h>
+#include <fizz/server/SlidingBloomReplayCache.h>
+
+using namespace folly;
+
+namespace fizz {
+namespace server {
+namespace test {
+
+class CountingReplayCache : public ReplayCache {
+ public:
+  folly::Future<ReplayCacheResult> check(folly::ByteRange) override {
+    singleChecks_++;
+    return ReplayCacheResult::NotReplay;
+  }
+
+  folly::Future<std::vector<ReplayCacheResult>> checkBatch(
+      const std::vector<folly::ByteRange>& identifiers) override {
+    batchSizes_.push_back(identifiers.size());
+    return std::vector<ReplayCacheResult>(
+        identifiers.size(), ReplayCacheResult::NotReplay);
+  }
+
+  size_t singleChecks_{0};
+  std::vector<size_t> batchSizes_;
+};
+
+static folly::ByteRange toRange(const std::string& str) {
+  return folly::ByteRange(folly::StringPiece(str));
+}
+
+TEST(BatchedReplayCacheTest, TestDefaultCheckBatch) {
+  SlidingBloomReplayCache cache(12, 100, 0.0005, nullptr);
+  std::vector<std::string> ids = {"one", "two", "three"};
+  std::vector<folly::ByteRange> ranges;
+  for (const auto& id : ids) {
+    ranges.push_back(toRange(id));
+  }
+
+  auto results = cache.checkBatch(ranges).get();
+  ASSERT_EQ(results.size(), 3);
+  for (auto result : results) {
+    EXPECT_EQ(result, ReplayCacheResult::NotReplay);
+  }
+
+  results = cache.checkBatch(ranges).get();
+  ASSERT_EQ(results.size(), 3);
+  for (auto result : results) {
+    EXPECT_EQ(result, ReplayCacheResult::MaybeReplay);
+  }
+}
+
+TEST(BatchedReplayCacheTest, TestWindowDispatch) {
+  folly::EventBase evb;
+  auto backend = std::make_shared<CountingReplayCache>();
+  BatchedReplayCache cache(backend, &evb, std::chrono::milliseconds(10));
+
+  std::vector<std::string> ids = {"a", "b", "c", "d", "e"};
+  std::vector<folly::Future<ReplayCacheResult>> futures;
+  for (const auto& id : ids) {
+    futures.push_back(cache.check(toRange(id)));
+  }
+  evb.loop();
+
+  for (auto& future : futures) {
+    ASSERT_TRUE(future.isReady());
+    EXPECT_EQ(std::move(future).get(), ReplayCacheResult::NotReplay);
+  }
+  EXPECT_EQ(backend->singleChecks_, 0);
+  ASSERT_EQ(backend->batchSizes_.size(), 1);
+  EXPECT_EQ(backend->batchSizes_[0], 5);
+}
+
+TEST(BatchedReplayCacheTest, TestMaxBatchSizeDispatch) {
+  folly::EventBase evb;
+  auto backend = std::make_shared<CountingReplayCache>();
+  BatchedReplayCache cache(backend, &evb, std::chrono::milliseconds(10), 2);
+
+  std::vector<std::string> ids = {"a", "b", "c", "d", "e"};
+  std::vector<folly::Future<ReplayCacheResult>> futures;
+  for (const auto& id : ids) {
+    futures.push_back(cache.check(toRange(id)));
+  }
+  evb.loop();
+
+  for (auto& future : futures) {
+    ASSERT_TRUE(future.isReady());
+    EXPECT_EQ(std::move(future).get(), ReplayCacheResult::NotReplay);
+  }
+  std::vector<size_t> expected = {2, 2, 1};
+  EXPECT_EQ(backend->batchSizes_, expected);
+}
+} // namespace test
+} // namespace server
+} // namespace fizz
@@ -0,0 +1,108 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GMock.h>
+#include <folly/portability/GTest.h>
+
+#include <fizz/server/BatchedTicketCipher.h>
+
+#include <folly/executors/ManualExecutor.h>
+
+using namespace folly;
+
+namespace fizz {
+namespace server {
+namespace test {
+
+class CountingTicketCipher : public TicketCipher {
+ public:
+  folly::Future<folly::Optional<std::pair<Buf, std::chrono::seconds>>> encrypt(
+      ResumptionState) const override {
+    encrypts_++;
+    return folly::none;
+  }
+
+  folly::Future<std::pair<PskType, folly::Optional<ResumptionState>>> decrypt(
+      std::unique_ptr<folly::IOBuf>) const override {
+    decrypts_++;
+    return std::make_pair(PskType::Resumption, folly::none);
+  }
+
+  mutable size_t encrypts_{0};
+  mutable size_t decrypts_{0};
+};
+
+static std::unique_ptr<folly::IOBuf> ticket() {
+  return folly::IOBuf::copyBuffer("ticket");
+}
+
+TEST(BatchedTicketCipherTest, TestWindowDispatch) {
+  folly::EventBase evb;
+  folly::ManualExecutor executor;
+  auto backend = std::make_shared<CountingTicketCipher>();
+  BatchedTicketCipher cipher(
+      backend, &evb, &executor, std::chrono::milliseconds(10));
+
+  std::vector<
+      folly::Future<std::pair<PskType, folly::Optional<ResumptionState>>>>
+      futures;
+  for (int i = 0; i < 3; i++) {
+    futures.push_back(cipher.decrypt(ticket()));
+  }
+  evb.loop();
+
+  // The whole window's worth of tickets crosses to the executor as one
+  // task and opens there.
+  for (auto& future : futures) {
+    EXPECT_FALSE(future.isReady());
+  }
+  EXPECT_EQ(executor.run(), 1);
+  EXPECT_EQ(backend->decrypts_, 3);
+  for (auto& future : futures) {
+    ASSERT_TRUE(future.isReady());
+    EXPECT_EQ(std::move(future).get().first, PskType::Resumption);
+  }
+}
+
+TEST(BatchedTicketCipherTest, TestMaxBatchSizeDispatch) {
+  folly::EventBase evb;
+  folly::ManualExecutor executor;
+  auto backend = std::make_shared<CountingTicketCipher>();
+  BatchedTicketCipher cipher(
+      backend, &evb, &executor, std::chrono::milliseconds(10), 2);
+
+  std::vector<
+      folly::Future<std::pair<PskType, folly::Optional<ResumptionState>>>>
+      futures;
+  for (int i = 0; i < 5; i++) {
+    futures.push_back(cipher.decrypt(ticket()));
+  }
+  evb.loop();
+
+  // Two full batches dispatch on size, the straggler on the timer.
+  EXPECT_EQ(executor.run(), 3);
+  EXPECT_EQ(backend->decrypts_, 5);
+  for (auto& future : futures) {
+    ASSERT_TRUE(future.isReady());
+  }
+}
+
+TEST(BatchedTicketCipherTest, TestEncryptPassthrough) {
+  folly::EventBase evb;
+  folly::ManualExecutor executor;
+  auto backend = std::make_shared<CountingTicketCipher>();
+  BatchedTicketCipher cipher(
+      backend, &evb, &executor, std::chrono::milliseconds(10));
+
+  auto result = cipher.encrypt(ResumptionState()).get();
+  EXPECT_FALSE(result.hasValue());
+  EXPECT_EQ(backend->encrypts_, 1);
+}
+} // namespace test
+} // namespace server
+} // namespace fizz
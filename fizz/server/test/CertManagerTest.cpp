@@ -11,7 +11,10 @@
 
 #include <fizz/server/CertManager.h>
 
+#include <fizz/crypto/test/TestUtil.h>
 #include <fizz/protocol/test/Mocks.h>
+#include <folly/FileUtil.h>
+#include <folly/experimental/TestUtil.h>
 
 using namespace fizz::test;
 using namespace folly;
@@ -133,6 +136,50 @@ TEST_F(CertManagerTest, TestClientSigSchemeFallback) {
   EXPECT_EQ(res->second, SignatureScheme::rsa_pss_sha256);
 }
 
+TEST_F(CertManagerTest, TestDelegatedCertPreference) {
+  auto cert = getCert("www.test.com", {}, kRsa);
+  auto delegated =
+      getCert("www.test.com", {}, {SignatureScheme::ecdsa_secp256r1_sha256});
+  manager_.addCert(cert, true);
+  manager_.addDelegatedCert(delegated, true);
+
+  auto res = manager_.getDelegatedCert(
+      std::string("www.test.com"),
+      {SignatureScheme::ecdsa_secp256r1_sha256},
+      {SignatureScheme::ecdsa_secp256r1_sha256});
+  ASSERT_TRUE(res.hasValue());
+  EXPECT_EQ(res->first, delegated);
+
+  // No last-resort: a credential the client cannot verify is not served.
+  EXPECT_FALSE(manager_
+                   .getDelegatedCert(
+                       std::string("www.test.com"),
+                       {SignatureScheme::ecdsa_secp256r1_sha256},
+                       kRsa)
+                   .hasValue());
+
+  // Regular selection never returns delegated certs.
+  auto regular = manager_.getCert(std::string("www.test.com"), kRsa, kRsa);
+  EXPECT_EQ(regular->first, cert);
+}
+
+TEST_F(CertManagerTest, TestUnknownSigScheme) {
+  // Schemes outside the known enum get no precomputed mask bit and must
+  // still match through the slow path.
+  auto unknown = static_cast<SignatureScheme>(0xfe0f);
+  auto cert = getCert("www.test.com", {}, {unknown});
+  manager_.addCert(cert);
+
+  auto res =
+      manager_.getCert(std::string("www.test.com"), {unknown}, {unknown});
+  EXPECT_EQ(res->first, cert);
+  EXPECT_EQ(res->second, unknown);
+
+  res = manager_.getCert(std::string("www.test.com"), {unknown}, kRsa);
+  EXPECT_EQ(res->first, cert);
+  EXPECT_EQ(res->second, unknown);
+}
+
 TEST_F(CertManagerTest, TestAlts) {
   auto cert = getCert(
       "www.test.com",
@@ -190,6 +237,68 @@ TEST_F(CertManagerTest, TestGetByIdentity) {
   EXPECT_EQ(manager_.getCert("foo.test.com"), nullptr);
   EXPECT_EQ(manager_.getCert("www.blah.com"), nullptr);
 }
+
+TEST_F(CertManagerTest, TestBundleLoad) {
+  folly::test::TemporaryFile bundleFile("bundle");
+  std::string bundle;
+  bundle += kP256Key.str();
+  bundle += kP256Certificate.str();
+  bundle += kRSAKey.str();
+  bundle += kRSACertificate.str();
+  folly::writeFileAtomic(bundleFile.path().string(), bundle);
+
+  manager_.addCertsFromBundle(bundleFile.path().string(), 2);
+
+  auto res = manager_.getCert(
+      std::string("Fizz"),
+      {SignatureScheme::ecdsa_secp256r1_sha256},
+      {SignatureScheme::ecdsa_secp256r1_sha256});
+  ASSERT_TRUE(res.hasValue());
+  EXPECT_EQ(
+      res->first->getSigSchemes(), CertUtils::getSigSchemes<KeyType::P256>());
+  EXPECT_EQ(res->first->getIdentity(), "Fizz");
+
+  res = manager_.getCert(
+      std::string("Fizz"),
+      {SignatureScheme::rsa_pss_sha256},
+      {SignatureScheme::rsa_pss_sha256});
+  ASSERT_TRUE(res.hasValue());
+
+  // Signing materializes the lazily loaded private key.
+  auto sig = res->first->sign(
+      SignatureScheme::rsa_pss_sha256,
+      CertificateVerifyContext::Server,
+      folly::StringPiece("tosign"));
+  EXPECT_TRUE(sig);
+}
+
+TEST_F(CertManagerTest, TestBundleLoadEmpty) {
+  folly::test::TemporaryFile bundleFile("bundle");
+  folly::writeFileAtomic(bundleFile.path().string(), std::string("no pem"));
+  EXPECT_THROW(
+      manager_.addCertsFromBundle(bundleFile.path().string()),
+      std::runtime_error);
+}
+
+TEST_F(CertManagerTest, TestPrecompressOnAdd) {
+  auto compressor = std::make_shared<MockCertificateCompressor>();
+  compressor->setDefaults();
+  manager_.setCertificateCompressors({compressor});
+
+  auto cert = getCert("www.test.com", {}, kRsa);
+  EXPECT_CALL(*cert, precompressCert(Ref(*compressor)));
+  manager_.addCert(cert);
+}
+
+TEST_F(CertManagerTest, TestPrecompressExistingCerts) {
+  auto cert = getCert("www.test.com", {}, kRsa);
+  manager_.addCert(cert);
+
+  auto compressor = std::make_shared<MockCertificateCompressor>();
+  compressor->setDefaults();
+  EXPECT_CALL(*cert, precompressCert(Ref(*compressor)));
+  manager_.setCertificateCompressors({compressor});
+}
 } // namespace test
 } // namespace server
 } // namespace fizz
@@ -0,0 +1,228 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/record/Extensions.h>
+#include <fizz/record/Types.h>
+#include <fizz/server/FizzServerContext.h>
+#include <fizz/server/Negotiator.h>
+#include <fizz/test/MallocCounter.h>
+
+#include <folly/FileUtil.h>
+#include <folly/ScopeGuard.h>
+#include <folly/init/Init.h>
+
+#include <dirent.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * ClientHello corpus replay benchmark.
+ *
+ * Replays a directory of raw ClientHello handshake message bodies (as
+ * captured from production traffic) through decode<ClientHello>, the
+ * extension lookups the ClientHello handler performs, and the
+ * Negotiator-based parameter selection, with no sockets or crypto. This
+ * pins the real-world parse+negotiate cost across the full variety of
+ * client implementations, which synthetic hellos miss.
+ *
+ * With --corpus unset a single representative synthetic hello is used,
+ * so the benchmark still runs standalone.
+ */
+
+DEFINE_string(corpus, "", "Directory of raw ClientHello message bodies");
+DEFINE_int32(iterations, 10000, "Replay passes over the corpus");
+
+using namespace fizz;
+using namespace fizz::server;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::vector<fizz::Buf> loadCorpus(const std::string& dir) {
+  std::vector<fizz::Buf> corpus;
+  DIR* d = opendir(dir.c_str());
+  if (!d) {
+    throw std::runtime_error("could not open corpus directory: " + dir);
+  }
+  SCOPE_EXIT {
+    closedir(d);
+  };
+  while (auto* entry = readdir(d)) {
+    if (entry->d_name[0] == '.') {
+      continue;
+    }
+    std::string contents;
+    if (folly::readFile((dir + "/" + entry->d_name).c_str(), contents)) {
+      corpus.push_back(folly::IOBuf::copyBuffer(contents));
+    }
+  }
+  if (corpus.empty()) {
+    throw std::runtime_error("no hellos in corpus directory: " + dir);
+  }
+  return corpus;
+}
+
+fizz::Buf syntheticHello() {
+  ClientHello chlo;
+  chlo.legacy_version = ProtocolVersion::tls_1_2;
+  chlo.random.fill(0x44);
+  chlo.legacy_session_id = folly::IOBuf::create(0);
+  chlo.cipher_suites = {
+      CipherSuite::TLS_AES_128_GCM_SHA256,
+      CipherSuite::TLS_AES_256_GCM_SHA384,
+      CipherSuite::TLS_CHACHA20_POLY1305_SHA256};
+  chlo.legacy_compression_methods.push_back(0x00);
+
+  SupportedVersions versions;
+  versions.versions = {ProtocolVersion::tls_1_3};
+  chlo.extensions.push_back(encodeExtension(versions));
+
+  SupportedGroups groups;
+  groups.named_group_list = {NamedGroup::x25519, NamedGroup::secp256r1};
+  chlo.extensions.push_back(encodeExtension(groups));
+
+  ClientKeyShare keyShare;
+  KeyShareEntry entry;
+  entry.group = NamedGroup::x25519;
+  entry.key_exchange = folly::IOBuf::create(32);
+  entry.key_exchange->append(32);
+  keyShare.client_shares.push_back(std::move(entry));
+  chlo.extensions.push_back(encodeExtension(keyShare));
+
+  SignatureAlgorithms sigAlgs;
+  sigAlgs.supported_signature_algorithms = {
+      SignatureScheme::ecdsa_secp256r1_sha256,
+      SignatureScheme::rsa_pss_sha256};
+  chlo.extensions.push_back(encodeExtension(sigAlgs));
+
+  PskKeyExchangeModes modes;
+  modes.modes = {PskKeyExchangeMode::psk_dhe_ke};
+  chlo.extensions.push_back(encodeExtension(modes));
+
+  ServerNameList sni;
+  ServerName name;
+  name.hostname = folly::IOBuf::copyBuffer("www.example.com");
+  sni.server_name_list.push_back(std::move(name));
+  chlo.extensions.push_back(encodeExtension(sni));
+
+  ProtocolNameList alpn;
+  ProtocolName h2;
+  h2.name = folly::IOBuf::copyBuffer("h2");
+  alpn.protocol_name_list.push_back(std::move(h2));
+  chlo.extensions.push_back(encodeExtension(alpn));
+
+  return encode(std::move(chlo));
+}
+
+/**
+ * The decode, extension indexing and negotiation work the ClientHello
+ * handler performs before any crypto, driven off a shared context.
+ */
+void replayHello(const FizzServerContext& context, const fizz::Buf& raw) {
+  auto chlo = decode<ClientHello>(raw->clone());
+
+  auto clientVersions = getExtension<SupportedVersions>(chlo.extensions);
+  folly::Optional<ProtocolVersion> version;
+  if (clientVersions) {
+    version =
+        negotiate(context.getSupportedVersions(), clientVersions->versions);
+  }
+  auto cipher = negotiate(context.getSupportedCiphers(), chlo.cipher_suites);
+
+  auto clientShares = getExtension<ClientKeyShare>(chlo.extensions);
+  auto clientGroups = getExtension<SupportedGroups>(chlo.extensions);
+  folly::Optional<NamedGroup> group;
+  if (clientGroups) {
+    group = negotiate(
+        context.getSupportedGroups(), clientGroups->named_group_list);
+  }
+
+  auto clientSigSchemes = getExtension<SignatureAlgorithms>(chlo.extensions);
+  folly::Optional<SignatureScheme> scheme;
+  if (clientSigSchemes) {
+    scheme = negotiate(
+        context.getSupportedSigSchemes(),
+        clientSigSchemes->supported_signature_algorithms);
+  }
+
+  auto pskModes = getExtension<PskKeyExchangeModes>(chlo.extensions);
+  auto sni = getExtension<ServerNameList>(chlo.extensions);
+
+  auto clientAlpns = getExtension<ProtocolNameList>(chlo.extensions);
+  folly::Optional<std::string> alpn;
+  if (clientAlpns) {
+    std::vector<std::string> names;
+    names.reserve(clientAlpns->protocol_name_list.size());
+    for (auto& protoName : clientAlpns->protocol_name_list) {
+      names.push_back(protoName.name->moveToFbString().toStdString());
+    }
+    alpn = negotiate(context.getSupportedAlpns(), names);
+  }
+
+  folly::doNotOptimizeAway(version);
+  folly::doNotOptimizeAway(cipher);
+  folly::doNotOptimizeAway(clientShares);
+  folly::doNotOptimizeAway(group);
+  folly::doNotOptimizeAway(scheme);
+  folly::doNotOptimizeAway(pskModes);
+  folly::doNotOptimizeAway(sni);
+  folly::doNotOptimizeAway(alpn);
+}
+} // namespace
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+
+  std::vector<fizz::Buf> corpus;
+  if (FLAGS_corpus.empty()) {
+    corpus.push_back(syntheticHello());
+  } else {
+    corpus = loadCorpus(FLAGS_corpus);
+  }
+
+  FizzServerContext context;
+  context.setSupportedAlpns({"h2", "http/1.1"});
+
+  // Warm up allocator and caches, then measure allocations on one pass.
+  for (const auto& raw : corpus) {
+    replayHello(context, raw);
+  }
+  uint64_t allocations = 0;
+  if (fizz::test::mallocCountingSupported()) {
+    fizz::test::MallocCounterGuard guard;
+    for (const auto& raw : corpus) {
+      replayHello(context, raw);
+    }
+    allocations = guard.count();
+  }
+
+  auto start = Clock::now();
+  for (int32_t i = 0; i < FLAGS_iterations; i++) {
+    for (const auto& raw : corpus) {
+      replayHello(context, raw);
+    }
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(
+      Clock::now() - start);
+
+  auto total = static_cast<uint64_t>(FLAGS_iterations) * corpus.size();
+  std::cout << "Hellos: " << corpus.size() << std::endl;
+  std::cout << "Replays: " << total << std::endl;
+  std::cout << "Hellos/sec: " << total / elapsed.count() << std::endl;
+  if (fizz::test::mallocCountingSupported()) {
+    std::cout << "Allocations/hello: " << allocations / corpus.size()
+              << std::endl;
+  } else {
+    std::cout << "Allocations/hello: unavailable" << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,103 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GMock.h>
+#include <folly/portability/GTest.h>
+
+#include <fizz/server/CompactTicketCodec.h>
+
+#include <fizz/protocol/test/Mocks.h>
+
+using namespace folly;
+using namespace testing;
+
+namespace fizz {
+namespace server {
+namespace test {
+
+static ResumptionState getCompactResumptionState() {
+  ResumptionState rs;
+  rs.version = ProtocolVersion::tls_1_3;
+  rs.cipher = CipherSuite::TLS_AES_128_GCM_SHA256;
+  rs.resumptionSecret = IOBuf::copyBuffer("secret");
+  rs.ticketAgeAdd = 0x44444444;
+  rs.ticketIssueTime = std::chrono::time_point<std::chrono::system_clock>(
+      std::chrono::seconds(25));
+  rs.handshakeTime = std::chrono::time_point<std::chrono::system_clock>(
+      std::chrono::seconds(15));
+  return rs;
+}
+
+static std::shared_ptr<FizzServerContext> getCompactContext() {
+  auto context = std::make_shared<FizzServerContext>();
+  context->setCertManager(std::make_shared<CertManager>());
+  return context;
+}
+
+TEST(CompactTicketCodecTest, TestRoundTrip) {
+  auto rs = getCompactResumptionState();
+  auto encoded = CompactTicketCodec::encode(std::move(rs));
+  EXPECT_LT(encoded->computeChainDataLength(), 40);
+
+  auto context = getCompactContext();
+  auto drs = CompactTicketCodec::decode(std::move(encoded), context.get());
+  EXPECT_EQ(drs.version, ProtocolVersion::tls_1_3);
+  EXPECT_EQ(drs.cipher, CipherSuite::TLS_AES_128_GCM_SHA256);
+  EXPECT_TRUE(
+      IOBufEqualTo()(drs.resumptionSecret, IOBuf::copyBuffer("secret")));
+  EXPECT_EQ(drs.ticketAgeAdd, 0x44444444);
+  EXPECT_EQ(
+      drs.ticketIssueTime,
+      std::chrono::time_point<std::chrono::system_clock>(
+          std::chrono::seconds(25)));
+  EXPECT_EQ(
+      drs.handshakeTime,
+      std::chrono::time_point<std::chrono::system_clock>(
+          std::chrono::seconds(15)));
+  EXPECT_EQ(drs.clientCert, nullptr);
+  EXPECT_FALSE(drs.alpn.hasValue());
+}
+
+TEST(CompactTicketCodecTest, TestProfileMismatch) {
+  auto rs = getCompactResumptionState();
+  rs.cipher = CipherSuite::TLS_AES_256_GCM_SHA384;
+  auto encoded = CompactTicketCodec::encode(std::move(rs));
+
+  auto context = getCompactContext();
+  EXPECT_THROW(
+      CompactTicketCodec::decode(std::move(encoded), context.get()),
+      std::runtime_error);
+}
+
+TEST(CompactTicketCodecTest, TestAlpnInFingerprint) {
+  auto rs = getCompactResumptionState();
+  rs.alpn = "h2";
+  auto encoded = CompactTicketCodec::encode(std::move(rs));
+
+  auto context = getCompactContext();
+  context->setSupportedAlpns({"h2", "http/1.1"});
+  auto drs = CompactTicketCodec::decode(std::move(encoded), context.get());
+  EXPECT_EQ(*drs.alpn, "h2");
+}
+
+TEST(CompactTicketCodecTest, TestClientCertRejected) {
+  auto rs = getCompactResumptionState();
+  rs.clientCert = std::make_shared<MockPeerCert>();
+  EXPECT_THROW(CompactTicketCodec::encode(std::move(rs)), std::runtime_error);
+}
+
+TEST(CompactTicketCodecTest, TestNoContext) {
+  auto rs = getCompactResumptionState();
+  auto encoded = CompactTicketCodec::encode(std::move(rs));
+  EXPECT_THROW(
+      CompactTicketCodec::decode(std::move(encoded), nullptr),
+      std::runtime_error);
+}
+} // namespace test
+} // namespace server
+} // namespace fizz
@@ -24,6 +24,12 @@ static constexpr StringPiece statelessHrr{
 static constexpr StringPiece statelessHrrGroup{
     "0200003e0303cf21ad74e59a6111be1d8c021e65b891c2a211167abb8c5e079e09e2c8a8339c001301000016002b0002030400330002001d002c0006000474657374"};
 
+static constexpr StringPiece statelessHrrEmptyCookie{
+    "020000340303cf21ad74e59a6111be1d8c021e65b891c2a211167abb8c5e079e09e2c8a8339c00130100000c002b00020304002c00020000"};
+
+static constexpr StringPiece statelessHrrLongCookie{
+    "0200003c0303cf21ad74e59a6111be1d8c021e65b891c2a211167abb8c5e079e09e2c8a8339c001301000014002b00020304002c000a00086c6f6e6774657374"};
+
 namespace fizz {
 namespace server {
 namespace test {
@@ -46,6 +52,22 @@ TEST(GetStatelessHrrTest, Group) {
   EXPECT_EQ(hexlify(hrr->coalesce()), statelessHrrGroup);
 }
 
+TEST(GetStatelessHrrTest, CookieLengths) {
+  auto empty = getStatelessHelloRetryRequest(
+      ProtocolVersion::tls_1_3,
+      CipherSuite::TLS_AES_128_GCM_SHA256,
+      none,
+      IOBuf::create(0));
+  EXPECT_EQ(hexlify(empty->coalesce()), statelessHrrEmptyCookie);
+
+  auto longer = getStatelessHelloRetryRequest(
+      ProtocolVersion::tls_1_3,
+      CipherSuite::TLS_AES_128_GCM_SHA256,
+      none,
+      IOBuf::copyBuffer("longtest"));
+  EXPECT_EQ(hexlify(longer->coalesce()), statelessHrrLongCookie);
+}
+
 class GetCookieStateTest : public Test {
  public:
   void SetUp() override {
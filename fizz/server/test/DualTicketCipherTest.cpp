@@ -71,6 +71,69 @@ TEST(DualCipherTest, DecryptSuccessWithFallback) {
       std::get<0>(dualCipher.decrypt(std::move(buf)).get()),
       PskType::Resumption);
 }
+TEST(DualCipherTest, EncryptWithFormatByte) {
+  auto cipher = std::make_unique<MockTicketCipher>();
+  auto fallbackCipher = std::make_unique<MockTicketCipher>();
+  ResumptionState resState;
+
+  cipher->setDefaults();
+  fallbackCipher->setDefaults();
+  EXPECT_CALL(*cipher, _encrypt(_)).Times(1);
+
+  auto dualCipher =
+      DualTicketCipher(std::move(cipher), std::move(fallbackCipher));
+  dualCipher.setFormatBytes(0x01, 0x02);
+  auto ticket = dualCipher.encrypt(std::move(resState)).get();
+  EXPECT_TRUE(ticket.hasValue());
+  folly::io::Cursor cursor(ticket->first.get());
+  EXPECT_EQ(cursor.readBE<uint8_t>(), 0x01);
+}
+
+TEST(DualCipherTest, DecryptRoutedByFormatByte) {
+  auto cipher = std::make_unique<MockTicketCipher>();
+  auto fallbackCipher = std::make_unique<MockTicketCipher>();
+
+  EXPECT_CALL(*cipher, _decrypt(_)).Times(0);
+  EXPECT_CALL(*fallbackCipher, _decrypt(_))
+      .WillOnce(InvokeWithoutArgs([]() {
+        ResumptionState res;
+        return std::make_pair(PskType::Resumption, std::move(res));
+      }));
+
+  auto dualCipher =
+      DualTicketCipher(std::move(cipher), std::move(fallbackCipher));
+  dualCipher.setFormatBytes(0x01, 0x02);
+  auto buf = folly::IOBuf::copyBuffer("\x02ticket");
+  EXPECT_EQ(
+      std::get<0>(dualCipher.decrypt(std::move(buf)).get()),
+      PskType::Resumption);
+  EXPECT_EQ(dualCipher.getPrimaryFormatHits(), 0);
+  EXPECT_EQ(dualCipher.getFallbackFormatHits(), 1);
+}
+
+TEST(DualCipherTest, DecryptUnrecognizedFormatTriesBoth) {
+  auto cipher = std::make_unique<MockTicketCipher>();
+  auto fallbackCipher = std::make_unique<MockTicketCipher>();
+
+  EXPECT_CALL(*cipher, _decrypt(_)).WillOnce(InvokeWithoutArgs([]() {
+    ResumptionState res;
+    return std::make_pair(PskType::Rejected, std::move(res));
+  }));
+  EXPECT_CALL(*fallbackCipher, _decrypt(_))
+      .WillOnce(InvokeWithoutArgs([]() {
+        ResumptionState res;
+        return std::make_pair(PskType::Resumption, std::move(res));
+      }));
+
+  auto dualCipher =
+      DualTicketCipher(std::move(cipher), std::move(fallbackCipher));
+  dualCipher.setFormatBytes(0x01, 0x02);
+  auto buf = folly::IOBuf::copyBuffer("\x7fticket");
+  EXPECT_EQ(
+      std::get<0>(dualCipher.decrypt(std::move(buf)).get()),
+      PskType::Resumption);
+  EXPECT_EQ(dualCipher.getUnrecognizedFormatHits(), 1);
+}
 } // namespace test
 } // namespace server
 } // namespace fizz
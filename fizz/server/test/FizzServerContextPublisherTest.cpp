@@ -0,0 +1,49 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GTest.h>
+
+#include <fizz/server/FizzServerContextPublisher.h>
+
+namespace fizz {
+namespace server {
+namespace test {
+
+TEST(FizzServerContextPublisherTest, TestPublish) {
+  auto context = std::make_shared<FizzServerContext>();
+  context->setSendNewSessionTicket(false);
+  FizzServerContextPublisher publisher(std::move(context));
+  EXPECT_FALSE(publisher.getContext()->getSendNewSessionTicket());
+
+  auto newContext = std::make_shared<FizzServerContext>();
+  publisher.publishContext(std::move(newContext));
+  EXPECT_TRUE(publisher.getContext()->getSendNewSessionTicket());
+}
+
+TEST(FizzServerContextPublisherTest, TestUpdate) {
+  FizzServerContextPublisher publisher(
+      std::make_shared<FizzServerContext>());
+  publisher.updateContext([](FizzServerContext& context) {
+    context.setVersionFallbackEnabled(true);
+  });
+  EXPECT_TRUE(publisher.getContext()->getVersionFallbackEnabled());
+}
+
+TEST(FizzServerContextPublisherTest, TestSnapshotUnchangedByPublish) {
+  FizzServerContextPublisher publisher(
+      std::make_shared<FizzServerContext>());
+  auto snapshot = publisher.getContext();
+  publisher.updateContext([](FizzServerContext& context) {
+    context.setVersionFallbackEnabled(true);
+  });
+  EXPECT_FALSE(snapshot->getVersionFallbackEnabled());
+  EXPECT_TRUE(publisher.getContext()->getVersionFallbackEnabled());
+}
+} // namespace test
+} // namespace server
+} // namespace fizz
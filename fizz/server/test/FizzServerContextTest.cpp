@@ -0,0 +1,56 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GMock.h>
+#include <folly/portability/GTest.h>
+
+#include <fizz/protocol/test/Mocks.h>
+#include <fizz/protocol/test/TestMessages.h>
+#include <fizz/server/FizzServerContext.h>
+
+using namespace folly;
+using namespace fizz::test;
+using namespace testing;
+
+namespace fizz {
+namespace server {
+namespace test {
+
+TEST(FizzServerContextTest, TestFirstFlightBudget) {
+  FizzServerContext context;
+  EXPECT_EQ(context.getFirstFlightBudget(), 0);
+  context.setFirstFlightBudget(14600);
+  EXPECT_EQ(context.getFirstFlightBudget(), 14600);
+}
+
+TEST(FizzServerContextTest, TestEstimateFirstFlightSize) {
+  FizzServerContext context;
+  MockSelfCert cert;
+  EXPECT_CALL(cert, _getCertMessage(_)).WillOnce(InvokeWithoutArgs([]() {
+    return TestMessages::certificate();
+  }));
+  EXPECT_CALL(cert, getCompressedCert(CertificateCompressionAlgorithm::zlib))
+      .WillOnce(InvokeWithoutArgs(
+          []() { return TestMessages::compressedCertificate(); }));
+
+  auto plain = context.estimateFirstFlightSize(cert, folly::none);
+  auto compressed = context.estimateFirstFlightSize(
+      cert, CertificateCompressionAlgorithm::zlib);
+
+  // Both include the fixed non-certificate overhead plus the respective
+  // encoded certificate message.
+  auto plainCert =
+      encodeHandshake(TestMessages::certificate())->computeChainDataLength();
+  auto compressedCert = encodeHandshake(TestMessages::compressedCertificate())
+                            ->computeChainDataLength();
+  EXPECT_EQ(plain - plainCert, compressed - compressedCert);
+  EXPECT_GT(plain, plainCert);
+}
+} // namespace test
+} // namespace server
+} // namespace fizz
@@ -38,6 +38,19 @@ class ActionMoveVisitor : public boost::static_visitor<> {
   void operator()(AttemptVersionFallback&) {
     fallback();
   }
+
+  void operator()(WriteToSocket&) {
+    if (writeHook) {
+      writeHook();
+    }
+  }
+
+  void flushActions() {
+    flushes_++;
+  }
+
+  std::function<void()> writeHook;
+  size_t flushes_{0};
 };
 
 class TestFizzServer : public DelayedDestruction {
@@ -137,6 +150,43 @@ TEST_F(FizzServerTest, TestSSLV2AfterData) {
   fizzServer_->fizzServer_.newTransportData();
 }
 
+TEST_F(FizzServerTest, TestCoalescedEventFlush) {
+  accept();
+  fizzServer_->visitor_.flushes_ = 0;
+  EXPECT_CALL(*MockServerStateMachineInstance::instance, _processAppWrite(_, _))
+      .WillOnce(InvokeWithoutArgs([] {
+        Actions acts;
+        acts.push_back(WriteToSocket());
+        return AsyncActions(std::move(acts));
+      }))
+      .WillOnce(InvokeWithoutArgs([] { return AsyncActions(Actions()); }));
+  // The write action enqueues a second event mid-drain, as a write callback
+  // responding to delivered data would.
+  fizzServer_->visitor_.writeHook = [this]() {
+    fizzServer_->fizzServer_.appWrite(AppWrite());
+  };
+  fizzServer_->fizzServer_.appWrite(AppWrite());
+  EXPECT_EQ(fizzServer_->visitor_.flushes_, 1);
+}
+
+TEST_F(FizzServerTest, TestPerEventFlush) {
+  accept();
+  fizzServer_->fizzServer_.setEventFlushCoalescing(false);
+  fizzServer_->visitor_.flushes_ = 0;
+  EXPECT_CALL(*MockServerStateMachineInstance::instance, _processAppWrite(_, _))
+      .WillOnce(InvokeWithoutArgs([] {
+        Actions acts;
+        acts.push_back(WriteToSocket());
+        return AsyncActions(std::move(acts));
+      }))
+      .WillOnce(InvokeWithoutArgs([] { return AsyncActions(Actions()); }));
+  fizzServer_->visitor_.writeHook = [this]() {
+    fizzServer_->fizzServer_.appWrite(AppWrite());
+  };
+  fizzServer_->fizzServer_.appWrite(AppWrite());
+  EXPECT_EQ(fizzServer_->visitor_.flushes_, 2);
+}
+
 TEST(FizzServerContextTest, TestCopy) {
   FizzServerContext ctx;
   auto ctx2 = ctx;
@@ -79,6 +79,15 @@ class MockServerStateMachine : public ServerStateMachine {
     return *_processEarlyAppWrite(state, appWrite);
   }
 
+  MOCK_METHOD2(
+      _processKeyUpdateInitiation,
+      folly::Optional<AsyncActions>(const State&, KeyUpdateInitiation&));
+  AsyncActions processKeyUpdateInitiation(
+      const State& state,
+      KeyUpdateInitiation keyUpdateInitiation) override {
+    return *_processKeyUpdateInitiation(state, keyUpdateInitiation);
+  }
+
   MOCK_METHOD1(_processAppClose, folly::Optional<Actions>(const State&));
   Actions processAppClose(const State& state) override {
     return *_processAppClose(state);
@@ -72,6 +72,45 @@ TEST(NegotiateTest, TestServerEmptyTier) {
 
   EXPECT_EQ(*negotiate(server, client), 4);
 }
+
+TEST(PrecomputedNegotiatorTest, TestServerPref) {
+  std::vector<std::vector<int>> server = {{1}, {2}, {3}};
+  PrecomputedNegotiator<int> negotiator(server);
+  std::vector<int> client = {3, 1, 2};
+
+  EXPECT_EQ(*negotiator(client), 1);
+}
+
+TEST(PrecomputedNegotiatorTest, TestServerPrefTie) {
+  std::vector<std::vector<int>> server = {{1}, {2, 4}, {3}};
+  PrecomputedNegotiator<int> negotiator(server);
+  std::vector<int> client = {5, 6, 4, 2};
+
+  EXPECT_EQ(*negotiator(client), 4);
+}
+
+TEST(PrecomputedNegotiatorTest, TestMismatch) {
+  std::vector<std::vector<int>> server = {{1}, {2}};
+  PrecomputedNegotiator<int> negotiator(server);
+  std::vector<int> client = {3, 4};
+
+  EXPECT_FALSE(negotiator(client).hasValue());
+}
+
+TEST(PrecomputedNegotiatorTest, TestSingleOrdering) {
+  std::vector<int> server = {1, 2, 3};
+  PrecomputedNegotiator<int> negotiator(server);
+  std::vector<int> client = {3, 1, 2};
+
+  EXPECT_EQ(*negotiator(client), 1);
+}
+
+TEST(PrecomputedNegotiatorTest, TestEmpty) {
+  PrecomputedNegotiator<int> negotiator;
+  std::vector<int> client = {1, 2};
+
+  EXPECT_FALSE(negotiator(client).hasValue());
+}
 } // namespace test
 } // namespace server
 } // namespace fizz
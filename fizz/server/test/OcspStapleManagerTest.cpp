@@ -0,0 +1,126 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GMock.h>
+#include <folly/portability/GTest.h>
+
+#include <fizz/server/OcspStapleManager.h>
+
+#include <fizz/protocol/test/Mocks.h>
+#include <fizz/record/Extensions.h>
+
+using namespace fizz::test;
+using namespace folly;
+using namespace testing;
+
+namespace fizz {
+namespace server {
+namespace test {
+
+class OcspStapleManagerTest : public Test {
+ protected:
+  std::shared_ptr<MockSelfCert> getCert() {
+    auto cert = std::make_shared<MockSelfCert>();
+    ON_CALL(*cert, _getCertMessage(_)).WillByDefault(InvokeWithoutArgs([]() {
+      CertificateMsg msg;
+      CertificateEntry entry;
+      entry.cert_data = IOBuf::copyBuffer("cert");
+      msg.certificate_list.push_back(std::move(entry));
+      return msg;
+    }));
+    return cert;
+  }
+
+  static Buf expectedStapledMessage(const std::string& response) {
+    CertificateMsg msg;
+    CertificateEntry entry;
+    entry.cert_data = IOBuf::copyBuffer("cert");
+    CertificateStatus status;
+    status.response = IOBuf::copyBuffer(response);
+    entry.extensions.push_back(encodeExtension(status));
+    msg.certificate_list.push_back(std::move(entry));
+    return encodeHandshake(std::move(msg));
+  }
+
+  IOBufEqualTo eq_;
+};
+
+TEST_F(OcspStapleManagerTest, TestStapleServed) {
+  auto cert = getCert();
+  OcspStapleManager manager([](const SelfCert&) {
+    OcspStapleManager::Staple staple;
+    staple.response = IOBuf::copyBuffer("ocspresponse");
+    staple.expiry = std::chrono::system_clock::now() + std::chrono::hours(24);
+    return folly::Optional<OcspStapleManager::Staple>(std::move(staple));
+  });
+  manager.addCert(cert);
+  manager.refreshNow();
+
+  auto encoded = manager.getStapledCertMessage(cert.get());
+  ASSERT_NE(encoded, nullptr);
+  EXPECT_TRUE(eq_(encoded, expectedStapledMessage("ocspresponse")));
+}
+
+TEST_F(OcspStapleManagerTest, TestUnknownCert) {
+  OcspStapleManager manager([](const SelfCert&) {
+    return folly::Optional<OcspStapleManager::Staple>(folly::none);
+  });
+  MockSelfCert cert;
+  EXPECT_EQ(manager.getStapledCertMessage(&cert), nullptr);
+}
+
+TEST_F(OcspStapleManagerTest, TestFetchFailure) {
+  auto cert = getCert();
+  OcspStapleManager manager([](const SelfCert&) {
+    return folly::Optional<OcspStapleManager::Staple>(folly::none);
+  });
+  manager.addCert(cert);
+  manager.refreshNow();
+  EXPECT_EQ(manager.getStapledCertMessage(cert.get()), nullptr);
+}
+
+TEST_F(OcspStapleManagerTest, TestExpiredStapleNotServed) {
+  auto cert = getCert();
+  OcspStapleManager manager([](const SelfCert&) {
+    OcspStapleManager::Staple staple;
+    staple.response = IOBuf::copyBuffer("stale");
+    staple.expiry =
+        std::chrono::system_clock::now() - std::chrono::seconds(1);
+    return folly::Optional<OcspStapleManager::Staple>(std::move(staple));
+  });
+  manager.addCert(cert);
+  manager.refreshNow();
+  EXPECT_EQ(manager.getStapledCertMessage(cert.get()), nullptr);
+}
+
+TEST_F(OcspStapleManagerTest, TestStatusExtensionRoundTrip) {
+  CertificateStatus status;
+  status.response = IOBuf::copyBuffer("ocspresponse");
+  auto ext = encodeExtension(status);
+  EXPECT_EQ(ext.extension_type, ExtensionType::status_request);
+
+  std::vector<Extension> extensions;
+  extensions.push_back(std::move(ext));
+  auto decoded = getExtension<CertificateStatus>(extensions);
+  ASSERT_TRUE(decoded.hasValue());
+  EXPECT_EQ(decoded->status_type, CertificateStatusType::ocsp);
+  EXPECT_TRUE(eq_(decoded->response, IOBuf::copyBuffer("ocspresponse")));
+
+  CertificateStatusRequest request;
+  auto reqExt = encodeExtension(request);
+  std::vector<Extension> chloExtensions;
+  chloExtensions.push_back(std::move(reqExt));
+  auto decodedRequest =
+      getExtension<CertificateStatusRequest>(chloExtensions);
+  ASSERT_TRUE(decodedRequest.hasValue());
+  EXPECT_EQ(decodedRequest->status_type, CertificateStatusType::ocsp);
+}
+
+} // namespace test
+} // namespace server
+} // namespace fizz
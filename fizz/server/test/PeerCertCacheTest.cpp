@@ -0,0 +1,54 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GMock.h>
+#include <folly/portability/GTest.h>
+
+#include <fizz/protocol/test/Mocks.h>
+#include <fizz/server/PeerCertCache.h>
+
+using namespace folly;
+using namespace fizz::test;
+
+namespace fizz {
+namespace server {
+namespace test {
+
+TEST(PeerCertCacheTest, TestGetPut) {
+  PeerCertCache cache(10, std::chrono::minutes(5));
+  auto der = IOBuf::copyBuffer("certder");
+  EXPECT_EQ(cache.get(*der), nullptr);
+
+  auto cert = std::make_shared<MockPeerCert>();
+  cache.put(*der, cert);
+  EXPECT_EQ(cache.get(*der), cert);
+  EXPECT_EQ(cache.get(*IOBuf::copyBuffer("otherder")), nullptr);
+}
+
+TEST(PeerCertCacheTest, TestTtlExpiry) {
+  PeerCertCache cache(10, std::chrono::milliseconds(0));
+  auto der = IOBuf::copyBuffer("certder");
+  cache.put(*der, std::make_shared<MockPeerCert>());
+  EXPECT_EQ(cache.get(*der), nullptr);
+}
+
+TEST(PeerCertCacheTest, TestEviction) {
+  PeerCertCache cache(1, std::chrono::minutes(5));
+  auto der1 = IOBuf::copyBuffer("certder1");
+  auto der2 = IOBuf::copyBuffer("certder2");
+  auto cert1 = std::make_shared<MockPeerCert>();
+  auto cert2 = std::make_shared<MockPeerCert>();
+
+  cache.put(*der1, cert1);
+  cache.put(*der2, cert2);
+  EXPECT_EQ(cache.get(*der1), nullptr);
+  EXPECT_EQ(cache.get(*der2), cert2);
+}
+} // namespace test
+} // namespace server
+} // namespace fizz
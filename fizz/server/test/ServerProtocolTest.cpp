@@ -1270,10 +1270,11 @@ TEST_F(ServerProtocolTest, TestClientHelloPskFlow) {
       *mockKeyScheduler_, deriveEarlySecret(RangeMatches("resumesecret")));
   EXPECT_CALL(*mockHandshakeContext_, appendToTranscript(BufMatches("client")))
       .InSequence(contextSeq);
-  EXPECT_CALL(*mockHandshakeContext_, getFinishedData(RangeMatches("bdr")))
+  EXPECT_CALL(
+      *mockHandshakeContext_,
+      verifyFinishedData(RangeMatches("bdr"), RangeMatches("verifydata")))
       .InSequence(contextSeq)
-      .WillRepeatedly(
-          InvokeWithoutArgs([]() { return IOBuf::copyBuffer("verifydata"); }));
+      .WillRepeatedly(Return(true));
   EXPECT_CALL(
       *mockHandshakeContext_, appendToTranscript(BufMatches("helloencoding")))
       .InSequence(contextSeq);
@@ -1487,10 +1488,11 @@ TEST_F(ServerProtocolTest, TestClientHelloPskDheFlow) {
       *mockKeyScheduler_, deriveEarlySecret(RangeMatches("resumesecret")));
   EXPECT_CALL(*mockHandshakeContext_, appendToTranscript(BufMatches("client")))
       .InSequence(contextSeq);
-  EXPECT_CALL(*mockHandshakeContext_, getFinishedData(RangeMatches("bdr")))
+  EXPECT_CALL(
+      *mockHandshakeContext_,
+      verifyFinishedData(RangeMatches("bdr"), RangeMatches("verifydata")))
       .InSequence(contextSeq)
-      .WillRepeatedly(
-          InvokeWithoutArgs([]() { return IOBuf::copyBuffer("verifydata"); }));
+      .WillRepeatedly(Return(true));
   EXPECT_CALL(
       *mockHandshakeContext_, appendToTranscript(BufMatches("helloencoding")))
       .InSequence(contextSeq);
@@ -1711,7 +1713,7 @@ TEST_F(ServerProtocolTest, TestClientHelloHelloRetryRequestFlow) {
       .WillOnce(InvokeWithoutArgs([=]() {
         return std::unique_ptr<HandshakeContext>(secondHandshakeContext);
       }));
-  EXPECT_CALL(*secondHandshakeContext, appendToTranscript(_)).Times(2);
+  EXPECT_CALL(*secondHandshakeContext, appendToTranscript(_)).Times(3);
   EXPECT_CALL(*mockWrite_, _write(_)).WillOnce(Invoke([&](TLSMessage& msg) {
     TLSContent content;
     content.contentType = msg.type;
@@ -2005,10 +2007,11 @@ TEST_F(ServerProtocolTest, TestRetryClientHelloPskDheFlow) {
       *mockKeyScheduler_, deriveEarlySecret(RangeMatches("resumesecret")));
   EXPECT_CALL(*mockHandshakeContext_, appendToTranscript(BufMatches("client")))
       .InSequence(contextSeq);
-  EXPECT_CALL(*mockHandshakeContext_, getFinishedData(RangeMatches("bdr")))
+  EXPECT_CALL(
+      *mockHandshakeContext_,
+      verifyFinishedData(RangeMatches("bdr"), RangeMatches("verifydata")))
       .InSequence(contextSeq)
-      .WillRepeatedly(
-          InvokeWithoutArgs([]() { return IOBuf::copyBuffer("verifydata"); }));
+      .WillRepeatedly(Return(true));
   EXPECT_CALL(
       *mockHandshakeContext_, appendToTranscript(BufMatches("helloencoding")))
       .InSequence(contextSeq);
@@ -2232,10 +2235,11 @@ TEST_F(ServerProtocolTest, TestClientHelloPskDheEarlyFlow) {
       *mockKeyScheduler_, deriveEarlySecret(RangeMatches("resumesecret")));
   EXPECT_CALL(*mockHandshakeContext_, appendToTranscript(BufMatches("client")))
       .InSequence(contextSeq);
-  EXPECT_CALL(*mockHandshakeContext_, getFinishedData(RangeMatches("bdr")))
+  EXPECT_CALL(
+      *mockHandshakeContext_,
+      verifyFinishedData(RangeMatches("bdr"), RangeMatches("verifydata")))
       .InSequence(contextSeq)
-      .WillRepeatedly(
-          InvokeWithoutArgs([]() { return IOBuf::copyBuffer("verifydata"); }));
+      .WillRepeatedly(Return(true));
   EXPECT_CALL(
       *mockHandshakeContext_, appendToTranscript(BufMatches("helloencoding")))
       .InSequence(contextSeq);
@@ -2507,10 +2511,11 @@ TEST_F(ServerProtocolTest, TestClientHelloPskEarlyFlow) {
       *mockKeyScheduler_, deriveEarlySecret(RangeMatches("resumesecret")));
   EXPECT_CALL(*mockHandshakeContext_, appendToTranscript(BufMatches("client")))
       .InSequence(contextSeq);
-  EXPECT_CALL(*mockHandshakeContext_, getFinishedData(RangeMatches("bdr")))
+  EXPECT_CALL(
+      *mockHandshakeContext_,
+      verifyFinishedData(RangeMatches("bdr"), RangeMatches("verifydata")))
       .InSequence(contextSeq)
-      .WillRepeatedly(
-          InvokeWithoutArgs([]() { return IOBuf::copyBuffer("verifydata"); }));
+      .WillRepeatedly(Return(true));
   EXPECT_CALL(
       *mockHandshakeContext_, appendToTranscript(BufMatches("helloencoding")))
       .InSequence(contextSeq);
@@ -2924,6 +2929,41 @@ TEST_F(ServerProtocolTest, TestClientHelloSupportedVersionsMismatch) {
       "supported version mismatch");
 }
 
+TEST_F(ServerProtocolTest, TestClientHelloSniContextOverride) {
+  setUpExpectingClientHello();
+  // The override context supports no versions; negotiation failing with
+  // a version mismatch proves the handler swapped it in before
+  // consulting any policy.
+  auto overrideContext = std::make_shared<FizzServerContext>();
+  overrideContext->setSupportedVersions({});
+  auto overrides = std::make_shared<FizzServerContext::SniContextMap>();
+  (*overrides)["www.hostname.com"] = overrideContext;
+  context_->setSniContextOverrides(overrides);
+  auto actions =
+      getActions(detail::processEvent(state_, TestMessages::clientHello()));
+  expectError<FizzException>(
+      actions,
+      AlertDescription::protocol_version,
+      "supported version mismatch");
+  EXPECT_EQ(state_.context(), overrideContext.get());
+}
+
+TEST_F(ServerProtocolTest, TestClientHelloSniContextOverrideWildcard) {
+  setUpExpectingClientHello();
+  auto overrideContext = std::make_shared<FizzServerContext>();
+  overrideContext->setSupportedVersions({});
+  auto overrides = std::make_shared<FizzServerContext::SniContextMap>();
+  (*overrides)["*.hostname.com"] = overrideContext;
+  context_->setSniContextOverrides(overrides);
+  auto actions =
+      getActions(detail::processEvent(state_, TestMessages::clientHello()));
+  expectError<FizzException>(
+      actions,
+      AlertDescription::protocol_version,
+      "supported version mismatch");
+  EXPECT_EQ(state_.context(), overrideContext.get());
+}
+
 TEST_F(ServerProtocolTest, TestClientHelloCipherMismatch) {
   setUpExpectingClientHello();
   auto clientHello = TestMessages::clientHello();
@@ -3830,6 +3870,72 @@ TEST_F(ServerProtocolTest, TestNoCertCompressionAlgorithmMatch) {
   EXPECT_EQ(state_.serverCertCompAlgo(), folly::none);
 }
 
+TEST_F(ServerProtocolTest, TestCertCompressionBudgetPicksSmallest) {
+  setUpExpectingClientHello();
+  context_->setSupportedCompressionAlgorithms(
+      {CertificateCompressionAlgorithm::zlib,
+       CertificateCompressionAlgorithm::zstd});
+  context_->setFirstFlightBudget(14600);
+  EXPECT_CALL(*cert_, _getCertMessage(_)).WillOnce(InvokeWithoutArgs([]() {
+    auto msg = TestMessages::certificate();
+    CertificateEntry entry;
+    entry.cert_data = IOBuf::copyBuffer(std::string(2000, 'a'));
+    msg.certificate_list.push_back(std::move(entry));
+    return msg;
+  }));
+  EXPECT_CALL(*cert_, getCompressedCert(CertificateCompressionAlgorithm::zlib))
+      .WillOnce(InvokeWithoutArgs([]() {
+        auto cc = TestMessages::compressedCertificate();
+        cc.compressed_certificate_message =
+            IOBuf::copyBuffer(std::string(1000, 'b'));
+        return cc;
+      }));
+  EXPECT_CALL(*cert_, getCompressedCert(CertificateCompressionAlgorithm::zstd))
+      .Times(2)
+      .WillRepeatedly(InvokeWithoutArgs([]() {
+        auto cc = TestMessages::compressedCertificate();
+        cc.algorithm = CertificateCompressionAlgorithm::zstd;
+        cc.compressed_certificate_message = IOBuf::copyBuffer("tiny");
+        return cc;
+      }));
+  auto chlo = TestMessages::clientHello();
+  CertificateCompressionAlgorithms algos;
+  algos.algorithms = {CertificateCompressionAlgorithm::zlib,
+                      CertificateCompressionAlgorithm::zstd};
+  chlo.extensions.push_back(encodeExtension(algos));
+  auto actions = getActions(detail::processEvent(state_, std::move(chlo)));
+  expectActions<MutateState, WriteToSocket, SecretAvailable>(actions);
+  processStateMutations(actions);
+  EXPECT_EQ(state_.state(), StateEnum::ExpectingFinished);
+  EXPECT_EQ(
+      state_.serverCertCompAlgo(), CertificateCompressionAlgorithm::zstd);
+}
+
+TEST_F(ServerProtocolTest, TestCertCompressionBudgetPrefersUncompressed) {
+  setUpExpectingClientHello();
+  context_->setSupportedCompressionAlgorithms(
+      {CertificateCompressionAlgorithm::zlib});
+  context_->setFirstFlightBudget(14600);
+  // The plain encoding of the test certificate is smaller than any
+  // compressed encoding, so compression should be skipped.
+  EXPECT_CALL(*cert_, _getCertMessage(_))
+      .WillRepeatedly(InvokeWithoutArgs([]() {
+        return TestMessages::certificate();
+      }));
+  EXPECT_CALL(*cert_, getCompressedCert(CertificateCompressionAlgorithm::zlib))
+      .WillOnce(InvokeWithoutArgs(
+          []() { return TestMessages::compressedCertificate(); }));
+  auto chlo = TestMessages::clientHello();
+  CertificateCompressionAlgorithms algos;
+  algos.algorithms = {CertificateCompressionAlgorithm::zlib};
+  chlo.extensions.push_back(encodeExtension(algos));
+  auto actions = getActions(detail::processEvent(state_, std::move(chlo)));
+  expectActions<MutateState, WriteToSocket, SecretAvailable>(actions);
+  processStateMutations(actions);
+  EXPECT_EQ(state_.state(), StateEnum::ExpectingFinished);
+  EXPECT_EQ(state_.serverCertCompAlgo(), folly::none);
+}
+
 TEST_F(ServerProtocolTest, TestCertCompressionRequestedNotSupported) {
   setUpExpectingClientHello();
   auto chlo = TestMessages::clientHello();
@@ -3907,10 +4013,11 @@ TEST_F(ServerProtocolTest, TestFullHandshakeFinished) {
   setUpExpectingFinished();
   Sequence contextSeq;
   EXPECT_CALL(
-      *mockHandshakeContext_, getFinishedData(RangeMatches("clihandsec")))
+      *mockHandshakeContext_,
+      verifyFinishedData(
+          RangeMatches("clihandsec"), RangeMatches("verifydata")))
       .InSequence(contextSeq)
-      .WillOnce(
-          InvokeWithoutArgs([]() { return IOBuf::copyBuffer("verifydata"); }));
+      .WillOnce(Return(true));
   EXPECT_CALL(*mockHandshakeContext_, getHandshakeContext())
       .InSequence(contextSeq)
       .WillRepeatedly(
@@ -4072,9 +4179,8 @@ TEST_F(ServerProtocolTest, TestFinishedNoAutomaticNewSessionTicket) {
 TEST_F(ServerProtocolTest, TestFinishedMismatch) {
   setUpExpectingFinished();
   EXPECT_CALL(
-      *mockHandshakeContext_, getFinishedData(RangeMatches("clihandsec")))
-      .WillOnce(InvokeWithoutArgs(
-          []() { return IOBuf::copyBuffer("wrongverifydata"); }));
+      *mockHandshakeContext_, verifyFinishedData(RangeMatches("clihandsec"), _))
+      .WillOnce(Return(false));
 
   auto actions =
       getActions(detail::processEvent(state_, TestMessages::finished()));
@@ -4160,6 +4266,54 @@ TEST_F(ServerProtocolTest, TestWriteNewSessionTicket) {
   EXPECT_TRUE(IOBufEqualTo()(nstBuf, write.contents[0].data));
 }
 
+TEST_F(ServerProtocolTest, TestWriteNewSessionTicketBatch) {
+  setUpAcceptingData();
+  context_->setSendNewSessionTicket(false);
+  context_->setNumNewSessionTickets(2);
+  state_.resumptionMasterSecret() = std::vector<uint8_t>({'r', 's', 'e', 'c'});
+
+  // Each ticket in the batch binds a distinct nonce-derived secret.
+  EXPECT_CALL(
+      *mockKeyScheduler_,
+      getResumptionSecret(RangeMatches("rsec"), RangeMatches("")))
+      .WillOnce(
+          InvokeWithoutArgs([]() { return IOBuf::copyBuffer("derivedrsec"); }));
+  EXPECT_CALL(
+      *mockKeyScheduler_,
+      getResumptionSecret(
+          RangeMatches("rsec"),
+          RangeMatches(std::string("\x00\x00\x00\x01", 4))))
+      .WillOnce(InvokeWithoutArgs(
+          []() { return IOBuf::copyBuffer("derivedrsec2"); }));
+
+  EXPECT_CALL(*factory_, makeTicketAgeAdd())
+      .Times(2)
+      .WillRepeatedly(Return(0x44444444));
+  EXPECT_CALL(*mockTicketCipher_, _encrypt(_))
+      .Times(2)
+      .WillRepeatedly(InvokeWithoutArgs([]() {
+        return std::make_pair(
+            IOBuf::copyBuffer("ticket"), std::chrono::seconds(100));
+      }));
+  EXPECT_CALL(*appWrite_, _write(_))
+      .Times(2)
+      .WillRepeatedly(Invoke([&](TLSMessage& msg) {
+        TLSContent content;
+        content.contentType = msg.type;
+        content.encryptionLevel = appWrite_->getEncryptionLevel();
+        EXPECT_EQ(msg.type, ContentType::handshake);
+        content.data = folly::IOBuf::copyBuffer("nst");
+        return content;
+      }));
+
+  auto actions =
+      getActions(detail::processEvent(state_, WriteNewSessionTicket()));
+  auto write = expectSingleAction<WriteToSocket>(std::move(actions));
+  EXPECT_EQ(write.contents.size(), 2);
+  EXPECT_EQ(write.contents[0].contentType, ContentType::handshake);
+  EXPECT_EQ(write.contents[1].contentType, ContentType::handshake);
+}
+
 TEST_F(ServerProtocolTest, TestWriteNewSessionTicketWithTicketEarly) {
   acceptEarlyData();
   setUpAcceptingData();
@@ -4310,6 +4464,65 @@ TEST_F(ServerProtocolTest, TestAppWrite) {
   EXPECT_EQ(write.contents[0].contentType, ContentType::application_data);
 }
 
+TEST_F(ServerProtocolTest, TestAppWriteRekey) {
+  setUpAcceptingData();
+  EXPECT_CALL(*appWrite_, rekeyRecommended()).WillOnce(Return(true));
+  EXPECT_CALL(*appWrite_, _write(_))
+      .WillOnce(Invoke([&](TLSMessage& msg) {
+        TLSContent content;
+        content.contentType = msg.type;
+        content.encryptionLevel = appWrite_->getEncryptionLevel();
+        EXPECT_EQ(msg.type, ContentType::application_data);
+        EXPECT_TRUE(IOBufEqualTo()(msg.fragment, IOBuf::copyBuffer("appdata")));
+        content.data = IOBuf::copyBuffer("writtenappdata");
+        return content;
+      }))
+      .WillOnce(Invoke([&](TLSMessage& msg) {
+        TLSContent content;
+        content.contentType = msg.type;
+        content.encryptionLevel = appWrite_->getEncryptionLevel();
+        EXPECT_EQ(msg.type, ContentType::handshake);
+        EXPECT_TRUE(IOBufEqualTo()(
+            msg.fragment, encodeHandshake(TestMessages::keyUpdate(false))));
+        content.data = IOBuf::copyBuffer("keyupdated");
+        return content;
+      }));
+
+  EXPECT_CALL(*mockKeyScheduler_, serverKeyUpdate());
+  EXPECT_CALL(
+      *mockKeyScheduler_, getSecret(AppTrafficSecrets::ServerAppTraffic))
+      .WillOnce(InvokeWithoutArgs([]() {
+        return DerivedSecret(
+            std::vector<uint8_t>({'s', 'a', 't'}),
+            AppTrafficSecrets::ServerAppTraffic);
+      }));
+  EXPECT_CALL(*mockKeyScheduler_, getTrafficKey(RangeMatches("sat"), _, _))
+      .WillOnce(InvokeWithoutArgs([]() {
+        return TrafficKey{IOBuf::copyBuffer("serverkey"),
+                          IOBuf::copyBuffer("serveriv")};
+      }));
+  EXPECT_CALL(*appWrite_, _rekey(_))
+      .WillOnce(Invoke([](TrafficKeyDeriver& deriver) {
+        auto key = deriver(16, 12);
+        EXPECT_TRUE(IOBufEqualTo()(key.key, IOBuf::copyBuffer("serverkey")));
+        EXPECT_TRUE(IOBufEqualTo()(key.iv, IOBuf::copyBuffer("serveriv")));
+      }));
+
+  auto actions =
+      getActions(detail::processEvent(state_, TestMessages::appWrite()));
+  expectActions<MutateState, WriteToSocket, SecretAvailable>(actions);
+  auto write = expectAction<WriteToSocket>(actions);
+  EXPECT_TRUE(IOBufEqualTo()(
+      write.contents[0].data, IOBuf::copyBuffer("writtenappdata")));
+  EXPECT_TRUE(
+      IOBufEqualTo()(write.contents[1].data, IOBuf::copyBuffer("keyupdated")));
+  expectSecret(
+      actions, AppTrafficSecrets::ServerAppTraffic, StringPiece("sat"));
+  processStateMutations(actions);
+  EXPECT_EQ(state_.writeRecordLayer().get(), appWrite_);
+  EXPECT_EQ(state_.state(), StateEnum::AcceptingData);
+}
+
 TEST_F(ServerProtocolTest, TestKeyUpdateNotRequested) {
   setUpAcceptingData();
   auto actions =
@@ -4398,6 +4611,56 @@ TEST_F(ServerProtocolTest, TestKeyUpdateRequest) {
   EXPECT_EQ(state_.state(), StateEnum::AcceptingData);
 }
 
+TEST_F(ServerProtocolTest, TestKeyUpdateInitiation) {
+  setUpAcceptingData();
+  EXPECT_CALL(*appWrite_, _write(_)).WillOnce(Invoke([&](TLSMessage& msg) {
+    TLSContent content;
+    content.contentType = msg.type;
+    content.encryptionLevel = appWrite_->getEncryptionLevel();
+    EXPECT_EQ(msg.type, ContentType::handshake);
+    EXPECT_TRUE(IOBufEqualTo()(
+        msg.fragment, encodeHandshake(TestMessages::keyUpdate(true))));
+    content.data = folly::IOBuf::copyBuffer("keyupdated");
+    return content;
+  }));
+
+  EXPECT_CALL(*mockKeyScheduler_, serverKeyUpdate());
+  EXPECT_CALL(
+      *mockKeyScheduler_, getSecret(AppTrafficSecrets::ServerAppTraffic))
+      .WillOnce(InvokeWithoutArgs([]() {
+        return DerivedSecret(
+            std::vector<uint8_t>({'s', 'a', 't'}),
+            AppTrafficSecrets::ServerAppTraffic);
+      }));
+  EXPECT_CALL(*mockKeyScheduler_, getTrafficKey(RangeMatches("sat"), _, _))
+      .WillOnce(InvokeWithoutArgs([]() {
+        return TrafficKey{IOBuf::copyBuffer("serverkey"),
+                          IOBuf::copyBuffer("serveriv")};
+      }));
+  // The existing write record layer is rekeyed in place rather than
+  // replaced.
+  EXPECT_CALL(*appWrite_, _rekey(_))
+      .WillOnce(Invoke([](TrafficKeyDeriver& deriver) {
+        auto key = deriver(16, 12);
+        EXPECT_TRUE(IOBufEqualTo()(key.key, IOBuf::copyBuffer("serverkey")));
+        EXPECT_TRUE(IOBufEqualTo()(key.iv, IOBuf::copyBuffer("serveriv")));
+      }));
+
+  KeyUpdateInitiation keyUpdateInitiation;
+  keyUpdateInitiation.request_update = KeyUpdateRequest::update_requested;
+  auto actions = getActions(ServerStateMachine().processKeyUpdateInitiation(
+      state_, std::move(keyUpdateInitiation)));
+  expectActions<MutateState, WriteToSocket, SecretAvailable>(actions);
+  auto write = expectAction<WriteToSocket>(actions);
+  EXPECT_TRUE(
+      IOBufEqualTo()(write.contents[0].data, IOBuf::copyBuffer("keyupdated")));
+  expectSecret(
+      actions, AppTrafficSecrets::ServerAppTraffic, StringPiece("sat"));
+  processStateMutations(actions);
+  EXPECT_EQ(state_.writeRecordLayer().get(), appWrite_);
+  EXPECT_EQ(state_.state(), StateEnum::AcceptingData);
+}
+
 TEST_F(ServerProtocolTest, TestCertificate) {
   setUpExpectingCertificate();
   EXPECT_CALL(
@@ -4427,6 +4690,78 @@ TEST_F(ServerProtocolTest, TestCertificate) {
   EXPECT_EQ(state_.state(), StateEnum::ExpectingCertificateVerify);
 }
 
+TEST_F(ServerProtocolTest, TestCertificateNoVerifier) {
+  setUpExpectingCertificate();
+  context_->setClientCertVerifier(nullptr);
+  EXPECT_CALL(
+      *mockHandshakeContext_, appendToTranscript(BufMatches("certencoding")));
+  EXPECT_CALL(*factory_, _makePeerCert(_)).Times(0);
+
+  auto certificate = TestMessages::certificate();
+  CertificateEntry entry;
+  entry.cert_data = folly::IOBuf::copyBuffer("cert1");
+  certificate.certificate_list.push_back(std::move(entry));
+  auto actions =
+      getActions(detail::processEvent(state_, std::move(certificate)));
+
+  expectActions<MutateState>(actions);
+  processStateMutations(actions);
+  EXPECT_EQ(state_.unverifiedCertChain()->size(), 1);
+  // The raw DER is retained unparsed; the junk encoding only fails once
+  // the certificate is actually used.
+  EXPECT_THROW(
+      state_.unverifiedCertChain()->at(0)->getX509(), std::runtime_error);
+  EXPECT_EQ(state_.state(), StateEnum::ExpectingCertificateVerify);
+}
+
+TEST_F(ServerProtocolTest, TestCertificateInternCacheHit) {
+  setUpExpectingCertificate();
+  auto cache = std::make_shared<PeerCertCache>(10, std::chrono::minutes(5));
+  context_->setClientCertCache(cache);
+  clientLeafCert_ = std::make_shared<MockPeerCert>();
+  cache->put(*folly::IOBuf::copyBuffer("cert1"), clientLeafCert_);
+  EXPECT_CALL(
+      *mockHandshakeContext_, appendToTranscript(BufMatches("certencoding")));
+  EXPECT_CALL(*factory_, _makePeerCert(_)).Times(0);
+
+  auto certificate = TestMessages::certificate();
+  CertificateEntry entry;
+  entry.cert_data = folly::IOBuf::copyBuffer("cert1");
+  certificate.certificate_list.push_back(std::move(entry));
+  auto actions =
+      getActions(detail::processEvent(state_, std::move(certificate)));
+
+  expectActions<MutateState>(actions);
+  processStateMutations(actions);
+  EXPECT_EQ(state_.unverifiedCertChain()->size(), 1);
+  EXPECT_EQ(state_.unverifiedCertChain()->at(0), clientLeafCert_);
+  EXPECT_EQ(state_.state(), StateEnum::ExpectingCertificateVerify);
+}
+
+TEST_F(ServerProtocolTest, TestCertificateInternCacheMiss) {
+  setUpExpectingCertificate();
+  auto cache = std::make_shared<PeerCertCache>(10, std::chrono::minutes(5));
+  context_->setClientCertCache(cache);
+  clientLeafCert_ = std::make_shared<MockPeerCert>();
+  EXPECT_CALL(
+      *mockHandshakeContext_, appendToTranscript(BufMatches("certencoding")));
+  EXPECT_CALL(*factory_, _makePeerCert(BufMatches("cert1")))
+      .WillOnce(Return(clientLeafCert_));
+
+  auto certificate = TestMessages::certificate();
+  CertificateEntry entry;
+  entry.cert_data = folly::IOBuf::copyBuffer("cert1");
+  certificate.certificate_list.push_back(std::move(entry));
+  auto actions =
+      getActions(detail::processEvent(state_, std::move(certificate)));
+
+  expectActions<MutateState>(actions);
+  processStateMutations(actions);
+  EXPECT_EQ(state_.unverifiedCertChain()->at(0), clientLeafCert_);
+  // The miss populated the cache for the next presentation.
+  EXPECT_EQ(cache->get(*folly::IOBuf::copyBuffer("cert1")), clientLeafCert_);
+}
+
 TEST_F(ServerProtocolTest, TestCertificateNonemptyContext) {
   setUpExpectingCertificate();
   EXPECT_CALL(
@@ -4548,6 +4883,83 @@ TEST_F(ServerProtocolTest, TestCertificateVerifyWithVerifier) {
   EXPECT_EQ(state_.state(), StateEnum::ExpectingFinished);
 }
 
+namespace {
+class InlineBatchExecutor : public folly::Executor {
+ public:
+  void add(folly::Func f) override {
+    f();
+  }
+};
+} // namespace
+
+TEST_F(ServerProtocolTest, TestCertificateVerifyBatchVerifier) {
+  setUpExpectingCertificateVerify();
+  context_->setClientCertBatchVerifier(
+      std::make_shared<BatchSignatureVerifier>(
+          std::make_shared<InlineBatchExecutor>()));
+  Sequence contextSeq;
+  EXPECT_CALL(*mockHandshakeContext_, getHandshakeContext())
+      .InSequence(contextSeq)
+      .WillRepeatedly(
+          Invoke([]() { return IOBuf::copyBuffer("certcontext"); }));
+
+  EXPECT_CALL(
+      *clientLeafCert_,
+      verify(
+          SignatureScheme::ecdsa_secp256r1_sha256,
+          CertificateVerifyContext::Client,
+          RangeMatches("certcontext"),
+          RangeMatches("signature")))
+      .InSequence(contextSeq);
+
+  EXPECT_CALL(*certVerifier_, verify(_)).InSequence(contextSeq);
+
+  EXPECT_CALL(
+      *mockHandshakeContext_,
+      appendToTranscript(BufMatches("certverifyencoding")))
+      .InSequence(contextSeq);
+
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::certificateVerify()));
+
+  expectActions<MutateState>(actions);
+  processStateMutations(actions);
+  EXPECT_EQ(state_.unverifiedCertChain(), folly::none);
+  EXPECT_EQ(state_.clientCert(), clientLeafCert_);
+  EXPECT_EQ(state_.state(), StateEnum::ExpectingFinished);
+}
+
+TEST_F(ServerProtocolTest, TestCertificateVerifyBatchVerifierFailure) {
+  setUpExpectingCertificateVerify();
+  context_->setClientCertBatchVerifier(
+      std::make_shared<BatchSignatureVerifier>(
+          std::make_shared<InlineBatchExecutor>()));
+  Sequence contextSeq;
+  EXPECT_CALL(*mockHandshakeContext_, getHandshakeContext())
+      .InSequence(contextSeq)
+      .WillRepeatedly(
+          Invoke([]() { return IOBuf::copyBuffer("certcontext"); }));
+
+  EXPECT_CALL(
+      *clientLeafCert_,
+      verify(
+          SignatureScheme::ecdsa_secp256r1_sha256,
+          CertificateVerifyContext::Client,
+          RangeMatches("certcontext"),
+          RangeMatches("signature")))
+      .InSequence(contextSeq)
+      .WillOnce(Throw(
+          FizzException("verify failed", AlertDescription::bad_record_mac)));
+
+  EXPECT_CALL(*certVerifier_, verify(_)).InSequence(contextSeq);
+
+  auto actions = getActions(
+      detail::processEvent(state_, TestMessages::certificateVerify()));
+
+  expectError<FizzException>(
+      actions, AlertDescription::bad_record_mac, "verify failed");
+}
+
 TEST_F(ServerProtocolTest, TestCertificateVerifyAlgoMismatch) {
   setUpExpectingCertificateVerify();
 
@@ -4715,8 +5127,9 @@ TEST_F(ServerProtocolTest, TestEarlyWriteError) {
 TEST_F(ServerProtocolTest, TestDecodeErrorAlert) {
   setUpAcceptingData();
   EXPECT_CALL(*appRead_, read(_))
-      .WillOnce(Invoke([](auto &&) -> folly::Optional<TLSMessage> {
-        throw std::runtime_error("read record layer error");
+      .WillOnce(Invoke([](auto &&) -> ReadResult<TLSMessage> {
+        return folly::makeUnexpected(ReadError{
+            "read record layer error", AlertDescription::decode_error});
       }));
   folly::IOBufQueue buf;
   auto actions =
@@ -4731,7 +5144,7 @@ TEST_F(ServerProtocolTest, TestDecodeErrorAlert) {
 TEST_F(ServerProtocolTest, TestSocketDataFizzExceptionAlert) {
   setUpAcceptingData();
   EXPECT_CALL(*appRead_, read(_))
-      .WillOnce(Invoke([](auto &&) -> folly::Optional<TLSMessage> {
+      .WillOnce(Invoke([](auto &&) -> ReadResult<TLSMessage> {
         throw FizzException(
             "arbitrary fizzexception with alert",
             AlertDescription::internal_error);
@@ -4751,7 +5164,7 @@ TEST_F(ServerProtocolTest, TestSocketDataFizzExceptionAlert) {
 TEST_F(ServerProtocolTest, TestSocketDataFizzExceptionNoAlert) {
   setUpAcceptingData();
   EXPECT_CALL(*appRead_, read(_))
-      .WillOnce(Invoke([](auto &&) -> folly::Optional<TLSMessage> {
+      .WillOnce(Invoke([](auto &&) -> ReadResult<TLSMessage> {
         throw FizzException(
             "arbitrary fizzexception without alert", folly::none);
       }));
@@ -0,0 +1,178 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GTest.h>
+
+#include <fizz/protocol/OpenSSLFactory.h>
+#include <fizz/protocol/Protocol.h>
+#include <fizz/record/EncryptedRecordLayer.h>
+#include <fizz/server/SessionHandoff.h>
+
+using namespace folly;
+
+namespace fizz {
+namespace server {
+namespace test {
+
+static constexpr StringPiece kClientSecret{
+    "clientappsecret_clientappsecret_"};
+static constexpr StringPiece kServerSecret{
+    "serverappsecret_serverappsecret_"};
+static constexpr StringPiece kResumptionSecret{
+    "resumptionmaster_resumptionmast_"};
+
+class SessionHandoffTest : public testing::Test {
+ protected:
+  State makeEstablishedState() {
+    State state;
+    state.state() = StateEnum::AcceptingData;
+    state.context() = context_;
+    state.version() = ProtocolVersion::tls_1_3;
+    state.cipher() = CipherSuite::TLS_AES_128_GCM_SHA256;
+    state.alpn() = "h2";
+    state.resumptionMasterSecret() = SecretStorage(kResumptionSecret);
+    state.handshakeTime() = std::chrono::system_clock::time_point(
+        std::chrono::milliseconds(1234567890));
+
+    auto scheduler =
+        factory_.makeKeyScheduler(CipherSuite::TLS_AES_128_GCM_SHA256);
+    scheduler->adoptAppTrafficSecrets(kClientSecret, kServerSecret);
+
+    auto readRecordLayer =
+        factory_.makeEncryptedReadRecordLayer(EncryptionLevel::AppTraffic);
+    readRecordLayer->setProtocolVersion(ProtocolVersion::tls_1_3);
+    Protocol::setAead(
+        *readRecordLayer,
+        CipherSuite::TLS_AES_128_GCM_SHA256,
+        kClientSecret,
+        factory_,
+        *scheduler);
+    readRecordLayer->setSequenceNumber(3);
+
+    auto writeRecordLayer =
+        factory_.makeEncryptedWriteRecordLayer(EncryptionLevel::AppTraffic);
+    writeRecordLayer->setProtocolVersion(ProtocolVersion::tls_1_3);
+    Protocol::setAead(
+        *writeRecordLayer,
+        CipherSuite::TLS_AES_128_GCM_SHA256,
+        kServerSecret,
+        factory_,
+        *scheduler);
+    writeRecordLayer->setSequenceNumber(5);
+
+    state.keyScheduler() = std::move(scheduler);
+    state.readRecordLayer() = std::move(readRecordLayer);
+    state.writeRecordLayer() = std::move(writeRecordLayer);
+    return state;
+  }
+
+  OpenSSLFactory factory_;
+  std::shared_ptr<FizzServerContext> context_{
+      std::make_shared<FizzServerContext>()};
+};
+
+TEST_F(SessionHandoffTest, TestRoundTrip) {
+  auto state = makeEstablishedState();
+  auto serialized = serializeSessionState(state);
+  auto restored = deserializeSessionState(factory_, context_, *serialized);
+
+  EXPECT_EQ(restored.state(), StateEnum::AcceptingData);
+  EXPECT_EQ(restored.context().get(), context_.get());
+  EXPECT_EQ(*restored.version(), ProtocolVersion::tls_1_3);
+  EXPECT_EQ(*restored.cipher(), CipherSuite::TLS_AES_128_GCM_SHA256);
+  EXPECT_EQ(*restored.alpn(), "h2");
+  EXPECT_EQ(*restored.handshakeTime(), *state.handshakeTime());
+  EXPECT_TRUE(
+      folly::range(restored.resumptionMasterSecret()) ==
+      folly::ByteRange(kResumptionSecret));
+
+  auto clientSecret =
+      restored.keyScheduler()->getSecret(AppTrafficSecrets::ClientAppTraffic);
+  auto serverSecret =
+      restored.keyScheduler()->getSecret(AppTrafficSecrets::ServerAppTraffic);
+  EXPECT_TRUE(
+      folly::range(clientSecret.secret) == folly::ByteRange(kClientSecret));
+  EXPECT_TRUE(
+      folly::range(serverSecret.secret) == folly::ByteRange(kServerSecret));
+
+  auto readLayer = dynamic_cast<const EncryptedReadRecordLayer*>(
+      restored.readRecordLayer());
+  auto writeLayer = dynamic_cast<const EncryptedWriteRecordLayer*>(
+      restored.writeRecordLayer());
+  ASSERT_NE(readLayer, nullptr);
+  ASSERT_NE(writeLayer, nullptr);
+  EXPECT_EQ(readLayer->getRecordLayerState().sequence, 3);
+  EXPECT_EQ(writeLayer->getRecordLayerState().sequence, 5);
+}
+
+TEST_F(SessionHandoffTest, TestTrafficContinuity) {
+  auto state = makeEstablishedState();
+  auto serialized = serializeSessionState(state);
+  auto restored = deserializeSessionState(factory_, context_, *serialized);
+
+  // The restored write layer continues the original's record stream: the
+  // same plaintext at the same sequence number encrypts identically.
+  auto original = state.writeRecordLayer()->write(
+      TLSMessage{ContentType::application_data, IOBuf::copyBuffer("hello")});
+  auto continued = restored.writeRecordLayer()->write(
+      TLSMessage{ContentType::application_data, IOBuf::copyBuffer("hello")});
+  EXPECT_TRUE(IOBufEqualTo()(original.data, continued.data));
+
+  // And the restored read layer decrypts a record written under the
+  // client's traffic secret at the restored sequence number.
+  auto clientWrite =
+      factory_.makeEncryptedWriteRecordLayer(EncryptionLevel::AppTraffic);
+  clientWrite->setProtocolVersion(ProtocolVersion::tls_1_3);
+  Protocol::setAead(
+      *clientWrite,
+      CipherSuite::TLS_AES_128_GCM_SHA256,
+      kClientSecret,
+      factory_,
+      *restored.keyScheduler());
+  clientWrite->setSequenceNumber(3);
+  auto record = clientWrite->write(
+      TLSMessage{ContentType::application_data, IOBuf::copyBuffer("ping")});
+
+  IOBufQueue queue{IOBufQueue::cacheChainLength()};
+  queue.append(std::move(record.data));
+  auto msg = restored.readRecordLayer()->read(queue).value();
+  EXPECT_EQ(msg->type, ContentType::application_data);
+  EXPECT_EQ(msg->fragment->moveToFbString().toStdString(), "ping");
+}
+
+TEST_F(SessionHandoffTest, TestKeyUpdateAfterHandoff) {
+  auto state = makeEstablishedState();
+  auto serialized = serializeSessionState(state);
+  auto restored = deserializeSessionState(factory_, context_, *serialized);
+
+  // The adopted scheduler supports key updates, as the AppWrite rekey path
+  // requires.
+  EXPECT_EQ(restored.keyScheduler()->serverKeyUpdate(), 1);
+  auto updated =
+      restored.keyScheduler()->getSecret(AppTrafficSecrets::ServerAppTraffic);
+  EXPECT_FALSE(
+      folly::range(updated.secret) == folly::ByteRange(kServerSecret));
+}
+
+TEST_F(SessionHandoffTest, TestNotEstablished) {
+  State state;
+  EXPECT_THROW(serializeSessionState(state), std::runtime_error);
+}
+
+TEST_F(SessionHandoffTest, TestTruncated) {
+  auto state = makeEstablishedState();
+  auto serialized = serializeSessionState(state);
+  serialized->coalesce();
+  serialized->trimEnd(serialized->length() / 2);
+  EXPECT_THROW(
+      deserializeSessionState(factory_, context_, *serialized),
+      std::runtime_error);
+}
+} // namespace test
+} // namespace server
+} // namespace fizz
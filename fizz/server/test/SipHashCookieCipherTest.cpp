@@ -0,0 +1,139 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GMock.h>
+#include <folly/portability/GTest.h>
+
+#include <fizz/server/SipHashCookieCipher.h>
+
+#include <fizz/crypto/test/TestUtil.h>
+#include <fizz/protocol/test/TestMessages.h>
+
+using namespace fizz::test;
+using namespace folly;
+using namespace testing;
+
+static constexpr StringPiece secret{
+    "c44ed3fb98c179579036d201735f43af20a856470b9c527fe07f01f3a2a0bde9"};
+static constexpr StringPiece altSecret{
+    "2b62282b7e8c3553c2d64f810dd9ecc7a24a1b1c0c8a3f21f5ff28bcb04f4552"};
+
+namespace fizz {
+namespace server {
+namespace test {
+
+class SipHashCookieCipherTest : public Test {
+ public:
+  void SetUp() override {
+    context_ = std::make_shared<FizzServerContext>();
+    context_->setSupportedVersions({ProtocolVersion::tls_1_3});
+    cipher_ = std::make_shared<SipHashCookieCipher>();
+    cipher_->setContext(context_.get());
+
+    auto s = toIOBuf(secret);
+    std::vector<ByteRange> cookieSecrets{{s->coalesce()}};
+    EXPECT_TRUE(cipher_->setCookieSecrets(std::move(cookieSecrets)));
+  }
+
+ protected:
+  Buf getClientHello(Buf cookie) {
+    auto chlo = TestMessages::clientHello();
+
+    if (cookie) {
+      Cookie c;
+      c.cookie = std::move(cookie);
+      chlo.extensions.push_back(encodeExtension(std::move(c)));
+    }
+
+    return PlaintextWriteRecordLayer()
+        .writeInitialClientHello(encodeHandshake(std::move(chlo)))
+        .data;
+  }
+
+  Buf getCookieFromRetry(Buf retry) {
+    folly::IOBufQueue queue{folly::IOBufQueue::cacheChainLength()};
+    queue.append(std::move(retry));
+    auto msg = PlaintextReadRecordLayer().readEvent(queue).value();
+    auto hrr = std::move(boost::get<HelloRetryRequest>(*msg));
+    auto cookie = getExtension<Cookie>(hrr.extensions);
+    EXPECT_TRUE(cookie.hasValue());
+    return std::move(cookie->cookie);
+  }
+
+  std::shared_ptr<FizzServerContext> context_;
+  std::shared_ptr<SipHashCookieCipher> cipher_;
+};
+
+TEST_F(SipHashCookieCipherTest, TestRoundTrip) {
+  auto res = cipher_->getTokenOrRetry(
+      getClientHello(nullptr), IOBuf::copyBuffer("test"));
+  auto msg = std::move(boost::get<StatelessHelloRetryRequest>(res));
+  auto cookie = getCookieFromRetry(std::move(msg.data));
+
+  auto state = cipher_->decrypt(std::move(cookie));
+  EXPECT_TRUE(state.hasValue());
+  EXPECT_EQ(state->version, ProtocolVersion::tls_1_3);
+  EXPECT_TRUE(IOBufEqualTo()(state->appToken, IOBuf::copyBuffer("test")));
+}
+
+TEST_F(SipHashCookieCipherTest, TestGetToken) {
+  auto res = cipher_->getTokenOrRetry(
+      getClientHello(nullptr), IOBuf::copyBuffer("test"));
+  auto msg = std::move(boost::get<StatelessHelloRetryRequest>(res));
+  auto cookie = getCookieFromRetry(std::move(msg.data));
+
+  auto res2 = cipher_->getTokenOrRetry(
+      getClientHello(std::move(cookie)), IOBuf::copyBuffer("xx"));
+  auto token = std::move(boost::get<AppToken>(res2));
+  EXPECT_TRUE(IOBufEqualTo()(token.token, IOBuf::copyBuffer("test")));
+}
+
+TEST_F(SipHashCookieCipherTest, TestWrongKey) {
+  auto res = cipher_->getTokenOrRetry(
+      getClientHello(nullptr), IOBuf::copyBuffer("test"));
+  auto msg = std::move(boost::get<StatelessHelloRetryRequest>(res));
+  auto cookie = getCookieFromRetry(std::move(msg.data));
+
+  SipHashCookieCipher other;
+  other.setContext(context_.get());
+  auto s = toIOBuf(altSecret);
+  std::vector<ByteRange> cookieSecrets{{s->coalesce()}};
+  EXPECT_TRUE(other.setCookieSecrets(std::move(cookieSecrets)));
+
+  EXPECT_FALSE(other.decrypt(std::move(cookie)).hasValue());
+}
+
+TEST_F(SipHashCookieCipherTest, TestMultipleSecrets) {
+  auto res = cipher_->getTokenOrRetry(
+      getClientHello(nullptr), IOBuf::copyBuffer("test"));
+  auto msg = std::move(boost::get<StatelessHelloRetryRequest>(res));
+  auto cookie = getCookieFromRetry(std::move(msg.data));
+
+  SipHashCookieCipher other;
+  other.setContext(context_.get());
+  auto s1 = toIOBuf(altSecret);
+  auto s2 = toIOBuf(secret);
+  std::vector<ByteRange> cookieSecrets{{s1->coalesce()}, {s2->coalesce()}};
+  EXPECT_TRUE(other.setCookieSecrets(std::move(cookieSecrets)));
+
+  EXPECT_TRUE(other.decrypt(std::move(cookie)).hasValue());
+}
+
+TEST_F(SipHashCookieCipherTest, TestJunkCookie) {
+  EXPECT_FALSE(cipher_->decrypt(IOBuf::copyBuffer("junk")).hasValue());
+}
+
+TEST_F(SipHashCookieCipherTest, TestShortSecret) {
+  SipHashCookieCipher other;
+  std::vector<uint8_t> shortSecret(8);
+  std::vector<ByteRange> cookieSecrets{{folly::range(shortSecret)}};
+  EXPECT_FALSE(other.setCookieSecrets(std::move(cookieSecrets)));
+}
+} // namespace test
+} // namespace server
+} // namespace fizz
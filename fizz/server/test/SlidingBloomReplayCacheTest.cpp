@@ -13,6 +13,8 @@
 
 #include <folly/Random.h>
 
+#include <atomic>
+#include <thread>
 #include <unordered_set>
 
 using namespace folly;
@@ -100,6 +102,46 @@ TEST(SlidingBloomReplayCacheTest, TestCacheErrorRate) {
   EXPECT_LT(actualErrorRate, 0.001);
 }
 
+TEST(SlidingBloomReplayCacheTest, TestConcurrentTestAndSet) {
+  const int numThreads = 4;
+  const int numTriesPerThread = 1 << 12;
+  const int numTries = numThreads * numTriesPerThread;
+  SlidingBloomReplayCache cache(12, numTries, 0.0005, nullptr);
+
+  std::vector<std::string> history(numTries);
+  for (size_t i = 0; i < numTries; i++) {
+    history[i] = generateRandomString(8, 64);
+  }
+
+  // Each value is offered from two threads concurrently. Two racing
+  // testAndSet calls on the same value may both observe it as unseen
+  // before either's relaxed stores land; the design tolerates such
+  // double-accepts, so this test only checks for false negatives.
+  std::atomic<size_t> firstSets{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < numThreads; t++) {
+    threads.emplace_back([&, t]() {
+      size_t start = (t / 2) * 2 * numTriesPerThread;
+      for (size_t i = start; i < start + 2 * numTriesPerThread; i++) {
+        if (!cache.testAndSet(toRange(history[i]))) {
+          firstSets++;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (size_t i = 0; i < numTries; i++) {
+    EXPECT_TRUE(cache.test(toRange(history[i])));
+  }
+
+  // Allow a small margin for false positives. There is deliberately no
+  // upper bound: concurrent racing sets can count the same value twice.
+  EXPECT_GE(firstSets.load(), numTries * 0.999);
+}
+
 TEST(SlidingBloomReplayCacheTest, TestTimeBucketing) {
   const int numTries = 1 << 14;
 
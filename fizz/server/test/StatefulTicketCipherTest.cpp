@@ -0,0 +1,128 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GMock.h>
+#include <folly/portability/GTest.h>
+
+#include <fizz/server/StatefulTicketCipher.h>
+
+#include <fizz/protocol/clock/test/Mocks.h>
+
+using namespace fizz::test;
+using namespace folly;
+using namespace testing;
+
+namespace fizz {
+namespace server {
+namespace test {
+
+class StatefulTicketCipherTest : public Test {
+ public:
+  void SetUp() override {
+    cipher_ = std::make_unique<StatefulTicketCipher>(
+        100, std::chrono::seconds(100));
+    clock_ = std::make_shared<MockClock>();
+    ON_CALL(*clock_, getCurrentTime())
+        .WillByDefault(Return(
+            std::chrono::system_clock::time_point(std::chrono::minutes(5))));
+    cipher_->setClock(clock_);
+  }
+
+ protected:
+  static ResumptionState makeState() {
+    ResumptionState state;
+    state.version = ProtocolVersion::tls_1_3;
+    state.cipher = CipherSuite::TLS_AES_128_GCM_SHA256;
+    state.resumptionSecret = IOBuf::copyBuffer("resumptionsecret");
+    state.alpn = "h2";
+    state.ticketAgeAdd = 0x44444444;
+    state.appToken = IOBuf::copyBuffer("apptoken");
+    return state;
+  }
+
+  std::unique_ptr<StatefulTicketCipher> cipher_;
+  std::shared_ptr<MockClock> clock_;
+};
+
+TEST_F(StatefulTicketCipherTest, TestLookup) {
+  auto ticket = cipher_->encrypt(makeState()).get();
+  EXPECT_TRUE(ticket.hasValue());
+  EXPECT_EQ(ticket->first->computeChainDataLength(), 16);
+  EXPECT_EQ(ticket->second, std::chrono::seconds(100));
+
+  auto result = cipher_->decrypt(ticket->first->clone()).get();
+  EXPECT_EQ(result.first, PskType::Resumption);
+  ASSERT_TRUE(result.second.hasValue());
+  EXPECT_EQ(result.second->version, ProtocolVersion::tls_1_3);
+  EXPECT_EQ(result.second->cipher, CipherSuite::TLS_AES_128_GCM_SHA256);
+  EXPECT_TRUE(IOBufEqualTo()(
+      result.second->resumptionSecret, IOBuf::copyBuffer("resumptionsecret")));
+  EXPECT_EQ(*result.second->alpn, "h2");
+  EXPECT_EQ(result.second->ticketAgeAdd, 0x44444444);
+  EXPECT_TRUE(
+      IOBufEqualTo()(result.second->appToken, IOBuf::copyBuffer("apptoken")));
+
+  // Tickets stay redeemable until expiry, so a retry still resumes.
+  auto retry = cipher_->decrypt(ticket->first->clone()).get();
+  EXPECT_EQ(retry.first, PskType::Resumption);
+  EXPECT_TRUE(retry.second.hasValue());
+}
+
+TEST_F(StatefulTicketCipherTest, TestUnknownTicket) {
+  auto result =
+      cipher_->decrypt(IOBuf::copyBuffer("0123456789abcdef")).get();
+  EXPECT_EQ(result.first, PskType::Rejected);
+  EXPECT_FALSE(result.second.hasValue());
+
+  // Wrong length is rejected without a probe.
+  auto shortResult = cipher_->decrypt(IOBuf::copyBuffer("short")).get();
+  EXPECT_EQ(shortResult.first, PskType::Rejected);
+}
+
+TEST_F(StatefulTicketCipherTest, TestExpiredTicket) {
+  auto ticket = cipher_->encrypt(makeState()).get();
+  EXPECT_CALL(*clock_, getCurrentTime())
+      .WillRepeatedly(Return(
+          std::chrono::system_clock::time_point(std::chrono::minutes(10))));
+  auto result = cipher_->decrypt(ticket->first->clone()).get();
+  EXPECT_EQ(result.first, PskType::Rejected);
+  EXPECT_FALSE(result.second.hasValue());
+}
+
+TEST_F(StatefulTicketCipherTest, TestDistinctTickets) {
+  auto ticket1 = cipher_->encrypt(makeState()).get();
+  auto ticket2 = cipher_->encrypt(makeState()).get();
+  EXPECT_FALSE(IOBufEqualTo()(ticket1->first, ticket2->first));
+}
+
+TEST_F(StatefulTicketCipherTest, TestCapacityEviction) {
+  // Capacity 16 leaves one slot per shard, so re-encrypting into a
+  // shard evicts its previous ticket.
+  auto smallCipher = std::make_unique<StatefulTicketCipher>(
+      16, std::chrono::seconds(100));
+  smallCipher->setClock(clock_);
+
+  std::vector<Buf> tickets;
+  for (int i = 0; i < 64; i++) {
+    tickets.push_back(
+        std::move(smallCipher->encrypt(makeState()).get()->first));
+  }
+  size_t resumed = 0;
+  for (auto& ticket : tickets) {
+    auto result = smallCipher->decrypt(ticket->clone()).get();
+    if (result.first == PskType::Resumption) {
+      resumed++;
+    }
+  }
+  // At most one survivor per shard; random ids make exact counts vary.
+  EXPECT_LE(resumed, 16);
+  EXPECT_GE(resumed, 1);
+}
+} // namespace test
+} // namespace server
+} // namespace fizz
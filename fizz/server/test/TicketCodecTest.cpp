@@ -111,6 +111,53 @@ TEST(TicketCodecTest, TestEncodeClientAuthIdentityOnly) {
       << folly::hexlify(encoded->coalesce());
 }
 
+TEST(TicketCodecTest, TestFingerprintRoundTrip) {
+  auto cert = std::make_shared<MockSelfCert>();
+  auto peerCert = std::make_shared<MockPeerCert>();
+  auto rs = getTestResumptionState(cert, peerCert);
+  EXPECT_CALL(*cert, getIdentity()).WillOnce(Return("ident"));
+  EXPECT_CALL(*peerCert, getIdentity()).WillOnce(Return("clientid"));
+  EXPECT_CALL(*peerCert, getX509()).Times(2).WillRepeatedly(Invoke([]() {
+    return getCert(kRSACertificate);
+  }));
+  auto encoded =
+      TicketCodec<CertificateStorage::Fingerprint>::encode(std::move(rs));
+  EXPECT_LT(encoded->computeChainDataLength(), 200);
+  auto drs = TicketCodec<CertificateStorage::Fingerprint>::decode(
+      std::move(encoded), nullptr);
+  EXPECT_EQ(drs.clientCert.get(), peerCert.get());
+}
+
+TEST(TicketCodecTest, TestFingerprintCacheMiss) {
+  auto cert = std::make_shared<MockSelfCert>();
+  auto peerCert = std::make_shared<MockPeerCert>();
+  auto rs = getTestResumptionState(cert, peerCert);
+  EXPECT_CALL(*cert, getIdentity()).WillRepeatedly(Return("ident"));
+  EXPECT_CALL(*peerCert, getIdentity()).WillOnce(Return("clientid"));
+  EXPECT_CALL(*peerCert, getX509()).Times(2).WillRepeatedly(Invoke([]() {
+    return getCert(kRSACertificate);
+  }));
+  auto encoded =
+      TicketCodec<CertificateStorage::Fingerprint>::encode(std::move(rs));
+
+  // Evict the cached cert by shrinking the cache and inserting another.
+  setClientCertCacheSize(1);
+  auto otherPeerCert = std::make_shared<MockPeerCert>();
+  auto rs2 = getTestResumptionState(cert, otherPeerCert);
+  EXPECT_CALL(*otherPeerCert, getIdentity()).WillOnce(Return("clientid2"));
+  EXPECT_CALL(*otherPeerCert, getX509()).Times(2).WillRepeatedly(Invoke([]() {
+    return getCert(kP256Certificate);
+  }));
+  TicketCodec<CertificateStorage::Fingerprint>::encode(std::move(rs2));
+
+  auto drs = TicketCodec<CertificateStorage::Fingerprint>::decode(
+      std::move(encoded), nullptr);
+  EXPECT_TRUE(drs.clientCert);
+  EXPECT_EQ(drs.clientCert->getIdentity(), "clientid");
+  EXPECT_EQ(drs.clientCert->getX509(), nullptr);
+  setClientCertCacheSize(10000);
+}
+
 TEST(TicketCodecTest, TestEncodeNoX509) {
   auto cert = std::make_shared<MockSelfCert>();
   auto peerCert = std::make_shared<MockPeerCert>();
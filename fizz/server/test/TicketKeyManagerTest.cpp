@@ -0,0 +1,177 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GMock.h>
+#include <folly/portability/GTest.h>
+
+#include <fizz/server/TicketKeyManager.h>
+
+#include <fizz/protocol/clock/test/Mocks.h>
+
+using namespace folly;
+using namespace testing;
+
+static constexpr StringPiece masterSecret{
+    "thisisa32bytemastersecret1234567"};
+
+namespace fizz {
+namespace server {
+namespace test {
+
+class MockTicketCodecInstance {
+ public:
+  MOCK_CONST_METHOD1(_encode, Buf(ResumptionState& state));
+  MOCK_CONST_METHOD2(
+      _decode,
+      ResumptionState(Buf& encoded, const FizzServerContext* context));
+};
+
+class MockTicketCodec {
+ public:
+  static constexpr folly::StringPiece Label{"Mock Ticket Codec"};
+  static Buf encode(ResumptionState state) {
+    return instance->_encode(state);
+  }
+  static ResumptionState decode(Buf encoded, const FizzServerContext* context) {
+    return instance->_decode(encoded, context);
+  }
+  static MockTicketCodecInstance* instance;
+};
+MockTicketCodecInstance* MockTicketCodec::instance;
+constexpr folly::StringPiece MockTicketCodec::Label;
+
+using TestTicketKeyManager = TicketKeyManager<
+    OpenSSLEVPCipher<AESGCM128>,
+    MockTicketCodec,
+    HkdfImpl<Sha256>>;
+
+class TicketKeyManagerTest : public Test {
+ public:
+  ~TicketKeyManagerTest() override = default;
+  void SetUp() override {
+    MockTicketCodec::instance = &codec_;
+    clock_ = std::make_shared<fizz::test::MockClock>();
+    EXPECT_CALL(*clock_, getCurrentTime())
+        .WillRepeatedly(InvokeWithoutArgs([this]() { return currentTime_; }));
+    currentTime_ =
+        std::chrono::system_clock::time_point(std::chrono::hours(1));
+    setupManager(manager_);
+  }
+
+ protected:
+  void setupManager(TestTicketKeyManager& manager) {
+    manager.setClock(clock_);
+    manager.setEpochDuration(std::chrono::hours(1));
+    EXPECT_TRUE(manager.setMasterSecret(masterSecret));
+  }
+
+  void expectEncode(int times = 1) {
+    EXPECT_CALL(codec_, _encode(_))
+        .Times(times)
+        .WillRepeatedly(InvokeWithoutArgs(
+            []() { return IOBuf::copyBuffer("encodedticket"); }));
+  }
+
+  void expectDecode(int times = 1) {
+    EXPECT_CALL(codec_, _decode(_, _))
+        .Times(times)
+        .WillRepeatedly(
+            Invoke([](Buf& encoded, const FizzServerContext* /*context*/) {
+              EXPECT_TRUE(
+                  IOBufEqualTo()(encoded, IOBuf::copyBuffer("encodedticket")));
+              return ResumptionState();
+            }));
+  }
+
+  void advance(std::chrono::seconds duration) {
+    currentTime_ += duration;
+  }
+
+  TestTicketKeyManager manager_;
+  MockTicketCodecInstance codec_;
+  std::shared_ptr<fizz::test::MockClock> clock_;
+  std::chrono::system_clock::time_point currentTime_;
+};
+
+TEST_F(TicketKeyManagerTest, TestNoMasterSecret) {
+  TestTicketKeyManager manager;
+  manager.setClock(clock_);
+  EXPECT_FALSE(manager.encrypt(ResumptionState()).get().hasValue());
+  EXPECT_EQ(
+      manager.decrypt(IOBuf::copyBuffer("ticket")).get().first,
+      PskType::Rejected);
+}
+
+TEST_F(TicketKeyManagerTest, TestShortMasterSecretRejected) {
+  TestTicketKeyManager manager;
+  EXPECT_FALSE(manager.setMasterSecret(StringPiece("tooshort")));
+}
+
+TEST_F(TicketKeyManagerTest, TestRoundTrip) {
+  expectEncode();
+  expectDecode();
+  auto result = manager_.encrypt(ResumptionState()).get();
+  ASSERT_TRUE(result.hasValue());
+  auto decResult = manager_.decrypt(result->first->clone()).get();
+  EXPECT_EQ(decResult.first, PskType::Resumption);
+  EXPECT_TRUE(decResult.second.hasValue());
+}
+
+TEST_F(TicketKeyManagerTest, TestRotationOverlap) {
+  expectEncode();
+  auto result = manager_.encrypt(ResumptionState()).get();
+  ASSERT_TRUE(result.hasValue());
+  auto startEpoch = manager_.getCurrentEpoch();
+
+  // One epoch later the previous epoch's secret still decrypts.
+  advance(std::chrono::hours(1));
+  EXPECT_EQ(manager_.getCurrentEpoch(), startEpoch + 1);
+  expectDecode();
+  EXPECT_EQ(
+      manager_.decrypt(result->first->clone()).get().first,
+      PskType::Resumption);
+
+  // Two epochs later the secret has aged out of the overlap window.
+  advance(std::chrono::hours(1));
+  EXPECT_EQ(
+      manager_.decrypt(result->first->clone()).get().first,
+      PskType::Rejected);
+}
+
+TEST_F(TicketKeyManagerTest, TestClockSkewTolerance) {
+  // A ticket sealed by a server one epoch ahead decrypts via the next
+  // epoch's secret.
+  advance(std::chrono::hours(1));
+  expectEncode();
+  auto result = manager_.encrypt(ResumptionState()).get();
+  ASSERT_TRUE(result.hasValue());
+
+  advance(std::chrono::hours(-1));
+  expectDecode();
+  EXPECT_EQ(
+      manager_.decrypt(result->first->clone()).get().first,
+      PskType::Resumption);
+}
+
+TEST_F(TicketKeyManagerTest, TestSharedMasterSecret) {
+  // Managers sharing a master secret derive the same epoch secrets, so
+  // rotation needs no coordinated secret distribution.
+  TestTicketKeyManager other;
+  setupManager(other);
+  expectEncode();
+  expectDecode();
+  auto result = manager_.encrypt(ResumptionState()).get();
+  ASSERT_TRUE(result.hasValue());
+  EXPECT_EQ(
+      other.decrypt(result->first->clone()).get().first,
+      PskType::Resumption);
+}
+
+} // namespace test
+} // namespace server
+} // namespace fizz
@@ -0,0 +1,93 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GMock.h>
+#include <folly/portability/GTest.h>
+
+#include <fizz/server/TieredReplayCache.h>
+#include <fizz/server/test/Mocks.h>
+
+using namespace folly;
+using namespace testing;
+
+namespace fizz {
+namespace server {
+namespace test {
+
+static folly::ByteRange toRange(const std::string& str) {
+  return folly::ByteRange(folly::StringPiece(str));
+}
+
+static std::unique_ptr<SlidingBloomReplayCache> makeLocalCache() {
+  return std::make_unique<SlidingBloomReplayCache>(12, 100, 0.0005, nullptr);
+}
+
+TEST(TieredReplayCacheTest, TestLocalHitSkipsRemote) {
+  auto remote = std::make_shared<MockReplayCache>();
+  EXPECT_CALL(*remote, check(_))
+      .Times(1)
+      .WillOnce(Return(ReplayCacheResult::NotReplay));
+
+  TieredReplayCache cache(makeLocalCache(), remote);
+  std::string id = "identifier";
+  EXPECT_EQ(cache.check(toRange(id)).get(), ReplayCacheResult::NotReplay);
+  EXPECT_EQ(cache.check(toRange(id)).get(), ReplayCacheResult::MaybeReplay);
+}
+
+TEST(TieredReplayCacheTest, TestOptimisticAccept) {
+  auto remote = std::make_shared<MockReplayCache>();
+  folly::Promise<ReplayCacheResult> remotePromise;
+  EXPECT_CALL(*remote, check(_))
+      .WillOnce(InvokeWithoutArgs(
+          [&remotePromise]() { return remotePromise.getFuture(); }));
+
+  TieredReplayCache cache(
+      makeLocalCache(), remote, TieredReplayCache::PendingPolicy::Optimistic);
+  std::string id = "identifier";
+  auto future = cache.check(toRange(id));
+  ASSERT_TRUE(future.isReady());
+  EXPECT_EQ(std::move(future).get(), ReplayCacheResult::NotReplay);
+  EXPECT_EQ(cache.getLateRemoteHits(), 0);
+
+  remotePromise.setValue(ReplayCacheResult::DefinitelyReplay);
+  EXPECT_EQ(cache.getLateRemoteHits(), 1);
+}
+
+TEST(TieredReplayCacheTest, TestPessimisticWaitsForRemote) {
+  auto remote = std::make_shared<MockReplayCache>();
+  folly::Promise<ReplayCacheResult> remotePromise;
+  EXPECT_CALL(*remote, check(_))
+      .WillOnce(InvokeWithoutArgs(
+          [&remotePromise]() { return remotePromise.getFuture(); }));
+
+  TieredReplayCache cache(
+      makeLocalCache(), remote, TieredReplayCache::PendingPolicy::Pessimistic);
+  std::string id = "identifier";
+  auto future = cache.check(toRange(id));
+  EXPECT_FALSE(future.isReady());
+
+  remotePromise.setValue(ReplayCacheResult::NotReplay);
+  ASSERT_TRUE(future.isReady());
+  EXPECT_EQ(std::move(future).get(), ReplayCacheResult::NotReplay);
+}
+
+TEST(TieredReplayCacheTest, TestPessimisticRemoteErrorFailsClosed) {
+  auto remote = std::make_shared<MockReplayCache>();
+  EXPECT_CALL(*remote, check(_)).WillOnce(InvokeWithoutArgs([]() {
+    return folly::makeFuture<ReplayCacheResult>(
+        std::runtime_error("remote unavailable"));
+  }));
+
+  TieredReplayCache cache(
+      makeLocalCache(), remote, TieredReplayCache::PendingPolicy::Pessimistic);
+  std::string id = "identifier";
+  EXPECT_EQ(cache.check(toRange(id)).get(), ReplayCacheResult::MaybeReplay);
+}
+} // namespace test
+} // namespace server
+} // namespace fizz
@@ -0,0 +1,187 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GTest.h>
+
+#include <fizz/client/AsyncFizzClient.h>
+#include <fizz/crypto/Utils.h>
+#include <fizz/crypto/aead/AESGCM128.h>
+#include <fizz/crypto/aead/OpenSSLEVPCipher.h>
+#include <fizz/crypto/test/TestUtil.h>
+#include <fizz/record/EncryptedRecordLayer.h>
+#include <fizz/server/AsyncFizzServer.h>
+#include <fizz/server/CertManager.h>
+#include <fizz/test/LocalTransport.h>
+#include <fizz/test/MallocCounter.h>
+
+using namespace folly;
+using namespace fizz::client;
+using namespace fizz::server;
+
+namespace fizz {
+namespace test {
+
+/**
+ * Allocation-count regression tests. These pin the number of heap
+ * allocations for a full handshake and for a steady-state record round
+ * trip, so that allocation regressions fail CI rather than showing up in
+ * production profiles. The ceilings are deliberately a small margin above
+ * the measured counts; ratchet them down as pooling work lands, and bump
+ * them only with an explanation of where the new allocations come from.
+ */
+
+// Both sides of one full handshake (no PSK, no client auth), measured
+// after a warmup handshake has primed the per-thread recyclers.
+constexpr uint64_t kHandshakeAllocationLimit = 3000;
+
+// One 1400 byte application data record encrypted and decrypted through
+// warm encrypted record layers.
+constexpr uint64_t kRecordRoundTripAllocationLimit = 30;
+
+namespace {
+
+class ClientCallback : public AsyncFizzClient::HandshakeCallback {
+ public:
+  void fizzHandshakeSuccess(AsyncFizzClient*) noexcept override {
+    success = true;
+  }
+
+  void fizzHandshakeError(
+      AsyncFizzClient*,
+      folly::exception_wrapper ex) noexcept override {
+    ADD_FAILURE() << "client handshake error: " << ex.what();
+  }
+
+  bool success{false};
+};
+
+class ServerCallback : public AsyncFizzServer::HandshakeCallback {
+ public:
+  void fizzHandshakeSuccess(AsyncFizzServer*) noexcept override {
+    success = true;
+  }
+
+  void fizzHandshakeError(
+      AsyncFizzServer*,
+      folly::exception_wrapper ex) noexcept override {
+    ADD_FAILURE() << "server handshake error: " << ex.what();
+  }
+
+  void fizzHandshakeAttemptFallback(
+      std::unique_ptr<folly::IOBuf> /*clientHello*/) override {
+    ADD_FAILURE() << "unexpected fallback";
+  }
+
+  bool success{false};
+};
+} // namespace
+
+class AllocationTest : public testing::Test {
+ public:
+  void SetUp() override {
+    CryptoUtils::init();
+
+    clientContext_ = std::make_shared<FizzClientContext>();
+    serverContext_ = std::make_shared<FizzServerContext>();
+
+    auto certManager = std::make_unique<CertManager>();
+    std::vector<ssl::X509UniquePtr> certs;
+    certs.emplace_back(getCert(kP256Certificate));
+    certManager->addCert(
+        std::make_shared<SelfCertImpl<KeyType::P256>>(
+            getPrivateKey(kP256Key), std::move(certs)),
+        true);
+    serverContext_->setCertManager(std::move(certManager));
+  }
+
+  void doHandshake() {
+    auto clientTransport = LocalTransport::UniquePtr(new LocalTransport());
+    auto serverTransport = LocalTransport::UniquePtr(new LocalTransport());
+    clientTransport->attachEventBase(&evb_);
+    serverTransport->attachEventBase(&evb_);
+    clientTransport->setPeer(serverTransport.get());
+    serverTransport->setPeer(clientTransport.get());
+    client_.reset(
+        new AsyncFizzClient(std::move(clientTransport), clientContext_));
+    server_.reset(
+        new AsyncFizzServer(std::move(serverTransport), serverContext_));
+
+    clientCallback_.success = false;
+    serverCallback_.success = false;
+    client_->connect(&clientCallback_, nullptr, folly::none, folly::none);
+    server_->accept(&serverCallback_);
+    evb_.loop();
+
+    EXPECT_TRUE(clientCallback_.success);
+    EXPECT_TRUE(serverCallback_.success);
+  }
+
+ protected:
+  EventBase evb_;
+  std::shared_ptr<FizzClientContext> clientContext_;
+  std::shared_ptr<FizzServerContext> serverContext_;
+  AsyncFizzClient::UniquePtr client_;
+  AsyncFizzServer::UniquePtr server_;
+  ClientCallback clientCallback_;
+  ServerCallback serverCallback_;
+};
+
+TEST_F(AllocationTest, TestFullHandshakeAllocations) {
+  if (!mallocCountingSupported()) {
+    return;
+  }
+
+  // Warmup handshake primes per-thread recyclers and lazy initialization
+  // so the counted handshake reflects steady-state behavior.
+  doHandshake();
+
+  MallocCounterGuard guard;
+  doHandshake();
+  EXPECT_LE(guard.count(), kHandshakeAllocationLimit);
+}
+
+TEST_F(AllocationTest, TestRecordRoundTripAllocations) {
+  if (!mallocCountingSupported()) {
+    return;
+  }
+
+  auto makeAead = []() {
+    auto aead = std::make_unique<OpenSSLEVPCipher<AESGCM128>>();
+    TrafficKey key;
+    key.key = IOBuf::copyBuffer(std::string(AESGCM128::kKeyLength, 0x11));
+    key.iv = IOBuf::copyBuffer(std::string(AESGCM128::kIVLength, 0x22));
+    aead->setKey(std::move(key));
+    return aead;
+  };
+  EncryptedWriteRecordLayer write{EncryptionLevel::AppTraffic};
+  write.setAead(folly::ByteRange(), makeAead());
+  EncryptedReadRecordLayer read{EncryptionLevel::AppTraffic};
+  read.setAead(folly::ByteRange(), makeAead());
+
+  IOBufQueue queue{IOBufQueue::cacheChainLength()};
+  auto roundTrip = [&]() {
+    auto payload = IOBuf::create(1400);
+    memset(payload->writableTail(), 0x33, 1400);
+    payload->append(1400);
+    auto content = write.write(
+        TLSMessage{ContentType::application_data, std::move(payload)});
+    queue.append(std::move(content.data));
+    auto msg = read.read(queue).value();
+    EXPECT_TRUE(msg.hasValue());
+  };
+
+  // Warm up so one-time buffer growth is not counted.
+  roundTrip();
+  roundTrip();
+
+  MallocCounterGuard guard;
+  roundTrip();
+  EXPECT_LE(guard.count(), kRecordRoundTripAllocationLimit);
+}
+} // namespace test
+} // namespace fizz
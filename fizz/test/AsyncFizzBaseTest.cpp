@@ -60,6 +60,7 @@ class AsyncFizzBaseTest : public testing::Test, public AsyncFizzBase {
   MOCK_CONST_METHOD0(getCipher, folly::Optional<CipherSuite>());
   MOCK_CONST_METHOD0(getSupportedSigSchemes, std::vector<SignatureScheme>());
   MOCK_CONST_METHOD3(getEkm, Buf(folly::StringPiece, const Buf&, uint16_t));
+  MOCK_METHOD1(updateTrafficKeys, void(bool));
 
   MOCK_METHOD3(
       writeAppDataInternal,
@@ -229,6 +230,30 @@ TEST_F(AsyncFizzBaseTest, TestWrite) {
   writeChain(nullptr, std::move(buf));
 }
 
+TEST_F(AsyncFizzBaseTest, TestZeroCopyThreshold) {
+  setZeroCopyThreshold(10);
+
+  // Writes below the threshold stay on the copying path.
+  EXPECT_CALL(*socket_, writeChain(_, _, folly::WriteFlags::NONE));
+  queueTransportWrite(
+      this, IOBuf::copyBuffer("short"), folly::WriteFlags::NONE);
+
+  EXPECT_CALL(
+      *socket_, writeChain(_, _, folly::WriteFlags::WRITE_MSG_ZEROCOPY));
+  queueTransportWrite(
+      this,
+      IOBuf::copyBuffer("long enough for zero-copy"),
+      folly::WriteFlags::NONE);
+}
+
+TEST_F(AsyncFizzBaseTest, TestZeroCopyDisabled) {
+  EXPECT_CALL(*socket_, writeChain(_, _, folly::WriteFlags::NONE));
+  queueTransportWrite(
+      this,
+      IOBuf::copyBuffer("long enough for zero-copy"),
+      folly::WriteFlags::NONE);
+}
+
 TEST_F(AsyncFizzBaseTest, TestReadErr) {
   setReadCB(&readCallback_);
 
@@ -426,6 +451,76 @@ TEST_F(AsyncFizzBaseTest, TestTransportReadBufAvail) {
       eq(*IOBuf::copyBuffer("hellogoodbye"), *transportReadBuf_.front()));
 }
 
+TEST_F(AsyncFizzBaseTest, TestAdaptiveReadBufferGrowth) {
+  void* buf;
+  size_t len;
+  expectTransportReadCallback();
+  startTransportReads();
+  // A minimum above the pooled buffer size so growth is visible in the
+  // allocation rather than absorbed by pooled tailroom.
+  setReadBufferSizes(20 * 1024, 64 * 1024);
+
+  transportReadCallback_->getReadBuffer(&buf, &len);
+  auto initialLen = len;
+
+  // Completely filling the buffer doubles the next allocation.
+  EXPECT_CALL(*this, transportDataAvailable());
+  std::memset(buf, 0x5c, len);
+  transportReadCallback_->readDataAvailable(len);
+
+  // Consume the buffered data so the next read is hint-sized rather than
+  // sized to complete the (garbage) record at the front of the queue.
+  transportReadBuf_.move();
+
+  transportReadCallback_->getReadBuffer(&buf, &len);
+  EXPECT_GT(len, initialLen);
+}
+
+TEST_F(AsyncFizzBaseTest, TestRecordSizedRead) {
+  void* buf;
+  size_t len;
+  expectTransportReadCallback();
+  startTransportReads();
+
+  // A 5 byte record header declaring a 100 byte body, with 10 body bytes
+  // received so far.
+  std::string partialRecord("\x17\x03\x03\x00\x64", 5);
+  partialRecord += std::string(10, 'a');
+  EXPECT_CALL(*this, transportDataAvailable());
+  transportReadCallback_->readBufferAvailable(
+      IOBuf::copyBuffer(partialRecord));
+
+  // The next read request is sized to exactly complete the record.
+  transportReadCallback_->getReadBuffer(&buf, &len);
+  EXPECT_EQ(len, 90);
+
+  // Completing the record does not perturb the adaptive hint; the
+  // following read is hint-sized again.
+  EXPECT_CALL(*this, transportDataAvailable());
+  std::memset(buf, 'a', len);
+  transportReadCallback_->readDataAvailable(len);
+  transportReadCallback_->getReadBuffer(&buf, &len);
+  EXPECT_GE(len, 1460);
+}
+
+TEST_F(AsyncFizzBaseTest, TestReadBufferSizeLimits) {
+  void* buf;
+  size_t len;
+  expectTransportReadCallback();
+  startTransportReads();
+  setReadBufferSizes(1000, 1000);
+
+  transportReadCallback_->getReadBuffer(&buf, &len);
+  EXPECT_CALL(*this, transportDataAvailable());
+  std::memset(buf, 0x5c, len);
+  transportReadCallback_->readDataAvailable(len);
+
+  // The buffer must not grow beyond the configured max (modulo allocation
+  // rounding).
+  transportReadCallback_->getReadBuffer(&buf, &len);
+  EXPECT_LE(len, 2000);
+}
+
 TEST_F(AsyncFizzBaseTest, TestTransportReadError) {
   expectTransportReadCallback();
   startTransportReads();
@@ -478,6 +573,133 @@ TEST_F(AsyncFizzBaseTest, TestAppReadBufPause) {
   EXPECT_NE(transportReadCallback_, nullptr);
 }
 
+class MockWriteBufferCallback : public AsyncFizzBase::WriteBufferCallback {
+ public:
+  MOCK_METHOD1(onWriteBufferHigh, void(size_t));
+  MOCK_METHOD1(onWriteBufferLow, void(size_t));
+};
+
+TEST_F(AsyncFizzBaseTest, TestBufferedWriteBytes) {
+  setWriteBufferWatermarks(0, 0, nullptr);
+  EXPECT_EQ(getBufferedWriteBytes(), 0);
+
+  queueTransportWrite(
+      nullptr, IOBuf::copyBuffer("0123456789"), folly::WriteFlags::NONE);
+  EXPECT_EQ(getBufferedWriteBytes(), 10);
+
+  AsyncTransportWrapper::WriteCallback* transportWriteCallback = nullptr;
+  EXPECT_CALL(*socket_, writeChain(_, _, _))
+      .WillOnce(SaveArg<0>(&transportWriteCallback));
+  flushTransportWrites();
+  EXPECT_EQ(getBufferedWriteBytes(), 10);
+
+  ASSERT_NE(transportWriteCallback, nullptr);
+  transportWriteCallback->writeSuccess();
+  EXPECT_EQ(getBufferedWriteBytes(), 0);
+}
+
+TEST_F(AsyncFizzBaseTest, TestWriteWatermarkCallbacks) {
+  MockWriteBufferCallback bufferCallback;
+  setWriteBufferWatermarks(5, 10, &bufferCallback);
+
+  queueTransportWrite(
+      nullptr, IOBuf::copyBuffer("01234567"), folly::WriteFlags::NONE);
+
+  EXPECT_CALL(bufferCallback, onWriteBufferHigh(13));
+  queueTransportWrite(
+      nullptr, IOBuf::copyBuffer("89abc"), folly::WriteFlags::NONE);
+
+  // No second signal while the buffer stays above the watermark.
+  queueTransportWrite(nullptr, IOBuf::copyBuffer("x"), folly::WriteFlags::NONE);
+
+  AsyncTransportWrapper::WriteCallback* transportWriteCallback = nullptr;
+  EXPECT_CALL(*socket_, writeChain(_, _, _))
+      .WillOnce(SaveArg<0>(&transportWriteCallback));
+  flushTransportWrites();
+
+  EXPECT_CALL(bufferCallback, onWriteBufferLow(0));
+  ASSERT_NE(transportWriteCallback, nullptr);
+  transportWriteCallback->writeSuccess();
+  EXPECT_EQ(getBufferedWriteBytes(), 0);
+}
+
+TEST_F(AsyncFizzBaseTest, TestTrackedWriteCallbackForwarded) {
+  setWriteBufferWatermarks(0, 0, nullptr);
+  StrictMock<folly::test::MockWriteCallback> writeCallback;
+
+  AsyncTransportWrapper::WriteCallback* transportWriteCallback = nullptr;
+  EXPECT_CALL(*socket_, writeChain(_, _, _))
+      .WillOnce(SaveArg<0>(&transportWriteCallback));
+  queueTransportWrite(
+      &writeCallback, IOBuf::copyBuffer("data"), folly::WriteFlags::NONE);
+  EXPECT_EQ(getBufferedWriteBytes(), 4);
+
+  EXPECT_CALL(writeCallback, writeSuccess_());
+  ASSERT_NE(transportWriteCallback, nullptr);
+  transportWriteCallback->writeSuccess();
+  EXPECT_EQ(getBufferedWriteBytes(), 0);
+}
+
+TEST_F(AsyncFizzBaseTest, TestDeferredFlush) {
+  EventBase evb;
+  EXPECT_CALL(*socket_, getEventBase()).WillRepeatedly(Return(&evb));
+  setDeferredFlush(true);
+
+  queueTransportWrite(
+      nullptr, IOBuf::copyBuffer("write1"), folly::WriteFlags::NONE);
+  flushTransportWrites();
+  queueTransportWrite(
+      nullptr, IOBuf::copyBuffer("write2"), folly::WriteFlags::NONE);
+  flushTransportWrites();
+
+  // Nothing reaches the transport until the loop callback fires, and
+  // both flushes coalesce into one writeChain.
+  auto expected = IOBuf::copyBuffer("write1write2");
+  EXPECT_CALL(*socket_, writeChain(_, BufMatches(expected.get()), _));
+  evb.loop();
+}
+
+TEST_F(AsyncFizzBaseTest, TestAppReadBufLimit) {
+  setAppDataBufferLimit(10);
+  expectTransportReadCallback();
+  startTransportReads();
+
+  expectTransportReadCallback();
+  deliverAppData(IOBuf::copyBuffer("0123456789A"));
+  EXPECT_EQ(transportReadCallback_, nullptr);
+
+  expectTransportReadCallback();
+  EXPECT_CALL(readCallback_, isBufferMovable_()).WillRepeatedly(Return(true));
+  EXPECT_CALL(readCallback_, readBufferAvailable_(_));
+  setReadCB(&readCallback_);
+  EXPECT_NE(transportReadCallback_, nullptr);
+}
+
+TEST_F(AsyncFizzBaseTest, TestAppReadBufMeter) {
+  auto meter = std::make_shared<BufferMeter>(10);
+  setAppDataBufferMeter(meter);
+  expectTransportReadCallback();
+  startTransportReads();
+
+  // Under the shared limit buffering proceeds without pausing reads.
+  deliverAppData(IOBuf::copyBuffer("12345"));
+  EXPECT_EQ(meter->bytesBuffered(), 5);
+  EXPECT_NE(transportReadCallback_, nullptr);
+
+  expectTransportReadCallback();
+  deliverAppData(IOBuf::copyBuffer("678901"));
+  EXPECT_EQ(meter->bytesBuffered(), 11);
+  EXPECT_EQ(transportReadCallback_, nullptr);
+
+  // Draining the buffer releases the meter and resumes reads.
+  expectTransportReadCallback();
+  EXPECT_CALL(readCallback_, isBufferMovable_()).WillRepeatedly(Return(true));
+  EXPECT_CALL(readCallback_, readBufferAvailable_(_));
+  setReadCB(&readCallback_);
+  EXPECT_EQ(meter->bytesBuffered(), 0);
+  EXPECT_NE(transportReadCallback_, nullptr);
+}
+
 TEST_F(AsyncFizzBaseTest, TestWriteSuccess) {
   AsyncTransportWrapper::WriteCallback* writeCallback = this;
   writeCallback->writeSuccess();
@@ -506,6 +728,29 @@ TEST_F(AsyncFizzBaseTest, TestHandshakeTimeout) {
   timeout->timeoutExpired();
 }
 
+TEST_F(AsyncFizzBaseTest, TestWheelTimerHandshakeTimeout) {
+  EventBase evb;
+  setHandshakeTimer(&evb.timer());
+  startHandshakeTimeout(std::chrono::milliseconds(1));
+  EXPECT_EQ(evb.timer().count(), 1);
+
+  EXPECT_CALL(*this, transportError(_))
+      .WillOnce(Invoke([](const AsyncSocketException& ex) {
+        EXPECT_EQ(ex.getType(), AsyncSocketException::TIMED_OUT);
+      }));
+  evb.loop();
+  EXPECT_EQ(evb.timer().count(), 0);
+}
+
+TEST_F(AsyncFizzBaseTest, TestWheelTimerHandshakeTimeoutCancel) {
+  EventBase evb;
+  setHandshakeTimer(&evb.timer());
+  startHandshakeTimeout(std::chrono::milliseconds(1));
+  cancelHandshakeTimeout();
+  EXPECT_EQ(evb.timer().count(), 0);
+  evb.loop();
+}
+
 TEST_F(AsyncFizzBaseTest, TestAttachEventBase) {
   EventBase evb;
   expectTransportReadCallback();
@@ -0,0 +1,271 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/client/AsyncFizzClient.h>
+#include <fizz/crypto/Utils.h>
+#include <fizz/crypto/test/TestUtil.h>
+#include <fizz/protocol/DefaultCertificateVerifier.h>
+#include <fizz/server/AsyncFizzServer.h>
+#include <fizz/server/CertManager.h>
+#include <fizz/server/TicketTypes.h>
+#include <fizz/test/LocalTransport.h>
+
+#include <folly/init/Init.h>
+
+#include <algorithm>
+#include <chrono>
+
+/**
+ * End-to-end handshake benchmark harness.
+ *
+ * Drives batches of concurrent handshakes between AsyncFizzClient and
+ * AsyncFizzServer over an in-memory LocalTransport pair on a single event
+ * base, so the reported handshakes/sec is per core. Latency is measured
+ * per handshake from connect() to both sides reporting success, with
+ * batches of --concurrency handshakes in flight at once.
+ */
+
+DEFINE_int32(handshakes, 1000, "Total number of handshakes to run");
+DEFINE_int32(concurrency, 10, "Handshakes in flight at once");
+DEFINE_string(cipher, "aesgcm128", "Cipher: aesgcm128, aesgcm256 or chacha");
+DEFINE_string(mode, "full", "Resumption mode: full, psk or zero_rtt");
+DEFINE_string(cert, "p256", "Server certificate type: rsa or p256");
+DEFINE_bool(client_auth, false, "Require a client certificate");
+
+using namespace fizz;
+using namespace fizz::client;
+using namespace fizz::server;
+using namespace fizz::test;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+CipherSuite getCipherSuite() {
+  if (FLAGS_cipher == "aesgcm128") {
+    return CipherSuite::TLS_AES_128_GCM_SHA256;
+  } else if (FLAGS_cipher == "aesgcm256") {
+    return CipherSuite::TLS_AES_256_GCM_SHA384;
+  } else if (FLAGS_cipher == "chacha") {
+    return CipherSuite::TLS_CHACHA20_POLY1305_SHA256;
+  }
+  LOG(FATAL) << "unknown cipher: " << FLAGS_cipher;
+}
+
+std::shared_ptr<FizzClientContext> makeClientContext() {
+  auto context = std::make_shared<FizzClientContext>();
+  context->setSupportedCiphers({getCipherSuite()});
+  if (FLAGS_mode != "full") {
+    context->setPskCache(std::make_shared<BasicPskCache>());
+  }
+  if (FLAGS_mode == "zero_rtt") {
+    context->setSendEarlyData(true);
+  }
+  if (FLAGS_client_auth) {
+    std::vector<folly::ssl::X509UniquePtr> certs;
+    certs.emplace_back(getCert(kClientAuthClientCert));
+    context->setClientCertificate(std::make_shared<SelfCertImpl<KeyType::RSA>>(
+        getPrivateKey(kClientAuthClientKey), std::move(certs)));
+  }
+  return context;
+}
+
+std::shared_ptr<FizzServerContext> makeServerContext() {
+  auto context = std::make_shared<FizzServerContext>();
+  context->setSupportedCiphers({{getCipherSuite()}});
+
+  auto certManager = std::make_unique<CertManager>();
+  if (FLAGS_cert == "rsa") {
+    std::vector<folly::ssl::X509UniquePtr> certs;
+    certs.emplace_back(getCert(kRSACertificate));
+    certManager->addCert(
+        std::make_shared<SelfCertImpl<KeyType::RSA>>(
+            getPrivateKey(kRSAKey), std::move(certs)),
+        true);
+  } else if (FLAGS_cert == "p256") {
+    std::vector<folly::ssl::X509UniquePtr> certs;
+    certs.emplace_back(getCert(kP256Certificate));
+    certManager->addCert(
+        std::make_shared<SelfCertImpl<KeyType::P256>>(
+            getPrivateKey(kP256Key), std::move(certs)),
+        true);
+  } else {
+    LOG(FATAL) << "unknown cert type: " << FLAGS_cert;
+  }
+  context->setCertManager(std::move(certManager));
+
+  auto ticketCipher = std::make_shared<AES128TicketCipher>();
+  auto ticketSeed = RandomGenerator<32>().generateRandom();
+  ticketCipher->setTicketSecrets({{folly::range(ticketSeed)}});
+  ticketCipher->setTicketValidity(std::chrono::seconds(3600));
+  context->setTicketCipher(std::move(ticketCipher));
+
+  if (FLAGS_mode == "zero_rtt") {
+    context->setEarlyDataSettings(
+        true,
+        {std::chrono::seconds(-60), std::chrono::seconds(60)},
+        std::make_shared<AllowAllReplayReplayCache>());
+  }
+
+  if (FLAGS_client_auth) {
+    folly::ssl::X509StoreUniquePtr store(X509_STORE_new());
+    CHECK_EQ(
+        X509_STORE_add_cert(store.get(), getCert(kClientAuthCACert).get()), 1);
+    context->setClientCertVerifier(
+        std::make_shared<const DefaultCertificateVerifier>(
+            VerificationContext::Server, std::move(store)));
+    context->setClientAuthMode(ClientAuthMode::Required);
+  }
+  return context;
+}
+
+/**
+ * One client/server handshake over a LocalTransport pair. Reports its
+ * latency once both sides have completed.
+ */
+class HandshakePair : public AsyncFizzClient::HandshakeCallback,
+                      public AsyncFizzServer::HandshakeCallback {
+ public:
+  HandshakePair(
+      folly::EventBase* evb,
+      std::shared_ptr<FizzClientContext> clientContext,
+      std::shared_ptr<FizzServerContext> serverContext,
+      folly::Function<void(Clock::duration)> onComplete)
+      : onComplete_(std::move(onComplete)) {
+    auto clientTransport = LocalTransport::UniquePtr(new LocalTransport());
+    auto serverTransport = LocalTransport::UniquePtr(new LocalTransport());
+    clientTransport->attachEventBase(evb);
+    serverTransport->attachEventBase(evb);
+    clientTransport->setPeer(serverTransport.get());
+    serverTransport->setPeer(clientTransport.get());
+    client_.reset(new AsyncFizzClient(
+        std::move(clientTransport), std::move(clientContext)));
+    server_.reset(new AsyncFizzServer(
+        std::move(serverTransport), std::move(serverContext)));
+  }
+
+  void start() {
+    start_ = Clock::now();
+    client_->connect(
+        this, nullptr, folly::none, std::string("fizz-benchmark"));
+    server_->accept(this);
+  }
+
+  void fizzHandshakeSuccess(AsyncFizzClient*) noexcept override {
+    clientDone_ = true;
+    maybeFinish();
+  }
+
+  void fizzHandshakeError(
+      AsyncFizzClient*,
+      folly::exception_wrapper ex) noexcept override {
+    LOG(FATAL) << "client handshake error: " << ex.what();
+  }
+
+  void fizzHandshakeSuccess(AsyncFizzServer*) noexcept override {
+    serverDone_ = true;
+    maybeFinish();
+  }
+
+  void fizzHandshakeError(
+      AsyncFizzServer*,
+      folly::exception_wrapper ex) noexcept override {
+    LOG(FATAL) << "server handshake error: " << ex.what();
+  }
+
+  void fizzHandshakeAttemptFallback(
+      std::unique_ptr<folly::IOBuf> /*clientHello*/) override {
+    LOG(FATAL) << "unexpected fallback";
+  }
+
+ private:
+  void maybeFinish() {
+    if (clientDone_ && serverDone_) {
+      onComplete_(Clock::now() - start_);
+    }
+  }
+
+  AsyncFizzClient::UniquePtr client_;
+  AsyncFizzServer::UniquePtr server_;
+  folly::Function<void(Clock::duration)> onComplete_;
+  Clock::time_point start_;
+  bool clientDone_{false};
+  bool serverDone_{false};
+};
+
+double percentileUs(const std::vector<double>& sorted, double percentile) {
+  auto index = static_cast<size_t>(percentile / 100.0 * (sorted.size() - 1));
+  return sorted[index];
+}
+} // namespace
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  CryptoUtils::init();
+
+  auto clientContext = makeClientContext();
+  auto serverContext = makeServerContext();
+  folly::EventBase evb;
+
+  std::vector<double> latenciesUs;
+  latenciesUs.reserve(FLAGS_handshakes);
+  auto recordLatency = [&latenciesUs](Clock::duration elapsed) {
+    latenciesUs.push_back(
+        std::chrono::duration_cast<std::chrono::microseconds>(elapsed)
+            .count());
+  };
+
+  // Warmup handshake; for psk and zero_rtt modes this also populates the
+  // client's psk cache so that the measured handshakes resume.
+  {
+    HandshakePair warmup(
+        &evb, clientContext, serverContext, [](Clock::duration) {});
+    warmup.start();
+    evb.loop();
+  }
+
+  auto wallStart = Clock::now();
+  int launched = 0;
+  while (launched < FLAGS_handshakes) {
+    auto batch = std::min(
+        static_cast<int>(FLAGS_concurrency), FLAGS_handshakes - launched);
+    std::vector<std::unique_ptr<HandshakePair>> pairs;
+    pairs.reserve(batch);
+    for (int i = 0; i < batch; i++) {
+      pairs.push_back(std::make_unique<HandshakePair>(
+          &evb, clientContext, serverContext, recordLatency));
+    }
+    for (auto& pair : pairs) {
+      pair->start();
+    }
+    evb.loop();
+    launched += batch;
+  }
+  auto wallSeconds = std::chrono::duration_cast<std::chrono::duration<double>>(
+                         Clock::now() - wallStart)
+                         .count();
+
+  CHECK_EQ(latenciesUs.size(), static_cast<size_t>(FLAGS_handshakes));
+  std::sort(latenciesUs.begin(), latenciesUs.end());
+
+  printf(
+      "cipher=%s mode=%s cert=%s client_auth=%d concurrency=%d\n",
+      FLAGS_cipher.c_str(),
+      FLAGS_mode.c_str(),
+      FLAGS_cert.c_str(),
+      FLAGS_client_auth,
+      static_cast<int>(FLAGS_concurrency));
+  printf("handshakes:     %d\n", static_cast<int>(FLAGS_handshakes));
+  printf(
+      "handshakes/sec: %.1f (single core)\n", FLAGS_handshakes / wallSeconds);
+  printf("latency p50:    %.1f us\n", percentileUs(latenciesUs, 50));
+  printf("latency p90:    %.1f us\n", percentileUs(latenciesUs, 90));
+  printf("latency p99:    %.1f us\n", percentileUs(latenciesUs, 99));
+  printf("latency max:    %.1f us\n", latenciesUs.back());
+  return 0;
+}
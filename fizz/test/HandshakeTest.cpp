@@ -415,6 +415,33 @@ TEST_F(HandshakeTest, BasicHandshakeTrickle) {
   sendAppData();
 }
 
+TEST_F(HandshakeTest, KeyUpdate) {
+  expectSuccess();
+  doHandshake();
+  verifyParameters();
+  sendAppData();
+
+  client_->updateTrafficKeys();
+  evb_.loop();
+
+  // Both directions still work after both sides have rotated keys.
+  sendAppData();
+}
+
+TEST_F(HandshakeTest, AutomaticRekey) {
+  // Every app data record written exceeds the limit and triggers a rekey.
+  clientContext_->setRekeyAfterWriting(1, 0);
+  serverContext_->setRekeyAfterWriting(1, 0);
+  expectSuccess();
+  doHandshake();
+  verifyParameters();
+  sendAppData();
+  evb_.loop();
+  sendAppData();
+  evb_.loop();
+  sendAppData();
+}
+
 TEST_F(HandshakeTest, P256) {
   clientContext_->setSupportedGroups(
       {NamedGroup::x25519, NamedGroup::secp256r1});
@@ -0,0 +1,71 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/test/MallocCounter.h>
+
+#include <folly/Portability.h>
+
+#include <cstddef>
+
+#if defined(__GLIBC__) && !FOLLY_SANITIZE
+#define FIZZ_MALLOC_COUNTER_SUPPORTED 1
+#else
+#define FIZZ_MALLOC_COUNTER_SUPPORTED 0
+#endif
+
+namespace {
+thread_local uint64_t mallocCount{0};
+} // namespace
+
+#if FIZZ_MALLOC_COUNTER_SUPPORTED
+
+// Interpose the allocation entry points with counting wrappers. All of
+// them (including free) forward to the glibc implementations so that the
+// binary uses one consistent allocator even if another malloc library is
+// linked in.
+extern "C" {
+
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void __libc_free(void* ptr);
+
+void* malloc(size_t size) {
+  ++mallocCount;
+  return __libc_malloc(size);
+}
+
+void* calloc(size_t n, size_t size) {
+  ++mallocCount;
+  return __libc_calloc(n, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+  ++mallocCount;
+  return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) {
+  __libc_free(ptr);
+}
+} // extern "C"
+
+#endif
+
+namespace fizz {
+namespace test {
+
+bool mallocCountingSupported() {
+  return FIZZ_MALLOC_COUNTER_SUPPORTED;
+}
+
+uint64_t getMallocCount() {
+  return mallocCount;
+}
+} // namespace test
+} // namespace fizz
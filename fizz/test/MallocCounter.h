@@ -0,0 +1,54 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace fizz {
+namespace test {
+
+/**
+ * Malloc-count shim for allocation regression tests.
+ *
+ * When supported (glibc, no sanitizers), linking MallocCounter.cpp into a
+ * test binary interposes malloc/calloc/realloc with counting wrappers that
+ * forward to the glibc allocator, so a test can pin the number of heap
+ * allocations a code path performs. The count is per thread and only
+ * meaningful for work done on the counting thread.
+ */
+
+/**
+ * Whether allocation counting is active in this binary. Tests should
+ * early-out when this returns false (non-glibc platforms, sanitized
+ * builds).
+ */
+bool mallocCountingSupported();
+
+/**
+ * Number of allocations made on this thread since it started.
+ */
+uint64_t getMallocCount();
+
+/**
+ * Snapshots the allocation count at construction; count() returns the
+ * number of allocations on this thread since then.
+ */
+class MallocCounterGuard {
+ public:
+  MallocCounterGuard() : start_(getMallocCount()) {}
+
+  uint64_t count() const {
+    return getMallocCount() - start_;
+  }
+
+ private:
+  uint64_t start_;
+};
+} // namespace test
+} // namespace fizz
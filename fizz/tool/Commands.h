@@ -18,12 +18,18 @@ namespace tool {
 
 int fizzClientCommand(const std::vector<std::string>& args);
 int fizzServerCommand(const std::vector<std::string>& args);
+int fizzCertDictCommand(const std::vector<std::string>& args);
+int fizzLoadCommand(const std::vector<std::string>& args);
+int fizzBenchCommand(const std::vector<std::string>& args);
 
 const std::map<std::string, std::function<int(const std::vector<std::string>&)>>
     fizzUtilities = {{"client", &fizzClientCommand},
                      {"s_client", &fizzClientCommand},
                      {"server", &fizzServerCommand},
-                     {"s_server", &fizzServerCommand}};
+                     {"s_server", &fizzServerCommand},
+                     {"certdict", &fizzCertDictCommand},
+                     {"load", &fizzLoadCommand},
+                     {"bench", &fizzBenchCommand}};
 
 } // namespace tool
 } // namespace fizz
@@ -0,0 +1,152 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/tool/FizzCommandCommon.h>
+
+#ifdef FIZZ_TOOL_ENABLE_ZSTD
+#include <fizz/protocol/Certificate.h>
+#include <folly/FileUtil.h>
+#include <folly/ssl/OpenSSLCertUtils.h>
+#include <zdict.h>
+
+#include <dirent.h>
+#endif
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace folly;
+
+namespace fizz {
+namespace tool {
+
+namespace {
+
+void printUsage() {
+  // clang-format off
+  std::cerr
+    << "Usage: certdict args\n"
+    << "\n"
+    << "Trains a zstd dictionary over a directory of PEM cert chains. The\n"
+    << "dictionary can then be loaded into ZstdCertificateCompressor and\n"
+    << "ZstdCertificateDecompressor for dictionary-based certificate\n"
+    << "compression; both peers must use the same dictionary.\n"
+    << "\n"
+    << "Supported arguments:\n"
+    << " -dir path                (directory of PEM cert chain files. Required)\n"
+    << " -out file                (output dictionary file. Default: fizz_cert.dict)\n"
+    << " -maxsize bytes           (maximum dictionary size. Default: 4096)\n";
+  // clang-format on
+}
+
+} // namespace
+
+int fizzCertDictCommand(const std::vector<std::string>& args) {
+  std::string dirPath;
+  std::string outPath = "fizz_cert.dict";
+  size_t maxSize = 4096;
+
+  // clang-format off
+  FizzArgHandlerMap handlers = {
+    {"-dir", {true, [&dirPath](const std::string& arg) { dirPath = arg; }}},
+    {"-out", {true, [&outPath](const std::string& arg) { outPath = arg; }}},
+    {"-maxsize", {true, [&maxSize](const std::string& arg) {
+        maxSize = folly::to<size_t>(arg);
+    }}}
+  };
+  // clang-format on
+
+  try {
+    if (parseArguments(args, handlers, printUsage)) {
+      // Parsing failed, return
+      return 1;
+    }
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Error: " << e.what();
+    return 1;
+  }
+
+  if (dirPath.empty()) {
+    LOG(ERROR) << "-dir is required";
+    return 1;
+  }
+
+#ifdef FIZZ_TOOL_ENABLE_ZSTD
+  // Collect the handshake encoding of each chain's CertificateMsg, as
+  // that is exactly what the compressor sees.
+  std::string samples;
+  std::vector<size_t> sampleSizes;
+  DIR* dir = opendir(dirPath.c_str());
+  if (!dir) {
+    LOG(ERROR) << "Failed to open directory " << dirPath;
+    return 1;
+  }
+  while (auto* entry = readdir(dir)) {
+    std::string name(entry->d_name);
+    if (name == "." || name == "..") {
+      continue;
+    }
+    auto filePath = dirPath + "/" + name;
+    std::string pemData;
+    if (!readFile(filePath.c_str(), pemData)) {
+      LOG(WARNING) << "Failed to read " << filePath << ", skipping.";
+      continue;
+    }
+    try {
+      auto certs = folly::ssl::OpenSSLCertUtils::readCertsFromBuffer(
+          StringPiece(pemData));
+      auto msg = CertUtils::getCertMessage(certs, nullptr);
+      auto encoded = encode(msg);
+      auto encodedRange = encoded->coalesce();
+      samples.append(
+          reinterpret_cast<const char*>(encodedRange.data()),
+          encodedRange.size());
+      sampleSizes.push_back(encodedRange.size());
+    } catch (const std::exception& e) {
+      LOG(WARNING) << "Failed to parse " << filePath << ": " << e.what()
+                   << ", skipping.";
+    }
+  }
+  closedir(dir);
+
+  if (sampleSizes.empty()) {
+    LOG(ERROR) << "No cert chains found in " << dirPath;
+    return 1;
+  }
+
+  std::string dict(maxSize, '\0');
+  auto status = ZDICT_trainFromBuffer(
+      &dict[0],
+      dict.size(),
+      samples.data(),
+      sampleSizes.data(),
+      sampleSizes.size());
+  if (ZDICT_isError(status)) {
+    LOG(ERROR) << "Failed to train dictionary: "
+               << ZDICT_getErrorName(status);
+    return 1;
+  }
+  dict.resize(status);
+
+  if (!writeFile(dict, outPath.c_str())) {
+    LOG(ERROR) << "Failed to write dictionary to " << outPath;
+    return 1;
+  }
+
+  LOG(INFO) << "Trained " << dict.size() << " byte dictionary over "
+            << sampleSizes.size() << " cert chains, written to " << outPath;
+  return 0;
+#else
+  LOG(ERROR) << "Fizz was not built with zstd support.";
+  return 1;
+#endif
+}
+
+} // namespace tool
+} // namespace fizz
@@ -56,7 +56,8 @@ void printUsage() {
     << " -quiet                   (hide informational logging. Default: false)\n"
     << " -v verbosity             (set verbose log level for VLOG macros. Default: 0)\n"
     << " -vmodule m1=N,...        (set per-module verbose log level for VLOG macros. Default: none)\n"
-    << " -httpproxy host:port     (set an HTTP proxy to use. Default: none)\n";
+    << " -httpproxy host:port     (set an HTTP proxy to use. Default: none)\n"
+    << " -keylog file             (append NSS key log lines for the session secrets to file. Default: none)\n";
   // clang-format on
 }
 
@@ -73,13 +74,15 @@ class Connection : public AsyncSocket::ConnectCallback,
       Optional<std::string> sni,
       std::shared_ptr<const CertificateVerifier> verifier,
       bool willResume,
-      std::string proxyTarget)
+      std::string proxyTarget,
+      std::shared_ptr<KeyLogWriter> keyLogger)
       : evb_(evb),
         clientContext_(clientContext),
         sni_(sni),
         verifier_(std::move(verifier)),
         willResume_(willResume),
-        proxyTarget_(proxyTarget) {}
+        proxyTarget_(proxyTarget),
+        keyLogger_(std::move(keyLogger)) {}
 
   void connect(const SocketAddress& addr) {
     sock_ = AsyncSocket::UniquePtr(new AsyncSocket(evb_));
@@ -291,6 +294,9 @@ class Connection : public AsyncSocket::ConnectCallback,
               << secretStr(resumptionMasterSecret_);
     LOG(INFO) << "    Client Traffic: " << secretStr(clientAppTrafficSecret_);
     LOG(INFO) << "    Server Traffic: " << secretStr(serverAppTrafficSecret_);
+    if (keyLogger_) {
+      writeKeyLog(*keyLogger_, state.clientRandom());
+    }
   }
 
   EventBase* evb_;
@@ -303,6 +309,7 @@ class Connection : public AsyncSocket::ConnectCallback,
   std::array<char, 8192> readBuf_;
   std::string proxyTarget_;
   std::unique_ptr<IOBuf> proxyResponseBuffer_;
+  std::shared_ptr<KeyLogWriter> keyLogger_;
 };
 
 class ResumptionPskCache : public BasicPskCache {
@@ -341,6 +348,7 @@ int fizzClientCommand(const std::vector<std::string>& args) {
   bool early = false;
   std::string proxyHost = "";
   uint16_t proxyPort = 0;
+  std::string keyLogFile;
   std::vector<CipherSuite> ciphers {
     CipherSuite::TLS_AES_128_GCM_SHA256,
     CipherSuite::TLS_AES_256_GCM_SHA384,
@@ -386,6 +394,8 @@ int fizzClientCommand(const std::vector<std::string>& args) {
     {"-quiet", {false, [](const std::string&) {
         FLAGS_minloglevel = google::GLOG_ERROR;
     }}},
+    {"-keylog", {true, [&keyLogFile](const std::string& arg) {
+        keyLogFile = arg; }}},
     {"-httpproxy", {true, [&proxyHost, &proxyPort] (const std::string& arg) {
         std::tie(proxyHost, proxyPort) = hostPortFromString(arg);
     }}},
@@ -503,9 +513,14 @@ int fizzClientCommand(const std::vector<std::string>& args) {
         ? std::string()
         : folly::to<std::string>(host, ":", port);
     SocketAddress addr(connectHost, connectPort, true);
-    Connection conn(&evb, clientContext, sni, verifier, reconnect, proxiedHost);
+    std::shared_ptr<KeyLogWriter> keyLogger;
+    if (!keyLogFile.empty()) {
+      keyLogger = std::make_shared<KeyLogWriter>(keyLogFile);
+    }
+    Connection conn(
+        &evb, clientContext, sni, verifier, reconnect, proxiedHost, keyLogger);
     Connection resumptionConn(
-        &evb, clientContext, sni, verifier, false, proxiedHost);
+        &evb, clientContext, sni, verifier, false, proxiedHost, keyLogger);
     Connection* inputTarget = &conn;
     if (reconnect) {
       auto pskCache = std::make_shared<ResumptionPskCache>(
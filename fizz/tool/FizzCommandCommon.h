@@ -9,6 +9,7 @@
 #pragma once
 
 #include <fizz/protocol/AsyncFizzBase.h>
+#include <fizz/util/KeyLogWriter.h>
 #include <fizz/util/Parse.h>
 #include <folly/io/IOBuf.h>
 #include <folly/io/async/EventBase.h>
@@ -185,6 +186,33 @@ class SecretCollector : public AsyncFizzBase::SecretCallback {
     return folly::hexlify(*secret);
   }
 
+  // Appends all collected secrets to an NSS key log for offline decryption
+  // of captured traffic.
+  void writeKeyLog(KeyLogWriter& writer, const Random& clientRandom) const {
+    auto writeOne = [&](const OptionalSecret& secret,
+                        KeyLogWriter::Label label) {
+      if (secret) {
+        writer.write(clientRandom, label, folly::range(*secret));
+      }
+    };
+    writeOne(
+        clientEarlyTrafficSecret_,
+        KeyLogWriter::Label::CLIENT_EARLY_TRAFFIC_SECRET);
+    writeOne(
+        clientHandshakeTrafficSecret_,
+        KeyLogWriter::Label::CLIENT_HANDSHAKE_TRAFFIC_SECRET);
+    writeOne(
+        serverHandshakeTrafficSecret_,
+        KeyLogWriter::Label::SERVER_HANDSHAKE_TRAFFIC_SECRET);
+    writeOne(
+        clientAppTrafficSecret_, KeyLogWriter::Label::CLIENT_TRAFFIC_SECRET_0);
+    writeOne(
+        serverAppTrafficSecret_, KeyLogWriter::Label::SERVER_TRAFFIC_SECRET_0);
+    writeOne(
+        earlyExporterSecret_, KeyLogWriter::Label::EARLY_EXPORTER_SECRET);
+    writeOne(exporterMasterSecret_, KeyLogWriter::Label::EXPORTER_SECRET);
+  }
+
   OptionalSecret externalPskBinder_;
   OptionalSecret resumptionPskBinder_;
   OptionalSecret earlyExporterSecret_;
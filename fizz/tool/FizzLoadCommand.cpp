@@ -0,0 +1,482 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/client/AsyncFizzClient.h>
+#include <fizz/tool/FizzCommandCommon.h>
+#include <fizz/util/Parse.h>
+#include <folly/FileUtil.h>
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace fizz::client;
+using namespace folly;
+
+namespace fizz {
+namespace tool {
+namespace {
+
+void printLoadUsage() {
+  // clang-format off
+  std::cerr
+    << "Usage: load args\n"
+    << "\n"
+    << "Supported arguments:\n"
+    << " -connect host:port   (address to connect to. Default:\n"
+    << "                       localhost:4433)\n"
+    << " -threads n           (number of event base threads. Default: 1)\n"
+    << " -rate n              (target handshakes/sec across all threads;\n"
+    << "                       0 runs as fast as -maxout allows. Default: 0)\n"
+    << " -duration secs       (how long to run. Default: 10)\n"
+    << " -maxout n            (max outstanding handshakes per thread.\n"
+    << "                       Default: 100)\n"
+    << " -psk_ratio f         (fraction of handshakes in [0,1] attempting\n"
+    << "                       resumption. Default: 0)\n"
+    << " -early               (send early data on resumption. Default: false)\n"
+    << " -verify              (verify the server cert. Default: false)\n"
+    << " -cert cert           (PEM client cert for client auth)\n"
+    << " -key key             (PEM private key for client cert)\n"
+    << " -pass password       (private key password. Default: none)\n"
+    << " -capath directory    (directory of CA certs for verification)\n"
+    << " -cafile file         (bundle of CA certs for verification)\n"
+    << " -servername name     (SNI to send. Default: host)\n"
+    << " -ciphers c1:...      (colon-separated cipher preference list)\n"
+    << " -quiet               (hide informational logging. Default: false)\n";
+  // clang-format on
+}
+
+using Clock = std::chrono::steady_clock;
+
+struct LoadConfig {
+  SocketAddress addr;
+  std::string sni;
+  double pskRatio{0.0};
+  bool early{false};
+  uint32_t maxOutstanding{100};
+  std::vector<CipherSuite> ciphers;
+  std::shared_ptr<SelfCert> clientCert;
+  std::shared_ptr<const CertificateVerifier> verifier;
+};
+
+class Worker;
+
+/**
+ * One handshake attempt. Owns itself; reports its result to the worker
+ * and schedules its own destruction when done.
+ */
+class LoadConnection : public AsyncSocket::ConnectCallback,
+                       public AsyncFizzClient::HandshakeCallback {
+ public:
+  LoadConnection(
+      Worker* worker,
+      EventBase* evb,
+      std::shared_ptr<const FizzClientContext> context,
+      const LoadConfig& config,
+      bool resume)
+      : worker_(worker),
+        evb_(evb),
+        context_(std::move(context)),
+        config_(config),
+        resume_(resume) {}
+
+  void start() {
+    sock_ = AsyncSocket::UniquePtr(new AsyncSocket(evb_));
+    sock_->connect(this, config_.addr);
+  }
+
+  void connectSuccess() noexcept override {
+    start_ = Clock::now();
+    transport_ = AsyncFizzClient::UniquePtr(
+        new AsyncFizzClient(std::move(sock_), context_));
+    // The psk identity doubles as the cache key: resuming connections
+    // look the psk up and refresh it from new session tickets.
+    transport_->connect(
+        this,
+        config_.verifier,
+        config_.sni,
+        resume_ ? Optional<std::string>(config_.sni) : folly::none);
+  }
+
+  void connectErr(const AsyncSocketException& ex) noexcept override {
+    fail(ex.what());
+  }
+
+  void fizzHandshakeSuccess(AsyncFizzClient* /*client*/) noexcept override;
+
+  void fizzHandshakeError(
+      AsyncFizzClient* /*client*/,
+      exception_wrapper ex) noexcept override {
+    fail(ex.what().toStdString());
+  }
+
+ private:
+  void fail(const std::string& msg);
+
+  void destroyLater() {
+    evb_->runInLoop([this] { delete this; }, true /* thisIteration */);
+  }
+
+  Worker* worker_;
+  EventBase* evb_;
+  std::shared_ptr<const FizzClientContext> context_;
+  const LoadConfig& config_;
+  bool resume_;
+  Clock::time_point start_;
+  AsyncSocket::UniquePtr sock_;
+  AsyncFizzClient::UniquePtr transport_;
+};
+
+/**
+ * One event base thread launching connections at its share of the target
+ * rate. Each worker has its own client context and psk cache so no state
+ * is shared across threads; results are merged after the workers join.
+ */
+class Worker : private AsyncTimeout {
+ public:
+  Worker(const LoadConfig& config, double rate)
+      : config_(config), rate_(rate) {}
+
+  void start() {
+    thread_ = std::thread([this] {
+      attachEventBase(&evb_);
+      context_ = makeContext();
+      start_ = Clock::now();
+      scheduleTimeout(1);
+      evb_.loopForever();
+    });
+  }
+
+  void stop() {
+    evb_.terminateLoopSoon();
+  }
+
+  void join() {
+    thread_.join();
+  }
+
+  void connectionDone(Clock::duration latency) {
+    outstanding_--;
+    successes_++;
+    latenciesUs_.push_back(
+        std::chrono::duration_cast<std::chrono::microseconds>(latency)
+            .count());
+  }
+
+  void connectionFailed() {
+    outstanding_--;
+    failures_++;
+  }
+
+  uint64_t successes() const {
+    return successes_;
+  }
+
+  uint64_t failures() const {
+    return failures_;
+  }
+
+  const std::vector<uint64_t>& latenciesUs() const {
+    return latenciesUs_;
+  }
+
+ private:
+  std::shared_ptr<FizzClientContext> makeContext() {
+    auto context = std::make_shared<FizzClientContext>();
+    if (!config_.ciphers.empty()) {
+      context->setSupportedCiphers(config_.ciphers);
+    }
+    context->setSupportedVersions(
+        {ProtocolVersion::tls_1_3, ProtocolVersion::tls_1_3_28});
+    context->setPskCache(std::make_shared<BasicPskCache>());
+    context->setSendEarlyData(config_.early);
+    if (config_.clientCert) {
+      context->setClientCertificate(config_.clientCert);
+    }
+    return context;
+  }
+
+  void timeoutExpired() noexcept override {
+    auto elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(
+                       Clock::now() - start_)
+                       .count();
+    // How many connections should have been launched by now to stay on
+    // schedule; unlimited rate just keeps the outstanding window full.
+    uint64_t due = rate_ == 0
+        ? launched_ + config_.maxOutstanding
+        : static_cast<uint64_t>(rate_ * elapsed);
+    while (launched_ < due && outstanding_ < config_.maxOutstanding) {
+      launchOne();
+    }
+    scheduleTimeout(5);
+  }
+
+  void launchOne() {
+    bool resume = config_.pskRatio > 0.0 &&
+        std::uniform_real_distribution<double>(0.0, 1.0)(rng_) <
+            config_.pskRatio;
+    auto conn = new LoadConnection(this, &evb_, context_, config_, resume);
+    launched_++;
+    outstanding_++;
+    conn->start();
+  }
+
+  const LoadConfig& config_;
+  double rate_;
+  EventBase evb_;
+  std::thread thread_;
+  std::shared_ptr<FizzClientContext> context_;
+  std::mt19937 rng_{std::random_device{}()};
+  Clock::time_point start_;
+  uint64_t launched_{0};
+  uint64_t outstanding_{0};
+  uint64_t successes_{0};
+  uint64_t failures_{0};
+  std::vector<uint64_t> latenciesUs_;
+};
+
+void LoadConnection::fizzHandshakeSuccess(
+    AsyncFizzClient* /*client*/) noexcept {
+  worker_->connectionDone(Clock::now() - start_);
+  destroyLater();
+}
+
+void LoadConnection::fail(const std::string& msg) {
+  VLOG(1) << "handshake failed: " << msg;
+  worker_->connectionFailed();
+  destroyLater();
+}
+
+uint64_t percentileUs(const std::vector<uint64_t>& sorted, double percentile) {
+  auto index = static_cast<size_t>(percentile / 100.0 * (sorted.size() - 1));
+  return sorted[index];
+}
+
+void printHistogram(const std::vector<uint64_t>& sortedUs) {
+  // Exponential latency buckets, in milliseconds.
+  static const std::vector<uint64_t> kBucketsUs{
+      1000, 2000, 4000, 8000, 16000, 32000, 64000, 128000};
+  size_t start = 0;
+  for (size_t b = 0; b <= kBucketsUs.size(); b++) {
+    auto end = b < kBucketsUs.size()
+        ? std::lower_bound(
+              sortedUs.begin() + start, sortedUs.end(), kBucketsUs[b]) -
+            sortedUs.begin()
+        : sortedUs.size();
+    auto count = end - start;
+    if (b < kBucketsUs.size()) {
+      printf("  < %3lu ms: ", static_cast<unsigned long>(kBucketsUs[b] / 1000));
+    } else {
+      printf("  >=128 ms: ");
+    }
+    printf(
+        "%8lu (%5.1f%%)\n",
+        static_cast<unsigned long>(count),
+        100.0 * count / sortedUs.size());
+    start = end;
+  }
+}
+
+double cpuSeconds() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  auto toSeconds = [](const struct timeval& tv) {
+    return tv.tv_sec + tv.tv_usec / 1e6;
+  };
+  return toSeconds(usage.ru_utime) + toSeconds(usage.ru_stime);
+}
+
+} // namespace
+
+int fizzLoadCommand(const std::vector<std::string>& args) {
+  std::string host = "localhost";
+  uint16_t port = 4433;
+  uint32_t threads = 1;
+  double rate = 0;
+  uint32_t duration = 10;
+  std::string customSNI;
+  std::string certPath;
+  std::string keyPath;
+  std::string keyPass;
+  std::string caPath;
+  std::string caFile;
+  bool verify = false;
+  LoadConfig config;
+
+  // clang-format off
+  FizzArgHandlerMap handlers = {
+    {"-connect", {true, [&host, &port](const std::string& arg) {
+        std::tie(host, port) = hostPortFromString(arg);
+    }}},
+    {"-threads", {true, [&threads](const std::string& arg) {
+        threads = folly::to<uint32_t>(arg);
+    }}},
+    {"-rate", {true, [&rate](const std::string& arg) {
+        rate = folly::to<double>(arg);
+    }}},
+    {"-duration", {true, [&duration](const std::string& arg) {
+        duration = folly::to<uint32_t>(arg);
+    }}},
+    {"-maxout", {true, [&config](const std::string& arg) {
+        config.maxOutstanding = folly::to<uint32_t>(arg);
+    }}},
+    {"-psk_ratio", {true, [&config](const std::string& arg) {
+        config.pskRatio = folly::to<double>(arg);
+    }}},
+    {"-early", {false, [&config](const std::string&) {
+        config.early = true;
+    }}},
+    {"-verify", {false, [&verify](const std::string&) { verify = true; }}},
+    {"-cert", {true, [&certPath](const std::string& arg) { certPath = arg; }}},
+    {"-key", {true, [&keyPath](const std::string& arg) { keyPath = arg; }}},
+    {"-pass", {true, [&keyPass](const std::string& arg) { keyPass = arg; }}},
+    {"-capath", {true, [&caPath](const std::string& arg) { caPath = arg; }}},
+    {"-cafile", {true, [&caFile](const std::string& arg) { caFile = arg; }}},
+    {"-servername", {true, [&customSNI](const std::string& arg) {
+        customSNI = arg;
+    }}},
+    {"-ciphers", {true, [&config](const std::string& arg) {
+        config.ciphers = splitParse<CipherSuite>(arg);
+    }}},
+    {"-quiet", {false, [](const std::string&) {
+        FLAGS_minloglevel = google::GLOG_ERROR;
+    }}}
+  };
+  // clang-format on
+
+  try {
+    if (parseArguments(args, handlers, printLoadUsage)) {
+      return 1;
+    }
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Error: " << e.what();
+    return 1;
+  }
+
+  if (certPath.empty() != keyPath.empty()) {
+    LOG(ERROR) << "-cert and -key are both required when specified";
+    return 1;
+  }
+  if (config.pskRatio < 0.0 || config.pskRatio > 1.0) {
+    LOG(ERROR) << "-psk_ratio must be in [0, 1]";
+    return 1;
+  }
+  if (threads == 0) {
+    LOG(ERROR) << "-threads must be positive";
+    return 1;
+  }
+
+  if (verify) {
+    folly::ssl::X509StoreUniquePtr storePtr;
+    if (!caPath.empty() || !caFile.empty()) {
+      storePtr.reset(X509_STORE_new());
+      auto caFilePtr = caFile.empty() ? nullptr : caFile.c_str();
+      auto caPathPtr = caPath.empty() ? nullptr : caPath.c_str();
+      if (X509_STORE_load_locations(storePtr.get(), caFilePtr, caPathPtr) ==
+          0) {
+        LOG(ERROR) << "Failed to load CA certificates";
+        return 1;
+      }
+    }
+    config.verifier = std::make_shared<const DefaultCertificateVerifier>(
+        VerificationContext::Client, std::move(storePtr));
+  }
+
+  if (!certPath.empty()) {
+    std::string certData;
+    std::string keyData;
+    if (!readFile(certPath.c_str(), certData)) {
+      LOG(ERROR) << "Failed to read certificate";
+      return 1;
+    } else if (!readFile(keyPath.c_str(), keyData)) {
+      LOG(ERROR) << "Failed to read private key";
+      return 1;
+    }
+    if (!keyPass.empty()) {
+      config.clientCert = CertUtils::makeSelfCert(certData, keyData, keyPass);
+    } else {
+      config.clientCert = CertUtils::makeSelfCert(certData, keyData);
+    }
+  }
+
+  try {
+    config.addr = SocketAddress(host, port, true);
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Error: " << e.what();
+    return 1;
+  }
+  config.sni = customSNI.empty() ? host : customSNI;
+
+  std::vector<std::unique_ptr<Worker>> workers;
+  for (uint32_t i = 0; i < threads; i++) {
+    workers.push_back(std::make_unique<Worker>(config, rate / threads));
+  }
+
+  auto cpuStart = cpuSeconds();
+  auto wallStart = Clock::now();
+  for (auto& worker : workers) {
+    worker->start();
+  }
+  /* sleep override */
+  std::this_thread::sleep_for(std::chrono::seconds(duration));
+  for (auto& worker : workers) {
+    worker->stop();
+  }
+  for (auto& worker : workers) {
+    worker->join();
+  }
+  auto wallSeconds = std::chrono::duration_cast<std::chrono::duration<double>>(
+                         Clock::now() - wallStart)
+                         .count();
+  auto cpuUsed = cpuSeconds() - cpuStart;
+
+  uint64_t successes = 0;
+  uint64_t failures = 0;
+  std::vector<uint64_t> latenciesUs;
+  for (const auto& worker : workers) {
+    successes += worker->successes();
+    failures += worker->failures();
+    latenciesUs.insert(
+        latenciesUs.end(),
+        worker->latenciesUs().begin(),
+        worker->latenciesUs().end());
+  }
+
+  printf("threads:        %u\n", threads);
+  printf("target rate:    %s\n",
+         rate == 0 ? "unlimited" : folly::to<std::string>(rate).c_str());
+  printf("handshakes:     %lu\n", static_cast<unsigned long>(successes));
+  printf("failures:       %lu\n", static_cast<unsigned long>(failures));
+  printf("handshakes/sec: %.1f\n", successes / wallSeconds);
+  printf(
+      "cpu:            %.2f s (%.2f cores)\n", cpuUsed, cpuUsed / wallSeconds);
+  if (!latenciesUs.empty()) {
+    std::sort(latenciesUs.begin(), latenciesUs.end());
+    printf("latency p50:    %lu us\n",
+           static_cast<unsigned long>(percentileUs(latenciesUs, 50)));
+    printf("latency p90:    %lu us\n",
+           static_cast<unsigned long>(percentileUs(latenciesUs, 90)));
+    printf("latency p99:    %lu us\n",
+           static_cast<unsigned long>(percentileUs(latenciesUs, 99)));
+    printf("latency max:    %lu us\n",
+           static_cast<unsigned long>(latenciesUs.back()));
+    printf("latency histogram:\n");
+    printHistogram(latenciesUs);
+  }
+
+  return failures == 0 ? 0 : 1;
+}
+
+} // namespace tool
+} // namespace fizz
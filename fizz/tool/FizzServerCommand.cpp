@@ -23,11 +23,16 @@
 #include <fizz/tool/FizzCommandCommon.h>
 #include <fizz/util/Parse.h>
 
+#include <folly/FileUtil.h>
 #include <folly/Format.h>
 #include <folly/io/async/AsyncSSLSocket.h>
 #include <folly/io/async/AsyncServerSocket.h>
 
+#include <sys/resource.h>
+
+#include <atomic>
 #include <string>
+#include <thread>
 #include <vector>
 
 using namespace fizz::server;
@@ -59,10 +64,20 @@ void printUsage() {
     << " -certcompression a1:...  (enables certificate compression support for given algorithms. Default: None)\n"
     << " -fallback                (enables falling back to OpenSSL for pre-1.3 connections. Default: false)\n"
     << " -loop                    (don't exit after client disconnect. Default: false)\n"
+    << " -threads n               (run a worker pool of n event base threads with SO_REUSEPORT\n"
+    << "                           listeners, printing aggregated stats once per second. Meant as\n"
+    << "                           a performance testing peer; ignores -fallback/-http/-loop.\n"
+    << "                           Default: 0, single-connection interactive mode)\n"
+    << " -serve file              (serve the given file repeatedly to every connection, printing\n"
+    << "                           goodput and CPU seconds per GB once per second. Combines with\n"
+    << "                           -threads for a worker pool. Default: none)\n"
+    << " -zerocopy threshold      (in -serve mode, flag encrypted writes of at least threshold\n"
+    << "                           bytes for MSG_ZEROCOPY transmission. Default: 0, disabled)\n"
     << " -quiet                   (hide informational logging. Default: false)\n"
     << " -v verbosity             (set verbose log level for VLOG macros. Default: 0)\n"
     << " -vmodule m1=N,...        (set per-module verbose log level for VLOG macros. Default: none)\n"
-    << " -http                    (run a crude HTTP server that returns stats for GET requests. Default: false)\n";
+    << " -http                    (run a crude HTTP server that returns stats for GET requests. Default: false)\n"
+    << " -keylog file             (append NSS key log lines for each connection's secrets to file. Default: none)\n";
   // clang-format on
 }
 
@@ -83,6 +98,9 @@ class FizzServerAcceptor : AsyncServerSocket::AcceptCallback {
   void setHttpEnabled(bool enabled) {
     http_ = enabled;
   }
+  void setKeyLogger(std::shared_ptr<KeyLogWriter> keyLogger) {
+    keyLogger_ = std::move(keyLogger);
+  }
 
  private:
   bool loop_{false};
@@ -93,6 +111,7 @@ class FizzServerAcceptor : AsyncServerSocket::AcceptCallback {
   std::unique_ptr<AsyncFizzServer::HandshakeCallback> cb_;
   std::unique_ptr<TerminalInputHandler> inputHandler_;
   bool http_{false};
+  std::shared_ptr<KeyLogWriter> keyLogger_;
 };
 
 class FizzExampleServer : public AsyncFizzServer::HandshakeCallback,
@@ -104,12 +123,20 @@ class FizzExampleServer : public AsyncFizzServer::HandshakeCallback,
   explicit FizzExampleServer(
       std::shared_ptr<AsyncFizzServer> transport,
       FizzServerAcceptor* acceptor,
-      std::shared_ptr<SSLContext> sslCtx)
-      : transport_(transport), acceptor_(acceptor), sslCtx_(sslCtx) {}
+      std::shared_ptr<SSLContext> sslCtx,
+      std::shared_ptr<KeyLogWriter> keyLogger = nullptr)
+      : transport_(transport),
+        acceptor_(acceptor),
+        sslCtx_(sslCtx),
+        keyLogger_(std::move(keyLogger)) {}
   void fizzHandshakeSuccess(AsyncFizzServer* server) noexcept override {
     server->setReadCB(this);
     connected_ = true;
     printHandshakeSuccess();
+    auto* logging = transport_->getState().handshakeLogging();
+    if (keyLogger_ && logging && logging->clientRandom) {
+      writeKeyLog(*keyLogger_, *logging->clientRandom);
+    }
   }
 
   void fizzHandshakeError(
@@ -290,6 +317,7 @@ class FizzExampleServer : public AsyncFizzServer::HandshakeCallback,
   std::shared_ptr<SSLContext> sslCtx_;
   std::array<char, 8192> readBuf_;
   bool connected_{false};
+  std::shared_ptr<KeyLogWriter> keyLogger_;
 };
 
 class FizzHTTPServer : public FizzExampleServer {
@@ -297,8 +325,9 @@ class FizzHTTPServer : public FizzExampleServer {
   explicit FizzHTTPServer(
       std::shared_ptr<AsyncFizzServer> transport,
       FizzServerAcceptor* acceptor,
-      std::shared_ptr<SSLContext> sslCtx)
-      : FizzExampleServer(transport, acceptor, sslCtx) {}
+      std::shared_ptr<SSLContext> sslCtx,
+      std::shared_ptr<KeyLogWriter> keyLogger = nullptr)
+      : FizzExampleServer(transport, acceptor, sslCtx, std::move(keyLogger)) {}
 
   // HTTP server doesn't send user input.
   void write(std::unique_ptr<IOBuf> /*msg*/) override {}
@@ -386,8 +415,9 @@ void FizzServerAcceptor::connectionAccepted(
       new AsyncFizzServer(AsyncSocket::UniquePtr(sock), ctx_));
   socket_->pauseAccepting();
   auto serverCb = http_
-      ? std::make_unique<FizzHTTPServer>(transport, this, sslCtx_)
-      : std::make_unique<FizzExampleServer>(transport, this, sslCtx_);
+      ? std::make_unique<FizzHTTPServer>(transport, this, sslCtx_, keyLogger_)
+      : std::make_unique<FizzExampleServer>(
+            transport, this, sslCtx_, keyLogger_);
   inputHandler_ = std::make_unique<TerminalInputHandler>(evb_, serverCb.get());
   transport->setSecretCallback(serverCb.get());
   cb_ = std::move(serverCb);
@@ -411,6 +441,398 @@ void FizzServerAcceptor::done() {
   }
 }
 
+// Worker pool mode: N event base threads, each with its own SO_REUSEPORT
+// listener and context snapshot, counting accepts and handshakes into
+// shared atomics that the main thread aggregates and prints.
+
+struct PoolStats {
+  std::atomic<uint64_t> accepted{0};
+  std::atomic<uint64_t> handshakes{0};
+  std::atomic<uint64_t> failures{0};
+};
+
+/**
+ * One accepted connection in worker pool mode. Owns itself; counts the
+ * handshake result and goes away.
+ */
+class PoolConnection : public AsyncFizzServer::HandshakeCallback {
+ public:
+  PoolConnection(
+      EventBase* evb,
+      AsyncFizzServer::UniquePtr transport,
+      PoolStats* stats)
+      : evb_(evb), transport_(std::move(transport)), stats_(stats) {}
+
+  void accept() {
+    transport_->accept(this);
+  }
+
+  void fizzHandshakeSuccess(AsyncFizzServer* /*server*/) noexcept override {
+    stats_->handshakes++;
+    finish();
+  }
+
+  void fizzHandshakeError(
+      AsyncFizzServer* /*server*/,
+      exception_wrapper ex) noexcept override {
+    VLOG(1) << "Handshake error: " << ex.what();
+    stats_->failures++;
+    finish();
+  }
+
+  void fizzHandshakeAttemptFallback(
+      std::unique_ptr<IOBuf> /*clientHello*/) override {
+    VLOG(1) << "Fallback attempted in pool mode";
+    stats_->failures++;
+    finish();
+  }
+
+ private:
+  void finish() {
+    evb_->runInLoop([this] { delete this; }, true /* thisIteration */);
+  }
+
+  EventBase* evb_;
+  AsyncFizzServer::UniquePtr transport_;
+  PoolStats* stats_;
+};
+
+class PoolWorker : public AsyncServerSocket::AcceptCallback {
+ public:
+  PoolWorker(
+      uint16_t port,
+      std::shared_ptr<const FizzServerContext> baseContext,
+      bool early,
+      uint32_t earlyDataSize,
+      PoolStats* stats)
+      : port_(port),
+        baseContext_(std::move(baseContext)),
+        early_(early),
+        earlyDataSize_(earlyDataSize),
+        stats_(stats) {}
+
+  void start() {
+    thread_ = std::thread([this] {
+      // Per-thread context snapshot: contexts are read on every
+      // handshake, so giving each worker its own copy avoids sharing
+      // between threads. The ticket cipher is shared through the copy so
+      // tickets issued by one worker resume on any other.
+      auto context = std::make_shared<FizzServerContext>(*baseContext_);
+      if (early_) {
+        context->setEarlyDataSettings(
+            true,
+            {std::chrono::seconds(-10), std::chrono::seconds(10)},
+            std::make_shared<SlidingBloomReplayCache>(
+                240, 140000, 0.0005, &evb_));
+        context->setMaxEarlyDataSize(earlyDataSize_);
+      }
+      context_ = std::move(context);
+
+      socket_ = AsyncServerSocket::UniquePtr(new AsyncServerSocket(&evb_));
+      socket_->setReusePortEnabled(true);
+      socket_->bind(port_);
+      socket_->listen(1024);
+      socket_->addAcceptCallback(this, &evb_);
+      socket_->startAccepting();
+      evb_.loopForever();
+    });
+  }
+
+  void join() {
+    thread_.join();
+  }
+
+  void connectionAccepted(
+      folly::NetworkSocket fdNetworkSocket,
+      const SocketAddress& /*clientAddr*/) noexcept override {
+    stats_->accepted++;
+    auto sock = AsyncSocket::UniquePtr(new AsyncSocket(
+        &evb_, folly::NetworkSocket::fromFd(fdNetworkSocket.toFd())));
+    auto transport = AsyncFizzServer::UniquePtr(
+        new AsyncFizzServer(std::move(sock), context_));
+    auto conn = new PoolConnection(&evb_, std::move(transport), stats_);
+    conn->accept();
+  }
+
+  void acceptError(const std::exception& ex) noexcept override {
+    LOG(ERROR) << "Failed to accept connection: " << ex.what();
+  }
+
+ private:
+  uint16_t port_;
+  std::shared_ptr<const FizzServerContext> baseContext_;
+  bool early_;
+  uint32_t earlyDataSize_;
+  PoolStats* stats_;
+  EventBase evb_;
+  std::thread thread_;
+  std::shared_ptr<FizzServerContext> context_;
+  AsyncServerSocket::UniquePtr socket_;
+};
+
+int runWorkerPool(
+    uint16_t port,
+    std::shared_ptr<FizzServerContext> serverContext,
+    uint32_t threads,
+    bool early,
+    uint32_t earlyDataSize) {
+  PoolStats stats;
+  std::vector<std::unique_ptr<PoolWorker>> workers;
+  for (uint32_t i = 0; i < threads; i++) {
+    workers.push_back(std::make_unique<PoolWorker>(
+        port, serverContext, early, earlyDataSize, &stats));
+  }
+  for (auto& worker : workers) {
+    worker->start();
+  }
+  LOG(INFO) << "Started " << threads << " workers listening on port " << port;
+
+  uint64_t lastAccepted = 0;
+  uint64_t lastHandshakes = 0;
+  while (true) {
+    /* sleep override */
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    auto accepted = stats.accepted.load();
+    auto handshakes = stats.handshakes.load();
+    auto failures = stats.failures.load();
+    printf(
+        "accepts/sec: %8lu  handshakes/sec: %8lu  "
+        "total: %lu accepted, %lu handshakes, %lu failures\n",
+        static_cast<unsigned long>(accepted - lastAccepted),
+        static_cast<unsigned long>(handshakes - lastHandshakes),
+        static_cast<unsigned long>(accepted),
+        static_cast<unsigned long>(handshakes),
+        static_cast<unsigned long>(failures));
+    lastAccepted = accepted;
+    lastHandshakes = handshakes;
+  }
+}
+
+// Static content serving mode: every connection streams the configured
+// file repeatedly through the normal record layer (or the zero-copy
+// write path when -zerocopy is set), with goodput and CPU cost printed
+// once per second. Meant for measuring offload work: once a kernel TLS
+// handoff exists (see AsyncFizzServer::getKtlsState) it plugs into the
+// serve loop so the same workload measures both paths.
+
+constexpr size_t kServeChunkSize = 64 * 1024;
+
+struct ServeStats {
+  std::atomic<uint64_t> connections{0};
+  std::atomic<uint64_t> bytesWritten{0};
+  std::atomic<uint64_t> failures{0};
+};
+
+/**
+ * One serving connection. Owns itself; writes one chunk at a time and
+ * queues the next when the previous reaches the socket, cycling through
+ * the file until the peer goes away.
+ */
+class ServeConnection : public AsyncFizzServer::HandshakeCallback,
+                        public AsyncTransportWrapper::WriteCallback {
+ public:
+  ServeConnection(
+      EventBase* evb,
+      AsyncFizzServer::UniquePtr transport,
+      std::shared_ptr<const std::vector<Buf>> chunks,
+      ServeStats* stats)
+      : evb_(evb),
+        transport_(std::move(transport)),
+        chunks_(std::move(chunks)),
+        stats_(stats) {}
+
+  void accept() {
+    transport_->accept(this);
+  }
+
+  void fizzHandshakeSuccess(AsyncFizzServer* /*server*/) noexcept override {
+    stats_->connections++;
+    sendChunk();
+  }
+
+  void fizzHandshakeError(
+      AsyncFizzServer* /*server*/,
+      exception_wrapper ex) noexcept override {
+    VLOG(1) << "Handshake error: " << ex.what();
+    stats_->failures++;
+    finish();
+  }
+
+  void fizzHandshakeAttemptFallback(
+      std::unique_ptr<IOBuf> /*clientHello*/) override {
+    VLOG(1) << "Fallback attempted in serve mode";
+    stats_->failures++;
+    finish();
+  }
+
+  void writeSuccess() noexcept override {
+    stats_->bytesWritten += lastChunkSize_;
+    sendChunk();
+  }
+
+  void writeErr(
+      size_t /*bytesWritten*/,
+      const AsyncSocketException& ex) noexcept override {
+    VLOG(1) << "Write error: " << ex.what();
+    finish();
+  }
+
+ private:
+  void sendChunk() {
+    const auto& chunk = (*chunks_)[nextChunk_];
+    nextChunk_ = (nextChunk_ + 1) % chunks_->size();
+    lastChunkSize_ = chunk->computeChainDataLength();
+    transport_->writeChain(this, chunk->clone());
+  }
+
+  void finish() {
+    evb_->runInLoop([this] { delete this; }, true /* thisIteration */);
+  }
+
+  EventBase* evb_;
+  AsyncFizzServer::UniquePtr transport_;
+  std::shared_ptr<const std::vector<Buf>> chunks_;
+  ServeStats* stats_;
+  size_t nextChunk_{0};
+  size_t lastChunkSize_{0};
+};
+
+class ServeWorker : public AsyncServerSocket::AcceptCallback {
+ public:
+  ServeWorker(
+      uint16_t port,
+      std::shared_ptr<const FizzServerContext> baseContext,
+      std::shared_ptr<const std::vector<Buf>> chunks,
+      size_t zeroCopyThreshold,
+      ServeStats* stats)
+      : port_(port),
+        baseContext_(std::move(baseContext)),
+        chunks_(std::move(chunks)),
+        zeroCopyThreshold_(zeroCopyThreshold),
+        stats_(stats) {}
+
+  void start() {
+    thread_ = std::thread([this] {
+      context_ = std::make_shared<FizzServerContext>(*baseContext_);
+      socket_ = AsyncServerSocket::UniquePtr(new AsyncServerSocket(&evb_));
+      socket_->setReusePortEnabled(true);
+      socket_->bind(port_);
+      socket_->listen(1024);
+      socket_->addAcceptCallback(this, &evb_);
+      socket_->startAccepting();
+      evb_.loopForever();
+    });
+  }
+
+  void join() {
+    thread_.join();
+  }
+
+  void connectionAccepted(
+      folly::NetworkSocket fdNetworkSocket,
+      const SocketAddress& /*clientAddr*/) noexcept override {
+    auto sock = AsyncSocket::UniquePtr(new AsyncSocket(
+        &evb_, folly::NetworkSocket::fromFd(fdNetworkSocket.toFd())));
+    if (zeroCopyThreshold_) {
+      sock->setZeroCopy(true);
+    }
+    auto transport = AsyncFizzServer::UniquePtr(
+        new AsyncFizzServer(std::move(sock), context_));
+    if (zeroCopyThreshold_) {
+      transport->setZeroCopyThreshold(zeroCopyThreshold_);
+    }
+    auto conn = new ServeConnection(&evb_, std::move(transport), chunks_,
+        stats_);
+    conn->accept();
+  }
+
+  void acceptError(const std::exception& ex) noexcept override {
+    LOG(ERROR) << "Failed to accept connection: " << ex.what();
+  }
+
+ private:
+  uint16_t port_;
+  std::shared_ptr<const FizzServerContext> baseContext_;
+  std::shared_ptr<const std::vector<Buf>> chunks_;
+  size_t zeroCopyThreshold_;
+  ServeStats* stats_;
+  EventBase evb_;
+  std::thread thread_;
+  std::shared_ptr<FizzServerContext> context_;
+  AsyncServerSocket::UniquePtr socket_;
+};
+
+double processCpuSeconds() {
+  rusage usage = {};
+  getrusage(RUSAGE_SELF, &usage);
+  auto toSeconds = [](const timeval& tv) {
+    return tv.tv_sec + tv.tv_usec / 1e6;
+  };
+  return toSeconds(usage.ru_utime) + toSeconds(usage.ru_stime);
+}
+
+int runStaticServer(
+    uint16_t port,
+    std::shared_ptr<FizzServerContext> serverContext,
+    const std::string& servePath,
+    uint32_t threads,
+    size_t zeroCopyThreshold) {
+  std::string content;
+  if (!folly::readFile(servePath.c_str(), content)) {
+    LOG(ERROR) << "Could not read file to serve: " << servePath;
+    return 1;
+  }
+  if (content.empty()) {
+    LOG(ERROR) << "Refusing to serve empty file: " << servePath;
+    return 1;
+  }
+
+  // Pre-chunk the file so each write hands the transport a bounded,
+  // shared-storage buffer rather than queueing the whole file.
+  auto chunks = std::make_shared<std::vector<Buf>>();
+  for (size_t offset = 0; offset < content.size();
+       offset += kServeChunkSize) {
+    auto len = std::min(kServeChunkSize, content.size() - offset);
+    chunks->push_back(folly::IOBuf::copyBuffer(content.data() + offset, len));
+  }
+
+  ServeStats stats;
+  std::vector<std::unique_ptr<ServeWorker>> workers;
+  for (uint32_t i = 0; i < threads; i++) {
+    workers.push_back(std::make_unique<ServeWorker>(
+        port, serverContext, chunks, zeroCopyThreshold, &stats));
+  }
+  for (auto& worker : workers) {
+    worker->start();
+  }
+  LOG(INFO) << "Serving " << servePath << " (" << content.size()
+            << " bytes) on port " << port << " with " << threads
+            << " workers"
+            << (zeroCopyThreshold ? ", zero-copy writes enabled" : "");
+
+  uint64_t lastBytes = 0;
+  double lastCpu = processCpuSeconds();
+  while (true) {
+    /* sleep override */
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    auto bytes = stats.bytesWritten.load();
+    auto cpu = processCpuSeconds();
+    auto deltaBytes = bytes - lastBytes;
+    auto deltaCpu = cpu - lastCpu;
+    double gigabytes = deltaBytes / 1e9;
+    printf(
+        "goodput: %7.2f Gbit/s  cpu/GB: %6.3f s  "
+        "total: %lu connections, %.2f GB, %lu failures\n",
+        deltaBytes * 8 / 1e9,
+        gigabytes > 0 ? deltaCpu / gigabytes : 0.0,
+        static_cast<unsigned long>(stats.connections.load()),
+        bytes / 1e9,
+        static_cast<unsigned long>(stats.failures.load()));
+    lastBytes = bytes;
+    lastCpu = cpu;
+  }
+}
+
 } // namespace
 
 int fizzServerCommand(const std::vector<std::string>& args) {
@@ -427,7 +849,11 @@ int fizzServerCommand(const std::vector<std::string>& args) {
   bool loop = false;
   bool fallback = false;
   bool http = false;
+  std::string keyLogFile;
+  uint32_t threads = 0;
   uint32_t earlyDataSize = std::numeric_limits<uint32_t>::max();
+  std::string servePath;
+  size_t zeroCopyThreshold = 0;
   std::vector<std::vector<CipherSuite>> ciphers {
     {CipherSuite::TLS_AES_128_GCM_SHA256,
      CipherSuite::TLS_AES_256_GCM_SHA384},
@@ -480,6 +906,9 @@ int fizzServerCommand(const std::vector<std::string>& args) {
         }
     }}},
     {"-loop", {false, [&loop](const std::string&) { loop = true; }}},
+    {"-threads", {true, [&threads](const std::string& arg) {
+        threads = folly::to<uint32_t>(arg);
+    }}},
     {"-quiet", {false, [](const std::string&) {
         FLAGS_minloglevel = google::GLOG_ERROR;
     }}},
@@ -489,6 +918,15 @@ int fizzServerCommand(const std::vector<std::string>& args) {
     {"-http", {false, [&http](const std::string&) { http = true; }}},
     {"-early_max", {true, [&earlyDataSize](const std::string& arg) {
         earlyDataSize = folly::to<uint32_t>(arg);
+    }}},
+    {"-serve", {true, [&servePath](const std::string& arg) {
+        servePath = arg;
+    }}},
+    {"-zerocopy", {true, [&zeroCopyThreshold](const std::string& arg) {
+        zeroCopyThreshold = folly::to<size_t>(arg);
+    }}},
+    {"-keylog", {true, [&keyLogFile](const std::string& arg) {
+        keyLogFile = arg;
     }}}
   };
   // clang-format on
@@ -606,7 +1044,9 @@ int fizzServerCommand(const std::vector<std::string>& args) {
   }
   serverContext->setCertManager(std::move(certManager));
 
-  if (early) {
+  // In worker pool mode each worker installs its own replay cache bound to
+  // its event base; the main event base never loops there.
+  if (early && threads == 0) {
     serverContext->setEarlyDataSettings(
         true,
         {std::chrono::seconds(-10), std::chrono::seconds(10)},
@@ -632,8 +1072,30 @@ int fizzServerCommand(const std::vector<std::string>& args) {
 
   serverContext->setSupportedVersions(
       {ProtocolVersion::tls_1_3, ProtocolVersion::tls_1_3_28});
+
+  if (!servePath.empty()) {
+    return runStaticServer(
+        port,
+        serverContext,
+        servePath,
+        threads > 0 ? threads : 1,
+        zeroCopyThreshold);
+  }
+
+  if (threads > 0) {
+    return runWorkerPool(port, serverContext, threads, early, earlyDataSize);
+  }
+
   FizzServerAcceptor acceptor(port, serverContext, loop, &evb, sslContext);
   acceptor.setHttpEnabled(http);
+  if (!keyLogFile.empty()) {
+    try {
+      acceptor.setKeyLogger(std::make_shared<KeyLogWriter>(keyLogFile));
+    } catch (const std::exception& e) {
+      LOG(ERROR) << "Error: " << e.what();
+      return 1;
+    }
+  }
   evb.loop();
   return 0;
 }
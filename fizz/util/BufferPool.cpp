@@ -0,0 +1,93 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/util/BufferPool.h>
+
+#include <cstdlib>
+#include <vector>
+
+namespace fizz {
+namespace buffer_pool {
+
+namespace {
+
+constexpr size_t kDefaultPoolCapacity = 32;
+
+// Room for the owning pool pointer ahead of the data region, padded so
+// the data stays maximally aligned.
+constexpr size_t kHeaderSize = alignof(std::max_align_t);
+
+struct Pool;
+
+struct BlockHeader {
+  Pool* origin;
+};
+
+struct Pool {
+  std::vector<void*> blocks;
+  size_t capacity{kDefaultPoolCapacity};
+
+  ~Pool() {
+    for (auto block : blocks) {
+      std::free(block);
+    }
+  }
+};
+
+Pool& getPool() {
+  static thread_local Pool pool;
+  return pool;
+}
+
+void releaseBlock(void* /* data */, void* userData) {
+  auto header = static_cast<BlockHeader*>(userData);
+  auto& pool = getPool();
+  if (header->origin == &pool && pool.blocks.size() < pool.capacity) {
+    pool.blocks.push_back(header);
+    return;
+  }
+  std::free(header);
+}
+} // namespace
+
+std::unique_ptr<folly::IOBuf> allocate(size_t capacity) {
+  if (capacity > kPooledBufferSize) {
+    return folly::IOBuf::create(capacity);
+  }
+  auto& pool = getPool();
+  void* block;
+  if (!pool.blocks.empty()) {
+    block = pool.blocks.back();
+    pool.blocks.pop_back();
+  } else {
+    block = std::malloc(kHeaderSize + kPooledBufferSize);
+    if (!block) {
+      throw std::bad_alloc();
+    }
+  }
+  auto header = static_cast<BlockHeader*>(block);
+  header->origin = &pool;
+  auto data = static_cast<uint8_t*>(block) + kHeaderSize;
+  return folly::IOBuf::takeOwnership(
+      data, kPooledBufferSize, 0, releaseBlock, block);
+}
+
+void setPoolCapacity(size_t capacity) {
+  auto& pool = getPool();
+  pool.capacity = capacity;
+  while (pool.blocks.size() > capacity) {
+    std::free(pool.blocks.back());
+    pool.blocks.pop_back();
+  }
+}
+
+size_t getPoolCapacity() {
+  return getPool().capacity;
+}
+} // namespace buffer_pool
+} // namespace fizz
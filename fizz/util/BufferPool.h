@@ -0,0 +1,56 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <folly/io/IOBuf.h>
+
+namespace fizz {
+
+/**
+ * Per-thread pool of record-sized IOBuf backing stores.
+ *
+ * Event base threads are typically pinned, so a per-thread pool is also
+ * per-core and, on multi-socket hosts, per-NUMA-node: pooled memory is
+ * first-touched and recycled on the thread that uses it, keeping the
+ * record path node-local instead of bouncing buffers across sockets.
+ *
+ * Buffers released on the thread that allocated them return to that
+ * thread's pool; buffers released elsewhere are freed to the global
+ * allocator, as handing them back would both race and defeat node
+ * locality. Requests larger than kPooledBufferSize fall through to the
+ * regular IOBuf allocator.
+ */
+namespace buffer_pool {
+
+/**
+ * Largest pooled allocation: one max-size encrypted record plus header
+ * and cipher overhead.
+ */
+constexpr size_t kPooledBufferSize = 17 * 1024;
+
+/**
+ * Returns an empty IOBuf with at least `capacity` bytes of tailroom,
+ * pooled when `capacity` permits.
+ */
+std::unique_ptr<folly::IOBuf> allocate(size_t capacity);
+
+/**
+ * Sets the maximum number of free buffers the calling thread's pool
+ * retains (default 32, or about 544KB). Shrinking frees excess buffers
+ * immediately; zero disables recycling on this thread.
+ */
+void setPoolCapacity(size_t capacity);
+
+/**
+ * Returns the calling thread's pool capacity.
+ */
+size_t getPoolCapacity();
+
+} // namespace buffer_pool
+} // namespace fizz
@@ -0,0 +1,154 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/util/ClientHelloPeek.h>
+
+#include <fizz/record/Types.h>
+
+namespace fizz {
+
+namespace {
+
+constexpr size_t kRecordHeaderSize = 5;
+
+/**
+ * Bounds-checked reader over a flat byte range. Running out of bytes throws
+ * std::out_of_range, which peekClientHello() maps to "need more data".
+ */
+class RangeReader {
+ public:
+  explicit RangeReader(folly::ByteRange data) : data_(data) {}
+
+  uint8_t readU8() {
+    ensure(1);
+    return data_[pos_++];
+  }
+
+  uint16_t readU16() {
+    ensure(2);
+    uint16_t val = (uint16_t(data_[pos_]) << 8) | data_[pos_ + 1];
+    pos_ += 2;
+    return val;
+  }
+
+  uint32_t readU24() {
+    ensure(3);
+    uint32_t val = (uint32_t(data_[pos_]) << 16) |
+        (uint32_t(data_[pos_ + 1]) << 8) | data_[pos_ + 2];
+    pos_ += 3;
+    return val;
+  }
+
+  folly::StringPiece readRange(size_t len) {
+    ensure(len);
+    folly::StringPiece range(
+        reinterpret_cast<const char*>(data_.data() + pos_), len);
+    pos_ += len;
+    return range;
+  }
+
+  void skip(size_t len) {
+    ensure(len);
+    pos_ += len;
+  }
+
+  size_t remaining() const {
+    return data_.size() - pos_;
+  }
+
+ private:
+  void ensure(size_t len) const {
+    if (data_.size() - pos_ < len) {
+      throw std::out_of_range("out of data");
+    }
+  }
+
+  folly::ByteRange data_;
+  size_t pos_{0};
+};
+} // namespace
+
+folly::Optional<ClientHelloPeek> peekClientHello(folly::ByteRange data) {
+  try {
+    RangeReader reader(data);
+
+    auto contentType = static_cast<ContentType>(reader.readU8());
+    if (contentType != ContentType::handshake) {
+      throw std::runtime_error("peek: not a handshake record");
+    }
+    reader.skip(sizeof(ProtocolVersion));
+    auto recordLength = reader.readU16();
+
+    auto handshakeType = static_cast<HandshakeType>(reader.readU8());
+    if (handshakeType != HandshakeType::client_hello) {
+      throw std::runtime_error("peek: not a client hello");
+    }
+    auto messageLength = reader.readU24();
+    if (messageLength + sizeof(HandshakeType) + 3 > recordLength) {
+      throw std::runtime_error("peek: fragmented client hello");
+    }
+
+    reader.skip(sizeof(ProtocolVersion));
+    reader.skip(32); // random
+    reader.skip(reader.readU8()); // legacy_session_id
+    reader.skip(reader.readU16()); // cipher_suites
+    reader.skip(reader.readU8()); // legacy_compression_methods
+
+    ClientHelloPeek result;
+    if (reader.remaining() == 0) {
+      // Pre-TLS 1.3 client hellos may omit extensions entirely; this is only
+      // an answer if the whole record is present.
+      if (data.size() >= kRecordHeaderSize + recordLength) {
+        return result;
+      }
+      throw std::out_of_range("out of data");
+    }
+
+    auto extensionsLength = reader.readU16();
+    size_t consumed = 0;
+    while (consumed < extensionsLength) {
+      auto extensionType = static_cast<ExtensionType>(reader.readU16());
+      size_t extensionLength = reader.readU16();
+      consumed += 2 * sizeof(uint16_t) + extensionLength;
+
+      switch (extensionType) {
+        case ExtensionType::server_name: {
+          reader.skip(sizeof(uint16_t)); // server_name_list length
+          auto nameType = reader.readU8();
+          auto nameLength = reader.readU16();
+          if (nameType != 0 || nameLength + 5u > extensionLength) {
+            throw std::runtime_error("peek: malformed server_name");
+          }
+          result.sni = reader.readRange(nameLength);
+          reader.skip(extensionLength - 5 - nameLength);
+          break;
+        }
+        case ExtensionType::application_layer_protocol_negotiation: {
+          reader.skip(sizeof(uint16_t)); // protocol_name_list length
+          size_t protocolsConsumed = sizeof(uint16_t);
+          while (protocolsConsumed < extensionLength) {
+            size_t nameLength = reader.readU8();
+            if (protocolsConsumed + 1 + nameLength > extensionLength) {
+              throw std::runtime_error("peek: malformed alpn");
+            }
+            result.alpns.push_back(reader.readRange(nameLength));
+            protocolsConsumed += 1 + nameLength;
+          }
+          break;
+        }
+        default:
+          reader.skip(extensionLength);
+          break;
+      }
+    }
+    return result;
+  } catch (const std::out_of_range&) {
+    return folly::none;
+  }
+}
+} // namespace fizz
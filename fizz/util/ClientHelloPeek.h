@@ -0,0 +1,38 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <folly/Optional.h>
+#include <folly/Range.h>
+#include <folly/small_vector.h>
+
+namespace fizz {
+
+/**
+ * SNI and ALPN values found by peekClientHello(). The StringPieces point
+ * into the caller's buffer and are only valid as long as it is.
+ */
+struct ClientHelloPeek {
+  folly::Optional<folly::StringPiece> sni;
+  folly::small_vector<folly::StringPiece, 8> alpns;
+};
+
+/**
+ * Scans a raw ClientHello for the server_name and ALPN extensions without
+ * decoding the message. data should contain the bytes read from the
+ * transport so far, starting at the plaintext record header. Nothing is
+ * allocated and nothing is copied; the result aliases data.
+ *
+ * Returns folly::none if data is a truncated client hello and more data is
+ * needed to answer. Throws std::runtime_error if data is not the start of a
+ * TLS client hello, or if the client hello spans multiple records (rare
+ * enough that callers should fall back to a full parse).
+ */
+folly::Optional<ClientHelloPeek> peekClientHello(folly::ByteRange data);
+} // namespace fizz
@@ -0,0 +1,98 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/util/Ja3Fingerprint.h>
+
+#include <fizz/record/Extensions.h>
+#include <folly/String.h>
+#include <folly/io/Cursor.h>
+
+#include <openssl/md5.h>
+
+namespace fizz {
+
+namespace {
+constexpr uint16_t kEcPointFormats = 11;
+
+// GREASE values (RFC 8701) are random per client and excluded from the
+// fingerprint.
+bool isGrease(uint16_t value) {
+  return (value & 0x0f0f) == 0x0a0a && (value >> 8) == (value & 0xff);
+}
+
+void appendValue(std::string& out, bool& first, uint16_t value) {
+  if (!first) {
+    out.push_back('-');
+  }
+  first = false;
+  folly::toAppend(value, &out);
+}
+} // namespace
+
+std::string ja3String(const ClientHello& chlo) {
+  std::string out;
+  folly::toAppend(static_cast<uint16_t>(chlo.legacy_version), &out);
+  out.push_back(',');
+
+  bool first = true;
+  for (auto cipher : chlo.cipher_suites) {
+    auto value = static_cast<uint16_t>(cipher);
+    if (!isGrease(value)) {
+      appendValue(out, first, value);
+    }
+  }
+  out.push_back(',');
+
+  first = true;
+  for (const auto& extension : chlo.extensions) {
+    auto value = static_cast<uint16_t>(extension.extension_type);
+    if (!isGrease(value)) {
+      appendValue(out, first, value);
+    }
+  }
+  out.push_back(',');
+
+  first = true;
+  auto groups = getExtension<SupportedGroups>(chlo.extensions);
+  if (groups) {
+    for (auto group : groups->named_group_list) {
+      auto value = static_cast<uint16_t>(group);
+      if (!isGrease(value)) {
+        appendValue(out, first, value);
+      }
+    }
+  }
+  out.push_back(',');
+
+  first = true;
+  for (const auto& extension : chlo.extensions) {
+    if (static_cast<uint16_t>(extension.extension_type) != kEcPointFormats) {
+      continue;
+    }
+    // One length byte followed by one byte per point format.
+    folly::io::Cursor cursor(extension.extension_data.get());
+    if (cursor.totalLength() < 1) {
+      break;
+    }
+    auto length = cursor.read<uint8_t>();
+    for (uint8_t i = 0; i < length && !cursor.isAtEnd(); i++) {
+      appendValue(out, first, cursor.read<uint8_t>());
+    }
+    break;
+  }
+
+  return out;
+}
+
+std::string ja3Hash(const ClientHello& chlo) {
+  auto str = ja3String(chlo);
+  std::array<uint8_t, MD5_DIGEST_LENGTH> digest;
+  MD5(reinterpret_cast<const uint8_t*>(str.data()), str.size(), digest.data());
+  return folly::hexlify(folly::range(digest));
+}
+} // namespace fizz
@@ -0,0 +1,32 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/record/Types.h>
+
+#include <string>
+
+namespace fizz {
+
+/**
+ * Computes the JA3 fingerprint string for a decoded ClientHello:
+ * version, cipher suites, extension order, supported groups and EC point
+ * formats, each as dash-joined decimal values separated by commas, with
+ * GREASE values removed. The decoded message already carries every field
+ * the fingerprint needs, so this is a walk over the decoded vectors
+ * rather than a second parse of the raw bytes.
+ */
+std::string ja3String(const ClientHello& chlo);
+
+/**
+ * The MD5 of ja3String() as a lowercase hex string, the form most
+ * fingerprint databases key on.
+ */
+std::string ja3Hash(const ClientHello& chlo);
+} // namespace fizz
@@ -0,0 +1,64 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <fizz/util/KeyLogWriter.h>
+
+#include <folly/String.h>
+
+#include <stdexcept>
+
+namespace fizz {
+
+KeyLogWriter::KeyLogWriter(const std::string& fileName) {
+  outputFile_.open(fileName, std::ofstream::app);
+  if (outputFile_.fail()) {
+    throw std::runtime_error("Error opening NSS key log output file");
+  }
+}
+
+void KeyLogWriter::write(
+    const Random& clientRandom,
+    Label label,
+    folly::ByteRange secret) {
+  outputFile_ << generateLogLine(clientRandom, label, secret);
+  outputFile_.flush();
+}
+
+std::string KeyLogWriter::generateLogLine(
+    const Random& clientRandom,
+    Label label,
+    folly::ByteRange secret) {
+  return folly::to<std::string>(
+      labelToString(label),
+      " ",
+      folly::hexlify(folly::range(clientRandom)),
+      " ",
+      folly::hexlify(secret),
+      "\n");
+}
+
+folly::StringPiece KeyLogWriter::labelToString(Label label) {
+  switch (label) {
+    case Label::CLIENT_EARLY_TRAFFIC_SECRET:
+      return "CLIENT_EARLY_TRAFFIC_SECRET";
+    case Label::CLIENT_HANDSHAKE_TRAFFIC_SECRET:
+      return "CLIENT_HANDSHAKE_TRAFFIC_SECRET";
+    case Label::SERVER_HANDSHAKE_TRAFFIC_SECRET:
+      return "SERVER_HANDSHAKE_TRAFFIC_SECRET";
+    case Label::CLIENT_TRAFFIC_SECRET_0:
+      return "CLIENT_TRAFFIC_SECRET_0";
+    case Label::SERVER_TRAFFIC_SECRET_0:
+      return "SERVER_TRAFFIC_SECRET_0";
+    case Label::EARLY_EXPORTER_SECRET:
+      return "EARLY_EXPORTER_SECRET";
+    case Label::EXPORTER_SECRET:
+      return "EXPORTER_SECRET";
+  }
+  return "UNKNOWN_SECRET";
+}
+} // namespace fizz
@@ -0,0 +1,66 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/record/Types.h>
+#include <folly/Range.h>
+
+#include <fstream>
+#include <string>
+
+namespace fizz {
+
+/**
+ * Appends session secrets to a file in the NSS key log format (the format
+ * the SSLKEYLOGFILE convention uses), so traffic captured from a sampled
+ * connection can be decrypted offline without inserting a decrypting proxy
+ * into the path being debugged. Typically fed from an
+ * AsyncFizzBase::SecretCallback; when no callback is installed the secret
+ * delivery path stays a single null check.
+ */
+class KeyLogWriter {
+ public:
+  enum class Label {
+    CLIENT_EARLY_TRAFFIC_SECRET,
+    CLIENT_HANDSHAKE_TRAFFIC_SECRET,
+    SERVER_HANDSHAKE_TRAFFIC_SECRET,
+    CLIENT_TRAFFIC_SECRET_0,
+    SERVER_TRAFFIC_SECRET_0,
+    EARLY_EXPORTER_SECRET,
+    EXPORTER_SECRET
+  };
+
+  /**
+   * Opens the key log file in append mode. Throws on failure.
+   */
+  explicit KeyLogWriter(const std::string& fileName);
+
+  /**
+   * Appends a log line for the given secret.
+   */
+  void write(
+      const Random& clientRandom,
+      Label label,
+      folly::ByteRange secret);
+
+  /**
+   * Generates one NSS key log line:
+   * <label> <client random in hex> <secret in hex>\n
+   */
+  static std::string generateLogLine(
+      const Random& clientRandom,
+      Label label,
+      folly::ByteRange secret);
+
+ private:
+  static folly::StringPiece labelToString(Label label);
+
+  std::ofstream outputFile_;
+};
+} // namespace fizz
@@ -0,0 +1,74 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace fizz {
+
+/**
+ * CRTP mixin that backs a type's heap allocations with a per-thread
+ * freelist, so that connection churn reuses warm storage instead of going
+ * through the global allocator for every short-lived protocol object.
+ *
+ * Objects are still constructed and destroyed normally; only their storage
+ * is recycled. Blocks freed on one thread land in that thread's freelist,
+ * regardless of where they were allocated. Derived types of a recycled
+ * class fall through to the global allocator, as their size differs from
+ * sizeof(T).
+ */
+template <typename T, size_t Capacity = 32>
+class PerThreadRecycled {
+ public:
+  static void* operator new(std::size_t size) {
+    if (size == sizeof(T)) {
+      auto& blocks = getFreelist().blocks;
+      if (!blocks.empty()) {
+        void* ptr = blocks.back();
+        blocks.pop_back();
+        return ptr;
+      }
+    }
+    return ::operator new(size);
+  }
+
+  static void operator delete(void* ptr, std::size_t size) {
+    if (size == sizeof(T)) {
+      auto& blocks = getFreelist().blocks;
+      if (blocks.size() < Capacity) {
+        blocks.push_back(ptr);
+        return;
+      }
+    }
+    ::operator delete(ptr);
+  }
+
+  static void operator delete(void* ptr) {
+    ::operator delete(ptr);
+  }
+
+ private:
+  struct Freelist {
+    std::vector<void*> blocks;
+
+    ~Freelist() {
+      for (auto ptr : blocks) {
+        ::operator delete(ptr);
+      }
+    }
+  };
+
+  static Freelist& getFreelist() {
+    static thread_local Freelist freelist;
+    return freelist;
+  }
+};
+} // namespace fizz
@@ -0,0 +1,69 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GTest.h>
+
+#include <fizz/util/BufferPool.h>
+
+#include <thread>
+
+namespace fizz {
+namespace test {
+
+TEST(BufferPoolTest, TestAllocate) {
+  auto buf = buffer_pool::allocate(1024);
+  EXPECT_EQ(buf->length(), 0);
+  EXPECT_GE(buf->tailroom(), 1024);
+}
+
+TEST(BufferPoolTest, TestRecycled) {
+  auto buf = buffer_pool::allocate(1024);
+  auto data = buf->writableTail();
+  buf.reset();
+  auto recycled = buffer_pool::allocate(1024);
+  EXPECT_EQ(recycled->writableTail(), data);
+}
+
+TEST(BufferPoolTest, TestOversizeNotPooled) {
+  auto buf = buffer_pool::allocate(buffer_pool::kPooledBufferSize + 1);
+  EXPECT_GE(buf->tailroom(), buffer_pool::kPooledBufferSize + 1);
+  auto data = buf->writableTail();
+  buf.reset();
+  auto next = buffer_pool::allocate(1024);
+  EXPECT_NE(next->writableTail(), data);
+}
+
+TEST(BufferPoolTest, TestCrossThreadRelease) {
+  auto buf = buffer_pool::allocate(1024);
+  buf->append(4);
+  std::thread releaser([buf = std::move(buf)]() mutable { buf.reset(); });
+  releaser.join();
+}
+
+TEST(BufferPoolTest, TestPoolCapacity) {
+  EXPECT_GT(buffer_pool::getPoolCapacity(), 0);
+
+  // With recycling disabled a released buffer is not handed back out.
+  buffer_pool::setPoolCapacity(0);
+  auto buf = buffer_pool::allocate(1024);
+  auto data = buf->writableTail();
+  buf.reset();
+  auto next = buffer_pool::allocate(1024);
+  EXPECT_NE(next->writableTail(), data);
+
+  buffer_pool::setPoolCapacity(32);
+}
+
+TEST(BufferPoolTest, TestWritable) {
+  auto buf = buffer_pool::allocate(buffer_pool::kPooledBufferSize);
+  memset(buf->writableTail(), 0xab, buffer_pool::kPooledBufferSize);
+  buf->append(buffer_pool::kPooledBufferSize);
+  EXPECT_EQ(buf->data()[buffer_pool::kPooledBufferSize - 1], 0xab);
+}
+} // namespace test
+} // namespace fizz
@@ -0,0 +1,126 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GTest.h>
+
+#include <fizz/util/ClientHelloPeek.h>
+#include <folly/String.h>
+
+using namespace folly;
+
+// Real client hello captured from firefox nightly
+static const std::string chlo =
+    "0304383cd7adc8587"
+    "e3b608ef98f8b47e5f29dd6124a1f258549"
+    "34ad85157dd5a7a400001ac02bc02fcca9c"
+    "ca8c02cc030c00ac009c013c014002f0035"
+    "000a010001d000000014001200000f74726"
+    "9732e66696c6970706f2e696f00170000ff"
+    "01000100000a00080006001700180019000"
+    "b0002010000230000337400000010001700"
+    "1502683208737064792f332e31086874747"
+    "02f312e31000500050100000000ff020002"
+    "000d0033014b014900170041048d5e897c8"
+    "96b17e1679766c14c785dd2c328c3eecc7d"
+    "bfd2e2e817cd35c786aceea79bf1286ab8a"
+    "5c3c464c46f5ba06338b24ea96ce442a4d1"
+    "3356902dfcd1e90100010032c84b9fc5e4f"
+    "12bf1b10da62506105f26d6913eb6a6ca34"
+    "c454963b85d3bbbd9360994db2baa28c217"
+    "e98cb6c40ed5a51246867910b5586dab299"
+    "5cb2c7c6298ab6606906911c08913adabe2"
+    "5901b7907b915b5962ad9e4639475292b18"
+    "0b651929e53b7fb38e7150bae3360aa3a30"
+    "b5a22facff2dd8716ef3239887f1f781757"
+    "b5ef4c68e7ed31e5bfbcb0ebb5d86794322"
+    "c01bd5d456292e8c0276efb05296cd24c10"
+    "cd388cf51ee798cf7e18638c17e44874bc3"
+    "bd1f697424511051f686db6a84b604d1bb4"
+    "0f6041c0c0e28be2a98829c78c7baea2dd3"
+    "49f0219443007e88fb3406dc4d9756e1076"
+    "1ef0eef675b4c4625f5d0aab3d6c7f57747"
+    "f4008d5a5000d0018001604010501060102"
+    "010403050306030203050204020202";
+
+static const std::string ssl3chlo =
+    "03005880ff04e8d5e0af70a2fe55fd90a5380a184f78c213aa8a4142010cac742e3600004cc014c00a0039003800880087c00fc00500350084c013c00900330032009a009900450044c00ec004002f00960041c012c00800160013c00dc003000a0007c011c007c00cc0020005000400ff0100";
+
+namespace fizz {
+namespace test {
+
+static std::string wireClientHello(const std::string& bodyHex) {
+  auto body = unhexlify(bodyHex);
+  std::string message;
+  message.push_back(0x01); // client_hello
+  message.push_back(static_cast<char>((body.size() >> 16) & 0xff));
+  message.push_back(static_cast<char>((body.size() >> 8) & 0xff));
+  message.push_back(static_cast<char>(body.size() & 0xff));
+  message += body;
+  std::string record;
+  record.push_back(0x16); // handshake
+  record.push_back(0x03);
+  record.push_back(0x01);
+  record.push_back(static_cast<char>((message.size() >> 8) & 0xff));
+  record.push_back(static_cast<char>(message.size() & 0xff));
+  return record + message;
+}
+
+static ByteRange range(const std::string& data) {
+  return ByteRange(
+      reinterpret_cast<const uint8_t*>(data.data()), data.size());
+}
+
+TEST(ClientHelloPeekTest, TestPeek) {
+  auto data = wireClientHello(chlo);
+  auto result = peekClientHello(range(data));
+  ASSERT_TRUE(result.hasValue());
+  ASSERT_TRUE(result->sni.hasValue());
+  EXPECT_EQ(*result->sni, "tris.filippo.io");
+  ASSERT_EQ(result->alpns.size(), 3);
+  EXPECT_EQ(result->alpns[0], "h2");
+  EXPECT_EQ(result->alpns[1], "spdy/3.1");
+  EXPECT_EQ(result->alpns[2], "http/1.1");
+}
+
+TEST(ClientHelloPeekTest, TestPeekAliasesInput) {
+  auto data = wireClientHello(chlo);
+  auto result = peekClientHello(range(data));
+  ASSERT_TRUE(result.hasValue());
+  EXPECT_GE(result->sni->data(), data.data());
+  EXPECT_LE(result->sni->end(), data.data() + data.size());
+}
+
+TEST(ClientHelloPeekTest, TestPartialData) {
+  auto data = wireClientHello(chlo);
+  for (size_t len = 0; len < data.size(); len++) {
+    auto result = peekClientHello(ByteRange(
+        reinterpret_cast<const uint8_t*>(data.data()), len));
+    EXPECT_FALSE(result.hasValue()) << "unexpected result at length " << len;
+  }
+}
+
+TEST(ClientHelloPeekTest, TestNoExtensions) {
+  auto data = wireClientHello(ssl3chlo);
+  auto result = peekClientHello(range(data));
+  ASSERT_TRUE(result.hasValue());
+  EXPECT_FALSE(result->sni.hasValue());
+  EXPECT_TRUE(result->alpns.empty());
+}
+
+TEST(ClientHelloPeekTest, TestNotTls) {
+  std::string data = "GET / HTTP/1.1\r\n";
+  EXPECT_THROW(peekClientHello(range(data)), std::runtime_error);
+}
+
+TEST(ClientHelloPeekTest, TestNotClientHello) {
+  auto data = wireClientHello(chlo);
+  data[5] = 0x02; // server_hello
+  EXPECT_THROW(peekClientHello(range(data)), std::runtime_error);
+}
+} // namespace test
+} // namespace fizz
@@ -0,0 +1,76 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GTest.h>
+
+#include <fizz/record/Extensions.h>
+#include <fizz/util/Ja3Fingerprint.h>
+
+using namespace folly;
+
+namespace fizz {
+namespace test {
+
+namespace {
+ClientHello getChlo() {
+  ClientHello chlo;
+  chlo.legacy_version = ProtocolVersion::tls_1_2;
+  chlo.cipher_suites = {
+      CipherSuite::TLS_AES_128_GCM_SHA256,
+      CipherSuite::TLS_AES_256_GCM_SHA384};
+
+  SupportedGroups groups;
+  groups.named_group_list = {NamedGroup::x25519, NamedGroup::secp256r1};
+  chlo.extensions.push_back(encodeExtension(groups));
+
+  SupportedVersions versions;
+  versions.versions = {ProtocolVersion::tls_1_3};
+  chlo.extensions.push_back(encodeExtension(versions));
+  return chlo;
+}
+} // namespace
+
+TEST(Ja3FingerprintTest, TestString) {
+  auto chlo = getChlo();
+  EXPECT_EQ(ja3String(chlo), "771,4865-4866,10-43,29-23,");
+}
+
+TEST(Ja3FingerprintTest, TestGreaseFiltered) {
+  auto chlo = getChlo();
+  chlo.cipher_suites.insert(
+      chlo.cipher_suites.begin(), static_cast<CipherSuite>(0x0a0a));
+  Extension grease;
+  grease.extension_type = static_cast<ExtensionType>(0xfafa);
+  grease.extension_data = IOBuf::create(0);
+  chlo.extensions.insert(chlo.extensions.begin(), std::move(grease));
+  EXPECT_EQ(ja3String(chlo), "771,4865-4866,10-43,29-23,");
+}
+
+TEST(Ja3FingerprintTest, TestPointFormats) {
+  auto chlo = getChlo();
+  Extension pointFormats;
+  pointFormats.extension_type = static_cast<ExtensionType>(11);
+  pointFormats.extension_data = IOBuf::copyBuffer("\x01\x00", 2);
+  chlo.extensions.push_back(std::move(pointFormats));
+  EXPECT_EQ(ja3String(chlo), "771,4865-4866,10-43-11,29-23,0");
+}
+
+TEST(Ja3FingerprintTest, TestEmpty) {
+  ClientHello chlo;
+  chlo.legacy_version = ProtocolVersion::tls_1_2;
+  EXPECT_EQ(ja3String(chlo), "771,,,,");
+}
+
+TEST(Ja3FingerprintTest, TestHash) {
+  auto chlo = getChlo();
+  auto hash = ja3Hash(chlo);
+  EXPECT_EQ(hash.size(), 32);
+  EXPECT_EQ(hash, ja3Hash(chlo));
+}
+} // namespace test
+} // namespace fizz
@@ -0,0 +1,76 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GTest.h>
+
+#include <fizz/util/KeyLogWriter.h>
+#include <folly/FileUtil.h>
+#include <folly/experimental/TestUtil.h>
+
+using namespace folly;
+
+namespace fizz {
+namespace test {
+
+static Random testRandom() {
+  Random random;
+  random.fill(0xaa);
+  return random;
+}
+
+TEST(KeyLogWriterTest, TestLogLineFormat) {
+  std::vector<uint8_t> secret = {0x01, 0x02, 0x03, 0x04};
+  auto line = KeyLogWriter::generateLogLine(
+      testRandom(),
+      KeyLogWriter::Label::CLIENT_TRAFFIC_SECRET_0,
+      folly::range(secret));
+  EXPECT_EQ(
+      line,
+      "CLIENT_TRAFFIC_SECRET_0 "
+      "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa "
+      "01020304\n");
+}
+
+TEST(KeyLogWriterTest, TestAppendsToFile) {
+  folly::test::TemporaryFile testFile("keylog");
+  std::vector<uint8_t> secret = {0xff};
+  {
+    KeyLogWriter writer(testFile.path().string());
+    writer.write(
+        testRandom(),
+        KeyLogWriter::Label::SERVER_HANDSHAKE_TRAFFIC_SECRET,
+        folly::range(secret));
+  }
+  {
+    // Reopening appends rather than truncating.
+    KeyLogWriter writer(testFile.path().string());
+    writer.write(
+        testRandom(),
+        KeyLogWriter::Label::SERVER_TRAFFIC_SECRET_0,
+        folly::range(secret));
+  }
+  std::string contents;
+  EXPECT_TRUE(folly::readFile(testFile.path().string().c_str(), contents));
+  EXPECT_EQ(
+      contents,
+      KeyLogWriter::generateLogLine(
+          testRandom(),
+          KeyLogWriter::Label::SERVER_HANDSHAKE_TRAFFIC_SECRET,
+          folly::range(secret)) +
+          KeyLogWriter::generateLogLine(
+              testRandom(),
+              KeyLogWriter::Label::SERVER_TRAFFIC_SECRET_0,
+              folly::range(secret)));
+}
+
+TEST(KeyLogWriterTest, TestBadPathThrows) {
+  EXPECT_THROW(
+      KeyLogWriter("/path/does/not/exist/keylog"), std::runtime_error);
+}
+} // namespace test
+} // namespace fizz
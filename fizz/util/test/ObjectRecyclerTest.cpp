@@ -0,0 +1,67 @@
+/*
+ *  Copyright (c) 2018-present, Facebook, Inc.
+ *  All rights reserved.
+ *
+ *  This source code is licensed under the BSD-style license found in the
+ *  LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/portability/GTest.h>
+
+#include <fizz/util/ObjectRecycler.h>
+
+namespace fizz {
+namespace test {
+
+namespace {
+struct Recycled : public PerThreadRecycled<Recycled, 2> {
+  virtual ~Recycled() = default;
+  uint64_t data[4];
+};
+
+struct Derived : public Recycled {
+  uint64_t moreData[4];
+};
+} // namespace
+
+TEST(ObjectRecyclerTest, TestStorageReused) {
+  auto first = new Recycled();
+  auto firstPtr = static_cast<void*>(first);
+  delete first;
+
+  auto second = new Recycled();
+  EXPECT_EQ(static_cast<void*>(second), firstPtr);
+  delete second;
+}
+
+TEST(ObjectRecyclerTest, TestCapacity) {
+  // Drain the freelist.
+  auto a = new Recycled();
+  auto b = new Recycled();
+  auto c = new Recycled();
+
+  // Only two blocks are retained; the third free goes to the allocator.
+  delete a;
+  delete b;
+  delete c;
+
+  auto d = new Recycled();
+  auto e = new Recycled();
+  delete d;
+  delete e;
+}
+
+TEST(ObjectRecyclerTest, TestDerivedNotPooled) {
+  auto derived = new Derived();
+  auto derivedPtr = static_cast<void*>(derived);
+  // Deleted through the base pointer; the deleting destructor must use the
+  // most-derived size and skip the freelist.
+  Recycled* base = derived;
+  delete base;
+
+  auto recycled = new Recycled();
+  EXPECT_NE(static_cast<void*>(recycled), derivedPtr);
+  delete recycled;
+}
+} // namespace test
+} // namespace fizz